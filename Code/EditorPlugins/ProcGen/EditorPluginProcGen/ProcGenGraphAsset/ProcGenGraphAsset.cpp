@@ -479,6 +479,8 @@ void ezProcGenGraphAssetDocument::DumpSelectedOutput(bool bAst, bool bDisassembl
     ezExpressionByteCode byteCode;
 
     ezExpressionCompiler compiler;
+    compiler.SetLogOptimizationResults(true);
+
     if (compiler.Compile(ast, byteCode).Succeeded())
     {
       ezStringBuilder sDisassembly;
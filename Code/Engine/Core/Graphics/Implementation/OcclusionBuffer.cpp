@@ -0,0 +1,312 @@
+#include <CorePCH.h>
+
+#include <Core/Graphics/OcclusionBuffer.h>
+
+ezOcclusionBuffer::ezOcclusionBuffer()
+{
+  m_mViewProjection.SetIdentity();
+}
+
+ezOcclusionBuffer::~ezOcclusionBuffer() = default;
+
+void ezOcclusionBuffer::Initialize(ezUInt32 uiWidth, ezUInt32 uiHeight)
+{
+  EZ_ASSERT_DEV(uiWidth > 0 && uiHeight > 0, "Invalid occlusion buffer resolution {0}x{1}", uiWidth, uiHeight);
+
+  m_uiWidth = ezMemoryUtils::AlignSize(uiWidth, 4u);
+  m_uiHeight = uiHeight;
+  m_uiNumRasterizedTriangles = 0;
+
+  m_DepthBuffer.SetCount((m_uiWidth / 4) * m_uiHeight);
+
+  const ezSimdVec4f farDepth(ezMath::MaxValue<float>());
+  for (ezSimdVec4f& depth : m_DepthBuffer)
+  {
+    depth = farDepth;
+  }
+}
+
+void ezOcclusionBuffer::BeginView(const ezMat4& mViewProjection, ezClipSpaceDepthRange::Enum depthRange /*= ezClipSpaceDepthRange::Default*/)
+{
+  EZ_ASSERT_DEV(m_uiWidth > 0, "Occlusion buffer has not been initialized");
+
+  m_mViewProjection = mViewProjection;
+  m_fNearPlaneW = depthRange == ezClipSpaceDepthRange::MinusOneToOne ? 1.0f : 0.0f;
+  m_uiNumRasterizedTriangles = 0;
+
+  const ezSimdVec4f farDepth(ezMath::MaxValue<float>());
+  for (ezSimdVec4f& depth : m_DepthBuffer)
+  {
+    depth = farDepth;
+  }
+}
+
+void ezOcclusionBuffer::RasterizeTriangle(const ezVec3& v0, const ezVec3& v1, const ezVec3& v2)
+{
+  RasterizeClipSpaceTriangle(m_mViewProjection.Transform(v0.GetAsVec4(1.0f)), m_mViewProjection.Transform(v1.GetAsVec4(1.0f)),
+    m_mViewProjection.Transform(v2.GetAsVec4(1.0f)));
+}
+
+void ezOcclusionBuffer::RasterizeBox(const ezBoundingBox& box, const ezMat4& mTransform)
+{
+  // Indices into the corners as returned by ezBoundingBox::GetCorners, two triangles per face
+  static const ezUInt8 s_BoxTriangles[12][3] = {
+    {0, 1, 3}, {0, 3, 2}, // -x
+    {4, 6, 7}, {4, 7, 5}, // +x
+    {0, 4, 5}, {0, 5, 1}, // -y
+    {2, 3, 7}, {2, 7, 6}, // +y
+    {0, 2, 6}, {0, 6, 4}, // -z
+    {1, 5, 7}, {1, 7, 3}, // +z
+  };
+
+  ezVec3 corners[8];
+  box.GetCorners(corners);
+
+  const ezMat4 mTransformViewProjection = m_mViewProjection * mTransform;
+
+  ezVec4 clipCorners[8];
+  for (ezUInt32 i = 0; i < 8; ++i)
+  {
+    clipCorners[i] = mTransformViewProjection.Transform(corners[i].GetAsVec4(1.0f));
+  }
+
+  for (ezUInt32 i = 0; i < 12; ++i)
+  {
+    RasterizeClipSpaceTriangle(clipCorners[s_BoxTriangles[i][0]], clipCorners[s_BoxTriangles[i][1]], clipCorners[s_BoxTriangles[i][2]]);
+  }
+}
+
+bool ezOcclusionBuffer::IsBoxVisible(const ezBoundingBox& box) const
+{
+  if (m_uiNumRasterizedTriangles == 0)
+    return true;
+
+  ezVec3 corners[8];
+  box.GetCorners(corners);
+
+  float fMinX = ezMath::MaxValue<float>();
+  float fMinY = ezMath::MaxValue<float>();
+  float fMaxX = -ezMath::MaxValue<float>();
+  float fMaxY = -ezMath::MaxValue<float>();
+  float fMinZ = ezMath::MaxValue<float>();
+
+  for (ezUInt32 i = 0; i < 8; ++i)
+  {
+    const ezVec4 vClipPos = m_mViewProjection.Transform(corners[i].GetAsVec4(1.0f));
+
+    // Boxes that intersect the near plane are too close to the camera to be reliably tested
+    if (GetNearPlaneDistance(vClipPos) <= 0.0f || vClipPos.w <= 0.0f)
+      return true;
+
+    const ScreenVertex v = ToScreenSpace(vClipPos);
+    fMinX = ezMath::Min(fMinX, v.x);
+    fMinY = ezMath::Min(fMinY, v.y);
+    fMaxX = ezMath::Max(fMaxX, v.x);
+    fMaxY = ezMath::Max(fMaxY, v.y);
+    fMinZ = ezMath::Min(fMinZ, v.z);
+  }
+
+  // Not on screen at all, that is the job of frustum culling
+  if (fMaxX < 0.0f || fMaxY < 0.0f || fMinX >= m_uiWidth || fMinY >= m_uiHeight)
+    return true;
+
+  const ezInt32 iMinX = (ezInt32)ezMath::Floor(ezMath::Max(fMinX, 0.0f));
+  const ezInt32 iMinY = (ezInt32)ezMath::Floor(ezMath::Max(fMinY, 0.0f));
+  const ezInt32 iMaxX = (ezInt32)ezMath::Floor(ezMath::Min(fMaxX, m_uiWidth - 1.0f));
+  const ezInt32 iMaxY = (ezInt32)ezMath::Floor(ezMath::Min(fMaxY, m_uiHeight - 1.0f));
+
+  const ezUInt32 uiGroupsPerRow = m_uiWidth / 4;
+  const ezUInt32 uiFirstGroup = iMinX / 4;
+  const ezUInt32 uiLastGroup = iMaxX / 4;
+
+  const ezSimdVec4f objectDepth(fMinZ);
+  const ezSimdVec4f minX((float)iMinX);
+  const ezSimdVec4f maxX((float)iMaxX);
+  const ezSimdVec4f laneOffsets(0.0f, 1.0f, 2.0f, 3.0f);
+
+  for (ezInt32 y = iMinY; y <= iMaxY; ++y)
+  {
+    const ezSimdVec4f* pRow = m_DepthBuffer.GetData() + y * uiGroupsPerRow;
+
+    ezSimdVec4f lanePos = ezSimdVec4f((float)(uiFirstGroup * 4)) + laneOffsets;
+
+    for (ezUInt32 uiGroup = uiFirstGroup; uiGroup <= uiLastGroup; ++uiGroup)
+    {
+      const ezSimdVec4b inRect = (lanePos >= minX) && (lanePos <= maxX);
+      const ezSimdVec4b inFront = objectDepth <= pRow[uiGroup];
+
+      if ((inRect && inFront).AnySet<4>())
+        return true;
+
+      lanePos += ezSimdVec4f(4.0f);
+    }
+  }
+
+  return false;
+}
+
+float ezOcclusionBuffer::GetDepth(ezUInt32 x, ezUInt32 y) const
+{
+  EZ_ASSERT_DEBUG(x < m_uiWidth && y < m_uiHeight, "Pixel coordinates out of range");
+
+  const ezSimdVec4f& group = m_DepthBuffer[y * (m_uiWidth / 4) + x / 4];
+  switch (x & 3)
+  {
+    case 0:
+      return group.x();
+    case 1:
+      return group.y();
+    case 2:
+      return group.z();
+    default:
+      return group.w();
+  }
+}
+
+void ezOcclusionBuffer::RasterizeClipSpaceTriangle(const ezVec4& v0, const ezVec4& v1, const ezVec4& v2)
+{
+  const ezVec4 input[3] = {v0, v1, v2};
+  const float fDist[3] = {GetNearPlaneDistance(v0), GetNearPlaneDistance(v1), GetNearPlaneDistance(v2)};
+
+  if (fDist[0] < 0.0f && fDist[1] < 0.0f && fDist[2] < 0.0f)
+    return;
+
+  // Clip against the near plane, which results in at most 4 vertices
+  ezVec4 clipped[4];
+  ezUInt32 uiNumClipped = 0;
+
+  for (ezUInt32 i = 0; i < 3; ++i)
+  {
+    const ezUInt32 j = (i + 1) % 3;
+
+    if (fDist[i] >= 0.0f)
+    {
+      clipped[uiNumClipped++] = input[i];
+    }
+
+    if ((fDist[i] >= 0.0f) != (fDist[j] >= 0.0f))
+    {
+      const float t = fDist[i] / (fDist[i] - fDist[j]);
+      clipped[uiNumClipped++] = ezMath::Lerp(input[i], input[j], t);
+    }
+  }
+
+  if (uiNumClipped < 3)
+    return;
+
+  ScreenVertex screen[4];
+  for (ezUInt32 i = 0; i < uiNumClipped; ++i)
+  {
+    // After clipping a perspective w can only be zero for vertices exactly on the camera plane, which is only possible with a zero near distance
+    if (clipped[i].w <= 0.0f)
+      return;
+
+    screen[i] = ToScreenSpace(clipped[i]);
+  }
+
+  RasterizeScreenSpaceTriangle(screen[0], screen[1], screen[2]);
+
+  if (uiNumClipped == 4)
+  {
+    RasterizeScreenSpaceTriangle(screen[0], screen[2], screen[3]);
+  }
+
+  ++m_uiNumRasterizedTriangles;
+}
+
+void ezOcclusionBuffer::RasterizeScreenSpaceTriangle(ScreenVertex v0, ScreenVertex v1, ScreenVertex v2)
+{
+  float fArea = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+  if (ezMath::Abs(fArea) < 1e-6f)
+    return;
+
+  if (fArea < 0.0f)
+  {
+    ezMath::Swap(v1, v2);
+    fArea = -fArea;
+  }
+
+  const float fMinX = ezMath::Min(v0.x, v1.x, v2.x);
+  const float fMinY = ezMath::Min(v0.y, v1.y, v2.y);
+  const float fMaxX = ezMath::Max(v0.x, v1.x, v2.x);
+  const float fMaxY = ezMath::Max(v0.y, v1.y, v2.y);
+
+  if (fMaxX < 0.0f || fMaxY < 0.0f || fMinX >= m_uiWidth || fMinY >= m_uiHeight)
+    return;
+
+  // Clamp before converting to integers, vertices close to the camera plane can have huge screen coordinates
+  const ezInt32 iMinX = (ezInt32)ezMath::Floor(ezMath::Max(fMinX, 0.0f));
+  const ezInt32 iMinY = (ezInt32)ezMath::Floor(ezMath::Max(fMinY, 0.0f));
+  const ezInt32 iMaxX = (ezInt32)ezMath::Floor(ezMath::Min(fMaxX, m_uiWidth - 1.0f));
+  const ezInt32 iMaxY = (ezInt32)ezMath::Floor(ezMath::Min(fMaxY, m_uiHeight - 1.0f));
+
+  // Edge functions E(p) = A * p.x + B * p.y + C, positive on the inner side of the edge
+  auto ComputeEdge = [](const ScreenVertex& a, const ScreenVertex& b, float& out_A, float& out_B, float& out_C) {
+    out_A = a.y - b.y;
+    out_B = b.x - a.x;
+    out_C = -out_A * a.x - out_B * a.y;
+  };
+
+  float A0, B0, C0; // v1 -> v2, weight of v0
+  float A1, B1, C1; // v2 -> v0, weight of v1
+  float A2, B2, C2; // v0 -> v1, weight of v2
+  ComputeEdge(v1, v2, A0, B0, C0);
+  ComputeEdge(v2, v0, A1, B1, C1);
+  ComputeEdge(v0, v1, A2, B2, C2);
+
+  // Projected depth is linear in screen space, so it can be interpolated with the normalized edge functions
+  const float fInvArea = 1.0f / fArea;
+  const float Az = (A0 * v0.z + A1 * v1.z + A2 * v2.z) * fInvArea;
+  const float Bz = (B0 * v0.z + B1 * v1.z + B2 * v2.z) * fInvArea;
+  const float Cz = (C0 * v0.z + C1 * v1.z + C2 * v2.z) * fInvArea;
+
+  const ezUInt32 uiGroupsPerRow = m_uiWidth / 4;
+  const ezUInt32 uiFirstGroup = iMinX / 4;
+  const ezUInt32 uiLastGroup = iMaxX / 4;
+
+  const ezSimdVec4f zero = ezSimdVec4f::ZeroVector();
+  const ezSimdVec4f px = ezSimdVec4f((float)(uiFirstGroup * 4)) + ezSimdVec4f(0.5f, 1.5f, 2.5f, 3.5f);
+
+  const ezSimdVec4f stepE0(A0 * 4.0f);
+  const ezSimdVec4f stepE1(A1 * 4.0f);
+  const ezSimdVec4f stepE2(A2 * 4.0f);
+  const ezSimdVec4f stepZ(Az * 4.0f);
+
+  for (ezInt32 y = iMinY; y <= iMaxY; ++y)
+  {
+    const float py = y + 0.5f;
+
+    ezSimdVec4f e0 = ezSimdVec4f::MulAdd(px, ezSimdVec4f(A0), ezSimdVec4f(B0 * py + C0));
+    ezSimdVec4f e1 = ezSimdVec4f::MulAdd(px, ezSimdVec4f(A1), ezSimdVec4f(B1 * py + C1));
+    ezSimdVec4f e2 = ezSimdVec4f::MulAdd(px, ezSimdVec4f(A2), ezSimdVec4f(B2 * py + C2));
+    ezSimdVec4f z = ezSimdVec4f::MulAdd(px, ezSimdVec4f(Az), ezSimdVec4f(Bz * py + Cz));
+
+    ezSimdVec4f* pRow = m_DepthBuffer.GetData() + y * uiGroupsPerRow;
+
+    for (ezUInt32 uiGroup = uiFirstGroup; uiGroup <= uiLastGroup; ++uiGroup)
+    {
+      const ezSimdVec4b inside = (e0 >= zero) && (e1 >= zero) && (e2 >= zero);
+
+      ezSimdVec4f& depth = pRow[uiGroup];
+      depth = ezSimdVec4f::Select(inside, depth.CompMin(z), depth);
+
+      e0 += stepE0;
+      e1 += stepE1;
+      e2 += stepE2;
+      z += stepZ;
+    }
+  }
+}
+
+ezOcclusionBuffer::ScreenVertex ezOcclusionBuffer::ToScreenSpace(const ezVec4& vClipPos) const
+{
+  const float fInvW = 1.0f / vClipPos.w;
+
+  ScreenVertex result;
+  result.x = (vClipPos.x * fInvW * 0.5f + 0.5f) * m_uiWidth;
+  result.y = (vClipPos.y * fInvW * -0.5f + 0.5f) * m_uiHeight;
+  result.z = vClipPos.z * fInvW;
+  return result;
+}
+
+EZ_STATICLINK_FILE(Core, Core_Graphics_Implementation_OcclusionBuffer);
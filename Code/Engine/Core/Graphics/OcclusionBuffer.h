@@ -0,0 +1,74 @@
+#pragma once
+
+#include <Core/CoreDLL.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Math/BoundingBox.h>
+#include <Foundation/Math/Mat4.h>
+#include <Foundation/SimdMath/SimdVec4f.h>
+
+/// \brief A low resolution depth buffer that is filled by rasterizing occluder geometry on the CPU.
+///
+/// After all occluders of a view have been rasterized, bounding boxes can be tested against the buffer to find out
+/// whether they are completely hidden behind the occluders. Everything runs on the CPU, so it works without any graphics API.
+///
+/// The buffer stores the projected depth (z / w) of the closest occluder per pixel, thus it works with perspective as well as
+/// orthographic projections as long as depth increases with the distance to the camera. Four horizontally adjacent pixels
+/// are always processed at once with SIMD, which is why the width is rounded up to a multiple of 4.
+///
+/// Occluder coverage is determined at the pixel centers, so tiny objects that are only visible through a gap at the border of an
+/// occluder that is smaller than a pixel may be culled. Objects that intersect the near plane are always considered visible.
+class EZ_CORE_DLL ezOcclusionBuffer
+{
+public:
+  ezOcclusionBuffer();
+  ~ezOcclusionBuffer();
+
+  /// \brief Sets the resolution of the buffer. The width is rounded up to a multiple of 4.
+  void Initialize(ezUInt32 uiWidth, ezUInt32 uiHeight);
+
+  ezUInt32 GetWidth() const { return m_uiWidth; }
+  ezUInt32 GetHeight() const { return m_uiHeight; }
+
+  /// \brief Clears the buffer and sets the view-projection matrix that is used for all following rasterization and test calls.
+  void BeginView(const ezMat4& mViewProjection, ezClipSpaceDepthRange::Enum depthRange = ezClipSpaceDepthRange::Default);
+
+  /// \brief Rasterizes a single world space triangle as an occluder. The winding order does not matter.
+  void RasterizeTriangle(const ezVec3& v0, const ezVec3& v1, const ezVec3& v2);
+
+  /// \brief Rasterizes the given box, transformed by mTransform into world space, as an occluder.
+  void RasterizeBox(const ezBoundingBox& box, const ezMat4& mTransform);
+
+  /// \brief Returns whether any occluder triangle has been rasterized since the last call to BeginView().
+  bool HasOccluders() const { return m_uiNumRasterizedTriangles > 0; }
+
+  /// \brief Returns false if the world space box is completely hidden behind the rasterized occluders.
+  bool IsBoxVisible(const ezBoundingBox& box) const;
+
+  /// \brief Returns the stored depth of the given pixel. Useful for tests and debug visualizations.
+  float GetDepth(ezUInt32 x, ezUInt32 y) const;
+
+private:
+  struct ScreenVertex
+  {
+    float x;
+    float y;
+    float z;
+  };
+
+  void RasterizeClipSpaceTriangle(const ezVec4& v0, const ezVec4& v1, const ezVec4& v2);
+  void RasterizeScreenSpaceTriangle(ScreenVertex v0, ScreenVertex v1, ScreenVertex v2);
+  ScreenVertex ToScreenSpace(const ezVec4& vClipPos) const;
+
+  /// \brief Signed distance to the near plane in clip space, positive values are in front of the near plane.
+  EZ_ALWAYS_INLINE float GetNearPlaneDistance(const ezVec4& vClipPos) const { return vClipPos.z + m_fNearPlaneW * vClipPos.w; }
+
+  ezUInt32 m_uiWidth = 0;
+  ezUInt32 m_uiHeight = 0;
+  ezUInt32 m_uiNumRasterizedTriangles = 0;
+
+  ezMat4 m_mViewProjection;
+  float m_fNearPlaneW = 0.0f;
+
+  // Each element holds the depth of 4 horizontally adjacent pixels
+  ezDynamicArray<ezSimdVec4f, ezAlignedAllocatorWrapper> m_DepthBuffer;
+};
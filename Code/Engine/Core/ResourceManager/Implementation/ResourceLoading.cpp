@@ -127,29 +127,6 @@ void ezResourceManager::RunWorkerTask(ezResource* pResource)
   }
 }
 
-void ezResourceManager::ReverseBubbleSortStep(ezDeque<LoadingInfo>& data)
-{
-  // Yep, it's really bubble sort!
-  // This will move the entry with the smallest value to the front and move all other values closer to their correct position,
-  // which is exactly what we need for the priority queue.
-  // We do this once a frame, which gives us nice iterative sorting, with relatively deterministic performance characteristics.
-
-  EZ_ASSERT_DEBUG(s_ResourceMutex.IsLocked(), "Calling code must acquire s_ResourceMutex");
-
-  const ezUInt32 uiCount = data.GetCount();
-
-  for (ezUInt32 i = uiCount; i > 1; --i)
-  {
-    const ezUInt32 idx2 = i - 1;
-    const ezUInt32 idx1 = i - 2;
-
-    if (data[idx1].m_fPriority > data[idx1].m_fPriority)
-    {
-      ezMath::Swap(data[idx1], data[idx2]);
-    }
-  }
-}
-
 void ezResourceManager::UpdateLoadingDeadlines()
 {
   if (s_State->s_LoadingQueue.IsEmpty())
@@ -159,35 +136,46 @@ void ezResourceManager::UpdateLoadingDeadlines()
 
   EZ_PROFILE_SCOPE("UpdateLoadingDeadlines");
 
-  const ezUInt32 uiCount = s_State->s_LoadingQueue.GetCount();
-  s_State->s_uiLastResourcePriorityUpdateIdx = ezMath::Min(s_State->s_uiLastResourcePriorityUpdateIdx, uiCount);
-
-  ezUInt32 uiUpdateCount = ezMath::Min(50u, uiCount - s_State->s_uiLastResourcePriorityUpdateIdx);
+  ezResourceLoadingQueue& queue = s_State->s_LoadingQueue;
+  const ezTime tNow = ezTime::Now();
 
-  if (uiUpdateCount == 0)
   {
-    s_State->s_uiLastResourcePriorityUpdateIdx = 0;
-    uiUpdateCount = ezMath::Min(50u, uiCount - s_State->s_uiLastResourcePriorityUpdateIdx);
+    EZ_PROFILE_SCOPE("EvalLoadingDeadlines");
+
+    // re-evaluate a few entries per call, resources that became more urgent (e.g. because they were acquired again)
+    // are moved towards the front this way
+    // updating an entry can move other entries around, that only means that some of them are evaluated a bit later or earlier
+    const ezUInt32 uiUpdateCount = ezMath::Min(50u, queue.GetCount());
+
+    for (ezUInt32 i = 0; i < uiUpdateCount; ++i)
+    {
+      if (s_State->s_uiLastResourcePriorityUpdateIdx >= queue.GetCount())
+        s_State->s_uiLastResourcePriorityUpdateIdx = 0;
+
+      ezResource* pResource = queue.GetEntry(s_State->s_uiLastResourcePriorityUpdateIdx).m_pResource;
+      queue.UpdatePriority(pResource, pResource->GetLoadingPriority(tNow));
+      ++s_State->s_uiLastResourcePriorityUpdateIdx;
+    }
   }
 
-  if (uiUpdateCount > 0)
   {
+    EZ_PROFILE_SCOPE("EvalFrontLoadingDeadline");
+
+    // priorities mostly get less urgent over time, so the cached priority of the front entry may be outdated
+    // re-evaluate the front until it does not change anymore, thus the next resource to load is the most urgent one
+    for (ezUInt32 i = 0; i < queue.GetCount(); ++i)
     {
-      EZ_PROFILE_SCOPE("EvalLoadingDeadlines");
+      const ezResourceLoadingQueue::Entry& front = queue.PeekFront();
+      ezResource* pResource = front.m_pResource;
+      const float fPriority = pResource->GetLoadingPriority(tNow);
 
-      const ezTime tNow = ezTime::Now();
+      if (fPriority == front.m_fPriority)
+        break;
 
-      for (ezUInt32 i = 0; i < uiUpdateCount; ++i)
-      {
-        auto& element = s_State->s_LoadingQueue[s_State->s_uiLastResourcePriorityUpdateIdx];
-        element.m_fPriority = element.m_pResource->GetLoadingPriority(tNow);
-        ++s_State->s_uiLastResourcePriorityUpdateIdx;
-      }
-    }
+      queue.UpdatePriority(pResource, fPriority);
 
-    {
-      EZ_PROFILE_SCOPE("SortLoadingDeadlines");
-      ReverseBubbleSortStep(s_State->s_LoadingQueue);
+      if (queue.PeekFront().m_pResource == pResource)
+        break;
     }
   }
 }
@@ -220,10 +208,7 @@ ezResult ezResourceManager::RemoveFromLoadingQueue(ezResource* pResource)
   if (!IsQueuedForLoading(pResource))
     return EZ_SUCCESS;
 
-  LoadingInfo li;
-  li.m_pResource = pResource;
-
-  if (s_State->s_LoadingQueue.RemoveAndSwap(li))
+  if (s_State->s_LoadingQueue.Remove(pResource))
   {
     pResource->m_Flags.Remove(ezResourceFlags::IsQueuedForLoading);
     return EZ_SUCCESS;
@@ -239,19 +224,14 @@ void ezResourceManager::AddToLoadingQueue(ezResource* pResource, bool bHighestPr
 
   pResource->m_Flags.Add(ezResourceFlags::IsQueuedForLoading);
 
-  LoadingInfo li;
-  li.m_pResource = pResource;
-
   if (bHighestPriority)
   {
     pResource->SetPriority(ezResourcePriority::Critical);
-    li.m_fPriority = 0.0f;
-    s_State->s_LoadingQueue.PushFront(li);
+    s_State->s_LoadingQueue.Insert(pResource, 0.0f, true);
   }
   else
   {
-    li.m_fPriority = pResource->GetLoadingPriority(s_State->s_LastFrameUpdate);
-    s_State->s_LoadingQueue.PushBack(li);
+    s_State->s_LoadingQueue.Insert(pResource, pResource->GetLoadingPriority(s_State->s_LastFrameUpdate));
   }
 }
 
@@ -284,10 +264,7 @@ bool ezResourceManager::ReloadResource(ezResource* pResource, bool bForce)
   {
     bAllowPreloading = false;
 
-    LoadingInfo li;
-    li.m_pResource = pResource;
-
-    if (s_State->s_LoadingQueue.IndexOf(li) == ezInvalidIndex)
+    if (!s_State->s_LoadingQueue.Contains(pResource))
     {
       // the resource is marked as 'loading' but it is not in the queue anymore
       // that means some task is already working on loading it
@@ -0,0 +1,155 @@
+#include <CorePCH.h>
+
+#include <Core/ResourceManager/Resource.h>
+#include <Core/ResourceManager/ResourceLoadingQueue.h>
+
+ezResourceLoadingQueue::ezResourceLoadingQueue() = default;
+ezResourceLoadingQueue::~ezResourceLoadingQueue() = default;
+
+bool ezResourceLoadingQueue::Contains(const ezResource* pResource) const
+{
+  const ezUInt32 uiIndex = pResource->m_uiLoadingQueueIndex;
+  return uiIndex < m_Heap.GetCount() && m_Heap[uiIndex].m_pResource == pResource;
+}
+
+void ezResourceLoadingQueue::Insert(ezResource* pResource, float fPriority, bool bInsertAtFront /*= false*/)
+{
+  EZ_ASSERT_DEV(!Contains(pResource), "Resource is already in the loading queue");
+
+  Entry entry;
+  entry.m_fPriority = fPriority;
+  entry.m_iInsertionOrder = bInsertAtFront ? m_iNextFrontOrder-- : m_iNextBackOrder++;
+  entry.m_pResource = pResource;
+
+  const ezUInt32 uiIndex = m_Heap.GetCount();
+  m_Heap.PushBack(entry);
+  pResource->m_uiLoadingQueueIndex = uiIndex;
+
+  MoveUp(uiIndex);
+}
+
+bool ezResourceLoadingQueue::Remove(ezResource* pResource)
+{
+  if (!Contains(pResource))
+    return false;
+
+  RemoveAt(pResource->m_uiLoadingQueueIndex);
+  return true;
+}
+
+bool ezResourceLoadingQueue::UpdatePriority(ezResource* pResource, float fPriority)
+{
+  if (!Contains(pResource))
+    return false;
+
+  const ezUInt32 uiIndex = pResource->m_uiLoadingQueueIndex;
+  Entry& entry = m_Heap[uiIndex];
+
+  if (entry.m_fPriority == fPriority)
+    return true;
+
+  const bool bMoreUrgent = fPriority < entry.m_fPriority;
+  entry.m_fPriority = fPriority;
+
+  if (bMoreUrgent)
+    MoveUp(uiIndex);
+  else
+    MoveDown(uiIndex);
+
+  return true;
+}
+
+ezResource* ezResourceLoadingQueue::PopFront()
+{
+  EZ_ASSERT_DEV(!m_Heap.IsEmpty(), "The loading queue is empty");
+
+  ezResource* pResource = m_Heap[0].m_pResource;
+  RemoveAt(0);
+  return pResource;
+}
+
+void ezResourceLoadingQueue::Clear()
+{
+  for (const Entry& entry : m_Heap)
+  {
+    entry.m_pResource->m_uiLoadingQueueIndex = ezInvalidIndex;
+  }
+
+  m_Heap.Clear();
+  m_iNextBackOrder = 0;
+  m_iNextFrontOrder = -1;
+}
+
+EZ_ALWAYS_INLINE void ezResourceLoadingQueue::SetEntry(ezUInt32 uiIndex, const Entry& entry)
+{
+  m_Heap[uiIndex] = entry;
+  entry.m_pResource->m_uiLoadingQueueIndex = uiIndex;
+}
+
+void ezResourceLoadingQueue::RemoveAt(ezUInt32 uiIndex)
+{
+  m_Heap[uiIndex].m_pResource->m_uiLoadingQueueIndex = ezInvalidIndex;
+
+  const ezUInt32 uiLastIndex = m_Heap.GetCount() - 1;
+  if (uiIndex != uiLastIndex)
+  {
+    const Entry& lastEntry = m_Heap[uiLastIndex];
+    const bool bMoreUrgent = IsLess(lastEntry, m_Heap[uiIndex]);
+
+    SetEntry(uiIndex, lastEntry);
+    m_Heap.PopBack();
+
+    if (bMoreUrgent)
+      MoveUp(uiIndex);
+    else
+      MoveDown(uiIndex);
+  }
+  else
+  {
+    m_Heap.PopBack();
+  }
+}
+
+void ezResourceLoadingQueue::MoveUp(ezUInt32 uiIndex)
+{
+  const Entry entry = m_Heap[uiIndex];
+
+  while (uiIndex > 0)
+  {
+    const ezUInt32 uiParent = (uiIndex - 1) / 2;
+
+    if (!IsLess(entry, m_Heap[uiParent]))
+      break;
+
+    SetEntry(uiIndex, m_Heap[uiParent]);
+    uiIndex = uiParent;
+  }
+
+  SetEntry(uiIndex, entry);
+}
+
+void ezResourceLoadingQueue::MoveDown(ezUInt32 uiIndex)
+{
+  const Entry entry = m_Heap[uiIndex];
+  const ezUInt32 uiCount = m_Heap.GetCount();
+
+  while (true)
+  {
+    ezUInt32 uiChild = uiIndex * 2 + 1;
+    if (uiChild >= uiCount)
+      break;
+
+    if (uiChild + 1 < uiCount && IsLess(m_Heap[uiChild + 1], m_Heap[uiChild]))
+      ++uiChild;
+
+    if (!IsLess(m_Heap[uiChild], entry))
+      break;
+
+    SetEntry(uiIndex, m_Heap[uiChild]);
+    uiIndex = uiChild;
+  }
+
+  SetEntry(uiIndex, entry);
+}
+
+EZ_STATICLINK_FILE(Core, Core_ResourceManager_Implementation_ResourceLoadingQueue);
@@ -318,6 +318,174 @@ void ezResourceManager::SetAutoFreeUnused(ezTime timeout, ezTime lastAcquireThre
   s_State->m_AutoFreeUnusedThreshold = lastAcquireThreshold;
 }
 
+void ezResourceManager::SetMemoryBudgetForResourceType(const ezRTTI* pType, ezUInt64 uiMaxMemoryCPU, ezUInt64 uiMaxMemoryGPU)
+{
+  EZ_LOCK(s_ResourceMutex);
+
+  auto& info = GetResourceTypeInfo(pType);
+  info.m_uiMemoryBudgetCPU = uiMaxMemoryCPU;
+  info.m_uiMemoryBudgetGPU = uiMaxMemoryGPU;
+
+  bool bAnyMemoryBudget = false;
+  for (auto it : s_State->m_TypeInfo)
+  {
+    if (it.Value().m_uiMemoryBudgetCPU > 0 || it.Value().m_uiMemoryBudgetGPU > 0)
+    {
+      bAnyMemoryBudget = true;
+      break;
+    }
+  }
+
+  s_State->m_bAnyMemoryBudget = bAnyMemoryBudget;
+}
+
+void ezResourceManager::GetMemoryUsageForResourceType(const ezRTTI* pType, ezUInt64& out_uiMemoryCPU, ezUInt64& out_uiMemoryGPU)
+{
+  EZ_LOCK(s_ResourceMutex);
+
+  out_uiMemoryCPU = 0;
+  out_uiMemoryGPU = 0;
+
+  const LoadedResources* pLoadedResources = s_State->s_LoadedResources.GetValue(pType);
+  if (pLoadedResources == nullptr)
+    return;
+
+  for (auto it : pLoadedResources->m_Resources)
+  {
+    const ezResource::MemoryUsage& usage = it.Value()->GetMemoryUsage();
+    out_uiMemoryCPU += usage.m_uiMemoryCPU;
+    out_uiMemoryGPU += usage.m_uiMemoryGPU;
+  }
+}
+
+ezUInt32 ezResourceManager::EnforceMemoryBudgets()
+{
+  if (!s_State->m_bAnyMemoryBudget)
+    return 0;
+
+  EZ_LOCK(s_ResourceMutex);
+  EZ_PROFILE_SCOPE("EnforceMemoryBudgets");
+
+  struct Candidate
+  {
+    EZ_DECLARE_POD_TYPE();
+
+    ezResource* m_pResource;
+    bool m_bReferenced;
+  };
+
+  ezDynamicArray<Candidate> candidates;
+  ezUInt32 uiAffectedResources = 0;
+
+  for (auto itType : s_State->m_TypeInfo)
+  {
+    const ResourceTypeInfo& info = itType.Value();
+    const ezUInt64 uiBudgetCPU = info.m_uiMemoryBudgetCPU > 0 ? info.m_uiMemoryBudgetCPU : ezMath::MaxValue<ezUInt64>();
+    const ezUInt64 uiBudgetGPU = info.m_uiMemoryBudgetGPU > 0 ? info.m_uiMemoryBudgetGPU : ezMath::MaxValue<ezUInt64>();
+
+    if (info.m_uiMemoryBudgetCPU == 0 && info.m_uiMemoryBudgetGPU == 0)
+      continue;
+
+    ezUInt64 uiMemoryCPU = 0;
+    ezUInt64 uiMemoryGPU = 0;
+    GetMemoryUsageForResourceType(itType.Key(), uiMemoryCPU, uiMemoryGPU);
+
+    if (uiMemoryCPU <= uiBudgetCPU && uiMemoryGPU <= uiBudgetGPU)
+      continue;
+
+    LoadedResources* pLoadedResources = s_State->s_LoadedResources.GetValue(itType.Key());
+    if (pLoadedResources == nullptr)
+      continue;
+
+    LoadedResources& lr = *pLoadedResources;
+
+    candidates.Clear();
+    for (auto it : lr.m_Resources)
+    {
+      ezResource* pResource = it.Value();
+
+      if (pResource->m_iLockCount > 0 || IsQueuedForLoading(pResource))
+        continue;
+
+      if (pResource->GetReferenceCount() == 0)
+      {
+        candidates.PushBack({pResource, false});
+      }
+      else if (pResource->GetNumQualityLevelsDiscardable() > 0 && pResource->GetLastAcquireTime() < s_State->s_LastFrameUpdate)
+      {
+        candidates.PushBack({pResource, true});
+      }
+    }
+
+    candidates.Sort([](const Candidate& a, const Candidate& b) {
+      if (a.m_bReferenced != b.m_bReferenced)
+        return !a.m_bReferenced;
+
+      // higher values mean lower priority
+      if (a.m_pResource->GetPriority() != b.m_pResource->GetPriority())
+        return a.m_pResource->GetPriority() > b.m_pResource->GetPriority();
+
+      return a.m_pResource->GetLastAcquireTime() < b.m_pResource->GetLastAcquireTime();
+    });
+
+    for (const Candidate& candidate : candidates)
+    {
+      if (uiMemoryCPU <= uiBudgetCPU && uiMemoryGPU <= uiBudgetGPU)
+        break;
+
+      ezResource* pResource = candidate.m_pResource;
+
+      if (!candidate.m_bReferenced)
+      {
+        const ezResource::MemoryUsage oldUsage = pResource->GetMemoryUsage();
+        const ezTempHashedString sResourceID(pResource->GetResourceID().GetData());
+
+        if (DeallocateResource(pResource).Failed())
+          continue;
+
+        lr.m_Resources.Remove(sResourceID);
+
+        uiMemoryCPU -= oldUsage.m_uiMemoryCPU;
+        uiMemoryGPU -= oldUsage.m_uiMemoryGPU;
+      }
+      else
+      {
+        // unload one quality level at a time, until the resource is within budget or has nothing left to discard
+        do
+        {
+          pResource->CallUnloadData(ezResource::Unload::OneQualityLevel);
+
+          ezResource::MemoryUsage MemUsage;
+          MemUsage.m_uiMemoryCPU = 0xFFFFFFFF;
+          MemUsage.m_uiMemoryGPU = 0xFFFFFFFF;
+          pResource->UpdateMemoryUsage(MemUsage);
+
+          EZ_ASSERT_DEV(
+            MemUsage.m_uiMemoryCPU != 0xFFFFFFFF, "Resource '{0}' did not properly update its CPU memory usage", pResource->GetResourceID());
+          EZ_ASSERT_DEV(
+            MemUsage.m_uiMemoryGPU != 0xFFFFFFFF, "Resource '{0}' did not properly update its GPU memory usage", pResource->GetResourceID());
+
+          uiMemoryCPU = uiMemoryCPU - pResource->m_MemoryUsage.m_uiMemoryCPU + MemUsage.m_uiMemoryCPU;
+          uiMemoryGPU = uiMemoryGPU - pResource->m_MemoryUsage.m_uiMemoryGPU + MemUsage.m_uiMemoryGPU;
+
+          pResource->m_MemoryUsage = MemUsage;
+
+        } while (pResource->GetNumQualityLevelsDiscardable() > 0 && (uiMemoryCPU > uiBudgetCPU || uiMemoryGPU > uiBudgetGPU));
+      }
+
+      ++uiAffectedResources;
+    }
+
+    if (uiMemoryCPU > uiBudgetCPU || uiMemoryGPU > uiBudgetGPU)
+    {
+      ezLog::Debug("Resources of type '{}' exceed their memory budget and cannot be unloaded further (CPU: {} KB, GPU: {} KB)",
+        itType.Key()->GetTypeName(), uiMemoryCPU / 1024, uiMemoryGPU / 1024);
+    }
+  }
+
+  return uiAffectedResources;
+}
+
 void ezResourceManager::AllowResourceTypeAcquireDuringUpdateContent(const ezRTTI* pTypeBeingUpdated, const ezRTTI* pTypeItWantsToAcquire)
 {
   auto& info = s_State->m_TypeInfo[pTypeBeingUpdated];
@@ -446,6 +614,9 @@ void ezResourceManager::PerFrameUpdate()
 {
   EZ_PROFILE_SCOPE("ezResourceManagerUpdate");
 
+  // done before the frame time is updated, so that resources that were used in the last frame are not unloaded
+  EnforceMemoryBudgets();
+
   s_State->s_LastFrameUpdate = ezTime::Now();
 
   if (s_State->s_bBroadcastExistsEvent)
@@ -497,6 +668,8 @@ void ezResourceManager::PerFrameUpdate()
     }
 
     s_State->s_ResourcesToUnloadOnMainThread.Clear();
+
+    EZ_PROFILE_COUNTER("Resource Manager/Loading Queue", s_State->s_LoadingQueue.GetCount());
   }
 
   if (s_State->m_AutoFreeUnusedTimeout.IsPositive())
@@ -576,9 +749,9 @@ void ezResourceManager::EngineAboutToShutdown()
   {
     EZ_LOCK(s_ResourceMutex);
 
-    for (auto entry : s_State->s_LoadingQueue)
+    for (ezUInt32 i = 0; i < s_State->s_LoadingQueue.GetCount(); ++i)
     {
-      entry.m_pResource->m_Flags.Remove(ezResourceFlags::IsQueuedForLoading);
+      s_State->s_LoadingQueue.GetEntry(i).m_pResource->m_Flags.Remove(ezResourceFlags::IsQueuedForLoading);
     }
 
     s_State->s_LoadingQueue.Clear();
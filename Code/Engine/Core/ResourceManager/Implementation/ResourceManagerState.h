@@ -3,6 +3,7 @@
 #include <Core/CoreInternal.h>
 EZ_CORE_INTERNAL_HEADER
 
+#include <Core/ResourceManager/ResourceLoadingQueue.h>
 #include <Core/ResourceManager/ResourceManager.h>
 
 class ezResourceManagerState
@@ -51,7 +52,7 @@ private:
   ezUInt32 s_uiForceNoFallbackAcquisition = 0;
 
   // resources in this queue are waiting for a task to load them
-  ezDeque<ezResourceManager::LoadingInfo> s_LoadingQueue;
+  ezResourceLoadingQueue s_LoadingQueue;
 
   ezHashTable<const ezRTTI*, ezResourceManager::LoadedResources> s_LoadedResources;
 
@@ -101,5 +102,8 @@ private:
   ezTime m_AutoFreeUnusedTimeout = ezTime::Zero();
   ezTime m_AutoFreeUnusedThreshold = ezTime::Zero();
 
+  // read without the resource mutex by EnforceMemoryBudgets(), so that it costs nothing when no budget is set
+  ezAtomicBool m_bAnyMemoryBudget;
+
   ezMap<const ezRTTI*, ezResourceManager::ResourceTypeInfo> m_TypeInfo;
 };
@@ -288,3 +288,9 @@ void ezResourceManager::SetIncrementalUnloadForResourceType(bool bActive)
 {
   GetResourceTypeInfo(ezGetStaticRTTI<ResourceType>()).m_bIncrementalUnload = bActive;
 }
+
+template <typename ResourceType>
+void ezResourceManager::SetMemoryBudgetForResourceType(ezUInt64 uiMaxMemoryCPU, ezUInt64 uiMaxMemoryGPU)
+{
+  SetMemoryBudgetForResourceType(ezGetStaticRTTI<ResourceType>(), uiMaxMemoryCPU, uiMaxMemoryGPU);
+}
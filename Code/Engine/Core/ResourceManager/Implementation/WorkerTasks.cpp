@@ -27,9 +27,7 @@ void ezResourceManagerWorkerDataLoad::Execute()
 
     ezResourceManager::UpdateLoadingDeadlines();
 
-    auto it = ezResourceManager::s_State->s_LoadingQueue.PeekFront();
-    pResourceToLoad = it.m_pResource;
-    ezResourceManager::s_State->s_LoadingQueue.PopFront();
+    pResourceToLoad = ezResourceManager::s_State->s_LoadingQueue.PopFront();
 
     if (pResourceToLoad->m_Flags.IsSet(ezResourceFlags::HasCustomDataLoader))
     {
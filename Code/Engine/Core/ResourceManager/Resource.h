@@ -135,6 +135,7 @@ private:
   friend class ezResourceManager;
   friend class ezResourceManagerWorkerDataLoad;
   friend class ezResourceManagerWorkerUpdateContent;
+  friend class ezResourceLoadingQueue;
 
   /// \brief Called by ezResourceManager shortly after resource creation.
   void SetUniqueID(const char* szUniqueID, bool bIsReloadable);
@@ -224,6 +225,7 @@ private:
   ezString m_sResourceDescription;
   MemoryUsage m_MemoryUsage;
   ezBitflags<ezResourceFlags> m_Flags;
+  ezUInt32 m_uiLoadingQueueIndex = ezInvalidIndex;
 
   ezTime m_LastAcquire;
   ezResourcePriority m_Priority = ezResourcePriority::Medium;
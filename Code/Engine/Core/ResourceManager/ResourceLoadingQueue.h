@@ -0,0 +1,79 @@
+#pragma once
+
+#include <Core/ResourceManager/Implementation/Declarations.h>
+#include <Foundation/Containers/DynamicArray.h>
+
+/// \brief A priority queue of resources that are waiting to be loaded.
+///
+/// The queue is an indexed binary min-heap, every resource stores its own position in the heap.
+/// Therefore checking whether a resource is queued, removing it and changing its priority are cheap operations,
+/// even with tens of thousands of queued resources, and the front of the queue is always the entry with the lowest priority value.
+///
+/// Low priority values mean the resource is more urgent (see ezResource::GetLoadingPriority()).
+/// Entries with the same priority are returned in the order in which they were inserted,
+/// except for entries that were inserted with bInsertAtFront, those are returned before all other entries with the same priority.
+///
+/// The queue does not do any synchronization, the ezResourceManager only accesses it while holding its resource mutex.
+/// A resource can only be stored in one queue at a time.
+class EZ_CORE_DLL ezResourceLoadingQueue
+{
+public:
+  struct Entry
+  {
+    float m_fPriority = 0.0f;
+    ezInt64 m_iInsertionOrder = 0;
+    ezResource* m_pResource = nullptr;
+  };
+
+  ezResourceLoadingQueue();
+  ~ezResourceLoadingQueue();
+
+  EZ_ALWAYS_INLINE ezUInt32 GetCount() const { return m_Heap.GetCount(); }
+  EZ_ALWAYS_INLINE bool IsEmpty() const { return m_Heap.IsEmpty(); }
+
+  /// \brief Returns whether the given resource is currently stored in this queue.
+  bool Contains(const ezResource* pResource) const;
+
+  /// \brief Adds the resource with the given priority. The resource must not be in the queue already.
+  ///
+  /// If bInsertAtFront is true, the resource is returned before all other resources that have the same priority.
+  void Insert(ezResource* pResource, float fPriority, bool bInsertAtFront = false);
+
+  /// \brief Removes the resource from the queue. Returns false if it was not in the queue.
+  bool Remove(ezResource* pResource);
+
+  /// \brief Changes the priority of a queued resource and moves it to its new position. Returns false if it was not in the queue.
+  bool UpdatePriority(ezResource* pResource, float fPriority);
+
+  /// \brief Returns the most urgent entry. The queue must not be empty.
+  EZ_ALWAYS_INLINE const Entry& PeekFront() const { return m_Heap[0]; }
+
+  /// \brief Removes the most urgent entry from the queue and returns its resource. The queue must not be empty.
+  ezResource* PopFront();
+
+  /// \brief Removes all entries.
+  void Clear();
+
+  /// \brief Gives access to all entries in heap order, e.g. to iteratively update their priorities.
+  ///
+  /// Note that updating the priority of an entry may move other entries around.
+  EZ_ALWAYS_INLINE const Entry& GetEntry(ezUInt32 uiIndex) const { return m_Heap[uiIndex]; }
+
+private:
+  EZ_ALWAYS_INLINE static bool IsLess(const Entry& lhs, const Entry& rhs)
+  {
+    if (lhs.m_fPriority != rhs.m_fPriority)
+      return lhs.m_fPriority < rhs.m_fPriority;
+
+    return lhs.m_iInsertionOrder < rhs.m_iInsertionOrder;
+  }
+
+  void SetEntry(ezUInt32 uiIndex, const Entry& entry);
+  void RemoveAt(ezUInt32 uiIndex);
+  void MoveUp(ezUInt32 uiIndex);
+  void MoveDown(ezUInt32 uiIndex);
+
+  ezDynamicArray<Entry> m_Heap;
+  ezInt64 m_iNextBackOrder = 0;
+  ezInt64 m_iNextFrontOrder = -1;
+};
@@ -192,6 +192,29 @@ public:
   template <typename ResourceType>
   static void SetIncrementalUnloadForResourceType(bool bActive);
 
+  /// \brief Sets how many bytes of CPU and GPU memory all resources of the given type may use together. Zero means unlimited.
+  ///
+  /// Whenever a type exceeds its budget, EnforceMemoryBudgets() frees unused resources of that type and unloads quality levels of
+  /// resources that are still referenced, until the type is within its budget again. Only resources that were created with exactly this
+  /// type are counted, resources of derived types need their own budget.
+  template <typename ResourceType>
+  static void SetMemoryBudgetForResourceType(ezUInt64 uiMaxMemoryCPU, ezUInt64 uiMaxMemoryGPU);
+
+  /// \copydoc SetMemoryBudgetForResourceType()
+  static void SetMemoryBudgetForResourceType(const ezRTTI* pType, ezUInt64 uiMaxMemoryCPU, ezUInt64 uiMaxMemoryGPU);
+
+  /// \brief Returns the sum of the memory usage of all resources of exactly the given type.
+  static void GetMemoryUsageForResourceType(const ezRTTI* pType, ezUInt64& out_uiMemoryCPU, ezUInt64& out_uiMemoryGPU);
+
+  /// \brief Frees or partially unloads resources of all types that exceed their memory budget. Returns the number of affected resources.
+  ///
+  /// Unused resources are freed first, then referenced resources unload one quality level after the other.
+  /// Within each group resources with a lower priority go first and among those the ones that were not acquired for the longest time.
+  /// Referenced resources that were acquired during the current frame, or that are currently queued for loading, are never unloaded.
+  ///
+  /// This is called automatically once per frame by PerFrameUpdate(), as long as any memory budget is set.
+  static ezUInt32 EnforceMemoryBudgets();
+
   template<typename TypeBeingUpdated, typename TypeItWantsToAcquire>
   static void AllowResourceTypeAcquireDuringUpdateContent()
   {
@@ -420,14 +443,6 @@ private:
     ezHashTable<ezTempHashedString, ezResource*> m_Resources;
   };
 
-  struct LoadingInfo
-  {
-    float m_fPriority = 0;
-    ezResource* m_pResource = nullptr;
-
-    EZ_ALWAYS_INLINE bool operator==(const LoadingInfo& rhs) const { return m_pResource == rhs.m_pResource; }
-    EZ_ALWAYS_INLINE bool operator<(const LoadingInfo& rhs) const { return m_fPriority < rhs.m_fPriority; }
-  };
   static void EnsureResourceLoadingState(ezResource* pResource, const ezResourceState RequestedState);
   static void PreloadResource(ezResource* pResource);
   static void InternalPreloadResource(ezResource* pResource, bool bHighestPriority);
@@ -437,7 +452,6 @@ private:
   static ezResource* GetResource(const ezRTTI* pRtti, const char* szResourceID, bool bIsReloadable);
   static void RunWorkerTask(ezResource* pResource);
   static void UpdateLoadingDeadlines();
-  static void ReverseBubbleSortStep(ezDeque<LoadingInfo>& data);
   static bool ReloadResource(ezResource* pResource, bool bForce);
 
   static void SetupWorkerTasks();
@@ -453,6 +467,8 @@ private:
   {
     bool m_bIncrementalUnload = true;
     bool m_bAllowNestedAcquireCached = false;
+    ezUInt64 m_uiMemoryBudgetCPU = 0;
+    ezUInt64 m_uiMemoryBudgetGPU = 0;
 
     ezHybridArray<const ezRTTI*, 8> m_NestedTypes;
   };
@@ -1,6 +1,7 @@
 #include <CorePCH.h>
 
 #include <Core/World/SpatialSystem.h>
+#include <Foundation/Threading/TaskSystem.h>
 #include <Foundation/Time/Stopwatch.h>
 
 // clang-format off
@@ -202,7 +203,47 @@ void ezSpatialSystem::FindVisibleObjects(const ezFrustum& frustum, ezUInt32 uiCa
     if ((pData->m_uiCategoryBitmask & uiCategoryBitmask) != 0)
     {
       out_Objects.PushBack(pData->m_pObject);
-    }    
+    }
+  }
+
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+  if (pStats != nullptr)
+  {
+    pStats->m_TimeTaken = timer.GetRunningTotal();
+  }
+#endif
+}
+
+void ezSpatialSystem::FindVisibleObjects(ezArrayPtr<const ezFrustum> frusta, ezUInt32 uiCategoryBitmask,
+  ezArrayPtr<ezDynamicArray<const ezGameObject*>> out_ObjectsPerFrustum, QueryStats* pStats /*= nullptr*/) const
+{
+  EZ_ASSERT_DEV(frusta.GetCount() == out_ObjectsPerFrustum.GetCount(), "Need exactly one output array per frustum");
+
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+  ezStopwatch timer;
+
+  if (pStats != nullptr)
+  {
+    pStats->m_uiTotalNumObjects = m_DataTable.GetCount();
+    pStats->m_uiNumObjectsTested += m_DataAlwaysVisible.GetCount() * frusta.GetCount();
+    pStats->m_uiNumObjectsPassed += m_DataAlwaysVisible.GetCount() * frusta.GetCount();
+  }
+#endif
+
+  if (frusta.IsEmpty())
+    return;
+
+  FindVisibleObjectsBatchInternal(frusta, uiCategoryBitmask, out_ObjectsPerFrustum, pStats);
+
+  for (auto pData : m_DataAlwaysVisible)
+  {
+    if ((pData->m_uiCategoryBitmask & uiCategoryBitmask) != 0)
+    {
+      for (auto& objects : out_ObjectsPerFrustum)
+      {
+        objects.PushBack(pData->m_pObject);
+      }
+    }
   }
 
 #if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
@@ -213,6 +254,42 @@ void ezSpatialSystem::FindVisibleObjects(const ezFrustum& frustum, ezUInt32 uiCa
 #endif
 }
 
+void ezSpatialSystem::FindVisibleObjectsBatchInternal(ezArrayPtr<const ezFrustum> frusta, ezUInt32 uiCategoryBitmask,
+  ezArrayPtr<ezDynamicArray<const ezGameObject*>> out_ObjectsPerFrustum, QueryStats* pStats) const
+{
+  struct BatchContext
+  {
+    ezArrayPtr<const ezFrustum> m_Frusta;
+    ezArrayPtr<ezDynamicArray<const ezGameObject*>> m_ObjectsPerFrustum;
+    ezDynamicArray<QueryStats> m_StatsPerFrustum;
+    ezUInt32 m_uiCategoryBitmask;
+  };
+
+  BatchContext context;
+  context.m_Frusta = frusta;
+  context.m_ObjectsPerFrustum = out_ObjectsPerFrustum;
+  context.m_StatsPerFrustum.SetCount(frusta.GetCount());
+  context.m_uiCategoryBitmask = uiCategoryBitmask;
+
+  // Queries are read-only, so the frusta can be processed independently of each other.
+  ezTaskSystem::ParallelForIndexed(0, frusta.GetCount(), [this, &context, pStats](ezUInt32 uiStartIndex, ezUInt32 uiEndIndex) {
+    for (ezUInt32 i = uiStartIndex; i < uiEndIndex; ++i)
+    {
+      FindVisibleObjectsInternal(context.m_Frusta[i], context.m_uiCategoryBitmask, context.m_ObjectsPerFrustum[i],
+        pStats != nullptr ? &context.m_StatsPerFrustum[i] : nullptr);
+    }
+  }, "FindVisibleObjectsBatch");
 
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+  if (pStats != nullptr)
+  {
+    for (const QueryStats& stats : context.m_StatsPerFrustum)
+    {
+      pStats->m_uiNumObjectsTested += stats.m_uiNumObjectsTested;
+      pStats->m_uiNumObjectsPassed += stats.m_uiNumObjectsPassed;
+    }
+  }
+#endif
+}
 
 EZ_STATICLINK_FILE(Core, Core_World_Implementation_SpatialSystem);
@@ -0,0 +1,919 @@
+#include <CorePCH.h>
+
+#include <Core/World/SpatialSystem_BVH.h>
+#include <Foundation/Algorithm/Sorting.h>
+#include <Foundation/SimdMath/SimdConversion.h>
+
+namespace
+{
+  enum
+  {
+    MAX_CHILDREN = 4,
+  };
+
+  /// \brief Objects are tested by their bounding sphere (same as in ezSpatialSystem_RegularGrid), so their box in the tree has to enclose the sphere.
+  EZ_ALWAYS_INLINE ezSimdBBox GetObjectBox(const ezSpatialData* pData)
+  {
+    const ezSimdVec4f& centerAndRadius = pData->m_Bounds.m_CenterAndRadius;
+
+    ezSimdBBox box;
+    box.SetCenterAndHalfExtents(centerAndRadius, centerAndRadius.Get<ezSwizzle::WWWW>());
+    return box;
+  }
+
+  EZ_ALWAYS_INLINE ezUInt32 GetLaneMask(const ezSimdVec4b& b)
+  {
+    return (b.x() ? 1u : 0u) | (b.y() ? 2u : 0u) | (b.z() ? 4u : 0u) | (b.w() ? 8u : 0u);
+  }
+
+  EZ_ALWAYS_INLINE ezSimdVec4f GetSurfaceArea(const ezSimdVec4f& extentsX, const ezSimdVec4f& extentsY, const ezSimdVec4f& extentsZ)
+  {
+    return extentsX.CompMul(extentsY) + extentsY.CompMul(extentsZ) + extentsZ.CompMul(extentsX);
+  }
+
+  /// \brief Maximum depth of a subtree with the given number of objects, before it gets rebuilt.
+  EZ_ALWAYS_INLINE ezUInt32 GetMaxSubtreeDepth(ezUInt32 uiNumObjects)
+  {
+    // a perfectly balanced tree has a depth of log4(n), allow up to twice as much
+    return ezMath::Log2i(ezMath::Max(uiNumObjects, 1u)) + 2;
+  }
+
+  struct PlaneDataSoA
+  {
+    ezSimdVec4f m_NormalX[ezFrustum::PLANE_COUNT];
+    ezSimdVec4f m_NormalY[ezFrustum::PLANE_COUNT];
+    ezSimdVec4f m_NormalZ[ezFrustum::PLANE_COUNT];
+    ezSimdVec4f m_NegDistance[ezFrustum::PLANE_COUNT];
+  };
+
+  struct CenterComparer
+  {
+    EZ_ALWAYS_INLINE bool Less(const ezSpatialData* a, const ezSpatialData* b) const
+    {
+      return a->m_Bounds.m_CenterAndRadius.GetComponent(m_iAxis) < b->m_Bounds.m_CenterAndRadius.GetComponent(m_iAxis);
+    }
+
+    int m_iAxis = 0;
+  };
+
+  /// \brief Sorts the objects along the longest axis of their centers and splits them in half.
+  void SplitAtMedian(ezArrayPtr<ezSpatialData*> objects, ezArrayPtr<ezSpatialData*>& out_Left, ezArrayPtr<ezSpatialData*>& out_Right)
+  {
+    ezSimdBBox centerBounds;
+    centerBounds.SetInvalid();
+
+    for (const ezSpatialData* pData : objects)
+    {
+      centerBounds.ExpandToInclude(pData->m_Bounds.m_CenterAndRadius);
+    }
+
+    const ezSimdVec4f extents = centerBounds.GetExtents();
+
+    CenterComparer comparer;
+    if (extents.y() > extents.x())
+      comparer.m_iAxis = 1;
+    if (extents.z() > extents.GetComponent(comparer.m_iAxis))
+      comparer.m_iAxis = 2;
+
+    ezSorting::QuickSort(objects, comparer);
+
+    const ezUInt32 uiHalf = objects.GetCount() / 2;
+    out_Left = objects.GetSubArray(0, uiHalf);
+    out_Right = objects.GetSubArray(uiHalf);
+  }
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+struct ezSpatialSystem_BVH::SpatialUserData
+{
+  ezUInt32 m_uiNodeIndex = ezInvalidIndex;
+  ezUInt32 m_uiSlot = ezInvalidIndex;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+struct ezSpatialSystem_BVH::Node
+{
+  EZ_DECLARE_POD_TYPE();
+
+  void Reset(ezUInt32 uiParent, ezUInt32 uiSlotInParent)
+  {
+    for (ezUInt32 i = 0; i < MAX_CHILDREN; ++i)
+    {
+      ClearSlot(i);
+    }
+
+    m_uiParent = uiParent;
+    m_uiSlotInParent = uiSlotInParent;
+    m_uiNumObjects = 0;
+    m_uiNumChildren = 0;
+  }
+
+  void ClearSlot(ezUInt32 uiSlot)
+  {
+    m_fMinX[uiSlot] = m_fMinY[uiSlot] = m_fMinZ[uiSlot] = ezMath::MaxValue<float>();
+    m_fMaxX[uiSlot] = m_fMaxY[uiSlot] = m_fMaxZ[uiSlot] = -ezMath::MaxValue<float>();
+    m_pData[uiSlot] = nullptr;
+    m_uiChildNode[uiSlot] = ezInvalidIndex;
+    m_uiCategoryBitmask[uiSlot] = 0;
+  }
+
+  void SetSlotBox(ezUInt32 uiSlot, const ezSimdBBox& box)
+  {
+    m_fMinX[uiSlot] = box.m_Min.x();
+    m_fMinY[uiSlot] = box.m_Min.y();
+    m_fMinZ[uiSlot] = box.m_Min.z();
+    m_fMaxX[uiSlot] = box.m_Max.x();
+    m_fMaxY[uiSlot] = box.m_Max.y();
+    m_fMaxZ[uiSlot] = box.m_Max.z();
+  }
+
+  ezSimdBBox GetSlotBox(ezUInt32 uiSlot) const
+  {
+    return ezSimdBBox(ezSimdVec4f(m_fMinX[uiSlot], m_fMinY[uiSlot], m_fMinZ[uiSlot]), ezSimdVec4f(m_fMaxX[uiSlot], m_fMaxY[uiSlot], m_fMaxZ[uiSlot]));
+  }
+
+  void CopySlot(ezUInt32 uiDstSlot, ezUInt32 uiSrcSlot)
+  {
+    m_fMinX[uiDstSlot] = m_fMinX[uiSrcSlot];
+    m_fMinY[uiDstSlot] = m_fMinY[uiSrcSlot];
+    m_fMinZ[uiDstSlot] = m_fMinZ[uiSrcSlot];
+    m_fMaxX[uiDstSlot] = m_fMaxX[uiSrcSlot];
+    m_fMaxY[uiDstSlot] = m_fMaxY[uiSrcSlot];
+    m_fMaxZ[uiDstSlot] = m_fMaxZ[uiSrcSlot];
+    m_pData[uiDstSlot] = m_pData[uiSrcSlot];
+    m_uiChildNode[uiDstSlot] = m_uiChildNode[uiSrcSlot];
+    m_uiCategoryBitmask[uiDstSlot] = m_uiCategoryBitmask[uiSrcSlot];
+  }
+
+  ezSimdBBox GetBounds() const
+  {
+    ezSimdVec4f minX, minY, minZ, maxX, maxY, maxZ;
+    LoadBoxes(minX, minY, minZ, maxX, maxY, maxZ);
+
+    // unused slots have an inverted box, so they don't affect the result
+    return ezSimdBBox(ezSimdVec4f(minX.HorizontalMin<4>(), minY.HorizontalMin<4>(), minZ.HorizontalMin<4>()),
+      ezSimdVec4f(maxX.HorizontalMax<4>(), maxY.HorizontalMax<4>(), maxZ.HorizontalMax<4>()));
+  }
+
+  ezUInt32 GetCategoryBitmask() const { return m_uiCategoryBitmask[0] | m_uiCategoryBitmask[1] | m_uiCategoryBitmask[2] | m_uiCategoryBitmask[3]; }
+
+  EZ_ALWAYS_INLINE void LoadBoxes(ezSimdVec4f& out_MinX, ezSimdVec4f& out_MinY, ezSimdVec4f& out_MinZ, ezSimdVec4f& out_MaxX, ezSimdVec4f& out_MaxY, ezSimdVec4f& out_MaxZ) const
+  {
+    out_MinX.Load<4>(m_fMinX);
+    out_MinY.Load<4>(m_fMinY);
+    out_MinZ.Load<4>(m_fMinZ);
+    out_MaxX.Load<4>(m_fMaxX);
+    out_MaxY.Load<4>(m_fMaxY);
+    out_MaxZ.Load<4>(m_fMaxZ);
+  }
+
+  /// \brief Returns a bit for every slot that contains any of the given categories.
+  EZ_ALWAYS_INLINE ezUInt32 GetCategorySlotMask(ezUInt32 uiCategoryBitmask) const
+  {
+    ezUInt32 mask = 0;
+    for (ezUInt32 i = 0; i < MAX_CHILDREN; ++i)
+    {
+      mask |= (m_uiCategoryBitmask[i] & uiCategoryBitmask) != 0 ? EZ_BIT(i) : 0;
+    }
+    return mask;
+  }
+
+  /// \brief Returns a bit for every slot that contains an object.
+  EZ_ALWAYS_INLINE ezUInt32 GetObjectSlotMask() const
+  {
+    ezUInt32 mask = 0;
+    for (ezUInt32 i = 0; i < MAX_CHILDREN; ++i)
+    {
+      mask |= m_pData[i] != nullptr ? EZ_BIT(i) : 0;
+    }
+    return mask;
+  }
+
+  // bounding boxes of the children, stored as SoA so that all children can be tested at once
+  float m_fMinX[MAX_CHILDREN];
+  float m_fMinY[MAX_CHILDREN];
+  float m_fMinZ[MAX_CHILDREN];
+  float m_fMaxX[MAX_CHILDREN];
+  float m_fMaxY[MAX_CHILDREN];
+  float m_fMaxZ[MAX_CHILDREN];
+
+  ezSpatialData* m_pData[MAX_CHILDREN];        // set for slots that contain an object
+  ezUInt32 m_uiChildNode[MAX_CHILDREN];        // set for slots that contain another node
+  ezUInt32 m_uiCategoryBitmask[MAX_CHILDREN];  // zero for unused slots
+
+  ezUInt32 m_uiParent;
+  ezUInt32 m_uiSlotInParent;
+  ezUInt32 m_uiNumObjects; // in the whole subtree
+  ezUInt32 m_uiNumChildren;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+EZ_BEGIN_DYNAMIC_REFLECTED_TYPE(ezSpatialSystem_BVH, 1, ezRTTINoAllocator)
+EZ_END_DYNAMIC_REFLECTED_TYPE;
+
+ezSpatialSystem_BVH::ezSpatialSystem_BVH()
+  : m_AlignedAllocator("Spatial System Aligned", ezFoundation::GetAlignedAllocator())
+  , m_Nodes(&m_AlignedAllocator)
+  , m_FreeNodes(&m_Allocator)
+  , m_RebuildObjects(&m_Allocator)
+{
+  EZ_CHECK_AT_COMPILETIME(sizeof(ezSpatialSystem_BVH::SpatialUserData) <= sizeof(ezSpatialData::m_uiUserData));
+
+  m_uiRootNode = AllocateNode(ezInvalidIndex, 0);
+}
+
+ezSpatialSystem_BVH::~ezSpatialSystem_BVH() = default;
+
+void ezSpatialSystem_BVH::GetAllNodeBoxes(ezHybridArray<ezBoundingBox, 16>& out_BoundingBoxes, ezSpatialData::Category filterCategory) const
+{
+  TraverseNodes([&](ezUInt32 uiNodeIndex, ezUInt32 uiDepth) {
+    const Node& node = m_Nodes[uiNodeIndex];
+    if (node.m_uiNumChildren > 0 && (filterCategory == ezInvalidSpatialDataCategory || (node.GetCategoryBitmask() & filterCategory.GetBitmask()) != 0))
+    {
+      const ezSimdBBox bounds = node.GetBounds();
+      out_BoundingBoxes.ExpandAndGetRef().SetElements(ezSimdConversion::ToVec3(bounds.m_Min), ezSimdConversion::ToVec3(bounds.m_Max));
+    }
+  });
+}
+
+ezUInt32 ezSpatialSystem_BVH::GetTreeDepth() const
+{
+  ezUInt32 uiMaxDepth = 0;
+  TraverseNodes([&](ezUInt32 uiNodeIndex, ezUInt32 uiDepth) { uiMaxDepth = ezMath::Max(uiMaxDepth, uiDepth + 1); });
+  return uiMaxDepth;
+}
+
+void ezSpatialSystem_BVH::FindObjectsInSphereInternal(const ezBoundingSphere& sphere, ezUInt32 uiCategoryBitmask, QueryCallback callback, QueryStats* pStats) const
+{
+  ezSimdBSphere simdSphere(ezSimdConversion::ToVec3(sphere.m_vCenter), sphere.m_fRadius);
+
+  const ezSimdVec4f centerX(simdSphere.m_CenterAndRadius.x());
+  const ezSimdVec4f centerY(simdSphere.m_CenterAndRadius.y());
+  const ezSimdVec4f centerZ(simdSphere.m_CenterAndRadius.z());
+  const ezSimdVec4f radiusSquared(simdSphere.m_CenterAndRadius.w() * simdSphere.m_CenterAndRadius.w());
+
+  ezHybridArray<ezUInt32, 64> nodeStack;
+  nodeStack.PushBack(m_uiRootNode);
+
+  while (!nodeStack.IsEmpty())
+  {
+    const Node& node = m_Nodes[nodeStack.PeekBack()];
+    nodeStack.PopBack();
+
+    ezUInt32 mask = node.GetCategorySlotMask(uiCategoryBitmask);
+    if (mask == 0)
+      continue;
+
+    ezSimdVec4f minX, minY, minZ, maxX, maxY, maxZ;
+    node.LoadBoxes(minX, minY, minZ, maxX, maxY, maxZ);
+
+    const ezSimdVec4f dx = centerX.CompMax(minX).CompMin(maxX) - centerX;
+    const ezSimdVec4f dy = centerY.CompMax(minY).CompMin(maxY) - centerY;
+    const ezSimdVec4f dz = centerZ.CompMax(minZ).CompMin(maxZ) - centerZ;
+    const ezSimdVec4f distSquared = dx.CompMul(dx) + dy.CompMul(dy) + dz.CompMul(dz);
+
+    mask &= GetLaneMask(distSquared <= radiusSquared);
+
+    while (mask > 0)
+    {
+      const ezUInt32 i = ezMath::FirstBitLow(mask);
+      mask &= mask - 1;
+
+      const ezSpatialData* pData = node.m_pData[i];
+      if (pData == nullptr)
+      {
+        nodeStack.PushBack(node.m_uiChildNode[i]);
+        continue;
+      }
+
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+      if (pStats != nullptr)
+      {
+        pStats->m_uiNumObjectsTested++;
+      }
+#endif
+
+      if (!simdSphere.Overlaps(pData->m_Bounds.GetSphere()))
+        continue;
+
+      if (callback(pData->m_pObject) == ezVisitorExecution::Stop)
+        return;
+
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+      if (pStats != nullptr)
+      {
+        pStats->m_uiNumObjectsPassed++;
+      }
+#endif
+    }
+  }
+}
+
+void ezSpatialSystem_BVH::FindObjectsInBoxInternal(const ezBoundingBox& box, ezUInt32 uiCategoryBitmask, QueryCallback callback, QueryStats* pStats) const
+{
+  ezSimdBBox simdBox(ezSimdConversion::ToVec3(box.m_vMin), ezSimdConversion::ToVec3(box.m_vMax));
+
+  const ezSimdVec4f queryMinX(simdBox.m_Min.x());
+  const ezSimdVec4f queryMinY(simdBox.m_Min.y());
+  const ezSimdVec4f queryMinZ(simdBox.m_Min.z());
+  const ezSimdVec4f queryMaxX(simdBox.m_Max.x());
+  const ezSimdVec4f queryMaxY(simdBox.m_Max.y());
+  const ezSimdVec4f queryMaxZ(simdBox.m_Max.z());
+
+  ezHybridArray<ezUInt32, 64> nodeStack;
+  nodeStack.PushBack(m_uiRootNode);
+
+  while (!nodeStack.IsEmpty())
+  {
+    const Node& node = m_Nodes[nodeStack.PeekBack()];
+    nodeStack.PopBack();
+
+    ezUInt32 mask = node.GetCategorySlotMask(uiCategoryBitmask);
+    if (mask == 0)
+      continue;
+
+    ezSimdVec4f minX, minY, minZ, maxX, maxY, maxZ;
+    node.LoadBoxes(minX, minY, minZ, maxX, maxY, maxZ);
+
+    const ezSimdVec4b overlapX = (minX <= queryMaxX) && (maxX >= queryMinX);
+    const ezSimdVec4b overlapY = (minY <= queryMaxY) && (maxY >= queryMinY);
+    const ezSimdVec4b overlapZ = (minZ <= queryMaxZ) && (maxZ >= queryMinZ);
+
+    mask &= GetLaneMask(overlapX && overlapY && overlapZ);
+
+    while (mask > 0)
+    {
+      const ezUInt32 i = ezMath::FirstBitLow(mask);
+      mask &= mask - 1;
+
+      const ezSpatialData* pData = node.m_pData[i];
+      if (pData == nullptr)
+      {
+        nodeStack.PushBack(node.m_uiChildNode[i]);
+        continue;
+      }
+
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+      if (pStats != nullptr)
+      {
+        pStats->m_uiNumObjectsTested++;
+      }
+#endif
+
+      if (!simdBox.Overlaps(pData->m_Bounds.GetSphere()) || !simdBox.Overlaps(pData->m_Bounds.GetBox()))
+        continue;
+
+      if (callback(pData->m_pObject) == ezVisitorExecution::Stop)
+        return;
+
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+      if (pStats != nullptr)
+      {
+        pStats->m_uiNumObjectsPassed++;
+      }
+#endif
+    }
+  }
+}
+
+void ezSpatialSystem_BVH::FindVisibleObjectsInternal(const ezFrustum& frustum, ezUInt32 uiCategoryBitmask, ezDynamicArray<const ezGameObject*>& out_Objects, QueryStats* pStats) const
+{
+  PlaneDataSoA planeData;
+  for (ezUInt32 p = 0; p < ezFrustum::PLANE_COUNT; ++p)
+  {
+    const ezPlane& plane = frustum.GetPlane(static_cast<ezUInt8>(p));
+    planeData.m_NormalX[p] = ezSimdVec4f(plane.m_vNormal.x);
+    planeData.m_NormalY[p] = ezSimdVec4f(plane.m_vNormal.y);
+    planeData.m_NormalZ[p] = ezSimdVec4f(plane.m_vNormal.z);
+    planeData.m_NegDistance[p] = ezSimdVec4f(plane.m_fNegDistance);
+  }
+
+  const ezSimdVec4f half(0.5f);
+
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+  ezUInt32 uiNumObjectsTested = 0;
+  ezUInt32 uiNumObjectsPassed = 0;
+#endif
+
+  ezHybridArray<ezUInt32, 64> nodeStack;
+  nodeStack.PushBack(m_uiRootNode);
+
+  while (!nodeStack.IsEmpty())
+  {
+    const Node& node = m_Nodes[nodeStack.PeekBack()];
+    nodeStack.PopBack();
+
+    ezUInt32 mask = node.GetCategorySlotMask(uiCategoryBitmask);
+    if (mask == 0)
+      continue;
+
+    ezSimdVec4f minX, minY, minZ, maxX, maxY, maxZ;
+    node.LoadBoxes(minX, minY, minZ, maxX, maxY, maxZ);
+
+    const ezUInt32 objectMask = node.GetObjectSlotMask() & mask;
+
+    if (objectMask != mask)
+    {
+      // child nodes: a box is outside, if even its corner that is furthest inside lies outside of one plane
+      ezSimdVec4b outside(false);
+      for (ezUInt32 p = 0; p < ezFrustum::PLANE_COUNT; ++p)
+      {
+        ezSimdVec4f dist = planeData.m_NegDistance[p];
+        dist += planeData.m_NormalX[p].CompMul(minX).CompMin(planeData.m_NormalX[p].CompMul(maxX));
+        dist += planeData.m_NormalY[p].CompMul(minY).CompMin(planeData.m_NormalY[p].CompMul(maxY));
+        dist += planeData.m_NormalZ[p].CompMul(minZ).CompMin(planeData.m_NormalZ[p].CompMul(maxZ));
+
+        outside = outside || (dist > ezSimdVec4f::ZeroVector());
+      }
+
+      const ezUInt32 nodeMask = (mask & ~objectMask) & ~GetLaneMask(outside);
+
+      ezUInt32 childMask = nodeMask;
+      while (childMask > 0)
+      {
+        const ezUInt32 i = ezMath::FirstBitLow(childMask);
+        childMask &= childMask - 1;
+
+        nodeStack.PushBack(node.m_uiChildNode[i]);
+      }
+    }
+
+    if (objectMask != 0)
+    {
+      // objects: the boxes of objects enclose their bounding spheres tightly, so the spheres can be reconstructed and tested directly
+      const ezSimdVec4f centerX = (minX + maxX).CompMul(half);
+      const ezSimdVec4f centerY = (minY + maxY).CompMul(half);
+      const ezSimdVec4f centerZ = (minZ + maxZ).CompMul(half);
+      const ezSimdVec4f radius = (maxX - minX).CompMul(half);
+
+      ezSimdVec4b outside(false);
+      for (ezUInt32 p = 0; p < ezFrustum::PLANE_COUNT; ++p)
+      {
+        ezSimdVec4f dist = ezSimdVec4f::MulAdd(centerX, planeData.m_NormalX[p], planeData.m_NegDistance[p]);
+        dist = ezSimdVec4f::MulAdd(centerY, planeData.m_NormalY[p], dist);
+        dist = ezSimdVec4f::MulAdd(centerZ, planeData.m_NormalZ[p], dist);
+
+        outside = outside || (dist > radius);
+      }
+
+      ezUInt32 visibleMask = objectMask & ~GetLaneMask(outside);
+
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+      uiNumObjectsTested += ezMath::CountBits(objectMask);
+      uiNumObjectsPassed += ezMath::CountBits(visibleMask);
+#endif
+
+      while (visibleMask > 0)
+      {
+        const ezUInt32 i = ezMath::FirstBitLow(visibleMask);
+        visibleMask &= visibleMask - 1;
+
+        out_Objects.PushBack(node.m_pData[i]->m_pObject);
+      }
+    }
+  }
+
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+  if (pStats != nullptr)
+  {
+    pStats->m_uiNumObjectsTested = uiNumObjectsTested;
+    pStats->m_uiNumObjectsPassed = uiNumObjectsPassed;
+  }
+#endif
+}
+
+void ezSpatialSystem_BVH::SpatialDataAdded(ezSpatialData* pData)
+{
+  InsertObject(pData);
+}
+
+void ezSpatialSystem_BVH::SpatialDataRemoved(ezSpatialData* pData)
+{
+  RemoveObject(pData);
+}
+
+void ezSpatialSystem_BVH::SpatialDataChanged(ezSpatialData* pData, const ezSimdBBoxSphere& oldBounds, ezUInt32 uiOldCategoryBitmask)
+{
+  auto pUserData = reinterpret_cast<SpatialUserData*>(&pData->m_uiUserData[0]);
+
+  // objects are not in the tree while their category bitmask is 0
+  if (pUserData->m_uiNodeIndex == ezInvalidIndex)
+  {
+    if (pData->m_uiCategoryBitmask != 0)
+    {
+      InsertObject(pData);
+    }
+
+    return;
+  }
+
+  if (pData->m_uiCategoryBitmask == uiOldCategoryBitmask)
+  {
+    const ezUInt32 uiNodeIndex = pUserData->m_uiNodeIndex;
+
+    const ezSimdBBox newBox = GetObjectBox(pData);
+
+    // as long as the object stays within its node, only the boxes along the path to the root need to be refitted
+    // otherwise the object would enlarge the node more and more, so it is better to find a new place for it
+    if (uiNodeIndex == m_uiRootNode || m_Nodes[uiNodeIndex].GetBounds().Contains(newBox))
+    {
+      m_Nodes[uiNodeIndex].SetSlotBox(pUserData->m_uiSlot, newBox);
+      Refit(uiNodeIndex);
+    }
+    else
+    {
+      RemoveObject(pData);
+      InsertObject(pData);
+    }
+  }
+  else
+  {
+    RemoveObject(pData);
+
+    if (pData->m_uiCategoryBitmask != 0)
+    {
+      InsertObject(pData);
+    }
+  }
+}
+
+void ezSpatialSystem_BVH::FixSpatialDataPointer(ezSpatialData* pOldPtr, ezSpatialData* pNewPtr)
+{
+  auto pUserData = reinterpret_cast<SpatialUserData*>(&pNewPtr->m_uiUserData[0]);
+  if (pUserData->m_uiNodeIndex != ezInvalidIndex)
+  {
+    Node& node = m_Nodes[pUserData->m_uiNodeIndex];
+    EZ_ASSERT_DEBUG(node.m_pData[pUserData->m_uiSlot] == pOldPtr, "Implementation error");
+
+    node.m_pData[pUserData->m_uiSlot] = pNewPtr;
+  }
+}
+
+ezUInt32 ezSpatialSystem_BVH::AllocateNode(ezUInt32 uiParent, ezUInt32 uiSlotInParent)
+{
+  ezUInt32 uiNodeIndex;
+  if (!m_FreeNodes.IsEmpty())
+  {
+    uiNodeIndex = m_FreeNodes.PeekBack();
+    m_FreeNodes.PopBack();
+  }
+  else
+  {
+    uiNodeIndex = m_Nodes.GetCount();
+    m_Nodes.ExpandAndGetRef();
+  }
+
+  m_Nodes[uiNodeIndex].Reset(uiParent, uiSlotInParent);
+  return uiNodeIndex;
+}
+
+void ezSpatialSystem_BVH::FreeNode(ezUInt32 uiNodeIndex)
+{
+  EZ_ASSERT_DEBUG(uiNodeIndex != m_uiRootNode, "The root node must not be freed");
+
+  m_Nodes[uiNodeIndex].Reset(ezInvalidIndex, 0);
+  m_FreeNodes.PushBack(uiNodeIndex);
+}
+
+void ezSpatialSystem_BVH::SetObjectSlot(ezUInt32 uiNodeIndex, ezUInt32 uiSlot, ezSpatialData* pData)
+{
+  Node& node = m_Nodes[uiNodeIndex];
+  node.SetSlotBox(uiSlot, GetObjectBox(pData));
+  node.m_pData[uiSlot] = pData;
+  node.m_uiChildNode[uiSlot] = ezInvalidIndex;
+  node.m_uiCategoryBitmask[uiSlot] = pData->m_uiCategoryBitmask;
+
+  auto pUserData = reinterpret_cast<SpatialUserData*>(&pData->m_uiUserData[0]);
+  pUserData->m_uiNodeIndex = uiNodeIndex;
+  pUserData->m_uiSlot = uiSlot;
+}
+
+void ezSpatialSystem_BVH::SetNodeSlot(ezUInt32 uiNodeIndex, ezUInt32 uiSlot, ezUInt32 uiChildNodeIndex)
+{
+  Node& child = m_Nodes[uiChildNodeIndex];
+  child.m_uiParent = uiNodeIndex;
+  child.m_uiSlotInParent = uiSlot;
+
+  Node& node = m_Nodes[uiNodeIndex];
+  node.SetSlotBox(uiSlot, child.GetBounds());
+  node.m_pData[uiSlot] = nullptr;
+  node.m_uiChildNode[uiSlot] = uiChildNodeIndex;
+  node.m_uiCategoryBitmask[uiSlot] = child.GetCategoryBitmask();
+}
+
+void ezSpatialSystem_BVH::RemoveSlot(ezUInt32 uiNodeIndex, ezUInt32 uiSlot)
+{
+  Node& node = m_Nodes[uiNodeIndex];
+  const ezUInt32 uiLastSlot = node.m_uiNumChildren - 1;
+
+  // keep the used slots packed at the front
+  if (uiSlot != uiLastSlot)
+  {
+    node.CopySlot(uiSlot, uiLastSlot);
+
+    if (ezSpatialData* pMovedData = node.m_pData[uiSlot])
+    {
+      reinterpret_cast<SpatialUserData*>(&pMovedData->m_uiUserData[0])->m_uiSlot = uiSlot;
+    }
+    else
+    {
+      m_Nodes[node.m_uiChildNode[uiSlot]].m_uiSlotInParent = uiSlot;
+    }
+  }
+
+  node.ClearSlot(uiLastSlot);
+  node.m_uiNumChildren = uiLastSlot;
+}
+
+void ezSpatialSystem_BVH::InsertObject(ezSpatialData* pData)
+{
+  const ezSimdBBox box = GetObjectBox(pData);
+
+  const ezSimdVec4f boxMinX(box.m_Min.x());
+  const ezSimdVec4f boxMinY(box.m_Min.y());
+  const ezSimdVec4f boxMinZ(box.m_Min.z());
+  const ezSimdVec4f boxMaxX(box.m_Max.x());
+  const ezSimdVec4f boxMaxY(box.m_Max.y());
+  const ezSimdVec4f boxMaxZ(box.m_Max.z());
+
+  ezHybridArray<ezUInt32, 32> path;
+  ezUInt32 uiNodeIndex = m_uiRootNode;
+  ezUInt32 uiRefitNodeIndex = ezInvalidIndex;
+
+  while (true)
+  {
+    path.PushBack(uiNodeIndex);
+
+    Node& node = m_Nodes[uiNodeIndex];
+    node.m_uiNumObjects++;
+
+    if (node.m_uiNumChildren == 0)
+    {
+      SetObjectSlot(uiNodeIndex, node.m_uiNumChildren++, pData);
+      uiRefitNodeIndex = uiNodeIndex;
+      break;
+    }
+
+    // find the child that grows the least (by surface area) when the object is added to it
+    ezSimdVec4f minX, minY, minZ, maxX, maxY, maxZ;
+    node.LoadBoxes(minX, minY, minZ, maxX, maxY, maxZ);
+
+    const ezSimdVec4f oldArea = GetSurfaceArea(maxX - minX, maxY - minY, maxZ - minZ);
+    const ezSimdVec4f newArea = GetSurfaceArea(maxX.CompMax(boxMaxX) - minX.CompMin(boxMinX), maxY.CompMax(boxMaxY) - minY.CompMin(boxMinY), maxZ.CompMax(boxMaxZ) - minZ.CompMin(boxMinZ));
+
+    float fCost[MAX_CHILDREN];
+    (newArea - oldArea).Store<4>(fCost);
+
+    ezUInt32 uiBestSlot = 0;
+    for (ezUInt32 i = 1; i < node.m_uiNumChildren; ++i)
+    {
+      if (fCost[i] < fCost[uiBestSlot])
+        uiBestSlot = i;
+    }
+
+    // if the object does not fit into any child without enlarging it, or the best fit is just another object,
+    // rather add it directly to this node than to make the tree deeper
+    if (node.m_uiNumChildren < MAX_CHILDREN && (fCost[uiBestSlot] > 0.0f || node.m_pData[uiBestSlot] != nullptr))
+    {
+      SetObjectSlot(uiNodeIndex, node.m_uiNumChildren++, pData);
+      uiRefitNodeIndex = uiNodeIndex;
+      break;
+    }
+
+    if (ezSpatialData* pOtherData = node.m_pData[uiBestSlot])
+    {
+      // merge both objects into a new node
+      const ezUInt32 uiNewNodeIndex = AllocateNode(uiNodeIndex, uiBestSlot);
+      Node& newNode = m_Nodes[uiNewNodeIndex];
+      newNode.m_uiNumObjects = 2;
+      newNode.m_uiNumChildren = 2;
+
+      SetObjectSlot(uiNewNodeIndex, 0, pOtherData);
+      SetObjectSlot(uiNewNodeIndex, 1, pData);
+      SetNodeSlot(uiNodeIndex, uiBestSlot, uiNewNodeIndex);
+
+      // the box of the new node is already up-to-date, but not the boxes further up
+      path.PushBack(uiNewNodeIndex);
+      uiRefitNodeIndex = uiNodeIndex;
+      break;
+    }
+
+    uiNodeIndex = node.m_uiChildNode[uiBestSlot];
+  }
+
+  Refit(uiRefitNodeIndex);
+
+  // rebuild the topmost subtree that has become too deep
+  for (ezUInt32 i = 0; i < path.GetCount(); ++i)
+  {
+    const ezUInt32 uiSubtreeDepth = path.GetCount() - i;
+    if (uiSubtreeDepth > GetMaxSubtreeDepth(m_Nodes[path[i]].m_uiNumObjects))
+    {
+      RebuildSubtree(path[i]);
+      break;
+    }
+  }
+}
+
+void ezSpatialSystem_BVH::RemoveObject(ezSpatialData* pData)
+{
+  auto pUserData = reinterpret_cast<SpatialUserData*>(&pData->m_uiUserData[0]);
+  const ezUInt32 uiNodeIndex = pUserData->m_uiNodeIndex;
+  if (uiNodeIndex == ezInvalidIndex)
+    return;
+
+  EZ_ASSERT_DEBUG(m_Nodes[uiNodeIndex].m_pData[pUserData->m_uiSlot] == pData, "Implementation error");
+
+  RemoveSlot(uiNodeIndex, pUserData->m_uiSlot);
+  AdjustObjectCount(uiNodeIndex, -1);
+
+  pUserData->m_uiNodeIndex = ezInvalidIndex;
+  pUserData->m_uiSlot = ezInvalidIndex;
+
+  CollapseNode(uiNodeIndex);
+}
+
+void ezSpatialSystem_BVH::CollapseNode(ezUInt32 uiNodeIndex)
+{
+  if (uiNodeIndex == m_uiRootNode)
+    return;
+
+  const Node& node = m_Nodes[uiNodeIndex];
+  const ezUInt32 uiParent = node.m_uiParent;
+  const ezUInt32 uiSlotInParent = node.m_uiSlotInParent;
+
+  if (node.m_uiNumChildren == 0)
+  {
+    RemoveSlot(uiParent, uiSlotInParent);
+    FreeNode(uiNodeIndex);
+    CollapseNode(uiParent);
+  }
+  else if (node.m_uiNumChildren == 1)
+  {
+    // a node with a single child is useless, move the child up into the parent
+    if (ezSpatialData* pData = node.m_pData[0])
+    {
+      SetObjectSlot(uiParent, uiSlotInParent, pData);
+    }
+    else
+    {
+      SetNodeSlot(uiParent, uiSlotInParent, node.m_uiChildNode[0]);
+    }
+
+    FreeNode(uiNodeIndex);
+    Refit(uiParent);
+  }
+  else
+  {
+    Refit(uiNodeIndex);
+  }
+}
+
+void ezSpatialSystem_BVH::Refit(ezUInt32 uiNodeIndex)
+{
+  while (uiNodeIndex != m_uiRootNode)
+  {
+    const Node& node = m_Nodes[uiNodeIndex];
+    Node& parent = m_Nodes[node.m_uiParent];
+    const ezUInt32 uiSlot = node.m_uiSlotInParent;
+
+    const ezSimdBBox bounds = node.GetBounds();
+    const ezUInt32 uiCategoryBitmask = node.GetCategoryBitmask();
+
+    // once a box doesn't change anymore, the boxes further up won't change either
+    if (parent.GetSlotBox(uiSlot) == bounds && parent.m_uiCategoryBitmask[uiSlot] == uiCategoryBitmask)
+      return;
+
+    parent.SetSlotBox(uiSlot, bounds);
+    parent.m_uiCategoryBitmask[uiSlot] = uiCategoryBitmask;
+
+    uiNodeIndex = node.m_uiParent;
+  }
+}
+
+void ezSpatialSystem_BVH::AdjustObjectCount(ezUInt32 uiNodeIndex, ezInt32 iDelta)
+{
+  while (uiNodeIndex != ezInvalidIndex)
+  {
+    Node& node = m_Nodes[uiNodeIndex];
+    node.m_uiNumObjects += iDelta;
+
+    uiNodeIndex = node.m_uiParent;
+  }
+}
+
+void ezSpatialSystem_BVH::RebuildSubtree(ezUInt32 uiNodeIndex)
+{
+  m_RebuildObjects.Clear();
+  GatherObjects(uiNodeIndex, false);
+
+  const Node& node = m_Nodes[uiNodeIndex];
+  const ezUInt32 uiParent = node.m_uiParent;
+  const ezUInt32 uiSlotInParent = node.m_uiSlotInParent;
+
+  m_Nodes[uiNodeIndex].Reset(uiParent, uiSlotInParent);
+
+  BuildNode(uiNodeIndex, m_RebuildObjects);
+  Refit(uiNodeIndex);
+}
+
+void ezSpatialSystem_BVH::GatherObjects(ezUInt32 uiNodeIndex, bool bFreeNode)
+{
+  const Node& node = m_Nodes[uiNodeIndex];
+
+  for (ezUInt32 i = 0; i < node.m_uiNumChildren; ++i)
+  {
+    if (node.m_pData[i] != nullptr)
+    {
+      m_RebuildObjects.PushBack(node.m_pData[i]);
+    }
+    else
+    {
+      GatherObjects(node.m_uiChildNode[i], true);
+    }
+  }
+
+  if (bFreeNode)
+  {
+    FreeNode(uiNodeIndex);
+  }
+}
+
+void ezSpatialSystem_BVH::BuildNode(ezUInt32 uiNodeIndex, ezArrayPtr<ezSpatialData*> objects)
+{
+  const ezUInt32 uiNumObjects = objects.GetCount();
+  m_Nodes[uiNodeIndex].m_uiNumObjects = uiNumObjects;
+
+  if (uiNumObjects <= MAX_CHILDREN)
+  {
+    for (ezUInt32 i = 0; i < uiNumObjects; ++i)
+    {
+      SetObjectSlot(uiNodeIndex, i, objects[i]);
+    }
+
+    m_Nodes[uiNodeIndex].m_uiNumChildren = uiNumObjects;
+    return;
+  }
+
+  ezArrayPtr<ezSpatialData*> groups[MAX_CHILDREN];
+  {
+    ezArrayPtr<ezSpatialData*> left, right;
+    SplitAtMedian(objects, left, right);
+    SplitAtMedian(left, groups[0], groups[1]);
+    SplitAtMedian(right, groups[2], groups[3]);
+  }
+
+  for (ezUInt32 i = 0; i < MAX_CHILDREN; ++i)
+  {
+    if (groups[i].GetCount() == 1)
+    {
+      SetObjectSlot(uiNodeIndex, i, groups[i][0]);
+    }
+    else
+    {
+      const ezUInt32 uiChildNodeIndex = AllocateNode(uiNodeIndex, i);
+      BuildNode(uiChildNodeIndex, groups[i]);
+      SetNodeSlot(uiNodeIndex, i, uiChildNodeIndex);
+    }
+  }
+
+  m_Nodes[uiNodeIndex].m_uiNumChildren = MAX_CHILDREN;
+}
+
+template <typename Functor>
+void ezSpatialSystem_BVH::TraverseNodes(Functor func) const
+{
+  struct StackEntry
+  {
+    EZ_DECLARE_POD_TYPE();
+
+    ezUInt32 m_uiNodeIndex;
+    ezUInt32 m_uiDepth;
+  };
+
+  ezHybridArray<StackEntry, 64> nodeStack;
+  nodeStack.PushBack({m_uiRootNode, 0});
+
+  while (!nodeStack.IsEmpty())
+  {
+    const StackEntry entry = nodeStack.PeekBack();
+    nodeStack.PopBack();
+
+    func(entry.m_uiNodeIndex, entry.m_uiDepth);
+
+    const Node& node = m_Nodes[entry.m_uiNodeIndex];
+    for (ezUInt32 i = 0; i < node.m_uiNumChildren; ++i)
+    {
+      if (node.m_pData[i] == nullptr)
+      {
+        nodeStack.PushBack({node.m_uiChildNode[i], entry.m_uiDepth + 1});
+      }
+    }
+  }
+}
+
+
+EZ_STATICLINK_FILE(Core, Core_World_Implementation_SpatialSystem_BVH);
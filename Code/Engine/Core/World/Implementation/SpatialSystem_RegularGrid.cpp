@@ -3,6 +3,7 @@
 #include <Core/World/SpatialSystem_RegularGrid.h>
 #include <Foundation/Containers/HashSet.h>
 #include <Foundation/SimdMath/SimdConversion.h>
+#include <Foundation/Threading/TaskSystem.h>
 
 namespace
 {
@@ -53,6 +54,48 @@ namespace
     ezSimdVec4f m_w4w5w4w5;
   };
 
+  EZ_FORCE_INLINE ezSimdBBox ComputeFrustumBoundingBox(const ezFrustum& frustum)
+  {
+    ezVec3 cornerPoints[8];
+    frustum.ComputeCornerPoints(cornerPoints);
+
+    ezSimdVec4f simdCornerPoints[8];
+    for (ezUInt32 i = 0; i < 8; ++i)
+    {
+      simdCornerPoints[i] = ezSimdConversion::ToVec3(cornerPoints[i]);
+    }
+
+    ezSimdBBox simdBox;
+    simdBox.SetFromPoints(simdCornerPoints, 8);
+    return simdBox;
+  }
+
+  EZ_FORCE_INLINE void ComputePlaneData(const ezFrustum& frustum, PlaneData& out_PlaneData)
+  {
+    // Compiler is too stupid to properly unroll a constant loop so we do it by hand
+    ezSimdVec4f plane0 = ezSimdConversion::ToVec4(*reinterpret_cast<const ezVec4*>(&(frustum.GetPlane(0).m_vNormal.x)));
+    ezSimdVec4f plane1 = ezSimdConversion::ToVec4(*reinterpret_cast<const ezVec4*>(&(frustum.GetPlane(1).m_vNormal.x)));
+    ezSimdVec4f plane2 = ezSimdConversion::ToVec4(*reinterpret_cast<const ezVec4*>(&(frustum.GetPlane(2).m_vNormal.x)));
+    ezSimdVec4f plane3 = ezSimdConversion::ToVec4(*reinterpret_cast<const ezVec4*>(&(frustum.GetPlane(3).m_vNormal.x)));
+    ezSimdVec4f plane4 = ezSimdConversion::ToVec4(*reinterpret_cast<const ezVec4*>(&(frustum.GetPlane(4).m_vNormal.x)));
+    ezSimdVec4f plane5 = ezSimdConversion::ToVec4(*reinterpret_cast<const ezVec4*>(&(frustum.GetPlane(5).m_vNormal.x)));
+
+    ezSimdMat4f helperMat;
+    helperMat.SetRows(plane0, plane1, plane2, plane3);
+
+    out_PlaneData.m_x0x1x2x3 = helperMat.m_col0;
+    out_PlaneData.m_y0y1y2y3 = helperMat.m_col1;
+    out_PlaneData.m_z0z1z2z3 = helperMat.m_col2;
+    out_PlaneData.m_w0w1w2w3 = helperMat.m_col3;
+
+    helperMat.SetRows(plane4, plane5, plane4, plane5);
+
+    out_PlaneData.m_x4x5x4x5 = helperMat.m_col0;
+    out_PlaneData.m_y4y5y4y5 = helperMat.m_col1;
+    out_PlaneData.m_z4z5z4z5 = helperMat.m_col2;
+    out_PlaneData.m_w4w5w4w5 = helperMat.m_col3;
+  }
+
   EZ_FORCE_INLINE bool SphereFrustumIntersect(const ezSimdBSphere& sphere, const PlaneData& planeData)
   {
     ezSimdVec4f pos_xxxx(sphere.m_CenterAndRadius.x());
@@ -452,43 +495,10 @@ void ezSpatialSystem_RegularGrid::FindObjectsInBoxInternal(const ezBoundingBox&
 void ezSpatialSystem_RegularGrid::FindVisibleObjectsInternal(const ezFrustum& frustum, ezUInt32 uiCategoryBitmask, ezDynamicArray<const ezGameObject*>& out_Objects,
   QueryStats* pStats) const
 {
-  ezVec3 cornerPoints[8];
-  frustum.ComputeCornerPoints(cornerPoints);
-
-  ezSimdVec4f simdCornerPoints[8];
-  for (ezUInt32 i = 0; i < 8; ++i)
-  {
-    simdCornerPoints[i] = ezSimdConversion::ToVec3(cornerPoints[i]);
-  }
-
-  ezSimdBBox simdBox;
-  simdBox.SetFromPoints(simdCornerPoints, 8);
+  ezSimdBBox simdBox = ComputeFrustumBoundingBox(frustum);
 
   PlaneData planeData;
-  {
-    // Compiler is too stupid to properly unroll a constant loop so we do it by hand
-    ezSimdVec4f plane0 = ezSimdConversion::ToVec4(*reinterpret_cast<const ezVec4*>(&(frustum.GetPlane(0).m_vNormal.x)));
-    ezSimdVec4f plane1 = ezSimdConversion::ToVec4(*reinterpret_cast<const ezVec4*>(&(frustum.GetPlane(1).m_vNormal.x)));
-    ezSimdVec4f plane2 = ezSimdConversion::ToVec4(*reinterpret_cast<const ezVec4*>(&(frustum.GetPlane(2).m_vNormal.x)));
-    ezSimdVec4f plane3 = ezSimdConversion::ToVec4(*reinterpret_cast<const ezVec4*>(&(frustum.GetPlane(3).m_vNormal.x)));
-    ezSimdVec4f plane4 = ezSimdConversion::ToVec4(*reinterpret_cast<const ezVec4*>(&(frustum.GetPlane(4).m_vNormal.x)));
-    ezSimdVec4f plane5 = ezSimdConversion::ToVec4(*reinterpret_cast<const ezVec4*>(&(frustum.GetPlane(5).m_vNormal.x)));
-
-    ezSimdMat4f helperMat;
-    helperMat.SetRows(plane0, plane1, plane2, plane3);
-
-    planeData.m_x0x1x2x3 = helperMat.m_col0;
-    planeData.m_y0y1y2y3 = helperMat.m_col1;
-    planeData.m_z0z1z2z3 = helperMat.m_col2;
-    planeData.m_w0w1w2w3 = helperMat.m_col3;
-
-    helperMat.SetRows(plane4, plane5, plane4, plane5);
-
-    planeData.m_x4x5x4x5 = helperMat.m_col0;
-    planeData.m_y4y5y4y5 = helperMat.m_col1;
-    planeData.m_z4z5z4z5 = helperMat.m_col2;
-    planeData.m_w4w5w4w5 = helperMat.m_col3;
-  }
+  ComputePlaneData(frustum, planeData);
 
 #if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
   ezUInt32 uiNumObjectsTested = 0;
@@ -574,6 +584,258 @@ void ezSpatialSystem_RegularGrid::FindVisibleObjectsInternal(const ezFrustum& fr
 #endif
 }
 
+void ezSpatialSystem_RegularGrid::FindVisibleObjectsBatchInternal(ezArrayPtr<const ezFrustum> frusta, ezUInt32 uiCategoryBitmask,
+  ezArrayPtr<ezDynamicArray<const ezGameObject*>> out_ObjectsPerFrustum, QueryStats* pStats) const
+{
+  // The visibility of an object for all frusta of one batch is stored in a 32 bit mask
+  constexpr ezUInt32 uiMaxFrustaPerBatch = 32;
+
+  const ezUInt32 uiNumFrusta = frusta.GetCount();
+  if (uiNumFrusta > uiMaxFrustaPerBatch)
+  {
+    for (ezUInt32 uiFirstFrustum = 0; uiFirstFrustum < uiNumFrusta; uiFirstFrustum += uiMaxFrustaPerBatch)
+    {
+      const ezUInt32 uiCount = ezMath::Min(uiNumFrusta - uiFirstFrustum, uiMaxFrustaPerBatch);
+      FindVisibleObjectsBatchInternal(frusta.GetSubArray(uiFirstFrustum, uiCount), uiCategoryBitmask,
+        out_ObjectsPerFrustum.GetSubArray(uiFirstFrustum, uiCount), pStats);
+    }
+    return;
+  }
+
+  struct VisibleObject
+  {
+    EZ_DECLARE_POD_TYPE();
+
+    const ezGameObject* m_pObject;
+    ezUInt32 m_uiFrustumMask;
+  };
+
+  struct Chunk
+  {
+    ezUInt32 m_uiFirstCell = 0;
+    ezUInt32 m_uiNumCells = 0;
+    ezUInt32 m_uiNumObjectsTested = 0;
+    ezDynamicArray<VisibleObject> m_VisibleObjects;
+  };
+
+  struct BatchContext
+  {
+    PlaneData m_PlaneData[uiMaxFrustaPerBatch];
+    ezSimdBBox m_FrustumBoxes[uiMaxFrustaPerBatch];
+    ezUInt32 m_uiNumFrusta = 0;
+    ezUInt32 m_uiCategoryBitmask = 0;
+
+    ezDynamicArray<const Cell*> m_Cells;
+    ezDynamicArray<Chunk> m_Chunks;
+    ezArrayPtr<ezDynamicArray<const ezGameObject*>> m_ObjectsPerFrustum;
+  };
+
+  BatchContext context;
+  context.m_uiNumFrusta = uiNumFrusta;
+  context.m_uiCategoryBitmask = uiCategoryBitmask;
+  context.m_ObjectsPerFrustum = out_ObjectsPerFrustum;
+
+  ezSimdBBox unionBox;
+  unionBox.SetInvalid();
+
+  for (ezUInt32 i = 0; i < uiNumFrusta; ++i)
+  {
+    context.m_FrustumBoxes[i] = ComputeFrustumBoundingBox(frusta[i]);
+    ComputePlaneData(frusta[i], context.m_PlaneData[i]);
+
+    unionBox.ExpandToInclude(context.m_FrustumBoxes[i]);
+  }
+
+  // Gather all cells that overlap any of the frusta. If the frusta are far apart, walking the union box
+  // would look up more cells than exist, so in that case all existing cells are filtered directly.
+  {
+    auto OverlapsAnyFrustumBox = [&](const Cell& cell) {
+      ezSimdBBox cellBox = cell.m_Bounds.GetBox();
+      for (ezUInt32 i = 0; i < uiNumFrusta; ++i)
+      {
+        if (cellBox.Overlaps(context.m_FrustumBoxes[i]))
+          return true;
+      }
+      return false;
+    };
+
+    ezSimdVec4i minIndex = ToVec3I32((unionBox.m_Min - m_fOverlapSize) * m_fInvCellSize);
+    ezSimdVec4i maxIndex = ToVec3I32((unionBox.m_Max + m_fOverlapSize) * m_fInvCellSize);
+    ezSimdVec4i diff = maxIndex - minIndex + ezSimdVec4i(1);
+    const ezUInt64 uiNumCellsInUnionBox = ezUInt64(diff.x()) * ezUInt64(diff.y()) * ezUInt64(diff.z());
+
+    if (uiNumCellsInUnionBox > m_Cells.GetCount())
+    {
+      for (auto it = m_Cells.GetIterator(); it.IsValid(); ++it)
+      {
+        const Cell& cell = *it.Value();
+        if ((cell.m_uiCategoryBitmask & uiCategoryBitmask) != 0 && OverlapsAnyFrustumBox(cell))
+        {
+          context.m_Cells.PushBack(&cell);
+        }
+      }
+
+      if ((m_pOverflowCell->m_uiCategoryBitmask & uiCategoryBitmask) != 0)
+      {
+        context.m_Cells.PushBack(m_pOverflowCell.Borrow());
+      }
+    }
+    else
+    {
+      ForEachCellInBox(unionBox, uiCategoryBitmask, [&](const ezSimdVec4i& cellIndex, ezUInt64 cellKey, const Cell& cell, ezUInt32 uiFilteredCategoryBitmask) {
+        if (&cell == m_pOverflowCell.Borrow() || OverlapsAnyFrustumBox(cell))
+        {
+          context.m_Cells.PushBack(&cell);
+        }
+      });
+    }
+  }
+
+  // Split the cells into chunks which are culled in parallel. Every chunk writes into its own result array,
+  // which keeps the output order deterministic regardless of how the chunks are scheduled.
+  {
+    constexpr ezUInt32 uiMinCellsPerChunk = 4;
+    constexpr ezUInt32 uiMaxChunks = 64;
+
+    const ezUInt32 uiNumCells = context.m_Cells.GetCount();
+    const ezUInt32 uiCellsPerChunk = ezMath::Max(uiMinCellsPerChunk, (uiNumCells + uiMaxChunks - 1) / uiMaxChunks);
+    const ezUInt32 uiNumChunks = (uiNumCells + uiCellsPerChunk - 1) / uiCellsPerChunk;
+
+    context.m_Chunks.SetCount(uiNumChunks);
+    for (ezUInt32 i = 0; i < uiNumChunks; ++i)
+    {
+      Chunk& chunk = context.m_Chunks[i];
+      chunk.m_uiFirstCell = i * uiCellsPerChunk;
+      chunk.m_uiNumCells = ezMath::Min(uiCellsPerChunk, uiNumCells - chunk.m_uiFirstCell);
+    }
+  }
+
+  ezTaskSystem::ParallelForIndexed(0, context.m_Chunks.GetCount(), [&context](ezUInt32 uiStartIndex, ezUInt32 uiEndIndex) {
+    const PlaneData* planeData = context.m_PlaneData;
+
+    for (ezUInt32 uiChunkIndex = uiStartIndex; uiChunkIndex < uiEndIndex; ++uiChunkIndex)
+    {
+      Chunk& chunk = context.m_Chunks[uiChunkIndex];
+
+      for (ezUInt32 uiCellIndex = chunk.m_uiFirstCell; uiCellIndex < chunk.m_uiFirstCell + chunk.m_uiNumCells; ++uiCellIndex)
+      {
+        const Cell& cell = *context.m_Cells[uiCellIndex];
+
+        // Each cell is only touched once and tested against all frusta, objects are then only tested against the frusta that see the cell.
+        ezUInt32 uiCellFrustumMask = 0;
+        ezSimdBSphere cellSphere = cell.m_Bounds.GetSphere();
+        for (ezUInt32 i = 0; i < context.m_uiNumFrusta; ++i)
+        {
+          uiCellFrustumMask |= SphereFrustumIntersect(cellSphere, planeData[i]) ? (1u << i) : 0;
+        }
+
+        if (uiCellFrustumMask == 0)
+          continue;
+
+        ezUInt32 filteredMask = cell.m_uiCategoryBitmask & context.m_uiCategoryBitmask;
+        while (filteredMask > 0)
+        {
+          ezUInt32 category = ezMath::FirstBitLow(filteredMask);
+          filteredMask &= filteredMask - 1;
+
+          auto& boundingSpheres = cell.m_BoundingSpheres[category];
+          auto& dataPointers = cell.m_DataPointers[category];
+
+          const ezUInt32 numSpheres = boundingSpheres.GetCount();
+          chunk.m_uiNumObjectsTested += numSpheres;
+
+          ezUInt32 currentIndex = 0;
+          for (; currentIndex + 1 < numSpheres; currentIndex += 2)
+          {
+            auto& objectSphereA = boundingSpheres[currentIndex + 0];
+            auto& objectSphereB = boundingSpheres[currentIndex + 1];
+
+            ezUInt32 uiMaskA = 0;
+            ezUInt32 uiMaskB = 0;
+
+            ezUInt32 frustumMask = uiCellFrustumMask;
+            while (frustumMask > 0)
+            {
+              ezUInt32 i = ezMath::FirstBitLow(frustumMask);
+              frustumMask &= frustumMask - 1;
+
+              ezUInt32 result = SphereFrustumIntersect(objectSphereA, objectSphereB, planeData[i]);
+              uiMaskA |= (result & 1) << i;
+              uiMaskB |= (result >> 1) << i;
+            }
+
+            if (uiMaskA != 0)
+            {
+              chunk.m_VisibleObjects.PushBack({dataPointers[currentIndex + 0]->m_pObject, uiMaskA});
+            }
+
+            if (uiMaskB != 0)
+            {
+              chunk.m_VisibleObjects.PushBack({dataPointers[currentIndex + 1]->m_pObject, uiMaskB});
+            }
+          }
+
+          if (currentIndex < numSpheres)
+          {
+            auto& objectSphere = boundingSpheres[currentIndex];
+
+            ezUInt32 uiMask = 0;
+
+            ezUInt32 frustumMask = uiCellFrustumMask;
+            while (frustumMask > 0)
+            {
+              ezUInt32 i = ezMath::FirstBitLow(frustumMask);
+              frustumMask &= frustumMask - 1;
+
+              uiMask |= SphereFrustumIntersect(objectSphere, planeData[i]) ? (1u << i) : 0;
+            }
+
+            if (uiMask != 0)
+            {
+              chunk.m_VisibleObjects.PushBack({dataPointers[currentIndex]->m_pObject, uiMask});
+            }
+          }
+        }
+      }
+    }
+  }, "SpatialSystem Cull Cells");
+
+  // Distribute the results to the output arrays, each frustum is handled independently.
+  ezTaskSystem::ParallelForIndexed(0, uiNumFrusta, [&context](ezUInt32 uiStartIndex, ezUInt32 uiEndIndex) {
+    for (ezUInt32 i = uiStartIndex; i < uiEndIndex; ++i)
+    {
+      const ezUInt32 uiFrustumBit = 1u << i;
+      auto& out_Objects = context.m_ObjectsPerFrustum[i];
+
+      for (const Chunk& chunk : context.m_Chunks)
+      {
+        for (const VisibleObject& visibleObject : chunk.m_VisibleObjects)
+        {
+          if ((visibleObject.m_uiFrustumMask & uiFrustumBit) != 0)
+          {
+            out_Objects.PushBack(visibleObject.m_pObject);
+          }
+        }
+      }
+    }
+  }, "SpatialSystem Gather Visible Objects");
+
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+  if (pStats != nullptr)
+  {
+    for (const Chunk& chunk : context.m_Chunks)
+    {
+      pStats->m_uiNumObjectsTested += chunk.m_uiNumObjectsTested;
+
+      for (const VisibleObject& visibleObject : chunk.m_VisibleObjects)
+      {
+        pStats->m_uiNumObjectsPassed += ezMath::CountBits(visibleObject.m_uiFrustumMask);
+      }
+    }
+  }
+#endif
+}
+
 void ezSpatialSystem_RegularGrid::SpatialDataAdded(ezSpatialData* pData)
 {
   Cell* pCell = GetOrCreateCell(pData->m_Bounds);
@@ -596,6 +858,12 @@ void ezSpatialSystem_RegularGrid::SpatialDataChanged(ezSpatialData* pData, const
     auto pUserData = reinterpret_cast<SpatialUserData*>(&pData->m_uiUserData[0]);
 
     Cell* pOldCell = pUserData->m_pCell;
+    if (pOldCell == nullptr)
+    {
+      // data with an empty category bitmask is not stored in any cell
+      return;
+    }
+
     if (pOldCell->m_Bounds.GetBox().Contains(pData->m_Bounds.GetBox()))
     {
       pOldCell->UpdateData(pData);
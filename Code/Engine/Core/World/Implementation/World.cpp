@@ -358,8 +358,7 @@ void ezWorld::PostMessage(const ezGameObjectHandle& receiverObject, const ezMess
   }
   else
   {
-    ezMessage* pMsgCopy = pMsgRTTIAllocator->Clone<ezMessage>(&msg, m_Data.m_StackAllocator.GetCurrentAllocator());
-    m_Data.m_MessageQueues[queueType].Enqueue(pMsgCopy, metaData);
+    m_Data.QueueMessage(msg, metaData, queueType);
   }
 }
 
@@ -384,8 +383,7 @@ void ezWorld::PostMessage(const ezComponentHandle& receiverComponent, const ezMe
   }
   else
   {
-    ezMessage* pMsgCopy = pMsgRTTIAllocator->Clone<ezMessage>(&msg, m_Data.m_StackAllocator.GetCurrentAllocator());
-    m_Data.m_MessageQueues[queueType].Enqueue(pMsgCopy, metaData);
+    m_Data.QueueMessage(msg, metaData, queueType);
   }
 }
 
@@ -525,7 +523,7 @@ void ezWorld::Update()
   }
 
   // Swap our double buffered stack allocator
-  m_Data.m_StackAllocator.Swap();
+  m_Data.SwapStackAllocator();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -834,19 +832,21 @@ void ezWorld::ProcessQueuedMessages(ezObjectMsgQueueType::Enum queueType)
     }
   };
 
-  // regular messages
+  // regular messages, messages that are posted to the same queue while processing are handled in the next round
+  while (m_Data.TakeQueuedMessages(queueType))
   {
-    ezInternal::WorldData::MessageQueue& queue = m_Data.m_MessageQueues[queueType];
-    queue.Sort(MessageComparer());
+    auto& messages = m_Data.m_MessagesToProcess;
+    messages.Sort(MessageComparer());
 
-    for (ezUInt32 i = 0; i < queue.GetCount(); ++i)
+    for (ezUInt32 i = 0; i < messages.GetCount(); ++i)
     {
-      ProcessQueuedMessage(queue[i]);
+      ProcessQueuedMessage(messages[i]);
 
-      // no need to deallocate these messages, they are allocated through a frame allocator
+      // no need to deallocate these messages, their memory belongs to the stack allocator
+      messages[i].m_pMessage->~ezMessage();
     }
 
-    queue.Clear();
+    messages.Clear();
   }
 
   // timed messages
@@ -1,10 +1,117 @@
 #include <CorePCH.h>
 
+#include <Core/World/SpatialSystem_BVH.h>
 #include <Core/World/SpatialSystem_RegularGrid.h>
 #include <Core/World/World.h>
 
 #include <Foundation/Time/DefaultTimeStepSmoothing.h>
 
+namespace
+{
+  /// Hands out the memory for the message copies of the calling thread from chunks of a world's stack allocator, so that
+  /// posting a message does not need to take the lock of the stack allocator for every message.
+  /// Destructors are not tracked, queued messages are destructed right after they have been processed.
+  class ezQueuedMessageArena : public ezAllocatorBase
+  {
+  public:
+    enum
+    {
+      ChunkSize = 16 * 1024,
+      ChunkAlignment = 16,
+      MaxChunkAllocationSize = ChunkSize / 4,
+    };
+
+    EZ_ALWAYS_INLINE bool IsOwnedBy(const void* pOwner) const { return m_pOwner == pOwner; }
+
+    void SetChunkAllocator(const void* pOwner, ezAllocatorBase* pChunkAllocator, ezUInt64 uiGeneration)
+    {
+      if (m_uiGeneration != uiGeneration)
+      {
+        // the remaining space of the previous chunk is lost, it is freed together with its stack allocator
+        m_pOwner = pOwner;
+        m_pChunkAllocator = pChunkAllocator;
+        m_uiGeneration = uiGeneration;
+        m_pNextAllocation = nullptr;
+        m_pChunkEnd = nullptr;
+      }
+    }
+
+    virtual void* Allocate(size_t uiSize, size_t uiAlign, ezMemoryUtils::DestructorFunction destructorFunc) override
+    {
+      EZ_ASSERT_DEBUG(uiAlign <= ChunkAlignment, "Alignment of {0} bytes is not supported for queued messages", uiAlign);
+
+      if (uiSize > MaxChunkAllocationSize)
+      {
+        return m_pChunkAllocator->Allocate(uiSize, uiAlign, nullptr);
+      }
+
+      ezUInt8* pAllocation = m_pNextAllocation != nullptr ? ezMemoryUtils::Align(m_pNextAllocation + uiAlign - 1, uiAlign) : nullptr;
+      if (pAllocation == nullptr || pAllocation + uiSize > m_pChunkEnd)
+      {
+        m_pNextAllocation = static_cast<ezUInt8*>(m_pChunkAllocator->Allocate(ChunkSize, ChunkAlignment, nullptr));
+        m_pChunkEnd = m_pNextAllocation + ChunkSize;
+        pAllocation = m_pNextAllocation;
+      }
+
+      m_pNextAllocation = pAllocation + uiSize;
+      return pAllocation;
+    }
+
+    virtual void Deallocate(void* ptr) override
+    {
+      // freed together with the stack allocator
+    }
+
+    virtual size_t AllocatedSize(const void* ptr) override { return 0; }
+    virtual ezAllocatorId GetId() const override { return ezAllocatorId(); }
+    virtual Stats GetStats() const override { return Stats(); }
+
+  private:
+    const void* m_pOwner = nullptr;
+    ezAllocatorBase* m_pChunkAllocator = nullptr;
+    ezUInt64 m_uiGeneration = 0;
+    ezUInt8* m_pNextAllocation = nullptr;
+    ezUInt8* m_pChunkEnd = nullptr;
+  };
+
+  /// Each thread keeps one arena per world it posts to, so that posting to several worlds in turn does not start a new chunk on every switch.
+  /// If a thread posts to more worlds than that, the least recently claimed arena is handed over to the next world.
+  static constexpr ezUInt32 s_uiMaxQueuedMessageArenasPerThread = 4;
+  static thread_local ezQueuedMessageArena s_QueuedMessageArenas[s_uiMaxQueuedMessageArenasPerThread];
+  static thread_local ezUInt32 s_uiNextQueuedMessageArena = 0;
+
+  // shared by all worlds, so that a thread never mistakes the chunk of a deleted world for one of a new world
+  static ezAtomicInteger64 s_iMessageChunkGeneration;
+
+  ezQueuedMessageArena& GetQueuedMessageArena(const void* pOwner, ezAllocatorBase* pChunkAllocator, ezUInt64 uiGeneration)
+  {
+    for (ezQueuedMessageArena& arena : s_QueuedMessageArenas)
+    {
+      if (arena.IsOwnedBy(pOwner))
+      {
+        arena.SetChunkAllocator(pOwner, pChunkAllocator, uiGeneration);
+        return arena;
+      }
+    }
+
+    ezQueuedMessageArena& arena = s_QueuedMessageArenas[s_uiNextQueuedMessageArena];
+    s_uiNextQueuedMessageArena = (s_uiNextQueuedMessageArena + 1) % s_uiMaxQueuedMessageArenasPerThread;
+
+    arena.SetChunkAllocator(pOwner, pChunkAllocator, uiGeneration);
+    return arena;
+  }
+
+  template <typename T>
+  EZ_ALWAYS_INLINE T* ReadPointerAtomic(T* const& pPointer)
+  {
+#if EZ_ENABLED(EZ_PLATFORM_64BIT)
+    return reinterpret_cast<T*>(ezAtomicUtils::Read(reinterpret_cast<volatile const ezInt64&>(pPointer)));
+#else
+    return reinterpret_cast<T*>(ezAtomicUtils::Read(reinterpret_cast<volatile const ezInt32&>(pPointer)));
+#endif
+  }
+} // namespace
+
 namespace ezInternal
 {
   class DefaultCoordinateSystemProvider : public ezCoordinateSystemProvider
@@ -55,6 +162,13 @@ namespace ezInternal
   {
     m_AllocatorWrapper.Reset();
 
+    for (ezUInt32 i = 0; i < ezObjectMsgQueueType::COUNT; ++i)
+    {
+      m_pQueuedMessages[i] = nullptr;
+    }
+
+    m_uiMessageChunkGeneration = s_iMessageChunkGeneration.Increment();
+
     if (desc.m_uiRandomNumberGeneratorSeed == 0)
     {
       m_Random.InitializeFromCurrentTime();
@@ -90,7 +204,14 @@ namespace ezInternal
 
     if (m_pSpatialSystem == nullptr && desc.m_bAutoCreateSpatialSystem)
     {
-      m_pSpatialSystem = EZ_NEW(ezFoundation::GetAlignedAllocator(), ezSpatialSystem_RegularGrid);
+      if (desc.m_AutoCreatedSpatialSystemType == ezSpatialSystemType::BoundingVolumeHierarchy)
+      {
+        m_pSpatialSystem = EZ_NEW(ezFoundation::GetAlignedAllocator(), ezSpatialSystem_BVH);
+      }
+      else
+      {
+        m_pSpatialSystem = EZ_NEW(ezFoundation::GetAlignedAllocator(), ezSpatialSystem_RegularGrid);
+      }
     }
 
     if (m_pCoordinateSystemProvider == nullptr)
@@ -136,10 +257,13 @@ namespace ezInternal
     for (ezUInt32 i = 0; i < ezObjectMsgQueueType::COUNT; ++i)
     {
       {
-        MessageQueue& queue = m_MessageQueues[i];
+        // The memory of these messages belongs to the stack allocator and thus mustn't (and doesn't need to be) deallocated
+        for (QueuedMsg* pQueuedMsg = m_pQueuedMessages[i]; pQueuedMsg != nullptr; pQueuedMsg = pQueuedMsg->m_pNext)
+        {
+          pQueuedMsg->m_pMessage->~ezMessage();
+        }
 
-        // The messages in this queue are allocated through a frame allocator and thus mustn't (and don't need to be) deallocated
-        queue.Clear();
+        m_pQueuedMessages[i] = nullptr;
       }
 
       {
@@ -155,6 +279,47 @@ namespace ezInternal
     }
   }
 
+  void WorldData::QueueMessage(const ezMessage& msg, const QueuedMsgMetaData& metaData, ezObjectMsgQueueType::Enum queueType) const
+  {
+    ezQueuedMessageArena& arena = GetQueuedMessageArena(this, m_StackAllocator.GetCurrentAllocator(), m_uiMessageChunkGeneration);
+
+    QueuedMsg* pQueuedMsg = EZ_NEW(&arena, QueuedMsg);
+    pQueuedMsg->m_pMessage = msg.GetDynamicRTTI()->GetAllocator()->Clone<ezMessage>(&msg, &arena);
+    pQueuedMsg->m_MetaData = metaData;
+
+    QueuedMsg* pHead = nullptr;
+    do
+    {
+      pHead = ReadPointerAtomic(m_pQueuedMessages[queueType]);
+      pQueuedMsg->m_pNext = pHead;
+    } while (!ezAtomicUtils::TestAndSet(reinterpret_cast<void**>(&m_pQueuedMessages[queueType]), pHead, pQueuedMsg));
+  }
+
+  void WorldData::SwapStackAllocator()
+  {
+    m_StackAllocator.Swap();
+    m_uiMessageChunkGeneration = s_iMessageChunkGeneration.Increment();
+  }
+
+  bool WorldData::TakeQueuedMessages(ezObjectMsgQueueType::Enum queueType)
+  {
+    QueuedMsg* pHead = nullptr;
+    do
+    {
+      pHead = ReadPointerAtomic(m_pQueuedMessages[queueType]);
+    } while (!ezAtomicUtils::TestAndSet(reinterpret_cast<void**>(&m_pQueuedMessages[queueType]), pHead, nullptr));
+
+    for (QueuedMsg* pQueuedMsg = pHead; pQueuedMsg != nullptr; pQueuedMsg = pQueuedMsg->m_pNext)
+    {
+      auto& entry = m_MessagesToProcess.ExpandAndGetRef();
+      entry.m_pMessage = pQueuedMsg->m_pMessage;
+      entry.m_MetaData = pQueuedMsg->m_MetaData;
+      entry.m_uiMessageHash = 0;
+    }
+
+    return pHead != nullptr;
+  }
+
   ezGameObject::TransformationData* WorldData::CreateTransformationData(bool bDynamic, ezUInt32 uiHierarchyLevel)
   {
     Hierarchy& hierarchy = m_Hierarchies[GetHierarchyType(bDynamic)];
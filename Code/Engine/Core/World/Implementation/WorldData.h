@@ -225,9 +225,34 @@ namespace ezInternal
     };
 
     typedef ezMessageQueue<QueuedMsgMetaData, ezLocalAllocatorWrapper> MessageQueue;
-    mutable MessageQueue m_MessageQueues[ezObjectMsgQueueType::COUNT];
     mutable MessageQueue m_TimedMessageQueues[ezObjectMsgQueueType::COUNT];
 
+    /// \brief A message that was posted without a delay, linked into one of the m_pQueuedMessages lists.
+    struct QueuedMsg
+    {
+      QueuedMsg* m_pNext;
+      ezMessage* m_pMessage;
+      QueuedMsgMetaData m_MetaData;
+    };
+
+    /// \brief Copies the message into the calling thread's chunk of m_StackAllocator and pushes it to the given queue without taking a lock.
+    void QueueMessage(const ezMessage& msg, const QueuedMsgMetaData& metaData, ezObjectMsgQueueType::Enum queueType) const;
+
+    /// \brief Swaps m_StackAllocator and makes sure that no thread uses a chunk of the new current allocator for message copies anymore.
+    void SwapStackAllocator();
+
+    /// \brief Removes all messages from the given queue and appends them to m_MessagesToProcess in no particular order.
+    ///
+    /// Returns false if the queue was empty. The messages have to be destructed by the caller once they are processed.
+    bool TakeQueuedMessages(ezObjectMsgQueueType::Enum queueType);
+
+    /// Lock-free lists of the messages that were posted without a delay, in reverse order. Every thread may push to them.
+    mutable QueuedMsg* m_pQueuedMessages[ezObjectMsgQueueType::COUNT];
+    ezDynamicArray<MessageQueue::Entry, ezLocalAllocatorWrapper> m_MessagesToProcess;
+
+    /// Changes whenever m_StackAllocator is swapped, the per thread chunks for message copies must not be used anymore afterwards.
+    ezUInt64 m_uiMessageChunkGeneration;
+
     ezThreadID m_WriteThreadID;
     ezInt32 m_iWriteCounter;
     mutable ezAtomicInteger32 m_iReadCounter;
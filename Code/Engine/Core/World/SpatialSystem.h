@@ -58,6 +58,14 @@ public:
 
   void FindVisibleObjects(const ezFrustum& frustum, ezUInt32 uiCategoryBitmask, ezDynamicArray<const ezGameObject*>& out_Objects, QueryStats* pStats = nullptr) const;
 
+  /// \brief Finds the visible objects for several frusta at once, e.g. for all shadow views of a frame.
+  ///
+  /// out_ObjectsPerFrustum must contain one array per frustum, the visible objects of frusta[i] are appended to out_ObjectsPerFrustum[i].
+  /// Spatial systems can traverse their data only once for all frusta and distribute the work across the task system,
+  /// which is considerably cheaper than doing one query per frustum.
+  void FindVisibleObjects(ezArrayPtr<const ezFrustum> frusta, ezUInt32 uiCategoryBitmask, ezArrayPtr<ezDynamicArray<const ezGameObject*>> out_ObjectsPerFrustum,
+    QueryStats* pStats = nullptr) const;
+
   ///@}
 
 protected:
@@ -65,6 +73,10 @@ protected:
   virtual void FindObjectsInBoxInternal(const ezBoundingBox& box, ezUInt32 uiCategoryBitmask, QueryCallback callback, QueryStats* pStats) const = 0;
   virtual void FindVisibleObjectsInternal(const ezFrustum& frustum, ezUInt32 uiCategoryBitmask, ezDynamicArray<const ezGameObject*>& out_Objects, QueryStats* pStats) const = 0;
 
+  /// \brief The default implementation executes one FindVisibleObjectsInternal call per frustum in parallel.
+  virtual void FindVisibleObjectsBatchInternal(ezArrayPtr<const ezFrustum> frusta, ezUInt32 uiCategoryBitmask,
+    ezArrayPtr<ezDynamicArray<const ezGameObject*>> out_ObjectsPerFrustum, QueryStats* pStats) const;
+
   virtual void SpatialDataAdded(ezSpatialData* pData) = 0;
   virtual void SpatialDataRemoved(ezSpatialData* pData) = 0;
   virtual void SpatialDataChanged(ezSpatialData* pData, const ezSimdBBoxSphere& oldBounds, ezUInt32 uiOldCategoryBitmask) = 0;
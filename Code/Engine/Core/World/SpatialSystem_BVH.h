@@ -0,0 +1,70 @@
+#pragma once
+
+#include <Core/World/SpatialSystem.h>
+
+/// \brief A spatial system that stores all objects in a dynamic bounding volume hierarchy.
+///
+/// Every node has up to 4 children, which are either other nodes or objects. The bounding boxes of the children are stored
+/// as structure of arrays, so that all children of a node can be tested against a query with a few SIMD operations.
+/// Objects are inserted incrementally, moved objects only refit the boxes of their parent nodes as long as they stay inside of them.
+/// Subtrees that become too deep are rebuilt, thus the hierarchy adapts to worlds with very uneven object density
+/// without the need to choose a cell size.
+class EZ_CORE_DLL ezSpatialSystem_BVH : public ezSpatialSystem
+{
+  EZ_ADD_DYNAMIC_REFLECTION(ezSpatialSystem_BVH, ezSpatialSystem);
+
+public:
+  ezSpatialSystem_BVH();
+  ~ezSpatialSystem_BVH();
+
+  /// \brief Returns bounding boxes of all existing nodes. Useful for debug visualizations.
+  void GetAllNodeBoxes(ezHybridArray<ezBoundingBox, 16>& out_BoundingBoxes, ezSpatialData::Category filterCategory = ezInvalidSpatialDataCategory) const;
+
+  /// \brief Returns the number of node levels of the hierarchy.
+  ezUInt32 GetTreeDepth() const;
+
+private:
+  // ezSpatialSystem implementation
+  virtual void FindObjectsInSphereInternal(const ezBoundingSphere& sphere, ezUInt32 uiCategoryBitmask, QueryCallback callback,
+    QueryStats* pStats = nullptr) const override;
+  virtual void FindObjectsInBoxInternal(const ezBoundingBox& box, ezUInt32 uiCategoryBitmask, QueryCallback callback, QueryStats* pStats = nullptr) const override;
+
+  virtual void FindVisibleObjectsInternal(const ezFrustum& frustum, ezUInt32 uiCategoryBitmask, ezDynamicArray<const ezGameObject*>& out_Objects,
+    QueryStats* pStats = nullptr) const override;
+
+  virtual void SpatialDataAdded(ezSpatialData* pData) override;
+  virtual void SpatialDataRemoved(ezSpatialData* pData) override;
+  virtual void SpatialDataChanged(ezSpatialData* pData, const ezSimdBBoxSphere& oldBounds, ezUInt32 uiOldCategoryBitmask) override;
+  virtual void FixSpatialDataPointer(ezSpatialData* pOldPtr, ezSpatialData* pNewPtr) override;
+
+  struct SpatialUserData;
+  struct Node;
+
+  ezUInt32 AllocateNode(ezUInt32 uiParent, ezUInt32 uiSlotInParent);
+  void FreeNode(ezUInt32 uiNodeIndex);
+
+  void SetObjectSlot(ezUInt32 uiNodeIndex, ezUInt32 uiSlot, ezSpatialData* pData);
+  void SetNodeSlot(ezUInt32 uiNodeIndex, ezUInt32 uiSlot, ezUInt32 uiChildNodeIndex);
+  void RemoveSlot(ezUInt32 uiNodeIndex, ezUInt32 uiSlot);
+
+  void InsertObject(ezSpatialData* pData);
+  void RemoveObject(ezSpatialData* pData);
+  void CollapseNode(ezUInt32 uiNodeIndex);
+  void Refit(ezUInt32 uiNodeIndex);
+  void AdjustObjectCount(ezUInt32 uiNodeIndex, ezInt32 iDelta);
+
+  void RebuildSubtree(ezUInt32 uiNodeIndex);
+  void GatherObjects(ezUInt32 uiNodeIndex, bool bFreeNodes);
+  void BuildNode(ezUInt32 uiNodeIndex, ezArrayPtr<ezSpatialData*> objects);
+
+  template <typename Functor>
+  void TraverseNodes(Functor func) const;
+
+  ezProxyAllocator m_AlignedAllocator;
+
+  ezDynamicArray<Node> m_Nodes;
+  ezDynamicArray<ezUInt32> m_FreeNodes;
+  ezUInt32 m_uiRootNode = ezInvalidIndex;
+
+  ezDynamicArray<ezSpatialData*> m_RebuildObjects;
+};
@@ -26,6 +26,8 @@ private:
 
   virtual void FindVisibleObjectsInternal(const ezFrustum& frustum, ezUInt32 uiCategoryBitmask, ezDynamicArray<const ezGameObject*>& out_Objects,
     QueryStats* pStats = nullptr) const override;
+  virtual void FindVisibleObjectsBatchInternal(ezArrayPtr<const ezFrustum> frusta, ezUInt32 uiCategoryBitmask,
+    ezArrayPtr<ezDynamicArray<const ezGameObject*>> out_ObjectsPerFrustum, QueryStats* pStats) const override;
 
   virtual void SpatialDataAdded(ezSpatialData* pData) override;
   virtual void SpatialDataRemoved(ezSpatialData* pData) override;
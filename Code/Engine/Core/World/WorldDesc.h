@@ -9,6 +9,18 @@
 
 class ezTimeStepSmoothing;
 
+/// \brief The type of spatial system that a world creates, if none is passed in through ezWorldDesc::m_pSpatialSystem.
+struct ezSpatialSystemType
+{
+  enum Enum
+  {
+    RegularGrid,             ///< ezSpatialSystem_RegularGrid
+    BoundingVolumeHierarchy, ///< ezSpatialSystem_BVH, better suited for big worlds with very uneven object density
+
+    Default = RegularGrid
+  };
+};
+
 /// \brief Describes the initial state of a world.
 struct ezWorldDesc
 {
@@ -24,6 +36,7 @@ struct ezWorldDesc
 
   ezUniquePtr<ezSpatialSystem> m_pSpatialSystem;
   bool m_bAutoCreateSpatialSystem = true; ///< automatically create a default spatial system if none is set
+  ezSpatialSystemType::Enum m_AutoCreatedSpatialSystemType = ezSpatialSystemType::Default; ///< the type of spatial system to create automatically
 
   ezSharedPtr<ezCoordinateSystemProvider> m_pCoordinateSystemProvider;
   ezUniquePtr<ezTimeStepSmoothing> m_pTimeStepSmoothing; ///< if nullptr, ezDefaultTimeStepSmoothing will be used
@@ -120,11 +120,9 @@ struct ezHashHelper<T*>
 {
   EZ_ALWAYS_INLINE static ezUInt32 Hash(T* value)
   {
-#if EZ_ENABLED(EZ_PLATFORM_64BIT)
-    return ezHashHelper<ezUInt64>::Hash(reinterpret_cast<ezUInt64>(value) >> 4);
-#else
-    return ezHashHelper<ezUInt32>::Hash(reinterpret_cast<ezUInt32>(value) >> 4);
-#endif
+    // Fibonacci hashing, pointers into pools and slabs are evenly spaced and would otherwise fill long runs of neighboring buckets
+    const ezUInt64 uiMixed = static_cast<ezUInt64>(reinterpret_cast<size_t>(value)) * 0x9E3779B97F4A7C15ull;
+    return static_cast<ezUInt32>(uiMixed >> 32);
   }
 
   EZ_ALWAYS_INLINE static bool Equal(T* a, T* b)
@@ -6,6 +6,10 @@
 typedef ezGuardedAllocator DefaultHeapType;
 typedef ezGuardedAllocator DefaultAlignedHeapType;
 typedef ezGuardedAllocator DefaultStaticHeapType;
+#elif EZ_ENABLED(EZ_USE_SMALL_OBJECT_ALLOCATIONS)
+typedef ezSmallObjectAllocator DefaultHeapType;
+typedef ezAlignedHeapAllocator DefaultAlignedHeapType;
+typedef ezSmallObjectAllocator DefaultStaticHeapType;
 #else
 typedef ezHeapAllocator DefaultHeapType;
 typedef ezAlignedHeapAllocator DefaultAlignedHeapType;
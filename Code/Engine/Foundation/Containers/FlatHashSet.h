@@ -0,0 +1,222 @@
+#pragma once
+
+#include <Foundation/Algorithm/HashingUtils.h>
+#include <Foundation/Containers/Implementation/FlatHashGroup.h>
+#include <Foundation/Math/Math.h>
+#include <Foundation/Memory/AllocatorWrapper.h>
+
+/// \brief Implementation of a hashset which stores its keys in groups that are searched with SIMD instructions.
+///
+/// Has the same interface as ezHashSet and uses the same memory layout as ezFlatHashTable: every key has one control byte with
+/// 7 bits of its hash and a lookup compares the control bytes of a group of 16 keys at once.
+/// The set is expanded when the load gets greater than 87.5%.
+///
+/// Keys may be move-only types, all lookup functions accept any key type that the Hasher can hash and compare with KeyType.
+///
+/// \see ezHashHelper
+template <typename KeyType, typename Hasher>
+class ezFlatHashSetBase
+{
+public:
+  /// \brief Const iterator.
+  class ConstIterator
+  {
+  public:
+    /// \brief Checks whether this iterator points to a valid element.
+    bool IsValid() const; // [tested]
+
+    /// \brief Checks whether the two iterators point to the same element.
+    bool operator==(const typename ezFlatHashSetBase<KeyType, Hasher>::ConstIterator& rhs) const;
+
+    /// \brief Checks whether the two iterators point to the same element.
+    bool operator!=(const typename ezFlatHashSetBase<KeyType, Hasher>::ConstIterator& rhs) const;
+
+    /// \brief Returns the 'key' of the element that this iterator points to.
+    const KeyType& Key() const; // [tested]
+
+    /// \brief Returns the 'key' of the element that this iterator points to.
+    EZ_ALWAYS_INLINE const KeyType& operator*() { return Key(); } // [tested]
+
+    /// \brief Advances the iterator to the next element in the map. The iterator will not be valid anymore, if the end is reached.
+    void Next(); // [tested]
+
+    /// \brief Shorthand for 'Next'
+    void operator++(); // [tested]
+
+  protected:
+    friend class ezFlatHashSetBase<KeyType, Hasher>;
+
+    explicit ConstIterator(const ezFlatHashSetBase<KeyType, Hasher>& hashSet);
+    void SetToBegin();
+    void SetToEnd();
+
+    const ezFlatHashSetBase<KeyType, Hasher>* m_hashSet = nullptr;
+    ezUInt32 m_uiCurrentIndex = 0; // current element index that this iterator points to.
+    ezUInt32 m_uiCurrentCount = 0; // current number of valid elements that this iterator has found so far.
+  };
+
+protected:
+  /// \brief Creates an empty hashset. Does not allocate any data yet.
+  ezFlatHashSetBase(ezAllocatorBase* pAllocator); // [tested]
+
+  /// \brief Creates a copy of the given hashset.
+  ezFlatHashSetBase(const ezFlatHashSetBase<KeyType, Hasher>& rhs, ezAllocatorBase* pAllocator); // [tested]
+
+  /// \brief Moves data from an existing hashset into this one.
+  ezFlatHashSetBase(ezFlatHashSetBase<KeyType, Hasher>&& rhs, ezAllocatorBase* pAllocator); // [tested]
+
+  /// \brief Destructor.
+  ~ezFlatHashSetBase(); // [tested]
+
+  /// \brief Copies the data from another hashset into this one.
+  void operator=(const ezFlatHashSetBase<KeyType, Hasher>& rhs); // [tested]
+
+  /// \brief Moves data from an existing hashset into this one.
+  void operator=(ezFlatHashSetBase<KeyType, Hasher>&& rhs); // [tested]
+
+public:
+  /// \brief Compares this set to another set.
+  bool operator==(const ezFlatHashSetBase<KeyType, Hasher>& rhs) const; // [tested]
+
+  /// \brief Compares this set to another set.
+  bool operator!=(const ezFlatHashSetBase<KeyType, Hasher>& rhs) const; // [tested]
+
+  /// \brief Expands the hashset by over-allocating the internal storage so that the given number of keys can be inserted without
+  /// expanding it again.
+  void Reserve(ezUInt32 uiCapacity); // [tested]
+
+  /// \brief Tries to compact the hashset to avoid wasting memory.
+  ///
+  /// The resulting capacity is at least 'GetCount' (no elements get removed). Also gets rid of the markers of removed keys.
+  /// Will deallocate all data, if the hashset is empty.
+  void Compact(); // [tested]
+
+  /// \brief Returns the number of active entries in the set.
+  ezUInt32 GetCount() const; // [tested]
+
+  /// \brief Returns true, if the hashset does not contain any elements.
+  bool IsEmpty() const; // [tested]
+
+  /// \brief Clears the set.
+  void Clear(); // [tested]
+
+  /// \brief Inserts the key. Returns whether the key was already existing.
+  template <typename CompatibleKeyType>
+  bool Insert(CompatibleKeyType&& key); // [tested]
+
+  /// \brief Removes the entry with the given key. Returns if an entry was removed.
+  template <typename CompatibleKeyType>
+  bool Remove(const CompatibleKeyType& key); // [tested]
+
+  /// \brief Erases the key at the given Iterator. Returns an iterator to the element after the given iterator.
+  ConstIterator Remove(const ConstIterator& pos); // [tested]
+
+  /// \brief Returns if an entry with given key exists in the set.
+  template <typename CompatibleKeyType>
+  bool Contains(const CompatibleKeyType& key) const; // [tested]
+
+  /// \brief Checks whether all keys of the given set are in the container.
+  bool ContainsSet(const ezFlatHashSetBase<KeyType, Hasher>& operand) const; // [tested]
+
+  /// \brief Makes this set the union of itself and the operand.
+  void Union(const ezFlatHashSetBase<KeyType, Hasher>& operand); // [tested]
+
+  /// \brief Makes this set the difference of itself and the operand, i.e. subtracts operand.
+  void Difference(const ezFlatHashSetBase<KeyType, Hasher>& operand); // [tested]
+
+  /// \brief Makes this set the intersection of itself and the operand.
+  void Intersection(const ezFlatHashSetBase<KeyType, Hasher>& operand); // [tested]
+
+  /// \brief Returns a constant Iterator to the very first element.
+  ConstIterator GetIterator() const; // [tested]
+
+  /// \brief Returns a constant Iterator to the first element that is not part of the hashset. Needed to implement range based for loop
+  /// support.
+  ConstIterator GetEndIterator() const;
+
+  /// \brief Returns the allocator that is used by this instance.
+  ezAllocatorBase* GetAllocator() const;
+
+  /// \brief Returns the amount of bytes that are currently allocated on the heap.
+  ezUInt64 GetHeapMemoryUsage() const; // [tested]
+
+  /// \brief Swaps this set with the other one.
+  void Swap(ezFlatHashSetBase<KeyType, Hasher>& other); // [tested]
+
+private:
+  typedef ezInternal::FlatHashGroup Group;
+
+  KeyType* m_pEntries;
+  ezUInt8* m_pControl;
+
+  ezUInt32 m_uiCount;
+  ezUInt32 m_uiCapacity;
+  ezUInt32 m_uiGrowthLeft; ///< The number of keys that can be inserted into free slots before the set has to be expanded.
+
+  ezAllocatorBase* m_pAllocator;
+
+  void SetCapacity(ezUInt32 uiCapacity);
+  void Deallocate();
+
+  void RemoveInternal(ezUInt32 uiIndex);
+
+  template <typename CompatibleKeyType>
+  ezUInt32 FindEntry(const CompatibleKeyType& key) const;
+
+  template <typename CompatibleKeyType>
+  ezUInt32 FindEntry(ezUInt32 uiHash, const CompatibleKeyType& key) const;
+
+  /// \brief Returns the index of a free or deleted slot for a new key. Expands the set first, if necessary.
+  ezUInt32 PrepareInsert(ezUInt32 uiHash);
+  ezUInt32 FindInsertSlot(ezUInt32 uiHash) const;
+  ezUInt32 FindNextValidEntry(ezUInt32 uiEntryIndex) const;
+
+  static ezUInt32 GetMaxLoad(ezUInt32 uiCapacity);
+};
+
+/// \brief \see ezFlatHashSetBase
+template <typename KeyType, typename Hasher = ezHashHelper<KeyType>, typename AllocatorWrapper = ezDefaultAllocatorWrapper>
+class ezFlatHashSet : public ezFlatHashSetBase<KeyType, Hasher>
+{
+public:
+  ezFlatHashSet();
+  ezFlatHashSet(ezAllocatorBase* pAllocator);
+
+  ezFlatHashSet(const ezFlatHashSet<KeyType, Hasher, AllocatorWrapper>& other);
+  ezFlatHashSet(const ezFlatHashSetBase<KeyType, Hasher>& other);
+
+  ezFlatHashSet(ezFlatHashSet<KeyType, Hasher, AllocatorWrapper>&& other);
+  ezFlatHashSet(ezFlatHashSetBase<KeyType, Hasher>&& other);
+
+  void operator=(const ezFlatHashSet<KeyType, Hasher, AllocatorWrapper>& rhs);
+  void operator=(const ezFlatHashSetBase<KeyType, Hasher>& rhs);
+
+  void operator=(ezFlatHashSet<KeyType, Hasher, AllocatorWrapper>&& rhs);
+  void operator=(ezFlatHashSetBase<KeyType, Hasher>&& rhs);
+};
+
+template <typename KeyType, typename Hasher>
+typename ezFlatHashSetBase<KeyType, Hasher>::ConstIterator begin(const ezFlatHashSetBase<KeyType, Hasher>& set)
+{
+  return set.GetIterator();
+}
+
+template <typename KeyType, typename Hasher>
+typename ezFlatHashSetBase<KeyType, Hasher>::ConstIterator cbegin(const ezFlatHashSetBase<KeyType, Hasher>& set)
+{
+  return set.GetIterator();
+}
+
+template <typename KeyType, typename Hasher>
+typename ezFlatHashSetBase<KeyType, Hasher>::ConstIterator end(const ezFlatHashSetBase<KeyType, Hasher>& set)
+{
+  return set.GetEndIterator();
+}
+
+template <typename KeyType, typename Hasher>
+typename ezFlatHashSetBase<KeyType, Hasher>::ConstIterator cend(const ezFlatHashSetBase<KeyType, Hasher>& set)
+{
+  return set.GetEndIterator();
+}
+
+#include <Foundation/Containers/Implementation/FlatHashSet_inl.h>
@@ -0,0 +1,304 @@
+#pragma once
+
+#include <Foundation/Algorithm/HashingUtils.h>
+#include <Foundation/Containers/Implementation/FlatHashGroup.h>
+#include <Foundation/Math/Math.h>
+#include <Foundation/Memory/AllocatorWrapper.h>
+
+/// \brief Implementation of a hashtable which stores key/value pairs in groups that are searched with SIMD instructions.
+///
+/// Has the same interface as ezHashTable, but a different memory layout. Every entry has one control byte that stores
+/// 7 bits of the hash of its key. A lookup compares the control bytes of a group of 16 entries at once and only compares the keys
+/// of the entries whose control byte matches, so it typically touches one cache line of control bytes and one entry.
+/// Groups are probed quadratically, the table is expanded when the load gets greater than 87.5%.
+///
+/// Prefer this over ezHashTable for large tables and keys that are expensive to compare. Values may be move-only types,
+/// all lookup functions accept any key type that the Hasher can hash and compare with KeyType.
+///
+/// \see ezHashHelper
+template <typename KeyType, typename ValueType, typename Hasher>
+class ezFlatHashTableBase
+{
+public:
+  /// \brief Const iterator.
+  struct ConstIterator
+  {
+    EZ_DECLARE_POD_TYPE();
+
+    /// \brief Checks whether this iterator points to a valid element.
+    bool IsValid() const; // [tested]
+
+    /// \brief Checks whether the two iterators point to the same element.
+    bool operator==(const typename ezFlatHashTableBase<KeyType, ValueType, Hasher>::ConstIterator& rhs) const;
+
+    /// \brief Checks whether the two iterators point to the same element.
+    bool operator!=(const typename ezFlatHashTableBase<KeyType, ValueType, Hasher>::ConstIterator& rhs) const;
+
+    /// \brief Returns the 'key' of the element that this iterator points to.
+    const KeyType& Key() const; // [tested]
+
+    /// \brief Returns the 'value' of the element that this iterator points to.
+    const ValueType& Value() const; // [tested]
+
+    /// \brief Advances the iterator to the next element in the map. The iterator will not be valid anymore, if the end is reached.
+    void Next(); // [tested]
+
+    /// \brief Shorthand for 'Next'
+    void operator++(); // [tested]
+
+    /// \brief Returns '*this' to enable foreach
+    EZ_ALWAYS_INLINE ConstIterator& operator*() { return *this; } // [tested]
+
+  protected:
+    friend class ezFlatHashTableBase<KeyType, ValueType, Hasher>;
+
+    explicit ConstIterator(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& hashTable);
+    void SetToBegin();
+    void SetToEnd();
+
+    const ezFlatHashTableBase<KeyType, ValueType, Hasher>* m_hashTable = nullptr;
+    ezUInt32 m_uiCurrentIndex = 0; // current element index that this iterator points to.
+    ezUInt32 m_uiCurrentCount = 0; // current number of valid elements that this iterator has found so far.
+  };
+
+  /// \brief Iterator with write access.
+  struct Iterator : public ConstIterator
+  {
+    EZ_DECLARE_POD_TYPE();
+
+    /// \brief Creates a new iterator from another.
+    EZ_ALWAYS_INLINE Iterator(const Iterator& rhs); // [tested]
+
+    /// \brief Assigns one iterator no another.
+    EZ_ALWAYS_INLINE void operator=(const Iterator& rhs); // [tested]
+
+    // this is required to pull in the const version of this function
+    using ConstIterator::Value;
+
+    /// \brief Returns the 'value' of the element that this iterator points to.
+    EZ_FORCE_INLINE ValueType& Value(); // [tested]
+
+    /// \brief Returns '*this' to enable foreach
+    EZ_ALWAYS_INLINE Iterator& operator*() { return *this; } // [tested]
+
+  private:
+    friend class ezFlatHashTableBase<KeyType, ValueType, Hasher>;
+
+    explicit Iterator(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& hashTable);
+  };
+
+protected:
+  /// \brief Creates an empty hashtable. Does not allocate any data yet.
+  ezFlatHashTableBase(ezAllocatorBase* pAllocator); // [tested]
+
+  /// \brief Creates a copy of the given hashtable.
+  ezFlatHashTableBase(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& rhs, ezAllocatorBase* pAllocator); // [tested]
+
+  /// \brief Moves data from an existing hashtable into this one.
+  ezFlatHashTableBase(ezFlatHashTableBase<KeyType, ValueType, Hasher>&& rhs, ezAllocatorBase* pAllocator); // [tested]
+
+  /// \brief Destructor.
+  ~ezFlatHashTableBase(); // [tested]
+
+  /// \brief Copies the data from another hashtable into this one.
+  void operator=(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& rhs); // [tested]
+
+  /// \brief Moves data from an existing hashtable into this one.
+  void operator=(ezFlatHashTableBase<KeyType, ValueType, Hasher>&& rhs); // [tested]
+
+public:
+  /// \brief Compares this table to another table.
+  bool operator==(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& rhs) const; // [tested]
+
+  /// \brief Compares this table to another table.
+  bool operator!=(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& rhs) const; // [tested]
+
+  /// \brief Expands the hashtable by over-allocating the internal storage so that the given number of entries can be inserted without
+  /// expanding it again.
+  void Reserve(ezUInt32 uiCapacity); // [tested]
+
+  /// \brief Tries to compact the hashtable to avoid wasting memory.
+  ///
+  /// The resulting capacity is at least 'GetCount' (no elements get removed). Also gets rid of the markers of removed entries.
+  /// Will deallocate all data, if the hashtable is empty.
+  void Compact(); // [tested]
+
+  /// \brief Returns the number of active entries in the table.
+  ezUInt32 GetCount() const; // [tested]
+
+  /// \brief Returns true, if the hashtable does not contain any elements.
+  bool IsEmpty() const; // [tested]
+
+  /// \brief Clears the table.
+  void Clear(); // [tested]
+
+  /// \brief Inserts the key value pair or replaces value if an entry with the given key already exists.
+  ///
+  /// Returns true if an existing value was replaced and optionally writes out the old value to out_oldValue.
+  template <typename CompatibleKeyType, typename CompatibleValueType>
+  bool Insert(CompatibleKeyType&& key, CompatibleValueType&& value, ValueType* out_oldValue = nullptr); // [tested]
+
+  /// \brief Removes the entry with the given key. Returns whether an entry was removed and optionally writes out the old value to out_oldValue.
+  template <typename CompatibleKeyType>
+  bool Remove(const CompatibleKeyType& key, ValueType* out_oldValue = nullptr); // [tested]
+
+  /// \brief Erases the key/value pair at the given Iterator. Returns an iterator to the element after the given iterator.
+  Iterator Remove(const Iterator& pos); // [tested]
+
+  /// \brief Cannot remove an element with just a ConstIterator
+  void Remove(const ConstIterator& pos) = delete;
+
+  /// \brief Returns if an entry with the given key was found and if found writes out the corresponding value to out_value.
+  template <typename CompatibleKeyType>
+  bool TryGetValue(const CompatibleKeyType& key, ValueType& out_value) const; // [tested]
+
+  /// \brief Returns if an entry with the given key was found and if found writes out the pointer to the corresponding value to out_pValue.
+  template <typename CompatibleKeyType>
+  bool TryGetValue(const CompatibleKeyType& key, const ValueType*& out_pValue) const; // [tested]
+
+  /// \brief Returns if an entry with the given key was found and if found writes out the pointer to the corresponding value to out_pValue.
+  template <typename CompatibleKeyType>
+  bool TryGetValue(const CompatibleKeyType& key, ValueType*& out_pValue); // [tested]
+
+  /// \brief Searches for key, returns a ConstIterator to it or an invalid iterator, if no such key is found. O(1) operation.
+  template <typename CompatibleKeyType>
+  ConstIterator Find(const CompatibleKeyType& key) const; // [tested]
+
+  /// \brief Searches for key, returns an Iterator to it or an invalid iterator, if no such key is found. O(1) operation.
+  template <typename CompatibleKeyType>
+  Iterator Find(const CompatibleKeyType& key); // [tested]
+
+  /// \brief Returns a pointer to the value of the entry with the given key if found, otherwise returns nullptr.
+  template <typename CompatibleKeyType>
+  const ValueType* GetValue(const CompatibleKeyType& key) const; // [tested]
+
+  /// \brief Returns a pointer to the value of the entry with the given key if found, otherwise returns nullptr.
+  template <typename CompatibleKeyType>
+  ValueType* GetValue(const CompatibleKeyType& key); // [tested]
+
+  /// \brief Returns the value to the given key if found or creates a new entry with the given key and a default constructed value.
+  ValueType& operator[](const KeyType& key); // [tested]
+
+  /// \brief Returns if an entry with given key exists in the table.
+  template <typename CompatibleKeyType>
+  bool Contains(const CompatibleKeyType& key) const; // [tested]
+
+  /// \brief Returns an Iterator to the very first element.
+  Iterator GetIterator(); // [tested]
+
+  /// \brief Returns an Iterator to the first element that is not part of the hash-table. Needed to support range based for loops.
+  Iterator GetEndIterator(); // [tested]
+
+  /// \brief Returns a constant Iterator to the very first element.
+  ConstIterator GetIterator() const; // [tested]
+
+  /// \brief Returns a ConstIterator to the first element that is not part of the hash-table. Needed to support range based for loops.
+  ConstIterator GetEndIterator() const; // [tested]
+
+  /// \brief Returns the allocator that is used by this instance.
+  ezAllocatorBase* GetAllocator() const;
+
+  /// \brief Returns the amount of bytes that are currently allocated on the heap.
+  ezUInt64 GetHeapMemoryUsage() const; // [tested]
+
+  /// \brief Swaps this map with the other one.
+  void Swap(ezFlatHashTableBase<KeyType, ValueType, Hasher>& other); // [tested]
+
+private:
+  typedef ezInternal::FlatHashGroup Group;
+
+  struct Entry
+  {
+    KeyType key;
+    ValueType value;
+  };
+
+  Entry* m_pEntries;
+  ezUInt8* m_pControl;
+
+  ezUInt32 m_uiCount;
+  ezUInt32 m_uiCapacity;
+  ezUInt32 m_uiGrowthLeft; ///< The number of entries that can be inserted into free slots before the table has to be expanded.
+
+  ezAllocatorBase* m_pAllocator;
+
+  void SetCapacity(ezUInt32 uiCapacity);
+  void Deallocate();
+
+  void RemoveInternal(ezUInt32 uiIndex);
+
+  template <typename CompatibleKeyType>
+  ezUInt32 FindEntry(const CompatibleKeyType& key) const;
+
+  template <typename CompatibleKeyType>
+  ezUInt32 FindEntry(ezUInt32 uiHash, const CompatibleKeyType& key) const;
+
+  /// \brief Returns the index of a free or deleted slot for a new entry. Expands the table first, if necessary.
+  ezUInt32 PrepareInsert(ezUInt32 uiHash);
+  ezUInt32 FindInsertSlot(ezUInt32 uiHash) const;
+  ezUInt32 FindNextValidEntry(ezUInt32 uiEntryIndex) const;
+
+  static ezUInt32 GetMaxLoad(ezUInt32 uiCapacity);
+};
+
+/// \brief \see ezFlatHashTableBase
+template <typename KeyType, typename ValueType, typename Hasher = ezHashHelper<KeyType>, typename AllocatorWrapper = ezDefaultAllocatorWrapper>
+class ezFlatHashTable : public ezFlatHashTableBase<KeyType, ValueType, Hasher>
+{
+public:
+  ezFlatHashTable();
+  ezFlatHashTable(ezAllocatorBase* pAllocator);
+
+  ezFlatHashTable(const ezFlatHashTable<KeyType, ValueType, Hasher, AllocatorWrapper>& other);
+  ezFlatHashTable(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& other);
+
+  ezFlatHashTable(ezFlatHashTable<KeyType, ValueType, Hasher, AllocatorWrapper>&& other);
+  ezFlatHashTable(ezFlatHashTableBase<KeyType, ValueType, Hasher>&& other);
+
+  void operator=(const ezFlatHashTable<KeyType, ValueType, Hasher, AllocatorWrapper>& rhs);
+  void operator=(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& rhs);
+
+  void operator=(ezFlatHashTable<KeyType, ValueType, Hasher, AllocatorWrapper>&& rhs);
+  void operator=(ezFlatHashTableBase<KeyType, ValueType, Hasher>&& rhs);
+};
+
+//////////////////////////////////////////////////////////////////////////
+// begin() /end() for range-based for-loop support
+
+template <typename KeyType, typename ValueType, typename Hasher>
+typename ezFlatHashTableBase<KeyType, ValueType, Hasher>::Iterator begin(ezFlatHashTableBase<KeyType, ValueType, Hasher>& container)
+{
+  return container.GetIterator();
+}
+
+template <typename KeyType, typename ValueType, typename Hasher>
+typename ezFlatHashTableBase<KeyType, ValueType, Hasher>::ConstIterator begin(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& container)
+{
+  return container.GetIterator();
+}
+
+template <typename KeyType, typename ValueType, typename Hasher>
+typename ezFlatHashTableBase<KeyType, ValueType, Hasher>::ConstIterator cbegin(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& container)
+{
+  return container.GetIterator();
+}
+
+template <typename KeyType, typename ValueType, typename Hasher>
+typename ezFlatHashTableBase<KeyType, ValueType, Hasher>::Iterator end(ezFlatHashTableBase<KeyType, ValueType, Hasher>& container)
+{
+  return container.GetEndIterator();
+}
+
+template <typename KeyType, typename ValueType, typename Hasher>
+typename ezFlatHashTableBase<KeyType, ValueType, Hasher>::ConstIterator end(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& container)
+{
+  return container.GetEndIterator();
+}
+
+template <typename KeyType, typename ValueType, typename Hasher>
+typename ezFlatHashTableBase<KeyType, ValueType, Hasher>::ConstIterator cend(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& container)
+{
+  return container.GetEndIterator();
+}
+
+#include <Foundation/Containers/Implementation/FlatHashTable_inl.h>
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <Foundation/Math/Math.h>
+
+#if defined(__SSE2__) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define EZ_FLAT_HASH_GROUP_SSE2 EZ_ON
+#  include <emmintrin.h>
+#else
+#  define EZ_FLAT_HASH_GROUP_SSE2 EZ_OFF
+#endif
+
+namespace ezInternal
+{
+  /// \brief The control bytes of ezFlatHashTable and ezFlatHashSet and the operations on groups of them.
+  ///
+  /// Every slot of a flat hash container has one control byte. A full slot stores the upper 7 bits of the hash of its key,
+  /// free and deleted slots have the highest bit set. The slots are divided into groups of 16 and all control bytes of a group
+  /// are compared at once, with SSE2 where available.
+  struct FlatHashGroup
+  {
+    enum : ezUInt8
+    {
+      EmptyControl = 0x80,
+      DeletedControl = 0xFE,
+    };
+
+    enum
+    {
+      Size = 16,
+    };
+
+    EZ_ALWAYS_INLINE static ezUInt8 GetControl(ezUInt32 uiHash) { return static_cast<ezUInt8>(uiHash >> 25); }
+
+    EZ_ALWAYS_INLINE static bool IsFull(ezUInt8 uiControl) { return (uiControl & 0x80) == 0; }
+
+    /// \brief A mask with one bit per slot of a group, the lowest bit is the first slot.
+    struct BitMask
+    {
+      EZ_ALWAYS_INLINE explicit BitMask(ezUInt32 uiMask)
+        : m_uiMask(uiMask)
+      {
+      }
+
+      EZ_ALWAYS_INLINE bool HasAny() const { return m_uiMask != 0; }
+
+      /// \brief Returns the index of the lowest set bit and clears it.
+      EZ_ALWAYS_INLINE ezUInt32 TakeFirst()
+      {
+        const ezUInt32 uiIndex = ezMath::FirstBitLow(m_uiMask);
+        m_uiMask &= m_uiMask - 1;
+        return uiIndex;
+      }
+
+      ezUInt32 m_uiMask;
+    };
+
+#if EZ_ENABLED(EZ_FLAT_HASH_GROUP_SSE2)
+
+    EZ_ALWAYS_INLINE explicit FlatHashGroup(const ezUInt8* pControl)
+      : m_Control(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pControl)))
+    {
+    }
+
+    /// \brief Returns the slots whose control byte equals the given control byte of a full slot.
+    EZ_ALWAYS_INLINE BitMask Match(ezUInt8 uiControl) const
+    {
+      return BitMask(_mm_movemask_epi8(_mm_cmpeq_epi8(m_Control, _mm_set1_epi8(static_cast<char>(uiControl)))));
+    }
+
+    EZ_ALWAYS_INLINE BitMask MatchEmpty() const { return Match(EmptyControl); }
+
+    EZ_ALWAYS_INLINE BitMask MatchEmptyOrDeleted() const { return BitMask(_mm_movemask_epi8(m_Control)); }
+
+    EZ_ALWAYS_INLINE BitMask MatchFull() const { return BitMask(_mm_movemask_epi8(m_Control) ^ 0xFFFF); }
+
+    __m128i m_Control;
+
+#else
+
+    EZ_ALWAYS_INLINE explicit FlatHashGroup(const ezUInt8* pControl)
+      : m_pControl(pControl)
+    {
+    }
+
+    EZ_ALWAYS_INLINE BitMask Match(ezUInt8 uiControl) const
+    {
+      ezUInt32 uiMask = 0;
+      for (ezUInt32 i = 0; i < Size; ++i)
+      {
+        uiMask |= static_cast<ezUInt32>(m_pControl[i] == uiControl) << i;
+      }
+      return BitMask(uiMask);
+    }
+
+    EZ_ALWAYS_INLINE BitMask MatchEmpty() const { return Match(EmptyControl); }
+
+    EZ_ALWAYS_INLINE BitMask MatchEmptyOrDeleted() const
+    {
+      ezUInt32 uiMask = 0;
+      for (ezUInt32 i = 0; i < Size; ++i)
+      {
+        uiMask |= static_cast<ezUInt32>(m_pControl[i] >> 7) << i;
+      }
+      return BitMask(uiMask);
+    }
+
+    EZ_ALWAYS_INLINE BitMask MatchFull() const { return BitMask(MatchEmptyOrDeleted().m_uiMask ^ 0xFFFF); }
+
+    const ezUInt8* m_pControl;
+
+#endif
+  };
+} // namespace ezInternal
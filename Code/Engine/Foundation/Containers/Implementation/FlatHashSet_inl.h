@@ -0,0 +1,615 @@
+
+/// \brief Value used by containers for indices to indicate an invalid index.
+#ifndef ezInvalidIndex
+#  define ezInvalidIndex 0xFFFFFFFF
+#endif
+
+// ***** Const Iterator *****
+
+template <typename K, typename H>
+ezFlatHashSetBase<K, H>::ConstIterator::ConstIterator(const ezFlatHashSetBase<K, H>& hashSet)
+  : m_hashSet(&hashSet)
+{
+}
+
+template <typename K, typename H>
+void ezFlatHashSetBase<K, H>::ConstIterator::SetToBegin()
+{
+  if (m_hashSet->IsEmpty())
+  {
+    m_uiCurrentIndex = m_hashSet->m_uiCapacity;
+    return;
+  }
+
+  m_uiCurrentIndex = m_hashSet->FindNextValidEntry(0);
+}
+
+template <typename K, typename H>
+inline void ezFlatHashSetBase<K, H>::ConstIterator::SetToEnd()
+{
+  m_uiCurrentCount = m_hashSet->m_uiCount;
+  m_uiCurrentIndex = m_hashSet->m_uiCapacity;
+}
+
+template <typename K, typename H>
+EZ_ALWAYS_INLINE bool ezFlatHashSetBase<K, H>::ConstIterator::IsValid() const
+{
+  return m_uiCurrentCount < m_hashSet->m_uiCount;
+}
+
+template <typename K, typename H>
+EZ_ALWAYS_INLINE bool ezFlatHashSetBase<K, H>::ConstIterator::operator==(const typename ezFlatHashSetBase<K, H>::ConstIterator& rhs) const
+{
+  return m_uiCurrentIndex == rhs.m_uiCurrentIndex && m_hashSet->m_pEntries == rhs.m_hashSet->m_pEntries;
+}
+
+template <typename K, typename H>
+EZ_ALWAYS_INLINE bool ezFlatHashSetBase<K, H>::ConstIterator::operator!=(const typename ezFlatHashSetBase<K, H>::ConstIterator& rhs) const
+{
+  return !(*this == rhs);
+}
+
+template <typename K, typename H>
+EZ_FORCE_INLINE const K& ezFlatHashSetBase<K, H>::ConstIterator::Key() const
+{
+  return m_hashSet->m_pEntries[m_uiCurrentIndex];
+}
+
+template <typename K, typename H>
+void ezFlatHashSetBase<K, H>::ConstIterator::Next()
+{
+  ++m_uiCurrentCount;
+  if (m_uiCurrentCount == m_hashSet->m_uiCount)
+  {
+    m_uiCurrentIndex = m_hashSet->m_uiCapacity;
+    return;
+  }
+
+  m_uiCurrentIndex = m_hashSet->FindNextValidEntry(m_uiCurrentIndex + 1);
+}
+
+template <typename K, typename H>
+EZ_ALWAYS_INLINE void ezFlatHashSetBase<K, H>::ConstIterator::operator++()
+{
+  Next();
+}
+
+
+// ***** ezFlatHashSetBase *****
+
+template <typename K, typename H>
+ezFlatHashSetBase<K, H>::ezFlatHashSetBase(ezAllocatorBase* pAllocator)
+{
+  m_pEntries = nullptr;
+  m_pControl = nullptr;
+  m_uiCount = 0;
+  m_uiCapacity = 0;
+  m_uiGrowthLeft = 0;
+  m_pAllocator = pAllocator;
+}
+
+template <typename K, typename H>
+ezFlatHashSetBase<K, H>::ezFlatHashSetBase(const ezFlatHashSetBase<K, H>& other, ezAllocatorBase* pAllocator)
+{
+  m_pEntries = nullptr;
+  m_pControl = nullptr;
+  m_uiCount = 0;
+  m_uiCapacity = 0;
+  m_uiGrowthLeft = 0;
+  m_pAllocator = pAllocator;
+
+  *this = other;
+}
+
+template <typename K, typename H>
+ezFlatHashSetBase<K, H>::ezFlatHashSetBase(ezFlatHashSetBase<K, H>&& other, ezAllocatorBase* pAllocator)
+{
+  m_pEntries = nullptr;
+  m_pControl = nullptr;
+  m_uiCount = 0;
+  m_uiCapacity = 0;
+  m_uiGrowthLeft = 0;
+  m_pAllocator = pAllocator;
+
+  *this = std::move(other);
+}
+
+template <typename K, typename H>
+ezFlatHashSetBase<K, H>::~ezFlatHashSetBase()
+{
+  Clear();
+  Deallocate();
+}
+
+template <typename K, typename H>
+void ezFlatHashSetBase<K, H>::operator=(const ezFlatHashSetBase<K, H>& rhs)
+{
+  Clear();
+  Reserve(rhs.GetCount());
+
+  for (ezUInt32 i = rhs.FindNextValidEntry(0); i < rhs.m_uiCapacity; i = rhs.FindNextValidEntry(i + 1))
+  {
+    Insert(rhs.m_pEntries[i]);
+  }
+}
+
+template <typename K, typename H>
+void ezFlatHashSetBase<K, H>::operator=(ezFlatHashSetBase<K, H>&& rhs)
+{
+  // Clear any existing data (calls destructors if necessary)
+  Clear();
+
+  if (m_pAllocator != rhs.m_pAllocator)
+  {
+    Reserve(rhs.m_uiCount);
+
+    for (ezUInt32 i = rhs.FindNextValidEntry(0); i < rhs.m_uiCapacity; i = rhs.FindNextValidEntry(i + 1))
+    {
+      Insert(std::move(rhs.m_pEntries[i]));
+    }
+
+    rhs.Clear();
+  }
+  else
+  {
+    Deallocate();
+
+    // Move all data over.
+    m_pEntries = rhs.m_pEntries;
+    m_pControl = rhs.m_pControl;
+    m_uiCount = rhs.m_uiCount;
+    m_uiCapacity = rhs.m_uiCapacity;
+    m_uiGrowthLeft = rhs.m_uiGrowthLeft;
+
+    // Temp copy forgets all its state.
+    rhs.m_pEntries = nullptr;
+    rhs.m_pControl = nullptr;
+    rhs.m_uiCount = 0;
+    rhs.m_uiCapacity = 0;
+    rhs.m_uiGrowthLeft = 0;
+  }
+}
+
+template <typename K, typename H>
+bool ezFlatHashSetBase<K, H>::operator==(const ezFlatHashSetBase<K, H>& rhs) const
+{
+  if (m_uiCount != rhs.m_uiCount)
+    return false;
+
+  for (ezUInt32 i = FindNextValidEntry(0); i < m_uiCapacity; i = FindNextValidEntry(i + 1))
+  {
+    if (!rhs.Contains(m_pEntries[i]))
+      return false;
+  }
+
+  return true;
+}
+
+template <typename K, typename H>
+EZ_ALWAYS_INLINE bool ezFlatHashSetBase<K, H>::operator!=(const ezFlatHashSetBase<K, H>& rhs) const
+{
+  return !(*this == rhs);
+}
+
+template <typename K, typename H>
+void ezFlatHashSetBase<K, H>::Reserve(ezUInt32 uiCapacity)
+{
+  // ensure a maximum load of 87.5%
+  const ezUInt32 uiNewCapacity = ezMath::Max<ezUInt32>(ezMath::PowerOfTwo_Ceil(uiCapacity + (uiCapacity + 6) / 7), Group::Size);
+  if (m_uiCapacity >= uiNewCapacity)
+    return;
+
+  SetCapacity(uiNewCapacity);
+}
+
+template <typename K, typename H>
+void ezFlatHashSetBase<K, H>::Compact()
+{
+  if (IsEmpty())
+  {
+    // completely deallocate all data, if the set is empty.
+    Deallocate();
+  }
+  else
+  {
+    // also rehashes a set of the same size to remove all deleted markers
+    SetCapacity(ezMath::Max<ezUInt32>(ezMath::PowerOfTwo_Ceil(m_uiCount + (m_uiCount + 6) / 7), Group::Size));
+  }
+}
+
+template <typename K, typename H>
+EZ_ALWAYS_INLINE ezUInt32 ezFlatHashSetBase<K, H>::GetCount() const
+{
+  return m_uiCount;
+}
+
+template <typename K, typename H>
+EZ_ALWAYS_INLINE bool ezFlatHashSetBase<K, H>::IsEmpty() const
+{
+  return m_uiCount == 0;
+}
+
+template <typename K, typename H>
+void ezFlatHashSetBase<K, H>::Clear()
+{
+  for (ezUInt32 i = FindNextValidEntry(0); i < m_uiCapacity; i = FindNextValidEntry(i + 1))
+  {
+    ezMemoryUtils::Destruct(&m_pEntries[i], 1);
+  }
+
+  ezMemoryUtils::PatternFill(m_pControl, Group::EmptyControl, m_uiCapacity);
+  m_uiCount = 0;
+  m_uiGrowthLeft = GetMaxLoad(m_uiCapacity);
+}
+
+template <typename K, typename H>
+template <typename CompatibleKeyType>
+bool ezFlatHashSetBase<K, H>::Insert(CompatibleKeyType&& key)
+{
+  const ezUInt32 uiHash = H::Hash(key);
+  if (FindEntry(uiHash, key) != ezInvalidIndex)
+  {
+    return true;
+  }
+
+  // new entry, might either be a move or a copy
+  const ezUInt32 uiIndex = PrepareInsert(uiHash);
+  ezMemoryUtils::CopyOrMoveConstruct(&m_pEntries[uiIndex], std::forward<CompatibleKeyType>(key));
+
+  return false;
+}
+
+template <typename K, typename H>
+template <typename CompatibleKeyType>
+bool ezFlatHashSetBase<K, H>::Remove(const CompatibleKeyType& key)
+{
+  ezUInt32 uiIndex = FindEntry(key);
+  if (uiIndex != ezInvalidIndex)
+  {
+    RemoveInternal(uiIndex);
+    return true;
+  }
+
+  return false;
+}
+
+template <typename K, typename H>
+typename ezFlatHashSetBase<K, H>::ConstIterator ezFlatHashSetBase<K, H>::Remove(const typename ezFlatHashSetBase<K, H>::ConstIterator& pos)
+{
+  ConstIterator it = pos;
+  ezUInt32 uiIndex = pos.m_uiCurrentIndex;
+  ++it;
+  --it.m_uiCurrentCount;
+  RemoveInternal(uiIndex);
+  return it;
+}
+
+template <typename K, typename H>
+void ezFlatHashSetBase<K, H>::RemoveInternal(ezUInt32 uiIndex)
+{
+  ezMemoryUtils::Destruct(&m_pEntries[uiIndex], 1);
+
+  // see ezFlatHashTableBase::RemoveInternal
+  const Group group(m_pControl + (uiIndex & ~(Group::Size - 1)));
+  if (group.MatchEmpty().HasAny())
+  {
+    m_pControl[uiIndex] = Group::EmptyControl;
+    ++m_uiGrowthLeft;
+  }
+  else
+  {
+    m_pControl[uiIndex] = Group::DeletedControl;
+  }
+
+  --m_uiCount;
+}
+
+template <typename K, typename H>
+template <typename CompatibleKeyType>
+EZ_FORCE_INLINE bool ezFlatHashSetBase<K, H>::Contains(const CompatibleKeyType& key) const
+{
+  return FindEntry(key) != ezInvalidIndex;
+}
+
+template <typename K, typename H>
+bool ezFlatHashSetBase<K, H>::ContainsSet(const ezFlatHashSetBase<K, H>& operand) const
+{
+  for (const K& key : operand)
+  {
+    if (!Contains(key))
+      return false;
+  }
+
+  return true;
+}
+
+template <typename K, typename H>
+void ezFlatHashSetBase<K, H>::Union(const ezFlatHashSetBase<K, H>& operand)
+{
+  Reserve(GetCount() + operand.GetCount());
+  for (const auto& key : operand)
+  {
+    Insert(key);
+  }
+}
+
+template <typename K, typename H>
+void ezFlatHashSetBase<K, H>::Difference(const ezFlatHashSetBase<K, H>& operand)
+{
+  for (const auto& key : operand)
+  {
+    Remove(key);
+  }
+}
+
+template <typename K, typename H>
+void ezFlatHashSetBase<K, H>::Intersection(const ezFlatHashSetBase<K, H>& operand)
+{
+  for (auto it = GetIterator(); it.IsValid();)
+  {
+    if (!operand.Contains(it.Key()))
+      it = Remove(it);
+    else
+      ++it;
+  }
+}
+
+template <typename K, typename H>
+EZ_FORCE_INLINE typename ezFlatHashSetBase<K, H>::ConstIterator ezFlatHashSetBase<K, H>::GetIterator() const
+{
+  ConstIterator iterator(*this);
+  iterator.SetToBegin();
+  return iterator;
+}
+
+template <typename K, typename H>
+EZ_FORCE_INLINE typename ezFlatHashSetBase<K, H>::ConstIterator ezFlatHashSetBase<K, H>::GetEndIterator() const
+{
+  ConstIterator iterator(*this);
+  iterator.SetToEnd();
+  return iterator;
+}
+
+template <typename K, typename H>
+EZ_ALWAYS_INLINE ezAllocatorBase* ezFlatHashSetBase<K, H>::GetAllocator() const
+{
+  return m_pAllocator;
+}
+
+template <typename K, typename H>
+ezUInt64 ezFlatHashSetBase<K, H>::GetHeapMemoryUsage() const
+{
+  return (ezUInt64)m_uiCapacity * (sizeof(K) + sizeof(ezUInt8));
+}
+
+template <typename K, typename H>
+void ezFlatHashSetBase<K, H>::Swap(ezFlatHashSetBase<K, H>& other)
+{
+  ezMath::Swap(this->m_pEntries, other.m_pEntries);
+  ezMath::Swap(this->m_pControl, other.m_pControl);
+  ezMath::Swap(this->m_uiCount, other.m_uiCount);
+  ezMath::Swap(this->m_uiCapacity, other.m_uiCapacity);
+  ezMath::Swap(this->m_uiGrowthLeft, other.m_uiGrowthLeft);
+  ezMath::Swap(this->m_pAllocator, other.m_pAllocator);
+}
+
+// private methods
+template <typename K, typename H>
+void ezFlatHashSetBase<K, H>::SetCapacity(ezUInt32 uiCapacity)
+{
+  EZ_ASSERT_DEV(ezMath::IsPowerOf2(uiCapacity) && uiCapacity >= Group::Size, "uiCapacity must be a power of two and at least one group.");
+  EZ_ASSERT_DEV(GetMaxLoad(uiCapacity) >= m_uiCount, "uiCapacity is too small for the current number of keys.");
+
+  const ezUInt32 uiOldCapacity = m_uiCapacity;
+  K* pOldEntries = m_pEntries;
+  ezUInt8* pOldControl = m_pControl;
+
+  m_uiCapacity = uiCapacity;
+  m_pEntries = EZ_NEW_RAW_BUFFER(m_pAllocator, K, m_uiCapacity);
+  m_pControl = EZ_NEW_RAW_BUFFER(m_pAllocator, ezUInt8, m_uiCapacity);
+  ezMemoryUtils::PatternFill(m_pControl, Group::EmptyControl, m_uiCapacity);
+
+  m_uiGrowthLeft = GetMaxLoad(m_uiCapacity) - m_uiCount;
+
+  for (ezUInt32 i = 0; i < uiOldCapacity; ++i)
+  {
+    if (Group::IsFull(pOldControl[i]))
+    {
+      // the set does not contain any duplicates, so the keys can be placed without comparing them
+      const ezUInt32 uiHash = H::Hash(pOldEntries[i]);
+      const ezUInt32 uiIndex = FindInsertSlot(uiHash);
+      m_pControl[uiIndex] = Group::GetControl(uiHash);
+
+      ezMemoryUtils::RelocateConstruct(&m_pEntries[uiIndex], &pOldEntries[i], 1);
+    }
+  }
+
+  EZ_DELETE_RAW_BUFFER(m_pAllocator, pOldEntries);
+  EZ_DELETE_RAW_BUFFER(m_pAllocator, pOldControl);
+}
+
+template <typename K, typename H>
+void ezFlatHashSetBase<K, H>::Deallocate()
+{
+  EZ_DELETE_RAW_BUFFER(m_pAllocator, m_pEntries);
+  EZ_DELETE_RAW_BUFFER(m_pAllocator, m_pControl);
+  m_uiCapacity = 0;
+  m_uiGrowthLeft = 0;
+}
+
+template <typename K, typename H>
+template <typename CompatibleKeyType>
+EZ_FORCE_INLINE ezUInt32 ezFlatHashSetBase<K, H>::FindEntry(const CompatibleKeyType& key) const
+{
+  return FindEntry(H::Hash(key), key);
+}
+
+template <typename K, typename H>
+template <typename CompatibleKeyType>
+inline ezUInt32 ezFlatHashSetBase<K, H>::FindEntry(ezUInt32 uiHash, const CompatibleKeyType& key) const
+{
+  if (m_uiCapacity > 0)
+  {
+    const ezUInt8 uiControl = Group::GetControl(uiHash);
+    const ezUInt32 uiGroupMask = (m_uiCapacity / Group::Size) - 1;
+
+    ezUInt32 uiGroupIndex = uiHash & uiGroupMask;
+    for (ezUInt32 uiProbe = 1; uiProbe <= uiGroupMask + 1; ++uiProbe)
+    {
+      const ezUInt32 uiFirstIndex = uiGroupIndex * Group::Size;
+      const Group group(m_pControl + uiFirstIndex);
+
+      for (auto match = group.Match(uiControl); match.HasAny();)
+      {
+        const ezUInt32 uiIndex = uiFirstIndex + match.TakeFirst();
+        if (H::Equal(m_pEntries[uiIndex], key))
+          return uiIndex;
+      }
+
+      // a key with this hash would have been placed into this group
+      if (group.MatchEmpty().HasAny())
+        break;
+
+      // triangular numbers visit every group exactly once
+      uiGroupIndex = (uiGroupIndex + uiProbe) & uiGroupMask;
+    }
+  }
+  // not found
+  return ezInvalidIndex;
+}
+
+template <typename K, typename H>
+ezUInt32 ezFlatHashSetBase<K, H>::PrepareInsert(ezUInt32 uiHash)
+{
+  if (m_uiCapacity == 0)
+  {
+    SetCapacity(Group::Size);
+  }
+
+  ezUInt32 uiIndex = FindInsertSlot(uiHash);
+
+  // deleted slots can always be reused, free slots only as long as the maximum load is not reached
+  if (m_uiGrowthLeft == 0 && m_pControl[uiIndex] == Group::EmptyControl)
+  {
+    // if more than half of the used slots are only marked as deleted, it is enough to rehash the set in place
+    const ezUInt32 uiNewCapacity = (m_uiCount < GetMaxLoad(m_uiCapacity) / 2) ? m_uiCapacity : m_uiCapacity * 2;
+    SetCapacity(uiNewCapacity);
+
+    uiIndex = FindInsertSlot(uiHash);
+  }
+
+  if (m_pControl[uiIndex] == Group::EmptyControl)
+  {
+    --m_uiGrowthLeft;
+  }
+
+  m_pControl[uiIndex] = Group::GetControl(uiHash);
+  ++m_uiCount;
+
+  return uiIndex;
+}
+
+template <typename K, typename H>
+ezUInt32 ezFlatHashSetBase<K, H>::FindInsertSlot(ezUInt32 uiHash) const
+{
+  const ezUInt32 uiGroupMask = (m_uiCapacity / Group::Size) - 1;
+
+  ezUInt32 uiGroupIndex = uiHash & uiGroupMask;
+  for (ezUInt32 uiProbe = 1;; ++uiProbe)
+  {
+    auto match = Group(m_pControl + uiGroupIndex * Group::Size).MatchEmptyOrDeleted();
+    if (match.HasAny())
+      return uiGroupIndex * Group::Size + match.TakeFirst();
+
+    // the maximum load guarantees that there is always a free slot
+    EZ_ASSERT_DEBUG(uiProbe <= uiGroupMask, "Implementation error");
+    uiGroupIndex = (uiGroupIndex + uiProbe) & uiGroupMask;
+  }
+}
+
+template <typename K, typename H>
+ezUInt32 ezFlatHashSetBase<K, H>::FindNextValidEntry(ezUInt32 uiEntryIndex) const
+{
+  while (uiEntryIndex < m_uiCapacity)
+  {
+    const ezUInt32 uiFirstIndex = uiEntryIndex & ~(Group::Size - 1);
+    auto match = Group(m_pControl + uiFirstIndex).MatchFull();
+
+    // ignore the keys before the start index
+    match.m_uiMask &= ~((1u << (uiEntryIndex - uiFirstIndex)) - 1);
+
+    if (match.HasAny())
+      return uiFirstIndex + match.TakeFirst();
+
+    uiEntryIndex = uiFirstIndex + Group::Size;
+  }
+
+  return m_uiCapacity;
+}
+
+template <typename K, typename H>
+EZ_ALWAYS_INLINE ezUInt32 ezFlatHashSetBase<K, H>::GetMaxLoad(ezUInt32 uiCapacity)
+{
+  return uiCapacity - uiCapacity / 8;
+}
+
+
+template <typename K, typename H, typename A>
+ezFlatHashSet<K, H, A>::ezFlatHashSet()
+  : ezFlatHashSetBase<K, H>(A::GetAllocator())
+{
+}
+
+template <typename K, typename H, typename A>
+ezFlatHashSet<K, H, A>::ezFlatHashSet(ezAllocatorBase* pAllocator)
+  : ezFlatHashSetBase<K, H>(pAllocator)
+{
+}
+
+template <typename K, typename H, typename A>
+ezFlatHashSet<K, H, A>::ezFlatHashSet(const ezFlatHashSet<K, H, A>& other)
+  : ezFlatHashSetBase<K, H>(other, A::GetAllocator())
+{
+}
+
+template <typename K, typename H, typename A>
+ezFlatHashSet<K, H, A>::ezFlatHashSet(const ezFlatHashSetBase<K, H>& other)
+  : ezFlatHashSetBase<K, H>(other, A::GetAllocator())
+{
+}
+
+template <typename K, typename H, typename A>
+ezFlatHashSet<K, H, A>::ezFlatHashSet(ezFlatHashSet<K, H, A>&& other)
+  : ezFlatHashSetBase<K, H>(std::move(other), other.GetAllocator())
+{
+}
+
+template <typename K, typename H, typename A>
+ezFlatHashSet<K, H, A>::ezFlatHashSet(ezFlatHashSetBase<K, H>&& other)
+  : ezFlatHashSetBase<K, H>(std::move(other), other.GetAllocator())
+{
+}
+
+template <typename K, typename H, typename A>
+void ezFlatHashSet<K, H, A>::operator=(const ezFlatHashSet<K, H, A>& rhs)
+{
+  ezFlatHashSetBase<K, H>::operator=(rhs);
+}
+
+template <typename K, typename H, typename A>
+void ezFlatHashSet<K, H, A>::operator=(const ezFlatHashSetBase<K, H>& rhs)
+{
+  ezFlatHashSetBase<K, H>::operator=(rhs);
+}
+
+template <typename K, typename H, typename A>
+void ezFlatHashSet<K, H, A>::operator=(ezFlatHashSet<K, H, A>&& rhs)
+{
+  ezFlatHashSetBase<K, H>::operator=(std::move(rhs));
+}
+
+template <typename K, typename H, typename A>
+void ezFlatHashSet<K, H, A>::operator=(ezFlatHashSetBase<K, H>&& rhs)
+{
+  ezFlatHashSetBase<K, H>::operator=(std::move(rhs));
+}
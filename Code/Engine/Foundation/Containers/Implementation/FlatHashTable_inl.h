@@ -0,0 +1,760 @@
+
+/// \brief Value used by containers for indices to indicate an invalid index.
+#ifndef ezInvalidIndex
+#  define ezInvalidIndex 0xFFFFFFFF
+#endif
+
+// ***** Const Iterator *****
+
+template <typename K, typename V, typename H>
+ezFlatHashTableBase<K, V, H>::ConstIterator::ConstIterator(const ezFlatHashTableBase<K, V, H>& hashTable)
+  : m_hashTable(&hashTable)
+{
+}
+
+template <typename K, typename V, typename H>
+void ezFlatHashTableBase<K, V, H>::ConstIterator::SetToBegin()
+{
+  if (m_hashTable->IsEmpty())
+  {
+    m_uiCurrentIndex = m_hashTable->m_uiCapacity;
+    return;
+  }
+
+  m_uiCurrentIndex = m_hashTable->FindNextValidEntry(0);
+}
+
+template <typename K, typename V, typename H>
+inline void ezFlatHashTableBase<K, V, H>::ConstIterator::SetToEnd()
+{
+  m_uiCurrentCount = m_hashTable->m_uiCount;
+  m_uiCurrentIndex = m_hashTable->m_uiCapacity;
+}
+
+template <typename K, typename V, typename H>
+EZ_FORCE_INLINE bool ezFlatHashTableBase<K, V, H>::ConstIterator::IsValid() const
+{
+  return m_uiCurrentCount < m_hashTable->m_uiCount;
+}
+
+template <typename K, typename V, typename H>
+EZ_FORCE_INLINE bool ezFlatHashTableBase<K, V, H>::ConstIterator::operator==(const typename ezFlatHashTableBase<K, V, H>::ConstIterator& rhs) const
+{
+  return m_uiCurrentIndex == rhs.m_uiCurrentIndex && m_hashTable->m_pEntries == rhs.m_hashTable->m_pEntries;
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE bool ezFlatHashTableBase<K, V, H>::ConstIterator::operator!=(const typename ezFlatHashTableBase<K, V, H>::ConstIterator& rhs) const
+{
+  return !(*this == rhs);
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE const K& ezFlatHashTableBase<K, V, H>::ConstIterator::Key() const
+{
+  return m_hashTable->m_pEntries[m_uiCurrentIndex].key;
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE const V& ezFlatHashTableBase<K, V, H>::ConstIterator::Value() const
+{
+  return m_hashTable->m_pEntries[m_uiCurrentIndex].value;
+}
+
+template <typename K, typename V, typename H>
+void ezFlatHashTableBase<K, V, H>::ConstIterator::Next()
+{
+  // if we already iterated over the amount of valid elements that the hash-table stores, early out
+  if (m_uiCurrentCount >= m_hashTable->m_uiCount)
+    return;
+
+  // increase the counter of how many elements we have seen
+  ++m_uiCurrentCount;
+
+  m_uiCurrentIndex = m_hashTable->FindNextValidEntry(m_uiCurrentIndex + 1);
+
+  // if there is no valid entry after this one, we reached the end of all elements in the container
+  // set the m_uiCurrentCount to maximum, to enable early-out in the future and to make 'IsValid' return 'false'
+  if (m_uiCurrentIndex == m_hashTable->m_uiCapacity)
+  {
+    m_uiCurrentCount = m_hashTable->m_uiCount;
+  }
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE void ezFlatHashTableBase<K, V, H>::ConstIterator::operator++()
+{
+  Next();
+}
+
+
+// ***** Iterator *****
+
+template <typename K, typename V, typename H>
+ezFlatHashTableBase<K, V, H>::Iterator::Iterator(const ezFlatHashTableBase<K, V, H>& hashTable)
+  : ConstIterator(hashTable)
+{
+}
+
+template <typename K, typename V, typename H>
+ezFlatHashTableBase<K, V, H>::Iterator::Iterator(const typename ezFlatHashTableBase<K, V, H>::Iterator& rhs)
+  : ConstIterator(*rhs.m_hashTable)
+{
+  this->m_uiCurrentIndex = rhs.m_uiCurrentIndex;
+  this->m_uiCurrentCount = rhs.m_uiCurrentCount;
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE void ezFlatHashTableBase<K, V, H>::Iterator::operator=(const Iterator& rhs) // [tested]
+{
+  this->m_hashTable = rhs.m_hashTable;
+  this->m_uiCurrentIndex = rhs.m_uiCurrentIndex;
+  this->m_uiCurrentCount = rhs.m_uiCurrentCount;
+}
+
+template <typename K, typename V, typename H>
+EZ_FORCE_INLINE V& ezFlatHashTableBase<K, V, H>::Iterator::Value()
+{
+  return this->m_hashTable->m_pEntries[this->m_uiCurrentIndex].value;
+}
+
+
+// ***** ezFlatHashTableBase *****
+
+template <typename K, typename V, typename H>
+ezFlatHashTableBase<K, V, H>::ezFlatHashTableBase(ezAllocatorBase* pAllocator)
+{
+  m_pEntries = nullptr;
+  m_pControl = nullptr;
+  m_uiCount = 0;
+  m_uiCapacity = 0;
+  m_uiGrowthLeft = 0;
+  m_pAllocator = pAllocator;
+}
+
+template <typename K, typename V, typename H>
+ezFlatHashTableBase<K, V, H>::ezFlatHashTableBase(const ezFlatHashTableBase<K, V, H>& other, ezAllocatorBase* pAllocator)
+{
+  m_pEntries = nullptr;
+  m_pControl = nullptr;
+  m_uiCount = 0;
+  m_uiCapacity = 0;
+  m_uiGrowthLeft = 0;
+  m_pAllocator = pAllocator;
+
+  *this = other;
+}
+
+template <typename K, typename V, typename H>
+ezFlatHashTableBase<K, V, H>::ezFlatHashTableBase(ezFlatHashTableBase<K, V, H>&& other, ezAllocatorBase* pAllocator)
+{
+  m_pEntries = nullptr;
+  m_pControl = nullptr;
+  m_uiCount = 0;
+  m_uiCapacity = 0;
+  m_uiGrowthLeft = 0;
+  m_pAllocator = pAllocator;
+
+  *this = std::move(other);
+}
+
+template <typename K, typename V, typename H>
+ezFlatHashTableBase<K, V, H>::~ezFlatHashTableBase()
+{
+  Clear();
+  Deallocate();
+}
+
+template <typename K, typename V, typename H>
+void ezFlatHashTableBase<K, V, H>::operator=(const ezFlatHashTableBase<K, V, H>& rhs)
+{
+  Clear();
+  Reserve(rhs.GetCount());
+
+  for (ezUInt32 i = rhs.FindNextValidEntry(0); i < rhs.m_uiCapacity; i = rhs.FindNextValidEntry(i + 1))
+  {
+    Insert(rhs.m_pEntries[i].key, rhs.m_pEntries[i].value);
+  }
+}
+
+template <typename K, typename V, typename H>
+void ezFlatHashTableBase<K, V, H>::operator=(ezFlatHashTableBase<K, V, H>&& rhs)
+{
+  // Clear any existing data (calls destructors if necessary)
+  Clear();
+
+  if (m_pAllocator != rhs.m_pAllocator)
+  {
+    Reserve(rhs.m_uiCount);
+
+    for (ezUInt32 i = rhs.FindNextValidEntry(0); i < rhs.m_uiCapacity; i = rhs.FindNextValidEntry(i + 1))
+    {
+      Insert(std::move(rhs.m_pEntries[i].key), std::move(rhs.m_pEntries[i].value));
+    }
+
+    rhs.Clear();
+  }
+  else
+  {
+    Deallocate();
+
+    // Move all data over.
+    m_pEntries = rhs.m_pEntries;
+    m_pControl = rhs.m_pControl;
+    m_uiCount = rhs.m_uiCount;
+    m_uiCapacity = rhs.m_uiCapacity;
+    m_uiGrowthLeft = rhs.m_uiGrowthLeft;
+
+    // Temp copy forgets all its state.
+    rhs.m_pEntries = nullptr;
+    rhs.m_pControl = nullptr;
+    rhs.m_uiCount = 0;
+    rhs.m_uiCapacity = 0;
+    rhs.m_uiGrowthLeft = 0;
+  }
+}
+
+template <typename K, typename V, typename H>
+bool ezFlatHashTableBase<K, V, H>::operator==(const ezFlatHashTableBase<K, V, H>& rhs) const
+{
+  if (m_uiCount != rhs.m_uiCount)
+    return false;
+
+  for (ezUInt32 i = FindNextValidEntry(0); i < m_uiCapacity; i = FindNextValidEntry(i + 1))
+  {
+    const V* pRhsValue = nullptr;
+    if (!rhs.TryGetValue(m_pEntries[i].key, pRhsValue))
+      return false;
+
+    if (m_pEntries[i].value != *pRhsValue)
+      return false;
+  }
+
+  return true;
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE bool ezFlatHashTableBase<K, V, H>::operator!=(const ezFlatHashTableBase<K, V, H>& rhs) const
+{
+  return !(*this == rhs);
+}
+
+template <typename K, typename V, typename H>
+void ezFlatHashTableBase<K, V, H>::Reserve(ezUInt32 uiCapacity)
+{
+  // ensure a maximum load of 87.5%
+  const ezUInt32 uiNewCapacity = ezMath::Max<ezUInt32>(ezMath::PowerOfTwo_Ceil(uiCapacity + (uiCapacity + 6) / 7), Group::Size);
+  if (m_uiCapacity >= uiNewCapacity)
+    return;
+
+  SetCapacity(uiNewCapacity);
+}
+
+template <typename K, typename V, typename H>
+void ezFlatHashTableBase<K, V, H>::Compact()
+{
+  if (IsEmpty())
+  {
+    // completely deallocate all data, if the table is empty.
+    Deallocate();
+  }
+  else
+  {
+    // also rehashes a table of the same size to remove all deleted markers
+    SetCapacity(ezMath::Max<ezUInt32>(ezMath::PowerOfTwo_Ceil(m_uiCount + (m_uiCount + 6) / 7), Group::Size));
+  }
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE ezUInt32 ezFlatHashTableBase<K, V, H>::GetCount() const
+{
+  return m_uiCount;
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE bool ezFlatHashTableBase<K, V, H>::IsEmpty() const
+{
+  return m_uiCount == 0;
+}
+
+template <typename K, typename V, typename H>
+void ezFlatHashTableBase<K, V, H>::Clear()
+{
+  for (ezUInt32 i = FindNextValidEntry(0); i < m_uiCapacity; i = FindNextValidEntry(i + 1))
+  {
+    ezMemoryUtils::Destruct(&m_pEntries[i].key, 1);
+    ezMemoryUtils::Destruct(&m_pEntries[i].value, 1);
+  }
+
+  ezMemoryUtils::PatternFill(m_pControl, Group::EmptyControl, m_uiCapacity);
+  m_uiCount = 0;
+  m_uiGrowthLeft = GetMaxLoad(m_uiCapacity);
+}
+
+template <typename K, typename V, typename H>
+template <typename CompatibleKeyType, typename CompatibleValueType>
+bool ezFlatHashTableBase<K, V, H>::Insert(CompatibleKeyType&& key, CompatibleValueType&& value, V* out_oldValue /*= nullptr*/)
+{
+  const ezUInt32 uiHash = H::Hash(key);
+  ezUInt32 uiIndex = FindEntry(uiHash, key);
+
+  if (uiIndex != ezInvalidIndex)
+  {
+    if (out_oldValue != nullptr)
+      *out_oldValue = std::move(m_pEntries[uiIndex].value);
+
+    m_pEntries[uiIndex].value = std::forward<CompatibleValueType>(value); // Either move or copy assignment.
+    return true;
+  }
+
+  // new entry
+  uiIndex = PrepareInsert(uiHash);
+
+  // Both constructions might either be a move or a copy.
+  ezMemoryUtils::CopyOrMoveConstruct(&m_pEntries[uiIndex].key, std::forward<CompatibleKeyType>(key));
+  ezMemoryUtils::CopyOrMoveConstruct(&m_pEntries[uiIndex].value, std::forward<CompatibleValueType>(value));
+
+  return false;
+}
+
+template <typename K, typename V, typename H>
+template <typename CompatibleKeyType>
+bool ezFlatHashTableBase<K, V, H>::Remove(const CompatibleKeyType& key, V* out_oldValue /*= nullptr*/)
+{
+  ezUInt32 uiIndex = FindEntry(key);
+  if (uiIndex != ezInvalidIndex)
+  {
+    if (out_oldValue != nullptr)
+      *out_oldValue = std::move(m_pEntries[uiIndex].value);
+
+    RemoveInternal(uiIndex);
+    return true;
+  }
+
+  return false;
+}
+
+template <typename K, typename V, typename H>
+typename ezFlatHashTableBase<K, V, H>::Iterator ezFlatHashTableBase<K, V, H>::Remove(const typename ezFlatHashTableBase<K, V, H>::Iterator& pos)
+{
+  Iterator it = pos;
+  ezUInt32 uiIndex = pos.m_uiCurrentIndex;
+  ++it;
+  --it.m_uiCurrentCount;
+  RemoveInternal(uiIndex);
+  return it;
+}
+
+template <typename K, typename V, typename H>
+void ezFlatHashTableBase<K, V, H>::RemoveInternal(ezUInt32 uiIndex)
+{
+  ezMemoryUtils::Destruct(&m_pEntries[uiIndex].key, 1);
+  ezMemoryUtils::Destruct(&m_pEntries[uiIndex].value, 1);
+
+  // Lookups only continue with the next group if a group has no free slot. Free slots are only created by a rehash or here,
+  // so if the group of this entry already has a free slot, no lookup ever continued past it and this slot can be freed as well.
+  const Group group(m_pControl + (uiIndex & ~(Group::Size - 1)));
+  if (group.MatchEmpty().HasAny())
+  {
+    m_pControl[uiIndex] = Group::EmptyControl;
+    ++m_uiGrowthLeft;
+  }
+  else
+  {
+    m_pControl[uiIndex] = Group::DeletedControl;
+  }
+
+  --m_uiCount;
+}
+
+template <typename K, typename V, typename H>
+template <typename CompatibleKeyType>
+inline bool ezFlatHashTableBase<K, V, H>::TryGetValue(const CompatibleKeyType& key, V& out_value) const
+{
+  ezUInt32 uiIndex = FindEntry(key);
+  if (uiIndex != ezInvalidIndex)
+  {
+    out_value = m_pEntries[uiIndex].value;
+    return true;
+  }
+
+  return false;
+}
+
+template <typename K, typename V, typename H>
+template <typename CompatibleKeyType>
+inline bool ezFlatHashTableBase<K, V, H>::TryGetValue(const CompatibleKeyType& key, const V*& out_pValue) const
+{
+  ezUInt32 uiIndex = FindEntry(key);
+  if (uiIndex != ezInvalidIndex)
+  {
+    out_pValue = &m_pEntries[uiIndex].value;
+    return true;
+  }
+
+  return false;
+}
+
+template <typename K, typename V, typename H>
+template <typename CompatibleKeyType>
+inline bool ezFlatHashTableBase<K, V, H>::TryGetValue(const CompatibleKeyType& key, V*& out_pValue)
+{
+  ezUInt32 uiIndex = FindEntry(key);
+  if (uiIndex != ezInvalidIndex)
+  {
+    out_pValue = &m_pEntries[uiIndex].value;
+    return true;
+  }
+
+  return false;
+}
+
+template <typename K, typename V, typename H>
+template <typename CompatibleKeyType>
+inline typename ezFlatHashTableBase<K, V, H>::ConstIterator ezFlatHashTableBase<K, V, H>::Find(const CompatibleKeyType& key) const
+{
+  ezUInt32 uiIndex = FindEntry(key);
+  if (uiIndex == ezInvalidIndex)
+  {
+    return GetEndIterator();
+  }
+
+  ConstIterator it(*this);
+  it.m_uiCurrentIndex = uiIndex;
+  it.m_uiCurrentCount = 0; // we do not know the 'count' (which is used as an optimization), so we just use 0
+
+  return it;
+}
+
+template <typename K, typename V, typename H>
+template <typename CompatibleKeyType>
+inline typename ezFlatHashTableBase<K, V, H>::Iterator ezFlatHashTableBase<K, V, H>::Find(const CompatibleKeyType& key)
+{
+  ezUInt32 uiIndex = FindEntry(key);
+  if (uiIndex == ezInvalidIndex)
+  {
+    return GetEndIterator();
+  }
+
+  Iterator it(*this);
+  it.m_uiCurrentIndex = uiIndex;
+  it.m_uiCurrentCount = 0; // we do not know the 'count' (which is used as an optimization), so we just use 0
+  return it;
+}
+
+template <typename K, typename V, typename H>
+template <typename CompatibleKeyType>
+inline const V* ezFlatHashTableBase<K, V, H>::GetValue(const CompatibleKeyType& key) const
+{
+  ezUInt32 uiIndex = FindEntry(key);
+  return (uiIndex != ezInvalidIndex) ? &m_pEntries[uiIndex].value : nullptr;
+}
+
+template <typename K, typename V, typename H>
+template <typename CompatibleKeyType>
+inline V* ezFlatHashTableBase<K, V, H>::GetValue(const CompatibleKeyType& key)
+{
+  ezUInt32 uiIndex = FindEntry(key);
+  return (uiIndex != ezInvalidIndex) ? &m_pEntries[uiIndex].value : nullptr;
+}
+
+template <typename K, typename V, typename H>
+inline V& ezFlatHashTableBase<K, V, H>::operator[](const K& key)
+{
+  const ezUInt32 uiHash = H::Hash(key);
+  ezUInt32 uiIndex = FindEntry(uiHash, key);
+
+  if (uiIndex == ezInvalidIndex)
+  {
+    // new entry
+    uiIndex = PrepareInsert(uiHash);
+
+    ezMemoryUtils::CopyConstruct(&m_pEntries[uiIndex].key, key, 1);
+    ezMemoryUtils::DefaultConstruct(&m_pEntries[uiIndex].value, 1);
+  }
+  return m_pEntries[uiIndex].value;
+}
+
+template <typename K, typename V, typename H>
+template <typename CompatibleKeyType>
+EZ_FORCE_INLINE bool ezFlatHashTableBase<K, V, H>::Contains(const CompatibleKeyType& key) const
+{
+  return FindEntry(key) != ezInvalidIndex;
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE typename ezFlatHashTableBase<K, V, H>::Iterator ezFlatHashTableBase<K, V, H>::GetIterator()
+{
+  Iterator iterator(*this);
+  iterator.SetToBegin();
+  return iterator;
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE typename ezFlatHashTableBase<K, V, H>::Iterator ezFlatHashTableBase<K, V, H>::GetEndIterator()
+{
+  Iterator iterator(*this);
+  iterator.SetToEnd();
+  return iterator;
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE typename ezFlatHashTableBase<K, V, H>::ConstIterator ezFlatHashTableBase<K, V, H>::GetIterator() const
+{
+  ConstIterator iterator(*this);
+  iterator.SetToBegin();
+  return iterator;
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE typename ezFlatHashTableBase<K, V, H>::ConstIterator ezFlatHashTableBase<K, V, H>::GetEndIterator() const
+{
+  ConstIterator iterator(*this);
+  iterator.SetToEnd();
+  return iterator;
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE ezAllocatorBase* ezFlatHashTableBase<K, V, H>::GetAllocator() const
+{
+  return m_pAllocator;
+}
+
+template <typename K, typename V, typename H>
+ezUInt64 ezFlatHashTableBase<K, V, H>::GetHeapMemoryUsage() const
+{
+  return (ezUInt64)m_uiCapacity * (sizeof(Entry) + sizeof(ezUInt8));
+}
+
+template <typename K, typename V, typename H>
+void ezFlatHashTableBase<K, V, H>::Swap(ezFlatHashTableBase<K, V, H>& other)
+{
+  ezMath::Swap(this->m_pEntries, other.m_pEntries);
+  ezMath::Swap(this->m_pControl, other.m_pControl);
+  ezMath::Swap(this->m_uiCount, other.m_uiCount);
+  ezMath::Swap(this->m_uiCapacity, other.m_uiCapacity);
+  ezMath::Swap(this->m_uiGrowthLeft, other.m_uiGrowthLeft);
+  ezMath::Swap(this->m_pAllocator, other.m_pAllocator);
+}
+
+// private methods
+template <typename K, typename V, typename H>
+void ezFlatHashTableBase<K, V, H>::SetCapacity(ezUInt32 uiCapacity)
+{
+  EZ_ASSERT_DEV(ezMath::IsPowerOf2(uiCapacity) && uiCapacity >= Group::Size, "uiCapacity must be a power of two and at least one group.");
+  EZ_ASSERT_DEV(GetMaxLoad(uiCapacity) >= m_uiCount, "uiCapacity is too small for the current number of entries.");
+
+  const ezUInt32 uiOldCapacity = m_uiCapacity;
+  Entry* pOldEntries = m_pEntries;
+  ezUInt8* pOldControl = m_pControl;
+
+  m_uiCapacity = uiCapacity;
+  m_pEntries = EZ_NEW_RAW_BUFFER(m_pAllocator, Entry, m_uiCapacity);
+  m_pControl = EZ_NEW_RAW_BUFFER(m_pAllocator, ezUInt8, m_uiCapacity);
+  ezMemoryUtils::PatternFill(m_pControl, Group::EmptyControl, m_uiCapacity);
+
+  m_uiGrowthLeft = GetMaxLoad(m_uiCapacity) - m_uiCount;
+
+  for (ezUInt32 i = 0; i < uiOldCapacity; ++i)
+  {
+    if (Group::IsFull(pOldControl[i]))
+    {
+      // the table does not contain any duplicates, so the entries can be placed without comparing any keys
+      const ezUInt32 uiHash = H::Hash(pOldEntries[i].key);
+      const ezUInt32 uiIndex = FindInsertSlot(uiHash);
+      m_pControl[uiIndex] = Group::GetControl(uiHash);
+
+      ezMemoryUtils::RelocateConstruct(&m_pEntries[uiIndex].key, &pOldEntries[i].key, 1);
+      ezMemoryUtils::RelocateConstruct(&m_pEntries[uiIndex].value, &pOldEntries[i].value, 1);
+    }
+  }
+
+  EZ_DELETE_RAW_BUFFER(m_pAllocator, pOldEntries);
+  EZ_DELETE_RAW_BUFFER(m_pAllocator, pOldControl);
+}
+
+template <typename K, typename V, typename H>
+void ezFlatHashTableBase<K, V, H>::Deallocate()
+{
+  EZ_DELETE_RAW_BUFFER(m_pAllocator, m_pEntries);
+  EZ_DELETE_RAW_BUFFER(m_pAllocator, m_pControl);
+  m_uiCapacity = 0;
+  m_uiGrowthLeft = 0;
+}
+
+template <typename K, typename V, typename H>
+template <typename CompatibleKeyType>
+EZ_ALWAYS_INLINE ezUInt32 ezFlatHashTableBase<K, V, H>::FindEntry(const CompatibleKeyType& key) const
+{
+  return FindEntry(H::Hash(key), key);
+}
+
+template <typename K, typename V, typename H>
+template <typename CompatibleKeyType>
+inline ezUInt32 ezFlatHashTableBase<K, V, H>::FindEntry(ezUInt32 uiHash, const CompatibleKeyType& key) const
+{
+  if (m_uiCapacity > 0)
+  {
+    const ezUInt8 uiControl = Group::GetControl(uiHash);
+    const ezUInt32 uiGroupMask = (m_uiCapacity / Group::Size) - 1;
+
+    ezUInt32 uiGroupIndex = uiHash & uiGroupMask;
+    for (ezUInt32 uiProbe = 1; uiProbe <= uiGroupMask + 1; ++uiProbe)
+    {
+      const ezUInt32 uiFirstIndex = uiGroupIndex * Group::Size;
+      const Group group(m_pControl + uiFirstIndex);
+
+      for (auto match = group.Match(uiControl); match.HasAny();)
+      {
+        const ezUInt32 uiIndex = uiFirstIndex + match.TakeFirst();
+        if (H::Equal(m_pEntries[uiIndex].key, key))
+          return uiIndex;
+      }
+
+      // an entry with this key would have been placed into this group
+      if (group.MatchEmpty().HasAny())
+        break;
+
+      // triangular numbers visit every group exactly once
+      uiGroupIndex = (uiGroupIndex + uiProbe) & uiGroupMask;
+    }
+  }
+  // not found
+  return ezInvalidIndex;
+}
+
+template <typename K, typename V, typename H>
+ezUInt32 ezFlatHashTableBase<K, V, H>::PrepareInsert(ezUInt32 uiHash)
+{
+  if (m_uiCapacity == 0)
+  {
+    SetCapacity(Group::Size);
+  }
+
+  ezUInt32 uiIndex = FindInsertSlot(uiHash);
+
+  // deleted slots can always be reused, free slots only as long as the maximum load is not reached
+  if (m_uiGrowthLeft == 0 && m_pControl[uiIndex] == Group::EmptyControl)
+  {
+    // if more than half of the used slots are only marked as deleted, it is enough to rehash the table in place
+    const ezUInt32 uiNewCapacity = (m_uiCount < GetMaxLoad(m_uiCapacity) / 2) ? m_uiCapacity : m_uiCapacity * 2;
+    SetCapacity(uiNewCapacity);
+
+    uiIndex = FindInsertSlot(uiHash);
+  }
+
+  if (m_pControl[uiIndex] == Group::EmptyControl)
+  {
+    --m_uiGrowthLeft;
+  }
+
+  m_pControl[uiIndex] = Group::GetControl(uiHash);
+  ++m_uiCount;
+
+  return uiIndex;
+}
+
+template <typename K, typename V, typename H>
+ezUInt32 ezFlatHashTableBase<K, V, H>::FindInsertSlot(ezUInt32 uiHash) const
+{
+  const ezUInt32 uiGroupMask = (m_uiCapacity / Group::Size) - 1;
+
+  ezUInt32 uiGroupIndex = uiHash & uiGroupMask;
+  for (ezUInt32 uiProbe = 1;; ++uiProbe)
+  {
+    auto match = Group(m_pControl + uiGroupIndex * Group::Size).MatchEmptyOrDeleted();
+    if (match.HasAny())
+      return uiGroupIndex * Group::Size + match.TakeFirst();
+
+    // the maximum load guarantees that there is always a free slot
+    EZ_ASSERT_DEBUG(uiProbe <= uiGroupMask, "Implementation error");
+    uiGroupIndex = (uiGroupIndex + uiProbe) & uiGroupMask;
+  }
+}
+
+template <typename K, typename V, typename H>
+ezUInt32 ezFlatHashTableBase<K, V, H>::FindNextValidEntry(ezUInt32 uiEntryIndex) const
+{
+  while (uiEntryIndex < m_uiCapacity)
+  {
+    const ezUInt32 uiFirstIndex = uiEntryIndex & ~(Group::Size - 1);
+    auto match = Group(m_pControl + uiFirstIndex).MatchFull();
+
+    // ignore the entries before the start index
+    match.m_uiMask &= ~((1u << (uiEntryIndex - uiFirstIndex)) - 1);
+
+    if (match.HasAny())
+      return uiFirstIndex + match.TakeFirst();
+
+    uiEntryIndex = uiFirstIndex + Group::Size;
+  }
+
+  return m_uiCapacity;
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE ezUInt32 ezFlatHashTableBase<K, V, H>::GetMaxLoad(ezUInt32 uiCapacity)
+{
+  return uiCapacity - uiCapacity / 8;
+}
+
+
+template <typename K, typename V, typename H, typename A>
+ezFlatHashTable<K, V, H, A>::ezFlatHashTable()
+  : ezFlatHashTableBase<K, V, H>(A::GetAllocator())
+{
+}
+
+template <typename K, typename V, typename H, typename A>
+ezFlatHashTable<K, V, H, A>::ezFlatHashTable(ezAllocatorBase* pAllocator)
+  : ezFlatHashTableBase<K, V, H>(pAllocator)
+{
+}
+
+template <typename K, typename V, typename H, typename A>
+ezFlatHashTable<K, V, H, A>::ezFlatHashTable(const ezFlatHashTable<K, V, H, A>& other)
+  : ezFlatHashTableBase<K, V, H>(other, A::GetAllocator())
+{
+}
+
+template <typename K, typename V, typename H, typename A>
+ezFlatHashTable<K, V, H, A>::ezFlatHashTable(const ezFlatHashTableBase<K, V, H>& other)
+  : ezFlatHashTableBase<K, V, H>(other, A::GetAllocator())
+{
+}
+
+template <typename K, typename V, typename H, typename A>
+ezFlatHashTable<K, V, H, A>::ezFlatHashTable(ezFlatHashTable<K, V, H, A>&& other)
+  : ezFlatHashTableBase<K, V, H>(std::move(other), other.GetAllocator())
+{
+}
+
+template <typename K, typename V, typename H, typename A>
+ezFlatHashTable<K, V, H, A>::ezFlatHashTable(ezFlatHashTableBase<K, V, H>&& other)
+  : ezFlatHashTableBase<K, V, H>(std::move(other), other.GetAllocator())
+{
+}
+
+template <typename K, typename V, typename H, typename A>
+void ezFlatHashTable<K, V, H, A>::operator=(const ezFlatHashTable<K, V, H, A>& rhs)
+{
+  ezFlatHashTableBase<K, V, H>::operator=(rhs);
+}
+
+template <typename K, typename V, typename H, typename A>
+void ezFlatHashTable<K, V, H, A>::operator=(const ezFlatHashTableBase<K, V, H>& rhs)
+{
+  ezFlatHashTableBase<K, V, H>::operator=(rhs);
+}
+
+template <typename K, typename V, typename H, typename A>
+void ezFlatHashTable<K, V, H, A>::operator=(ezFlatHashTable<K, V, H, A>&& rhs)
+{
+  ezFlatHashTableBase<K, V, H>::operator=(std::move(rhs));
+}
+
+template <typename K, typename V, typename H, typename A>
+void ezFlatHashTable<K, V, H, A>::operator=(ezFlatHashTableBase<K, V, H>&& rhs)
+{
+  ezFlatHashTableBase<K, V, H>::operator=(std::move(rhs));
+}
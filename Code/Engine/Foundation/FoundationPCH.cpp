@@ -111,7 +111,9 @@ EZ_STATICLINK_LIBRARY(Foundation)
   EZ_STATICLINK_REFERENCE(Foundation_Memory_Implementation_MemoryUtils);
   EZ_STATICLINK_REFERENCE(Foundation_Memory_Implementation_PageAllocator);
   EZ_STATICLINK_REFERENCE(Foundation_Memory_Policies_GuardedAllocation);
+  EZ_STATICLINK_REFERENCE(Foundation_Memory_Policies_SmallObjectAllocation);
   EZ_STATICLINK_REFERENCE(Foundation_Profiling_Implementation_Profiling);
+  EZ_STATICLINK_REFERENCE(Foundation_Profiling_Implementation_ProfilingTrace);
   EZ_STATICLINK_REFERENCE(Foundation_Reflection_Implementation_PropertyAttributes);
   EZ_STATICLINK_REFERENCE(Foundation_Reflection_Implementation_PropertyPath);
   EZ_STATICLINK_REFERENCE(Foundation_Reflection_Implementation_RTTI);
@@ -1,10 +1,13 @@
 #include <FoundationPCH.h>
 
+#include <Foundation/Configuration/Startup.h>
 #include <Foundation/Logging/Log.h>
 #include <Foundation/Strings/StringBuilder.h>
+#include <Foundation/Strings/StringConversion.h>
+#include <Foundation/Threading/Thread.h>
+#include <Foundation/Threading/ThreadSignal.h>
 #include <Foundation/Time/Time.h>
 #include <Foundation/Time/Timestamp.h>
-#include <Foundation/Strings/StringConversion.h>
 
 #if EZ_ENABLED(EZ_PLATFORM_WINDOWS)
 #  include <Foundation/Logging/Implementation/Win/ETWProvider_win.h>
@@ -23,6 +26,301 @@ static ezMutex s_OverrideLogMutex;
 /// \brief The log system that messages are sent to when the user specifies no system himself.
 static thread_local ezLogInterface* s_DefaultLogSystem = nullptr;
 
+namespace
+{
+  enum
+  {
+    ASYNC_LOG_QUEUE_SIZE = 64 * 1024,                     ///< Per thread, must be a power of two
+    ASYNC_LOG_MAX_STRING_LENGTH = ASYNC_LOG_QUEUE_SIZE / 4, ///< Longer texts and tags are truncated
+  };
+
+  /// Header of a message in an ezAsyncLogQueue, followed by the tag and the text without terminators.
+  struct ezAsyncLogEntryHeader
+  {
+    EZ_DECLARE_POD_TYPE();
+
+    double m_fSeconds;
+    ezUInt32 m_uiSize; ///< Including the header and the padding to the next entry
+    ezUInt32 m_uiTextLength;
+    ezUInt16 m_uiTagLength;
+    ezInt8 m_EventType;
+    ezUInt8 m_uiIndentation;
+    bool m_bHasText; ///< Flush messages don't have a text at all
+  };
+
+  /// A ring buffer with a single producer, the thread that owns it, and a single consumer, whoever holds s_AsyncDispatchMutex.
+  /// The read and write positions only ever increase and are wrapped when the data is accessed.
+  struct ezAsyncLogQueue
+  {
+    bool IsEmpty() const { return m_iReadPos == m_iWritePos; }
+
+    void Write(ezUInt32 uiPos, const void* pData, ezUInt32 uiSize)
+    {
+      if (uiSize == 0)
+        return;
+
+      const ezUInt32 uiOffset = uiPos & (ASYNC_LOG_QUEUE_SIZE - 1);
+      const ezUInt32 uiFirstPart = ezMath::Min<ezUInt32>(uiSize, ASYNC_LOG_QUEUE_SIZE - uiOffset);
+
+      ezMemoryUtils::Copy(m_Data + uiOffset, static_cast<const ezUInt8*>(pData), uiFirstPart);
+      ezMemoryUtils::Copy(m_Data, static_cast<const ezUInt8*>(pData) + uiFirstPart, uiSize - uiFirstPart);
+    }
+
+    void Read(ezUInt32 uiPos, void* pData, ezUInt32 uiSize) const
+    {
+      if (uiSize == 0)
+        return;
+
+      const ezUInt32 uiOffset = uiPos & (ASYNC_LOG_QUEUE_SIZE - 1);
+      const ezUInt32 uiFirstPart = ezMath::Min<ezUInt32>(uiSize, ASYNC_LOG_QUEUE_SIZE - uiOffset);
+
+      ezMemoryUtils::Copy(static_cast<ezUInt8*>(pData), m_Data + uiOffset, uiFirstPart);
+      ezMemoryUtils::Copy(static_cast<ezUInt8*>(pData) + uiFirstPart, m_Data, uiSize - uiFirstPart);
+    }
+
+    ezUInt8 m_Data[ASYNC_LOG_QUEUE_SIZE];
+    ezAtomicInteger32 m_iWritePos; ///< Only modified by the producer
+    ezAtomicInteger32 m_iReadPos;  ///< Only modified by the consumer
+
+    /// Cleared when the owning thread exits, so that the next new thread can take over the queue including its pending messages.
+    ezAtomicInteger32 m_iInUse = 1;
+
+    /// Queues are only removed from the list on core systems shutdown, so that threads may come and go without synchronizing with the logging thread.
+    ezAsyncLogQueue* m_pNext = nullptr;
+  };
+
+  class ezAsyncLogThread : public ezThread
+  {
+  public:
+    ezAsyncLogThread()
+      : ezThread("Async Log")
+    {
+    }
+
+    volatile bool m_bRunning = true;
+
+  private:
+    virtual ezUInt32 Run() override;
+  };
+
+  static volatile bool s_bAsyncMode = false;
+  static ezAsyncLogThread* s_pAsyncLogThread = nullptr;
+  static ezMutex s_AsyncLogThreadMutex;
+  static ezThreadSignal s_AsyncLogSignal;
+
+  static ezAsyncLogQueue* s_pAsyncLogQueues = nullptr;
+  static ezMutex s_AsyncLogQueuesMutex;
+
+  /// Incremented whenever all queues are freed, which invalidates the queue references of all threads.
+  static ezAtomicInteger32 s_iAsyncLogQueueGeneration;
+
+  /// The queue of a thread. It is handed back when the thread exits, so that the queues are recycled instead of leaked.
+  struct ezAsyncLogQueueRef
+  {
+    ~ezAsyncLogQueueRef()
+    {
+      EZ_LOCK(s_AsyncLogQueuesMutex);
+
+      if (ezAsyncLogQueue* pQueue = Get())
+      {
+        pQueue->m_iInUse = 0;
+      }
+    }
+
+    ezAsyncLogQueue* Get() const { return m_iGeneration == s_iAsyncLogQueueGeneration ? m_pQueue : nullptr; }
+
+    ezAsyncLogQueue* m_pQueue = nullptr;
+    ezInt32 m_iGeneration = 0;
+  };
+
+  static thread_local ezAsyncLogQueueRef s_AsyncLogQueue;
+
+  static ezMutex s_AsyncDispatchMutex;
+
+  /// Set while a thread passes queued messages to the log writers. Messages that the writers log themselves are dispatched right away.
+  static thread_local bool s_bDispatchingAsyncMessages = false;
+
+  ezUInt32 ezAsyncLogThread::Run()
+  {
+    while (m_bRunning)
+    {
+      // the signal is only raised when a queue was empty, the timeout catches messages that were added during the last dispatch
+      s_AsyncLogSignal.WaitForSignal(ezTime::Milliseconds(10));
+      ezGlobalLog::FlushAsyncMessages();
+    }
+
+    return 0;
+  }
+
+  ezUInt32 GetTruncatedLength(const char* szString)
+  {
+    ezUInt32 uiLength = ezStringUtils::GetStringElementCount(szString);
+    if (uiLength <= ASYNC_LOG_MAX_STRING_LENGTH)
+      return uiLength;
+
+    // don't cut a character in half
+    uiLength = ASYNC_LOG_MAX_STRING_LENGTH;
+    while (uiLength > 0 && ezUnicodeUtils::IsUtf8ContinuationByte(szString[uiLength]))
+    {
+      --uiLength;
+    }
+
+    return uiLength;
+  }
+
+  ezAsyncLogQueue* AcquireAsyncLogQueue()
+  {
+    EZ_LOCK(s_AsyncLogQueuesMutex);
+
+    // take over the queue of a thread that has exited, its remaining messages are simply dispatched before the new ones
+    for (ezAsyncLogQueue* pQueue = s_pAsyncLogQueues; pQueue != nullptr; pQueue = pQueue->m_pNext)
+    {
+      if (pQueue->m_iInUse.TestAndSet(0, 1))
+        return pQueue;
+    }
+
+    // use new, not EZ_DEFAULT_NEW, to prevent tracking, just like the thread local ezGlobalLog
+    ezAsyncLogQueue* pQueue = new ezAsyncLogQueue;
+    pQueue->m_pNext = s_pAsyncLogQueues;
+    s_pAsyncLogQueues = pQueue;
+
+    return pQueue;
+  }
+
+  /// Only called on core systems shutdown, after async mode has been disabled and all messages have been dispatched.
+  void FreeAsyncLogQueues()
+  {
+    EZ_LOCK(s_AsyncLogQueuesMutex);
+
+    while (s_pAsyncLogQueues != nullptr)
+    {
+      ezAsyncLogQueue* pQueue = s_pAsyncLogQueues;
+      s_pAsyncLogQueues = pQueue->m_pNext;
+      delete pQueue;
+    }
+
+    s_iAsyncLogQueueGeneration.Increment();
+  }
+
+  void QueueAsyncMessage(const ezLoggingEventData& le)
+  {
+    ezAsyncLogQueue* pQueue = s_AsyncLogQueue.Get();
+    if (pQueue == nullptr)
+    {
+      pQueue = AcquireAsyncLogQueue();
+
+      s_AsyncLogQueue.m_pQueue = pQueue;
+      s_AsyncLogQueue.m_iGeneration = s_iAsyncLogQueueGeneration;
+    }
+
+    ezAsyncLogQueue& queue = *pQueue;
+
+    ezAsyncLogEntryHeader header;
+    header.m_EventType = le.m_EventType;
+    header.m_uiIndentation = le.m_uiIndentation;
+    header.m_bHasText = le.m_szText != nullptr;
+    header.m_uiTagLength = static_cast<ezUInt16>(GetTruncatedLength(le.m_szTag));
+    header.m_uiTextLength = GetTruncatedLength(le.m_szText);
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+    header.m_fSeconds = le.m_fSeconds;
+#else
+    header.m_fSeconds = 0;
+#endif
+    header.m_uiSize = ezMemoryUtils::AlignSize<ezUInt32>(sizeof(header) + header.m_uiTagLength + header.m_uiTextLength, 8);
+
+    const ezUInt32 uiWritePos = queue.m_iWritePos;
+
+    if (ASYNC_LOG_QUEUE_SIZE - (uiWritePos - static_cast<ezUInt32>(queue.m_iReadPos)) < header.m_uiSize)
+    {
+      // the logging thread can't keep up, help it out instead of dropping messages
+      ezGlobalLog::FlushAsyncMessages();
+    }
+
+    const bool bWasEmpty = queue.IsEmpty();
+
+    queue.Write(uiWritePos, &header, sizeof(header));
+    queue.Write(uiWritePos + sizeof(header), le.m_szTag, header.m_uiTagLength);
+    queue.Write(uiWritePos + sizeof(header) + header.m_uiTagLength, le.m_szText, header.m_uiTextLength);
+    queue.m_iWritePos = static_cast<ezInt32>(uiWritePos + header.m_uiSize);
+
+    // only wake up the logging thread once per burst of messages
+    if (bWasEmpty)
+    {
+      s_AsyncLogSignal.RaiseSignal();
+    }
+  }
+
+  void DispatchAsyncMessages(ezLoggingEvent& loggingEvent)
+  {
+    const bool bWasDispatching = s_bDispatchingAsyncMessages;
+    s_bDispatchingAsyncMessages = true;
+
+    ezHybridArray<char, 256> tag;
+    ezHybridArray<char, 1024> text;
+
+    bool bDispatchedAny = true;
+    while (bDispatchedAny)
+    {
+      bDispatchedAny = false;
+
+      ezAsyncLogQueue* pQueues = nullptr;
+      {
+        // new queues are only ever added at the front
+        EZ_LOCK(s_AsyncLogQueuesMutex);
+        pQueues = s_pAsyncLogQueues;
+      }
+
+      for (ezAsyncLogQueue* pQueue = pQueues; pQueue != nullptr; pQueue = pQueue->m_pNext)
+      {
+        ezUInt32 uiReadPos = pQueue->m_iReadPos;
+        const ezUInt32 uiWritePos = pQueue->m_iWritePos;
+
+        while (uiReadPos != uiWritePos)
+        {
+          ezAsyncLogEntryHeader header;
+          pQueue->Read(uiReadPos, &header, sizeof(header));
+
+          tag.SetCountUninitialized(header.m_uiTagLength + 1);
+          text.SetCountUninitialized(header.m_uiTextLength + 1);
+          pQueue->Read(uiReadPos + sizeof(header), tag.GetData(), header.m_uiTagLength);
+          pQueue->Read(uiReadPos + sizeof(header) + header.m_uiTagLength, text.GetData(), header.m_uiTextLength);
+          tag[header.m_uiTagLength] = '\0';
+          text[header.m_uiTextLength] = '\0';
+
+          ezLoggingEventData le;
+          le.m_EventType = static_cast<ezLogMsgType::Enum>(header.m_EventType);
+          le.m_uiIndentation = header.m_uiIndentation;
+          le.m_szTag = tag.GetData();
+          le.m_szText = header.m_bHasText ? text.GetData() : nullptr;
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+          le.m_fSeconds = header.m_fSeconds;
+#endif
+
+          loggingEvent.Broadcast(le);
+
+          uiReadPos += header.m_uiSize;
+          pQueue->m_iReadPos = static_cast<ezInt32>(uiReadPos);
+          bDispatchedAny = true;
+        }
+      }
+    }
+
+    s_bDispatchingAsyncMessages = bWasDispatching;
+  }
+} // namespace
+
+// clang-format off
+EZ_BEGIN_SUBSYSTEM_DECLARATION(Foundation, Logging)
+
+  ON_CORESYSTEMS_SHUTDOWN
+  {
+    ezGlobalLog::SetAsyncMode(false);
+    FreeAsyncLogQueues();
+  }
+
+EZ_END_SUBSYSTEM_DECLARATION;
+// clang-format on
+
 
 ezEventSubscriptionID ezGlobalLog::AddLogWriter(ezLoggingEvent::Handler handler)
 {
@@ -76,10 +374,77 @@ void ezGlobalLog::HandleLogMessage(const ezLoggingEventData& le)
     if ((ThisType > ezLogMsgType::None) && (ThisType < ezLogMsgType::All))
       s_uiMessageCount[ThisType].Increment();
 
+    if (!s_bDispatchingAsyncMessages)
+    {
+      if (s_bAsyncMode)
+      {
+        QueueAsyncMessage(le);
+        return;
+      }
+
+      // messages that were queued before async mode was disabled come first
+      ezAsyncLogQueue* pQueue = s_AsyncLogQueue.Get();
+      if (pQueue != nullptr && !pQueue->IsEmpty())
+      {
+        FlushAsyncMessages();
+      }
+    }
+
     s_LoggingEvent.Broadcast(le);
   }
 }
 
+void ezGlobalLog::SetAsyncMode(bool bEnable)
+{
+  EZ_LOCK(s_AsyncLogThreadMutex);
+
+  if (bEnable == (s_pAsyncLogThread != nullptr))
+    return;
+
+  if (bEnable)
+  {
+    s_pAsyncLogThread = EZ_DEFAULT_NEW(ezAsyncLogThread);
+    s_pAsyncLogThread->Start();
+
+    s_bAsyncMode = true;
+  }
+  else
+  {
+    s_bAsyncMode = false;
+
+    s_pAsyncLogThread->m_bRunning = false;
+    s_AsyncLogSignal.RaiseSignal();
+    s_pAsyncLogThread->Join();
+
+    EZ_DEFAULT_DELETE(s_pAsyncLogThread);
+
+    FlushAsyncMessages();
+  }
+}
+
+bool ezGlobalLog::IsAsyncMode()
+{
+  return s_bAsyncMode;
+}
+
+void ezGlobalLog::FlushAsyncMessages()
+{
+  EZ_LOCK(s_AsyncDispatchMutex);
+  DispatchAsyncMessages(s_LoggingEvent);
+}
+
+bool ezGlobalLog::TryFlushAsyncMessages()
+{
+  // the mutex is recursive, so this also prevents a thread that crashed while dispatching from dispatching again
+  if (s_bDispatchingAsyncMessages || !s_AsyncDispatchMutex.TryLock())
+    return false;
+
+  DispatchAsyncMessages(s_LoggingEvent);
+
+  s_AsyncDispatchMutex.Unlock();
+  return true;
+}
+
 ezLogBlock::ezLogBlock(const char* szName, const char* szContextInfo)
 {
   m_pLogInterface = ezLog::GetThreadLocalLogSystem();
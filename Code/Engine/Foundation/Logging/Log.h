@@ -117,6 +117,28 @@ public:
   /// override is set at the moment.
   static void SetGlobalLogOverride(ezLogInterface* pInterface);
 
+  /// \brief Enables or disables asynchronous dispatching of log messages to the log writers.
+  ///
+  /// In async mode every thread copies its messages into its own lock-free queue and returns right away. A dedicated logging thread
+  /// passes them on to the log writers, so in this mode the writers are called on that thread. The messages of one thread keep their order,
+  /// and therefore also the nesting of their log blocks, but messages of different threads may be interleaved differently than they were logged.
+  /// Message counts and the global log override are still handled synchronously.
+  ///
+  /// Disabling async mode dispatches all pending messages first. Async mode is disabled automatically on core systems shutdown.
+  static void SetAsyncMode(bool bEnable);
+
+  /// \brief Returns whether log messages are currently dispatched asynchronously.
+  static bool IsAsyncMode();
+
+  /// \brief Dispatches all messages that are still queued in async mode and returns once the log writers have handled them.
+  static void FlushAsyncMessages();
+
+  /// \brief Same as FlushAsyncMessages(), but returns false right away instead of waiting when another thread is dispatching messages.
+  ///
+  /// This is called by the crash handlers before they write the crash report, so that the messages right before a crash are not lost.
+  /// It must not wait, because the crashed thread itself might have been dispatching messages.
+  static bool TryFlushAsyncMessages();
+
 private:
   /// \brief Counts the number of messages of each type.
   static ezAtomicInteger32 s_uiMessageCount[ezLogMsgType::ENUM_COUNT];
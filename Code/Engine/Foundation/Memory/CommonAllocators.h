@@ -9,6 +9,7 @@
 #include <Foundation/Memory/Policies/GuardedAllocation.h>
 #include <Foundation/Memory/Policies/HeapAllocation.h>
 #include <Foundation/Memory/Policies/ProxyAllocation.h>
+#include <Foundation/Memory/Policies/SmallObjectAllocation.h>
 
 
 /// \brief Default heap allocator
@@ -23,3 +24,6 @@ typedef ezAllocator<ezMemoryPolicies::ezGuardedAllocation> ezGuardedAllocator;
 /// \brief Proxy allocator
 typedef ezAllocator<ezMemoryPolicies::ezProxyAllocation> ezProxyAllocator;
 
+/// \brief Allocator for many small allocations from many threads
+typedef ezAllocator<ezMemoryPolicies::ezSmallObjectAllocation> ezSmallObjectAllocator;
+
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Foundation/Memory/StackAllocator.h>
+#include <Foundation/Threading/ThreadUtils.h>
 
 /// \brief A double buffered stack allocator
 class EZ_FOUNDATION_DLL ezDoubleBufferedStackAllocator
@@ -12,6 +13,7 @@ public:
   ~ezDoubleBufferedStackAllocator();
 
   EZ_ALWAYS_INLINE ezAllocatorBase* GetCurrentAllocator() const { return m_pCurrentAllocator; }
+  EZ_ALWAYS_INLINE ezAllocatorBase* GetOtherAllocator() const { return m_pOtherAllocator; }
 
   void Swap();
   void Reset();
@@ -21,20 +23,109 @@ private:
   StackAllocatorType* m_pOtherAllocator;
 };
 
+/// \brief A linear allocator that belongs to one thread and hands out memory from chunks of a frame allocator buffer.
+///
+/// Allocations only bump a pointer inside the current chunk, no lock is taken unless a new chunk has to be requested from the
+/// shared stack allocator. Every allocation is preceded by a small header that stores its size and destructor, which makes
+/// Deallocate() lock free as well. Memory is only given back when the arena is reset together with its frame allocator buffer.
+/// Allocations with an alignment above 16 bytes get a dedicated block from the shared stack allocator.
+///
+/// An arena may be passed to other threads (e.g. as the allocator of a container), allocations from a thread that does not own
+/// the arena are redirected to the arena of that thread.
+class EZ_FOUNDATION_DLL ezFrameAllocatorArena : public ezAllocatorBase
+{
+public:
+  ezFrameAllocatorArena();
+  ~ezFrameAllocatorArena();
+
+  virtual void* Allocate(size_t uiSize, size_t uiAlign, ezMemoryUtils::DestructorFunction destructorFunc) override;
+  virtual void Deallocate(void* ptr) override;
+  virtual void* Reallocate(void* ptr, size_t uiCurrentSize, size_t uiNewSize, size_t uiAlign) override;
+  virtual size_t AllocatedSize(const void* ptr) override;
+  virtual ezAllocatorId GetId() const override;
+  virtual Stats GetStats() const override;
+
+  /// \brief The number of bytes that were taken from the shared allocator since the last reset, including headers and unused chunk space.
+  ezUInt64 GetUsedMemory() const { return m_uiUsedMemory; }
+
+  /// \brief The highest value of GetUsedMemory() that was reached in any frame.
+  ezUInt64 GetPeakMemory() const { return ezMath::Max(m_uiPeakMemory, m_uiUsedMemory); }
+
+private:
+  friend class ezFrameAllocator;
+
+  enum
+  {
+    Alignment = 16,
+    HeaderSize = 16,
+    ChunkSize = 64 * 1024,
+    MaxChunkAllocationSize = ChunkSize / 4,
+  };
+
+  struct AllocationHeader
+  {
+    ezMemoryUtils::DestructorFunction m_Func;
+    ezUInt32 m_uiSize;
+  };
+
+  void* AllocateLocal(size_t uiSize, size_t uiAlign, ezMemoryUtils::DestructorFunction destructorFunc);
+  void Reset();
+
+  EZ_ALWAYS_INLINE static AllocationHeader* GetHeader(const void* ptr)
+  {
+    return reinterpret_cast<AllocationHeader*>(const_cast<ezUInt8*>(static_cast<const ezUInt8*>(ptr) - HeaderSize));
+  }
+
+  ezAllocatorBase* m_pParent = nullptr;
+  ezThreadID m_ThreadID;
+  ezUInt32 m_uiBuffer = 0;
+
+  ezUInt8* m_pNextAllocation = nullptr;
+  ezUInt8* m_pChunkEnd = nullptr;
+
+  ezUInt64 m_uiNumAllocations = 0;
+  ezUInt64 m_uiUsedMemory = 0;
+  ezUInt64 m_uiPeakMemory = 0;
+
+  /// Allocations with a destructor, which is called on reset unless the allocation was deallocated before.
+  ezDynamicArray<AllocationHeader*> m_Destructors;
+};
+
+/// \brief Provides memory that is only valid for the current and the next frame.
+///
+/// GetCurrentAllocator() returns an ezFrameAllocatorArena that belongs to the calling thread, so threads that allocate
+/// concurrently, e.g. during render data extraction, do not contend for a lock. The arenas take their memory in large chunks from
+/// an ezDoubleBufferedStackAllocator and are reset together with it in Swap().
 class EZ_FOUNDATION_DLL ezFrameAllocator
 {
 public:
-  EZ_ALWAYS_INLINE static ezAllocatorBase* GetCurrentAllocator() { return s_pAllocator->GetCurrentAllocator(); }
+  static ezAllocatorBase* GetCurrentAllocator();
 
   static void Swap();
   static void Reset();
 
+  struct ThreadStats
+  {
+    ezThreadID m_ThreadID;
+    ezUInt64 m_uiCurrentMemory = 0; ///< The memory used by this thread in the current frame.
+    ezUInt64 m_uiPeakMemory = 0;    ///< The highest memory usage of this thread in any frame.
+  };
+
+  /// \brief Returns the memory usage of every thread that has allocated from the frame allocator.
+  static void GetThreadStats(ezDynamicArray<ThreadStats>& out_Stats);
+
 private:
+  friend class ezFrameAllocatorArena;
+  friend struct ezFrameAllocatorThreadDataGuard;
   EZ_MAKE_SUBSYSTEM_STARTUP_FRIEND(Foundation, FrameAllocator);
 
   static void Startup();
   static void Shutdown();
 
+  /// \brief Called when a thread exits, its arenas are deleted in Swap() once their memory has been reset.
+  static void RetireThreadData();
+
+  static ezFrameAllocatorArena* GetThreadArena(ezUInt32 uiBuffer);
+
   static ezDoubleBufferedStackAllocator* s_pAllocator;
 };
-
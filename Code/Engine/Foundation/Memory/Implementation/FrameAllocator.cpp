@@ -4,6 +4,8 @@
 #include <Foundation/Memory/FrameAllocator.h>
 #include <Foundation/Profiling/Profiling.h>
 #include <Foundation/Strings/StringBuilder.h>
+#include <Foundation/Threading/Lock.h>
+#include <Foundation/Threading/Mutex.h>
 
 ezDoubleBufferedStackAllocator::ezDoubleBufferedStackAllocator(const char* szName, ezAllocatorBase* pParent)
 {
@@ -37,6 +39,135 @@ void ezDoubleBufferedStackAllocator::Reset()
   m_pOtherAllocator->Reset();
 }
 
+ezFrameAllocatorArena::ezFrameAllocatorArena() = default;
+
+ezFrameAllocatorArena::~ezFrameAllocatorArena()
+{
+  Reset();
+}
+
+void* ezFrameAllocatorArena::Allocate(size_t uiSize, size_t uiAlign, ezMemoryUtils::DestructorFunction destructorFunc)
+{
+  EZ_ASSERT_DEV(ezMath::IsPowerOf2((ezInt32)uiAlign), "Alignment {0} is not a power of two", ((ezUInt32)uiAlign));
+
+  if (m_ThreadID != ezThreadUtils::GetCurrentThreadID())
+  {
+    // the arena has been handed to another thread, which uses its own arena for the same buffer instead
+    return ezFrameAllocator::GetThreadArena(m_uiBuffer)->AllocateLocal(uiSize, uiAlign, destructorFunc);
+  }
+
+  return AllocateLocal(uiSize, uiAlign, destructorFunc);
+}
+
+void* ezFrameAllocatorArena::AllocateLocal(size_t uiSize, size_t uiAlign, ezMemoryUtils::DestructorFunction destructorFunc)
+{
+  EZ_ASSERT_DEV(m_pParent != nullptr, "Frame allocator arena is used without a frame allocator buffer");
+  EZ_ASSERT_DEV(uiSize <= ezMath::MaxValue<ezUInt32>(), "Allocation of {0} bytes is too large for the frame allocator", (ezUInt64)uiSize);
+
+  // The header directly precedes the returned pointer. With a larger alignment than the one of the chunks the header is placed at
+  // the end of a padding of uiAlign bytes, which only pays off for a dedicated block.
+  const size_t uiHeaderSize = ezMath::Max((size_t)HeaderSize, uiAlign);
+  const size_t uiAllocationSize = uiHeaderSize + ezMemoryUtils::AlignSize(uiSize, (size_t)Alignment);
+
+  ezUInt8* pMemory = nullptr;
+
+  if (uiAllocationSize > MaxChunkAllocationSize || uiAlign > Alignment)
+  {
+    // large allocations get their own block, so that the rest of the current chunk is not wasted
+    pMemory = static_cast<ezUInt8*>(m_pParent->Allocate(uiAllocationSize, ezMath::Max((size_t)Alignment, uiAlign), nullptr));
+    pMemory += uiHeaderSize - HeaderSize;
+    m_uiUsedMemory += uiAllocationSize;
+  }
+  else
+  {
+    if (static_cast<size_t>(m_pChunkEnd - m_pNextAllocation) < uiAllocationSize)
+    {
+      m_pNextAllocation = static_cast<ezUInt8*>(m_pParent->Allocate(ChunkSize, Alignment, nullptr));
+      m_pChunkEnd = m_pNextAllocation + ChunkSize;
+      m_uiUsedMemory += ChunkSize;
+    }
+
+    pMemory = m_pNextAllocation;
+    m_pNextAllocation += uiAllocationSize;
+  }
+
+  AllocationHeader* pHeader = reinterpret_cast<AllocationHeader*>(pMemory);
+  pHeader->m_Func = destructorFunc;
+  pHeader->m_uiSize = static_cast<ezUInt32>(uiSize);
+
+  if (destructorFunc != nullptr)
+  {
+    m_Destructors.PushBack(pHeader);
+  }
+
+  ++m_uiNumAllocations;
+
+  return pMemory + HeaderSize;
+}
+
+void ezFrameAllocatorArena::Deallocate(void* ptr)
+{
+  // Individual deallocation is not supported, only make sure that the destructor is not called again on reset
+  GetHeader(ptr)->m_Func = nullptr;
+}
+
+void* ezFrameAllocatorArena::Reallocate(void* ptr, size_t uiCurrentSize, size_t uiNewSize, size_t uiAlign)
+{
+  AllocationHeader* pHeader = GetHeader(ptr);
+
+  // the last allocation in the current chunk can grow in place
+  if (m_ThreadID == ezThreadUtils::GetCurrentThreadID() && pHeader->m_Func == nullptr && ptr >= m_pChunkEnd - ChunkSize && ptr < m_pChunkEnd)
+  {
+    ezUInt8* pEnd = static_cast<ezUInt8*>(ptr) + ezMemoryUtils::AlignSize((size_t)pHeader->m_uiSize, (size_t)Alignment);
+    ezUInt8* pNewEnd = static_cast<ezUInt8*>(ptr) + ezMemoryUtils::AlignSize(uiNewSize, (size_t)Alignment);
+
+    if (pEnd == m_pNextAllocation && pNewEnd <= m_pChunkEnd)
+    {
+      m_pNextAllocation = pNewEnd;
+      pHeader->m_uiSize = static_cast<ezUInt32>(uiNewSize);
+      return ptr;
+    }
+  }
+
+  return ezAllocatorBase::Reallocate(ptr, uiCurrentSize, uiNewSize, uiAlign);
+}
+
+size_t ezFrameAllocatorArena::AllocatedSize(const void* ptr)
+{
+  return GetHeader(ptr)->m_uiSize;
+}
+
+ezAllocatorId ezFrameAllocatorArena::GetId() const
+{
+  return m_pParent != nullptr ? m_pParent->GetId() : ezAllocatorId();
+}
+
+ezAllocatorBase::Stats ezFrameAllocatorArena::GetStats() const
+{
+  Stats stats;
+  stats.m_uiNumAllocations = m_uiNumAllocations;
+  stats.m_uiAllocationSize = m_uiUsedMemory;
+  return stats;
+}
+
+void ezFrameAllocatorArena::Reset()
+{
+  for (ezUInt32 i = m_Destructors.GetCount(); i-- > 0;)
+  {
+    AllocationHeader* pHeader = m_Destructors[i];
+    if (pHeader->m_Func != nullptr)
+    {
+      pHeader->m_Func(reinterpret_cast<ezUInt8*>(pHeader) + HeaderSize);
+    }
+  }
+  m_Destructors.Clear();
+
+  m_pNextAllocation = nullptr;
+  m_pChunkEnd = nullptr;
+
+  m_uiPeakMemory = ezMath::Max(m_uiPeakMemory, m_uiUsedMemory);
+  m_uiUsedMemory = 0;
+}
 
 // clang-format off
 EZ_BEGIN_SUBSYSTEM_DECLARATION(Foundation, FrameAllocator)
@@ -54,14 +185,112 @@ EZ_BEGIN_SUBSYSTEM_DECLARATION(Foundation, FrameAllocator)
 EZ_END_SUBSYSTEM_DECLARATION;
 // clang-format on
 
+namespace
+{
+  struct ezFrameAllocatorThreadData
+  {
+    ezFrameAllocatorArena m_Arenas[2];
+
+    // set when the owning thread has exited
+    bool m_bRetired = false;
+    ezUInt32 m_uiSwapsSinceRetired = 0;
+  };
+
+  // the stack allocators of both buffers, the arenas of the current buffer are handed out by GetCurrentAllocator()
+  static ezAllocatorBase* s_BufferAllocators[2];
+  static ezUInt32 s_uiCurrentBuffer = 0;
+
+  // incremented on every startup to detect thread local data of a previous startup
+  static ezUInt32 s_uiGeneration = 0;
+
+  static ezDynamicArray<ezFrameAllocatorThreadData*> s_AllThreadData;
+  static ezMutex s_AllThreadDataMutex;
+
+  static thread_local ezFrameAllocatorThreadData* s_pThreadData = nullptr;
+  static thread_local ezUInt32 s_uiThreadDataGeneration = 0;
+} // namespace
+
+struct ezFrameAllocatorThreadDataGuard
+{
+  ~ezFrameAllocatorThreadDataGuard() { ezFrameAllocator::RetireThreadData(); }
+
+  bool m_bActive = false;
+};
+
+static thread_local ezFrameAllocatorThreadDataGuard s_ThreadDataGuard;
+
 ezDoubleBufferedStackAllocator* ezFrameAllocator::s_pAllocator;
 
+// static
+ezAllocatorBase* ezFrameAllocator::GetCurrentAllocator()
+{
+  return GetThreadArena(s_uiCurrentBuffer);
+}
+
+// static
+ezFrameAllocatorArena* ezFrameAllocator::GetThreadArena(ezUInt32 uiBuffer)
+{
+  if (s_uiThreadDataGeneration != s_uiGeneration)
+  {
+    EZ_LOCK(s_AllThreadDataMutex);
+
+    ezFrameAllocatorThreadData* pThreadData = EZ_DEFAULT_NEW(ezFrameAllocatorThreadData);
+
+    for (ezUInt32 i = 0; i < 2; ++i)
+    {
+      ezFrameAllocatorArena& arena = pThreadData->m_Arenas[i];
+      arena.m_pParent = s_BufferAllocators[i];
+      arena.m_ThreadID = ezThreadUtils::GetCurrentThreadID();
+      arena.m_uiBuffer = i;
+    }
+
+    s_AllThreadData.PushBack(pThreadData);
+
+    s_pThreadData = pThreadData;
+    s_uiThreadDataGeneration = s_uiGeneration;
+
+    // makes sure the guard is constructed for this thread, so that the data is retired when the thread exits
+    s_ThreadDataGuard.m_bActive = true;
+  }
+
+  return &s_pThreadData->m_Arenas[uiBuffer];
+}
+
 // static
 void ezFrameAllocator::Swap()
 {
   EZ_PROFILE_SCOPE("FrameAllocator.Swap");
 
+  const ezUInt32 uiNewBuffer = 1 - s_uiCurrentBuffer;
+
+  // the arenas have to be reset first, the destructors of their allocations may still access the memory
+  {
+    EZ_LOCK(s_AllThreadDataMutex);
+
+    ezUInt64 uiUsedMemory = 0;
+    for (ezUInt32 i = s_AllThreadData.GetCount(); i-- > 0;)
+    {
+      ezFrameAllocatorThreadData* pThreadData = s_AllThreadData[i];
+
+      uiUsedMemory += pThreadData->m_Arenas[s_uiCurrentBuffer].GetUsedMemory();
+      pThreadData->m_Arenas[uiNewBuffer].Reset();
+
+      // once both arenas of an exited thread have been reset, nothing can reference them anymore
+      if (pThreadData->m_bRetired && ++pThreadData->m_uiSwapsSinceRetired >= 2)
+      {
+        EZ_DEFAULT_DELETE(pThreadData);
+        s_AllThreadData.RemoveAtAndSwap(i);
+      }
+    }
+
+    // the memory of all threads in the frame that just ended
+    EZ_PROFILE_COUNTER("Frame Allocator/Used Memory", uiUsedMemory);
+  }
+
   s_pAllocator->Swap();
+  s_uiCurrentBuffer = uiNewBuffer;
+
+  EZ_ASSERT_DEBUG(s_pAllocator->GetCurrentAllocator() == s_BufferAllocators[s_uiCurrentBuffer], "Frame allocator buffers are out of sync");
 }
 
 // static
@@ -69,21 +298,93 @@ void ezFrameAllocator::Reset()
 {
   if (s_pAllocator)
   {
+    {
+      EZ_LOCK(s_AllThreadDataMutex);
+
+      for (ezFrameAllocatorThreadData* pThreadData : s_AllThreadData)
+      {
+        for (ezUInt32 i = 0; i < 2; ++i)
+        {
+          pThreadData->m_Arenas[i].Reset();
+        }
+      }
+    }
+
     s_pAllocator->Reset();
   }
 }
 
+// static
+void ezFrameAllocator::GetThreadStats(ezDynamicArray<ThreadStats>& out_Stats)
+{
+  EZ_LOCK(s_AllThreadDataMutex);
+
+  out_Stats.Clear();
+  out_Stats.Reserve(s_AllThreadData.GetCount());
+
+  for (const ezFrameAllocatorThreadData* pThreadData : s_AllThreadData)
+  {
+    const ezFrameAllocatorArena& currentArena = pThreadData->m_Arenas[s_uiCurrentBuffer];
+    const ezFrameAllocatorArena& otherArena = pThreadData->m_Arenas[1 - s_uiCurrentBuffer];
+
+    ThreadStats& stats = out_Stats.ExpandAndGetRef();
+    stats.m_ThreadID = currentArena.m_ThreadID;
+    stats.m_uiCurrentMemory = currentArena.GetUsedMemory();
+    stats.m_uiPeakMemory = ezMath::Max(currentArena.GetPeakMemory(), otherArena.GetPeakMemory());
+  }
+}
+
+// static
+void ezFrameAllocator::RetireThreadData()
+{
+  if (s_uiThreadDataGeneration != s_uiGeneration)
+    return;
+
+  EZ_LOCK(s_AllThreadDataMutex);
+
+  // The allocations of the exited thread stay valid until both buffers have been swapped out. The arenas are deleted afterwards
+  // in Swap(), in the meantime allocations through them are forwarded to the arena of the calling thread.
+  for (ezUInt32 i = 0; i < 2; ++i)
+  {
+    s_pThreadData->m_Arenas[i].m_ThreadID = ezThreadID();
+  }
+
+  s_pThreadData->m_bRetired = true;
+
+  s_pThreadData = nullptr;
+  s_uiThreadDataGeneration = 0;
+}
+
 // static
 void ezFrameAllocator::Startup()
 {
   s_pAllocator = EZ_DEFAULT_NEW(ezDoubleBufferedStackAllocator, "FrameAllocator", ezFoundation::GetAlignedAllocator());
+
+  s_BufferAllocators[0] = s_pAllocator->GetCurrentAllocator();
+  s_BufferAllocators[1] = s_pAllocator->GetOtherAllocator();
+  s_uiCurrentBuffer = 0;
+  ++s_uiGeneration;
 }
 
 // static
 void ezFrameAllocator::Shutdown()
 {
+  {
+    EZ_LOCK(s_AllThreadDataMutex);
+
+    for (ezFrameAllocatorThreadData* pThreadData : s_AllThreadData)
+    {
+      EZ_DEFAULT_DELETE(pThreadData);
+    }
+
+    s_AllThreadData.Clear();
+    s_AllThreadData.Compact();
+  }
+
+  // invalidates the thread local data of all threads
+  ++s_uiGeneration;
+
   EZ_DEFAULT_DELETE(s_pAllocator);
 }
 
 EZ_STATICLINK_FILE(Foundation, Foundation_Memory_Implementation_FrameAllocator);
-
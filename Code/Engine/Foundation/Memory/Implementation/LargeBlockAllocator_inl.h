@@ -113,7 +113,7 @@ EZ_ALWAYS_INLINE ezAllocatorId ezLargeBlockAllocator<BlockSize>::GetId() const
 }
 
 template <ezUInt32 BlockSize>
-EZ_ALWAYS_INLINE const ezAllocatorBase::Stats& ezLargeBlockAllocator<BlockSize>::GetStats() const
+EZ_ALWAYS_INLINE ezAllocatorBase::Stats ezLargeBlockAllocator<BlockSize>::GetStats() const
 {
   return ezMemoryTracker::GetAllocatorStats(m_Id);
 }
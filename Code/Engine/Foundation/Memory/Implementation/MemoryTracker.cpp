@@ -26,6 +26,43 @@ namespace
     EZ_ALWAYS_INLINE static ezAllocatorBase* GetAllocator() { return s_pTrackerDataAllocator; }
   };
 
+  enum
+  {
+    NumAllocationShards = 64,
+
+    /// Allocators with a higher index update their stats under the global lock.
+    MaxThreadLocalAllocators = 512,
+  };
+
+  struct AllocationKey
+  {
+    EZ_DECLARE_POD_TYPE();
+
+    const void* m_Ptr;
+    ezAllocatorId m_AllocatorId;
+  };
+
+  struct AllocationKeyHashHelper
+  {
+    EZ_ALWAYS_INLINE static ezUInt32 Hash(const AllocationKey& key)
+    {
+      return ezHashHelper<const void*>::Hash(key.m_Ptr) ^ key.m_AllocatorId.m_InstanceIndex;
+    }
+
+    EZ_ALWAYS_INLINE static bool Equal(const AllocationKey& a, const AllocationKey& b)
+    {
+      return a.m_Ptr == b.m_Ptr && a.m_AllocatorId == b.m_AllocatorId;
+    }
+  };
+
+  typedef ezHashTable<AllocationKey, ezMemoryTracker::AllocationInfo, AllocationKeyHashHelper, TrackerDataAllocatorWrapper> AllocationTable;
+
+  /// The live allocations of all allocators whose address maps to this shard.
+  struct EZ_ALIGN(AllocationShard, 64)
+  {
+    ezMutex m_Mutex;
+    AllocationTable m_Allocations;
+  };
 
   struct AllocatorData
   {
@@ -36,9 +73,23 @@ namespace
 
     ezAllocatorId m_ParentId;
 
+    /// The part of the stats that is not held by any thread stats, the actual stats are the sum of both.
     ezAllocatorBase::Stats m_Stats;
+  };
+
+  struct ThreadStatsSlot
+  {
+    ezAllocatorId m_AllocatorId;
+    ezAllocatorBase::Stats m_Stats;
+  };
 
-    ezHashTable<const void*, ezMemoryTracker::AllocationInfo, ezHashHelper<const void*>, TrackerDataAllocatorWrapper> m_Allocations;
+  /// Stats of all allocators with an index below MaxThreadLocalAllocators, only written by the owning thread.
+  struct ThreadStats
+  {
+    ThreadStatsSlot m_Slots[MaxThreadLocalAllocators];
+
+    ThreadStats* m_pNextInAll = nullptr;
+    ThreadStats* m_pNextFree = nullptr;
   };
 
   struct TrackerData
@@ -52,12 +103,20 @@ namespace
     AllocatorTable m_AllocatorData;
 
     ezAllocatorId m_StaticAllocatorId;
+
+    ThreadStats* m_pAllThreadStats = nullptr;
+    ThreadStats* m_pFreeThreadStats = nullptr;
+
+    AllocationShard m_Shards[NumAllocationShards];
   };
 
   static TrackerData* s_pTrackerData;
   static bool s_bIsInitialized = false;
   static bool s_bIsInitializing = false;
 
+  static ezUInt32 s_uiStackTraceSampleRate = 1;
+  static size_t s_uiAlwaysSampleSize = 0;
+
   static void Initialize()
   {
     if (s_bIsInitialized)
@@ -84,6 +143,182 @@ namespace
     s_bIsInitializing = false;
   }
 
+  EZ_ALWAYS_INLINE AllocationShard& GetShard(const void* ptr)
+  {
+    // the table inside the shard uses the low bits of the hash
+    return s_pTrackerData->m_Shards[ezHashHelper<const void*>::Hash(ptr) >> 26];
+  }
+
+  EZ_CHECK_AT_COMPILETIME((1 << (32 - 26)) == NumAllocationShards);
+
+  static void AddStats(ezAllocatorBase::Stats& target, const ezAllocatorBase::Stats& source)
+  {
+    target.m_uiNumAllocations += source.m_uiNumAllocations;
+    target.m_uiNumDeallocations += source.m_uiNumDeallocations;
+    target.m_uiAllocationSize += source.m_uiAllocationSize;
+    target.m_uiPerFrameAllocationSize += source.m_uiPerFrameAllocationSize;
+    target.m_PerFrameAllocationTime += source.m_PerFrameAllocationTime;
+  }
+
+  static void SubtractStats(ezAllocatorBase::Stats& target, const ezAllocatorBase::Stats& source)
+  {
+    // the stats are unsigned, a thread may free more than it allocated, which is fine as long as the sum is correct
+    target.m_uiNumAllocations -= source.m_uiNumAllocations;
+    target.m_uiNumDeallocations -= source.m_uiNumDeallocations;
+    target.m_uiAllocationSize -= source.m_uiAllocationSize;
+    target.m_uiPerFrameAllocationSize -= source.m_uiPerFrameAllocationSize;
+    target.m_PerFrameAllocationTime -= source.m_PerFrameAllocationTime;
+  }
+
+  /// Returns the sum of the stats of all threads, the global lock must be held.
+  static ezAllocatorBase::Stats GetThreadStatsSum(ezAllocatorId allocatorId)
+  {
+    ezAllocatorBase::Stats stats;
+
+    if (allocatorId.m_InstanceIndex < MaxThreadLocalAllocators)
+    {
+      for (ThreadStats* pThreadStats = s_pTrackerData->m_pAllThreadStats; pThreadStats != nullptr; pThreadStats = pThreadStats->m_pNextInAll)
+      {
+        const ThreadStatsSlot& slot = pThreadStats->m_Slots[allocatorId.m_InstanceIndex];
+        if (slot.m_AllocatorId == allocatorId)
+        {
+          AddStats(stats, slot.m_Stats);
+        }
+      }
+    }
+
+    return stats;
+  }
+
+  /// Returns the stats of an allocator, the global lock must be held.
+  static ezAllocatorBase::Stats GetMergedStats(ezAllocatorId allocatorId, const AllocatorData& data)
+  {
+    ezAllocatorBase::Stats stats = GetThreadStatsSum(allocatorId);
+    AddStats(stats, data.m_Stats);
+    return stats;
+  }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Thread stats
+
+  static ThreadStats* const ReleasedThreadStats = reinterpret_cast<ThreadStats*>(static_cast<size_t>(1));
+
+  static thread_local ThreadStats* s_pThreadStats = nullptr;
+  static thread_local ezUInt32 s_uiStackTraceSampleCounter = 0;
+
+  static void ReleaseThreadStats();
+
+  struct ThreadStatsGuard
+  {
+    ~ThreadStatsGuard() { ReleaseThreadStats(); }
+
+    bool m_bActive = false;
+  };
+
+  static thread_local ThreadStatsGuard s_ThreadStatsGuard;
+
+  static ThreadStats* AcquireThreadStats()
+  {
+    EZ_LOCK(*s_pTrackerData);
+
+    ThreadStats* pThreadStats = s_pTrackerData->m_pFreeThreadStats;
+    if (pThreadStats != nullptr)
+    {
+      s_pTrackerData->m_pFreeThreadStats = pThreadStats->m_pNextFree;
+      pThreadStats->m_pNextFree = nullptr;
+    }
+    else
+    {
+      pThreadStats = EZ_NEW(s_pTrackerDataAllocator, ThreadStats);
+      pThreadStats->m_pNextInAll = s_pTrackerData->m_pAllThreadStats;
+      s_pTrackerData->m_pAllThreadStats = pThreadStats;
+    }
+
+    s_pThreadStats = pThreadStats;
+
+    // makes sure the guard is constructed for this thread, so that the stats are released when the thread exits
+    s_ThreadStatsGuard.m_bActive = true;
+
+    return pThreadStats;
+  }
+
+  static void ReleaseThreadStats()
+  {
+    ThreadStats* pThreadStats = s_pThreadStats;
+
+    // stats of later allocations on this thread are updated under the global lock
+    s_pThreadStats = ReleasedThreadStats;
+
+    if (pThreadStats == nullptr || pThreadStats == ReleasedThreadStats)
+      return;
+
+    EZ_LOCK(*s_pTrackerData);
+
+    // hand the stats over to the allocators, so that the thread stats can be reused by another thread
+    for (ThreadStatsSlot& slot : pThreadStats->m_Slots)
+    {
+      AllocatorData* pData = nullptr;
+      if (!slot.m_AllocatorId.IsInvalidated() && s_pTrackerData->m_AllocatorData.TryGetValue(slot.m_AllocatorId, pData))
+      {
+        AddStats(pData->m_Stats, slot.m_Stats);
+      }
+
+      slot.m_AllocatorId.Invalidate();
+      slot.m_Stats = ezAllocatorBase::Stats();
+    }
+
+    pThreadStats->m_pNextFree = s_pTrackerData->m_pFreeThreadStats;
+    s_pTrackerData->m_pFreeThreadStats = pThreadStats;
+  }
+
+  /// Returns the stats of the calling thread for the given allocator or nullptr if the stats have to be updated under the global lock.
+  EZ_FORCE_INLINE ezAllocatorBase::Stats* GetThreadStats(ezAllocatorId allocatorId)
+  {
+    if (allocatorId.m_InstanceIndex >= MaxThreadLocalAllocators)
+      return nullptr;
+
+    ThreadStats* pThreadStats = s_pThreadStats;
+    if (pThreadStats == nullptr)
+    {
+      pThreadStats = AcquireThreadStats();
+    }
+
+    if (pThreadStats == ReleasedThreadStats)
+      return nullptr;
+
+    ThreadStatsSlot& slot = pThreadStats->m_Slots[allocatorId.m_InstanceIndex];
+    if (slot.m_AllocatorId != allocatorId)
+    {
+      // the slot belonged to an allocator that has been deregistered in the meantime
+      slot.m_Stats = ezAllocatorBase::Stats();
+      slot.m_AllocatorId = allocatorId;
+    }
+
+    return &slot.m_Stats;
+  }
+
+  template <typename UpdateFunc>
+  EZ_FORCE_INLINE void UpdateStats(ezAllocatorId allocatorId, UpdateFunc func)
+  {
+    if (ezAllocatorBase::Stats* pStats = GetThreadStats(allocatorId))
+    {
+      func(*pStats);
+    }
+    else
+    {
+      EZ_LOCK(*s_pTrackerData);
+      func(s_pTrackerData->m_AllocatorData[allocatorId].m_Stats);
+    }
+  }
+
+  EZ_FORCE_INLINE bool ShouldSampleStackTrace(size_t uiSize)
+  {
+    if (s_uiAlwaysSampleSize != 0 && uiSize >= s_uiAlwaysSampleSize)
+      return true;
+
+    return (++s_uiStackTraceSampleCounter % s_uiStackTraceSampleRate) == 0;
+  }
+
   static void DumpLeak(const ezMemoryTracker::AllocationInfo& info, const char* szAllocatorName)
   {
     char szBuffer[512];
@@ -99,6 +334,40 @@ namespace
 
     ezLog::Print("--------------------------------------------------------------------\n\n");
   }
+
+  /// Removes all allocations of the given allocator from the shards and returns how many were removed and their total size.
+  static ezUInt32 RemoveAllocationsOfAllocator(ezAllocatorId allocatorId, const char* szLeakedBy, ezUInt64& out_uiTotalSize)
+  {
+    ezUInt32 uiNumRemoved = 0;
+    out_uiTotalSize = 0;
+
+    for (AllocationShard& shard : s_pTrackerData->m_Shards)
+    {
+      EZ_LOCK(shard.m_Mutex);
+
+      for (auto it = shard.m_Allocations.GetIterator(); it.IsValid();)
+      {
+        if (it.Key().m_AllocatorId != allocatorId)
+        {
+          ++it;
+          continue;
+        }
+
+        if (szLeakedBy != nullptr)
+        {
+          DumpLeak(it.Value(), szLeakedBy);
+        }
+
+        ++uiNumRemoved;
+        out_uiTotalSize += it.Value().m_uiSize;
+
+        EZ_DELETE_ARRAY(s_pTrackerDataAllocator, it.Value().GetStackTrace());
+        it = shard.m_Allocations.Remove(it);
+      }
+    }
+
+    return uiNumRemoved;
+  }
 } // namespace
 
 // Iterator
@@ -119,9 +388,9 @@ ezAllocatorId ezMemoryTracker::Iterator::ParentId() const
   return CAST_ITER(m_pData)->Value().m_ParentId;
 }
 
-const ezAllocatorBase::Stats& ezMemoryTracker::Iterator::Stats() const
+ezAllocatorBase::Stats ezMemoryTracker::Iterator::Stats() const
 {
-  return CAST_ITER(m_pData)->Value().m_Stats;
+  return ezMemoryTracker::GetAllocatorStats(CAST_ITER(m_pData)->Id());
 }
 
 void ezMemoryTracker::Iterator::Next()
@@ -171,15 +440,29 @@ void ezMemoryTracker::DeregisterAllocator(ezAllocatorId allocatorId)
 
   const AllocatorData& data = s_pTrackerData->m_AllocatorData[allocatorId];
 
-  ezUInt32 uiLiveAllocations = data.m_Allocations.GetCount();
-  if (uiLiveAllocations != 0)
+  // only search the shards if the allocator has live allocations
+  const ezAllocatorBase::Stats stats = GetMergedStats(allocatorId, data);
+  if (data.m_Flags.IsSet(ezMemoryTrackingFlags::EnableAllocationTracking) && stats.m_uiNumAllocations != stats.m_uiNumDeallocations)
   {
-    for (auto it = data.m_Allocations.GetIterator(); it.IsValid(); ++it)
+    ezUInt64 uiLeakedSize = 0;
+    const ezUInt32 uiLiveAllocations = RemoveAllocationsOfAllocator(allocatorId, data.m_sName.GetData(), uiLeakedSize);
+
+    if (uiLiveAllocations != 0)
     {
-      DumpLeak(it.Value(), data.m_sName.GetData());
+      EZ_REPORT_FAILURE("Allocator '{0}' leaked {1} allocation(s)", data.m_sName.GetData(), uiLiveAllocations);
     }
+  }
 
-    EZ_REPORT_FAILURE("Allocator '{0}' leaked {1} allocation(s)", data.m_sName.GetData(), uiLiveAllocations);
+  if (allocatorId.m_InstanceIndex < MaxThreadLocalAllocators)
+  {
+    for (ThreadStats* pThreadStats = s_pTrackerData->m_pAllThreadStats; pThreadStats != nullptr; pThreadStats = pThreadStats->m_pNextInAll)
+    {
+      ThreadStatsSlot& slot = pThreadStats->m_Slots[allocatorId.m_InstanceIndex];
+      if (slot.m_AllocatorId == allocatorId)
+      {
+        slot.m_AllocatorId.Invalidate();
+      }
+    }
   }
 
   s_pTrackerData->m_AllocatorData.Remove(allocatorId);
@@ -192,7 +475,7 @@ void ezMemoryTracker::AddAllocation(ezAllocatorId allocatorId, ezBitflags<ezMemo
   EZ_ASSERT_DEV(uiAlign < 0xFFFF, "Alignment too big");
 
   ezArrayPtr<void*> stackTrace;
-  if (flags.IsSet(ezMemoryTrackingFlags::EnableStackTrace))
+  if (flags.IsSet(ezMemoryTrackingFlags::EnableStackTrace) && ShouldSampleStackTrace(uiSize))
   {
     void* pBuffer[64];
     ezArrayPtr<void*> tempTrace(pBuffer);
@@ -203,63 +486,58 @@ void ezMemoryTracker::AddAllocation(ezAllocatorId allocatorId, ezBitflags<ezMemo
   }
 
   {
-    EZ_LOCK(*s_pTrackerData);
+    AllocationShard& shard = GetShard(ptr);
+    EZ_LOCK(shard.m_Mutex);
 
-    AllocatorData& data = s_pTrackerData->m_AllocatorData[allocatorId];
-    data.m_Stats.m_uiNumAllocations++;
-    data.m_Stats.m_uiAllocationSize += uiSize;
-    data.m_Stats.m_uiPerFrameAllocationSize += uiSize;
-    data.m_Stats.m_PerFrameAllocationTime += allocationTime;
-
-    EZ_ASSERT_DEBUG(data.m_Flags == flags, "Given flags have to be identical to allocator flags");
-    auto pInfo = &data.m_Allocations[ptr];
+    auto pInfo = &shard.m_Allocations[AllocationKey{ptr, allocatorId}];
     pInfo->m_uiSize = uiSize;
     pInfo->m_uiAlignment = (ezUInt16)uiAlign;
     pInfo->SetStackTrace(stackTrace);
   }
+
+  UpdateStats(allocatorId, [&](ezAllocatorBase::Stats& stats) {
+    stats.m_uiNumAllocations++;
+    stats.m_uiAllocationSize += uiSize;
+    stats.m_uiPerFrameAllocationSize += uiSize;
+    stats.m_PerFrameAllocationTime += allocationTime;
+  });
 }
 
 // static
 void ezMemoryTracker::RemoveAllocation(ezAllocatorId allocatorId, const void* ptr)
 {
-  ezArrayPtr<void*> stackTrace;
+  AllocationInfo info;
 
   {
-    EZ_LOCK(*s_pTrackerData);
-
-    AllocatorData& data = s_pTrackerData->m_AllocatorData[allocatorId];
+    AllocationShard& shard = GetShard(ptr);
+    EZ_LOCK(shard.m_Mutex);
 
-    AllocationInfo info;
-    if (data.m_Allocations.Remove(ptr, &info))
-    {
-      data.m_Stats.m_uiNumDeallocations++;
-      data.m_Stats.m_uiAllocationSize -= info.m_uiSize;
-
-      stackTrace = info.GetStackTrace();
-    }
-    else
+    if (!shard.m_Allocations.Remove(AllocationKey{ptr, allocatorId}, &info))
     {
       EZ_REPORT_FAILURE("Invalid Allocation '{0}'. Memory corruption?", ezArgP(ptr));
+      return;
     }
   }
 
-  EZ_DELETE_ARRAY(s_pTrackerDataAllocator, stackTrace);
+  UpdateStats(allocatorId, [&](ezAllocatorBase::Stats& stats) {
+    stats.m_uiNumDeallocations++;
+    stats.m_uiAllocationSize -= info.m_uiSize;
+  });
+
+  EZ_DELETE_ARRAY(s_pTrackerDataAllocator, info.GetStackTrace());
 }
 
 // static
 void ezMemoryTracker::RemoveAllAllocations(ezAllocatorId allocatorId)
 {
   EZ_LOCK(*s_pTrackerData);
-  AllocatorData& data = s_pTrackerData->m_AllocatorData[allocatorId];
-  for (auto it = data.m_Allocations.GetIterator(); it.IsValid(); ++it)
-  {
-    auto& info = it.Value();
-    data.m_Stats.m_uiNumDeallocations++;
-    data.m_Stats.m_uiAllocationSize -= info.m_uiSize;
 
-    EZ_DELETE_ARRAY(s_pTrackerDataAllocator, info.GetStackTrace());
-  }
-  data.m_Allocations.Clear();
+  ezUInt64 uiRemovedSize = 0;
+  const ezUInt32 uiNumRemoved = RemoveAllocationsOfAllocator(allocatorId, nullptr, uiRemovedSize);
+
+  AllocatorData& data = s_pTrackerData->m_AllocatorData[allocatorId];
+  data.m_Stats.m_uiNumDeallocations += uiNumRemoved;
+  data.m_Stats.m_uiAllocationSize -= uiRemovedSize;
 }
 
 // static
@@ -267,7 +545,10 @@ void ezMemoryTracker::SetAllocatorStats(ezAllocatorId allocatorId, const ezAlloc
 {
   EZ_LOCK(*s_pTrackerData);
 
-  s_pTrackerData->m_AllocatorData[allocatorId].m_Stats = stats;
+  // the thread stats are added on top again when the stats are queried
+  AllocatorData& data = s_pTrackerData->m_AllocatorData[allocatorId];
+  data.m_Stats = stats;
+  SubtractStats(data.m_Stats, GetThreadStatsSum(allocatorId));
 }
 
 // static
@@ -278,8 +559,10 @@ void ezMemoryTracker::ResetPerFrameAllocatorStats()
   for (auto it = s_pTrackerData->m_AllocatorData.GetIterator(); it.IsValid(); ++it)
   {
     AllocatorData& data = it.Value();
-    data.m_Stats.m_uiPerFrameAllocationSize = 0;
-    data.m_Stats.m_PerFrameAllocationTime.SetZero();
+    const ezAllocatorBase::Stats stats = GetMergedStats(it.Id(), data);
+
+    data.m_Stats.m_uiPerFrameAllocationSize -= stats.m_uiPerFrameAllocationSize;
+    data.m_Stats.m_PerFrameAllocationTime -= stats.m_PerFrameAllocationTime;
   }
 }
 
@@ -292,11 +575,11 @@ const char* ezMemoryTracker::GetAllocatorName(ezAllocatorId allocatorId)
 }
 
 // static
-const ezAllocatorBase::Stats& ezMemoryTracker::GetAllocatorStats(ezAllocatorId allocatorId)
+ezAllocatorBase::Stats ezMemoryTracker::GetAllocatorStats(ezAllocatorId allocatorId)
 {
   EZ_LOCK(*s_pTrackerData);
 
-  return s_pTrackerData->m_AllocatorData[allocatorId].m_Stats;
+  return GetMergedStats(allocatorId, s_pTrackerData->m_AllocatorData[allocatorId]);
 }
 
 // static
@@ -310,11 +593,11 @@ ezAllocatorId ezMemoryTracker::GetAllocatorParentId(ezAllocatorId allocatorId)
 // static
 const ezMemoryTracker::AllocationInfo& ezMemoryTracker::GetAllocationInfo(ezAllocatorId allocatorId, const void* ptr)
 {
-  EZ_LOCK(*s_pTrackerData);
+  AllocationShard& shard = GetShard(ptr);
+  EZ_LOCK(shard.m_Mutex);
 
-  const AllocatorData& data = s_pTrackerData->m_AllocatorData[allocatorId];
   const AllocationInfo* info = nullptr;
-  if (data.m_Allocations.TryGetValue(ptr, info))
+  if (shard.m_Allocations.TryGetValue(AllocationKey{ptr, allocatorId}, info))
   {
     return *info;
   }
@@ -325,6 +608,15 @@ const ezMemoryTracker::AllocationInfo& ezMemoryTracker::GetAllocationInfo(ezAllo
   return invalidInfo;
 }
 
+// static
+void ezMemoryTracker::SetStackTraceSampling(ezUInt32 uiSampleRate, size_t uiAlwaysSampleSize)
+{
+  EZ_ASSERT_DEV(uiSampleRate > 0, "Invalid sample rate");
+
+  s_uiStackTraceSampleRate = uiSampleRate;
+  s_uiAlwaysSampleSize = uiAlwaysSampleSize;
+}
+
 
 struct LeakInfo
 {
@@ -348,17 +640,18 @@ void ezMemoryTracker::DumpMemoryLeaks()
   leakTable.Clear();
 
   // first collect all leaks
-  for (auto it = s_pTrackerData->m_AllocatorData.GetIterator(); it.IsValid(); ++it)
+  for (AllocationShard& shard : s_pTrackerData->m_Shards)
   {
-    const AllocatorData& data = it.Value();
-    for (auto it2 = data.m_Allocations.GetIterator(); it2.IsValid(); ++it2)
+    EZ_LOCK(shard.m_Mutex);
+
+    for (auto it = shard.m_Allocations.GetIterator(); it.IsValid(); ++it)
     {
       LeakInfo leak;
-      leak.m_AllocatorId = it.Id();
-      leak.m_uiSize = it2.Value().m_uiSize;
+      leak.m_AllocatorId = it.Key().m_AllocatorId;
+      leak.m_uiSize = it.Value().m_uiSize;
       leak.m_pParentLeak = nullptr;
 
-      leakTable.Insert(it2.Key(), leak);
+      leakTable.Insert(it.Key().m_Ptr, leak);
     }
   }
 
@@ -404,7 +697,11 @@ void ezMemoryTracker::DumpMemoryLeaks()
 
       const AllocatorData& data = s_pTrackerData->m_AllocatorData[leak.m_AllocatorId];
       ezMemoryTracker::AllocationInfo info;
-      data.m_Allocations.TryGetValue(ptr, info);
+      {
+        AllocationShard& shard = GetShard(ptr);
+        EZ_LOCK(shard.m_Mutex);
+        shard.m_Allocations.TryGetValue(AllocationKey{ptr, leak.m_AllocatorId}, info);
+      }
 
       DumpLeak(info, data.m_sName.GetData());
 
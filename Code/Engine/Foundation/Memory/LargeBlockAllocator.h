@@ -54,7 +54,7 @@ public:
 
   ezAllocatorId GetId() const;
 
-  const ezAllocatorBase::Stats& GetStats() const;
+  ezAllocatorBase::Stats GetStats() const;
 
 private:
   void* Allocate(size_t uiAlign);
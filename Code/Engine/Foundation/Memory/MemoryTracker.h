@@ -39,6 +39,10 @@ struct ezMemoryTrackingFlags
 #define EZ_STATIC_ALLOCATOR_NAME "Statics"
 
 /// \brief Memory tracker which keeps track of all allocations and constructions
+///
+/// Individual allocations are stored in tables that are sharded by the allocation address, so allocations on different threads rarely
+/// contend for the same lock. The stats of an allocator are accumulated per thread and merged when they are queried.
+/// Capturing stack traces is the most expensive part of tracking, see SetStackTraceSampling() to only record them for some allocations.
 class EZ_FOUNDATION_DLL ezMemoryTracker
 {
 public:
@@ -82,7 +86,7 @@ public:
     ezAllocatorId Id() const;
     const char* Name() const;
     ezAllocatorId ParentId() const;
-    const ezAllocatorBase::Stats& Stats() const;
+    ezAllocatorBase::Stats Stats() const;
 
     void Next();
     bool IsValid() const;
@@ -112,12 +116,19 @@ public:
   static void ResetPerFrameAllocatorStats();
 
   static const char* GetAllocatorName(ezAllocatorId allocatorId);
-  static const ezAllocatorBase::Stats& GetAllocatorStats(ezAllocatorId allocatorId);
+  static ezAllocatorBase::Stats GetAllocatorStats(ezAllocatorId allocatorId);
   static ezAllocatorId GetAllocatorParentId(ezAllocatorId allocatorId);
   static const AllocationInfo& GetAllocationInfo(ezAllocatorId allocatorId, const void* ptr);
 
   static void DumpMemoryLeaks();
 
+  /// \brief Configures which allocations of allocators with ezMemoryTrackingFlags::EnableStackTrace record a stack trace.
+  ///
+  /// Only every uiSampleRate-th allocation of a thread and every allocation of at least uiAlwaysSampleSize bytes record their stack trace,
+  /// a uiAlwaysSampleSize of zero disables the size rule. All other allocations are still tracked, so stats, AllocatedSize() and leak
+  /// detection stay exact, but their leaks are reported without a stack trace. By default every allocation is sampled.
+  static void SetStackTraceSampling(ezUInt32 uiSampleRate, size_t uiAlwaysSampleSize = 0);
+
   static Iterator GetIterator();
 };
 
@@ -0,0 +1,601 @@
+#include <FoundationPCH.h>
+
+#include <Foundation/Math/Math.h>
+#include <Foundation/Memory/Policies/AlignedHeapAllocation.h>
+#include <Foundation/Memory/Policies/SmallObjectAllocation.h>
+#include <Foundation/Threading/AtomicInteger.h>
+#include <Foundation/Threading/AtomicUtils.h>
+#include <Foundation/Threading/Lock.h>
+#include <Foundation/Threading/Mutex.h>
+
+namespace
+{
+  using ezMemoryPolicies::ezSmallObjectAllocation;
+
+  enum
+  {
+    NumSizeClasses = 20,
+    SlabShift = 16,
+    SlabHeaderSize = 128,
+
+    // The page map resolves a pointer to its slab, it covers the whole user mode address space in two levels.
+#if EZ_ENABLED(EZ_PLATFORM_64BIT)
+    AddressBits = 48,
+#else
+    AddressBits = 32,
+#endif
+    PageBits = AddressBits - SlabShift,
+    RootBits = PageBits / 2,
+    LeafBits = PageBits - RootBits,
+  };
+
+  EZ_CHECK_AT_COMPILETIME((1 << SlabShift) == ezSmallObjectAllocation::SlabSize);
+
+  // 16 byte steps up to 128 bytes, then four classes per power of two
+  static const ezUInt32 s_SizeClassBlockSizes[NumSizeClasses] = {
+    16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512, 640, 768, 896, 1024};
+
+  EZ_ALWAYS_INLINE ezUInt32 GetSizeClass(size_t uiSize)
+  {
+    if (uiSize <= 128)
+      return (static_cast<ezUInt32>(uiSize) + 15) / 16 - 1;
+
+    const ezUInt32 uiHighBit = ezMath::FirstBitHigh(static_cast<ezUInt32>(uiSize - 1));
+    return 8 + (uiHighBit - 7) * 4 + (static_cast<ezUInt32>(uiSize - 1) >> (uiHighBit - 2)) - 4;
+  }
+
+  enum class SlabState : ezUInt8
+  {
+    Active,   ///< The slab that the owning thread currently allocates from.
+    Partial,  ///< Owned by a thread and has local free blocks.
+    Full,     ///< Owned by a thread without local free blocks, other threads may have freed blocks though.
+    Orphaned, ///< The owning thread has exited, the slab waits to be adopted by another thread.
+    Spare,    ///< Empty and kept by a thread cache for reuse.
+  };
+
+  struct ThreadCache;
+
+  struct Slab
+  {
+    // written by all threads
+    void* volatile m_pRemoteFree;
+    ThreadCache* volatile m_pOwner;
+    ezUInt8 m_RemotePadding[64 - 2 * sizeof(void*)];
+
+    // only accessed by the owning thread
+    void* m_pLocalFree;
+    ezUInt8* m_pUnused;
+    ezUInt8* m_pEnd;
+    Slab* m_pPrev;
+    Slab* m_pNext;
+    ezUInt32 m_uiBlockSize;
+    ezUInt32 m_uiNumUsed;
+    ezUInt8 m_uiSizeClass;
+    SlabState m_State;
+  };
+
+  EZ_CHECK_AT_COMPILETIME(sizeof(Slab) <= SlabHeaderSize);
+
+  struct SlabList
+  {
+    Slab* m_pFirst = nullptr;
+    Slab* m_pLast = nullptr;
+
+    void PushBack(Slab* pSlab)
+    {
+      pSlab->m_pPrev = m_pLast;
+      pSlab->m_pNext = nullptr;
+
+      if (m_pLast != nullptr)
+        m_pLast->m_pNext = pSlab;
+      else
+        m_pFirst = pSlab;
+
+      m_pLast = pSlab;
+    }
+
+    void Remove(Slab* pSlab)
+    {
+      if (pSlab->m_pPrev != nullptr)
+        pSlab->m_pPrev->m_pNext = pSlab->m_pNext;
+      else
+        m_pFirst = pSlab->m_pNext;
+
+      if (pSlab->m_pNext != nullptr)
+        pSlab->m_pNext->m_pPrev = pSlab->m_pPrev;
+      else
+        m_pLast = pSlab->m_pPrev;
+
+      pSlab->m_pPrev = nullptr;
+      pSlab->m_pNext = nullptr;
+    }
+  };
+
+  struct SizeClassSlabs
+  {
+    Slab* m_pActive = nullptr;
+    SlabList m_Partial;
+    SlabList m_Full;
+  };
+
+  struct ThreadCache
+  {
+    SizeClassSlabs m_SizeClasses[NumSizeClasses];
+    Slab* m_pSpareSlab = nullptr;
+  };
+
+  struct GlobalData
+  {
+    ezMutex m_Mutex;
+    SlabList m_OrphanedSlabs[NumSizeClasses];
+    ezAtomicInteger64 m_iNumSlabs;
+  };
+
+  static ezMemoryPolicies::ezAlignedHeapAllocation s_Heap(nullptr);
+
+  static Slab* volatile* volatile s_PageMap[1 << RootBits];
+
+  // constructed on first use and never destroyed, since memory may still be freed during static destruction
+  EZ_ALIGN_VARIABLE(static ezUInt8 s_GlobalDataBuffer[sizeof(GlobalData)], EZ_ALIGNMENT_OF(GlobalData));
+
+  GlobalData& GetGlobalData()
+  {
+    static GlobalData* s_pGlobalData = new (s_GlobalDataBuffer) GlobalData();
+    return *s_pGlobalData;
+  }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Page map
+
+  EZ_ALWAYS_INLINE Slab* LookupSlab(const void* ptr)
+  {
+    const ezUInt64 uiPage = reinterpret_cast<size_t>(ptr) >> SlabShift;
+    if ((uiPage >> PageBits) != 0)
+      return nullptr;
+
+    Slab* volatile* pLeaf = s_PageMap[uiPage >> LeafBits];
+    if (pLeaf == nullptr)
+      return nullptr;
+
+    return pLeaf[uiPage & ((1 << LeafBits) - 1)];
+  }
+
+  bool RegisterSlab(Slab* pSlab)
+  {
+    const ezUInt64 uiPage = reinterpret_cast<size_t>(pSlab) >> SlabShift;
+    if ((uiPage >> PageBits) != 0)
+      return false;
+
+    Slab* volatile* volatile& pLeaf = s_PageMap[uiPage >> LeafBits];
+    if (pLeaf == nullptr)
+    {
+      const size_t uiLeafSize = sizeof(Slab*) << LeafBits;
+      void* pNewLeaf = s_Heap.Allocate(uiLeafSize, ezSmallObjectAllocation::SlabSize);
+      ezMemoryUtils::ZeroFill(static_cast<ezUInt8*>(pNewLeaf), uiLeafSize);
+
+      // leaves are never freed, another thread might have added the same leaf in the meantime though
+      if (!ezAtomicUtils::TestAndSet((void**)&pLeaf, nullptr, pNewLeaf))
+      {
+        s_Heap.Deallocate(pNewLeaf);
+      }
+    }
+
+    pLeaf[uiPage & ((1 << LeafBits) - 1)] = pSlab;
+    return true;
+  }
+
+  void UnregisterSlab(Slab* pSlab)
+  {
+    const ezUInt64 uiPage = reinterpret_cast<size_t>(pSlab) >> SlabShift;
+    s_PageMap[uiPage >> LeafBits][uiPage & ((1 << LeafBits) - 1)] = nullptr;
+  }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Slabs
+
+  Slab* CreateSlab()
+  {
+    Slab* pSlab = static_cast<Slab*>(s_Heap.Allocate(ezSmallObjectAllocation::SlabSize, ezSmallObjectAllocation::SlabSize));
+
+    if (!RegisterSlab(pSlab))
+    {
+      s_Heap.Deallocate(pSlab);
+      return nullptr;
+    }
+
+    GetGlobalData().m_iNumSlabs.Increment();
+    return pSlab;
+  }
+
+  void DestroySlab(Slab* pSlab)
+  {
+    UnregisterSlab(pSlab);
+    s_Heap.Deallocate(pSlab);
+
+    GetGlobalData().m_iNumSlabs.Decrement();
+  }
+
+  void InitSlab(Slab* pSlab, ThreadCache* pOwner, ezUInt32 uiSizeClass)
+  {
+    pSlab->m_pRemoteFree = nullptr;
+    pSlab->m_pOwner = pOwner;
+    pSlab->m_pLocalFree = nullptr;
+    pSlab->m_pUnused = reinterpret_cast<ezUInt8*>(pSlab) + SlabHeaderSize;
+    pSlab->m_pEnd = reinterpret_cast<ezUInt8*>(pSlab) + ezSmallObjectAllocation::SlabSize;
+    pSlab->m_pPrev = nullptr;
+    pSlab->m_pNext = nullptr;
+    pSlab->m_uiBlockSize = s_SizeClassBlockSizes[uiSizeClass];
+    pSlab->m_uiNumUsed = 0;
+    pSlab->m_uiSizeClass = static_cast<ezUInt8>(uiSizeClass);
+    pSlab->m_State = SlabState::Active;
+  }
+
+  /// Moves the blocks that other threads have freed into the local free list. Returns false if there were none.
+  bool CollectRemoteFrees(Slab* pSlab)
+  {
+    void* pRemoteFree = pSlab->m_pRemoteFree;
+    while (pRemoteFree != nullptr && !ezAtomicUtils::TestAndSet((void**)&pSlab->m_pRemoteFree, pRemoteFree, nullptr))
+    {
+      pRemoteFree = pSlab->m_pRemoteFree;
+    }
+
+    if (pRemoteFree == nullptr)
+      return false;
+
+    ezUInt32 uiNumBlocks = 1;
+    void* pLastBlock = pRemoteFree;
+    while (*static_cast<void**>(pLastBlock) != nullptr)
+    {
+      pLastBlock = *static_cast<void**>(pLastBlock);
+      ++uiNumBlocks;
+    }
+
+    *static_cast<void**>(pLastBlock) = pSlab->m_pLocalFree;
+    pSlab->m_pLocalFree = pRemoteFree;
+    pSlab->m_uiNumUsed -= uiNumBlocks;
+    return true;
+  }
+
+  EZ_FORCE_INLINE void* PopBlock(Slab* pSlab)
+  {
+    if (void* pBlock = pSlab->m_pLocalFree)
+    {
+      pSlab->m_pLocalFree = *static_cast<void**>(pBlock);
+      ++pSlab->m_uiNumUsed;
+      return pBlock;
+    }
+
+    if (pSlab->m_pUnused + pSlab->m_uiBlockSize <= pSlab->m_pEnd)
+    {
+      void* pBlock = pSlab->m_pUnused;
+      pSlab->m_pUnused += pSlab->m_uiBlockSize;
+      ++pSlab->m_uiNumUsed;
+      return pBlock;
+    }
+
+    if (pSlab->m_pRemoteFree != nullptr && CollectRemoteFrees(pSlab))
+    {
+      void* pBlock = pSlab->m_pLocalFree;
+      pSlab->m_pLocalFree = *static_cast<void**>(pBlock);
+      ++pSlab->m_uiNumUsed;
+      return pBlock;
+    }
+
+    return nullptr;
+  }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Thread caches
+
+  ThreadCache* const DeadThreadCache = reinterpret_cast<ThreadCache*>(static_cast<size_t>(1));
+
+  static thread_local ThreadCache* s_pThreadCache = nullptr;
+
+  void ReleaseThreadCache();
+
+  struct ThreadCacheGuard
+  {
+    ~ThreadCacheGuard() { ReleaseThreadCache(); }
+
+    bool m_bActive = false;
+  };
+
+  static thread_local ThreadCacheGuard s_ThreadCacheGuard;
+
+  ThreadCache* CreateThreadCache()
+  {
+    ThreadCache* pCache = new (s_Heap.Allocate(sizeof(ThreadCache), EZ_ALIGNMENT_OF(ThreadCache))) ThreadCache();
+    s_pThreadCache = pCache;
+
+    // makes sure the guard is constructed for this thread, so that the cache is released when the thread exits
+    s_ThreadCacheGuard.m_bActive = true;
+
+    return pCache;
+  }
+
+  void ReleaseThreadCache()
+  {
+    ThreadCache* pCache = s_pThreadCache;
+
+    // allocations after this point are forwarded to the heap
+    s_pThreadCache = DeadThreadCache;
+
+    if (pCache == nullptr || pCache == DeadThreadCache)
+      return;
+
+    GlobalData& globalData = GetGlobalData();
+
+    {
+      EZ_LOCK(globalData.m_Mutex);
+
+      // Orphaned slabs are only accessed while holding the mutex. The ones of threads that exited earlier may have been emptied
+      // by remote frees in the meantime, release them now instead of waiting for an allocation in their size class.
+      for (SlabList& orphanedSlabs : globalData.m_OrphanedSlabs)
+      {
+        Slab* pSlab = orphanedSlabs.m_pFirst;
+        while (pSlab != nullptr)
+        {
+          Slab* pNextSlab = pSlab->m_pNext;
+
+          if (pSlab->m_pRemoteFree != nullptr && CollectRemoteFrees(pSlab) && pSlab->m_uiNumUsed == 0)
+          {
+            orphanedSlabs.Remove(pSlab);
+            DestroySlab(pSlab);
+          }
+
+          pSlab = pNextSlab;
+        }
+      }
+
+      auto OrphanSlab = [&](Slab* pSlab) {
+        if (pSlab->m_pRemoteFree != nullptr)
+        {
+          CollectRemoteFrees(pSlab);
+        }
+
+        // nobody can free into an empty slab anymore, so it doesn't need to be adopted by another thread
+        if (pSlab->m_uiNumUsed == 0)
+        {
+          DestroySlab(pSlab);
+          return;
+        }
+
+        pSlab->m_pOwner = nullptr;
+        pSlab->m_State = SlabState::Orphaned;
+        globalData.m_OrphanedSlabs[pSlab->m_uiSizeClass].PushBack(pSlab);
+      };
+
+      for (SizeClassSlabs& sizeClass : pCache->m_SizeClasses)
+      {
+        if (sizeClass.m_pActive != nullptr)
+        {
+          OrphanSlab(sizeClass.m_pActive);
+        }
+
+        for (SlabList* pList : {&sizeClass.m_Partial, &sizeClass.m_Full})
+        {
+          while (Slab* pSlab = pList->m_pFirst)
+          {
+            pList->Remove(pSlab);
+            OrphanSlab(pSlab);
+          }
+        }
+      }
+    }
+
+    if (pCache->m_pSpareSlab != nullptr)
+    {
+      DestroySlab(pCache->m_pSpareSlab);
+    }
+
+    pCache->~ThreadCache();
+    s_Heap.Deallocate(pCache);
+  }
+
+  EZ_ALWAYS_INLINE ThreadCache* GetThreadCache()
+  {
+    ThreadCache* pCache = s_pThreadCache;
+
+    if (pCache == nullptr)
+    {
+      pCache = CreateThreadCache();
+    }
+
+    return pCache != DeadThreadCache ? pCache : nullptr;
+  }
+
+  /// Called when a slab of the owning thread has no allocated blocks left.
+  void ReleaseEmptySlab(ThreadCache* pCache, Slab* pSlab)
+  {
+    pSlab->m_State = SlabState::Spare;
+
+    if (pCache->m_pSpareSlab == nullptr)
+    {
+      pCache->m_pSpareSlab = pSlab;
+    }
+    else
+    {
+      DestroySlab(pSlab);
+    }
+  }
+
+  void* AllocateSlow(ThreadCache* pCache, ezUInt32 uiSizeClass)
+  {
+    SizeClassSlabs& sizeClass = pCache->m_SizeClasses[uiSizeClass];
+
+    if (Slab* pActive = sizeClass.m_pActive)
+    {
+      pActive->m_State = SlabState::Full;
+      sizeClass.m_Full.PushBack(pActive);
+      sizeClass.m_pActive = nullptr;
+    }
+
+    Slab* pSlab = sizeClass.m_Partial.m_pFirst;
+
+    if (pSlab != nullptr)
+    {
+      sizeClass.m_Partial.Remove(pSlab);
+    }
+    else
+    {
+      // look for full slabs that got blocks back from other threads, the inspected slabs are rotated to the back of the list
+      for (ezUInt32 i = 0; i < 8 && sizeClass.m_Full.m_pFirst != nullptr; ++i)
+      {
+        Slab* pFull = sizeClass.m_Full.m_pFirst;
+        sizeClass.m_Full.Remove(pFull);
+
+        if (pFull->m_pRemoteFree != nullptr)
+        {
+          pSlab = pFull;
+          break;
+        }
+
+        sizeClass.m_Full.PushBack(pFull);
+      }
+    }
+
+    if (pSlab == nullptr)
+    {
+      GlobalData& globalData = GetGlobalData();
+      EZ_LOCK(globalData.m_Mutex);
+
+      pSlab = globalData.m_OrphanedSlabs[uiSizeClass].m_pFirst;
+      if (pSlab != nullptr)
+      {
+        globalData.m_OrphanedSlabs[uiSizeClass].Remove(pSlab);
+        pSlab->m_pOwner = pCache;
+      }
+    }
+
+    if (pSlab == nullptr)
+    {
+      if (pCache->m_pSpareSlab != nullptr)
+      {
+        pSlab = pCache->m_pSpareSlab;
+        pCache->m_pSpareSlab = nullptr;
+      }
+      else
+      {
+        pSlab = CreateSlab();
+
+        if (pSlab == nullptr)
+          return nullptr;
+      }
+
+      InitSlab(pSlab, pCache, uiSizeClass);
+    }
+
+    pSlab->m_State = SlabState::Active;
+    sizeClass.m_pActive = pSlab;
+
+    if (void* pBlock = PopBlock(pSlab))
+      return pBlock;
+
+    // an adopted slab may not have any free blocks, it is moved to the full list and the next slab is tried
+    return AllocateSlow(pCache, uiSizeClass);
+  }
+} // namespace
+
+void* ezMemoryPolicies::ezSmallObjectAllocation::Allocate(size_t uiSize, size_t uiAlign)
+{
+  if (uiSize <= MaxSmallSize && uiAlign <= 16)
+  {
+    if (ThreadCache* pCache = GetThreadCache())
+    {
+      const ezUInt32 uiSizeClass = GetSizeClass(ezMath::Max<size_t>(uiSize, 1));
+
+      if (Slab* pActive = pCache->m_SizeClasses[uiSizeClass].m_pActive)
+      {
+        if (void* pBlock = PopBlock(pActive))
+          return pBlock;
+      }
+
+      if (void* pBlock = AllocateSlow(pCache, uiSizeClass))
+        return pBlock;
+    }
+  }
+
+  return s_Heap.Allocate(uiSize, uiAlign);
+}
+
+void* ezMemoryPolicies::ezSmallObjectAllocation::Reallocate(void* ptr, size_t uiCurrentSize, size_t uiNewSize, size_t uiAlign)
+{
+  if (Slab* pSlab = LookupSlab(ptr))
+  {
+    // the block is large enough already
+    if (uiNewSize <= pSlab->m_uiBlockSize && uiAlign <= 16)
+      return ptr;
+  }
+
+  void* pNewMem = Allocate(uiNewSize, uiAlign);
+  ezMemoryUtils::Copy(static_cast<ezUInt8*>(pNewMem), static_cast<const ezUInt8*>(ptr), ezMath::Min(uiCurrentSize, uiNewSize));
+  Deallocate(ptr);
+  return pNewMem;
+}
+
+void ezMemoryPolicies::ezSmallObjectAllocation::Deallocate(void* ptr)
+{
+  Slab* pSlab = LookupSlab(ptr);
+
+  if (pSlab == nullptr)
+  {
+    s_Heap.Deallocate(ptr);
+    return;
+  }
+
+  ThreadCache* pCache = s_pThreadCache;
+
+  if (pSlab->m_pOwner != pCache || pCache == nullptr)
+  {
+    // the slab belongs to another thread, hand the block back through the lock-free list
+    void* pRemoteFree;
+    do
+    {
+      pRemoteFree = pSlab->m_pRemoteFree;
+      *static_cast<void**>(ptr) = pRemoteFree;
+    } while (!ezAtomicUtils::TestAndSet((void**)&pSlab->m_pRemoteFree, pRemoteFree, ptr));
+
+    return;
+  }
+
+  *static_cast<void**>(ptr) = pSlab->m_pLocalFree;
+  pSlab->m_pLocalFree = ptr;
+  --pSlab->m_uiNumUsed;
+
+  if (pSlab->m_State == SlabState::Active)
+    return;
+
+  SizeClassSlabs& sizeClass = pCache->m_SizeClasses[pSlab->m_uiSizeClass];
+
+  if (pSlab->m_State == SlabState::Full)
+  {
+    sizeClass.m_Full.Remove(pSlab);
+  }
+  else
+  {
+    sizeClass.m_Partial.Remove(pSlab);
+  }
+
+  // collect remote frees as well, so that the slab can be released as soon as all of its blocks are back
+  if (pSlab->m_pRemoteFree != nullptr)
+  {
+    CollectRemoteFrees(pSlab);
+  }
+
+  if (pSlab->m_uiNumUsed == 0)
+  {
+    ReleaseEmptySlab(pCache, pSlab);
+  }
+  else
+  {
+    pSlab->m_State = SlabState::Partial;
+    sizeClass.m_Partial.PushBack(pSlab);
+  }
+}
+
+ezUInt64 ezMemoryPolicies::ezSmallObjectAllocation::GetNumSlabs()
+{
+  return static_cast<ezUInt64>(GetGlobalData().m_iNumSlabs);
+}
+
+EZ_STATICLINK_FILE(Foundation, Foundation_Memory_Policies_SmallObjectAllocation);
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Foundation/Basics.h>
+
+namespace ezMemoryPolicies
+{
+  /// \brief Allocation policy that serves small allocations from size-class slabs with per-thread caches.
+  ///
+  /// Allocations of up to MaxSmallSize bytes with an alignment of at most 16 bytes are rounded up to one of a few size classes
+  /// and taken from slabs of SlabSize bytes. Every thread owns its own slabs for each size class, so allocating and freeing
+  /// on the same thread never takes a lock. Blocks that are freed on another thread are pushed onto a lock-free list of their
+  /// slab and are reused by the owning thread once its local blocks run out. When a thread exits, its empty slabs are released
+  /// and the others are handed over to the next thread that needs a slab of the same size class. Handed over slabs that have been
+  /// emptied by frees on other threads are released when the next thread exits.
+  ///
+  /// Larger allocations and allocations with a larger alignment are forwarded to ezAlignedHeapAllocation.
+  /// All instances share the same slabs, just like all instances of ezHeapAllocation share the CRT heap, so memory may be
+  /// freed through any instance.
+  ///
+  /// \see ezAllocator
+  class EZ_FOUNDATION_DLL ezSmallObjectAllocation
+  {
+  public:
+    enum
+    {
+      MaxSmallSize = 1024,
+      SlabSize = 64 * 1024,
+    };
+
+    EZ_ALWAYS_INLINE ezSmallObjectAllocation(ezAllocatorBase* pParent) {}
+    EZ_ALWAYS_INLINE ~ezSmallObjectAllocation() {}
+
+    void* Allocate(size_t uiSize, size_t uiAlign);
+    void* Reallocate(void* ptr, size_t uiCurrentSize, size_t uiNewSize, size_t uiAlign);
+    void Deallocate(void* ptr);
+
+    EZ_ALWAYS_INLINE ezAllocatorBase* GetParent() const { return nullptr; }
+
+    /// \brief Returns the number of slabs that are currently allocated by all instances.
+    static ezUInt64 GetNumSlabs();
+  };
+} // namespace ezMemoryPolicies
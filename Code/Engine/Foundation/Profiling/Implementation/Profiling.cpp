@@ -3,11 +3,18 @@
 #include <Foundation/Communication/DataTransfer.h>
 #include <Foundation/Configuration/CVar.h>
 #include <Foundation/Configuration/Startup.h>
+#include <Foundation/Containers/HashSet.h>
+#include <Foundation/Containers/HashTable.h>
 #include <Foundation/Containers/IdTable.h>
 #include <Foundation/Containers/StaticRingBuffer.h>
 #include <Foundation/IO/JSONWriter.h>
+#include <Foundation/IO/OSFile.h>
 #include <Foundation/Memory/CommonAllocators.h>
+#include <Foundation/Profiling/Implementation/ProfilingTrace.h>
 #include <Foundation/Profiling/Profiling.h>
+#include <Foundation/Strings/HashedString.h>
+#include <Foundation/Threading/Thread.h>
+#include <Foundation/Threading/ThreadSignal.h>
 #include <Foundation/Threading/ThreadUtils.h>
 
 #if EZ_ENABLED(EZ_USE_PROFILING)
@@ -61,10 +68,178 @@ namespace
     BUFFER_SIZE_FRAMES = 120 * 60,
   };
 
+  enum
+  {
+    STREAM_FLUSH_THRESHOLD = 16 * 1024, ///< Number of streamed scopes of one thread after which the stream thread is woken up early
+  };
+
+  enum
+  {
+    SCOPE_NAMES_PER_CHUNK = 1024,
+    MAX_SCOPE_NAME_CHUNKS = 256,
+    SCOPE_NAME_CACHE_SIZE = 64, ///< Number of dynamic scope names that every thread can look up without a lock
+  };
+
   typedef ezStaticRingBuffer<ezProfilingSystem::GPUScope, BUFFER_SIZE_OTHER_THREAD / sizeof(ezProfilingSystem::GPUScope)> GPUScopesBuffer;
 
   static ezUInt64 s_MainThreadId = 0;
 
+  /// A recorded CPU scope or counter sample, the name is stored as a registered scope name id.
+  ///
+  /// Counter samples share the buffers with the scopes, so that they keep their order and don't need any additional memory per thread.
+  /// They are marked with COUNTER_FLAG in the name id and store their value in place of the end time.
+  struct CpuScopeEvent
+  {
+    EZ_DECLARE_POD_TYPE();
+
+    enum : ezUInt32
+    {
+      COUNTER_FLAG = 0x80000000,
+    };
+
+    bool IsCounterSample() const { return (m_uiScopeNameId & COUNTER_FLAG) != 0; }
+    double GetCounterValue() const { return m_EndTime.GetSeconds(); }
+
+    ezTime m_BeginTime;
+    ezTime m_EndTime;
+    ezUInt32 m_uiScopeNameId;
+  };
+
+  struct ScopeNameData
+  {
+    ezHashedString m_sName;
+    ezHashedString m_sFunctionName;
+    bool m_bHasFunctionName = false;
+  };
+
+  // Scope names are stored in chunks that are never moved or freed, so they can be read without a lock.
+  // An id is only handed out after its data has been written.
+  static ScopeNameData* s_ScopeNameChunks[MAX_SCOPE_NAME_CHUNKS];
+  static ezUInt32 s_uiNumScopeNames = 0;
+  static ezHashTable<ezUInt64, ezUInt32, ezHashHelper<ezUInt64>, ezStaticAllocatorWrapper> s_ScopeNameIds;
+  static ezMutex s_ScopeNamesMutex;
+  static ezUInt32 s_uiScopeNameOverflowId = ezProfilingScopeName::InvalidId;
+
+  struct ScopeNameCacheEntry
+  {
+    const char* m_szFunctionName;
+    ezUInt32 m_uiNameHash;
+    ezUInt32 m_uiGeneration;
+    ezUInt32 m_uiId;
+  };
+
+  /// Maps dynamic scope names to their ids, so that names which are built at runtime don't need to take the lock every time.
+  static thread_local ScopeNameCacheEntry s_ScopeNameCache[SCOPE_NAME_CACHE_SIZE];
+
+  /// The cache uses the function name pointer as a key, which might be reused once a plugin is unloaded. Starts at 1, so that empty cache entries are invalid.
+  static ezAtomicInteger32 s_iScopeNameCacheGeneration = 1;
+
+  EZ_ALWAYS_INLINE const ScopeNameData& GetScopeNameData(ezUInt32 uiId)
+  {
+    return s_ScopeNameChunks[uiId / SCOPE_NAMES_PER_CHUNK][uiId % SCOPE_NAMES_PER_CHUNK];
+  }
+
+  bool IsSameScopeName(const ScopeNameData& data, const char* szName, const char* szFunctionName)
+  {
+    if (data.m_bHasFunctionName != (szFunctionName != nullptr))
+      return false;
+
+    if (szFunctionName != nullptr && !ezStringUtils::IsEqual(data.m_sFunctionName.GetData(), szFunctionName))
+      return false;
+
+    return ezStringUtils::IsEqual(data.m_sName.GetData(), szName);
+  }
+
+  ezUInt32 AddScopeName(const char* szName, ezUInt32 uiNameHash, const char* szFunctionName)
+  {
+    const ezUInt32 uiFunctionNameHash = szFunctionName != nullptr ? ezHashingUtils::MurmurHash32String(szFunctionName) : 0;
+    ezUInt64 uiKey = (static_cast<ezUInt64>(uiNameHash) << 32) | uiFunctionNameHash;
+
+    EZ_LOCK(s_ScopeNamesMutex);
+
+    // Names are never removed, so colliding hashes are resolved by probing the following keys until the name is found or a free key is hit.
+    ezUInt32 uiId = 0;
+    while (s_ScopeNameIds.TryGetValue(uiKey, uiId))
+    {
+      if (IsSameScopeName(GetScopeNameData(uiId), szName, szFunctionName))
+        return uiId;
+
+      ++uiKey;
+    }
+
+    if (s_uiNumScopeNames == SCOPE_NAMES_PER_CHUNK * MAX_SCOPE_NAME_CHUNKS - 1)
+    {
+      // keep the last id for all further names, this only happens if unique names are built for every scope
+      if (s_uiScopeNameOverflowId == ezProfilingScopeName::InvalidId)
+      {
+        ezLog::Warning("Too many different profiling scope names, scope names should not contain data that changes every time.");
+
+        s_uiScopeNameOverflowId = s_uiNumScopeNames;
+        szName = "<Too many scope names>";
+        szFunctionName = nullptr;
+      }
+      else
+      {
+        return s_uiScopeNameOverflowId;
+      }
+    }
+
+    uiId = s_uiNumScopeNames;
+
+    ScopeNameData*& pChunk = s_ScopeNameChunks[uiId / SCOPE_NAMES_PER_CHUNK];
+    if (pChunk == nullptr)
+    {
+      pChunk = EZ_NEW_ARRAY(ezStaticAllocatorWrapper::GetAllocator(), ScopeNameData, SCOPE_NAMES_PER_CHUNK).GetPtr();
+    }
+
+    ScopeNameData& data = pChunk[uiId % SCOPE_NAMES_PER_CHUNK];
+    data.m_sName.Assign(szName);
+    if (szFunctionName != nullptr)
+    {
+      data.m_sFunctionName.Assign(szFunctionName);
+      data.m_bHasFunctionName = true;
+    }
+
+    ++s_uiNumScopeNames;
+    s_ScopeNameIds.Insert(uiKey, uiId);
+
+    return uiId;
+  }
+
+  EZ_ALWAYS_INLINE void ResolveScopeName(const CpuScopeEvent& event, ezProfilingSystem::CPUScope& out_scope)
+  {
+    const ScopeNameData& data = GetScopeNameData(event.m_uiScopeNameId);
+    out_scope.m_szName = data.m_sName.GetData();
+    out_scope.m_szFunctionName = data.m_bHasFunctionName ? data.m_sFunctionName.GetData() : nullptr;
+    out_scope.m_BeginTime = event.m_BeginTime;
+    out_scope.m_EndTime = event.m_EndTime;
+  }
+
+  EZ_ALWAYS_INLINE void ResolveCounterSample(const CpuScopeEvent& event, ezProfilingSystem::CounterSample& out_sample)
+  {
+    const ScopeNameData& data = GetScopeNameData(event.m_uiScopeNameId & ~CpuScopeEvent::COUNTER_FLAG);
+    out_sample.m_szName = data.m_sName.GetData();
+    out_sample.m_Time = event.m_BeginTime;
+    out_sample.m_fValue = event.GetCounterValue();
+  }
+
+  /// Sorts the given events into scopes and counter samples.
+  void ResolveEvents(ezArrayPtr<const CpuScopeEvent> events, ezDynamicArray<ezProfilingSystem::CPUScope>& out_scopes,
+    ezDynamicArray<ezProfilingSystem::CounterSample>& out_counterSamples)
+  {
+    for (const CpuScopeEvent& event : events)
+    {
+      if (event.IsCounterSample())
+      {
+        ResolveCounterSample(event, out_counterSamples.ExpandAndGetRef());
+      }
+      else
+      {
+        ResolveScopeName(event, out_scopes.ExpandAndGetRef());
+      }
+    }
+  }
+
   struct CpuScopesBufferBase
   {
     virtual ~CpuScopesBufferBase() = default;
@@ -74,12 +249,16 @@ namespace
     {
       return m_uiThreadId == s_MainThreadId;
     }
+
+    /// Scopes that have not been written to the trace file yet, only filled while streaming.
+    ezDynamicArray<CpuScopeEvent> m_StreamScopes;
+    ezMutex m_StreamMutex;
   };
 
   template <ezUInt32 SizeInBytes>
   struct CpuScopesBuffer : public CpuScopesBufferBase
   {
-    ezStaticRingBuffer<ezProfilingSystem::CPUScope, SizeInBytes / sizeof(ezProfilingSystem::CPUScope)> m_Data;
+    ezStaticRingBuffer<CpuScopeEvent, SizeInBytes / sizeof(CpuScopeEvent)> m_Data;
   };
 
   CpuScopesBuffer<BUFFER_SIZE_MAIN_THREAD>* CastToMainThreadEventBuffer(CpuScopesBufferBase* pEventBuffer)
@@ -104,7 +283,7 @@ namespace
   static ezMutex s_ThreadInfosMutex;
 
 #  if EZ_ENABLED(EZ_PLATFORM_64BIT)
-  EZ_CHECK_AT_COMPILETIME(sizeof(ezProfilingSystem::CPUScope) == 64);
+  EZ_CHECK_AT_COMPILETIME(sizeof(CpuScopeEvent) == 24);
   EZ_CHECK_AT_COMPILETIME(sizeof(ezProfilingSystem::GPUScope) == 64);
 #  endif
 
@@ -114,14 +293,148 @@ namespace
 
   static GPUScopesBuffer* s_GPUScopes;
 
+  struct StreamFrame
+  {
+    EZ_DECLARE_POD_TYPE();
+
+    ezUInt64 m_uiFrameNumber;
+    ezTime m_StartTime;
+  };
+
+  /// Writes the data that was recorded since the last flush to the trace file in regular intervals.
+  class ezProfilingStreamThread : public ezThread
+  {
+  public:
+    ezProfilingStreamThread(ezTime flushInterval)
+      : ezThread("Profiling Stream")
+      , m_FlushInterval(flushInterval)
+    {
+    }
+
+    ezResult Open(const char* szAbsoluteFilePath);
+    void Flush();
+
+    volatile bool m_bRunning = true;
+
+  private:
+    virtual ezUInt32 Run() override;
+
+    ezTime m_FlushInterval;
+    ezMutex m_FlushMutex;
+    ezOSFile m_File;
+    ezProfilingTraceWriter m_Writer;
+    ezHashSet<ezUInt64> m_WrittenThreadNames;
+
+    ezDynamicArray<CpuScopeEvent> m_CPUScopeEvents;
+    ezDynamicArray<ezProfilingSystem::CPUScope> m_CPUScopes;
+    ezDynamicArray<ezProfilingSystem::CounterSample> m_CounterSamples;
+    ezDynamicArray<StreamFrame> m_Frames;
+    ezDynamicArray<ezProfilingSystem::GPUScope> m_GPUScopes;
+  };
+
+  static volatile bool s_bStreaming = false;
+  static ezProfilingStreamThread* s_pStreamThread = nullptr;
+  static ezMutex s_StreamThreadMutex;
+  static ezThreadSignal s_StreamSignal;
+
+  /// Frames and GPU scopes that have not been written to the trace file yet.
+  static ezDynamicArray<StreamFrame> s_StreamFrames;
+  static ezDynamicArray<ezProfilingSystem::GPUScope> s_StreamGPUScopes;
+  static ezMutex s_StreamMutex;
+
+  ezResult ezProfilingStreamThread::Open(const char* szAbsoluteFilePath)
+  {
+    EZ_SUCCEED_OR_RETURN(m_File.Open(szAbsoluteFilePath, ezFileOpenMode::Write));
+
+#  if EZ_ENABLED(EZ_SUPPORTS_PROCESSES)
+    m_Writer.WriteHeader(ezProcess::GetCurrentProcessID());
+#  else
+    m_Writer.WriteHeader(0);
+#  endif
+
+    return EZ_SUCCESS;
+  }
+
+  void ezProfilingStreamThread::Flush()
+  {
+    EZ_LOCK(m_FlushMutex);
+
+    {
+      EZ_LOCK(s_ThreadInfosMutex);
+      for (const ezProfilingSystem::ThreadInfo& info : s_ThreadInfos)
+      {
+        if (!m_WrittenThreadNames.Insert(info.m_uiThreadId))
+        {
+          m_Writer.WriteThreadName(info.m_uiThreadId, info.m_sName);
+        }
+      }
+    }
+
+    {
+      EZ_LOCK(s_AllCpuScopesMutex);
+      for (CpuScopesBufferBase* pEventBuffer : s_AllCpuScopes)
+      {
+        {
+          // the recording thread continues with the (empty) array of the previous flush, so no memory is allocated in steady state
+          EZ_LOCK(pEventBuffer->m_StreamMutex);
+          m_CPUScopeEvents.Swap(pEventBuffer->m_StreamScopes);
+        }
+
+        ResolveEvents(m_CPUScopeEvents, m_CPUScopes, m_CounterSamples);
+
+        m_Writer.WriteCPUScopes(pEventBuffer->m_uiThreadId, m_CPUScopes);
+        m_Writer.WriteCounterSamples(pEventBuffer->m_uiThreadId, m_CounterSamples);
+        m_CPUScopeEvents.Clear();
+        m_CPUScopes.Clear();
+        m_CounterSamples.Clear();
+      }
+    }
+
+    {
+      EZ_LOCK(s_StreamMutex);
+      m_Frames.Swap(s_StreamFrames);
+      m_GPUScopes.Swap(s_StreamGPUScopes);
+    }
+
+    for (const StreamFrame& frame : m_Frames)
+    {
+      m_Writer.WriteFrame(frame.m_uiFrameNumber, frame.m_StartTime);
+    }
+    m_Writer.WriteGPUScopes(m_GPUScopes);
+
+    m_Frames.Clear();
+    m_GPUScopes.Clear();
+
+    if (m_Writer.GetData().IsEmpty())
+      return;
+
+    if (m_File.Write(m_Writer.GetData().GetPtr(), m_Writer.GetData().GetCount()).Failed())
+    {
+      ezLog::Error("Failed to write profiling trace to '{0}'.", m_File.GetOpenFileName());
+    }
+
+    m_Writer.ClearData();
+  }
+
+  ezUInt32 ezProfilingStreamThread::Run()
+  {
+    while (m_bRunning)
+    {
+      s_StreamSignal.WaitForSignal(m_FlushInterval);
+      Flush();
+    }
+
+    return 0;
+  }
+
   static ezEventSubscriptionID s_PluginEventSubscription = 0;
   void PluginEvent(const ezPluginEvent& e)
   {
     if (e.m_EventType == ezPluginEvent::AfterUnloading)
     {
-      // When a plugin is unloaded we need to clear all profiling data
-      // since they can contain pointers to function names that don't exist anymore.
-      ezProfilingSystem::Clear();
+      // Recorded scopes only refer to copies of their names, but the scope name caches use the addresses of function names
+      // as keys, which might be reused by the next plugin.
+      s_iScopeNameCacheGeneration.Increment();
     }
   }
 } // namespace
@@ -278,6 +591,31 @@ ezResult ezProfilingSystem::ProfilingData::Write(ezStreamWriter& outputStream) c
       }
     }
 
+    // counter samples, chrome shows one track per name
+    for (const auto& eventBuffer : m_AllEventBuffers)
+    {
+      for (const CounterSample& e : eventBuffer.m_CounterSamples)
+      {
+        writer.BeginObject();
+        writer.AddVariableString("name", e.m_szName);
+        writer.AddVariableUInt32("pid", m_uiProcessID);
+        writer.AddVariableUInt64("tid", eventBuffer.m_uiThreadId + 2);
+        writer.AddVariableUInt64("ts", static_cast<ezUInt64>(e.m_Time.GetMicroseconds()));
+        writer.AddVariableString("ph", "C");
+
+        writer.BeginObject("args");
+        writer.AddVariableDouble("value", e.m_fValue);
+        writer.EndObject();
+
+        writer.EndObject();
+
+        if (writer.HadWriteError())
+        {
+          return EZ_FAILURE;
+        }
+      }
+    }
+
     // frame start/end
     {
       ezStringBuilder sFrameName;
@@ -408,15 +746,9 @@ ezProfilingSystem::ProfilingData ezProfilingSystem::Capture()
       targetEventBuffer.m_Data.Reserve(uiSourceCount);
       for (ezUInt32 j = 0; j < uiSourceCount; ++j)
       {
-        const CPUScope& sourceEvent = sourceEventBuffer->IsMainThread() ? CastToMainThreadEventBuffer(sourceEventBuffer)->m_Data[j] : CastToOtherThreadEventBuffer(sourceEventBuffer)->m_Data[j];
-
-        CPUScope copiedEvent;
-        copiedEvent.m_szFunctionName = sourceEvent.m_szFunctionName;
-        copiedEvent.m_BeginTime = sourceEvent.m_BeginTime;
-        copiedEvent.m_EndTime = sourceEvent.m_EndTime;
-        ezStringUtils::Copy(copiedEvent.m_szName, CPUScope::NAME_SIZE, sourceEvent.m_szName);
+        const CpuScopeEvent& sourceEvent = sourceEventBuffer->IsMainThread() ? CastToMainThreadEventBuffer(sourceEventBuffer)->m_Data[j] : CastToOtherThreadEventBuffer(sourceEventBuffer)->m_Data[j];
 
-        targetEventBuffer.m_Data.PushBack(std::move(copiedEvent));
+        ResolveEvents(ezMakeArrayPtr(&sourceEvent, 1), targetEventBuffer.m_Data, targetEventBuffer.m_CounterSamples);
       }
 
       profilingData.m_AllEventBuffers.PushBack(std::move(targetEventBuffer));
@@ -466,16 +798,18 @@ void ezProfilingSystem::StartNewFrame()
     s_FrameStartTimes.PopFront();
   }
 
-  s_FrameStartTimes.PushBack(ezTime::Now());
+  const ezTime now = ezTime::Now();
+  s_FrameStartTimes.PushBack(now);
+
+  if (s_bStreaming)
+  {
+    EZ_LOCK(s_StreamMutex);
+    s_StreamFrames.PushBack({s_uiFrameCount, now});
+  }
 }
 
-// static
-void ezProfilingSystem::AddCPUScope(const char* szName, const char* szFunctionName, ezTime beginTime, ezTime endTime)
+static void AddCpuScopeEvent(const CpuScopeEvent& scope)
 {
-  // discard?
-  if (endTime - beginTime < ezTime::Milliseconds(CVarDiscardThresholdMs))
-    return;
-
   ::CpuScopesBufferBase* pScopes = s_CpuScopes;
 
   if (pScopes == nullptr)
@@ -498,12 +832,6 @@ void ezProfilingSystem::AddCPUScope(const char* szName, const char* szFunctionNa
     }
   }
 
-  CPUScope scope;
-  scope.m_szFunctionName = szFunctionName;
-  scope.m_BeginTime = beginTime;
-  scope.m_EndTime = endTime;
-  ezStringUtils::Copy(scope.m_szName, EZ_ARRAY_SIZE(scope.m_szName), szName);
-
   if (ezThreadUtils::IsMainThread())
   {
     auto pMainThreadBuffer = CastToMainThreadEventBuffer(pScopes);
@@ -524,6 +852,147 @@ void ezProfilingSystem::AddCPUScope(const char* szName, const char* szFunctionNa
 
     pOtherThreadBuffer->m_Data.PushBack(scope);
   }
+
+  if (s_bStreaming)
+  {
+    EZ_LOCK(pScopes->m_StreamMutex);
+    pScopes->m_StreamScopes.PushBack(scope);
+
+    if (pScopes->m_StreamScopes.GetCount() == STREAM_FLUSH_THRESHOLD)
+    {
+      s_StreamSignal.RaiseSignal();
+    }
+  }
+}
+
+// static
+void ezProfilingSystem::AddCPUScope(const char* szName, const char* szFunctionName, ezTime beginTime, ezTime endTime)
+{
+  AddCPUScope(ezProfilingScopeName(szName, szFunctionName), beginTime, endTime);
+}
+
+// static
+void ezProfilingSystem::AddCPUScope(const ezProfilingScopeName& name, ezTime beginTime, ezTime endTime)
+{
+  // discard?
+  if (endTime - beginTime < ezTime::Milliseconds(CVarDiscardThresholdMs))
+    return;
+
+  CpuScopeEvent scope;
+  scope.m_BeginTime = beginTime;
+  scope.m_EndTime = endTime;
+  scope.m_uiScopeNameId = name.m_uiId != ezProfilingScopeName::InvalidId ? name.m_uiId : RegisterScopeName(name.m_szName, name.m_szFunctionName);
+
+  AddCpuScopeEvent(scope);
+}
+
+// static
+void ezProfilingSystem::AddCounterSample(const char* szName, double fValue)
+{
+  AddCounterSample(ezProfilingScopeName(szName, nullptr), fValue);
+}
+
+// static
+void ezProfilingSystem::AddCounterSample(const ezProfilingScopeName& name, double fValue)
+{
+  // counter samples are never discarded, a track with gaps would show wrong values
+  CpuScopeEvent sample;
+  sample.m_BeginTime = ezTime::Now();
+  sample.m_EndTime = ezTime::Seconds(fValue);
+  sample.m_uiScopeNameId = name.m_uiId != ezProfilingScopeName::InvalidId ? name.m_uiId : RegisterScopeName(name.m_szName, name.m_szFunctionName);
+  sample.m_uiScopeNameId |= CpuScopeEvent::COUNTER_FLAG;
+
+  AddCpuScopeEvent(sample);
+}
+
+// static
+ezResult ezProfilingSystem::StartStreaming(const char* szAbsoluteFilePath, ezTime flushInterval)
+{
+  EZ_LOCK(s_StreamThreadMutex);
+
+  if (s_pStreamThread != nullptr)
+  {
+    ezLog::Error("Profiling data is already streamed to '{0}'.", szAbsoluteFilePath);
+    return EZ_FAILURE;
+  }
+
+  ezProfilingStreamThread* pStreamThread = EZ_DEFAULT_NEW(ezProfilingStreamThread, flushInterval);
+  if (pStreamThread->Open(szAbsoluteFilePath).Failed())
+  {
+    ezLog::Error("Failed to open profiling trace file '{0}'.", szAbsoluteFilePath);
+    EZ_DEFAULT_DELETE(pStreamThread);
+    return EZ_FAILURE;
+  }
+
+  // discard scopes that were added while a previous stream was stopped
+  {
+    EZ_LOCK(s_AllCpuScopesMutex);
+    for (CpuScopesBufferBase* pEventBuffer : s_AllCpuScopes)
+    {
+      EZ_LOCK(pEventBuffer->m_StreamMutex);
+      pEventBuffer->m_StreamScopes.Clear();
+    }
+  }
+
+  {
+    EZ_LOCK(s_StreamMutex);
+    s_StreamFrames.Clear();
+    s_StreamGPUScopes.Clear();
+  }
+
+  s_pStreamThread = pStreamThread;
+  s_bStreaming = true;
+
+  s_pStreamThread->Start();
+  return EZ_SUCCESS;
+}
+
+// static
+void ezProfilingSystem::StopStreaming()
+{
+  EZ_LOCK(s_StreamThreadMutex);
+
+  if (s_pStreamThread == nullptr)
+    return;
+
+  s_bStreaming = false;
+
+  s_pStreamThread->m_bRunning = false;
+  s_StreamSignal.RaiseSignal();
+  s_pStreamThread->Join();
+
+  // the stream thread might have missed scopes that were added just before streaming was stopped
+  s_pStreamThread->Flush();
+
+  EZ_DEFAULT_DELETE(s_pStreamThread);
+}
+
+// static
+bool ezProfilingSystem::IsStreaming()
+{
+  return s_bStreaming;
+}
+
+// static
+ezUInt32 ezProfilingSystem::RegisterScopeName(const char* szName, const char* szFunctionName)
+{
+  const ezUInt32 uiNameHash = ezHashingUtils::MurmurHash32String(szName);
+  const ezUInt32 uiGeneration = static_cast<ezUInt32>(s_iScopeNameCacheGeneration);
+
+  ScopeNameCacheEntry& entry = s_ScopeNameCache[(uiNameHash ^ static_cast<ezUInt32>(reinterpret_cast<size_t>(szFunctionName) >> 4)) % SCOPE_NAME_CACHE_SIZE];
+
+  // Function names are literals and can be compared by address, but names might be built at runtime and need a full comparison,
+  // otherwise a name with a colliding hash would be reported with the wrong string.
+  if (entry.m_uiNameHash != uiNameHash || entry.m_szFunctionName != szFunctionName || entry.m_uiGeneration != uiGeneration ||
+      !ezStringUtils::IsEqual(GetScopeNameData(entry.m_uiId).m_sName.GetData(), szName))
+  {
+    entry.m_uiId = AddScopeName(szName, uiNameHash, szFunctionName);
+    entry.m_uiNameHash = uiNameHash;
+    entry.m_szFunctionName = szFunctionName;
+    entry.m_uiGeneration = uiGeneration;
+  }
+
+  return entry.m_uiId;
 }
 
 // static
@@ -539,6 +1008,8 @@ void ezProfilingSystem::Initialize()
 // static
 void ezProfilingSystem::Reset()
 {
+  StopStreaming();
+
   EZ_LOCK(s_ThreadInfosMutex);
   EZ_LOCK(s_AllCpuScopesMutex);
   for (ezUInt32 i = 0; i < s_DeadThreadIDs.GetCount(); i++)
@@ -615,20 +1086,31 @@ void ezProfilingSystem::AddGPUScope(const char* szName, ezTime beginTime, ezTime
   ezStringUtils::Copy(scope.m_szName, EZ_ARRAY_SIZE(scope.m_szName), szName);
 
   s_GPUScopes->PushBack(scope);
+
+  if (s_bStreaming)
+  {
+    EZ_LOCK(s_StreamMutex);
+    s_StreamGPUScopes.PushBack(scope);
+  }
 }
 
 //////////////////////////////////////////////////////////////////////////
 
 ezProfilingScope::ezProfilingScope(const char* szName, const char* szFunctionName)
-  : m_szName(szName)
-  , m_szFunction(szFunctionName)
+  : m_Name(szName, szFunctionName)
+  , m_BeginTime(ezTime::Now())
+{
+}
+
+ezProfilingScope::ezProfilingScope(const ezProfilingScopeName& name)
+  : m_Name(name)
   , m_BeginTime(ezTime::Now())
 {
 }
 
 ezProfilingScope::~ezProfilingScope()
 {
-  ezProfilingSystem::AddCPUScope(m_szName, m_szFunction, m_BeginTime, ezTime::Now());
+  ezProfilingSystem::AddCPUScope(m_Name, m_BeginTime, ezTime::Now());
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -636,10 +1118,14 @@ ezProfilingScope::~ezProfilingScope()
 thread_local ezProfilingListScope* ezProfilingListScope::s_pCurrentList = nullptr;
 
 ezProfilingListScope::ezProfilingListScope(const char* szListName, const char* szFirstSectionName, const char* szFunctionName)
-  : m_szListName(szListName)
-  , m_szListFunction(szFunctionName)
+  : ezProfilingListScope(ezProfilingScopeName(szListName, szFunctionName), ezProfilingScopeName(szFirstSectionName, nullptr))
+{
+}
+
+ezProfilingListScope::ezProfilingListScope(const ezProfilingScopeName& listName, const ezProfilingScopeName& firstSectionName)
+  : m_ListName(listName)
   , m_ListBeginTime(ezTime::Now())
-  , m_szCurSectionName(szFirstSectionName)
+  , m_CurSectionName(firstSectionName)
   , m_CurSectionBeginTime(m_ListBeginTime)
 {
   m_pPreviousList = s_pCurrentList;
@@ -649,21 +1135,27 @@ ezProfilingListScope::ezProfilingListScope(const char* szListName, const char* s
 ezProfilingListScope::~ezProfilingListScope()
 {
   ezTime now = ezTime::Now();
-  ezProfilingSystem::AddCPUScope(m_szCurSectionName, nullptr, m_CurSectionBeginTime, now);
-  ezProfilingSystem::AddCPUScope(m_szListName, m_szListFunction, m_ListBeginTime, now);
+  ezProfilingSystem::AddCPUScope(m_CurSectionName, m_CurSectionBeginTime, now);
+  ezProfilingSystem::AddCPUScope(m_ListName, m_ListBeginTime, now);
 
   s_pCurrentList = m_pPreviousList;
 }
 
 // static
 void ezProfilingListScope::StartNextSection(const char* szNextSectionName)
+{
+  StartNextSection(ezProfilingScopeName(szNextSectionName, nullptr));
+}
+
+// static
+void ezProfilingListScope::StartNextSection(const ezProfilingScopeName& nextSectionName)
 {
   ezProfilingListScope* pCurScope = s_pCurrentList;
 
   ezTime now = ezTime::Now();
-  ezProfilingSystem::AddCPUScope(pCurScope->m_szCurSectionName, nullptr, pCurScope->m_CurSectionBeginTime, now);
+  ezProfilingSystem::AddCPUScope(pCurScope->m_CurSectionName, pCurScope->m_CurSectionBeginTime, now);
 
-  pCurScope->m_szCurSectionName = szNextSectionName;
+  pCurScope->m_CurSectionName = nextSectionName;
   pCurScope->m_CurSectionBeginTime = now;
 }
 
@@ -687,6 +1179,29 @@ void ezProfilingSystem::StartNewFrame() {}
 
 void ezProfilingSystem::AddCPUScope(const char* szName, const char* szFunctionName, ezTime beginTime, ezTime endTime) {}
 
+void ezProfilingSystem::AddCPUScope(const ezProfilingScopeName& name, ezTime beginTime, ezTime endTime) {}
+
+void ezProfilingSystem::AddCounterSample(const char* szName, double fValue) {}
+
+void ezProfilingSystem::AddCounterSample(const ezProfilingScopeName& name, double fValue) {}
+
+ezUInt32 ezProfilingSystem::RegisterScopeName(const char* szName, const char* szFunctionName)
+{
+  return 0;
+}
+
+ezResult ezProfilingSystem::StartStreaming(const char* szAbsoluteFilePath, ezTime flushInterval)
+{
+  return EZ_FAILURE;
+}
+
+void ezProfilingSystem::StopStreaming() {}
+
+bool ezProfilingSystem::IsStreaming()
+{
+  return false;
+}
+
 void ezProfilingSystem::Initialize() {}
 
 void ezProfilingSystem::Reset() {}
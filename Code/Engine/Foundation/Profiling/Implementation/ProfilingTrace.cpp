@@ -0,0 +1,521 @@
+#include <FoundationPCH.h>
+
+#include <Foundation/Containers/Deque.h>
+#include <Foundation/IO/JSONWriter.h>
+#include <Foundation/IO/Stream.h>
+#include <Foundation/Memory/EndianHelper.h>
+#include <Foundation/Profiling/Implementation/ProfilingTrace.h>
+#include <Foundation/Strings/StringBuilder.h>
+
+namespace
+{
+  enum
+  {
+    GPU_THREAD_ID = 0,
+    FRAMES_THREAD_ID = 1,
+    FIRST_CPU_THREAD_ID = 2, ///< Same ids as in ezProfilingSystem::Capture
+  };
+
+  EZ_ALWAYS_INLINE ezInt64 ToNanoseconds(ezTime time)
+  {
+    return static_cast<ezInt64>(time.GetNanoseconds());
+  }
+} // namespace
+
+void ezProfilingTraceWriter::WriteHeader(ezUInt64 uiProcessID)
+{
+  m_StringIds.Clear();
+
+  const ezUInt32 header[] = {Magic, Version};
+  m_Data.PushBackRange(ezMakeArrayPtr(reinterpret_cast<const ezUInt8*>(header), sizeof(header)));
+  WriteVarUInt(uiProcessID);
+}
+
+void ezProfilingTraceWriter::WriteThreadName(ezUInt64 uiThreadId, const char* szName)
+{
+  const ezUInt32 uiNameId = InternString(szName);
+
+  m_Data.PushBack(ezProfilingTraceRecord::ThreadName);
+  WriteVarUInt(uiThreadId);
+  WriteVarUInt(uiNameId);
+}
+
+void ezProfilingTraceWriter::WriteCPUScopes(ezUInt64 uiThreadId, ezArrayPtr<const ezProfilingSystem::CPUScope> scopes)
+{
+  if (scopes.IsEmpty())
+    return;
+
+  // all names have to be defined before the record starts
+  for (const ezProfilingSystem::CPUScope& scope : scopes)
+  {
+    InternString(scope.m_szName);
+    if (scope.m_szFunctionName != nullptr)
+    {
+      InternString(scope.m_szFunctionName);
+    }
+  }
+
+  m_Data.PushBack(ezProfilingTraceRecord::CPUScopes);
+  WriteVarUInt(uiThreadId);
+  WriteVarUInt(scopes.GetCount());
+
+  ezInt64 iPreviousTime = 0;
+  for (const ezProfilingSystem::CPUScope& scope : scopes)
+  {
+    WriteVarUInt(InternString(scope.m_szName));
+    WriteVarUInt(scope.m_szFunctionName != nullptr ? InternString(scope.m_szFunctionName) : 0);
+    WriteTimeDelta(scope.m_BeginTime, iPreviousTime);
+    WriteVarUInt(ezMath::Max<ezInt64>(ToNanoseconds(scope.m_EndTime - scope.m_BeginTime), 0));
+  }
+}
+
+void ezProfilingTraceWriter::WriteFrame(ezUInt64 uiFrameNumber, ezTime startTime)
+{
+  m_Data.PushBack(ezProfilingTraceRecord::Frame);
+  WriteVarUInt(uiFrameNumber);
+  WriteVarUInt(ezMath::Max<ezInt64>(ToNanoseconds(startTime), 0));
+}
+
+void ezProfilingTraceWriter::WriteGPUScopes(ezArrayPtr<const ezProfilingSystem::GPUScope> scopes)
+{
+  if (scopes.IsEmpty())
+    return;
+
+  for (const ezProfilingSystem::GPUScope& scope : scopes)
+  {
+    InternString(scope.m_szName);
+  }
+
+  m_Data.PushBack(ezProfilingTraceRecord::GPUScopes);
+  WriteVarUInt(scopes.GetCount());
+
+  ezInt64 iPreviousTime = 0;
+  for (const ezProfilingSystem::GPUScope& scope : scopes)
+  {
+    WriteVarUInt(InternString(scope.m_szName));
+    WriteTimeDelta(scope.m_BeginTime, iPreviousTime);
+    WriteVarUInt(ezMath::Max<ezInt64>(ToNanoseconds(scope.m_EndTime - scope.m_BeginTime), 0));
+  }
+}
+
+void ezProfilingTraceWriter::WriteCounterSamples(ezUInt64 uiThreadId, ezArrayPtr<const ezProfilingSystem::CounterSample> samples)
+{
+  if (samples.IsEmpty())
+    return;
+
+  for (const ezProfilingSystem::CounterSample& sample : samples)
+  {
+    InternString(sample.m_szName);
+  }
+
+  m_Data.PushBack(ezProfilingTraceRecord::Counters);
+  WriteVarUInt(uiThreadId);
+  WriteVarUInt(samples.GetCount());
+
+  ezInt64 iPreviousTime = 0;
+  for (const ezProfilingSystem::CounterSample& sample : samples)
+  {
+    WriteVarUInt(InternString(sample.m_szName));
+    WriteTimeDelta(sample.m_Time, iPreviousTime);
+
+    ezUInt64 uiValue = 0;
+    ezMemoryUtils::Copy(reinterpret_cast<double*>(&uiValue), &sample.m_fValue, 1);
+    ezEndianHelper::NativeToLittleEndian(&uiValue, 1);
+    m_Data.PushBackRange(ezMakeArrayPtr(reinterpret_cast<const ezUInt8*>(&uiValue), sizeof(uiValue)));
+  }
+}
+
+ezUInt32 ezProfilingTraceWriter::InternString(const char* szString)
+{
+  ezString sString = szString;
+
+  ezUInt32 uiId = 0;
+  if (m_StringIds.TryGetValue(sString, uiId))
+    return uiId;
+
+  // id 0 is reserved for 'no string'
+  uiId = m_StringIds.GetCount() + 1;
+
+  const ezUInt32 uiLength = sString.GetElementCount();
+
+  m_Data.PushBack(ezProfilingTraceRecord::String);
+  WriteVarUInt(uiId);
+  WriteVarUInt(uiLength);
+  m_Data.PushBackRange(ezMakeArrayPtr(reinterpret_cast<const ezUInt8*>(sString.GetData()), uiLength));
+
+  m_StringIds.Insert(std::move(sString), uiId);
+  return uiId;
+}
+
+void ezProfilingTraceWriter::WriteVarUInt(ezUInt64 uiValue)
+{
+  while (uiValue >= 0x80)
+  {
+    m_Data.PushBack(static_cast<ezUInt8>(uiValue | 0x80));
+    uiValue >>= 7;
+  }
+
+  m_Data.PushBack(static_cast<ezUInt8>(uiValue));
+}
+
+void ezProfilingTraceWriter::WriteTimeDelta(ezTime time, ezInt64& inout_iPreviousTime)
+{
+  const ezInt64 iTime = ToNanoseconds(time);
+  const ezInt64 iDelta = iTime - inout_iPreviousTime;
+  inout_iPreviousTime = iTime;
+
+  // zig-zag encoding, so that small negative deltas stay small as well
+  WriteVarUInt((static_cast<ezUInt64>(iDelta) << 1) ^ static_cast<ezUInt64>(iDelta >> 63));
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+  class ezProfilingTraceReader
+  {
+  public:
+    ezProfilingTraceReader(ezStreamReader& inputStream)
+      : m_InputStream(inputStream)
+    {
+    }
+
+    /// \brief Returns false at the end of the stream.
+    bool ReadByte(ezUInt8& out_uiValue) { return m_InputStream.ReadBytes(&out_uiValue, 1) == 1; }
+
+    ezResult ReadVarUInt(ezUInt64& out_uiValue)
+    {
+      out_uiValue = 0;
+
+      for (ezUInt32 uiShift = 0; uiShift < 64; uiShift += 7)
+      {
+        ezUInt8 uiByte = 0;
+        if (!ReadByte(uiByte))
+          return EZ_FAILURE;
+
+        out_uiValue |= static_cast<ezUInt64>(uiByte & 0x7F) << uiShift;
+
+        if ((uiByte & 0x80) == 0)
+          return EZ_SUCCESS;
+      }
+
+      return EZ_FAILURE;
+    }
+
+    ezResult ReadTimeDelta(ezInt64& inout_iTime)
+    {
+      ezUInt64 uiValue = 0;
+      EZ_SUCCEED_OR_RETURN(ReadVarUInt(uiValue));
+
+      inout_iTime += static_cast<ezInt64>(uiValue >> 1) ^ -static_cast<ezInt64>(uiValue & 1);
+      return EZ_SUCCESS;
+    }
+
+    ezResult ReadDouble(double& out_fValue) { return m_InputStream.ReadQWordValue(&out_fValue); }
+
+    ezResult ReadStringId(const char*& out_szString)
+    {
+      ezUInt64 uiId = 0;
+      EZ_SUCCEED_OR_RETURN(ReadVarUInt(uiId));
+
+      if (uiId == 0)
+      {
+        out_szString = nullptr;
+        return EZ_SUCCESS;
+      }
+
+      if (uiId > m_Strings.GetCount())
+        return EZ_FAILURE;
+
+      out_szString = m_Strings[static_cast<ezUInt32>(uiId - 1)].GetData();
+      return EZ_SUCCESS;
+    }
+
+    ezResult ReadStringDefinition()
+    {
+      ezUInt64 uiId = 0;
+      ezUInt64 uiLength = 0;
+      EZ_SUCCEED_OR_RETURN(ReadVarUInt(uiId));
+      EZ_SUCCEED_OR_RETURN(ReadVarUInt(uiLength));
+
+      // ids are assigned in order
+      if (uiId != m_Strings.GetCount() + 1 || uiLength > 0xFFFF)
+        return EZ_FAILURE;
+
+      m_Buffer.SetCountUninitialized(static_cast<ezUInt32>(uiLength) + 1);
+      if (m_InputStream.ReadBytes(m_Buffer.GetData(), uiLength) != uiLength)
+        return EZ_FAILURE;
+
+      m_Buffer[static_cast<ezUInt32>(uiLength)] = '\0';
+      m_Strings.PushBack(m_Buffer.GetData());
+      return EZ_SUCCESS;
+    }
+
+  private:
+    ezStreamReader& m_InputStream;
+    ezDeque<ezString> m_Strings;
+    ezDynamicArray<char> m_Buffer;
+  };
+
+  struct ConvertedScope
+  {
+    EZ_DECLARE_POD_TYPE();
+
+    const char* m_szName;
+    const char* m_szFunctionName;
+    ezInt64 m_iBeginTime;
+    ezInt64 m_iDuration;
+  };
+
+  void WriteThreadMetadata(ezStandardJSONWriter& writer, ezUInt64 uiProcessID, ezUInt64 uiThreadId, const char* szName)
+  {
+    writer.BeginObject();
+    writer.AddVariableString("name", "thread_name");
+    writer.AddVariableString("cat", "__metadata");
+    writer.AddVariableUInt64("pid", uiProcessID);
+    writer.AddVariableUInt64("tid", uiThreadId);
+    writer.AddVariableString("ph", "M");
+
+    writer.BeginObject("args");
+    writer.AddVariableString("name", szName);
+    writer.EndObject();
+
+    writer.EndObject();
+  }
+
+  void WriteThreadSortIndex(ezStandardJSONWriter& writer, ezUInt64 uiProcessID, ezUInt64 uiThreadId, ezInt32 iSortIndex)
+  {
+    writer.BeginObject();
+    writer.AddVariableString("name", "thread_sort_index");
+    writer.AddVariableString("cat", "__metadata");
+    writer.AddVariableUInt64("pid", uiProcessID);
+    writer.AddVariableUInt64("tid", uiThreadId);
+    writer.AddVariableString("ph", "M");
+
+    writer.BeginObject("args");
+    writer.AddVariableInt32("sort_index", iSortIndex);
+    writer.EndObject();
+
+    writer.EndObject();
+  }
+
+  void WriteScope(ezStandardJSONWriter& writer, ezUInt64 uiProcessID, ezUInt64 uiThreadId, const char* szName, const char* szFunctionName,
+    ezInt64 iBeginTime, ezInt64 iEndTime)
+  {
+    writer.BeginObject();
+    writer.AddVariableString("name", szName);
+    writer.AddVariableUInt64("pid", uiProcessID);
+    writer.AddVariableUInt64("tid", uiThreadId);
+    writer.AddVariableUInt64("ts", static_cast<ezUInt64>(iBeginTime / 1000));
+    writer.AddVariableString("ph", "B");
+
+    if (szFunctionName != nullptr)
+    {
+      writer.BeginObject("args");
+      writer.AddVariableString("function", szFunctionName);
+      writer.EndObject();
+    }
+
+    writer.EndObject();
+
+    writer.BeginObject();
+    writer.AddVariableString("name", szName);
+    writer.AddVariableUInt64("pid", uiProcessID);
+    writer.AddVariableUInt64("tid", uiThreadId);
+    writer.AddVariableUInt64("ts", static_cast<ezUInt64>(iEndTime / 1000));
+    writer.AddVariableString("ph", "E");
+    writer.EndObject();
+  }
+
+  void WriteCounterSample(ezStandardJSONWriter& writer, ezUInt64 uiProcessID, ezUInt64 uiThreadId, const char* szName, ezInt64 iTime, double fValue)
+  {
+    writer.BeginObject();
+    writer.AddVariableString("name", szName);
+    writer.AddVariableUInt64("pid", uiProcessID);
+    writer.AddVariableUInt64("tid", uiThreadId);
+    writer.AddVariableUInt64("ts", static_cast<ezUInt64>(iTime / 1000));
+    writer.AddVariableString("ph", "C");
+
+    writer.BeginObject("args");
+    writer.AddVariableDouble("value", fValue);
+    writer.EndObject();
+
+    writer.EndObject();
+  }
+} // namespace
+
+// static
+ezResult ezProfilingSystem::ConvertTraceToJSON(ezStreamReader& inputStream, ezStreamWriter& outputStream)
+{
+  ezProfilingTraceReader reader(inputStream);
+
+  ezUInt32 uiMagic = 0;
+  ezUInt32 uiVersion = 0;
+  inputStream >> uiMagic;
+  inputStream >> uiVersion;
+
+  if (uiMagic != ezProfilingTraceWriter::Magic)
+  {
+    ezLog::Error("Input is not a profiling trace.");
+    return EZ_FAILURE;
+  }
+
+  // version 2 only added the Counters record
+  if (uiVersion == 0 || uiVersion > ezProfilingTraceWriter::Version)
+  {
+    ezLog::Error("Unsupported profiling trace version {0}.", uiVersion);
+    return EZ_FAILURE;
+  }
+
+  ezUInt64 uiProcessID = 0;
+  if (reader.ReadVarUInt(uiProcessID).Failed())
+  {
+    ezLog::Error("Profiling trace header is truncated.");
+    return EZ_FAILURE;
+  }
+
+  ezStandardJSONWriter writer;
+  writer.SetWhitespaceMode(ezJSONWriter::WhitespaceMode::None);
+  writer.SetOutputStream(&outputStream);
+
+  writer.BeginObject();
+  writer.BeginArray("traceEvents");
+
+  WriteThreadMetadata(writer, uiProcessID, FRAMES_THREAD_ID, "Frames");
+  WriteThreadSortIndex(writer, uiProcessID, FRAMES_THREAD_ID, -1);
+  WriteThreadMetadata(writer, uiProcessID, GPU_THREAD_ID, "GPU");
+  WriteThreadSortIndex(writer, uiProcessID, GPU_THREAD_ID, -2);
+
+  ezDynamicArray<ConvertedScope> scopes;
+  ezStringBuilder sFrameName;
+  ezInt64 iPreviousFrameTime = -1;
+  bool bTruncated = false;
+
+  ezUInt8 uiRecord = 0;
+  while (!bTruncated && !writer.HadWriteError() && reader.ReadByte(uiRecord))
+  {
+    switch (uiRecord)
+    {
+      case ezProfilingTraceRecord::String:
+      {
+        bTruncated = reader.ReadStringDefinition().Failed();
+        break;
+      }
+
+      case ezProfilingTraceRecord::ThreadName:
+      {
+        ezUInt64 uiThreadId = 0;
+        const char* szName = nullptr;
+        bTruncated = reader.ReadVarUInt(uiThreadId).Failed() || reader.ReadStringId(szName).Failed();
+
+        if (!bTruncated)
+        {
+          WriteThreadMetadata(writer, uiProcessID, uiThreadId + FIRST_CPU_THREAD_ID, szName != nullptr ? szName : "");
+        }
+        break;
+      }
+
+      case ezProfilingTraceRecord::CPUScopes:
+      case ezProfilingTraceRecord::GPUScopes:
+      {
+        const bool bCPU = uiRecord == ezProfilingTraceRecord::CPUScopes;
+
+        ezUInt64 uiThreadId = GPU_THREAD_ID;
+        ezUInt64 uiCount = 0;
+        if (bCPU)
+        {
+          bTruncated = reader.ReadVarUInt(uiThreadId).Failed();
+          uiThreadId += FIRST_CPU_THREAD_ID;
+        }
+
+        bTruncated = bTruncated || reader.ReadVarUInt(uiCount).Failed();
+
+        scopes.Clear();
+        ezInt64 iTime = 0;
+        for (ezUInt64 i = 0; i < uiCount && !bTruncated; ++i)
+        {
+          ConvertedScope& scope = scopes.ExpandAndGetRef();
+          scope.m_szFunctionName = nullptr;
+
+          ezUInt64 uiDuration = 0;
+          bTruncated = reader.ReadStringId(scope.m_szName).Failed() || (bCPU && reader.ReadStringId(scope.m_szFunctionName).Failed()) ||
+                       reader.ReadTimeDelta(iTime).Failed() || reader.ReadVarUInt(uiDuration).Failed() || scope.m_szName == nullptr;
+
+          scope.m_iBeginTime = iTime;
+          scope.m_iDuration = static_cast<ezInt64>(uiDuration);
+        }
+
+        if (bTruncated)
+          break;
+
+        // parent scopes first, see ezProfilingSystem::ProfilingData::Write
+        scopes.Sort([](const ConvertedScope& a, const ConvertedScope& b) { return a.m_iDuration > b.m_iDuration; });
+
+        for (const ConvertedScope& scope : scopes)
+        {
+          WriteScope(writer, uiProcessID, uiThreadId, scope.m_szName, scope.m_szFunctionName, scope.m_iBeginTime, scope.m_iBeginTime + scope.m_iDuration);
+        }
+        break;
+      }
+
+      case ezProfilingTraceRecord::Frame:
+      {
+        ezUInt64 uiFrameNumber = 0;
+        ezUInt64 uiStartTime = 0;
+        bTruncated = reader.ReadVarUInt(uiFrameNumber).Failed() || reader.ReadVarUInt(uiStartTime).Failed();
+
+        if (!bTruncated)
+        {
+          // like in ezProfilingSystem::ProfilingData::Write a frame is named after the frame count at its end
+          if (iPreviousFrameTime >= 0)
+          {
+            sFrameName.Format("Frame {}", uiFrameNumber);
+            WriteScope(writer, uiProcessID, FRAMES_THREAD_ID, sFrameName, nullptr, iPreviousFrameTime, static_cast<ezInt64>(uiStartTime));
+          }
+
+          iPreviousFrameTime = static_cast<ezInt64>(uiStartTime);
+        }
+        break;
+      }
+
+      case ezProfilingTraceRecord::Counters:
+      {
+        ezUInt64 uiThreadId = 0;
+        ezUInt64 uiCount = 0;
+        bTruncated = reader.ReadVarUInt(uiThreadId).Failed() || reader.ReadVarUInt(uiCount).Failed();
+
+        ezInt64 iTime = 0;
+        for (ezUInt64 i = 0; i < uiCount && !bTruncated; ++i)
+        {
+          const char* szName = nullptr;
+          double fValue = 0.0;
+          bTruncated = reader.ReadStringId(szName).Failed() || reader.ReadTimeDelta(iTime).Failed() || reader.ReadDouble(fValue).Failed() ||
+                       szName == nullptr;
+
+          if (!bTruncated)
+          {
+            WriteCounterSample(writer, uiProcessID, uiThreadId + FIRST_CPU_THREAD_ID, szName, iTime, fValue);
+          }
+        }
+        break;
+      }
+
+      default:
+        ezLog::Error("Unknown record type {0} in profiling trace.", uiRecord);
+        return EZ_FAILURE;
+    }
+  }
+
+  // a trace of a process that did not shut down properly may end in the middle of a record, everything before that is still valid
+  if (bTruncated)
+  {
+    ezLog::Warning("Profiling trace is truncated or corrupted, the last record is ignored.");
+  }
+
+  writer.EndArray();
+  writer.EndObject();
+
+  return writer.HadWriteError() ? EZ_FAILURE : EZ_SUCCESS;
+}
+
+EZ_STATICLINK_FILE(Foundation, Foundation_Profiling_Implementation_ProfilingTrace);
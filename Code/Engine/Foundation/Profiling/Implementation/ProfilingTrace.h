@@ -0,0 +1,56 @@
+#pragma once
+
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Profiling/Profiling.h>
+#include <Foundation/Strings/String.h>
+
+/// \brief [internal] The record types of the binary trace that ezProfilingSystem writes in streaming mode.
+///
+/// A trace starts with the magic number, the format version and the process id, followed by any number of records.
+/// Each record starts with its type as one byte. All integers are stored as variable length integers (7 bits per byte),
+/// times are stored in nanoseconds. Names are interned, a String record defines the id of a name before it is used for the first time.
+/// The begin times in a CPUScopes or GPUScopes record are stored as zig-zag encoded deltas to the previous scope of the same record,
+/// the same applies to the sample times in a Counters record. Counter values are stored as raw little endian doubles.
+struct ezProfilingTraceRecord
+{
+  typedef ezUInt8 StorageType;
+
+  enum Enum : ezUInt8
+  {
+    String = 1,     ///< id, length, characters
+    ThreadName = 2, ///< thread id, string id
+    CPUScopes = 3,  ///< thread id, scope count, scope count * (name id, function name id or 0, begin time delta, duration)
+    Frame = 4,      ///< frame number, start time
+    GPUScopes = 5,  ///< scope count, scope count * (name id, begin time delta, duration)
+    Counters = 6,   ///< thread id, sample count, sample count * (name id, time delta, value)
+  };
+};
+
+/// \brief [internal] Encodes profiling data in the binary trace format into a memory buffer.
+class EZ_FOUNDATION_DLL ezProfilingTraceWriter
+{
+public:
+  static constexpr ezUInt32 Magic = 0x5450455A; // 'EZPT'
+  static constexpr ezUInt32 Version = 2;
+
+  void WriteHeader(ezUInt64 uiProcessID);
+  void WriteThreadName(ezUInt64 uiThreadId, const char* szName);
+  void WriteCPUScopes(ezUInt64 uiThreadId, ezArrayPtr<const ezProfilingSystem::CPUScope> scopes);
+  void WriteFrame(ezUInt64 uiFrameNumber, ezTime startTime);
+  void WriteGPUScopes(ezArrayPtr<const ezProfilingSystem::GPUScope> scopes);
+  void WriteCounterSamples(ezUInt64 uiThreadId, ezArrayPtr<const ezProfilingSystem::CounterSample> samples);
+
+  /// \brief The encoded data since the last call to ClearData().
+  ezArrayPtr<const ezUInt8> GetData() const { return m_Data; }
+  void ClearData() { m_Data.Clear(); }
+
+private:
+  ezUInt32 InternString(const char* szString);
+
+  void WriteVarUInt(ezUInt64 uiValue);
+  void WriteTimeDelta(ezTime time, ezInt64& inout_iPreviousTime);
+
+  ezHashTable<ezString, ezUInt32> m_StringIds;
+  ezDynamicArray<ezUInt8> m_Data;
+};
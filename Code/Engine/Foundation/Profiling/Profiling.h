@@ -6,9 +6,48 @@
 #include <Foundation/System/Process.h>
 #include <Foundation/Time/Time.h>
 
+class ezStreamReader;
 class ezStreamWriter;
 class ezThread;
 
+/// \brief Refers to the name and function of a profiling scope, either by a registered id or by the strings themselves.
+///
+/// Recorded scopes only store the id of their name, see ezProfilingSystem::RegisterScopeName().
+/// The EZ_PROFILE_SCOPE macros register string literals once per call site, all other names are registered when the scope is recorded.
+struct ezProfilingScopeName
+{
+  static constexpr ezUInt32 InvalidId = 0xFFFFFFFFu;
+
+  EZ_ALWAYS_INLINE explicit ezProfilingScopeName(ezUInt32 uiId)
+    : m_uiId(uiId)
+  {
+  }
+
+  EZ_ALWAYS_INLINE ezProfilingScopeName(const char* szName, const char* szFunctionName)
+    : m_szName(szName)
+    , m_szFunctionName(szFunctionName)
+  {
+  }
+
+  ezUInt32 m_uiId = InvalidId;
+  const char* m_szName = nullptr;
+  const char* m_szFunctionName = nullptr;
+};
+
+namespace ezInternal
+{
+  /// \brief Only string literals can be registered once per call site, other strings might change between calls.
+  template <typename T>
+  struct ezProfilingIsStringLiteral : std::false_type
+  {
+  };
+
+  template <size_t N>
+  struct ezProfilingIsStringLiteral<const char (&)[N]> : std::true_type
+  {
+  };
+} // namespace ezInternal
+
 /// \brief This class encapsulates a profiling scope.
 ///
 /// The constructor creates a new scope in the profiling system and the destructor pops the scope.
@@ -17,11 +56,11 @@ class EZ_FOUNDATION_DLL ezProfilingScope
 {
 public:
   ezProfilingScope(const char* szName, const char* szFunctionName);
+  ezProfilingScope(const ezProfilingScopeName& name);
   ~ezProfilingScope();
 
 protected:
-  const char* m_szName;
-  const char* m_szFunction;
+  ezProfilingScopeName m_Name;
   ezTime m_BeginTime;
 };
 
@@ -36,20 +75,21 @@ class ezProfilingListScope
 {
 public:
   EZ_FOUNDATION_DLL ezProfilingListScope(const char* szListName, const char* szFirstSectionName, const char* szFunctionName);
+  EZ_FOUNDATION_DLL ezProfilingListScope(const ezProfilingScopeName& listName, const ezProfilingScopeName& firstSectionName);
   EZ_FOUNDATION_DLL ~ezProfilingListScope();
 
   EZ_FOUNDATION_DLL static void StartNextSection(const char* szNextSectionName);
+  EZ_FOUNDATION_DLL static void StartNextSection(const ezProfilingScopeName& nextSectionName);
 
 protected:
   static thread_local ezProfilingListScope* s_pCurrentList; 
 
   ezProfilingListScope* m_pPreviousList;
 
-  const char* m_szListName;
-  const char* m_szListFunction;
+  ezProfilingScopeName m_ListName;
   ezTime m_ListBeginTime;
 
-  const char* m_szCurSectionName;
+  ezProfilingScopeName m_CurSectionName;
   ezTime m_CurSectionBeginTime;
 };
 
@@ -63,21 +103,31 @@ public:
     ezString m_sName;
   };
 
+  /// \brief A captured CPU scope. The names point to the registered scope names and stay valid until shutdown.
   struct CPUScope
   {
     EZ_DECLARE_POD_TYPE();
 
-    static constexpr ezUInt32 NAME_SIZE = 40;
-
+    const char* m_szName;
     const char* m_szFunctionName;
     ezTime m_BeginTime;
     ezTime m_EndTime;
-    char m_szName[NAME_SIZE];
+  };
+
+  /// \brief A captured counter sample. The name points to the registered counter name and stays valid until shutdown.
+  struct CounterSample
+  {
+    EZ_DECLARE_POD_TYPE();
+
+    const char* m_szName;
+    ezTime m_Time;
+    double m_fValue;
   };
 
   struct CPUScopesBufferFlat
   {
     ezDynamicArray<CPUScope> m_Data;
+    ezDynamicArray<CounterSample> m_CounterSamples;
     ezUInt64 m_uiThreadId = 0;
   };
 
@@ -126,6 +176,38 @@ public:
   /// \brief Adds a new scoped event for the calling thread in the profiling system
   static void AddCPUScope(const char* szName, const char* szFunctionName, ezTime beginTime, ezTime endTime);
 
+  /// \brief Adds a new scoped event for the calling thread in the profiling system, the name is only registered if the scope isn't discarded.
+  static void AddCPUScope(const ezProfilingScopeName& name, ezTime beginTime, ezTime endTime);
+
+  /// \brief Records the current value of a counter for the calling thread.
+  ///
+  /// Samples with the same name are shown as one counter track, no matter on which thread they were recorded.
+  static void AddCounterSample(const char* szName, double fValue);
+
+  /// \brief Same as above, but with a name that may have been registered already.
+  static void AddCounterSample(const ezProfilingScopeName& name, double fValue);
+
+  /// \brief Returns the id of the given combination of scope name and function name (which may be nullptr).
+  ///
+  /// Both strings are copied when they are registered for the first time, the id stays valid until shutdown.
+  static ezUInt32 RegisterScopeName(const char* szName, const char* szFunctionName);
+
+  /// \brief Starts writing all profiling scopes and frames continuously to a binary trace file.
+  ///
+  /// Unlike Capture(), which only returns what still fits into the ring buffers, streaming records everything until StopStreaming() is called,
+  /// so even very long sessions can be profiled completely. A background thread flushes the recorded data every \a flushInterval,
+  /// which keeps the memory usage bounded. The trace file can be converted to JSON with ConvertTraceToJSON().
+  static ezResult StartStreaming(const char* szAbsoluteFilePath, ezTime flushInterval = ezTime::Milliseconds(100));
+
+  /// \brief Flushes all remaining data and closes the trace file.
+  static void StopStreaming();
+
+  /// \brief Returns whether StartStreaming() has been called successfully and StopStreaming() has not been called yet.
+  static bool IsStreaming();
+
+  /// \brief Converts a binary trace file that was written during streaming to the same JSON format that ProfilingData::Write() produces.
+  static ezResult ConvertTraceToJSON(ezStreamReader& inputStream, ezStreamWriter& outputStream);
+
 private:
   EZ_MAKE_SUBSYSTEM_STARTUP_FRIEND(Foundation, ProfilingSystem);
   friend ezUInt32 RunThread(ezThread* pThread);
@@ -150,6 +232,20 @@ public:
 
 #if EZ_ENABLED(EZ_USE_PROFILING) || defined(EZ_DOCS)
 
+/// \brief [internal] Creates an ezProfilingScopeName. String literals are registered only once per call site.
+#  define EZ_PROFILING_SCOPE_NAME(szScopeName, szFunctionName)                                                                              \
+    [](auto&& name, const char* szFunction) -> ezProfilingScopeName {                                                                      \
+      if constexpr (ezInternal::ezProfilingIsStringLiteral<decltype(name)>::value)                                                         \
+      {                                                                                                                                    \
+        static const ezUInt32 s_uiScopeNameId = ezProfilingSystem::RegisterScopeName(name, szFunction);                                   \
+        return ezProfilingScopeName(s_uiScopeNameId);                                                                                      \
+      }                                                                                                                                    \
+      else                                                                                                                                 \
+      {                                                                                                                                    \
+        return ezProfilingScopeName(name, szFunction);                                                                                     \
+      }                                                                                                                                    \
+    }(szScopeName, szFunctionName)
+
 /// \brief Profiles the current scope using the given name.
 ///
 /// It is allowed to nest EZ_PROFILE_SCOPE, also with EZ_PROFILE_LIST_SCOPE. However EZ_PROFILE_SCOPE should start and end within the same list scope section.
@@ -158,7 +254,8 @@ public:
 ///
 /// \sa ezProfilingScope
 /// \sa EZ_PROFILE_LIST_SCOPE
-#  define EZ_PROFILE_SCOPE(szScopeName) ezProfilingScope EZ_CONCAT(_ezProfilingScope, EZ_SOURCE_LINE)(szScopeName, EZ_SOURCE_FUNCTION)
+#  define EZ_PROFILE_SCOPE(szScopeName)                                                                                                     \
+    ezProfilingScope EZ_CONCAT(_ezProfilingScope, EZ_SOURCE_LINE)(EZ_PROFILING_SCOPE_NAME(szScopeName, EZ_SOURCE_FUNCTION))
 
 /// \brief Profiles the current scope using the given name as the overall list scope name and the section name for the first section in the list.
 ///
@@ -171,13 +268,21 @@ public:
 /// \sa ezProfilingListScope
 /// \sa EZ_PROFILE_LIST_NEXT_SECTION
 #  define EZ_PROFILE_LIST_SCOPE(szListName, szFirstSectionName)                                                                            \
-    ezProfilingListScope EZ_CONCAT(_ezProfilingScope, EZ_SOURCE_LINE)(szListName, szFirstSectionName, EZ_SOURCE_FUNCTION)
+    ezProfilingListScope EZ_CONCAT(_ezProfilingScope, EZ_SOURCE_LINE)(                                                                      \
+      EZ_PROFILING_SCOPE_NAME(szListName, EZ_SOURCE_FUNCTION), EZ_PROFILING_SCOPE_NAME(szFirstSectionName, nullptr))
 
 /// \brief Starts a new section in a EZ_PROFILE_LIST_SCOPE
 ///
 /// \sa ezProfilingListScope
 /// \sa EZ_PROFILE_LIST_SCOPE
-#  define EZ_PROFILE_LIST_NEXT_SECTION(szNextSectionName) ezProfilingListScope::StartNextSection(szNextSectionName)
+#  define EZ_PROFILE_LIST_NEXT_SECTION(szNextSectionName)                                                                                   \
+    ezProfilingListScope::StartNextSection(EZ_PROFILING_SCOPE_NAME(szNextSectionName, nullptr))
+
+/// \brief Records the current value of a counter, e.g. a queue length or a memory usage, which is shown as a counter track next to the scopes.
+///
+/// \sa ezProfilingSystem::AddCounterSample
+#  define EZ_PROFILE_COUNTER(szCounterName, value)                                                                                         \
+    ezProfilingSystem::AddCounterSample(EZ_PROFILING_SCOPE_NAME(szCounterName, nullptr), static_cast<double>(value))
 
 #else
 
@@ -187,5 +292,7 @@ public:
 
 #  define EZ_PROFILE_LIST_NEXT_SECTION(szNextSectionName) /*empty*/
 
+#  define EZ_PROFILE_COUNTER(szCounterName, value) /*empty*/
+
 #endif
 
@@ -14,7 +14,8 @@ class ezTempHashedString;
 /// (it's a pointer comparison).\n
 /// Copying ezHashedString objects around and assigning between them is very fast as well.\n
 /// \n
-/// Assigning from some other string type is rather slow though, as it requires thread synchronization.\n
+/// Assigning from some other string type is rather slow though, as it requires thread synchronization. The central storage is split
+/// into shards with separate locks, so threads that assign different strings rarely have to wait for each other.\n
 /// You can also get access to the actual string data via GetString().\n
 /// \n
 /// You should use ezHashedString whenever the size of the encapsulating object is important and when changes to the string itself
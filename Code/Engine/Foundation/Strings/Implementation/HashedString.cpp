@@ -4,14 +4,37 @@
 #include <Foundation/Threading/Lock.h>
 #include <Foundation/Threading/Mutex.h>
 
-struct HashedStringData
+namespace
 {
-  ezMutex m_Mutex;
-  ezHashedString::StringStorage m_Storage;
-  ezHashedString::HashedType m_Empty;
-};
+  enum
+  {
+    NumStorageShards = 64,
+  };
+
+  /// All strings whose hash maps to this shard. Every shard has its own lock, so that threads that add different strings rarely wait
+  /// for each other.
+  struct EZ_ALIGN(StorageShard, 64)
+  {
+    ezMutex m_Mutex;
+    ezHashedString::StringStorage m_Storage;
+  };
 
-static HashedStringData* s_pHSData;
+  struct HashedStringData
+  {
+    StorageShard m_Shards[NumStorageShards];
+    ezHashedString::HashedType m_Empty;
+  };
+
+  static HashedStringData* s_pHSData;
+
+  EZ_ALWAYS_INLINE StorageShard& GetStorageShard(ezUInt32 uiHash)
+  {
+    // the lower bits are used by the map, so take the upper bits for the shard
+    return s_pHSData->m_Shards[uiHash >> 26];
+  }
+} // namespace
+
+EZ_CHECK_AT_COMPILETIME((1 << (32 - 26)) == NumStorageShards);
 
 EZ_MSVC_ANALYSIS_WARNING_PUSH
 EZ_MSVC_ANALYSIS_WARNING_DISABLE(6011) // Disable warning for null pointer dereference as InitHashedString() will ensure that s_pHSData is set
@@ -22,11 +45,12 @@ ezHashedString::HashedType ezHashedString::AddHashedString(const char* szString,
   if (s_pHSData == nullptr)
     InitHashedString();
 
-  EZ_LOCK(s_pHSData->m_Mutex);
+  StorageShard& shard = GetStorageShard(uiHash);
+  EZ_LOCK(shard.m_Mutex);
 
   // try to find the existing string
   bool bExisted = false;
-  auto ret = s_pHSData->m_Storage.FindOrAdd(uiHash, &bExisted);
+  auto ret = shard.m_Storage.FindOrAdd(uiHash, &bExisted);
 
   // if it already exists, just increase the refcount
   if (bExisted)
@@ -70,19 +94,22 @@ void ezHashedString::InitHashedString()
 #if EZ_ENABLED(EZ_HASHED_STRING_REF_COUNTING)
 ezUInt32 ezHashedString::ClearUnusedStrings()
 {
-  EZ_LOCK(s_pHSData->m_Mutex);
-
   ezUInt32 uiDeleted = 0;
 
-  for (auto it = s_pHSData->m_Storage.GetIterator(); it.IsValid();)
+  for (StorageShard& shard : s_pHSData->m_Shards)
   {
-    if (it.Value().m_iRefCount == 0)
+    EZ_LOCK(shard.m_Mutex);
+
+    for (auto it = shard.m_Storage.GetIterator(); it.IsValid();)
     {
-      it = s_pHSData->m_Storage.Remove(it);
-      ++uiDeleted;
+      if (it.Value().m_iRefCount == 0)
+      {
+        it = shard.m_Storage.Remove(it);
+        ++uiDeleted;
+      }
+      else
+        ++it;
     }
-    else
-      ++it;
   }
 
   return uiDeleted;
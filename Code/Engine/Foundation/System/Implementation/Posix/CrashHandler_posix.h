@@ -11,6 +11,8 @@ EZ_FOUNDATION_INTERNAL_HEADER
 
 static void ezCrashHandlerFunc() noexcept
 {
+  ezGlobalLog::TryFlushAsyncMessages();
+
   if (ezCrashHandler::GetCrashHandler() != nullptr)
   {
     ezCrashHandler::GetCrashHandler()->HandleCrash(nullptr);
@@ -49,6 +51,8 @@ static void ezSignalHandler(int signum)
       break;
   }
 
+  ezGlobalLog::TryFlushAsyncMessages();
+
   if (ezCrashHandler::GetCrashHandler() != nullptr)
   {
     ezCrashHandler::GetCrashHandler()->HandleCrash(nullptr);
@@ -12,6 +12,8 @@ static LONG WINAPI ezCrashHandlerFunc(struct _EXCEPTION_POINTERS* pExceptionInfo
 
   if (s_bAlreadyHandled == false)
   {
+    ezGlobalLog::TryFlushAsyncMessages();
+
     if (ezCrashHandler::GetCrashHandler() != nullptr)
     {
       s_bAlreadyHandled = true;
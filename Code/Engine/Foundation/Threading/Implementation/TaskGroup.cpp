@@ -2,33 +2,159 @@
 
 #include <Foundation/Threading/Implementation/TaskGroup.h>
 #include <Foundation/Threading/Lock.h>
+#include <Foundation/Threading/ThreadUtils.h>
+
+#if EZ_ENABLED(EZ_PLATFORM_WINDOWS)
+#  include <Foundation/Basics/Platform/Win/IncludeWindows.h>
+#elif EZ_ENABLED(EZ_PLATFORM_LINUX) || EZ_ENABLED(EZ_PLATFORM_ANDROID)
+#  include <linux/futex.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+namespace
+{
+  // set in ezTaskGroup::m_iNumPins while the group is being reused
+  constexpr ezInt32 ReuseFlag = 0x40000000;
+
+  // how often to check whether the group has finished, before putting the thread to sleep
+  constexpr ezUInt32 NumSpinsBeforeSleep = 256;
+
+  ezTaskGroup::DependentGroup* const ClosedList = reinterpret_cast<ezTaskGroup::DependentGroup*>(static_cast<size_t>(1));
+
+  /// Puts the thread to sleep until the value at \a pAddress is (probably) no longer \a iValue.
+  /// May return spuriously, so the value has to be checked again.
+  void WaitForValueChange(volatile ezInt32* pAddress, ezInt32 iValue)
+  {
+#if EZ_ENABLED(EZ_PLATFORM_WINDOWS)
+    WaitOnAddress(pAddress, &iValue, sizeof(ezInt32), INFINITE);
+#elif EZ_ENABLED(EZ_PLATFORM_LINUX) || EZ_ENABLED(EZ_PLATFORM_ANDROID)
+    syscall(SYS_futex, pAddress, FUTEX_WAIT_PRIVATE, iValue, nullptr, nullptr, 0);
+#else
+    EZ_IGNORE_UNUSED(pAddress);
+    EZ_IGNORE_UNUSED(iValue);
+    ezThreadUtils::YieldTimeSlice();
+#endif
+  }
+
+  /// Wakes up all threads that sleep in WaitForValueChange() on \a pAddress.
+  void WakeAllWaiting(volatile ezInt32* pAddress)
+  {
+#if EZ_ENABLED(EZ_PLATFORM_WINDOWS)
+    WakeByAddressAll(const_cast<ezInt32*>(pAddress));
+#elif EZ_ENABLED(EZ_PLATFORM_LINUX) || EZ_ENABLED(EZ_PLATFORM_ANDROID)
+    syscall(SYS_futex, pAddress, FUTEX_WAKE_PRIVATE, 0x7FFFFFFF, nullptr, nullptr, 0);
+#else
+    EZ_IGNORE_UNUSED(pAddress);
+#endif
+  }
+} // namespace
 
 ezTaskGroup::ezTaskGroup() = default;
 ezTaskGroup::~ezTaskGroup() = default;
 
 void ezTaskGroup::WaitForFinish(ezTaskGroupID group) const
 {
-  if (m_uiGroupCounter != group.m_uiGroupCounter)
-    return;
+  // groups are often finished very shortly after someone starts to wait for them, so try to avoid the expensive sleep
+  for (ezUInt32 i = 0; i < NumSpinsBeforeSleep; ++i)
+  {
+    if (!IsCurrentAndUnfinished(group))
+      return;
 
-  EZ_LOCK(m_CondVarGroupFinished);
+    ezThreadUtils::YieldHardwareThread();
+  }
+
+  // announce that we are going to sleep before checking the counter, MarkAsFinished() does it in the opposite order
+  // that way either we see the new counter value, or the finishing thread sees us and wakes us up
+  ezAtomicUtils::Increment(m_iNumWaiters);
 
-  while (m_uiGroupCounter == group.m_uiGroupCounter)
+  ezInt32 iCounter;
+  while ((iCounter = ezAtomicUtils::Read(m_iGroupCounter)) == static_cast<ezInt32>(group.m_uiGroupCounter))
   {
-    m_CondVarGroupFinished.UnlockWaitForSignalAndLock();
+    WaitForValueChange(const_cast<volatile ezInt32*>(&m_iGroupCounter), iCounter);
   }
+
+  ezAtomicUtils::Decrement(m_iNumWaiters);
 }
 
 void ezTaskGroup::Reuse(ezTaskPriority::Enum priority, ezOnTaskGroupFinishedCallback callback)
 {
   m_bInUse = true;
   m_bStartedByUser = false;
-  m_uiGroupCounter += 2; // even if it wraps around, it will never be zero, thus zero stays an invalid group counter
+  m_iGroupCounter += 2; // even if it wraps around, it will never be zero, thus zero stays an invalid group counter
+  m_pFirstDependent = nullptr;
   m_Tasks.Clear();
   m_DependsOnGroups.Clear();
-  m_OthersDependingOnMe.Clear();
+  m_DependentGroupEntries.Clear();
   m_Priority = priority;
   m_OnFinishedCallback = callback;
+
+  // the group has been acquired through TryAcquireForReuse(), from now on others may register themselves as dependents again
+  ezAtomicUtils::Add(m_iNumPins, -ReuseFlag);
+}
+
+bool ezTaskGroup::TryAcquireForReuse()
+{
+  return ezAtomicUtils::TestAndSet(m_iNumPins, 0, ReuseFlag);
+}
+
+bool ezTaskGroup::AddDependentGroup(ezTaskGroupID group, DependentGroup* pEntry)
+{
+  ezTaskGroup* pGroup = group.m_pTaskGroup;
+
+  // pin the group, so that it cannot be reused while we are looking at it
+  // otherwise we might add ourselves to the list of a later use of the group
+  if ((ezAtomicUtils::Increment(pGroup->m_iNumPins) & ReuseFlag) != 0)
+  {
+    // currently being reused, which means it is finished already
+    ezAtomicUtils::Decrement(pGroup->m_iNumPins);
+    return false;
+  }
+
+  bool bAdded = false;
+
+  if (pGroup->IsCurrentAndUnfinished(group))
+  {
+    while (true)
+    {
+      DependentGroup* pFirst = pGroup->m_pFirstDependent;
+
+      // the group finished in the meantime
+      if (pFirst == ClosedList)
+        break;
+
+      pEntry->m_pNext = pFirst;
+
+      if (ezAtomicUtils::TestAndSet(reinterpret_cast<void**>(&pGroup->m_pFirstDependent), pFirst, pEntry))
+      {
+        bAdded = true;
+        break;
+      }
+    }
+  }
+
+  ezAtomicUtils::Decrement(pGroup->m_iNumPins);
+  return bAdded;
+}
+
+ezTaskGroup::DependentGroup* ezTaskGroup::MarkAsFinished()
+{
+  // close the list, from now on nobody can add itself as a dependent anymore
+  DependentGroup* pFirst = nullptr;
+  do
+  {
+    pFirst = m_pFirstDependent;
+  } while (!ezAtomicUtils::TestAndSet(reinterpret_cast<void**>(&m_pFirstDependent), pFirst, ClosedList));
+
+  // set this task group to be finished, Set() is a full memory barrier before we read the number of waiters
+  ezAtomicUtils::Set(m_iGroupCounter, m_iGroupCounter + 2);
+
+  if (ezAtomicUtils::Read(m_iNumWaiters) > 0)
+  {
+    WakeAllWaiting(&m_iGroupCounter);
+  }
+
+  return pFirst;
 }
 
 #if EZ_ENABLED(EZ_COMPILE_FOR_DEBUG)
@@ -39,7 +165,7 @@ void ezTaskGroup::DebugCheckTaskGroup(ezTaskGroupID groupID, ezMutex& mutex)
   const ezTaskGroup* pGroup = groupID.m_pTaskGroup;
 
   EZ_ASSERT_DEV(pGroup != nullptr, "TaskGroupID is invalid.");
-  EZ_ASSERT_DEV(pGroup->m_uiGroupCounter == groupID.m_uiGroupCounter, "The given TaskGroupID is not valid anymore.");
+  EZ_ASSERT_DEV(pGroup->IsCurrentAndUnfinished(groupID), "The given TaskGroupID is not valid anymore.");
   EZ_ASSERT_DEV(!pGroup->m_bStartedByUser, "The given TaskGroupID is already started, you cannot modify it anymore.");
   EZ_ASSERT_DEV(pGroup->m_iNumActiveDependencies == 0, "Invalid active dependenices");
 }
@@ -47,4 +173,3 @@ void ezTaskGroup::DebugCheckTaskGroup(ezTaskGroupID groupID, ezMutex& mutex)
 
 
 EZ_STATICLINK_FILE(Foundation, Foundation_Threading_Implementation_TaskGroup);
-
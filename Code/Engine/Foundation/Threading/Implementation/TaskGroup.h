@@ -1,8 +1,8 @@
 #pragma once
 
 #include <Foundation/Strings/String.h>
-#include <Foundation/Threading/ConditionVariable.h>
 #include <Foundation/Threading/Implementation/TaskSystemDeclarations.h>
+#include <Foundation/Threading/Mutex.h>
 
 /// \internal Represents the state of a group of tasks that can be waited on
 class ezTaskGroup
@@ -13,6 +13,15 @@ public:
   ezTaskGroup();
   ~ezTaskGroup();
 
+  /// \brief An entry in the lock-free list of groups that wait for another group to finish.
+  ///
+  /// The entries are stored in the waiting group (one per dependency), so they stay valid until the dependency has released them.
+  struct DependentGroup
+  {
+    ezTaskGroup* m_pDependent = nullptr;
+    DependentGroup* m_pNext = nullptr;
+  };
+
 private:
   friend class ezTaskSystem;
 
@@ -24,18 +33,49 @@ private:
 
   /// \brief Puts the calling thread to sleep until this group is fully finished.
   void WaitForFinish(ezTaskGroupID group) const;
+
+  /// \brief Prepares the group for its next use. The group must have been acquired through TryAcquireForReuse() before.
   void Reuse(ezTaskPriority::Enum priority, ezOnTaskGroupFinishedCallback callback);
 
+  /// \brief Returns whether \a group refers to the current use of this group and it has not finished yet.
+  EZ_ALWAYS_INLINE bool IsCurrentAndUnfinished(ezTaskGroupID group) const { return static_cast<ezUInt32>(m_iGroupCounter) == group.m_uiGroupCounter; }
+
+  /// \brief Tries to reserve this unused group for reuse. Fails if some thread is currently registering itself as a dependent of it.
+  bool TryAcquireForReuse();
+
+  /// \brief Adds \a pEntry to the list of groups to notify once \a group has finished. Returns false, if \a group has already finished.
+  static bool AddDependentGroup(ezTaskGroupID group, DependentGroup* pEntry);
+
+  /// \brief Marks the group as finished, wakes up all waiting threads and returns the list of groups that depended on it.
+  ///
+  /// Must only be called once per use of the group, by the thread that finished its last task.
+  DependentGroup* MarkAsFinished();
+
   bool m_bInUse = true;
   bool m_bStartedByUser = false;
   ezUInt16 m_uiTaskGroupIndex = 0xFFFF; // only there as a debugging aid
-  ezUInt32 m_uiGroupCounter = 1;
+
+  // odd while the group is in use, incremented by 2 when the group is finished and again when it is reused
+  // waiting threads sleep on this value (see WaitForFinish())
+  volatile ezInt32 m_iGroupCounter = 1;
+
+  // the number of threads that are currently inside AddDependentGroup() for this group, plus 'ReuseFlag' while the group is being reused
+  volatile ezInt32 m_iNumPins = 0;
+
+  // the number of threads that are sleeping in WaitForFinish()
+  mutable volatile ezInt32 m_iNumWaiters = 0;
+
+  // lock-free stack of the groups that need to be notified when this group has finished, set to 'ClosedList' once finished
+  DependentGroup* m_pFirstDependent = nullptr;
+
   ezHybridArray<ezTask*, 16> m_Tasks;
   ezHybridArray<ezTaskGroupID, 4> m_DependsOnGroups;
-  ezHybridArray<ezTaskGroupID, 8> m_OthersDependingOnMe;
+  ezHybridArray<DependentGroup, 4> m_DependentGroupEntries; // one entry per m_DependsOnGroups, allocated when the group is started
   ezAtomicInteger32 m_iNumActiveDependencies;
   ezAtomicInteger32 m_iNumRemainingTasks;
   ezOnTaskGroupFinishedCallback m_OnFinishedCallback;
   ezTaskPriority::Enum m_Priority = ezTaskPriority::ThisFrame;
-  mutable ezConditionVariable m_CondVarGroupFinished;
+
+  // protects m_Tasks against concurrent scheduling and canceling of tasks, when s_TaskSystemMutex is not held
+  mutable ezMutex m_TaskListMutex;
 };
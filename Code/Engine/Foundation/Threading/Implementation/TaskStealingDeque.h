@@ -0,0 +1,98 @@
+#pragma once
+
+#include <Foundation/Threading/AtomicInteger.h>
+#include <Foundation/Threading/TaskSystem.h>
+
+/// \internal Fixed size, lock-free work-stealing deque (Chase-Lev) for the tasks of one worker thread.
+///
+/// Only the owning thread may call PushBottom() and PopBottom(), which it uses like a stack (LIFO) to keep the data
+/// of recently scheduled tasks in the cache. All other threads may call Steal() to take the oldest task (FIFO) from the top.
+/// The deque never grows, once it is full PushBottom() fails and the caller has to put the task somewhere else.
+class ezTaskStealingDeque
+{
+  EZ_DISALLOW_COPY_AND_ASSIGN(ezTaskStealingDeque);
+
+public:
+  enum
+  {
+    Capacity = 256, ///< Must be a power of two
+  };
+
+  ezTaskStealingDeque() = default;
+
+  /// \brief Adds a task at the bottom. Returns false if the deque is full. May only be called by the owning thread.
+  bool PushBottom(const ezTaskSystem::TaskData& task)
+  {
+    const ezInt64 iBottom = m_iBottom;
+    const ezInt64 iTop = m_iTop;
+
+    if (iBottom - iTop >= Capacity)
+      return false;
+
+    m_Tasks[iBottom & (Capacity - 1)] = task;
+
+    // Set() is a full barrier, the task data is visible to other threads before the new bottom
+    m_iBottom.Set(iBottom + 1);
+    return true;
+  }
+
+  /// \brief Removes the most recently pushed task. Returns false if the deque is empty. May only be called by the owning thread.
+  bool PopBottom(ezTaskSystem::TaskData& out_task)
+  {
+    const ezInt64 iBottom = m_iBottom - 1;
+
+    // reserve the bottom element before looking at the top, thieves will not take it anymore unless it is the last one
+    m_iBottom.Set(iBottom);
+
+    const ezInt64 iTop = m_iTop;
+
+    if (iTop > iBottom)
+    {
+      // was empty
+      m_iBottom.Set(iBottom + 1);
+      return false;
+    }
+
+    out_task = m_Tasks[iBottom & (Capacity - 1)];
+
+    if (iTop == iBottom)
+    {
+      // this is the last element, race against the thieves for it
+      const bool bWon = m_iTop.TestAndSet(iTop, iTop + 1);
+      m_iBottom.Set(iTop + 1);
+      return bWon;
+    }
+
+    return true;
+  }
+
+  /// \brief Removes the oldest task. Returns false if the deque is empty or another thread was faster. May be called by any thread.
+  bool Steal(ezTaskSystem::TaskData& out_task)
+  {
+    const ezInt64 iTop = m_iTop;
+    const ezInt64 iBottom = m_iBottom;
+
+    if (iTop >= iBottom)
+      return false;
+
+    // the owner can only overwrite this slot after the top has moved past it,
+    // in which case the compare-and-swap below fails and the (potentially torn) copy is discarded
+    ezTaskSystem::TaskData task = m_Tasks[iTop & (Capacity - 1)];
+
+    if (!m_iTop.TestAndSet(iTop, iTop + 1))
+      return false;
+
+    out_task = task;
+    return true;
+  }
+
+  /// \brief Returns whether the deque currently contains no tasks. The result may already be outdated when the function returns.
+  bool IsEmpty() const { return m_iTop >= m_iBottom; }
+
+private:
+  ezAtomicInteger64 m_iTop;
+  ezUInt8 m_Padding[64 - sizeof(ezAtomicInteger64)]; // keep the stealing threads off the owner's cache line
+  ezAtomicInteger64 m_iBottom;
+
+  ezTaskSystem::TaskData m_Tasks[Capacity];
+};
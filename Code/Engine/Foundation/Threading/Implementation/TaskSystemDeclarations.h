@@ -80,6 +80,18 @@ struct ezOnTaskRunning
   };
 };
 
+/// \brief Enum that describes how the ezTaskSystem distributes scheduled tasks onto its worker threads.
+struct ezTaskSchedulingMode
+{
+  enum Enum : ezUInt8
+  {
+    GlobalQueue,  ///< All tasks are put into one shared queue per priority, which is protected by a single mutex.
+    WorkStealing, ///< 'This frame' tasks that are started from a short task worker thread are put into that thread's lock-free queue.
+                  ///< Idle threads steal tasks from the queues of other threads. Reduces contention when many small tasks are used.
+    Default = GlobalQueue
+  };
+};
+
 /// \internal Enum that lists the different task worker thread types.
 struct ezWorkerThreadType
 {
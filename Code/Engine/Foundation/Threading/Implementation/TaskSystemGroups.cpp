@@ -18,7 +18,8 @@ ezTaskGroupID ezTaskSystem::CreateTaskGroup(ezTaskPriority::Enum Priority, ezOnT
   // this search could be speed up with a stack of free groups
   for (; i < s_State->m_TaskGroups.GetCount(); ++i)
   {
-    if (!s_State->m_TaskGroups[i].m_bInUse)
+    // groups that are still pinned by a thread that tries to add a dependency to their previous use are skipped
+    if (!s_State->m_TaskGroups[i].m_bInUse && s_State->m_TaskGroups[i].TryAcquireForReuse())
     {
       goto foundtaskgroup;
     }
@@ -27,6 +28,7 @@ ezTaskGroupID ezTaskSystem::CreateTaskGroup(ezTaskPriority::Enum Priority, ezOnT
   // no free group found, create a new one
   s_State->m_TaskGroups.ExpandAndGetRef();
   s_State->m_TaskGroups[i].m_uiTaskGroupIndex = static_cast<ezUInt16>(i);
+  s_State->m_TaskGroups[i].TryAcquireForReuse();
 
 foundtaskgroup:
 
@@ -34,7 +36,7 @@ foundtaskgroup:
 
   ezTaskGroupID id;
   id.m_pTaskGroup = &s_State->m_TaskGroups[i];
-  id.m_uiGroupCounter = s_State->m_TaskGroups[i].m_uiGroupCounter;
+  id.m_uiGroupCounter = static_cast<ezUInt32>(s_State->m_TaskGroups[i].m_iGroupCounter);
   return id;
 }
 
@@ -81,46 +83,40 @@ void ezTaskSystem::StartTaskGroup(ezTaskGroupID groupID)
 
   ezTaskGroup::DebugCheckTaskGroup(groupID, s_TaskSystemMutex);
 
-  ezInt32 iActiveDependencies = 0;
+  ezTaskGroup& tg = *groupID.m_pTaskGroup;
 
-  {
-    EZ_LOCK(s_TaskSystemMutex);
+  tg.m_bStartedByUser = true;
 
-    ezTaskGroup& tg = *groupID.m_pTaskGroup;
+  const ezUInt32 uiNumDependencies = tg.m_DependsOnGroups.GetCount();
 
-    tg.m_bStartedByUser = true;
-
-    for (ezUInt32 i = 0; i < tg.m_DependsOnGroups.GetCount(); ++i)
-    {
-      if (!IsTaskGroupFinished(tg.m_DependsOnGroups[i]))
-      {
-        ezTaskGroup& Dependency = *tg.m_DependsOnGroups[i].m_pTaskGroup;
+  // the entries must not be reallocated anymore, once the other groups may reference them
+  tg.m_DependentGroupEntries.SetCount(uiNumDependencies);
 
-        // add this task group to the list of dependencies, such that when that group finishes, this task group can get woken up
-        Dependency.m_OthersDependingOnMe.PushBack(groupID);
+  // the additional dependency is only released at the end of this function,
+  // so that the group cannot get scheduled by a finishing dependency while we are still registering at the others
+  tg.m_iNumActiveDependencies = static_cast<ezInt32>(uiNumDependencies) + 1;
 
-        // count how many other groups need to finish before this task group can be executed
-        ++iActiveDependencies;
-      }
-    }
+  for (ezUInt32 i = 0; i < uiNumDependencies; ++i)
+  {
+    ezTaskGroup::DependentGroup& entry = tg.m_DependentGroupEntries[i];
+    entry.m_pDependent = &tg;
 
-    if (iActiveDependencies != 0)
+    // add this task group to the list of dependents, such that when that group finishes, this task group can get woken up
+    if (!ezTaskGroup::AddDependentGroup(tg.m_DependsOnGroups[i], &entry))
     {
-      // atomic integers are quite slow, so do not use them in the loop, where they are not yet needed
-      tg.m_iNumActiveDependencies = iActiveDependencies;
+      // that group has finished already
+      tg.m_iNumActiveDependencies.Decrement();
     }
   }
 
-  if (iActiveDependencies == 0)
+  if (tg.m_iNumActiveDependencies.Decrement() == 0)
   {
-    ScheduleGroupTasks(groupID.m_pTaskGroup, false);
+    ScheduleGroupTasks(&tg, false);
   }
 }
 
 void ezTaskSystem::StartTaskGroupBatch(ezArrayPtr<const ezTaskGroupID> batch)
 {
-  EZ_LOCK(s_TaskSystemMutex);
-
   for (const ezTaskGroupID& group : batch)
   {
     StartTaskGroup(group);
@@ -130,7 +126,7 @@ void ezTaskSystem::StartTaskGroupBatch(ezArrayPtr<const ezTaskGroupID> batch)
 bool ezTaskSystem::IsTaskGroupFinished(ezTaskGroupID Group)
 {
   // if the counters differ, the task group has been reused since the GroupID was created, so that group has finished
-  return (Group.m_pTaskGroup == nullptr) || (Group.m_pTaskGroup->m_uiGroupCounter != Group.m_uiGroupCounter);
+  return (Group.m_pTaskGroup == nullptr) || !Group.m_pTaskGroup->IsCurrentAndUnfinished(Group);
 }
 
 void ezTaskSystem::ScheduleGroupTasks(ezTaskGroup* pGroup, bool bHighPriority)
@@ -144,6 +140,9 @@ void ezTaskSystem::ScheduleGroupTasks(ezTaskGroup* pGroup, bool bHighPriority)
     return;
   }
 
+  if (s_State->m_SchedulingMode == ezTaskSchedulingMode::WorkStealing && ScheduleGroupTasksLocally(pGroup))
+    return;
+
   ezInt32 iRemainingTasks = 0;
 
   // add all the tasks to the task list, so that they will be processed
@@ -181,6 +180,8 @@ void ezTaskSystem::ScheduleGroupTasks(ezTaskGroup* pGroup, bool bHighPriority)
       }
     }
 
+    s_State->m_iNumQueuedTasks[pGroup->m_Priority].Add(iRemainingTasks);
+
     // send the proper thread signal, to make sure one of the correct worker threads is awake
     switch (pGroup->m_Priority)
     {
@@ -226,6 +227,74 @@ void ezTaskSystem::ScheduleGroupTasks(ezTaskGroup* pGroup, bool bHighPriority)
   }
 }
 
+bool ezTaskSystem::ScheduleGroupTasksLocally(ezTaskGroup* pGroup)
+{
+  // only short task workers own local queues and those only take 'this frame' tasks,
+  // everything else still needs to go through the global queues, e.g. to be re-prioritized at the end of the frame
+  ezTaskWorkerThread* pWorker = tl_TaskWorkerInfo.m_pWorkerThread;
+
+  if (pWorker == nullptr || tl_TaskWorkerInfo.m_WorkerType != ezWorkerThreadType::ShortTasks || pGroup->m_Priority > ezTaskPriority::LateThisFrame)
+    return false;
+
+  ezTaskStealingDeque& deque = pWorker->m_LocalTasks[pGroup->m_Priority];
+
+  ezHybridArray<TaskData, 16> overflow;
+  ezInt32 iRemainingTasks = 0;
+
+  {
+    // synchronizes with ezTaskSystem::CancelTask(), which may remove tasks from groups that are not yet scheduled
+    EZ_LOCK(pGroup->m_TaskListMutex);
+
+    for (auto pTask : pGroup->m_Tasks)
+    {
+      iRemainingTasks += ezMath::Max(1u, pTask->m_uiMultiplicity);
+      pTask->m_iRemainingRuns = ezMath::Max(1u, pTask->m_uiMultiplicity);
+    }
+
+    pGroup->m_iNumRemainingTasks = iRemainingTasks;
+
+    for (ezUInt32 task = 0; task < pGroup->m_Tasks.GetCount(); ++task)
+    {
+      auto& pTask = pGroup->m_Tasks[task];
+
+      for (ezUInt32 mult = 0; mult < ezMath::Max(1u, pTask->m_uiMultiplicity); ++mult)
+      {
+        TaskData td;
+        td.m_pBelongsToGroup = pGroup;
+        td.m_pTask = pTask;
+        td.m_pTask->m_bTaskIsScheduled = true;
+        td.m_uiInvocation = mult;
+
+        // the local queue is executed in LIFO order by this thread, so newly scheduled tasks always have 'high priority' here
+        if (!deque.PushBottom(td))
+        {
+          overflow.PushBack(td);
+        }
+      }
+    }
+  }
+
+  if (!overflow.IsEmpty())
+  {
+    EZ_LOCK(s_TaskSystemMutex);
+
+    for (const TaskData& td : overflow)
+    {
+      s_State->m_Tasks[pGroup->m_Priority].PushBack(td);
+    }
+
+    s_State->m_iNumQueuedTasks[pGroup->m_Priority].Add(overflow.GetCount());
+  }
+
+  // this thread will work on the tasks itself once it is done with its current task, other threads may help out by stealing
+  if (iRemainingTasks > 1)
+  {
+    WakeUpThreads(ezWorkerThreadType::ShortTasks, iRemainingTasks - 1);
+  }
+
+  return true;
+}
+
 void ezTaskSystem::DependencyHasFinished(ezTaskGroup* pGroup)
 {
   // remove one dependency from the group
@@ -31,4 +31,11 @@ private:
 
   // The lists of all scheduled tasks, for each priority.
   ezList<ezTaskSystem::TaskData> m_Tasks[ezTaskPriority::ENUM_COUNT];
+
+  // The number of tasks in each of the lists above. Allows to skip taking the lock when there is nothing to get.
+  ezAtomicInteger32 m_iNumQueuedTasks[ezTaskPriority::ENUM_COUNT];
+
+  // Whether tasks are put into the worker-local queues (see ezTaskSchedulingMode)
+  // Stores an ezTaskSchedulingMode::Enum, it is atomic since it can be switched while worker threads read it.
+  ezAtomicInteger32 m_SchedulingMode = ezTaskSchedulingMode::Default;
 };
@@ -38,27 +38,17 @@ void ezTaskSystem::TaskHasFinished(ezTask* pTask, ezTaskGroup* pGroup)
   {
     // If this was the last task that had to be finished from this group, make sure all dependent groups are started
 
-    ezUInt32 groupCounter = 0;
-    {
-      // see ezTaskGroup::WaitForFinish() for why we need this lock here
-      // without it, there would be a race condition between these two places, reading and writing m_uiGroupCounter and waiting/signaling m_CondVarGroupFinished
-      EZ_LOCK(pGroup->m_CondVarGroupFinished);
-
-      groupCounter = pGroup->m_uiGroupCounter;
-      // set this task group to be finished such that no one tries to append further dependencies
-      pGroup->m_uiGroupCounter += 2;
-    }
+    const ezUInt32 groupCounter = static_cast<ezUInt32>(pGroup->m_iGroupCounter);
 
-    // wake up all threads that are waiting for this group
-    pGroup->m_CondVarGroupFinished.SignalAll();
+    // set this task group to be finished such that no one tries to append further dependencies, and wake up all threads that are waiting for it
+    ezTaskGroup::DependentGroup* pDependent = pGroup->MarkAsFinished();
 
+    while (pDependent != nullptr)
     {
-      EZ_LOCK(s_TaskSystemMutex);
-
-      for (ezUInt32 dep = 0; dep < pGroup->m_OthersDependingOnMe.GetCount(); ++dep)
-      {
-        DependencyHasFinished(pGroup->m_OthersDependingOnMe[dep].m_pTaskGroup);
-      }
+      // the entry belongs to the dependent group, which may get started, finished and reused as soon as its dependency is released
+      ezTaskGroup::DependentGroup* pNext = pDependent->m_pNext;
+      DependencyHasFinished(pDependent->m_pDependent);
+      pDependent = pNext;
     }
 
     if (pGroup->m_OnFinishedCallback.IsValid())
@@ -74,27 +64,145 @@ void ezTaskSystem::TaskHasFinished(ezTask* pTask, ezTaskGroup* pGroup)
   }
 }
 
-ezTaskSystem::TaskData ezTaskSystem::GetNextTask(ezTaskPriority::Enum FirstPriority, ezTaskPriority::Enum LastPriority, bool bOnlyTasksThatNeverWait, const ezTaskGroupID& WaitingForGroup, ezAtomicInteger32* pWorkerState)
+bool ezTaskSystem::IsTaskAllowedToExecute(const TaskData& task, bool bOnlyTasksThatNeverWait, const ezTaskGroupID& WaitingForGroup)
 {
-  // this is the central function that selects tasks for the worker threads to work on
+  return !bOnlyTasksThatNeverWait || (task.m_pTask->m_NestingMode == ezTaskNesting::Never) || task.m_pBelongsToGroup == WaitingForGroup.m_pTaskGroup;
+}
 
-  EZ_ASSERT_DEV(FirstPriority >= ezTaskPriority::EarlyThisFrame && LastPriority < ezTaskPriority::ENUM_COUNT, "Priority Range is invalid: {0} to {1}", FirstPriority, LastPriority);
+bool ezTaskSystem::TakeTaskFromGlobalQueue(ezUInt32 uiPriority, bool bOnlyTasksThatNeverWait, const ezTaskGroupID& WaitingForGroup, TaskData& out_Task)
+{
+  for (auto it = s_State->m_Tasks[uiPriority].GetIterator(); it.IsValid(); ++it)
+  {
+    if (IsTaskAllowedToExecute(*it, bOnlyTasksThatNeverWait, WaitingForGroup))
+    {
+      out_Task = *it;
+
+      s_State->m_Tasks[uiPriority].Remove(it);
+      s_State->m_iNumQueuedTasks[uiPriority].Decrement();
+      return true;
+    }
+  }
 
+  return false;
+}
+
+void ezTaskSystem::MoveTaskToGlobalQueue(const TaskData& task, ezUInt32 uiPriority)
+{
   EZ_LOCK(s_TaskSystemMutex);
 
-  // go through all the task lists that this thread is willing to work on
+  // the task was already scheduled, so put it at the front
+  s_State->m_Tasks[uiPriority].PushFront(task);
+  s_State->m_iNumQueuedTasks[uiPriority].Increment();
+
+  WakeUpThreads(ezWorkerThreadType::ShortTasks, 1);
+}
+
+bool ezTaskSystem::StealTask(ezUInt32 uiPriority, bool bOnlyTasksThatNeverWait, const ezTaskGroupID& WaitingForGroup, TaskData& out_Task)
+{
+  const ezUInt32 uiNumWorkers = s_ThreadState->m_iAllocatedWorkers[ezWorkerThreadType::ShortTasks];
+  const ezTaskWorkerThread* pOwnWorker = tl_TaskWorkerInfo.m_pWorkerThread;
+
+  // start with the next worker after this one, so that not all threads try to steal from the same one
+  const ezUInt32 uiStartIdx = static_cast<ezUInt32>(tl_TaskWorkerInfo.m_iWorkerIndex + 1);
+
+  for (ezUInt32 i = 0; i < uiNumWorkers; ++i)
+  {
+    ezTaskWorkerThread* pVictim = s_ThreadState->m_Workers[ezWorkerThreadType::ShortTasks][(uiStartIdx + i) % uiNumWorkers];
+
+    if (pVictim == pOwnWorker)
+      continue;
+
+    ezTaskStealingDeque& deque = pVictim->m_LocalTasks[uiPriority];
+
+    TaskData td;
+    while (!deque.IsEmpty())
+    {
+      if (!deque.Steal(td))
+        continue; // some other thread was faster, try again
+
+      if (IsTaskAllowedToExecute(td, bOnlyTasksThatNeverWait, WaitingForGroup))
+      {
+        out_Task = td;
+        return true;
+      }
+
+      // this thread is waiting for a group and must not execute tasks that may wait themselves
+      // pass the task on to someone else
+      MoveTaskToGlobalQueue(td, uiPriority);
+      break;
+    }
+  }
+
+  return false;
+}
+
+bool ezTaskSystem::GetNextTaskLockFree(ezTaskPriority::Enum FirstPriority, ezTaskPriority::Enum LastPriority, bool bOnlyTasksThatNeverWait, const ezTaskGroupID& WaitingForGroup, TaskData& out_Task)
+{
+  ezTaskWorkerThread* pOwnWorker = tl_TaskWorkerInfo.m_pWorkerThread;
+  const bool bWorkStealing = s_State->m_SchedulingMode == ezTaskSchedulingMode::WorkStealing;
+
   for (ezUInt32 prio = FirstPriority; prio <= (ezUInt32)LastPriority; ++prio)
   {
-    for (auto it = s_State->m_Tasks[prio].GetIterator(); it.IsValid(); ++it)
+    const bool bLocalPriority = prio <= ezTaskPriority::LateThisFrame;
+
+    // tasks that were started by this thread are the most likely ones to still have their data in the cache
+    // this is also done when the mode has been switched back to the global queue, to make sure that no task is left behind
+    if (bLocalPriority && pOwnWorker != nullptr)
     {
-      if (!bOnlyTasksThatNeverWait || (it->m_pTask->m_NestingMode == ezTaskNesting::Never) || it->m_pBelongsToGroup == WaitingForGroup.m_pTaskGroup)
+      ezTaskStealingDeque& deque = pOwnWorker->m_LocalTasks[prio];
+
+      TaskData td;
+      while (deque.PopBottom(td))
       {
-        TaskData td = *it;
+        if (IsTaskAllowedToExecute(td, bOnlyTasksThatNeverWait, WaitingForGroup))
+        {
+          out_Task = td;
+          return true;
+        }
 
-        s_State->m_Tasks[prio].Remove(it);
-        return td;
+        MoveTaskToGlobalQueue(td, prio);
       }
     }
+
+    if (!bWorkStealing)
+      continue;
+
+    // only take the lock, if there is a chance to find something
+    if (s_State->m_iNumQueuedTasks[prio] > 0)
+    {
+      EZ_LOCK(s_TaskSystemMutex);
+
+      if (TakeTaskFromGlobalQueue(prio, bOnlyTasksThatNeverWait, WaitingForGroup, out_Task))
+        return true;
+    }
+
+    if (bLocalPriority && StealTask(prio, bOnlyTasksThatNeverWait, WaitingForGroup, out_Task))
+      return true;
+  }
+
+  return false;
+}
+
+ezTaskSystem::TaskData ezTaskSystem::GetNextTask(ezTaskPriority::Enum FirstPriority, ezTaskPriority::Enum LastPriority, bool bOnlyTasksThatNeverWait, const ezTaskGroupID& WaitingForGroup, ezAtomicInteger32* pWorkerState)
+{
+  // this is the central function that selects tasks for the worker threads to work on
+
+  EZ_ASSERT_DEV(FirstPriority >= ezTaskPriority::EarlyThisFrame && LastPriority < ezTaskPriority::ENUM_COUNT, "Priority Range is invalid: {0} to {1}", FirstPriority, LastPriority);
+
+  {
+    TaskData td;
+    if (GetNextTaskLockFree(FirstPriority, LastPriority, bOnlyTasksThatNeverWait, WaitingForGroup, td))
+      return td;
+  }
+
+  EZ_LOCK(s_TaskSystemMutex);
+
+  // go through all the task lists that this thread is willing to work on
+  for (ezUInt32 prio = FirstPriority; prio <= (ezUInt32)LastPriority; ++prio)
+  {
+    TaskData td;
+    if (TakeTaskFromGlobalQueue(prio, bOnlyTasksThatNeverWait, WaitingForGroup, td))
+      return td;
   }
 
   if (pWorkerState)
@@ -150,11 +258,16 @@ ezResult ezTaskSystem::CancelTask(ezTask* pTask, ezOnTaskRunning::Enum OnTaskRun
     EZ_LOCK(s_TaskSystemMutex);
 
     // if the task is still in the queue of its group, it had not yet been scheduled
-    if (!pTask->m_bTaskIsScheduled && pTask->m_BelongsToGroup.m_pTaskGroup->m_Tasks.RemoveAndSwap(pTask))
     {
-      // we set the task to finished, even though it was not executed
-      pTask->m_iRemainingRuns = 0;
-      return EZ_SUCCESS;
+      // groups get started without holding s_TaskSystemMutex, see ezTaskSystem::StartTaskGroup() and ezTaskSystem::ScheduleGroupTasksLocally()
+      EZ_LOCK(pTask->m_BelongsToGroup.m_pTaskGroup->m_TaskListMutex);
+
+      if (!pTask->m_bTaskIsScheduled && pTask->m_BelongsToGroup.m_pTaskGroup->m_Tasks.RemoveAndSwap(pTask))
+      {
+        // we set the task to finished, even though it was not executed
+        pTask->m_iRemainingRuns = 0;
+        return EZ_SUCCESS;
+      }
     }
 
     // check if the task has already been scheduled for execution
@@ -168,13 +281,16 @@ ezResult ezTaskSystem::CancelTask(ezTask* pTask, ezOnTaskRunning::Enum OnTaskRun
         {
           if (it->m_pTask == pTask)
           {
+            ezTaskGroup* pGroup = it->m_pBelongsToGroup;
+
             s_State->m_Tasks[i].Remove(it);
+            s_State->m_iNumQueuedTasks[i].Decrement();
 
             // we set the task to finished, even though it was not executed
             pTask->m_iRemainingRuns = 0;
 
             // tell the system that one task of that group is 'finished', to ensure its dependencies will get scheduled
-            TaskHasFinished(it->m_pTask, it->m_pBelongsToGroup);
+            TaskHasFinished(pTask, pGroup);
             return EZ_SUCCESS;
           }
 
@@ -260,6 +376,13 @@ void ezTaskSystem::ReprioritizeFrameTasks()
     // remove the tasks from their current queue
     s_State->m_Tasks[i].Clear();
   }
+
+  for (ezUInt32 i = 0; i < ezTaskPriority::ENUM_COUNT; ++i)
+  {
+    s_State->m_iNumQueuedTasks[i] = s_State->m_Tasks[i].GetCount();
+  }
+
+  // the worker-local queues only contain 'this frame' tasks, which are all executed before any 'next frame' tasks, so they need no adjustment
 }
 
 void ezTaskSystem::ExecuteSomeFrameTasks(ezUInt32 uiSomeFrameTasks, ezTime smoothFrameTime)
@@ -386,6 +509,9 @@ void ezTaskSystem::FinishFrameTasks()
     {
       s_LastFrameUpdate = tNow;
 
+      double fAvgUtilization[ezWorkerThreadType::ENUM_COUNT] = {};
+      ezUInt32 uiTasksExecuted = 0;
+
       for (ezUInt32 type = 0; type < ezWorkerThreadType::ENUM_COUNT; ++type)
       {
         const ezUInt32 uiNumWorkers = s_ThreadState->m_iAllocatedWorkers[type];
@@ -393,8 +519,22 @@ void ezTaskSystem::FinishFrameTasks()
         for (ezUInt32 t = 0; t < uiNumWorkers; ++t)
         {
           s_ThreadState->m_Workers[type][t]->UpdateThreadUtilization(tDiff);
+
+          ezUInt32 uiNumTasks = 0;
+          fAvgUtilization[type] += s_ThreadState->m_Workers[type][t]->GetThreadUtilization(&uiNumTasks);
+          uiTasksExecuted += uiNumTasks;
+        }
+
+        if (uiNumWorkers > 0)
+        {
+          fAvgUtilization[type] /= uiNumWorkers;
         }
       }
+
+      EZ_PROFILE_COUNTER("Task System/Short Tasks Utilization", fAvgUtilization[ezWorkerThreadType::ShortTasks]);
+      EZ_PROFILE_COUNTER("Task System/Long Tasks Utilization", fAvgUtilization[ezWorkerThreadType::LongTasks]);
+      EZ_PROFILE_COUNTER("Task System/File Access Utilization", fAvgUtilization[ezWorkerThreadType::FileAccess]);
+      EZ_PROFILE_COUNTER("Task System/Tasks Executed", uiTasksExecuted);
     }
   }
 }
@@ -93,6 +93,10 @@ void ezTaskSystem::StopWorkerThreads()
     for (ezUInt32 i = 0; i < uiNumWorkers; ++i)
     {
       s_ThreadState->m_Workers[type][i]->Join();
+
+      // the tasks that were still queued on this thread must not get lost
+      MoveLocalTasksToGlobalQueue(s_ThreadState->m_Workers[type][i]);
+
       EZ_DEFAULT_DELETE(s_ThreadState->m_Workers[type][i]);
     }
 
@@ -180,6 +184,63 @@ ezWorkerThreadType::Enum ezTaskSystem::GetCurrentThreadWorkerType()
   return tl_TaskWorkerInfo.m_WorkerType;
 }
 
+void ezTaskSystem::SetTaskSchedulingMode(ezTaskSchedulingMode::Enum mode)
+{
+  if (s_State->m_SchedulingMode.Set(mode) == mode)
+    return;
+
+  if (mode == ezTaskSchedulingMode::GlobalQueue)
+  {
+    // other threads do not look into the local queues anymore, so hand over everything that is still queued there
+    // the owning threads still check their own queues, in case they have added something in the meantime
+    const ezUInt32 uiNumWorkers = s_ThreadState->m_iAllocatedWorkers[ezWorkerThreadType::ShortTasks];
+    ezUInt32 uiNumMoved = 0;
+
+    for (ezUInt32 i = 0; i < uiNumWorkers; ++i)
+    {
+      uiNumMoved += MoveLocalTasksToGlobalQueue(s_ThreadState->m_Workers[ezWorkerThreadType::ShortTasks][i]);
+    }
+
+    if (uiNumMoved > 0)
+    {
+      WakeUpThreads(ezWorkerThreadType::ShortTasks, uiNumMoved);
+    }
+  }
+}
+
+ezTaskSchedulingMode::Enum ezTaskSystem::GetTaskSchedulingMode()
+{
+  return static_cast<ezTaskSchedulingMode::Enum>(static_cast<ezInt32>(s_State->m_SchedulingMode));
+}
+
+ezUInt32 ezTaskSystem::MoveLocalTasksToGlobalQueue(ezTaskWorkerThread* pWorker)
+{
+  ezUInt32 uiNumMoved = 0;
+
+  for (ezUInt32 prio = 0; prio < EZ_ARRAY_SIZE(pWorker->m_LocalTasks); ++prio)
+  {
+    ezTaskStealingDeque& deque = pWorker->m_LocalTasks[prio];
+
+    if (deque.IsEmpty())
+      continue;
+
+    EZ_LOCK(s_TaskSystemMutex);
+
+    TaskData td;
+    while (!deque.IsEmpty())
+    {
+      if (deque.Steal(td))
+      {
+        s_State->m_Tasks[prio].PushBack(td);
+        s_State->m_iNumQueuedTasks[prio].Increment();
+        ++uiNumMoved;
+      }
+    }
+  }
+
+  return uiNumMoved;
+}
+
 double ezTaskSystem::GetThreadUtilization(ezWorkerThreadType::Enum Type, ezUInt32 uiThreadIndex, ezUInt32* pNumTasksExecuted /*= nullptr*/)
 {
   return s_ThreadState->m_Workers[Type][uiThreadIndex]->GetThreadUtilization(pNumTasksExecuted);
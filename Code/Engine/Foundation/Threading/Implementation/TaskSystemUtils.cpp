@@ -120,7 +120,7 @@ void ezTaskSystem::WriteStateSnapshotToDGML(ezDGMLGraph& graph)
       ezDGMLGraph::NodeId otherNodeId;
 
       // filter out already fulfilled dependencies
-      if (dependsOn.m_pTaskGroup->m_uiGroupCounter != dependsOn.m_uiGroupCounter)
+      if (!dependsOn.m_pTaskGroup->IsCurrentAndUnfinished(dependsOn))
         continue;
 
       // filter out already fulfilled dependencies
@@ -47,6 +47,7 @@ ezUInt32 ezTaskWorkerThread::Run()
   tl_TaskWorkerInfo.m_WorkerType = m_WorkerType;
   tl_TaskWorkerInfo.m_iWorkerIndex = m_uiWorkerThreadNumber;
   tl_TaskWorkerInfo.m_pWorkerState = &m_WorkerState;
+  tl_TaskWorkerInfo.m_pWorkerThread = this;
 
   const bool bIsReserve = m_uiWorkerThreadNumber >= ezTaskSystem::s_ThreadState->m_uiMaxWorkersToUse[m_WorkerType];
 
@@ -74,6 +75,9 @@ ezUInt32 ezTaskWorkerThread::Run()
 
       if (bIsReserve)
       {
+        // nobody would pick up the tasks in the local queues while this thread sleeps, unless they get stolen
+        const ezUInt32 uiNumHandedOver = ezTaskSystem::MoveLocalTasksToGlobalQueue(this);
+
         EZ_VERIFY(m_WorkerState.Set((int)ezTaskWorkerState::Idle) == (int)ezTaskWorkerState::Active, "Corrupt worker state");
 
         // if this thread is part of the reserve, then don't continue to process tasks indefinitely
@@ -81,7 +85,7 @@ ezUInt32 ezTaskWorkerThread::Run()
         // that someone else may be a thread at the front of the queue, it may also turn out to be this thread again
         // either way, if at some point we woke up more threads than the maximum desired, this will move the active threads
         // to the front of the list, because of the way ezTaskSystem::WakeUpThreads() works
-        ezTaskSystem::WakeUpThreads(m_WorkerType, 1);
+        ezTaskSystem::WakeUpThreads(m_WorkerType, ezMath::Max(1u, uiNumHandedOver));
 
         WaitForWork();
       }
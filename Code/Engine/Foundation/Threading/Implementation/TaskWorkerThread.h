@@ -1,5 +1,6 @@
 #pragma once
 
+#include <Foundation/Threading/Implementation/TaskStealingDeque.h>
 #include <Foundation/Threading/Implementation/TaskSystemDeclarations.h>
 
 #include <Foundation/Threading/Thread.h>
@@ -77,6 +78,18 @@ private:
   ezAtomicInteger32 m_WorkerState; // ezTaskWorkerState
 
   ///@}
+
+  /// \name Work Stealing
+  ///@{
+
+private:
+  friend class ezTaskSystem;
+
+  // In ezTaskSchedulingMode::WorkStealing, 'this frame' tasks started on this thread are queued here (one deque per priority).
+  // Only this thread pushes and pops, all other threads may steal.
+  ezTaskStealingDeque m_LocalTasks[ezTaskPriority::LateThisFrame + 1];
+
+  ///@}
 };
 
 /// \internal Thread local state used by the task system (and for better debugging)
@@ -87,6 +100,7 @@ struct ezTaskWorkerInfo
   bool m_bAllowNestedTasks = true;
   const char* m_szTaskName = nullptr;
   ezAtomicInteger32* m_pWorkerState = nullptr;
+  ezTaskWorkerThread* m_pWorkerThread = nullptr;
 };
 
 extern thread_local ezTaskWorkerInfo tl_TaskWorkerInfo;
@@ -99,6 +99,21 @@ private:
   /// \brief Helps executing tasks that are suitable for the calling thread. Returns true if a task was found and executed.
   static bool HelpExecutingTasks(const ezTaskGroupID& WaitingForGroup);
 
+  /// \brief Returns whether the given task may be executed by a thread that is currently waiting for \a WaitingForGroup.
+  static bool IsTaskAllowedToExecute(const TaskData& task, bool bOnlyTasksThatNeverWait, const ezTaskGroupID& WaitingForGroup);
+
+  /// \brief Removes the first suitable task of the given priority from the global queue. The caller has to hold s_TaskSystemMutex.
+  static bool TakeTaskFromGlobalQueue(ezUInt32 uiPriority, bool bOnlyTasksThatNeverWait, const ezTaskGroupID& WaitingForGroup, TaskData& out_Task);
+
+  /// \brief Puts a task that was taken from a worker-local queue, but cannot be executed by the current thread, into the global queue.
+  static void MoveTaskToGlobalQueue(const TaskData& task, ezUInt32 uiPriority);
+
+  /// \brief Takes tasks from the worker-local queues (and in work-stealing mode, also from the global queue without waiting for the lock).
+  static bool GetNextTaskLockFree(ezTaskPriority::Enum FirstPriority, ezTaskPriority::Enum LastPriority, bool bOnlyTasksThatNeverWait, const ezTaskGroupID& WaitingForGroup, TaskData& out_Task);
+
+  /// \brief Tries to steal a task of the given priority from the local queue of any short task worker thread.
+  static bool StealTask(ezUInt32 uiPriority, bool bOnlyTasksThatNeverWait, const ezTaskGroupID& WaitingForGroup, TaskData& out_Task);
+
   ///@}
 
   /// \name Managing Task Groups
@@ -168,6 +183,9 @@ private:
   /// \brief Takes all the tasks in the given group and schedules them for execution, by inserting them into the proper task lists.
   static void ScheduleGroupTasks(ezTaskGroup* pGroup, bool bHighPriority);
 
+  /// \brief Work-stealing mode: Puts the tasks of the given group into the local queue of the calling worker thread. Returns false if that is not possible.
+  static bool ScheduleGroupTasksLocally(ezTaskGroup* pGroup);
+
   /// \brief Is called whenever a dependency of pGroup has finished. Once all dependencies are finished, the group's tasks will get scheduled.
   static void DependencyHasFinished(ezTaskGroup* pGroup);
 
@@ -203,6 +221,16 @@ public:
   /// \brief Returns the (thread local) type of tasks that would be executed on this thread
   static ezWorkerThreadType::Enum GetCurrentThreadWorkerType();
 
+  /// \brief Selects how scheduled tasks are distributed onto the worker threads. See ezTaskSchedulingMode.
+  ///
+  /// The mode may be switched at any time, tasks that are already queued will still be executed.
+  /// Note that tasks that were put into the local queue of a worker thread cannot be removed from there anymore,
+  /// so CancelTask() will have to wait for them to run (with their cancel flag set).
+  static void SetTaskSchedulingMode(ezTaskSchedulingMode::Enum mode);
+
+  /// \brief Returns the currently used ezTaskSchedulingMode.
+  static ezTaskSchedulingMode::Enum GetTaskSchedulingMode();
+
   /// \brief Returns the utilization (0.0 to 1.0) of the given thread. Note: This will only be valid, if FinishFrameTasks() is called once
   /// per frame.
   ///
@@ -224,6 +252,11 @@ private:
   /// \brief Uses a thread local variable to know the current thread type and to decide the range of task priorities that it may execute
   static void DetermineTasksToExecuteOnThread(ezTaskPriority::Enum& out_FirstPriority, ezTaskPriority::Enum& out_LastPriority);
 
+  /// \brief Moves all tasks from the local queues of the given worker into the global queues. Returns how many tasks were moved.
+  ///
+  /// Does not wake up any threads, that is up to the caller.
+  static ezUInt32 MoveLocalTasksToGlobalQueue(ezTaskWorkerThread* pWorker);
+
 private:
   static ezUniquePtr<ezTaskSystemThreadState> s_ThreadState;
 
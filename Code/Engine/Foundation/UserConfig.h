@@ -75,6 +75,11 @@
 #    endif
 #  endif
 
+// Set to EZ_ON to serve small allocations of the default allocators from per-thread size class slabs, see ezSmallObjectAllocation.
+// Has no effect when guarded allocations are enabled.
+#  undef EZ_USE_SMALL_OBJECT_ALLOCATIONS
+#  define EZ_USE_SMALL_OBJECT_ALLOCATIONS EZ_OFF
+
 // Uncomment to use guarded allocations. This will use a lot of memory and should only be used in 64bit builds.
 //#undef EZ_USE_GUARDED_ALLOCATIONS
 //#define EZ_USE_GUARDED_ALLOCATIONS EZ_ON
@@ -0,0 +1,371 @@
+#include <GameEnginePCH.h>
+
+#include <Foundation/Time/Time.h>
+#include <GameEngine/AI/PathQueryWorldModule.h>
+#include <Utilities/PathFinding/GraphSearch.h>
+#include <Utilities/PathFinding/GridNavmesh.h>
+
+// clang-format off
+EZ_IMPLEMENT_WORLD_MODULE(ezPathQueryWorldModule);
+
+EZ_BEGIN_DYNAMIC_REFLECTED_TYPE(ezPathQueryWorldModule, 1, ezRTTINoAllocator)
+EZ_END_DYNAMIC_REFLECTED_TYPE;
+// clang-format on
+
+namespace
+{
+  /// Generates the neighbors of a navmesh area, the cost between two areas is the distance between their centers.
+  class ezNavmeshPathStateGenerator : public ezPathStateGenerator<ezPathState>
+  {
+  public:
+    ezNavmeshPathStateGenerator(const ezGridNavmesh* pNavmesh)
+      : m_pNavmesh(pNavmesh)
+    {
+    }
+
+    virtual void StartSearch(ezInt64 iStartNodeIndex, const ezPathState* pStartState, ezInt64 iTargetNodeIndex) override
+    {
+      m_vTargetCenter = GetAreaCenter(static_cast<ezInt32>(iTargetNodeIndex));
+    }
+
+    virtual void GenerateAdjacentStates(ezInt64 iNodeIndex, const ezPathState& StartState, ezPathSearch<ezPathState>* pPathSearch) override
+    {
+      const ezGridNavmesh::ConvexArea& area = m_pNavmesh->GetConvexArea(static_cast<ezInt32>(iNodeIndex));
+      const ezVec2 vCenter = GetAreaCenter(static_cast<ezInt32>(iNodeIndex));
+
+      for (ezUInt32 e = 0; e < area.m_uiNumEdges; ++e)
+      {
+        const ezInt32 iNeighbor = m_pNavmesh->GetAreaEdge(area.m_uiFirstEdge + e).m_iNeighborArea;
+        const ezVec2 vNeighborCenter = GetAreaCenter(iNeighbor);
+
+        ezPathState state;
+        state.m_fCostToNode = StartState.m_fCostToNode + ezMath::Max((vNeighborCenter - vCenter).GetLength(), 0.001f);
+        state.m_fEstimatedCostToTarget = state.m_fCostToNode + (m_vTargetCenter - vNeighborCenter).GetLength();
+
+        pPathSearch->AddPathNode(iNeighbor, state);
+      }
+    }
+
+    ezVec2 GetAreaCenter(ezInt32 iArea) const
+    {
+      const ezRectU32& rect = m_pNavmesh->GetConvexArea(iArea).m_Rect;
+      return ezVec2(rect.x + rect.width * 0.5f, rect.y + rect.height * 0.5f);
+    }
+
+  private:
+    const ezGridNavmesh* m_pNavmesh = nullptr;
+    ezVec2 m_vTargetCenter;
+  };
+
+  /// Executes searches of the current batch until there are none left or the time budget is used up.
+  ///
+  /// Every task owns its search data, so multiple tasks can run in parallel without any synchronization.
+  /// The search type is private to the module, so it is passed in as a template argument.
+  template <typename SearchType>
+  class ezPathQueryTask : public ezTask
+  {
+  public:
+    ezPathQueryTask(ezDelegate<SearchType*()> getNextSearch, const ezGridNavmesh* pNavmesh)
+      : m_GetNextSearch(getNextSearch)
+      , m_Generator(pNavmesh)
+    {
+      ConfigureTask("Path Queries", ezTaskNesting::Never);
+
+      m_PathSearch.SetPathStateGenerator(&m_Generator);
+      m_PathSearch.SetDenseNodeIndexRange(pNavmesh->GetNumConvexAreas());
+    }
+
+  private:
+    virtual void Execute() override
+    {
+      while (SearchType* pSearch = m_GetNextSearch())
+      {
+        ezPathState startState;
+        startState.m_fCostToNode = 0.0f;
+        startState.m_fEstimatedCostToTarget =
+          (m_Generator.GetAreaCenter(pSearch->m_iTargetArea) - m_Generator.GetAreaCenter(pSearch->m_iStartArea)).GetLength();
+
+        pSearch->m_Result = m_PathSearch.FindPath(pSearch->m_iStartArea, startState, pSearch->m_iTargetArea, m_Path);
+
+        if (pSearch->m_Result.Succeeded())
+        {
+          pSearch->m_fPathCost = m_Path.PeekBack().m_pPathState->m_fCostToNode;
+          pSearch->m_Areas.SetCountUninitialized(m_Path.GetCount());
+
+          for (ezUInt32 i = 0; i < m_Path.GetCount(); ++i)
+          {
+            pSearch->m_Areas[i] = static_cast<ezInt32>(m_Path[i].m_iNodeIndex);
+          }
+        }
+
+        pSearch->m_bExecuted = true;
+      }
+    }
+
+    ezDelegate<SearchType*()> m_GetNextSearch;
+    ezNavmeshPathStateGenerator m_Generator;
+    ezPathSearch<ezPathState> m_PathSearch;
+    ezDeque<ezPathSearch<ezPathState>::PathResultData> m_Path;
+  };
+} // namespace
+
+ezPathQueryWorldModule::ezPathQueryWorldModule(ezWorld* pWorld)
+  : ezWorldModule(pWorld)
+{
+}
+
+ezPathQueryWorldModule::~ezPathQueryWorldModule() = default;
+
+void ezPathQueryWorldModule::Initialize()
+{
+  SUPER::Initialize();
+
+  {
+    auto updateDesc = EZ_CREATE_MODULE_UPDATE_FUNCTION_DESC(ezPathQueryWorldModule::UpdateQueries, this);
+    updateDesc.m_Phase = ezWorldModule::UpdateFunctionDesc::Phase::PreAsync;
+    updateDesc.m_bOnlyUpdateWhenSimulating = false;
+
+    RegisterUpdateFunction(updateDesc);
+  }
+}
+
+void ezPathQueryWorldModule::Deinitialize()
+{
+  SetNavmesh(nullptr);
+
+  SUPER::Deinitialize();
+}
+
+void ezPathQueryWorldModule::SetNavmesh(const ezGridNavmesh* pNavmesh)
+{
+  if (m_BatchTaskGroup.IsValid())
+  {
+    ezTaskSystem::WaitForGroup(m_BatchTaskGroup);
+    m_BatchTaskGroup.Invalidate();
+  }
+
+  m_PendingQueries.Clear();
+
+  if (m_bDeliveringResults)
+  {
+    // called from a query callback, FinishBatch() is still iterating over the batch and clears it once it is done
+    for (Query& query : m_BatchQueries)
+    {
+      query.m_bCanceled = true;
+    }
+  }
+  else
+  {
+    m_BatchQueries.Clear();
+    m_BatchSearches.Clear();
+    m_BatchSearchLookup.Clear();
+  }
+
+  m_Tasks.Clear();
+
+  m_pNavmesh = pNavmesh;
+}
+
+ezUInt32 ezPathQueryWorldModule::QueueQuery(const ezVec2I32& startCoord, const ezVec2I32& targetCoord, ezPathQueryCallback callback)
+{
+  EZ_ASSERT_DEV(m_pNavmesh != nullptr, "A navmesh must be set before path queries can be queued");
+  EZ_ASSERT_DEV(m_pNavmesh->IsValidCellCoordinate(startCoord) && m_pNavmesh->IsValidCellCoordinate(targetCoord),
+    "Path query coordinates are outside the navmesh");
+
+  Query& query = m_PendingQueries.ExpandAndGetRef();
+  query.m_uiQueryID = m_uiNextQueryID;
+  query.m_StartCoord = startCoord;
+  query.m_TargetCoord = targetCoord;
+  query.m_Callback = callback;
+
+  // zero is never handed out, so that it can be used as an invalid ID
+  if (++m_uiNextQueryID == 0)
+    m_uiNextQueryID = 1;
+
+  return query.m_uiQueryID;
+}
+
+bool ezPathQueryWorldModule::CancelQuery(ezUInt32 uiQueryID)
+{
+  for (ezUInt32 i = 0; i < m_PendingQueries.GetCount(); ++i)
+  {
+    if (m_PendingQueries[i].m_uiQueryID == uiQueryID)
+    {
+      m_PendingQueries.RemoveAtAndCopy(i);
+      return true;
+    }
+  }
+
+  // queries of the running batch can't be removed, because the tasks are still working on them
+  for (Query& query : m_BatchQueries)
+  {
+    if (query.m_uiQueryID == uiQueryID && !query.m_bCanceled)
+    {
+      query.m_bCanceled = true;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void ezPathQueryWorldModule::FinishAllQueries()
+{
+  while (GetNumPendingQueries() > 0)
+  {
+    FinishBatch();
+    StartBatch(ezTime::Seconds(1000000));
+  }
+}
+
+void ezPathQueryWorldModule::UpdateQueries(const ezWorldModule::UpdateContext& context)
+{
+  FinishBatch();
+  StartBatch(m_TimeBudget);
+}
+
+void ezPathQueryWorldModule::StartBatch(ezTime timeBudget)
+{
+  EZ_ASSERT_DEBUG(m_BatchQueries.IsEmpty(), "The previous batch has not been finished");
+
+  if (m_PendingQueries.IsEmpty() || m_pNavmesh == nullptr)
+    return;
+
+  m_BatchQueries.Reserve(m_PendingQueries.GetCount());
+
+  for (Query& query : m_PendingQueries)
+  {
+    const ezInt32 iStartArea = m_pNavmesh->GetAreaAt(query.m_StartCoord);
+    const ezInt32 iTargetArea = m_pNavmesh->GetAreaAt(query.m_TargetCoord);
+
+    if (iStartArea < 0 || iTargetArea < 0)
+    {
+      // blocked cells never need a search, these queries fail right away
+      query.m_uiSearch = ezInvalidIndex;
+    }
+    else
+    {
+      // all queries between the same two areas share one search
+      const ezUInt64 uiKey = (static_cast<ezUInt64>(iStartArea) << 32) | static_cast<ezUInt32>(iTargetArea);
+
+      if (!m_BatchSearchLookup.TryGetValue(uiKey, query.m_uiSearch))
+      {
+        query.m_uiSearch = m_BatchSearches.GetCount();
+        m_BatchSearchLookup.Insert(uiKey, query.m_uiSearch);
+
+        Search& search = m_BatchSearches.ExpandAndGetRef();
+        search.m_iStartArea = iStartArea;
+        search.m_iTargetArea = iTargetArea;
+      }
+    }
+
+    m_BatchQueries.PushBack(std::move(query));
+  }
+
+  m_PendingQueries.Clear();
+
+  if (m_BatchSearches.IsEmpty())
+    return;
+
+  const ezUInt32 uiNumTasks =
+    ezMath::Min(m_BatchSearches.GetCount(), ezTaskSystem::GetWorkerThreadCount(ezWorkerThreadType::ShortTasks) + 1);
+
+  while (m_Tasks.GetCount() < uiNumTasks)
+  {
+    m_Tasks.PushBack(EZ_DEFAULT_NEW(ezPathQueryTask<Search>, ezDelegate<Search*()>(&ezPathQueryWorldModule::GetNextSearch, this), m_pNavmesh));
+  }
+
+  m_iNextBatchSearch = 0;
+  m_iBatchStartTime = 0;
+  m_BatchTimeBudget = timeBudget;
+
+  // the results are picked up at the beginning of the next update, so the tasks may run in parallel to the rest of this frame
+  m_BatchTaskGroup = ezTaskSystem::CreateTaskGroup(ezTaskPriority::LateThisFrame);
+
+  for (ezUInt32 i = 0; i < uiNumTasks; ++i)
+  {
+    ezTaskSystem::AddTaskToGroup(m_BatchTaskGroup, m_Tasks[i].Borrow());
+  }
+
+  ezTaskSystem::StartTaskGroup(m_BatchTaskGroup);
+}
+
+void ezPathQueryWorldModule::FinishBatch()
+{
+  if (m_BatchTaskGroup.IsValid())
+  {
+    ezTaskSystem::WaitForGroup(m_BatchTaskGroup);
+    m_BatchTaskGroup.Invalidate();
+  }
+
+  if (m_BatchQueries.IsEmpty())
+    return;
+
+  // Postpone queries before any callback runs, callbacks may queue or cancel queries or even change the navmesh.
+  ezUInt32 uiNumPostponed = 0;
+
+  for (Query& query : m_BatchQueries)
+  {
+    if (query.m_bCanceled || query.m_uiSearch == ezInvalidIndex || m_BatchSearches[query.m_uiSearch].m_bExecuted)
+      continue;
+
+    // the time budget was used up before this search was started, keep the query in its original order for the next batch
+    m_PendingQueries.Insert(query, uiNumPostponed);
+    ++uiNumPostponed;
+
+    query.m_bCanceled = true;
+  }
+
+  m_bDeliveringResults = true;
+
+  for (ezUInt32 i = 0; i < m_BatchQueries.GetCount(); ++i)
+  {
+    const Query& query = m_BatchQueries[i];
+
+    if (query.m_bCanceled)
+      continue;
+
+    ezPathQueryResult result;
+    result.m_uiQueryID = query.m_uiQueryID;
+    result.m_StartCoord = query.m_StartCoord;
+    result.m_TargetCoord = query.m_TargetCoord;
+
+    if (query.m_uiSearch != ezInvalidIndex)
+    {
+      const Search& search = m_BatchSearches[query.m_uiSearch];
+
+      result.m_Result = search.m_Result;
+      result.m_fPathCost = search.m_fPathCost;
+      result.m_Areas = search.m_Areas.GetArrayPtr();
+    }
+
+    query.m_Callback(result);
+  }
+
+  m_bDeliveringResults = false;
+
+  m_BatchQueries.Clear();
+  m_BatchSearches.Clear();
+  m_BatchSearchLookup.Clear();
+}
+
+ezPathQueryWorldModule::Search* ezPathQueryWorldModule::GetNextSearch()
+{
+  // always execute at least one search per batch, otherwise a tiny budget could postpone all queries forever
+  const ezInt32 iSearch = m_iNextBatchSearch.Increment() - 1;
+
+  if (iSearch >= static_cast<ezInt32>(m_BatchSearches.GetCount()))
+    return nullptr;
+
+  // The budget starts with the first search instead of when the batch is scheduled, since the tasks are often only picked up
+  // after the rest of the frame's work.
+  const ezInt64 iNow = ezMath::Max<ezInt64>(static_cast<ezInt64>(ezTime::Now().GetMicroseconds()), 1);
+  m_iBatchStartTime.TestAndSet(0, iNow);
+
+  if (iSearch > 0 && ezTime::Microseconds(static_cast<double>(iNow - m_iBatchStartTime)) > m_BatchTimeBudget)
+    return nullptr;
+
+  return &m_BatchSearches[iSearch];
+}
+
+EZ_STATICLINK_FILE(GameEngine, GameEngine_AI_Implementation_PathQueryWorldModule);
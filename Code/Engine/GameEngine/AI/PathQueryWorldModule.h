@@ -0,0 +1,136 @@
+#pragma once
+
+#include <Core/World/WorldModule.h>
+#include <Foundation/Containers/Deque.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Threading/AtomicInteger.h>
+#include <Foundation/Threading/TaskSystem.h>
+#include <Foundation/Types/Delegate.h>
+#include <Foundation/Types/UniquePtr.h>
+#include <GameEngine/GameEngineDLL.h>
+
+class ezGridNavmesh;
+
+/// \brief The result of a path query that was queued with ezPathQueryWorldModule::QueueQuery().
+struct ezPathQueryResult
+{
+  /// \brief The ID that was returned by ezPathQueryWorldModule::QueueQuery().
+  ezUInt32 m_uiQueryID = 0;
+
+  /// \brief EZ_FAILURE if the start or target cell is blocked or if the target cannot be reached from the start.
+  ezResult m_Result = EZ_FAILURE;
+
+  ezVec2I32 m_StartCoord;
+  ezVec2I32 m_TargetCoord;
+
+  /// \brief The accumulated distance between the centers of the areas along the path.
+  float m_fPathCost = 0.0f;
+
+  /// \brief The indices of all navmesh areas (see ezGridNavmesh::GetConvexArea()) along the path, including the start and target area.
+  ///
+  /// The data is only valid during the callback, it must be copied if it is needed afterwards.
+  ezArrayPtr<const ezInt32> m_Areas;
+};
+
+using ezPathQueryCallback = ezDelegate<void(const ezPathQueryResult&)>;
+
+/// \brief Runs path searches on an ezGridNavmesh asynchronously and in parallel.
+///
+/// Queries are collected with QueueQuery() during the frame. Once per frame the module takes all queued queries,
+/// merges queries that have the same start and target area into a single search and starts tasks that execute the searches
+/// in parallel. Every task owns its own ezPathSearch instance, so no search state is shared between threads.
+/// The searches run while the rest of the frame is processed and their results are delivered through the query callbacks
+/// at the beginning of the next update of the module, on the thread that updates the world.
+///
+/// The tasks stop picking up new searches once the time budget (see SetTimeBudget()) for the current batch is used up. The budget
+/// starts when the first task begins executing searches, not when the batch is scheduled.
+/// Searches that were not started in time stay queued and are executed with the next batch.
+class EZ_GAMEENGINE_DLL ezPathQueryWorldModule : public ezWorldModule
+{
+  EZ_DECLARE_WORLD_MODULE();
+  EZ_ADD_DYNAMIC_REFLECTION(ezPathQueryWorldModule, ezWorldModule);
+
+public:
+  ezPathQueryWorldModule(ezWorld* pWorld);
+  ~ezPathQueryWorldModule();
+
+  virtual void Initialize() override;
+  virtual void Deinitialize() override;
+
+  /// \brief Sets the navmesh that all queries are executed on.
+  ///
+  /// The navmesh must not be modified or deleted while it is set, because searches may access it at any time.
+  /// Changing the navmesh waits for the running searches and cancels all queued queries without calling their callbacks.
+  void SetNavmesh(const ezGridNavmesh* pNavmesh);
+  const ezGridNavmesh* GetNavmesh() const { return m_pNavmesh; }
+
+  /// \brief Sets how much time the searches of one batch may take, before the remaining searches are postponed to the next batch.
+  ///
+  /// Searches that have already been started are always finished, so the budget may be exceeded by the duration of one search.
+  void SetTimeBudget(ezTime budget) { m_TimeBudget = budget; }
+  ezTime GetTimeBudget() const { return m_TimeBudget; }
+
+  /// \brief Queues a search for a path from the start cell to the target cell. Returns an ID that can be used to cancel the query.
+  ///
+  /// The callback is called exactly once, unless the query is canceled. Both coordinates must be inside the navmesh grid.
+  ezUInt32 QueueQuery(const ezVec2I32& startCoord, const ezVec2I32& targetCoord, ezPathQueryCallback callback);
+
+  /// \brief Removes a query that has not been delivered yet. Its callback will not be called. Returns false if the query is not known.
+  bool CancelQuery(ezUInt32 uiQueryID);
+
+  /// \brief Returns the number of queries whose results have not been delivered yet.
+  ezUInt32 GetNumPendingQueries() const { return m_PendingQueries.GetCount() + m_BatchQueries.GetCount(); }
+
+  /// \brief Waits until all queued queries have been executed and delivers their results, ignoring the time budget.
+  ///
+  /// This is mostly useful for tools and tests, during the game the results should be picked up by the regular update.
+  void FinishAllQueries();
+
+private:
+  struct Query
+  {
+    ezUInt32 m_uiQueryID = 0;
+    ezUInt32 m_uiSearch = 0;
+    bool m_bCanceled = false;
+    ezVec2I32 m_StartCoord;
+    ezVec2I32 m_TargetCoord;
+    ezPathQueryCallback m_Callback;
+  };
+
+  struct Search
+  {
+    ezInt32 m_iStartArea = -1;
+    ezInt32 m_iTargetArea = -1;
+    bool m_bExecuted = false;
+    ezResult m_Result = EZ_FAILURE;
+    float m_fPathCost = 0.0f;
+    ezDynamicArray<ezInt32> m_Areas;
+  };
+
+  void UpdateQueries(const ezWorldModule::UpdateContext& context);
+  void StartBatch(ezTime timeBudget);
+  void FinishBatch();
+
+  /// \brief Called by the tasks, returns the next search that should be executed or nullptr if there is none or the time is up.
+  Search* GetNextSearch();
+
+  /// \brief Set while FinishBatch() calls the query callbacks, so that SetNavmesh() does not clear the batch that is being iterated.
+  bool m_bDeliveringResults = false;
+
+  const ezGridNavmesh* m_pNavmesh = nullptr;
+  ezTime m_TimeBudget = ezTime::Milliseconds(4);
+  ezUInt32 m_uiNextQueryID = 1;
+
+  ezDeque<Query> m_PendingQueries;
+
+  // the batch that is currently being executed by the tasks
+  ezDynamicArray<Query> m_BatchQueries;
+  ezDynamicArray<Search> m_BatchSearches;
+  ezHashTable<ezUInt64, ezUInt32> m_BatchSearchLookup;
+  ezAtomicInteger32 m_iNextBatchSearch;
+  ezAtomicInteger64 m_iBatchStartTime; ///< In microseconds, set by the first call to GetNextSearch() of a batch, zero before.
+  ezTime m_BatchTimeBudget;
+  ezTaskGroupID m_BatchTaskGroup;
+
+  ezDynamicArray<ezUniquePtr<ezTask>> m_Tasks;
+};
@@ -188,9 +188,8 @@ void ezGameApplication::Run_FinishFrame()
 
 void ezGameApplication::UpdateWorldsAndExtractViews()
 {
-  ezStringBuilder sb;
-  sb.Format("FRAME {}", ezRenderWorld::GetFrameCounter());
-  EZ_PROFILE_SCOPE(sb.GetData());
+  // the frame number is shown in the 'Frames' track, a scope name per frame would register a new name every frame
+  EZ_PROFILE_SCOPE("UpdateWorldsAndExtractViews");
 
   Run_BeforeWorldUpdate();
 
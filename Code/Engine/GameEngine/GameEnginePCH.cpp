@@ -7,6 +7,7 @@ EZ_STATICLINK_LIBRARY(GameEngine)
 
   EZ_STATICLINK_REFERENCE(GameEngine_AI_Implementation_AgentSteeringComponent);
   EZ_STATICLINK_REFERENCE(GameEngine_AI_Implementation_NpcComponent);
+  EZ_STATICLINK_REFERENCE(GameEngine_AI_Implementation_PathQueryWorldModule);
   EZ_STATICLINK_REFERENCE(GameEngine_AI_Implementation_PointOfInterestGraph);
   EZ_STATICLINK_REFERENCE(GameEngine_ActorSystem_Implementation_Actor);
   EZ_STATICLINK_REFERENCE(GameEngine_ActorSystem_Implementation_ActorApiService);
@@ -77,6 +78,7 @@ EZ_STATICLINK_LIBRARY(GameEngine)
   EZ_STATICLINK_REFERENCE(GameEngine_VisualScript_Implementation_VisualScriptComponent);
   EZ_STATICLINK_REFERENCE(GameEngine_VisualScript_Implementation_VisualScriptInstance);
   EZ_STATICLINK_REFERENCE(GameEngine_VisualScript_Implementation_VisualScriptNode);
+  EZ_STATICLINK_REFERENCE(GameEngine_VisualScript_Implementation_VisualScriptProgram);
   EZ_STATICLINK_REFERENCE(GameEngine_VisualScript_Implementation_VisualScriptResource);
   EZ_STATICLINK_REFERENCE(GameEngine_VisualScript_Nodes_VisualScriptLogicNodes);
   EZ_STATICLINK_REFERENCE(GameEngine_VisualScript_Nodes_VisualScriptMathExpressionNode);
@@ -9,6 +9,7 @@
 #include <GameEngine/VisualScript/Nodes/VisualScriptMessageNodes.h>
 #include <GameEngine/VisualScript/VisualScriptInstance.h>
 #include <GameEngine/VisualScript/VisualScriptNode.h>
+#include <GameEngine/VisualScript/VisualScriptProgram.h>
 #include <GameEngine/VisualScript/VisualScriptResource.h>
 
 ezMap<ezVisualScriptInstance::AssignFuncKey, ezVisualScriptDataPinAssignFunc> ezVisualScriptInstance::s_DataPinAssignFunctions;
@@ -69,21 +70,22 @@ ezVisualScriptInstance::ezVisualScriptInstance()
 
 void ezVisualScriptInstance::SetupPinDataTypeConversions()
 {
-  static bool bDone = false;
-  if (bDone)
-    return;
-
-  bDone = true;
-
-  RegisterDataPinAssignFunction(ezVisualScriptDataPinType::Number, ezVisualScriptDataPinType::Number, ezVisualScriptAssignNumberNumber);
-  RegisterDataPinAssignFunction(ezVisualScriptDataPinType::Boolean, ezVisualScriptDataPinType::Boolean, ezVisualScriptAssignBoolBool);
-  RegisterDataPinAssignFunction(ezVisualScriptDataPinType::Vec3, ezVisualScriptDataPinType::Vec3, ezVisualScriptAssignVec3Vec3);
-  RegisterDataPinAssignFunction(ezVisualScriptDataPinType::Number, ezVisualScriptDataPinType::Vec3, ezVisualScriptAssignNumberVec3);
-  RegisterDataPinAssignFunction(ezVisualScriptDataPinType::GameObjectHandle, ezVisualScriptDataPinType::GameObjectHandle,
-    ezVisualScriptAssignGameObject);
-  RegisterDataPinAssignFunction(ezVisualScriptDataPinType::ComponentHandle, ezVisualScriptDataPinType::ComponentHandle,
-    ezVisualScriptAssignComponent);
-  RegisterDataPinAssignFunction(ezVisualScriptDataPinType::Number, ezVisualScriptDataPinType::Boolean, ezVisualScriptAssignNumberBool);
+  // programs are compiled on resource loading threads while instances are created on the main thread,
+  // the initialization of a function-local static is guaranteed to run exactly once, even for concurrent calls
+  static const bool s_bDone = []() {
+    RegisterDataPinAssignFunction(ezVisualScriptDataPinType::Number, ezVisualScriptDataPinType::Number, ezVisualScriptAssignNumberNumber);
+    RegisterDataPinAssignFunction(ezVisualScriptDataPinType::Boolean, ezVisualScriptDataPinType::Boolean, ezVisualScriptAssignBoolBool);
+    RegisterDataPinAssignFunction(ezVisualScriptDataPinType::Vec3, ezVisualScriptDataPinType::Vec3, ezVisualScriptAssignVec3Vec3);
+    RegisterDataPinAssignFunction(ezVisualScriptDataPinType::Number, ezVisualScriptDataPinType::Vec3, ezVisualScriptAssignNumberVec3);
+    RegisterDataPinAssignFunction(ezVisualScriptDataPinType::GameObjectHandle, ezVisualScriptDataPinType::GameObjectHandle,
+      ezVisualScriptAssignGameObject);
+    RegisterDataPinAssignFunction(ezVisualScriptDataPinType::ComponentHandle, ezVisualScriptDataPinType::ComponentHandle,
+      ezVisualScriptAssignComponent);
+    RegisterDataPinAssignFunction(ezVisualScriptDataPinType::Number, ezVisualScriptDataPinType::Boolean, ezVisualScriptAssignNumberBool);
+    return true;
+  }();
+
+  EZ_ASSERT_DEBUG(s_bDone, "Implementation error");
 }
 
 ezVisualScriptInstance::~ezVisualScriptInstance()
@@ -100,42 +102,20 @@ void ezVisualScriptInstance::Clear()
 
   m_pWorld = nullptr;
   m_Nodes.Clear();
-  m_ExecutionConnections.Clear();
-  m_DataConnections.Clear();
+  m_DataPinTargets.Clear();
   m_LocalVariables.Clear();
+  m_pProgram = nullptr;
   m_hScriptResource.Invalidate();
 }
 
-
-void ezVisualScriptInstance::ComputeNodeDependencies()
-{
-  m_NodeDependencies.SetCount(m_Nodes.GetCount());
-
-  for (auto it = m_DataConnections.GetIterator(); it.IsValid(); ++it)
-  {
-    const ezVisualScriptPinConnectionID src = it.Key();
-
-    const ezUInt16 uiSourceNode = (src >> 16) & 0xFFFF;
-
-    if (m_Nodes[uiSourceNode]->IsManuallyStepped())
-      continue;
-
-    const ezHybridArray<DataPinConnection, 2>& dst = it.Value();
-
-    for (const DataPinConnection& target : dst)
-    {
-      m_NodeDependencies[target.m_uiTargetNode].PushBack(uiSourceNode);
-    }
-  }
-}
-
-
 void ezVisualScriptInstance::ExecuteDependentNodes(ezUInt16 uiNode)
 {
-  const auto& dep = m_NodeDependencies[uiNode];
-  for (ezUInt32 i = 0; i < dep.GetCount(); ++i)
+  const ezVisualScriptProgram::Node& node = m_pProgram->m_Nodes[uiNode];
+  const ezUInt16* pDependencies = m_pProgram->m_Dependencies.GetData() + node.m_uiFirstDependency;
+
+  for (ezUInt32 i = 0; i < node.m_uiNumDependencies; ++i)
   {
-    const ezUInt32 uiDependency = dep[i];
+    const ezUInt16 uiDependency = pDependencies[i];
     auto* pNode = m_Nodes[uiDependency];
 
     // recurse to the most dependent nodes first
@@ -153,8 +133,10 @@ void ezVisualScriptInstance::Configure(const ezVisualScriptResourceHandle& hScri
   Clear();
 
   ezResourceLock<ezVisualScriptResource> pScript(hScript, ezResourceAcquireMode::BlockTillLoaded);
-  const auto& resource = pScript->GetDescriptor();
-  m_pMessageHandlers = &resource.m_MessageHandlers;
+  m_pProgram = pScript->GetProgram();
+
+  if (m_pProgram == nullptr)
+    return;
 
   m_hScriptResource = hScript;
 
@@ -164,240 +146,104 @@ void ezVisualScriptInstance::Configure(const ezVisualScriptResourceHandle& hScri
     m_pWorld = pOwner->GetWorld();
   }
 
-  m_Nodes.Reserve(resource.m_Nodes.GetCount());
-
-  for (ezUInt32 n = 0; n < resource.m_Nodes.GetCount(); ++n)
-  {
-    const auto& node = resource.m_Nodes[n];
-
-    if (node.m_isFunctionCall)
-    {
-      CreateFunctionCallNode(n, resource);
-    }
-    else if (node.m_pType->IsDerivedFrom<ezMessage>())
-    {
-      if (node.m_isMsgSender)
-      {
-        CreateFunctionMessageNode(n, resource);
-      }
-      else if (node.m_isMsgHandler)
-      {
-        CreateEventMessageNode(n, resource);
-      }
-    }
-    else if (node.m_pType->IsDerivedFrom<ezVisualScriptNode>())
-    {
-      CreateVisualScriptNode(n, resource);
-    }
-    else
-    {
-      ezLog::Error("Invalid node type '{0}' in visual script", node.m_sTypeName);
-      Clear();
-      return;
-    }
-  }
+  const ezVisualScriptProgram& program = *m_pProgram;
 
-  m_ExecutionConnections.Reserve(resource.m_ExecutionPaths.GetCount());
+  m_Nodes.SetCountUninitialized(program.m_Nodes.GetCount());
 
-  for (const auto& con : resource.m_ExecutionPaths)
+  for (ezUInt32 n = 0; n < program.m_Nodes.GetCount(); ++n)
   {
-    ConnectExecutionPins(con.m_uiSourceNode, con.m_uiOutputPin, con.m_uiTargetNode, con.m_uiInputPin);
+    m_Nodes[n] = CreateNode(n);
   }
 
-  for (const auto& con : resource.m_DataPaths)
+  m_DataPinTargets.SetCountUninitialized(program.m_DataConnections.GetCount());
+
+  for (ezUInt32 i = 0; i < program.m_DataConnections.GetCount(); ++i)
   {
-    ConnectDataPins(con.m_uiSourceNode, con.m_uiOutputPin, (ezVisualScriptDataPinType::Enum)con.m_uiOutputPinType, con.m_uiTargetNode,
-      con.m_uiInputPin, (ezVisualScriptDataPinType::Enum)con.m_uiInputPinType);
+    const auto& con = program.m_DataConnections[i];
+    m_DataPinTargets[i] = m_Nodes[con.m_uiTargetNode]->GetInputPinDataPointer(con.m_uiTargetPin);
   }
 
-  ComputeNodeDependencies();
-
   // initialize local variables
   {
-    for (const auto& p : resource.m_BoolParameters)
+    for (const auto& p : program.m_BoolParameters)
     {
       m_LocalVariables.StoreBool(p.m_sName, p.m_Value);
     }
 
-    for (const auto& p : resource.m_NumberParameters)
+    for (const auto& p : program.m_NumberParameters)
     {
       m_LocalVariables.StoreDouble(p.m_sName, p.m_Value);
     }
   }
 }
 
-
-void ezVisualScriptInstance::CreateVisualScriptNode(ezUInt32 uiNodeIdx, const ezVisualScriptResourceDescriptor& resource)
-{
-  const auto& node = resource.m_Nodes[uiNodeIdx];
-
-  ezVisualScriptNode* pNode = node.m_pType->GetAllocator()->Allocate<ezVisualScriptNode>();
-  pNode->m_uiNodeID = uiNodeIdx;
-
-  // assign all property values
-  for (ezUInt32 i = 0; i < node.m_uiNumProperties; ++i)
-  {
-    const ezUInt32 uiProp = node.m_uiFirstProperty + i;
-    const auto& prop = resource.m_Properties[uiProp];
-
-    ezAbstractProperty* pAbstract = pNode->GetDynamicRTTI()->FindPropertyByName(prop.m_sName);
-    if (pAbstract->GetCategory() != ezPropertyCategory::Member)
-      continue;
-
-    ezAbstractMemberProperty* pMember = static_cast<ezAbstractMemberProperty*>(pAbstract);
-    ezReflectionUtils::SetMemberPropertyValue(pMember, pNode, prop.m_Value);
-  }
-
-  m_Nodes.PushBack(pNode);
-}
-
-void ezVisualScriptInstance::CreateFunctionMessageNode(ezUInt32 uiNodeIdx, const ezVisualScriptResourceDescriptor& resource)
+ezVisualScriptNode* ezVisualScriptInstance::CreateNode(ezUInt32 uiNodeIdx)
 {
-  const auto& node = resource.m_Nodes[uiNodeIdx];
-
-  ezVisualScriptNode_MessageSender* pNode =
-    ezGetStaticRTTI<ezVisualScriptNode_MessageSender>()->GetAllocator()->Allocate<ezVisualScriptNode_MessageSender>();
-  pNode->m_uiNodeID = uiNodeIdx;
+  const ezVisualScriptProgram::Node& node = m_pProgram->m_Nodes[uiNodeIdx];
+  const ezVisualScriptProgram::Property* pProperties = m_pProgram->m_Properties.GetData() + node.m_uiFirstProperty;
 
-  pNode->m_pMessageToSend = node.m_pType->GetAllocator()->Allocate<ezMessage>();
+  ezVisualScriptNode* pNode = node.m_pNodeType->GetAllocator()->Allocate<ezVisualScriptNode>();
+  pNode->m_uiNodeID = static_cast<ezUInt16>(uiNodeIdx);
 
-  // assign all property values
+  switch (node.m_Kind)
   {
-    for (ezUInt32 i = 0; i < node.m_uiNumProperties; ++i)
+    case ezVisualScriptProgram::NodeKind::MessageSender:
     {
-      const ezUInt32 uiProp = node.m_uiFirstProperty + i;
-      const auto& prop = resource.m_Properties[uiProp];
-
-      ezAbstractProperty* pAbstract = pNode->m_pMessageToSend->GetDynamicRTTI()->FindPropertyByName(prop.m_sName);
-      if (pAbstract == nullptr)
-      {
-        if (prop.m_sName == "Delay" && prop.m_Value.CanConvertTo<ezTime>())
-        {
-          pNode->m_Delay = prop.m_Value.ConvertTo<ezTime>();
-        }
-        if (prop.m_sName == "Recursive" && prop.m_Value.CanConvertTo<bool>())
-        {
-          pNode->m_bRecursive = prop.m_Value.ConvertTo<bool>();
-        }
-
-        continue;
-      }
-
-      if (pAbstract->GetCategory() != ezPropertyCategory::Member)
-        continue;
-
-      ezAbstractMemberProperty* pMember = static_cast<ezAbstractMemberProperty*>(pAbstract);
-      ezReflectionUtils::SetMemberPropertyValue(pMember, pNode->m_pMessageToSend, prop.m_Value);
+      auto* pSender = static_cast<ezVisualScriptNode_MessageSender*>(pNode);
+      pSender->m_pMessageToSend = node.m_pScriptType->GetAllocator()->Allocate<ezMessage>();
+      break;
     }
-  }
-
-  m_Nodes.PushBack(pNode);
-}
-
-
-void ezVisualScriptInstance::CreateEventMessageNode(ezUInt32 uiNodeIdx, const ezVisualScriptResourceDescriptor& resource)
-{
-  const auto& node = resource.m_Nodes[uiNodeIdx];
-
-  ezVisualScriptNode_GenericEvent* pNode = ezGetStaticRTTI<ezVisualScriptNode_GenericEvent>()->GetAllocator()->Allocate<ezVisualScriptNode_GenericEvent>();
-  pNode->m_uiNodeID = uiNodeIdx;
 
-  pNode->m_sEventType = node.m_sTypeName;
-
-  m_Nodes.PushBack(pNode);
-}
-
-ezAbstractFunctionProperty* ezVisualScriptInstance::SearchForScriptableFunctionOnType(const ezRTTI* pObjectType, ezStringView sFuncName, const ezScriptableFunctionAttribute*& out_pSfAttr) const
-{
-  if (sFuncName.IsEmpty())
-    return nullptr;
-
-  while (pObjectType != nullptr)
-  {
-    for (auto pFunc : pObjectType->GetFunctions())
+    case ezVisualScriptProgram::NodeKind::EventHandler:
     {
-      if (sFuncName != pFunc->GetPropertyName())
-        continue;
-
-      out_pSfAttr = pFunc->GetAttributeByType<ezScriptableFunctionAttribute>();
-
-      if (out_pSfAttr == nullptr)
-        continue;
+      static_cast<ezVisualScriptNode_GenericEvent*>(pNode)->m_sEventType = node.m_sEventType;
+      break;
+    }
 
-      return pFunc;
+    case ezVisualScriptProgram::NodeKind::FunctionCall:
+    {
+      auto* pCall = static_cast<ezVisualScriptNode_FunctionCall*>(pNode);
+      pCall->m_pExpectedType = node.m_pScriptType;
+      pCall->m_pFunctionToCall = node.m_pFunction;
+      pCall->m_ArgumentIsOutParamMask = node.m_uiArgumentIsOutParamMask;
+      pCall->m_Arguments.SetCount(node.m_uiNumProperties);
+      break;
     }
 
-    pObjectType = pObjectType->GetParentType();
+    default:
+      break;
   }
 
-  return nullptr;
-}
-
-void ezVisualScriptInstance::CreateFunctionCallNode(ezUInt32 uiNodeIdx, const ezVisualScriptResourceDescriptor& resource)
-{
-  const auto& node = resource.m_Nodes[uiNodeIdx];
-
-  ezVisualScriptNode_FunctionCall* pNode = ezGetStaticRTTI<ezVisualScriptNode_FunctionCall>()->GetAllocator()->Allocate<ezVisualScriptNode_FunctionCall>();
-  pNode->m_uiNodeID = uiNodeIdx;
-
-  pNode->m_pExpectedType = node.m_pType;
-
-  if (pNode->m_pExpectedType != nullptr)
+  // assign all property values
+  for (ezUInt32 i = 0; i < node.m_uiNumProperties; ++i)
   {
-    ezStringBuilder sFunc = node.m_sTypeName.FindSubString("::");
-    sFunc.Shrink(2, 0);
-
-    const ezScriptableFunctionAttribute* pSfAttr = nullptr;
-    pNode->m_pFunctionToCall = SearchForScriptableFunctionOnType(pNode->m_pExpectedType, sFunc, pSfAttr);
+    const ezVisualScriptProgram::Property& prop = pProperties[i];
 
-    if (pNode->m_pFunctionToCall != nullptr)
+    switch (prop.m_Target)
     {
-      pNode->m_ArgumentIsOutParamMask = 0;
-      pNode->m_Arguments.SetCount(pNode->m_pFunctionToCall->GetArgumentCount());
+      case ezVisualScriptProgram::PropertyTarget::NodeMember:
+        ezReflectionUtils::SetMemberPropertyValue(prop.m_pMember, pNode, prop.m_Value);
+        break;
 
-      // initialize the variants to the proper type
-      for (ezUInt32 arg = 0; arg < pNode->m_pFunctionToCall->GetArgumentCount(); ++arg)
-      {
-        pNode->m_Arguments[arg] = ezReflectionUtils::GetDefaultVariantFromType(pNode->m_pFunctionToCall->GetArgumentType(arg)->GetVariantType());
-        pNode->EnforceVariantTypeForInputPins(pNode->m_Arguments[arg]);
+      case ezVisualScriptProgram::PropertyTarget::MessageMember:
+        ezReflectionUtils::SetMemberPropertyValue(prop.m_pMember, static_cast<ezVisualScriptNode_MessageSender*>(pNode)->m_pMessageToSend, prop.m_Value);
+        break;
 
-        if (pSfAttr->GetArgumentType(arg) != ezScriptableFunctionAttribute::In) // out or inout
-        {
-          pNode->m_ArgumentIsOutParamMask |= EZ_BIT(arg);
-        }
-      }
+      case ezVisualScriptProgram::PropertyTarget::MessageDelay:
+        static_cast<ezVisualScriptNode_MessageSender*>(pNode)->m_Delay = prop.m_Value.Get<ezTime>();
+        break;
 
-      ezVariant tmpVal;
+      case ezVisualScriptProgram::PropertyTarget::MessageRecursive:
+        static_cast<ezVisualScriptNode_MessageSender*>(pNode)->m_bRecursive = prop.m_Value.Get<bool>();
+        break;
 
-      // assign all property values
-      for (ezUInt32 uiPropIdx = 0; uiPropIdx < node.m_uiNumProperties; ++uiPropIdx)
-      {
-        const ezUInt32 uiProp = node.m_uiFirstProperty + uiPropIdx;
-        const auto& prop = resource.m_Properties[uiProp];
-
-        if (prop.m_iMappingIndex >= 0 || prop.m_iMappingIndex < (ezInt32)pNode->m_Arguments.GetCount())
-        {
-          ezResult couldConvert = EZ_FAILURE;
-          tmpVal = prop.m_Value.ConvertTo(pNode->m_Arguments[prop.m_iMappingIndex].GetType(), &couldConvert);
-
-          if (couldConvert.Succeeded())
-          {
-            pNode->m_Arguments[prop.m_iMappingIndex] = tmpVal;
-          }
-        }
-      }
+      case ezVisualScriptProgram::PropertyTarget::FunctionArgument:
+        static_cast<ezVisualScriptNode_FunctionCall*>(pNode)->m_Arguments[prop.m_uiArgument] = prop.m_Value;
+        break;
     }
-    else
-    {
-      ezLog::Error("Function '{}' does not exist on type '{}'", sFunc, node.m_pType->GetTypeName());
-    }
-  }
-  else
-  {
-    ezLog::Error("Expected target object type is null for vis script function call node '{}'", node.m_sTypeName);
   }
 
-  m_Nodes.PushBack(pNode);
+  return pNode;
 }
 
 void ezVisualScriptInstance::ExecuteScript(ezVisualScriptInstanceActivity* pActivity /*= nullptr*/)
@@ -427,16 +273,17 @@ void ezVisualScriptInstance::ExecuteScript(ezVisualScriptInstanceActivity* pActi
 
 bool ezVisualScriptInstance::HandleMessage(ezMessage& msg)
 {
-  if (m_pMessageHandlers == nullptr)
+  if (m_pProgram == nullptr)
     return false;
 
-  ezUInt32 uiFirstHandler = m_pMessageHandlers->LowerBound(msg.GetId());
+  const ezArrayMap<ezMessageId, ezUInt16>& messageHandlers = m_pProgram->m_MessageHandlers;
+  ezUInt32 uiFirstHandler = messageHandlers.LowerBound(msg.GetId());
 
   bool bHandled = false;
 
-  while (uiFirstHandler < m_pMessageHandlers->GetCount())
+  while (uiFirstHandler < messageHandlers.GetCount())
   {
-    const auto& data = (*m_pMessageHandlers).GetPair(uiFirstHandler);
+    const auto& data = messageHandlers.GetPair(uiFirstHandler);
     if (data.key != msg.GetId())
       break;
 
@@ -450,36 +297,24 @@ bool ezVisualScriptInstance::HandleMessage(ezMessage& msg)
   return bHandled;
 }
 
-void ezVisualScriptInstance::ConnectExecutionPins(ezUInt16 uiSourceNode, ezUInt8 uiOutputSlot, ezUInt16 uiTargetNode, ezUInt8 uiTargetPin)
-{
-  auto& con = m_ExecutionConnections[((ezUInt32)uiSourceNode << 16) | (ezUInt32)uiOutputSlot];
-  con.m_uiTargetNode = uiTargetNode;
-  con.m_uiTargetPin = uiTargetPin;
-}
-
-void ezVisualScriptInstance::ConnectDataPins(ezUInt16 uiSourceNode, ezUInt8 uiSourcePin, ezVisualScriptDataPinType::Enum sourcePinType,
-  ezUInt16 uiTargetNode, ezUInt8 uiTargetPin, ezVisualScriptDataPinType::Enum targetPinType)
-{
-  DataPinConnection& con = m_DataConnections[((ezUInt32)uiSourceNode << 16) | (ezUInt32)uiSourcePin].ExpandAndGetRef();
-  con.m_uiTargetNode = uiTargetNode;
-  con.m_uiTargetPin = uiTargetPin;
-  con.m_pTargetData = m_Nodes[uiTargetNode]->GetInputPinDataPointer(uiTargetPin);
-  con.m_AssignFunc = FindDataPinAssignFunction(sourcePinType, targetPinType);
-}
-
 void ezVisualScriptInstance::SetOutputPinValue(const ezVisualScriptNode* pNode, ezUInt8 uiPin, const void* pValue)
 {
-  const ezUInt32 uiConnectionID = ((ezUInt32)pNode->m_uiNodeID << 16) | (ezUInt32)uiPin;
+  const ezVisualScriptProgram::Node& node = m_pProgram->m_Nodes[pNode->m_uiNodeID];
+  if (uiPin >= node.m_uiNumDataOutputs)
+    return;
 
-  ezHybridArray<DataPinConnection, 2>* TargetNodeAndPins;
-  if (!m_DataConnections.TryGetValue(uiConnectionID, TargetNodeAndPins))
+  const ezVisualScriptProgram::DataOutputPin& output = m_pProgram->m_DataOutputs[node.m_uiFirstDataOutput + uiPin];
+  if (output.m_uiNumConnections == 0)
     return;
 
-  for (const DataPinConnection& TargetNodeAndPin : *TargetNodeAndPins)
+  const ezUInt32 uiEndConnection = output.m_uiFirstConnection + output.m_uiNumConnections;
+  for (ezUInt32 i = output.m_uiFirstConnection; i < uiEndConnection; ++i)
   {
+    const ezVisualScriptProgram::DataConnection& TargetNodeAndPin = m_pProgram->m_DataConnections[i];
+
     if (TargetNodeAndPin.m_AssignFunc)
     {
-      if (TargetNodeAndPin.m_AssignFunc(pValue, TargetNodeAndPin.m_pTargetData))
+      if (TargetNodeAndPin.m_AssignFunc(pValue, m_DataPinTargets[i]))
       {
         m_Nodes[TargetNodeAndPin.m_uiTargetNode]->m_bInputValuesChanged = true;
       }
@@ -488,6 +323,7 @@ void ezVisualScriptInstance::SetOutputPinValue(const ezVisualScriptNode* pNode,
 
   if (m_pActivity != nullptr)
   {
+    const ezUInt32 uiConnectionID = ((ezUInt32)pNode->m_uiNodeID << 16) | (ezUInt32)uiPin;
     m_pActivity->m_ActiveDataConnections.PushBack(uiConnectionID);
   }
 }
@@ -499,10 +335,12 @@ Otherwise visual script graph execution can end up in an endless recursion with
 Override ezVisualScriptNode::IsManuallyStepped() for type '{}' if necessary.",
     pNode->GetDynamicRTTI()->GetTypeName());
 
-  const ezUInt32 uiConnectionID = ((ezUInt32)pNode->m_uiNodeID << 16) | (ezUInt32)uiNthTarget;
+  const ezVisualScriptProgram::Node& node = m_pProgram->m_Nodes[pNode->m_uiNodeID];
+  if (uiNthTarget >= node.m_uiNumExecutionOutputs)
+    return;
 
-  ExecPinConnection TargetNode;
-  if (!m_ExecutionConnections.TryGetValue(uiConnectionID, TargetNode))
+  const ezVisualScriptProgram::ExecutionConnection& TargetNode = m_pProgram->m_ExecutionOutputs[node.m_uiFirstExecutionOutput + uiNthTarget];
+  if (TargetNode.m_uiTargetNode == ezVisualScriptProgram::InvalidNode)
     return;
 
   auto* pTargetNode = m_Nodes[TargetNode.m_uiTargetNode];
@@ -514,6 +352,7 @@ Override ezVisualScriptNode::IsManuallyStepped() for type '{}' if necessary.",
 
   if (m_pActivity != nullptr)
   {
+    const ezUInt32 uiConnectionID = ((ezUInt32)pNode->m_uiNodeID << 16) | (ezUInt32)uiNthTarget;
     m_pActivity->m_ActiveExecutionConnections.PushBack(uiConnectionID);
   }
 }
@@ -540,10 +379,10 @@ ezVisualScriptDataPinAssignFunc ezVisualScriptInstance::FindDataPinAssignFunctio
 
 bool ezVisualScriptInstance::HandlesEventMessage(const ezEventMessage& msg) const
 {
-  if (m_pMessageHandlers == nullptr)
+  if (m_pProgram == nullptr)
     return false;
 
-  return m_pMessageHandlers->LowerBound(msg.GetId()) != ezInvalidIndex;
+  return m_pProgram->m_MessageHandlers.LowerBound(msg.GetId()) != ezInvalidIndex;
 }
 
 
@@ -0,0 +1,334 @@
+#include <GameEnginePCH.h>
+
+#include <Foundation/Reflection/ReflectionUtils.h>
+#include <GameEngine/VisualScript/Nodes/VisualScriptMessageNodes.h>
+#include <GameEngine/VisualScript/VisualScriptInstance.h>
+#include <GameEngine/VisualScript/VisualScriptNode.h>
+#include <GameEngine/VisualScript/VisualScriptProgram.h>
+
+namespace
+{
+  ezAbstractFunctionProperty* SearchForScriptableFunctionOnType(
+    const ezRTTI* pObjectType, ezStringView sFuncName, const ezScriptableFunctionAttribute*& out_pSfAttr)
+  {
+    if (sFuncName.IsEmpty())
+      return nullptr;
+
+    while (pObjectType != nullptr)
+    {
+      for (auto pFunc : pObjectType->GetFunctions())
+      {
+        if (sFuncName != pFunc->GetPropertyName())
+          continue;
+
+        out_pSfAttr = pFunc->GetAttributeByType<ezScriptableFunctionAttribute>();
+
+        if (out_pSfAttr == nullptr)
+          continue;
+
+        return pFunc;
+      }
+
+      pObjectType = pObjectType->GetParentType();
+    }
+
+    return nullptr;
+  }
+
+  /// Returns the member property with the given name or nullptr, if the type has no such property or it is not a member property.
+  ezAbstractMemberProperty* FindMemberProperty(const ezRTTI* pType, const char* szName)
+  {
+    ezAbstractProperty* pAbstract = pType->FindPropertyByName(szName);
+    if (pAbstract == nullptr || pAbstract->GetCategory() != ezPropertyCategory::Member)
+      return nullptr;
+
+    return static_cast<ezAbstractMemberProperty*>(pAbstract);
+  }
+} // namespace
+
+ezVisualScriptProgram::ezVisualScriptProgram() = default;
+ezVisualScriptProgram::~ezVisualScriptProgram() = default;
+
+ezResult ezVisualScriptProgram::Compile(const ezVisualScriptResourceDescriptor& desc)
+{
+  ezVisualScriptInstance::SetupPinDataTypeConversions();
+
+  EZ_ASSERT_DEV(desc.m_Nodes.GetCount() < InvalidNode, "Visual script has too many nodes");
+
+  m_Nodes.SetCount(desc.m_Nodes.GetCount());
+
+  for (ezUInt32 n = 0; n < desc.m_Nodes.GetCount(); ++n)
+  {
+    if (CompileNode(n, desc).Failed())
+      return EZ_FAILURE;
+  }
+
+  CompileConnections(desc);
+  ComputeNodeDependencies(desc);
+
+  m_MessageHandlers = desc.m_MessageHandlers;
+  m_BoolParameters = desc.m_BoolParameters;
+  m_NumberParameters = desc.m_NumberParameters;
+
+  return EZ_SUCCESS;
+}
+
+ezResult ezVisualScriptProgram::CompileNode(ezUInt32 uiNodeIdx, const ezVisualScriptResourceDescriptor& desc)
+{
+  const auto& descNode = desc.m_Nodes[uiNodeIdx];
+  Node& node = m_Nodes[uiNodeIdx];
+
+  node.m_uiFirstProperty = m_Properties.GetCount();
+
+  if (descNode.m_isFunctionCall)
+  {
+    node.m_Kind = NodeKind::FunctionCall;
+    node.m_pNodeType = ezGetStaticRTTI<ezVisualScriptNode_FunctionCall>();
+    node.m_pScriptType = descNode.m_pType;
+
+    if (node.m_pScriptType == nullptr)
+    {
+      ezLog::Error("Expected target object type is null for vis script function call node '{}'", descNode.m_sTypeName);
+    }
+    else
+    {
+      ezStringBuilder sFunc = descNode.m_sTypeName.FindSubString("::");
+      sFunc.Shrink(2, 0);
+
+      const ezScriptableFunctionAttribute* pSfAttr = nullptr;
+      node.m_pFunction = SearchForScriptableFunctionOnType(node.m_pScriptType, sFunc, pSfAttr);
+
+      if (node.m_pFunction == nullptr)
+      {
+        ezLog::Error("Function '{}' does not exist on type '{}'", sFunc, node.m_pScriptType->GetTypeName());
+      }
+      else
+      {
+        // the properties of a function call node are the initial values of all arguments
+        const ezUInt32 uiNumArguments = node.m_pFunction->GetArgumentCount();
+
+        for (ezUInt32 arg = 0; arg < uiNumArguments; ++arg)
+        {
+          Property& prop = m_Properties.ExpandAndGetRef();
+          prop.m_Target = PropertyTarget::FunctionArgument;
+          prop.m_uiArgument = static_cast<ezUInt8>(arg);
+
+          // initialize the variants to the proper type
+          prop.m_Value = ezReflectionUtils::GetDefaultVariantFromType(node.m_pFunction->GetArgumentType(arg)->GetVariantType());
+          ezVisualScriptNode_FunctionCall::EnforceVariantTypeForInputPins(prop.m_Value);
+
+          if (pSfAttr->GetArgumentType(arg) != ezScriptableFunctionAttribute::In) // out or inout
+          {
+            node.m_uiArgumentIsOutParamMask |= EZ_BIT(arg);
+          }
+        }
+
+        for (ezUInt32 i = 0; i < descNode.m_uiNumProperties; ++i)
+        {
+          const auto& descProp = desc.m_Properties[descNode.m_uiFirstProperty + i];
+
+          if (descProp.m_iMappingIndex < 0 || descProp.m_iMappingIndex >= static_cast<ezInt32>(uiNumArguments))
+            continue;
+
+          ezVariant& value = m_Properties[node.m_uiFirstProperty + descProp.m_iMappingIndex].m_Value;
+
+          ezResult couldConvert = EZ_FAILURE;
+          ezVariant convertedValue = descProp.m_Value.ConvertTo(value.GetType(), &couldConvert);
+
+          if (couldConvert.Succeeded())
+          {
+            value = convertedValue;
+          }
+        }
+      }
+    }
+  }
+  else if (descNode.m_pType != nullptr && descNode.m_pType->IsDerivedFrom<ezMessage>() && descNode.m_isMsgSender)
+  {
+    node.m_Kind = NodeKind::MessageSender;
+    node.m_pNodeType = ezGetStaticRTTI<ezVisualScriptNode_MessageSender>();
+    node.m_pScriptType = descNode.m_pType;
+
+    for (ezUInt32 i = 0; i < descNode.m_uiNumProperties; ++i)
+    {
+      const auto& descProp = desc.m_Properties[descNode.m_uiFirstProperty + i];
+
+      if (descNode.m_pType->FindPropertyByName(descProp.m_sName) == nullptr)
+      {
+        // properties that are not part of the message configure the sender node itself
+        if (descProp.m_sName == "Delay" && descProp.m_Value.CanConvertTo<ezTime>())
+        {
+          Property& prop = m_Properties.ExpandAndGetRef();
+          prop.m_Target = PropertyTarget::MessageDelay;
+          prop.m_Value = descProp.m_Value.ConvertTo<ezTime>();
+        }
+        if (descProp.m_sName == "Recursive" && descProp.m_Value.CanConvertTo<bool>())
+        {
+          Property& prop = m_Properties.ExpandAndGetRef();
+          prop.m_Target = PropertyTarget::MessageRecursive;
+          prop.m_Value = descProp.m_Value.ConvertTo<bool>();
+        }
+
+        continue;
+      }
+
+      if (ezAbstractMemberProperty* pMember = FindMemberProperty(descNode.m_pType, descProp.m_sName))
+      {
+        Property& prop = m_Properties.ExpandAndGetRef();
+        prop.m_Target = PropertyTarget::MessageMember;
+        prop.m_pMember = pMember;
+        prop.m_Value = descProp.m_Value;
+      }
+    }
+  }
+  else if (descNode.m_pType != nullptr && descNode.m_pType->IsDerivedFrom<ezMessage>() && descNode.m_isMsgHandler)
+  {
+    node.m_Kind = NodeKind::EventHandler;
+    node.m_pNodeType = ezGetStaticRTTI<ezVisualScriptNode_GenericEvent>();
+    node.m_pScriptType = descNode.m_pType;
+    node.m_sEventType = descNode.m_sTypeName;
+  }
+  else if (descNode.m_pType != nullptr && descNode.m_pType->IsDerivedFrom<ezVisualScriptNode>())
+  {
+    node.m_Kind = NodeKind::Default;
+    node.m_pNodeType = descNode.m_pType;
+
+    for (ezUInt32 i = 0; i < descNode.m_uiNumProperties; ++i)
+    {
+      const auto& descProp = desc.m_Properties[descNode.m_uiFirstProperty + i];
+
+      if (ezAbstractMemberProperty* pMember = FindMemberProperty(descNode.m_pType, descProp.m_sName))
+      {
+        Property& prop = m_Properties.ExpandAndGetRef();
+        prop.m_Target = PropertyTarget::NodeMember;
+        prop.m_pMember = pMember;
+        prop.m_Value = descProp.m_Value;
+      }
+    }
+  }
+  else
+  {
+    ezLog::Error("Invalid node type '{0}' in visual script", descNode.m_sTypeName);
+    return EZ_FAILURE;
+  }
+
+  node.m_uiNumProperties = static_cast<ezUInt16>(m_Properties.GetCount() - node.m_uiFirstProperty);
+
+  // IsManuallyStepped() may be overridden by any node type, so it is queried from a temporary node
+  {
+    ezVisualScriptNode* pNode = node.m_pNodeType->GetAllocator()->Allocate<ezVisualScriptNode>();
+    node.m_bManuallyStepped = pNode->IsManuallyStepped();
+    node.m_pNodeType->GetAllocator()->Deallocate(pNode);
+  }
+
+  return EZ_SUCCESS;
+}
+
+void ezVisualScriptProgram::CompileConnections(const ezVisualScriptResourceDescriptor& desc)
+{
+  // the number of output pins of a node is determined by the highest connected pin
+  for (const auto& con : desc.m_ExecutionPaths)
+  {
+    Node& node = m_Nodes[con.m_uiSourceNode];
+    node.m_uiNumExecutionOutputs = ezMath::Max<ezUInt8>(node.m_uiNumExecutionOutputs, con.m_uiOutputPin + 1);
+  }
+
+  for (const auto& con : desc.m_DataPaths)
+  {
+    Node& node = m_Nodes[con.m_uiSourceNode];
+    node.m_uiNumDataOutputs = ezMath::Max<ezUInt8>(node.m_uiNumDataOutputs, con.m_uiOutputPin + 1);
+  }
+
+  ezUInt32 uiNumExecutionOutputs = 0;
+  ezUInt32 uiNumDataOutputs = 0;
+
+  for (Node& node : m_Nodes)
+  {
+    node.m_uiFirstExecutionOutput = uiNumExecutionOutputs;
+    node.m_uiFirstDataOutput = uiNumDataOutputs;
+
+    uiNumExecutionOutputs += node.m_uiNumExecutionOutputs;
+    uiNumDataOutputs += node.m_uiNumDataOutputs;
+  }
+
+  m_ExecutionOutputs.SetCount(uiNumExecutionOutputs);
+
+  for (const auto& con : desc.m_ExecutionPaths)
+  {
+    ExecutionConnection& output = m_ExecutionOutputs[m_Nodes[con.m_uiSourceNode].m_uiFirstExecutionOutput + con.m_uiOutputPin];
+    output.m_uiTargetNode = con.m_uiTargetNode;
+    output.m_uiTargetPin = con.m_uiInputPin;
+  }
+
+  // sort the data connections by output pin, keeping the order of the connections of each pin
+  m_DataOutputs.SetCount(uiNumDataOutputs);
+
+  for (const auto& con : desc.m_DataPaths)
+  {
+    ++m_DataOutputs[m_Nodes[con.m_uiSourceNode].m_uiFirstDataOutput + con.m_uiOutputPin].m_uiNumConnections;
+  }
+
+  ezUInt32 uiNumDataConnections = 0;
+  for (DataOutputPin& output : m_DataOutputs)
+  {
+    output.m_uiFirstConnection = uiNumDataConnections;
+    uiNumDataConnections += output.m_uiNumConnections;
+    output.m_uiNumConnections = 0;
+  }
+
+  m_DataConnections.SetCountUninitialized(uiNumDataConnections);
+
+  for (const auto& con : desc.m_DataPaths)
+  {
+    DataOutputPin& output = m_DataOutputs[m_Nodes[con.m_uiSourceNode].m_uiFirstDataOutput + con.m_uiOutputPin];
+
+    DataConnection& dataCon = m_DataConnections[output.m_uiFirstConnection + output.m_uiNumConnections];
+    dataCon.m_uiTargetNode = con.m_uiTargetNode;
+    dataCon.m_uiTargetPin = con.m_uiInputPin;
+    dataCon.m_AssignFunc = ezVisualScriptInstance::FindDataPinAssignFunction(
+      (ezVisualScriptDataPinType::Enum)con.m_uiOutputPinType, (ezVisualScriptDataPinType::Enum)con.m_uiInputPinType);
+
+    ++output.m_uiNumConnections;
+  }
+}
+
+void ezVisualScriptProgram::ComputeNodeDependencies(const ezVisualScriptResourceDescriptor& desc)
+{
+  // nodes that are not manually stepped are executed on demand, right before the nodes that use their output values
+  for (const auto& con : desc.m_DataPaths)
+  {
+    if (!m_Nodes[con.m_uiSourceNode].m_bManuallyStepped)
+    {
+      ++m_Nodes[con.m_uiTargetNode].m_uiNumDependencies;
+    }
+  }
+
+  ezUInt32 uiNumDependencies = 0;
+  for (Node& node : m_Nodes)
+  {
+    node.m_uiFirstDependency = uiNumDependencies;
+    uiNumDependencies += node.m_uiNumDependencies;
+    node.m_uiNumDependencies = 0;
+  }
+
+  m_Dependencies.SetCountUninitialized(uiNumDependencies);
+
+  for (const auto& con : desc.m_DataPaths)
+  {
+    if (!m_Nodes[con.m_uiSourceNode].m_bManuallyStepped)
+    {
+      Node& target = m_Nodes[con.m_uiTargetNode];
+      m_Dependencies[target.m_uiFirstDependency + target.m_uiNumDependencies] = con.m_uiSourceNode;
+      ++target.m_uiNumDependencies;
+    }
+  }
+}
+
+ezUInt64 ezVisualScriptProgram::GetHeapMemoryUsage() const
+{
+  return m_Nodes.GetHeapMemoryUsage() + m_Properties.GetHeapMemoryUsage() + m_ExecutionOutputs.GetHeapMemoryUsage() +
+         m_DataOutputs.GetHeapMemoryUsage() + m_DataConnections.GetHeapMemoryUsage() + m_Dependencies.GetHeapMemoryUsage() +
+         m_MessageHandlers.GetHeapMemoryUsage() + m_BoolParameters.GetHeapMemoryUsage() + m_NumberParameters.GetHeapMemoryUsage();
+}
+
+EZ_STATICLINK_FILE(GameEngine, GameEngine_VisualScript_Implementation_VisualScriptProgram);
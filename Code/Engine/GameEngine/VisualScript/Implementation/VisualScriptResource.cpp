@@ -5,6 +5,7 @@
 #include <Core/WorldSerializer/WorldReader.h>
 #include <GameEngine/VisualScript/Nodes/VisualScriptMessageNodes.h>
 #include <GameEngine/VisualScript/VisualScriptNode.h>
+#include <GameEngine/VisualScript/VisualScriptProgram.h>
 #include <GameEngine/VisualScript/VisualScriptResource.h>
 
 //////////////////////////////////////////////////////////////////////////
@@ -25,8 +26,27 @@ ezVisualScriptResource::ezVisualScriptResource()
 
 ezVisualScriptResource::~ezVisualScriptResource() = default;
 
+ezSharedPtr<ezVisualScriptProgram> ezVisualScriptResource::GetProgram() const
+{
+  return m_pProgram;
+}
+
+void ezVisualScriptResource::CompileProgram()
+{
+  // instances that are still running keep their reference to the previous program
+  m_pProgram = EZ_DEFAULT_NEW(ezVisualScriptProgram);
+
+  if (m_pProgram->Compile(m_Descriptor).Failed())
+  {
+    ezLog::Error("Visual script '{}' could not be compiled", GetResourceID());
+    m_pProgram = nullptr;
+  }
+}
+
 ezResourceLoadDesc ezVisualScriptResource::UnloadData(Unload WhatToUnload)
 {
+  m_pProgram = nullptr;
+
   ezResourceLoadDesc res;
   res.m_uiQualityLevelsDiscardable = 0;
   res.m_uiQualityLevelsLoadable = 0;
@@ -57,6 +77,7 @@ ezResourceLoadDesc ezVisualScriptResource::UpdateContent(ezStreamReader* Stream)
   AssetHash.Read(*Stream);
 
   m_Descriptor.Load(*Stream);
+  CompileProgram();
 
   res.m_State = ezResourceState::Loaded;
   return res;
@@ -65,12 +86,19 @@ ezResourceLoadDesc ezVisualScriptResource::UpdateContent(ezStreamReader* Stream)
 void ezVisualScriptResource::UpdateMemoryUsage(MemoryUsage& out_NewMemoryUsage)
 {
   out_NewMemoryUsage.m_uiMemoryCPU = sizeof(ezVisualScriptResourceDescriptor);
+
+  if (m_pProgram != nullptr)
+  {
+    out_NewMemoryUsage.m_uiMemoryCPU += sizeof(ezVisualScriptProgram) + m_pProgram->GetHeapMemoryUsage();
+  }
+
   out_NewMemoryUsage.m_uiMemoryGPU = 0;
 }
 
 EZ_RESOURCE_IMPLEMENT_CREATEABLE(ezVisualScriptResource, ezVisualScriptResourceDescriptor)
 {
   m_Descriptor = descriptor;
+  CompileProgram();
 
   ezResourceLoadDesc res;
   res.m_uiQualityLevelsDiscardable = 0;
@@ -10,6 +10,8 @@
 #include <GameEngine/GameState/StateMap.h>
 #include <Foundation/Containers/ArrayMap.h>
 #include <Core/ResourceManager/ResourceHandle.h>
+#include <Foundation/Types/SharedPtr.h>
+#include <GameEngine/VisualScript/VisualScriptProgram.h>
 
 class ezVisualScriptNode;
 class ezMessage;
@@ -23,9 +25,10 @@ typedef ezUInt32 ezVisualScriptNodeConnectionID;
 typedef ezUInt32 ezVisualScriptPinConnectionID;
 typedef ezTypedResourceHandle<class ezVisualScriptResource> ezVisualScriptResourceHandle;
 
-typedef bool(*ezVisualScriptDataPinAssignFunc)(const void* src, void* dst);
-
 /// \brief An instance of a visual script resource. Stores the current script state and executes nodes.
+///
+/// The graph structure is shared with all other instances of the same script through an ezVisualScriptProgram.
+/// An instance only owns its nodes, which hold the pin values, and its local variables.
 class EZ_GAMEENGINE_DLL ezVisualScriptInstance
 {
 public:
@@ -72,46 +75,19 @@ private:
   friend class ezVisualScriptNode;
 
   void Clear();
-  void ComputeNodeDependencies();
   void ExecuteDependentNodes(ezUInt16 uiNode);
-
-  void ConnectExecutionPins(ezUInt16 uiSourceNode, ezUInt8 uiOutputSlot, ezUInt16 uiTargetNode, ezUInt8 uiTargetPin);
-  void ConnectDataPins(ezUInt16 uiSourceNode, ezUInt8 uiSourcePin, ezVisualScriptDataPinType::Enum sourcePinType, ezUInt16 uiTargetNode, ezUInt8 uiTargetPin, ezVisualScriptDataPinType::Enum targetPinType);
-
-  void CreateVisualScriptNode(ezUInt32 uiNodeIdx, const ezVisualScriptResourceDescriptor& resource);
-  void CreateFunctionMessageNode(ezUInt32 uiNodeIdx, const ezVisualScriptResourceDescriptor& resource);
-  void CreateEventMessageNode(ezUInt32 uiNodeIdx, const ezVisualScriptResourceDescriptor& resource);
-  void CreateFunctionCallNode(ezUInt32 uiNodeIdx, const ezVisualScriptResourceDescriptor& resource);
-  ezAbstractFunctionProperty* SearchForScriptableFunctionOnType(const ezRTTI* pObjectType, ezStringView sFuncName, const ezScriptableFunctionAttribute*& out_pSfAttr) const;
-
-  struct DataPinConnection
-  {
-    EZ_DECLARE_POD_TYPE();
-
-    ezUInt16 m_uiTargetNode;
-    ezUInt8 m_uiTargetPin;
-    ezVisualScriptDataPinAssignFunc m_AssignFunc = nullptr;
-    void* m_pTargetData = nullptr;
-  };
-
-  struct ExecPinConnection
-  {
-    EZ_DECLARE_POD_TYPE();
-
-    ezUInt16 m_uiTargetNode;
-    ezUInt8 m_uiTargetPin;
-  };
+  ezVisualScriptNode* CreateNode(ezUInt32 uiNodeIdx);
 
   ezVisualScriptResourceHandle m_hScriptResource;
+  ezSharedPtr<ezVisualScriptProgram> m_pProgram;
   ezGameObjectHandle m_hOwner;
   ezWorld* m_pWorld = nullptr;
+
+  // The state of this instance, everything else is shared through m_pProgram
   ezDynamicArray<ezVisualScriptNode*> m_Nodes;
-  ezDynamicArray<ezHybridArray<ezUInt16, 2>> m_NodeDependencies;
-  ezHashTable<ezVisualScriptNodeConnectionID, ExecPinConnection > m_ExecutionConnections;
-  ezHashTable<ezVisualScriptPinConnectionID, ezHybridArray<DataPinConnection, 2> > m_DataConnections;
+  ezDynamicArray<void*> m_DataPinTargets; ///< The input pin data of each data connection in ezVisualScriptProgram::m_DataConnections
   ezStateMap m_LocalVariables;
   ezVisualScriptInstanceActivity* m_pActivity = nullptr;
-  const ezArrayMap<ezMessageId, ezUInt16>* m_pMessageHandlers = nullptr;
 
   struct AssignFuncKey
   {
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <Foundation/Containers/ArrayMap.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Types/RefCounted.h>
+#include <Foundation/Types/Variant.h>
+#include <GameEngine/GameEngineDLL.h>
+#include <GameEngine/VisualScript/VisualScriptResource.h>
+
+class ezAbstractMemberProperty;
+class ezAbstractFunctionProperty;
+
+typedef bool (*ezVisualScriptDataPinAssignFunc)(const void* src, void* dst);
+
+/// \brief The compiled form of a visual script graph, which is shared by all ezVisualScriptInstance objects that run the same script.
+///
+/// Everything that does not depend on the state of an instance is resolved once when the script resource is loaded:
+/// the types of the nodes to create, the reflected properties that receive the node property values, the target functions of
+/// function call nodes, the pin connections and the dependencies between data nodes.
+/// Connections are stored in flat arrays that are indexed by node and pin, so executing a script never needs a lookup.
+/// The program is immutable after Compile() and may be used by any number of instances on any thread.
+class EZ_GAMEENGINE_DLL ezVisualScriptProgram : public ezRefCounted
+{
+public:
+  ezVisualScriptProgram();
+  ~ezVisualScriptProgram();
+
+  static constexpr ezUInt16 InvalidNode = 0xFFFF;
+
+  /// \brief Resolves all types, properties and connections of the given graph. Returns EZ_FAILURE if the graph contains unknown node types.
+  ezResult Compile(const ezVisualScriptResourceDescriptor& desc);
+
+  enum class NodeKind : ezUInt8
+  {
+    Default,       ///< A regular ezVisualScriptNode.
+    MessageSender, ///< An ezVisualScriptNode_MessageSender that sends a message of type m_pScriptType.
+    EventHandler,  ///< An ezVisualScriptNode_GenericEvent that handles event messages of type m_pScriptType.
+    FunctionCall,  ///< An ezVisualScriptNode_FunctionCall that calls m_pFunction on objects of type m_pScriptType.
+  };
+
+  enum class PropertyTarget : ezUInt8
+  {
+    NodeMember,        ///< m_pMember of the node is set to the value.
+    MessageMember,     ///< m_pMember of the message of a message sender node is set to the value.
+    MessageDelay,      ///< The delay of a message sender node.
+    MessageRecursive,  ///< The recursive flag of a message sender node.
+    FunctionArgument,  ///< The argument m_uiArgument of a function call node.
+  };
+
+  struct Property
+  {
+    PropertyTarget m_Target = PropertyTarget::NodeMember;
+    ezUInt8 m_uiArgument = 0;
+    ezAbstractMemberProperty* m_pMember = nullptr;
+    ezVariant m_Value;
+  };
+
+  struct ExecutionConnection
+  {
+    EZ_DECLARE_POD_TYPE();
+
+    ezUInt16 m_uiTargetNode = InvalidNode;
+    ezUInt8 m_uiTargetPin = 0;
+  };
+
+  struct DataConnection
+  {
+    EZ_DECLARE_POD_TYPE();
+
+    ezUInt16 m_uiTargetNode;
+    ezUInt8 m_uiTargetPin;
+    ezVisualScriptDataPinAssignFunc m_AssignFunc;
+  };
+
+  /// \brief The range of data connections in m_DataConnections that start at one output pin.
+  struct DataOutputPin
+  {
+    EZ_DECLARE_POD_TYPE();
+
+    ezUInt32 m_uiFirstConnection = 0;
+    ezUInt32 m_uiNumConnections = 0;
+  };
+
+  struct Node
+  {
+    NodeKind m_Kind = NodeKind::Default;
+    bool m_bManuallyStepped = false;
+
+    const ezRTTI* m_pNodeType = nullptr;   ///< The ezVisualScriptNode type that is instantiated.
+    const ezRTTI* m_pScriptType = nullptr; ///< The message type or the expected object type, depending on m_Kind.
+    ezString m_sEventType;                 ///< The event message type name for event handler nodes.
+
+    const ezAbstractFunctionProperty* m_pFunction = nullptr;
+    ezUInt16 m_uiArgumentIsOutParamMask = 0;
+
+    ezUInt32 m_uiFirstProperty = 0;
+    ezUInt32 m_uiFirstExecutionOutput = 0;
+    ezUInt32 m_uiFirstDataOutput = 0;
+    ezUInt32 m_uiFirstDependency = 0;
+    ezUInt16 m_uiNumProperties = 0;
+    ezUInt16 m_uiNumDependencies = 0;
+    ezUInt8 m_uiNumExecutionOutputs = 0;
+    ezUInt8 m_uiNumDataOutputs = 0;
+  };
+
+  ezDynamicArray<Node> m_Nodes;
+  ezDynamicArray<Property> m_Properties;
+
+  /// Indexed by Node::m_uiFirstExecutionOutput + output pin.
+  ezDynamicArray<ExecutionConnection> m_ExecutionOutputs;
+
+  /// Indexed by Node::m_uiFirstDataOutput + output pin.
+  ezDynamicArray<DataOutputPin> m_DataOutputs;
+  ezDynamicArray<DataConnection> m_DataConnections;
+
+  /// The data nodes that need to be executed before a node, in execution order. Indexed by Node::m_uiFirstDependency.
+  ezDynamicArray<ezUInt16> m_Dependencies;
+
+  ezArrayMap<ezMessageId, ezUInt16> m_MessageHandlers;
+
+  ezDynamicArray<ezVisualScriptResourceDescriptor::LocalParameterBool> m_BoolParameters;
+  ezDynamicArray<ezVisualScriptResourceDescriptor::LocalParameterNumber> m_NumberParameters;
+
+  ezUInt64 GetHeapMemoryUsage() const;
+
+private:
+  ezResult CompileNode(ezUInt32 uiNodeIdx, const ezVisualScriptResourceDescriptor& desc);
+  void CompileConnections(const ezVisualScriptResourceDescriptor& desc);
+  void ComputeNodeDependencies(const ezVisualScriptResourceDescriptor& desc);
+};
@@ -3,8 +3,10 @@
 #include <Core/ResourceManager/Resource.h>
 #include <Foundation/Containers/ArrayMap.h>
 #include <Foundation/Reflection/Reflection.h>
+#include <Foundation/Types/SharedPtr.h>
 #include <GameEngine/GameEngineDLL.h>
 
+class ezVisualScriptProgram;
 typedef ezTypedResourceHandle<class ezVisualScriptResource> ezVisualScriptResourceHandle;
 
 /// \brief Describes a visual script graph (node types and connections)
@@ -95,12 +97,18 @@ public:
 
   const ezVisualScriptResourceDescriptor& GetDescriptor() const { return m_Descriptor; }
 
+  /// \brief Returns the compiled program that is shared by all instances of this script. Null if the script could not be compiled.
+  ezSharedPtr<ezVisualScriptProgram> GetProgram() const;
+
 private:
   virtual ezResourceLoadDesc UnloadData(Unload WhatToUnload) override;
   virtual ezResourceLoadDesc UpdateContent(ezStreamReader* Stream) override;
   virtual void UpdateMemoryUsage(MemoryUsage& out_NewMemoryUsage) override;
 
+  void CompileProgram();
+
 private:
   ezVisualScriptResourceDescriptor m_Descriptor;
+  ezSharedPtr<ezVisualScriptProgram> m_pProgram;
 };
 
@@ -0,0 +1,97 @@
+#include <RendererCorePCH.h>
+
+#include <Core/Graphics/OcclusionBuffer.h>
+#include <Core/Messages/UpdateLocalBoundsMessage.h>
+#include <Core/WorldSerializer/WorldReader.h>
+#include <Core/WorldSerializer/WorldWriter.h>
+#include <RendererCore/Components/OccluderComponent.h>
+
+// clang-format off
+EZ_BEGIN_COMPONENT_TYPE(ezOccluderComponent, 1, ezComponentMode::Static)
+{
+  EZ_BEGIN_PROPERTIES
+  {
+    EZ_ACCESSOR_PROPERTY("Extents", GetExtents, SetExtents)->AddAttributes(new ezDefaultValueAttribute(ezVec3(5.0f)), new ezClampValueAttribute(ezVec3(0.0f), ezVariant())),
+  }
+  EZ_END_PROPERTIES;
+  EZ_BEGIN_MESSAGEHANDLERS
+  {
+    EZ_MESSAGE_HANDLER(ezMsgUpdateLocalBounds, OnUpdateLocalBounds),
+  }
+  EZ_END_MESSAGEHANDLERS;
+  EZ_BEGIN_ATTRIBUTES
+  {
+    new ezCategoryAttribute("Rendering"),
+    new ezBoxManipulatorAttribute("Extents"),
+    new ezBoxVisualizerAttribute("Extents", nullptr, ezColor::Gray),
+  }
+  EZ_END_ATTRIBUTES;
+}
+EZ_END_COMPONENT_TYPE
+// clang-format on
+
+ezOccluderComponent::ezOccluderComponent() = default;
+ezOccluderComponent::~ezOccluderComponent() = default;
+
+void ezOccluderComponent::OnActivated()
+{
+  GetOwner()->UpdateLocalBounds();
+}
+
+void ezOccluderComponent::OnDeactivated()
+{
+  GetOwner()->UpdateLocalBounds();
+}
+
+void ezOccluderComponent::SetExtents(const ezVec3& value)
+{
+  m_vExtents = value.CompMax(ezVec3::ZeroVector());
+
+  if (IsActiveAndInitialized())
+  {
+    GetOwner()->UpdateLocalBounds();
+  }
+}
+
+const ezVec3& ezOccluderComponent::GetExtents() const
+{
+  return m_vExtents;
+}
+
+void ezOccluderComponent::RasterizeOccluder(ezOcclusionBuffer& buffer) const
+{
+  ezBoundingBox box;
+  box.SetCenterAndHalfExtents(ezVec3::ZeroVector(), m_vExtents * 0.5f);
+
+  buffer.RasterizeBox(box, GetOwner()->GetGlobalTransform().GetAsMat4());
+}
+
+void ezOccluderComponent::OnUpdateLocalBounds(ezMsgUpdateLocalBounds& msg)
+{
+  if (IsActive() && !m_vExtents.IsZero())
+  {
+    msg.AddBounds(ezBoundingBox(m_vExtents * -0.5f, m_vExtents * 0.5f), ezDefaultSpatialDataCategories::Occluder);
+  }
+}
+
+void ezOccluderComponent::SerializeComponent(ezWorldWriter& stream) const
+{
+  SUPER::SerializeComponent(stream);
+
+  ezStreamWriter& s = stream.GetStream();
+
+  s << m_vExtents;
+}
+
+void ezOccluderComponent::DeserializeComponent(ezWorldReader& stream)
+{
+  SUPER::DeserializeComponent(stream);
+  // const ezUInt32 uiVersion = stream.GetComponentTypeVersion(GetStaticRTTI());
+
+  ezStreamReader& s = stream.GetStream();
+
+  s >> m_vExtents;
+}
+
+
+EZ_STATICLINK_FILE(RendererCore, RendererCore_Components_Implementation_OccluderComponent);
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Core/World/World.h>
+#include <RendererCore/RendererCoreDLL.h>
+
+struct ezMsgUpdateLocalBounds;
+class ezOcclusionBuffer;
+
+typedef ezComponentManager<class ezOccluderComponent, ezBlockStorageType::FreeList> ezOccluderComponentManager;
+
+/// \brief Marks a box shaped volume as opaque for the CPU occlusion culling of the render pipeline.
+///
+/// Objects that are completely hidden behind occluders in a view are not extracted for rendering.
+/// The box must not be larger than the solid geometry it stands in for, e.g. it should be placed inside of walls,
+/// otherwise objects behind it are culled although they are actually visible.
+class EZ_RENDERERCORE_DLL ezOccluderComponent : public ezComponent
+{
+  EZ_DECLARE_COMPONENT_TYPE(ezOccluderComponent, ezComponent, ezOccluderComponentManager);
+
+  //////////////////////////////////////////////////////////////////////////
+  // ezComponent
+
+public:
+  virtual void SerializeComponent(ezWorldWriter& stream) const override;
+  virtual void DeserializeComponent(ezWorldReader& stream) override;
+
+protected:
+  virtual void OnActivated() override;
+  virtual void OnDeactivated() override;
+
+
+  //////////////////////////////////////////////////////////////////////////
+  // ezOccluderComponent
+
+public:
+  ezOccluderComponent();
+  ~ezOccluderComponent();
+
+  void SetExtents(const ezVec3& value); // [ property ]
+  const ezVec3& GetExtents() const;     // [ property ]
+
+  /// \brief Rasterizes the occluder box with the current global transform of the owner into the given buffer.
+  void RasterizeOccluder(ezOcclusionBuffer& buffer) const;
+
+protected:
+  void OnUpdateLocalBounds(ezMsgUpdateLocalBounds& msg);
+
+  ezVec3 m_vExtents = ezVec3(5.0f);
+};
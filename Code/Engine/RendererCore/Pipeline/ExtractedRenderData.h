@@ -65,6 +65,12 @@ public:
   void AddRenderData(const ezRenderData* pRenderData, ezRenderData::Category category);
   void AddFrameData(const ezRenderData* pFrameData);
 
+  /// \brief Adds the render data and frame data of another extracted render data, e.g. one that was filled by a separate extraction task.
+  ///
+  /// The sorting keys are taken over as they are, so the other data must have been extracted with the same camera.
+  /// Must be called before SortAndBatch.
+  void MergeRenderData(const ezExtractedRenderData& other);
+
   void SortAndBatch();
 
   void Clear();
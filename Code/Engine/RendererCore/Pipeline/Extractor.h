@@ -1,6 +1,6 @@
 #pragma once
 
-#include <RendererCore/Pipeline/RenderData.h>
+#include <RendererCore/Pipeline/ExtractedRenderData.h>
 #include <Foundation/Strings/HashedString.h>
 
 class EZ_RENDERERCORE_DLL ezExtractor : public ezReflectedClass
@@ -32,6 +32,12 @@ protected:
   /// \brief extracts the render data for the given object.
   void ExtractRenderData(const ezView& view, const ezGameObject* pObject, ezMsgExtractRenderData& msg, ezExtractedRenderData& extractedRenderData) const;
 
+  /// \brief extracts the render data for the given object and adds the number of cached and uncached render data to the given counters.
+  ///
+  /// Does not modify the extractor, so it can be called for different objects from multiple threads at the same time.
+  void ExtractRenderData(const ezView& view, const ezGameObject* pObject, ezMsgExtractRenderData& msg, ezExtractedRenderData& extractedRenderData,
+    ezUInt32& inout_uiNumCachedRenderData, ezUInt32& inout_uiNumUncachedRenderData) const;
+
 private:
   friend class ezRenderPipeline;
 
@@ -57,6 +63,20 @@ public:
 
   virtual void Extract(const ezView& view, const ezDynamicArray<const ezGameObject*>& visibleObjects,
     ezExtractedRenderData& extractedRenderData) override;
+
+private:
+  /// \brief A range of the visible objects that is extracted by one task into its own render data.
+  struct ExtractionChunk
+  {
+    ezArrayPtr<const ezGameObject* const> m_Objects;
+    ezExtractedRenderData m_RenderData;
+    ezUInt32 m_uiNumCachedRenderData = 0;
+    ezUInt32 m_uiNumUncachedRenderData = 0;
+  };
+
+  void ExtractChunk(const ezView& view, ExtractionChunk& chunk) const;
+
+  ezDynamicArray<ExtractionChunk> m_Chunks;
 };
 
 class EZ_RENDERERCORE_DLL ezSelectedObjectsExtractor : public ezExtractor
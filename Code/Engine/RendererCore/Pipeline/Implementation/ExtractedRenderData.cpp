@@ -19,6 +19,21 @@ void ezExtractedRenderData::AddFrameData(const ezRenderData* pFrameData)
   m_FrameData.PushBack(pFrameData);
 }
 
+void ezExtractedRenderData::MergeRenderData(const ezExtractedRenderData& other)
+{
+  m_DataPerCategory.EnsureCount(other.m_DataPerCategory.GetCount());
+
+  for (ezUInt32 uiCategory = 0; uiCategory < other.m_DataPerCategory.GetCount(); ++uiCategory)
+  {
+    auto& dataPerCategory = m_DataPerCategory[uiCategory];
+    EZ_ASSERT_DEBUG(dataPerCategory.m_Batches.IsEmpty(), "Render data must be merged before SortAndBatch is called");
+
+    dataPerCategory.m_SortableRenderData.PushBackRange(other.m_DataPerCategory[uiCategory].m_SortableRenderData);
+  }
+
+  m_FrameData.PushBackRange(other.m_FrameData);
+}
+
 void ezExtractedRenderData::SortAndBatch()
 {
   EZ_PROFILE_SCOPE("SortAndBatch");
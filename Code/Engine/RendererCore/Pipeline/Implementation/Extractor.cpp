@@ -7,8 +7,11 @@
 #include <Core/World/World.h>
 #include <Core/World/SpatialSystem_RegularGrid.h>
 #include <Foundation/Configuration/CVar.h>
+#include <Foundation/Threading/TaskSystem.h>
 #include <RendererCore/Pipeline/ExtractedRenderData.h>
 
+ezCVarBool CVarParallelExtraction("r_ParallelExtraction", true, ezCVarFlags::Default, "Extracts the render data of the visible objects of a view in parallel");
+
 #if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
   ezCVarBool CVarVisBounds("r_VisBounds", false, ezCVarFlags::Default, "Enables debug visualization of object bounds");
   ezCVarBool CVarVisLocalBBox("r_VisLocalBBox", false, ezCVarFlags::Default, "Enables debug visualization of object local bounding box");
@@ -22,6 +25,11 @@
 
 namespace
 {
+  enum
+  {
+    ObjectsPerExtractionChunk = 256
+  };
+
 #if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
   void VisualizeSpatialData(const ezView& view)
   {
@@ -80,6 +88,18 @@ namespace
       }
     }
   }
+
+  void VisualizeObjectIfRequested(const ezView& view, const ezGameObject* pObject)
+  {
+    if (CVarVisBounds || CVarVisLocalBBox || CVarVisSpatialData)
+    {
+      if ((CVarVisObjectName.GetValue().IsEmpty() || ezStringUtils::FindSubString_NoCase(pObject->GetName(), CVarVisObjectName.GetValue()) != nullptr) &&
+        !CVarVisObjectSelection)
+      {
+        VisualizeObject(view, pObject);
+      }
+    }
+  }
 #endif
 }
 
@@ -142,6 +162,18 @@ bool ezExtractor::FilterByViewTags(const ezView& view, const ezGameObject* pObje
 }
 
 void ezExtractor::ExtractRenderData(const ezView& view, const ezGameObject* pObject, ezMsgExtractRenderData& msg, ezExtractedRenderData& extractedRenderData) const
+{
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+  ExtractRenderData(view, pObject, msg, extractedRenderData, m_uiNumCachedRenderData, m_uiNumUncachedRenderData);
+#else
+  ezUInt32 uiNumCachedRenderData = 0;
+  ezUInt32 uiNumUncachedRenderData = 0;
+  ExtractRenderData(view, pObject, msg, extractedRenderData, uiNumCachedRenderData, uiNumUncachedRenderData);
+#endif
+}
+
+void ezExtractor::ExtractRenderData(const ezView& view, const ezGameObject* pObject, ezMsgExtractRenderData& msg, ezExtractedRenderData& extractedRenderData,
+  ezUInt32& inout_uiNumCachedRenderData, ezUInt32& inout_uiNumUncachedRenderData) const
 {
   if (FilterByViewTags(view, pObject))
   {
@@ -233,10 +265,8 @@ void ezExtractor::ExtractRenderData(const ezView& view, const ezGameObject* pObj
     }
   }
 
-#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
-  m_uiNumCachedRenderData += msg.m_ExtractedRenderData.GetCount() - uiNumUncachedRenderData;
-  m_uiNumUncachedRenderData += uiNumUncachedRenderData;
-#endif
+  inout_uiNumCachedRenderData += msg.m_ExtractedRenderData.GetCount() - uiNumUncachedRenderData;
+  inout_uiNumUncachedRenderData += uiNumUncachedRenderData;
 }
 
 void ezExtractor::Extract(const ezView& view, const ezDynamicArray<const ezGameObject*>& visibleObjects, ezExtractedRenderData& extractedRenderData)
@@ -263,9 +293,6 @@ ezVisibleObjectsExtractor::ezVisibleObjectsExtractor(const char* szName)
 void ezVisibleObjectsExtractor::Extract(const ezView& view, const ezDynamicArray<const ezGameObject*>& visibleObjects,
   ezExtractedRenderData& extractedRenderData)
 {
-  ezMsgExtractRenderData msg;
-  msg.m_pView = &view;
-
   EZ_LOCK(view.GetWorld()->GetReadMarker());
 
   #if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
@@ -275,20 +302,63 @@ void ezVisibleObjectsExtractor::Extract(const ezView& view, const ezDynamicArray
     m_uiNumUncachedRenderData = 0;
   #endif
 
-  for (auto pObject : visibleObjects)
+  const ezUInt32 uiNumObjects = visibleObjects.GetCount();
+  const ezUInt32 uiNumChunks = (uiNumObjects + ObjectsPerExtractionChunk - 1) / ObjectsPerExtractionChunk;
+
+  if (uiNumChunks > 1 && CVarParallelExtraction)
   {
-    ExtractRenderData(view, pObject, msg, extractedRenderData);
+    // Every chunk is extracted by a separate task into its own render data, which is merged afterwards.
+    m_Chunks.SetCount(uiNumChunks);
 
-    #if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
-      if (CVarVisBounds || CVarVisLocalBBox || CVarVisSpatialData)
+    for (ezUInt32 i = 0; i < uiNumChunks; ++i)
+    {
+      ExtractionChunk& chunk = m_Chunks[i];
+
+      const ezUInt32 uiFirstObject = i * ObjectsPerExtractionChunk;
+      chunk.m_Objects = visibleObjects.GetArrayPtr().GetSubArray(uiFirstObject, ezMath::Min<ezUInt32>(ObjectsPerExtractionChunk, uiNumObjects - uiFirstObject));
+
+      // the sorting keys are computed with the camera when render data is added
+      chunk.m_RenderData.Clear();
+      chunk.m_RenderData.SetCamera(extractedRenderData.GetCamera());
+      chunk.m_uiNumCachedRenderData = 0;
+      chunk.m_uiNumUncachedRenderData = 0;
+    }
+
+    ezParallelForParams params;
+    params.nestingMode = ezTaskNesting::Maybe; // components might wait for resources during extraction
+
+    ezTaskSystem::ParallelForSingle(m_Chunks.GetArrayPtr(), [this, &view](ExtractionChunk& chunk) {
+      ExtractChunk(view, chunk);
+    }, "Extract Render Data Chunk", params);
+
+    // merge in the order of the visible objects, so the result does not depend on the order in which the chunks were finished
+    {
+      EZ_PROFILE_SCOPE("Merge Render Data");
+
+      for (ExtractionChunk& chunk : m_Chunks)
       {
-        if ((CVarVisObjectName.GetValue().IsEmpty() || ezStringUtils::FindSubString_NoCase(pObject->GetName(), CVarVisObjectName.GetValue()) != nullptr) &&
-          !CVarVisObjectSelection)
-        {
-          VisualizeObject(view, pObject);
-        }
+        extractedRenderData.MergeRenderData(chunk.m_RenderData);
+
+        #if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+          m_uiNumCachedRenderData += chunk.m_uiNumCachedRenderData;
+          m_uiNumUncachedRenderData += chunk.m_uiNumUncachedRenderData;
+        #endif
       }
-    #endif
+    }
+  }
+  else
+  {
+    ezMsgExtractRenderData msg;
+    msg.m_pView = &view;
+
+    for (auto pObject : visibleObjects)
+    {
+      ExtractRenderData(view, pObject, msg, extractedRenderData);
+
+      #if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+        VisualizeObjectIfRequested(view, pObject);
+      #endif
+    }
   }
 
 #if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
@@ -311,6 +381,21 @@ void ezVisibleObjectsExtractor::Extract(const ezView& view, const ezDynamicArray
 #endif
 }
 
+void ezVisibleObjectsExtractor::ExtractChunk(const ezView& view, ExtractionChunk& chunk) const
+{
+  ezMsgExtractRenderData msg;
+  msg.m_pView = &view;
+
+  for (auto pObject : chunk.m_Objects)
+  {
+    ExtractRenderData(view, pObject, msg, chunk.m_RenderData, chunk.m_uiNumCachedRenderData, chunk.m_uiNumUncachedRenderData);
+
+    #if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+      VisualizeObjectIfRequested(view, pObject);
+    #endif
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 EZ_BEGIN_DYNAMIC_REFLECTED_TYPE(ezSelectedObjectsExtractor, 1, ezRTTINoAllocator)
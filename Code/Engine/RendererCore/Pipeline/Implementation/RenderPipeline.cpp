@@ -1,7 +1,9 @@
 #include <RendererCorePCH.h>
 
+#include <Core/Graphics/OcclusionBuffer.h>
 #include <Core/World/World.h>
 #include <Foundation/Time/Clock.h>
+#include <RendererCore/Components/OccluderComponent.h>
 #include <RendererCore/Debug/DebugRenderer.h>
 #include <RendererCore/GPUResourcePool/GPUResourcePool.h>
 #include <RendererCore/Pipeline/Extractor.h>
@@ -20,12 +22,15 @@ ezCVarBool ezRenderPipeline::s_DebugCulling("r_DebugCulling", false, ezCVarFlags
 ezCVarBool CVarCullingStats("r_CullingStats", false, ezCVarFlags::Default, "Display some stats of the visibility culling");
 #endif
 
+ezCVarBool CVarOcclusionCulling("r_OcclusionCulling", true, ezCVarFlags::Default, "Enables CPU occlusion culling against occluder components");
+
 ezRenderPipeline::ezRenderPipeline()
   : m_PipelineState(PipelineState::Uninitialized)
 {
   m_CurrentExtractThread = (ezThreadID)0;
   m_CurrentRenderThread = (ezThreadID)0;
   m_uiLastExtractionFrame = -1;
+  m_uiPrecomputedVisibleObjectsFrame = -1;
   m_uiLastRenderFrame = -1;
 
 #if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
@@ -932,16 +937,29 @@ void ezRenderPipeline::FindVisibleObjects(const ezView& view)
   ezFrustum frustum;
   view.ComputeCullingFrustum(frustum);
 
+  // the objects were already determined together with other views by ezRenderWorld::AddViewsToRender()
+  const bool bPrecomputed = (m_uiPrecomputedVisibleObjectsFrame == ezRenderWorld::GetFrameCounter());
+  if (bPrecomputed)
+  {
+    m_visibleObjects.Swap(m_precomputedVisibleObjects);
+    m_precomputedVisibleObjects.Clear();
+    m_uiPrecomputedVisibleObjectsFrame = -1;
+  }
+
   EZ_LOCK(view.GetWorld()->GetReadMarker());
 
 #if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
   const bool bIsMainView =
     (view.GetCameraUsageHint() == ezCameraUsageHint::MainView || view.GetCameraUsageHint() == ezCameraUsageHint::EditorView);
-  const bool bRecordStats = CVarCullingStats && bIsMainView;
+  const bool bRecordStats = CVarCullingStats && bIsMainView && !bPrecomputed;
   ezSpatialSystem::QueryStats stats;
 
-  ezUInt32 uiCategoryBitmask = ezDefaultSpatialDataCategories::RenderStatic.GetBitmask() | ezDefaultSpatialDataCategories::RenderDynamic.GetBitmask();
-  view.GetWorld()->GetSpatialSystem()->FindVisibleObjects(frustum, uiCategoryBitmask, m_visibleObjects, bRecordStats ? &stats : nullptr);
+  if (!bPrecomputed)
+  {
+    view.GetWorld()->GetSpatialSystem()->FindVisibleObjects(frustum, GetVisibleObjectsCategoryBitmask(), m_visibleObjects, bRecordStats ? &stats : nullptr);
+  }
+
+  const ezUInt32 uiNumObjectsOccluded = ApplyOcclusionCulling(view, frustum);
 
   ezViewHandle hView = view.GetHandle();
 
@@ -965,17 +983,108 @@ void ezRenderPipeline::FindVisibleObjects(const ezView& view)
     sb.Format("Num Objects Passed: {0}", stats.m_uiNumObjectsPassed);
     ezDebugRenderer::Draw2DText(hView, sb, ezVec2I32(10, 260), ezColor::LimeGreen);
 
+    sb.Format("Num Objects Occluded: {0}", uiNumObjectsOccluded);
+    ezDebugRenderer::Draw2DText(hView, sb, ezVec2I32(10, 280), ezColor::LimeGreen);
+
     // Exponential moving average for better readability.
     m_AverageCullingTime = ezMath::Lerp(m_AverageCullingTime, stats.m_TimeTaken, 0.05f);
 
     sb.Format("Time Taken: {0}ms", m_AverageCullingTime.GetMilliseconds());
-    ezDebugRenderer::Draw2DText(hView, sb, ezVec2I32(10, 280), ezColor::LimeGreen);
+    ezDebugRenderer::Draw2DText(hView, sb, ezVec2I32(10, 300), ezColor::LimeGreen);
   }
 #else
-  view.GetWorld()->GetSpatialSystem().FindVisibleObjects(frustum, m_visibleObjects, nullptr);
+  if (!bPrecomputed)
+  {
+    view.GetWorld()->GetSpatialSystem()->FindVisibleObjects(frustum, GetVisibleObjectsCategoryBitmask(), m_visibleObjects, nullptr);
+  }
+
+  ApplyOcclusionCulling(view, frustum);
 #endif
 }
 
+// static
+ezUInt32 ezRenderPipeline::GetVisibleObjectsCategoryBitmask()
+{
+  return ezDefaultSpatialDataCategories::RenderStatic.GetBitmask() | ezDefaultSpatialDataCategories::RenderDynamic.GetBitmask();
+}
+
+void ezRenderPipeline::SetPrecomputedVisibleObjects(ezDynamicArray<const ezGameObject*>& objects)
+{
+  m_precomputedVisibleObjects.Swap(objects);
+  m_uiPrecomputedVisibleObjectsFrame = ezRenderWorld::GetFrameCounter();
+}
+
+ezUInt32 ezRenderPipeline::ApplyOcclusionCulling(const ezView& view, const ezFrustum& frustum)
+{
+  if (!CVarOcclusionCulling || m_visibleObjects.IsEmpty())
+    return 0;
+
+  // The occlusion buffer is rasterized from a single view projection. Stereo views would need one buffer per eye and shadow views
+  // see the scene from the light, where occluders placed for the camera do not reliably hide anything.
+  if (view.GetCamera()->IsStereoscopic() || view.GetCameraUsageHint() == ezCameraUsageHint::Shadow)
+    return 0;
+
+  m_visibleOccluders.Clear();
+  view.GetWorld()->GetSpatialSystem()->FindVisibleObjects(frustum, ezDefaultSpatialDataCategories::Occluder.GetBitmask(), m_visibleOccluders);
+
+  if (m_visibleOccluders.IsEmpty())
+    return 0;
+
+  EZ_PROFILE_SCOPE("Occlusion Culling");
+
+  // Low resolution with the aspect ratio of the view is enough for large occluders like walls
+  const ezRectFloat& viewport = view.GetViewport();
+  const ezUInt32 uiWidth = 256;
+  const ezUInt32 uiHeight = ezMath::Clamp((ezUInt32)(uiWidth * viewport.height / ezMath::Max(viewport.width, 1.0f)), 16u, 512u);
+
+  if (m_pOcclusionBuffer == nullptr)
+  {
+    m_pOcclusionBuffer = EZ_DEFAULT_NEW(ezOcclusionBuffer);
+  }
+
+  if (m_pOcclusionBuffer->GetWidth() != uiWidth || m_pOcclusionBuffer->GetHeight() != uiHeight)
+  {
+    m_pOcclusionBuffer->Initialize(uiWidth, uiHeight);
+  }
+
+  m_pOcclusionBuffer->BeginView(view.GetViewProjectionMatrix(ezCameraEye::Left));
+
+  for (const ezGameObject* pOccluderObject : m_visibleOccluders)
+  {
+    for (const ezComponent* pComponent : pOccluderObject->GetComponents())
+    {
+      const ezOccluderComponent* pOccluder = ezDynamicCast<const ezOccluderComponent*>(pComponent);
+      if (pOccluder != nullptr && pOccluder->IsActive())
+      {
+        pOccluder->RasterizeOccluder(*m_pOcclusionBuffer);
+      }
+    }
+  }
+
+  if (!m_pOcclusionBuffer->HasOccluders())
+    return 0;
+
+  const ezUInt32 uiNumObjects = m_visibleObjects.GetCount();
+  ezUInt32 uiNumVisible = 0;
+
+  for (ezUInt32 i = 0; i < uiNumObjects; ++i)
+  {
+    const ezGameObject* pObject = m_visibleObjects[i];
+
+    // Always visible objects have no valid bounds
+    const ezBoundingBoxSphere bounds = pObject->GetGlobalBounds();
+    if (!bounds.IsValid() || m_pOcclusionBuffer->IsBoxVisible(bounds.GetBox()))
+    {
+      m_visibleObjects[uiNumVisible] = pObject;
+      ++uiNumVisible;
+    }
+  }
+
+  m_visibleObjects.SetCountUninitialized(uiNumVisible);
+
+  return uiNumObjects - uiNumVisible;
+}
+
 void ezRenderPipeline::Render(ezRenderContext* pRenderContext)
 {
   EZ_PROFILE_AND_MARKER(pRenderContext->GetGALContext(), m_sName.GetData());
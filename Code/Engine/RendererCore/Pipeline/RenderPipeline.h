@@ -11,6 +11,8 @@ class ezProfilingId;
 class ezView;
 class ezRenderPipelinePass;
 class ezFrameDataProviderBase;
+class ezFrustum;
+class ezOcclusionBuffer;
 
 class EZ_RENDERERCORE_DLL ezRenderPipeline : public ezRefCounted
 {
@@ -79,6 +81,12 @@ private:
 
   void ExtractData(const ezView& view);
   void FindVisibleObjects(const ezView& view);
+  ezUInt32 ApplyOcclusionCulling(const ezView& view, const ezFrustum& frustum);
+
+  static ezUInt32 GetVisibleObjectsCategoryBitmask();
+
+  /// \brief Used by ezRenderWorld::AddViewsToRender(), the objects replace the spatial query of the next extraction in this frame.
+  void SetPrecomputedVisibleObjects(ezDynamicArray<const ezGameObject*>& objects);
 
   void Render(ezRenderContext* pRenderer);
 
@@ -90,6 +98,12 @@ private: // Member data
   // Pipeline render data
   ezExtractedRenderData m_Data[2];
   ezDynamicArray<const ezGameObject*> m_visibleObjects;
+  ezDynamicArray<const ezGameObject*> m_precomputedVisibleObjects;
+  ezUInt64 m_uiPrecomputedVisibleObjectsFrame;
+
+  // Occlusion culling
+  ezDynamicArray<const ezGameObject*> m_visibleOccluders;
+  ezUniquePtr<ezOcclusionBuffer> m_pOcclusionBuffer;
 
 #if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
   ezTime m_AverageCullingTime;
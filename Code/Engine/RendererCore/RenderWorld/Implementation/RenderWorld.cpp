@@ -1,5 +1,6 @@
 #include <RendererCorePCH.h>
 
+#include <Core/World/World.h>
 #include <Foundation/Configuration/CVar.h>
 #include <Foundation/Configuration/Startup.h>
 #include <Foundation/Memory/CommonAllocators.h>
@@ -239,6 +240,7 @@ void ezRenderWorld::CacheRenderData(const ezView& view, const ezGameObjectHandle
       return;
     }
 
+    // the increment reserves a slot exclusively for this call, so parallel extraction tasks never write to the same entry
     uiNewEntriesCount = view.m_pRenderDataCache->m_NewEntriesCount.Increment();
     if (uiNewEntriesCount <= MaxNumNewCacheEntries)
     {
@@ -382,6 +384,51 @@ void ezRenderWorld::AddViewToRender(const ezViewHandle& hView)
   }
 }
 
+void ezRenderWorld::AddViewsToRender(ezArrayPtr<const ezViewHandle> views)
+{
+  ezHybridArray<ezView*, 8> batchViews;
+  ezHybridArray<ezFrustum, 8> frusta;
+
+  for (const ezViewHandle& hView : views)
+  {
+    ezView* pView = nullptr;
+    if (!TryGetView(hView, pView) || !pView->IsValid() || pView->m_pRenderPipeline == nullptr)
+      continue;
+
+    if (!batchViews.IsEmpty() && batchViews[0]->GetWorld() != pView->GetWorld())
+      continue;
+
+    batchViews.PushBack(pView);
+    pView->ComputeCullingFrustum(frusta.ExpandAndGetRef());
+  }
+
+  if (batchViews.GetCount() > 1)
+  {
+    EZ_PROFILE_SCOPE("Batched Visibility Culling");
+
+    ezHybridArray<ezDynamicArray<const ezGameObject*>, 8> visibleObjects;
+    visibleObjects.SetCount(batchViews.GetCount());
+
+    {
+      const ezWorld* pWorld = batchViews[0]->GetWorld();
+      EZ_LOCK(pWorld->GetReadMarker());
+
+      pWorld->GetSpatialSystem()->FindVisibleObjects(frusta, ezRenderPipeline::GetVisibleObjectsCategoryBitmask(), visibleObjects);
+    }
+
+    // the views pick up their objects when they are extracted, which is started in AddViewToRender
+    for (ezUInt32 i = 0; i < batchViews.GetCount(); ++i)
+    {
+      batchViews[i]->m_pRenderPipeline->SetPrecomputedVisibleObjects(visibleObjects[i]);
+    }
+  }
+
+  for (const ezViewHandle& hView : views)
+  {
+    AddViewToRender(hView);
+  }
+}
+
 void ezRenderWorld::ExtractMainViews()
 {
   EZ_ASSERT_DEV(!s_bInExtract, "ExtractMainViews must not be called from multiple threads.");
@@ -50,6 +50,9 @@ public:
   static void ClearMainViews();
   static ezArrayPtr<ezViewHandle> GetMainViews();
 
+  /// \brief Queues the render data of a static object to be cached for the given view at the end of the frame.
+  ///
+  /// Can be called by multiple extraction tasks of the same view at the same time.
   static void CacheRenderData(const ezView& view, const ezGameObjectHandle& hOwnerObject, const ezComponentHandle& hOwnerComponent,
     ezArrayPtr<ezInternal::RenderDataCacheEntry> cacheEntries);
 
@@ -61,6 +64,11 @@ public:
 
   static void AddViewToRender(const ezViewHandle& hView);
 
+  /// \brief Adds several views of the same world, e.g. the cascades of a directional light shadow, in one go.
+  ///
+  /// The visible objects of all views are determined with a single batched spatial query instead of one query per view.
+  static void AddViewsToRender(ezArrayPtr<const ezViewHandle> views);
+
   static void ExtractMainViews();
 
   static void Render(ezRenderContext* pRenderContext);
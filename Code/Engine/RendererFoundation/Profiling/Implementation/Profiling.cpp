@@ -101,11 +101,11 @@ ezProfilingScopeAndMarker::ezProfilingScopeAndMarker(ezGALContext* pGALContext,
     : ezProfilingScope(szName, nullptr)
     , m_pGALContext(pGALContext)
 {
-  m_pGALContext->PushMarker(m_szName);
+  m_pGALContext->PushMarker(szName);
 
   auto& timingScope = GPUProfilingSystem::AllocateScope();
   timingScope.m_BeginTimestamp = m_pGALContext->InsertTimestamp();
-  ezStringUtils::Copy(timingScope.m_szName, EZ_ARRAY_SIZE(timingScope.m_szName), m_szName);
+  ezStringUtils::Copy(timingScope.m_szName, EZ_ARRAY_SIZE(timingScope.m_szName), szName);
 
   m_pTimingScope = &timingScope;
 }
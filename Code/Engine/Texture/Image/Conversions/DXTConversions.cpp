@@ -4,7 +4,10 @@
 #include <Texture/Image/Conversions/PixelConversions.h>
 #include <Texture/Image/ImageConversion.h>
 #include <Foundation/Math/Color16f.h>
+#include <Foundation/SimdMath/SimdVec4f.h>
 #include <Foundation/Strings/StringBuilder.h>
+#include <Foundation/Threading/AtomicInteger.h>
+#include <Foundation/Threading/TaskSystem.h>
 
 #if EZ_SSE_LEVEL >= EZ_SSE_41 && EZ_SIMD_IMPLEMENTATION == EZ_SIMD_IMPLEMENTATION_SSE
 #  define EZ_SUPPORTS_BC4_COMPRESSOR
@@ -1689,6 +1692,1394 @@ EZ_TEXTURE_DLL void ezDecompressBlockBC7(const ezUInt8* pSource, ezColorBaseUB*
   }
 } // namespace
 
+//////////////////////////////////////////////////////////////////////////
+// Block compression
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+  ezAtomicInteger32 s_iBlockCompressionQuality(ezBlockCompressionQuality::Default);
+
+  EZ_ALWAYS_INLINE ezUInt32 colorDistanceRGB(const ezColorBaseUB& a, const ezColorBaseUB& b)
+  {
+    const ezInt32 dr = ezInt32(a.r) - ezInt32(b.r);
+    const ezInt32 dg = ezInt32(a.g) - ezInt32(b.g);
+    const ezInt32 db = ezInt32(a.b) - ezInt32(b.b);
+    return dr * dr + dg * dg + db * db;
+  }
+
+  EZ_ALWAYS_INLINE ezUInt32 colorDistanceRGBA(const ezColorBaseUB& a, const ezColorBaseUB& b)
+  {
+    const ezInt32 da = ezInt32(a.a) - ezInt32(b.a);
+    return colorDistanceRGB(a, b) + da * da;
+  }
+
+  EZ_ALWAYS_INLINE ezColorBaseUB toColorUB(const ezSimdVec4f& v)
+  {
+    float f[4];
+    v.Store<4>(f);
+
+    return ezColorBaseUB(ezUInt8(ezMath::Clamp(f[0] + 0.5f, 0.0f, 255.0f)), ezUInt8(ezMath::Clamp(f[1] + 0.5f, 0.0f, 255.0f)),
+      ezUInt8(ezMath::Clamp(f[2] + 0.5f, 0.0f, 255.0f)), ezUInt8(ezMath::Clamp(f[3] + 0.5f, 0.0f, 255.0f)));
+  }
+
+  void setBits(ezUInt8* pBlock, ezUInt32& inout_uiStartBit, ezUInt32 uiNumBits, ezUInt32 uiValue)
+  {
+    for (ezUInt32 i = 0; i < uiNumBits; ++i, ++inout_uiStartBit)
+    {
+      if ((uiValue >> i) & 1)
+      {
+        pBlock[inout_uiStartBit >> 3] |= ezUInt8(1 << (inout_uiStartBit & 7));
+      }
+    }
+  }
+
+  /// Computes the mean of the points and the direction in which they vary the most, using a few iterations of the power method
+  /// on the covariance matrix. The axis is zero if all points are equal.
+  void computePrincipalAxis(
+    const ezSimdVec4f* pPoints, ezUInt32 uiNumPoints, ezUInt32 uiNumIterations, ezSimdVec4f& out_vMean, ezSimdVec4f& out_vAxis)
+  {
+    ezSimdVec4f vSum = ezSimdVec4f::ZeroVector();
+    for (ezUInt32 i = 0; i < uiNumPoints; ++i)
+    {
+      vSum += pPoints[i];
+    }
+
+    out_vMean = vSum / ezSimdFloat(uiNumPoints);
+    out_vAxis = ezSimdVec4f::ZeroVector();
+
+    ezSimdVec4f vCovariance[4] = {ezSimdVec4f::ZeroVector(), ezSimdVec4f::ZeroVector(), ezSimdVec4f::ZeroVector(), ezSimdVec4f::ZeroVector()};
+    for (ezUInt32 i = 0; i < uiNumPoints; ++i)
+    {
+      const ezSimdVec4f vDiff = pPoints[i] - out_vMean;
+      vCovariance[0] = ezSimdVec4f::MulAdd(vDiff, vDiff.x(), vCovariance[0]);
+      vCovariance[1] = ezSimdVec4f::MulAdd(vDiff, vDiff.y(), vCovariance[1]);
+      vCovariance[2] = ezSimdVec4f::MulAdd(vDiff, vDiff.z(), vCovariance[2]);
+      vCovariance[3] = ezSimdVec4f::MulAdd(vDiff, vDiff.w(), vCovariance[3]);
+    }
+
+    // the row of the channel with the largest variance is usually a good start for the iteration
+    ezUInt32 uiStartRow = 0;
+    float fLargestVariance = vCovariance[0].x();
+    for (ezUInt32 i = 1; i < 4; ++i)
+    {
+      const float fVariance = vCovariance[i].GetComponent(i);
+      if (fVariance > fLargestVariance)
+      {
+        fLargestVariance = fVariance;
+        uiStartRow = i;
+      }
+    }
+
+    ezSimdVec4f vAxis = vCovariance[uiStartRow];
+    for (ezUInt32 i = 0; i <= uiNumIterations; ++i)
+    {
+      const ezSimdFloat fLength = vAxis.GetLength<4>();
+      if (fLength < ezSimdFloat(1e-4f))
+        return;
+
+      vAxis /= fLength;
+
+      if (i < uiNumIterations)
+      {
+        vAxis = vCovariance[0] * vAxis.x() + vCovariance[1] * vAxis.y() + vCovariance[2] * vAxis.z() + vCovariance[3] * vAxis.w();
+      }
+    }
+
+    out_vAxis = vAxis;
+  }
+
+  /// Returns the two ends of the smallest segment along the principal axis that covers all points.
+  void computeEndpointsAlongAxis(
+    const ezSimdVec4f* pPoints, ezUInt32 uiNumPoints, ezUInt32 uiNumIterations, ezSimdVec4f& out_vEndpoint0, ezSimdVec4f& out_vEndpoint1)
+  {
+    ezSimdVec4f vMean, vAxis;
+    computePrincipalAxis(pPoints, uiNumPoints, uiNumIterations, vMean, vAxis);
+
+    float fMin = 0.0f;
+    float fMax = 0.0f;
+    for (ezUInt32 i = 0; i < uiNumPoints; ++i)
+    {
+      const float fProjection = (pPoints[i] - vMean).Dot<4>(vAxis);
+      fMin = ezMath::Min(fMin, fProjection);
+      fMax = ezMath::Max(fMax, fProjection);
+    }
+
+    out_vEndpoint0 = vMean + vAxis * fMin;
+    out_vEndpoint1 = vMean + vAxis * fMax;
+  }
+
+  /// Computes the endpoints that minimize the squared error when every point is represented by lerp(endpoint0, endpoint1, weight).
+  /// Returns false if there is no unique solution, e.g. because all points use the same weight.
+  bool fitEndpointsLeastSquares(const ezSimdVec4f* pPoints, const float* pWeights, ezUInt32 uiNumPoints, float fMaxValue,
+    ezSimdVec4f& out_vEndpoint0, ezSimdVec4f& out_vEndpoint1)
+  {
+    float fAlpha2 = 0.0f;
+    float fBeta2 = 0.0f;
+    float fAlphaBeta = 0.0f;
+    ezSimdVec4f vAlphaX = ezSimdVec4f::ZeroVector();
+    ezSimdVec4f vBetaX = ezSimdVec4f::ZeroVector();
+
+    for (ezUInt32 i = 0; i < uiNumPoints; ++i)
+    {
+      const float fBeta = pWeights[i];
+      const float fAlpha = 1.0f - fBeta;
+
+      fAlpha2 += fAlpha * fAlpha;
+      fBeta2 += fBeta * fBeta;
+      fAlphaBeta += fAlpha * fBeta;
+      vAlphaX = ezSimdVec4f::MulAdd(pPoints[i], ezSimdFloat(fAlpha), vAlphaX);
+      vBetaX = ezSimdVec4f::MulAdd(pPoints[i], ezSimdFloat(fBeta), vBetaX);
+    }
+
+    const float fDet = fAlpha2 * fBeta2 - fAlphaBeta * fAlphaBeta;
+    if (ezMath::Abs(fDet) < 1e-4f)
+      return false;
+
+    const ezSimdFloat fInvDet = 1.0f / fDet;
+    const ezSimdVec4f vMin = ezSimdVec4f::ZeroVector();
+    const ezSimdVec4f vMax(fMaxValue);
+
+    out_vEndpoint0 = ((vAlphaX * fBeta2 - vBetaX * fAlphaBeta) * fInvDet).CompMax(vMin).CompMin(vMax);
+    out_vEndpoint1 = ((vBetaX * fAlpha2 - vAlphaX * fAlphaBeta) * fInvDet).CompMax(vMin).CompMin(vMax);
+    return true;
+  }
+
+  ezUInt32 getNumPowerIterations(ezBlockCompressionQuality::Enum quality)
+  {
+    switch (quality)
+    {
+      case ezBlockCompressionQuality::Fast:
+        return 1;
+      case ezBlockCompressionQuality::Normal:
+        return 4;
+      default:
+        return 8;
+    }
+  }
+
+  ezUInt32 getNumRefinements(ezBlockCompressionQuality::Enum quality)
+  {
+    switch (quality)
+    {
+      case ezBlockCompressionQuality::Fast:
+        return 0;
+      case ezBlockCompressionQuality::Normal:
+        return 1;
+      default:
+        return 3;
+    }
+  }
+
+  //////////////////////////////////////////////////////////////////////////
+  // BC1 / BC3
+
+  /// For every 8 bit value, the 5 and 6 bit endpoints whose 2:1 interpolation reproduces it best.
+  /// Used to encode solid blocks much more precisely than by quantizing the color directly.
+  struct BC1SingleColorTable
+  {
+    BC1SingleColorTable()
+    {
+      Build(m_Endpoints5, 5);
+      Build(m_Endpoints6, 6);
+    }
+
+    static void Build(ezUInt8 (*pTable)[2], ezUInt32 uiBits)
+    {
+      const ezUInt32 uiMax = (1u << uiBits) - 1;
+
+      for (ezUInt32 uiValue = 0; uiValue < 256; ++uiValue)
+      {
+        ezUInt32 uiBestError = 0xFFFFFFFF;
+
+        for (ezUInt32 c0 = 0; c0 <= uiMax; ++c0)
+        {
+          for (ezUInt32 c1 = 0; c1 <= uiMax; ++c1)
+          {
+            // same expansion as ezDecompressB5G6R5
+            const ezInt32 e0 = uiBits == 5 ? (c0 * 527 + 23) >> 6 : (c0 * 259 + 33) >> 6;
+            const ezInt32 e1 = uiBits == 5 ? (c1 * 527 + 23) >> 6 : (c1 * 259 + 33) >> 6;
+            const ezUInt32 uiError = ezMath::Abs((2 * e0 + e1 + 1) / 3 - ezInt32(uiValue));
+
+            if (uiError < uiBestError)
+            {
+              uiBestError = uiError;
+              pTable[uiValue][0] = ezUInt8(c0);
+              pTable[uiValue][1] = ezUInt8(c1);
+            }
+          }
+        }
+      }
+    }
+
+    ezUInt8 m_Endpoints5[256][2];
+    ezUInt8 m_Endpoints6[256][2];
+  };
+
+  const BC1SingleColorTable& getSingleColorTableBC1()
+  {
+    static BC1SingleColorTable s_Table;
+    return s_Table;
+  }
+
+  /// Writes a BC1 color block with the given endpoints and picks the best palette entry for every pixel.
+  /// Pixels in uiTransparentMask use the transparent entry, if the block is in three color mode.
+  /// With bForceFourColorMode the block is always decoded in four color mode, as in BC2 and BC3.
+  /// Returns the squared error of all opaque pixels.
+  ezUInt32 encodeBlockBC1(const ezColorBaseUB* pPixels, ezUInt16 uiColor0, ezUInt16 uiColor1, bool bThreeColorMode, bool bForceFourColorMode,
+    ezUInt32 uiTransparentMask, ezUInt8* pTarget, ezUInt8* out_pIndices)
+  {
+    // without forced mode, the order of the endpoints selects the mode
+    if (!bForceFourColorMode && (bThreeColorMode ? uiColor0 > uiColor1 : uiColor0 < uiColor1))
+    {
+      ezMath::Swap(uiColor0, uiColor1);
+    }
+
+    const bool bFourColors = bForceFourColorMode || uiColor0 > uiColor1;
+
+    ezColorBaseUB palette[4];
+    palette[0] = ezDecompressB5G6R5(uiColor0);
+    palette[1] = ezDecompressB5G6R5(uiColor1);
+
+    if (bFourColors)
+    {
+      palette[2] = ezColorBaseUB((2 * palette[0].r + palette[1].r + 1) / 3, (2 * palette[0].g + palette[1].g + 1) / 3,
+        (2 * palette[0].b + palette[1].b + 1) / 3, 0xFF);
+      palette[3] = ezColorBaseUB((palette[0].r + 2 * palette[1].r + 1) / 3, (palette[0].g + 2 * palette[1].g + 1) / 3,
+        (palette[0].b + 2 * palette[1].b + 1) / 3, 0xFF);
+    }
+    else
+    {
+      palette[2] = ezColorBaseUB(
+        (palette[0].r + palette[1].r) / 2, (palette[0].g + palette[1].g) / 2, (palette[0].b + palette[1].b) / 2, 0xFF);
+      palette[3] = ezColorBaseUB(0, 0, 0, 0);
+    }
+
+    const ezUInt32 uiNumOpaqueEntries = bFourColors ? 4 : 3;
+
+    ezUInt32 uiError = 0;
+    ezUInt32 uiIndices = 0;
+
+    for (ezUInt32 i = 0; i < 16; ++i)
+    {
+      ezUInt32 uiBestIndex = 3;
+
+      if (bFourColors || (uiTransparentMask & (1u << i)) == 0)
+      {
+        ezUInt32 uiBestError = 0xFFFFFFFF;
+
+        for (ezUInt32 e = 0; e < uiNumOpaqueEntries; ++e)
+        {
+          const ezUInt32 uiEntryError = colorDistanceRGB(pPixels[i], palette[e]);
+          if (uiEntryError < uiBestError)
+          {
+            uiBestError = uiEntryError;
+            uiBestIndex = e;
+          }
+        }
+
+        uiError += uiBestError;
+      }
+
+      out_pIndices[i] = ezUInt8(uiBestIndex);
+      uiIndices |= uiBestIndex << (2 * i);
+    }
+
+    pTarget[0] = ezUInt8(uiColor0 & 0xFF);
+    pTarget[1] = ezUInt8(uiColor0 >> 8);
+    pTarget[2] = ezUInt8(uiColor1 & 0xFF);
+    pTarget[3] = ezUInt8(uiColor1 >> 8);
+    pTarget[4] = ezUInt8(uiIndices >> 0);
+    pTarget[5] = ezUInt8(uiIndices >> 8);
+    pTarget[6] = ezUInt8(uiIndices >> 16);
+    pTarget[7] = ezUInt8(uiIndices >> 24);
+
+    return uiError;
+  }
+
+  void compressColorBlockBC1(const ezColorBaseUB* pPixels, ezUInt32 uiTransparentMask, bool bForceFourColorMode,
+    ezBlockCompressionQuality::Enum quality, ezUInt8* pTarget)
+  {
+    ezSimdVec4f points[16];
+    ezUInt8 pointPixels[16];
+    ezUInt32 uiNumPoints = 0;
+    bool bSolid = true;
+
+    for (ezUInt32 i = 0; i < 16; ++i)
+    {
+      if ((uiTransparentMask & (1u << i)) == 0)
+      {
+        points[uiNumPoints] = ezSimdVec4f(pPixels[i].r, pPixels[i].g, pPixels[i].b, 0.0f);
+        pointPixels[uiNumPoints] = ezUInt8(i);
+        bSolid = bSolid && colorDistanceRGB(pPixels[i], pPixels[pointPixels[0]]) == 0;
+        ++uiNumPoints;
+      }
+    }
+
+    if (uiNumPoints == 0)
+    {
+      // equal endpoints select three color mode, all pixels use the transparent entry
+      memset(pTarget, 0x00, 4);
+      memset(pTarget + 4, 0xFF, 4);
+      return;
+    }
+
+    const bool bThreeColorMode = uiTransparentMask != 0;
+
+    ezUInt8 bestBlock[8];
+    ezUInt8 bestIndices[16];
+    ezUInt32 uiBestError = 0xFFFFFFFF;
+
+    auto tryEndpoints = [&](ezUInt16 uiColor0, ezUInt16 uiColor1, bool bThreeColors) {
+      ezUInt8 block[8];
+      ezUInt8 indices[16];
+      const ezUInt32 uiError =
+        encodeBlockBC1(pPixels, uiColor0, uiColor1, bThreeColors, bForceFourColorMode, uiTransparentMask, block, indices);
+
+      if (uiError < uiBestError)
+      {
+        uiBestError = uiError;
+        memcpy(bestBlock, block, sizeof(block));
+        memcpy(bestIndices, indices, sizeof(indices));
+      }
+    };
+
+    if (bSolid && quality >= ezBlockCompressionQuality::Normal)
+    {
+      const BC1SingleColorTable& table = getSingleColorTableBC1();
+      const ezColorBaseUB& color = pPixels[pointPixels[0]];
+
+      const ezUInt16 uiColor0 = ezUInt16((table.m_Endpoints5[color.r][0] << 11) | (table.m_Endpoints6[color.g][0] << 5) | table.m_Endpoints5[color.b][0]);
+      const ezUInt16 uiColor1 = ezUInt16((table.m_Endpoints5[color.r][1] << 11) | (table.m_Endpoints6[color.g][1] << 5) | table.m_Endpoints5[color.b][1]);
+      tryEndpoints(uiColor0, uiColor1, bThreeColorMode);
+    }
+
+    ezSimdVec4f vEndpoint0, vEndpoint1;
+    computeEndpointsAlongAxis(points, uiNumPoints, getNumPowerIterations(quality), vEndpoint0, vEndpoint1);
+
+    const ezUInt16 uiColor0 = ezCompressB5G6R5(toColorUB(vEndpoint0));
+    const ezUInt16 uiColor1 = ezCompressB5G6R5(toColorUB(vEndpoint1));
+    tryEndpoints(uiColor0, uiColor1, bThreeColorMode);
+
+    if (quality == ezBlockCompressionQuality::High && !bThreeColorMode && !bForceFourColorMode)
+    {
+      // the half-way entry of the three color mode is sometimes a better fit for opaque blocks, too
+      tryEndpoints(uiColor0, uiColor1, true);
+    }
+
+    for (ezUInt32 uiRefinement = 0; uiRefinement < getNumRefinements(quality) && uiBestError > 0; ++uiRefinement)
+    {
+      static const float s_fWeightsFourColors[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+      static const float s_fWeightsThreeColors[4] = {0.0f, 1.0f, 0.5f, 0.0f};
+
+      const ezUInt16 uiBestColor0 = bestBlock[0] | (bestBlock[1] << 8);
+      const ezUInt16 uiBestColor1 = bestBlock[2] | (bestBlock[3] << 8);
+      const bool bFourColors = bForceFourColorMode || uiBestColor0 > uiBestColor1;
+      const float* pIndexWeights = bFourColors ? s_fWeightsFourColors : s_fWeightsThreeColors;
+
+      float weights[16];
+      for (ezUInt32 i = 0; i < uiNumPoints; ++i)
+      {
+        weights[i] = pIndexWeights[bestIndices[pointPixels[i]]];
+      }
+
+      if (!fitEndpointsLeastSquares(points, weights, uiNumPoints, 255.0f, vEndpoint0, vEndpoint1))
+        break;
+
+      tryEndpoints(ezCompressB5G6R5(toColorUB(vEndpoint0)), ezCompressB5G6R5(toColorUB(vEndpoint1)), !bFourColors);
+    }
+
+    memcpy(pTarget, bestBlock, sizeof(bestBlock));
+  }
+
+  /// Writes a BC4 block (also used for the alpha of BC3) with the given endpoints and returns the squared error.
+  ezUInt32 encodeBlockBC4(const ezUInt8* pValues, ezUInt32 a0, ezUInt32 a1, ezUInt8* pTarget)
+  {
+    ezUInt32 palette[8];
+    ezUnpackPaletteBC4(a0, a1, palette);
+
+    ezUInt32 uiError = 0;
+    ezUInt64 uiIndices = 0;
+
+    for (ezUInt32 i = 0; i < 16; ++i)
+    {
+      ezUInt32 uiBestError = 0xFFFFFFFF;
+      ezUInt64 uiBestIndex = 0;
+
+      for (ezUInt32 e = 0; e < 8; ++e)
+      {
+        const ezInt32 iDiff = ezInt32(pValues[i]) - ezInt32(palette[e]);
+        const ezUInt32 uiEntryError = iDiff * iDiff;
+        if (uiEntryError < uiBestError)
+        {
+          uiBestError = uiEntryError;
+          uiBestIndex = e;
+        }
+      }
+
+      uiError += uiBestError;
+      uiIndices |= uiBestIndex << (3 * i);
+    }
+
+    pTarget[0] = ezUInt8(a0);
+    pTarget[1] = ezUInt8(a1);
+    for (ezUInt32 i = 0; i < 6; ++i)
+    {
+      pTarget[2 + i] = ezUInt8(uiIndices >> (8 * i));
+    }
+
+    return uiError;
+  }
+
+  void compressBlockBC4(const ezUInt8* pValues, ezBlockCompressionQuality::Enum quality, ezUInt8* pTarget)
+  {
+    ezUInt32 uiMin = 255, uiMax = 0;
+    ezUInt32 uiInnerMin = 255, uiInnerMax = 0;
+
+    for (ezUInt32 i = 0; i < 16; ++i)
+    {
+      uiMin = ezMath::Min<ezUInt32>(uiMin, pValues[i]);
+      uiMax = ezMath::Max<ezUInt32>(uiMax, pValues[i]);
+
+      if (pValues[i] != 0 && pValues[i] != 255)
+      {
+        uiInnerMin = ezMath::Min<ezUInt32>(uiInnerMin, pValues[i]);
+        uiInnerMax = ezMath::Max<ezUInt32>(uiInnerMax, pValues[i]);
+      }
+    }
+
+    ezUInt8 bestBlock[8];
+    ezUInt32 uiBestError = 0xFFFFFFFF;
+
+    auto tryEndpoints = [&](ezUInt32 a0, ezUInt32 a1) {
+      ezUInt8 block[8];
+      const ezUInt32 uiError = encodeBlockBC4(pValues, a0, a1, block);
+
+      if (uiError < uiBestError)
+      {
+        uiBestError = uiError;
+        memcpy(bestBlock, block, sizeof(block));
+      }
+    };
+
+    // a0 > a1 selects eight interpolated values
+    tryEndpoints(uiMax, uiMin);
+
+    if (quality >= ezBlockCompressionQuality::Normal && (uiMin == 0 || uiMax == 255) && uiInnerMin <= uiInnerMax)
+    {
+      // a0 <= a1 selects six interpolated values plus explicit 0 and 255
+      tryEndpoints(uiInnerMin, uiInnerMax);
+    }
+
+    if (quality == ezBlockCompressionQuality::High)
+    {
+      // moving the endpoints inwards may place the interpolated values better
+      for (ezUInt32 uiInset0 = 0; uiInset0 < 4 && uiBestError > 0; ++uiInset0)
+      {
+        for (ezUInt32 uiInset1 = 0; uiInset1 < 4; ++uiInset1)
+        {
+          if (uiMax - uiInset0 > uiMin + uiInset1 && (uiInset0 | uiInset1) != 0)
+          {
+            tryEndpoints(uiMax - uiInset0, uiMin + uiInset1);
+          }
+        }
+      }
+    }
+
+    memcpy(pTarget, bestBlock, sizeof(bestBlock));
+  }
+
+  //////////////////////////////////////////////////////////////////////////
+  // BC7
+
+  static const ezUInt8 s_bc7AllPixels[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+
+  /// Quantizes an endpoint to uiPrec bits per channel plus the given p-bit.
+  /// Returns the 8 bit color that the decoder reconstructs from the quantized value.
+  ezColorBaseUB quantizeEndpointBC7(
+    const ezSimdVec4f& vEndpoint, ezUInt32 uiPrec, ezUInt32 uiPBit, ezUInt32 uiNumChannels, ezColorBaseUB& out_Quantized, float& out_fError)
+  {
+    float f[4];
+    vEndpoint.Store<4>(f);
+
+    const ezInt32 iMax = (1 << uiPrec) - 1;
+    const float fScale = float((1 << (uiPrec + 1)) - 1) / 255.0f;
+
+    ezColorBaseUB result(0, 0, 0, 255);
+    out_Quantized = ezColorBaseUB(0, 0, 0, 0);
+    out_fError = 0.0f;
+
+    for (ezUInt32 ch = 0; ch < uiNumChannels; ++ch)
+    {
+      const ezInt32 iGuess = ezMath::Clamp(ezInt32((f[ch] * fScale - uiPBit) * 0.5f + 0.5f), 0, iMax);
+
+      float fBestError = ezMath::MaxValue<float>();
+      for (ezInt32 q = ezMath::Max(iGuess - 1, 0); q <= ezMath::Min(iGuess + 1, iMax); ++q)
+      {
+        const ezUInt8 uiValue = bc7Unquantize(ezUInt8((q << 1) | uiPBit), uiPrec + 1);
+        const float fError = ezMath::Square(uiValue - f[ch]);
+
+        if (fError < fBestError)
+        {
+          fBestError = fError;
+          out_Quantized.GetData()[ch] = ezUInt8(q);
+          result.GetData()[ch] = uiValue;
+        }
+      }
+
+      out_fError += fBestError;
+    }
+
+    return result;
+  }
+
+  /// Picks the best palette entry for every pixel of one subset and returns the squared error of the subset.
+  ezUInt32 findIndicesBC7(const ezColorBaseUB* pPixels, const ezUInt8* pSubsetPixels, ezUInt32 uiNumSubsetPixels, const ezColorBaseUB& c0,
+    const ezColorBaseUB& c1, ezUInt32 uiIndexPrec, ezUInt8* out_pIndices)
+  {
+    const int* pWeights = uiIndexPrec == 4 ? s_bc67InterpolationWeights4 : (uiIndexPrec == 3 ? s_bc67InterpolationWeights3 : s_bc67InterpolationWeights2);
+    const ezUInt32 uiNumEntries = 1u << uiIndexPrec;
+
+    ezColorBaseUB palette[16];
+    for (ezUInt32 e = 0; e < uiNumEntries; ++e)
+    {
+      for (ezUInt32 ch = 0; ch < 4; ++ch)
+      {
+        palette[e].GetData()[ch] = ezUInt8((ezUInt32(c0.GetData()[ch]) * ezUInt32(s_bc67WeightMax - pWeights[e]) +
+                                             ezUInt32(c1.GetData()[ch]) * ezUInt32(pWeights[e]) + s_bc67WeightRound) >>
+                                           s_bc67WeightShift);
+      }
+    }
+
+    ezUInt32 uiError = 0;
+    for (ezUInt32 i = 0; i < uiNumSubsetPixels; ++i)
+    {
+      const ezColorBaseUB& pixel = pPixels[pSubsetPixels[i]];
+      ezUInt32 uiBestError = 0xFFFFFFFF;
+
+      for (ezUInt32 e = 0; e < uiNumEntries; ++e)
+      {
+        const ezUInt32 uiEntryError = colorDistanceRGBA(pixel, palette[e]);
+        if (uiEntryError < uiBestError)
+        {
+          uiBestError = uiEntryError;
+          out_pIndices[pSubsetPixels[i]] = ezUInt8(e);
+        }
+      }
+
+      uiError += uiBestError;
+    }
+
+    return uiError;
+  }
+
+  struct BC7Subset
+  {
+    ezColorBaseUB m_Quantized[2];
+    ezUInt32 m_PBits[2];
+  };
+
+  /// Quantizes the endpoints of one subset and finds the indices of its pixels. Returns the squared error of the subset.
+  ///
+  /// With bTryAllPBits, every p-bit combination is evaluated on the pixels, otherwise the p-bits are chosen per endpoint.
+  ezUInt32 encodeSubsetBC7(const ezColorBaseUB* pPixels, const ezUInt8* pSubsetPixels, ezUInt32 uiNumSubsetPixels, const ezSimdVec4f& vEndpoint0,
+    const ezSimdVec4f& vEndpoint1, ezUInt32 uiPrec, bool bSharedPBit, ezUInt32 uiNumChannels, ezUInt32 uiIndexPrec, bool bTryAllPBits,
+    BC7Subset& out_Subset, ezUInt8* out_pIndices)
+  {
+    ezUInt32 uiBestError = 0xFFFFFFFF;
+    float fBestEndpointError = ezMath::MaxValue<float>();
+    ezUInt32 uiBestPBits = 0;
+
+    if (!bTryAllPBits)
+    {
+      for (ezUInt32 uiPBits = 0; uiPBits < 4; ++uiPBits)
+      {
+        const ezUInt32 p0 = uiPBits & 1;
+        const ezUInt32 p1 = uiPBits >> 1;
+
+        if (bSharedPBit && p0 != p1)
+          continue;
+
+        ezColorBaseUB q;
+        float fError0, fError1;
+        quantizeEndpointBC7(vEndpoint0, uiPrec, p0, uiNumChannels, q, fError0);
+        quantizeEndpointBC7(vEndpoint1, uiPrec, p1, uiNumChannels, q, fError1);
+
+        if (fError0 + fError1 < fBestEndpointError)
+        {
+          fBestEndpointError = fError0 + fError1;
+          uiBestPBits = uiPBits;
+        }
+      }
+    }
+
+    for (ezUInt32 uiPBits = 0; uiPBits < 4; ++uiPBits)
+    {
+      const ezUInt32 p0 = uiPBits & 1;
+      const ezUInt32 p1 = uiPBits >> 1;
+
+      if ((bSharedPBit && p0 != p1) || (!bTryAllPBits && uiPBits != uiBestPBits))
+        continue;
+
+      BC7Subset subset;
+      subset.m_PBits[0] = p0;
+      subset.m_PBits[1] = p1;
+
+      float fUnused;
+      const ezColorBaseUB c0 = quantizeEndpointBC7(vEndpoint0, uiPrec, p0, uiNumChannels, subset.m_Quantized[0], fUnused);
+      const ezColorBaseUB c1 = quantizeEndpointBC7(vEndpoint1, uiPrec, p1, uiNumChannels, subset.m_Quantized[1], fUnused);
+
+      ezUInt8 indices[16];
+      const ezUInt32 uiError = findIndicesBC7(pPixels, pSubsetPixels, uiNumSubsetPixels, c0, c1, uiIndexPrec, indices);
+
+      if (uiError < uiBestError)
+      {
+        uiBestError = uiError;
+        out_Subset = subset;
+
+        for (ezUInt32 i = 0; i < uiNumSubsetPixels; ++i)
+        {
+          out_pIndices[pSubsetPixels[i]] = indices[pSubsetPixels[i]];
+        }
+      }
+    }
+
+    return uiBestError;
+  }
+
+  /// Fits, quantizes and refines the endpoints of one subset. Returns the squared error of the subset.
+  ezUInt32 compressSubsetBC7(const ezColorBaseUB* pPixels, const ezUInt8* pSubsetPixels, ezUInt32 uiNumSubsetPixels, ezUInt32 uiPrec,
+    bool bSharedPBit, ezUInt32 uiNumChannels, ezUInt32 uiIndexPrec, ezUInt32 uiNumIterations, ezUInt32 uiNumRefinements, bool bTryAllPBits,
+    BC7Subset& out_Subset, ezUInt8* out_pIndices)
+  {
+    ezSimdVec4f points[16];
+    for (ezUInt32 i = 0; i < uiNumSubsetPixels; ++i)
+    {
+      const ezColorBaseUB& pixel = pPixels[pSubsetPixels[i]];
+      points[i] = ezSimdVec4f(pixel.r, pixel.g, pixel.b, uiNumChannels == 4 ? pixel.a : 255.0f);
+    }
+
+    ezSimdVec4f vEndpoint0, vEndpoint1;
+    computeEndpointsAlongAxis(points, uiNumSubsetPixels, uiNumIterations, vEndpoint0, vEndpoint1);
+
+    ezUInt32 uiError = encodeSubsetBC7(pPixels, pSubsetPixels, uiNumSubsetPixels, vEndpoint0, vEndpoint1, uiPrec, bSharedPBit, uiNumChannels,
+      uiIndexPrec, bTryAllPBits, out_Subset, out_pIndices);
+
+    const int* pWeights = uiIndexPrec == 4 ? s_bc67InterpolationWeights4 : s_bc67InterpolationWeights3;
+
+    for (ezUInt32 uiRefinement = 0; uiRefinement < uiNumRefinements && uiError > 0; ++uiRefinement)
+    {
+      float weights[16];
+      for (ezUInt32 i = 0; i < uiNumSubsetPixels; ++i)
+      {
+        weights[i] = pWeights[out_pIndices[pSubsetPixels[i]]] / float(s_bc67WeightMax);
+      }
+
+      if (!fitEndpointsLeastSquares(points, weights, uiNumSubsetPixels, 255.0f, vEndpoint0, vEndpoint1))
+        break;
+
+      BC7Subset subset;
+      ezUInt8 indices[16];
+      const ezUInt32 uiRefinedError = encodeSubsetBC7(pPixels, pSubsetPixels, uiNumSubsetPixels, vEndpoint0, vEndpoint1, uiPrec, bSharedPBit,
+        uiNumChannels, uiIndexPrec, bTryAllPBits, subset, indices);
+
+      if (uiRefinedError >= uiError)
+        break;
+
+      uiError = uiRefinedError;
+      out_Subset = subset;
+
+      for (ezUInt32 i = 0; i < uiNumSubsetPixels; ++i)
+      {
+        out_pIndices[pSubsetPixels[i]] = indices[pSubsetPixels[i]];
+      }
+    }
+
+    return uiError;
+  }
+
+  /// Mode 6: one subset, RGBA with 7 bits per channel plus a p-bit per endpoint, 4 bit indices.
+  ezUInt32 compressMode6BC7(const ezColorBaseUB* pPixels, ezBlockCompressionQuality::Enum quality, ezUInt8* pTarget)
+  {
+    BC7Subset subset;
+    ezUInt8 indices[16];
+    const ezUInt32 uiError = compressSubsetBC7(pPixels, s_bc7AllPixels, 16, 7, false, 4, 4, getNumPowerIterations(quality),
+      getNumRefinements(quality), quality == ezBlockCompressionQuality::High, subset, indices);
+
+    // the highest index bit of the first pixel is implicitly zero
+    if (indices[0] >= 8)
+    {
+      ezMath::Swap(subset.m_Quantized[0], subset.m_Quantized[1]);
+      ezMath::Swap(subset.m_PBits[0], subset.m_PBits[1]);
+
+      for (ezUInt32 i = 0; i < 16; ++i)
+      {
+        indices[i] = 15 - indices[i];
+      }
+    }
+
+    memset(pTarget, 0, 16);
+    ezUInt32 uiBit = 0;
+    setBits(pTarget, uiBit, 7, 1 << 6);
+
+    for (ezUInt32 ch = 0; ch < 4; ++ch)
+    {
+      setBits(pTarget, uiBit, 7, subset.m_Quantized[0].GetData()[ch]);
+      setBits(pTarget, uiBit, 7, subset.m_Quantized[1].GetData()[ch]);
+    }
+
+    setBits(pTarget, uiBit, 1, subset.m_PBits[0]);
+    setBits(pTarget, uiBit, 1, subset.m_PBits[1]);
+
+    for (ezUInt32 i = 0; i < 16; ++i)
+    {
+      setBits(pTarget, uiBit, i == 0 ? 3 : 4, indices[i]);
+    }
+
+    EZ_ASSERT_DEBUG(uiBit == 128, "Invalid BC7 block size");
+    return uiError;
+  }
+
+  /// The two subset modes that are used: mode 1 for opaque blocks and mode 7 for blocks with alpha.
+  struct BC7PartitionedModeInfo
+  {
+    ezUInt32 m_uiMode;
+    ezUInt32 m_uiPrec;
+    bool m_bSharedPBit;
+    ezUInt32 m_uiNumChannels;
+    ezUInt32 m_uiIndexPrec;
+  };
+
+  static const BC7PartitionedModeInfo s_bc7Mode1 = {1, 6, true, 3, 3};
+  static const BC7PartitionedModeInfo s_bc7Mode7 = {7, 5, false, 4, 2};
+
+  void gatherSubsets(ezUInt32 uiShape, ezUInt8 (*out_pSubsetPixels)[16], ezUInt32* out_pNumSubsetPixels)
+  {
+    out_pNumSubsetPixels[0] = 0;
+    out_pNumSubsetPixels[1] = 0;
+
+    for (ezUInt32 i = 0; i < 16; ++i)
+    {
+      const ezUInt32 uiSubset = s_bc67PartitionTable[1][uiShape][i];
+      out_pSubsetPixels[uiSubset][out_pNumSubsetPixels[uiSubset]++] = ezUInt8(i);
+    }
+  }
+
+  /// Estimates how well the pixels of every subset of the two subset partition lie on a line, without quantization.
+  float estimatePartitionError(const ezSimdVec4f* pPoints, ezUInt32 uiShape)
+  {
+    ezUInt8 subsetPixels[2][16];
+    ezUInt32 uiNumSubsetPixels[2];
+    gatherSubsets(uiShape, subsetPixels, uiNumSubsetPixels);
+
+    float fError = 0.0f;
+    for (ezUInt32 s = 0; s < 2; ++s)
+    {
+      ezSimdVec4f subsetPoints[16];
+      for (ezUInt32 i = 0; i < uiNumSubsetPixels[s]; ++i)
+      {
+        subsetPoints[i] = pPoints[subsetPixels[s][i]];
+      }
+
+      ezSimdVec4f vMean, vAxis;
+      computePrincipalAxis(subsetPoints, uiNumSubsetPixels[s], 1, vMean, vAxis);
+
+      for (ezUInt32 i = 0; i < uiNumSubsetPixels[s]; ++i)
+      {
+        const ezSimdVec4f vDiff = subsetPoints[i] - vMean;
+        const float fProjection = vDiff.Dot<4>(vAxis);
+        fError += float(vDiff.Dot<4>(vDiff)) - fProjection * fProjection;
+      }
+    }
+
+    return fError;
+  }
+
+  /// Finds the two subset partitions whose subsets are best approximated by lines, out of the first uiNumCandidateShapes partitions
+  /// (BC6H only supports the first 32). Returns the number of shapes written to out_pShapes.
+  ezUInt32 findBestPartitions(const ezSimdVec4f* pPoints, ezUInt32 uiNumCandidateShapes, ezUInt32 uiMaxShapes, ezUInt32* out_pShapes)
+  {
+    EZ_ASSERT_DEBUG(uiMaxShapes <= 4, "Too many shapes requested");
+
+    float fErrors[4];
+    ezUInt32 uiNumShapes = 0;
+
+    for (ezUInt32 uiShape = 0; uiShape < uiNumCandidateShapes; ++uiShape)
+    {
+      const float fError = estimatePartitionError(pPoints, uiShape);
+
+      // insertion into the sorted list of the best shapes so far
+      ezUInt32 uiPos = uiNumShapes;
+      while (uiPos > 0 && fErrors[uiPos - 1] > fError)
+      {
+        if (uiPos < uiMaxShapes)
+        {
+          fErrors[uiPos] = fErrors[uiPos - 1];
+          out_pShapes[uiPos] = out_pShapes[uiPos - 1];
+        }
+        --uiPos;
+      }
+
+      if (uiPos < uiMaxShapes)
+      {
+        fErrors[uiPos] = fError;
+        out_pShapes[uiPos] = uiShape;
+        uiNumShapes = ezMath::Min(uiNumShapes + 1, uiMaxShapes);
+      }
+    }
+
+    return uiNumShapes;
+  }
+
+  /// Encodes the block with two subsets in the given partition, in mode 1 or mode 7. Returns the squared error.
+  ezUInt32 compressPartitionedBC7(const ezColorBaseUB* pPixels, const BC7PartitionedModeInfo& mode, ezUInt32 uiShape,
+    ezBlockCompressionQuality::Enum quality, ezUInt8* pTarget)
+  {
+    ezUInt8 subsetPixels[2][16];
+    ezUInt32 uiNumSubsetPixels[2];
+    gatherSubsets(uiShape, subsetPixels, uiNumSubsetPixels);
+
+    BC7Subset subsets[2];
+    ezUInt8 indices[16];
+    ezUInt32 uiError = 0;
+
+    for (ezUInt32 s = 0; s < 2; ++s)
+    {
+      uiError += compressSubsetBC7(pPixels, subsetPixels[s], uiNumSubsetPixels[s], mode.m_uiPrec, mode.m_bSharedPBit, mode.m_uiNumChannels,
+        mode.m_uiIndexPrec, getNumPowerIterations(quality), getNumRefinements(quality), quality == ezBlockCompressionQuality::High, subsets[s],
+        indices);
+    }
+
+    // the highest index bit of the first pixel of every subset is implicitly zero
+    const ezUInt32 uiAnchors[2] = {0, s_bc67FixUp[1][uiShape][1]};
+    const ezUInt32 uiMaxIndex = (1u << mode.m_uiIndexPrec) - 1;
+
+    for (ezUInt32 s = 0; s < 2; ++s)
+    {
+      if (indices[uiAnchors[s]] > uiMaxIndex / 2)
+      {
+        ezMath::Swap(subsets[s].m_Quantized[0], subsets[s].m_Quantized[1]);
+        ezMath::Swap(subsets[s].m_PBits[0], subsets[s].m_PBits[1]);
+
+        for (ezUInt32 i = 0; i < uiNumSubsetPixels[s]; ++i)
+        {
+          indices[subsetPixels[s][i]] = ezUInt8(uiMaxIndex - indices[subsetPixels[s][i]]);
+        }
+      }
+    }
+
+    memset(pTarget, 0, 16);
+    ezUInt32 uiBit = 0;
+    setBits(pTarget, uiBit, mode.m_uiMode + 1, 1u << mode.m_uiMode);
+    setBits(pTarget, uiBit, 6, uiShape);
+
+    for (ezUInt32 ch = 0; ch < mode.m_uiNumChannels; ++ch)
+    {
+      for (ezUInt32 s = 0; s < 2; ++s)
+      {
+        setBits(pTarget, uiBit, mode.m_uiPrec, subsets[s].m_Quantized[0].GetData()[ch]);
+        setBits(pTarget, uiBit, mode.m_uiPrec, subsets[s].m_Quantized[1].GetData()[ch]);
+      }
+    }
+
+    for (ezUInt32 s = 0; s < 2; ++s)
+    {
+      setBits(pTarget, uiBit, 1, subsets[s].m_PBits[0]);
+
+      if (!mode.m_bSharedPBit)
+      {
+        setBits(pTarget, uiBit, 1, subsets[s].m_PBits[1]);
+      }
+    }
+
+    for (ezUInt32 i = 0; i < 16; ++i)
+    {
+      const bool bAnchor = i == uiAnchors[0] || i == uiAnchors[1];
+      setBits(pTarget, uiBit, bAnchor ? mode.m_uiIndexPrec - 1 : mode.m_uiIndexPrec, indices[i]);
+    }
+
+    EZ_ASSERT_DEBUG(uiBit == 128, "Invalid BC7 block size");
+    return uiError;
+  }
+
+  //////////////////////////////////////////////////////////////////////////
+  // BC6H
+
+  /// Returns the value of a quantized endpoint channel as the decoder reconstructs it, in half float bits.
+  EZ_ALWAYS_INLINE ezInt32 unquantizeEndpointBC6(ezInt32 iValue, ezUInt32 uiPrec)
+  {
+    return bc6FinishUnquantize(bc6Unquantize(iValue, ezUInt8(uiPrec), false), false);
+  }
+
+  ezInt32 quantizeEndpointBC6(float fHalfBits, ezUInt32 uiPrec)
+  {
+    // the decoder scales the value up to 16 bits and then by 31/64
+    const ezInt32 iMax = (1 << uiPrec) - 1;
+    const ezInt32 iGuess = ezMath::Clamp(ezInt32(fHalfBits * (64.0f / 31.0f) / float(1 << (16 - uiPrec))), 0, iMax);
+
+    ezInt32 iBest = iGuess;
+    float fBestError = ezMath::MaxValue<float>();
+
+    for (ezInt32 q = ezMath::Max(iGuess - 1, 0); q <= ezMath::Min(iGuess + 1, iMax); ++q)
+    {
+      const float fError = ezMath::Abs(unquantizeEndpointBC6(q, uiPrec) - fHalfBits);
+      if (fError < fBestError)
+      {
+        fBestError = fError;
+        iBest = q;
+      }
+    }
+
+    return iBest;
+  }
+
+  /// Computes endpoints for the given points, using the interpolation weights of the mode to refine them with least squares.
+  void fitEndpointsBC6(const ezSimdVec4f* pPoints, ezUInt32 uiNumPoints, ezUInt32 uiIndexPrec, ezBlockCompressionQuality::Enum quality,
+    ezSimdVec4f& out_vEndpoint0, ezSimdVec4f& out_vEndpoint1)
+  {
+    computeEndpointsAlongAxis(pPoints, uiNumPoints, getNumPowerIterations(quality), out_vEndpoint0, out_vEndpoint1);
+
+    const int* pWeights = uiIndexPrec == 4 ? s_bc67InterpolationWeights4 : s_bc67InterpolationWeights3;
+    const ezUInt32 uiMaxIndex = (1u << uiIndexPrec) - 1;
+
+    for (ezUInt32 uiRefinement = 0; uiRefinement < getNumRefinements(quality); ++uiRefinement)
+    {
+      const ezSimdVec4f vDir = out_vEndpoint1 - out_vEndpoint0;
+      const float fLengthSquared = vDir.Dot<4>(vDir);
+      if (fLengthSquared < 1.0f)
+        return;
+
+      // snap the position of every point on the segment to the nearest palette entry, quantization is not taken into account here
+      float weights[16];
+      for (ezUInt32 i = 0; i < uiNumPoints; ++i)
+      {
+        const float t = ezMath::Clamp(float((pPoints[i] - out_vEndpoint0).Dot<4>(vDir)) / fLengthSquared, 0.0f, 1.0f);
+        const ezUInt32 uiIndex = ezMath::Min(ezUInt32(t * uiMaxIndex + 0.5f), uiMaxIndex);
+        weights[i] = pWeights[uiIndex] / float(s_bc67WeightMax);
+      }
+
+      if (!fitEndpointsLeastSquares(pPoints, weights, uiNumPoints, float(s_bc6Float16Max), out_vEndpoint0, out_vEndpoint1))
+        return;
+    }
+  }
+
+  /// Encodes the block in one of the unsigned BC6H modes (an index into s_bc6ModeInfos) with the given endpoints per region.
+  /// The endpoints are quantized to the precision of the mode, in transformed modes the differences to the first endpoint are clamped
+  /// to the available bits. Returns the squared error in half float bits, or 0xFFFFFFFFFFFFFFFF if the endpoints can't be represented.
+  ezUInt64 encodeBlockBC6(const ezInt32 (*pValues)[3], ezUInt32 uiModeInfo, ezUInt32 uiShape, const ezSimdVec4f (*pEndpoints)[2], ezUInt8* pTarget)
+  {
+    const BC6ModeInfo& info = s_bc6ModeInfos[uiModeInfo];
+    const ezUInt32 uiNumRegions = info.partitions + 1u;
+    const ezColorBaseUB& prec = info.rgbaPrec[0][0];
+
+    ezInt32 quantized[2][2][3] = {};
+    for (ezUInt32 r = 0; r < uiNumRegions; ++r)
+    {
+      for (ezUInt32 e = 0; e < 2; ++e)
+      {
+        float f[4];
+        pEndpoints[r][e].Store<4>(f);
+
+        for (ezUInt32 ch = 0; ch < 3; ++ch)
+        {
+          quantized[r][e][ch] = quantizeEndpointBC6(f[ch], prec.GetData()[ch]);
+        }
+      }
+    }
+
+    auto deltaFits = [&](ezUInt32 r, ezUInt32 e, ezUInt32 ch, ezInt32 iValue) {
+      const ezInt32 iDeltaHalfRange = 1 << (info.rgbaPrec[r][e].GetData()[ch] - 1);
+      const ezInt32 iDelta = iValue - quantized[0][0][ch];
+      return iDelta >= -iDeltaHalfRange && iDelta < iDeltaHalfRange;
+    };
+
+    if (info.transformed)
+    {
+      // the other endpoints are stored as differences to the first one
+      for (ezUInt32 r = 0; r < uiNumRegions; ++r)
+      {
+        for (ezUInt32 e = (r == 0) ? 1 : 0; e < 2; ++e)
+        {
+          for (ezUInt32 ch = 0; ch < 3; ++ch)
+          {
+            const ezInt32 iDeltaHalfRange = 1 << (info.rgbaPrec[r][e].GetData()[ch] - 1);
+            const ezInt32 iMax = (1 << prec.GetData()[ch]) - 1;
+            quantized[r][e][ch] = ezMath::Clamp(quantized[r][e][ch], ezMath::Max(quantized[0][0][ch] - iDeltaHalfRange, 0),
+              ezMath::Min(quantized[0][0][ch] + iDeltaHalfRange - 1, iMax));
+          }
+        }
+      }
+    }
+
+    const int* pWeights = info.partitions > 0 ? s_bc67InterpolationWeights3 : s_bc67InterpolationWeights4;
+    const ezUInt32 uiNumEntries = 1u << info.indexPrec;
+
+    ezInt32 palette[2][16][3];
+    for (ezUInt32 r = 0; r < uiNumRegions; ++r)
+    {
+      for (ezUInt32 ch = 0; ch < 3; ++ch)
+      {
+        const ezInt32 iUnquantized0 = bc6Unquantize(quantized[r][0][ch], prec.GetData()[ch], false);
+        const ezInt32 iUnquantized1 = bc6Unquantize(quantized[r][1][ch], prec.GetData()[ch], false);
+
+        for (ezUInt32 i = 0; i < uiNumEntries; ++i)
+        {
+          palette[r][i][ch] = bc6FinishUnquantize(
+            (iUnquantized0 * (s_bc67WeightMax - pWeights[i]) + iUnquantized1 * pWeights[i] + s_bc67WeightRound) >> s_bc67WeightShift, false);
+        }
+      }
+    }
+
+    ezUInt8 indices[16];
+    ezUInt64 uiError = 0;
+
+    for (ezUInt32 i = 0; i < 16; ++i)
+    {
+      const ezUInt32 r = s_bc67PartitionTable[info.partitions][uiShape][i];
+      ezUInt64 uiBestError = 0xFFFFFFFFFFFFFFFFull;
+
+      for (ezUInt32 e = 0; e < uiNumEntries; ++e)
+      {
+        ezUInt64 uiEntryError = 0;
+        for (ezUInt32 ch = 0; ch < 3; ++ch)
+        {
+          const ezInt64 iDiff = pValues[i][ch] - palette[r][e][ch];
+          uiEntryError += iDiff * iDiff;
+        }
+
+        if (uiEntryError < uiBestError)
+        {
+          uiBestError = uiEntryError;
+          indices[i] = ezUInt8(e);
+        }
+      }
+
+      uiError += uiBestError;
+    }
+
+    // the highest index bit of the first pixel of every region is implicitly zero
+    for (ezUInt32 r = 0; r < uiNumRegions; ++r)
+    {
+      const ezUInt32 uiAnchor = s_bc67FixUp[info.partitions][uiShape][r];
+
+      if (indices[uiAnchor] >= uiNumEntries / 2)
+      {
+        for (ezUInt32 ch = 0; ch < 3; ++ch)
+        {
+          ezMath::Swap(quantized[r][0][ch], quantized[r][1][ch]);
+        }
+
+        for (ezUInt32 i = 0; i < 16; ++i)
+        {
+          if (s_bc67PartitionTable[info.partitions][uiShape][i] == r)
+          {
+            indices[i] = ezUInt8(uiNumEntries - 1 - indices[i]);
+          }
+        }
+      }
+    }
+
+    if (info.transformed)
+    {
+      // swapping the endpoints changes the differences, they may not fit anymore
+      for (ezUInt32 r = 0; r < uiNumRegions; ++r)
+      {
+        for (ezUInt32 e = (r == 0) ? 1 : 0; e < 2; ++e)
+        {
+          for (ezUInt32 ch = 0; ch < 3; ++ch)
+          {
+            if (!deltaFits(r, e, ch, quantized[r][e][ch]))
+              return 0xFFFFFFFFFFFFFFFFull;
+
+            quantized[r][e][ch] -= quantized[0][0][ch];
+          }
+        }
+      }
+    }
+
+    memset(pTarget, 0, 16);
+
+    // the header layout of every mode is described by the same table that the decoder uses
+    const BC6ModeDescriptor* pDesc = s_bc6ModeDescs[uiModeInfo];
+    const ezUInt32 uiHeaderBits = info.partitions > 0 ? 82 : 65;
+    ezUInt32 uiBit = 0;
+
+    for (ezUInt32 i = 0; i < uiHeaderBits; ++i)
+    {
+      ezInt32 iValue = 0;
+      switch (pDesc[i].field)
+      {
+        case M:
+          iValue = info.mode;
+          break;
+        case D:
+          iValue = uiShape;
+          break;
+        case RW:
+          iValue = quantized[0][0][0];
+          break;
+        case RX:
+          iValue = quantized[0][1][0];
+          break;
+        case RY:
+          iValue = quantized[1][0][0];
+          break;
+        case RZ:
+          iValue = quantized[1][1][0];
+          break;
+        case GW:
+          iValue = quantized[0][0][1];
+          break;
+        case GX:
+          iValue = quantized[0][1][1];
+          break;
+        case GY:
+          iValue = quantized[1][0][1];
+          break;
+        case GZ:
+          iValue = quantized[1][1][1];
+          break;
+        case BW:
+          iValue = quantized[0][0][2];
+          break;
+        case BX:
+          iValue = quantized[0][1][2];
+          break;
+        case BY:
+          iValue = quantized[1][0][2];
+          break;
+        case BZ:
+          iValue = quantized[1][1][2];
+          break;
+        default:
+          break;
+      }
+
+      setBits(pTarget, uiBit, 1, (ezUInt32(iValue) >> pDesc[i].bit) & 1);
+    }
+
+    for (ezUInt32 i = 0; i < 16; ++i)
+    {
+      setBits(pTarget, uiBit, isFixUpOffset(info.partitions, uiShape, i) ? info.indexPrec - 1 : info.indexPrec, indices[i]);
+    }
+
+    EZ_ASSERT_DEBUG(uiBit == 128, "Invalid BC6H block size");
+    return uiError;
+  }
+
+  //////////////////////////////////////////////////////////////////////////
+
+  /// Compresses all blocks of an image with the given function, distributing rows of blocks over the worker threads.
+  template <typename PixelType>
+  void compressBlocksParallel(ezConstByteBlobPtr source, ezByteBlobPtr target, ezUInt32 numBlocksX, ezUInt32 numBlocksY,
+    ezUInt32 uiBytesPerBlock, void (*compressBlock)(const PixelType*, ezUInt8*, ezBlockCompressionQuality::Enum), const char* szTaskName)
+  {
+    const ezUInt8* pSource = static_cast<const ezUInt8*>(source.GetPtr());
+    ezUInt8* pTarget = static_cast<ezUInt8*>(target.GetPtr());
+    const ezBlockCompressionQuality::Enum quality = ezGetBlockCompressionQuality();
+
+    ezParallelForParams params;
+    // don't split small images (e.g. lower mip levels) into tasks
+    params.uiBinSize = ezMath::Max(1u, 64u / numBlocksX);
+
+    ezTaskSystem::ParallelForIndexed(
+      0, numBlocksY,
+      [pSource, pTarget, numBlocksX, uiBytesPerBlock, compressBlock, quality](ezUInt32 uiStartRow, ezUInt32 uiEndRow) {
+        const ezUInt64 uiRowPitch = ezUInt64(numBlocksX) * 4 * sizeof(PixelType);
+        PixelType block[16];
+
+        for (ezUInt32 blockY = uiStartRow; blockY < uiEndRow; ++blockY)
+        {
+          for (ezUInt32 blockX = 0; blockX < numBlocksX; ++blockX)
+          {
+            for (ezUInt32 y = 0; y < 4; ++y)
+            {
+              memcpy(block + 4 * y, pSource + (4 * blockY + y) * uiRowPitch + blockX * 4 * sizeof(PixelType), 4 * sizeof(PixelType));
+            }
+
+            compressBlock(block, pTarget + (ezUInt64(blockY) * numBlocksX + blockX) * uiBytesPerBlock, quality);
+          }
+        }
+      },
+      szTaskName, params);
+  }
+
+  ezImageConversionEntry makeCompressionEntry(ezImageFormat::Enum sourceFormat, ezImageFormat::Enum targetFormat)
+  {
+    ezImageConversionEntry entry(sourceFormat, targetFormat, ezImageConversionFlags::Default);
+
+#if EZ_ENABLED(EZ_PLATFORM_WINDOWS_DESKTOP)
+    // DirectXTex evaluates all BC6H and BC7 modes, so it is preferred even when it has no hardware device, see DXTexConversions.cpp
+    entry.m_additionalPenalty = 4000.0f;
+#endif
+
+    return entry;
+  }
+} // namespace
+
+void ezCompressBlockBC1(const ezColorBaseUB* pSource, ezUInt8* pTarget, ezBlockCompressionQuality::Enum quality)
+{
+  ezUInt32 uiTransparentMask = 0;
+  for (ezUInt32 i = 0; i < 16; ++i)
+  {
+    if (pSource[i].a < 255)
+    {
+      uiTransparentMask |= 1u << i;
+    }
+  }
+
+  compressColorBlockBC1(pSource, uiTransparentMask, false, quality, pTarget);
+}
+
+void ezCompressBlockBC3(const ezColorBaseUB* pSource, ezUInt8* pTarget, ezBlockCompressionQuality::Enum quality)
+{
+  ezUInt8 alphas[16];
+  for (ezUInt32 i = 0; i < 16; ++i)
+  {
+    alphas[i] = pSource[i].a;
+  }
+
+  compressBlockBC4(alphas, quality, pTarget);
+  compressColorBlockBC1(pSource, 0, true, quality, pTarget + 8);
+}
+
+void ezCompressBlockBC6(const ezColorLinear16f* pSource, ezUInt8* pTarget, ezBlockCompressionQuality::Enum quality)
+{
+  // the interpolation works on the bits of the half floats, so the error is measured on them as well
+  ezInt32 values[16][3];
+  ezSimdVec4f points[16];
+
+  for (ezUInt32 i = 0; i < 16; ++i)
+  {
+    for (ezUInt32 ch = 0; ch < 3; ++ch)
+    {
+      const ezUInt16 uiBits = pSource[i].GetData()[ch].GetRawData();
+
+      if ((uiBits & s_bc6Float16Sign_Mask) != 0 || uiBits > 0x7C00)
+        values[i][ch] = 0; // negative values and NaN
+      else
+        values[i][ch] = ezMath::Min<ezInt32>(uiBits, s_bc6Float16Max); // infinity becomes the largest finite value
+    }
+
+    points[i] = ezSimdVec4f(float(values[i][0]), float(values[i][1]), float(values[i][2]), 0.0f);
+  }
+
+  // indices into s_bc6ModeInfos: 0 - 9 have two regions, 10 - 13 have one region
+  const ezUInt32 uiFirstOneRegionMode = 10;
+  const ezUInt32 uiNumModes = 14;
+
+  ezUInt64 uiBestError = 0xFFFFFFFFFFFFFFFFull;
+  ezUInt8 block[16];
+
+  auto tryMode = [&](ezUInt32 uiModeInfo, ezUInt32 uiShape, const ezSimdVec4f(*pEndpoints)[2]) {
+    const ezUInt64 uiError = encodeBlockBC6(values, uiModeInfo, uiShape, pEndpoints, block);
+
+    if (uiError < uiBestError)
+    {
+      uiBestError = uiError;
+      memcpy(pTarget, block, sizeof(block));
+    }
+  };
+
+  {
+    ezSimdVec4f endpoints[2][2];
+    fitEndpointsBC6(points, 16, 4, quality, endpoints[0][0], endpoints[0][1]);
+
+    // mode 11 stores both endpoints with 10 bits and can always be used, the others store the second endpoint
+    // as a difference with fewer bits but have more precision for the first one
+    tryMode(uiFirstOneRegionMode, 0, endpoints);
+
+    if (quality >= ezBlockCompressionQuality::Normal)
+    {
+      for (ezUInt32 uiModeInfo = uiFirstOneRegionMode + 1; uiModeInfo < uiNumModes; ++uiModeInfo)
+      {
+        tryMode(uiModeInfo, 0, endpoints);
+      }
+    }
+  }
+
+  if (quality == ezBlockCompressionQuality::Fast || uiBestError == 0)
+    return;
+
+  ezUInt32 shapes[4];
+  const ezUInt32 uiNumShapes = findBestPartitions(points, 32, quality == ezBlockCompressionQuality::High ? 4 : 1, shapes);
+
+  for (ezUInt32 s = 0; s < uiNumShapes; ++s)
+  {
+    ezUInt8 subsetPixels[2][16];
+    ezUInt32 uiNumSubsetPixels[2];
+    gatherSubsets(shapes[s], subsetPixels, uiNumSubsetPixels);
+
+    ezSimdVec4f endpoints[2][2];
+    for (ezUInt32 r = 0; r < 2; ++r)
+    {
+      ezSimdVec4f subsetPoints[16];
+      for (ezUInt32 i = 0; i < uiNumSubsetPixels[r]; ++i)
+      {
+        subsetPoints[i] = points[subsetPixels[r][i]];
+      }
+
+      fitEndpointsBC6(subsetPoints, uiNumSubsetPixels[r], 3, quality, endpoints[r][0], endpoints[r][1]);
+    }
+
+    for (ezUInt32 uiModeInfo = 0; uiModeInfo < uiFirstOneRegionMode; ++uiModeInfo)
+    {
+      tryMode(uiModeInfo, shapes[s], endpoints);
+    }
+  }
+}
+
+void ezCompressBlockBC7(const ezColorBaseUB* pSource, ezUInt8* pTarget, ezBlockCompressionQuality::Enum quality)
+{
+  // mode 6 represents smooth blocks well, blocks that contain multiple distinct colors need two subsets
+  ezUInt32 uiBestError = compressMode6BC7(pSource, quality, pTarget);
+
+  // Normal only tries the partitions if the error is noticeable, about 3 units per channel and pixel
+  const ezUInt32 uiErrorThreshold = quality == ezBlockCompressionQuality::High ? 0 : 16 * 4 * 9;
+
+  if (quality == ezBlockCompressionQuality::Fast || uiBestError <= uiErrorThreshold)
+    return;
+
+  bool bOpaque = true;
+  for (ezUInt32 i = 0; i < 16; ++i)
+  {
+    bOpaque = bOpaque && pSource[i].a == 255;
+  }
+
+  const BC7PartitionedModeInfo& mode = bOpaque ? s_bc7Mode1 : s_bc7Mode7;
+
+  ezSimdVec4f points[16];
+  for (ezUInt32 i = 0; i < 16; ++i)
+  {
+    points[i] = ezSimdVec4f(pSource[i].r, pSource[i].g, pSource[i].b, bOpaque ? 0.0f : pSource[i].a);
+  }
+
+  ezUInt32 shapes[4];
+  const ezUInt32 uiNumShapes = findBestPartitions(points, 64, quality == ezBlockCompressionQuality::High ? 4 : 1, shapes);
+
+  for (ezUInt32 i = 0; i < uiNumShapes; ++i)
+  {
+    ezUInt8 block[16];
+    const ezUInt32 uiError = compressPartitionedBC7(pSource, mode, shapes[i], quality, block);
+
+    if (uiError < uiBestError)
+    {
+      uiBestError = uiError;
+      memcpy(pTarget, block, sizeof(block));
+    }
+  }
+}
+
+void ezSetBlockCompressionQuality(ezBlockCompressionQuality::Enum quality)
+{
+  s_iBlockCompressionQuality.Set(quality);
+}
+
+ezBlockCompressionQuality::Enum ezGetBlockCompressionQuality()
+{
+  return static_cast<ezBlockCompressionQuality::Enum>(static_cast<ezInt32>(s_iBlockCompressionQuality));
+}
+
 class ezImageConversion_BC1_RGBA : public ezImageConversionStepDecompressBlocks
 {
 public:
@@ -2117,6 +3508,86 @@ static ezImageConversion_CompressBC5 s_conversion_compressBC5;
 
 #endif
 
+class ezImageConversion_CompressBC1 : public ezImageConversionStepCompressBlocks
+{
+  virtual ezArrayPtr<const ezImageConversionEntry> GetSupportedConversions() const override
+  {
+    static ezImageConversionEntry supportedConversions[] = {
+        makeCompressionEntry(ezImageFormat::R8G8B8A8_UNORM, ezImageFormat::BC1_UNORM),
+        makeCompressionEntry(ezImageFormat::R8G8B8A8_UNORM_SRGB, ezImageFormat::BC1_UNORM_SRGB),
+    };
+    return supportedConversions;
+  }
+
+  virtual ezResult CompressBlocks(ezConstByteBlobPtr source, ezByteBlobPtr target, ezUInt32 numBlocksX, ezUInt32 numBlocksY,
+                                  ezImageFormat::Enum sourceFormat, ezImageFormat::Enum targetFormat) const override
+  {
+    compressBlocksParallel<ezColorBaseUB>(source, target, numBlocksX, numBlocksY, 8, &ezCompressBlockBC1, "Compress BC1");
+    return EZ_SUCCESS;
+  }
+};
+
+class ezImageConversion_CompressBC3 : public ezImageConversionStepCompressBlocks
+{
+  virtual ezArrayPtr<const ezImageConversionEntry> GetSupportedConversions() const override
+  {
+    static ezImageConversionEntry supportedConversions[] = {
+        makeCompressionEntry(ezImageFormat::R8G8B8A8_UNORM, ezImageFormat::BC3_UNORM),
+        makeCompressionEntry(ezImageFormat::R8G8B8A8_UNORM_SRGB, ezImageFormat::BC3_UNORM_SRGB),
+    };
+    return supportedConversions;
+  }
+
+  virtual ezResult CompressBlocks(ezConstByteBlobPtr source, ezByteBlobPtr target, ezUInt32 numBlocksX, ezUInt32 numBlocksY,
+                                  ezImageFormat::Enum sourceFormat, ezImageFormat::Enum targetFormat) const override
+  {
+    compressBlocksParallel<ezColorBaseUB>(source, target, numBlocksX, numBlocksY, 16, &ezCompressBlockBC3, "Compress BC3");
+    return EZ_SUCCESS;
+  }
+};
+
+class ezImageConversion_CompressBC6H : public ezImageConversionStepCompressBlocks
+{
+  virtual ezArrayPtr<const ezImageConversionEntry> GetSupportedConversions() const override
+  {
+    static ezImageConversionEntry supportedConversions[] = {
+        makeCompressionEntry(ezImageFormat::R16G16B16A16_FLOAT, ezImageFormat::BC6H_UF16),
+    };
+    return supportedConversions;
+  }
+
+  virtual ezResult CompressBlocks(ezConstByteBlobPtr source, ezByteBlobPtr target, ezUInt32 numBlocksX, ezUInt32 numBlocksY,
+                                  ezImageFormat::Enum sourceFormat, ezImageFormat::Enum targetFormat) const override
+  {
+    compressBlocksParallel<ezColorLinear16f>(source, target, numBlocksX, numBlocksY, 16, &ezCompressBlockBC6, "Compress BC6H");
+    return EZ_SUCCESS;
+  }
+};
+
+class ezImageConversion_CompressBC7 : public ezImageConversionStepCompressBlocks
+{
+  virtual ezArrayPtr<const ezImageConversionEntry> GetSupportedConversions() const override
+  {
+    static ezImageConversionEntry supportedConversions[] = {
+        makeCompressionEntry(ezImageFormat::R8G8B8A8_UNORM, ezImageFormat::BC7_UNORM),
+        makeCompressionEntry(ezImageFormat::R8G8B8A8_UNORM_SRGB, ezImageFormat::BC7_UNORM_SRGB),
+    };
+    return supportedConversions;
+  }
+
+  virtual ezResult CompressBlocks(ezConstByteBlobPtr source, ezByteBlobPtr target, ezUInt32 numBlocksX, ezUInt32 numBlocksY,
+                                  ezImageFormat::Enum sourceFormat, ezImageFormat::Enum targetFormat) const override
+  {
+    compressBlocksParallel<ezColorBaseUB>(source, target, numBlocksX, numBlocksY, 16, &ezCompressBlockBC7, "Compress BC7");
+    return EZ_SUCCESS;
+  }
+};
+
+static ezImageConversion_CompressBC1 s_conversion_compressBC1;
+static ezImageConversion_CompressBC3 s_conversion_compressBC3;
+static ezImageConversion_CompressBC6H s_conversion_compressBC6H;
+static ezImageConversion_CompressBC7 s_conversion_compressBC7;
+
 static ezImageConversion_BC1_RGBA s_conversion_BC1_RGBA;
 static ezImageConversion_BC2_RGBA s_conversion_BC2_RGBA;
 static ezImageConversion_BC3_RGBA s_conversion_BC3_RGBA;
@@ -4,6 +4,21 @@
 
 class ezColorLinear16f;
 
+/// \brief Quality levels of the block compressors ezCompressBlockBC1(), ezCompressBlockBC3(), ezCompressBlockBC6() and ezCompressBlockBC7().
+struct ezBlockCompressionQuality
+{
+  using StorageType = ezUInt8;
+
+  enum Enum
+  {
+    Fast,   ///< Endpoints are taken from the extent of the block along its principal axis, without any refinement.
+    Normal, ///< Endpoints are refined with a least squares fit, solid blocks are encoded with optimal endpoints.
+    High,   ///< Additionally tries more encodings per block, e.g. all two-subset partitions for opaque BC7 blocks.
+
+    Default = Normal
+  };
+};
+
 EZ_TEXTURE_DLL void ezDecompressBlockBC1(const ezUInt8* pSource, ezColorBaseUB* pTarget, bool bForceFourColorMode);
 EZ_TEXTURE_DLL void ezDecompressBlockBC4(const ezUInt8* pSource, ezUInt8* pTarget, ezUInt32 uiStride, ezUInt8 bias);
 EZ_TEXTURE_DLL void ezDecompressBlockBC6(const ezUInt8* pSource, ezColorLinear16f* pTarget, bool isSigned);
@@ -11,3 +26,19 @@ EZ_TEXTURE_DLL void ezDecompressBlockBC7(const ezUInt8* pSource, ezColorBaseUB*
 
 EZ_TEXTURE_DLL void ezUnpackPaletteBC4(ezUInt32 a0, ezUInt32 a1, ezUInt32* alphas);
 
+/// \brief Compresses 16 pixels (4 rows of 4 pixels) into an 8 byte BC1 block. All pixels that are not fully opaque become transparent,
+/// which matches the alpha threshold that is used with DirectXTex.
+EZ_TEXTURE_DLL void ezCompressBlockBC1(const ezColorBaseUB* pSource, ezUInt8* pTarget, ezBlockCompressionQuality::Enum quality);
+
+/// \brief Compresses 16 pixels (4 rows of 4 pixels) into a 16 byte BC3 block.
+EZ_TEXTURE_DLL void ezCompressBlockBC3(const ezColorBaseUB* pSource, ezUInt8* pTarget, ezBlockCompressionQuality::Enum quality);
+
+/// \brief Compresses 16 pixels (4 rows of 4 pixels) into a 16 byte BC6H_UF16 block. Negative values and NaNs are stored as zero.
+EZ_TEXTURE_DLL void ezCompressBlockBC6(const ezColorLinear16f* pSource, ezUInt8* pTarget, ezBlockCompressionQuality::Enum quality);
+
+/// \brief Compresses 16 pixels (4 rows of 4 pixels) into a 16 byte BC7 block.
+EZ_TEXTURE_DLL void ezCompressBlockBC7(const ezColorBaseUB* pSource, ezUInt8* pTarget, ezBlockCompressionQuality::Enum quality);
+
+/// \brief Sets the quality that ezImageConversion uses for the built-in BC1, BC3, BC6H and BC7 compressors.
+EZ_TEXTURE_DLL void ezSetBlockCompressionQuality(ezBlockCompressionQuality::Enum quality);
+EZ_TEXTURE_DLL ezBlockCompressionQuality::Enum ezGetBlockCompressionQuality();
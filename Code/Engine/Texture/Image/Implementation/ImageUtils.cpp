@@ -3,6 +3,7 @@
 #include <Texture/Image/ImageUtils.h>
 
 #include <Foundation/SimdMath/SimdVec4f.h>
+#include <Foundation/Threading/TaskSystem.h>
 #include <Texture/Image/ImageConversion.h>
 #include <Texture/Image/ImageEnums.h>
 #include <Texture/Image/ImageFilter.h>
@@ -598,7 +599,27 @@ static ezSimdVec4f LoadSample(const ezSimdVec4f* source, ezUInt32 numSourceEleme
   return source[index * stride];
 }
 
-inline static void FilterLine(ezUInt32 numSourceElements, const ezSimdVec4f* __restrict sourceBegin, ezSimdVec4f* __restrict targetBegin,
+/// Computes one output sample in the interior of a line, where no address mode has to be applied.
+/// NumWeights is a compile time constant for the filter sizes that are used most (box and triangle filters for halving and
+/// Kaiser filters for halving), so that the loop is fully unrolled. The multiply-adds are executed in the same order in all cases,
+/// so the result does not depend on which kernel is used.
+template <ezUInt32 NumWeights>
+EZ_ALWAYS_INLINE static ezSimdVec4f FilterSample(
+  const ezSimdVec4f* __restrict sourcePtr, ezUInt32 stride, const float* __restrict weightPtr, ezUInt32 numWeights)
+{
+  const ezUInt32 numIterations = NumWeights > 0 ? NumWeights : numWeights;
+
+  ezSimdVec4f total(0.0f, 0.0f, 0.0f, 0.0f);
+  for (ezUInt32 weightIdx = 0; weightIdx < numIterations; ++weightIdx)
+  {
+    total = ezSimdVec4f::MulAdd(*sourcePtr, ezSimdVec4f(weightPtr[weightIdx]), total);
+    sourcePtr += stride;
+  }
+  return total;
+}
+
+template <ezUInt32 NumWeights>
+static void FilterLine(ezUInt32 numSourceElements, const ezSimdVec4f* __restrict sourceBegin, ezSimdVec4f* __restrict targetBegin,
   ezUInt32 stride, const ezImageFilterWeights& weights, ezArrayPtr<const ezInt32> firstSampleIndices, ezImageAddressMode::Enum addressMode,
   const ezSimdVec4f& borderColor)
 {
@@ -614,21 +635,18 @@ inline static void FilterLine(ezUInt32 numSourceElements, const ezSimdVec4f* __r
   EZ_ASSERT_DEBUG((static_cast<ezUInt32>(weightsView.GetCount()) % numWeights) == 0, "");
   for (ezInt32 firstSourceIdx : firstSampleIndices)
   {
-    ezSimdVec4f total(0.0f, 0.0f, 0.0f, 0.0f);
+    ezSimdVec4f total;
 
     if (firstSourceIdx >= 0 && firstSourceIdx < trivialSourceIndicesEnd)
     {
-      const auto* __restrict sourcePtr = sourceBegin + firstSourceIdx * stride;
-      for (ezUInt32 weightIdx = 0; weightIdx < numWeights; ++weightIdx)
-      {
-        total = ezSimdVec4f::MulAdd(*sourcePtr, ezSimdVec4f(*nextWeightPtr++), total);
-        sourcePtr += stride;
-      }
+      total = FilterSample<NumWeights>(sourceBegin + firstSourceIdx * stride, stride, nextWeightPtr, numWeights);
+      nextWeightPtr += numWeights;
     }
     else
     {
       // Very slow fallback case that respects the addressMode
       // (not a lot of pixels are taking this path, so it's probably fine)
+      total.SetZero();
       ezInt32 sourceIdx = firstSourceIdx;
       for (ezUInt32 weightIdx = 0; weightIdx < numWeights; ++weightIdx)
       {
@@ -648,6 +666,100 @@ inline static void FilterLine(ezUInt32 numSourceElements, const ezSimdVec4f* __r
   }
 }
 
+using FilterLineFunc = void (*)(ezUInt32, const ezSimdVec4f* __restrict, ezSimdVec4f* __restrict, ezUInt32, const ezImageFilterWeights&,
+  ezArrayPtr<const ezInt32>, ezImageAddressMode::Enum, const ezSimdVec4f&);
+
+static FilterLineFunc GetFilterLineFunc(ezUInt32 numWeights)
+{
+  switch (numWeights)
+  {
+    case 3:
+      return &FilterLine<3>; // box filter, halving
+    case 5:
+      return &FilterLine<5>; // triangle filter, halving
+    case 13:
+      return &FilterLine<13>; // Kaiser filter, halving
+    default:
+      return &FilterLine<0>;
+  }
+}
+
+/// Filters all lines of the image along the given axis (0 = x, 1 = y, 2 = z). The target must have the same size as the source,
+/// except along the filtered axis.
+///
+/// The lines of all faces and array slices are distributed over tasks. Each line is written by exactly one task and
+/// is computed exactly as in a serial loop, so the result does not depend on the number of threads.
+static void FilterLines(const ezImageView& source, ezImage& target, ezUInt32 axis, const ezImageFilterWeights& weights,
+  ezArrayPtr<const ezInt32> firstSampleIndices, ezImageAddressMode::Enum addressMode, const ezColor& borderColor, bool bParallel)
+{
+  struct Context
+  {
+    const ezImageView* m_pSource;
+    ezImage* m_pTarget;
+    const ezImageFilterWeights* m_pWeights;
+    ezArrayPtr<const ezInt32> m_FirstSampleIndices;
+    ezImageAddressMode::Enum m_AddressMode;
+    ezSimdVec4f m_BorderColor;
+    FilterLineFunc m_FilterLine;
+    ezUInt32 m_uiNumSourceElements;
+    ezUInt32 m_uiStride;
+    ezUInt32 m_uiInnerAxis;
+    ezUInt32 m_uiOuterAxis;
+    ezUInt32 m_uiInnerSize;
+    ezUInt32 m_uiOuterSize;
+    ezUInt32 m_uiNumFaces;
+  };
+
+  const ezUInt32 targetSize[3] = {target.GetWidth(), target.GetHeight(), target.GetDepth()};
+  const ezUInt32 sourceSize[3] = {source.GetWidth(), source.GetHeight(), source.GetDepth()};
+
+  Context context;
+  context.m_pSource = &source;
+  context.m_pTarget = &target;
+  context.m_pWeights = &weights;
+  context.m_FirstSampleIndices = firstSampleIndices;
+  context.m_AddressMode = addressMode;
+  context.m_BorderColor.Set(borderColor.r, borderColor.g, borderColor.b, borderColor.a);
+  context.m_FilterLine = GetFilterLineFunc(weights.GetNumWeights());
+  context.m_uiNumSourceElements = sourceSize[axis];
+  context.m_uiStride = axis == 0 ? 1 : (axis == 1 ? targetSize[0] : targetSize[0] * targetSize[1]);
+  // the lines are enumerated along the two other axes, the lower one changing fastest
+  context.m_uiInnerAxis = axis == 0 ? 1 : 0;
+  context.m_uiOuterAxis = axis == 2 ? 1 : 2;
+  context.m_uiInnerSize = targetSize[context.m_uiInnerAxis];
+  context.m_uiOuterSize = targetSize[context.m_uiOuterAxis];
+  context.m_uiNumFaces = target.GetNumFaces();
+
+  const ezUInt32 numLinesPerFace = context.m_uiInnerSize * context.m_uiOuterSize;
+  const ezUInt32 numLines = target.GetNumArrayIndices() * context.m_uiNumFaces * numLinesPerFace;
+
+  auto filterLines = [&context, numLinesPerFace](ezUInt32 startLine, ezUInt32 endLine) {
+    for (ezUInt32 line = startLine; line < endLine; ++line)
+    {
+      const ezUInt32 lineInFace = line % numLinesPerFace;
+      const ezUInt32 faceAndArrayIndex = line / numLinesPerFace;
+
+      ezUInt32 coords[3] = {0, 0, 0};
+      coords[context.m_uiInnerAxis] = lineInFace % context.m_uiInnerSize;
+      coords[context.m_uiOuterAxis] = lineInFace / context.m_uiInnerSize;
+
+      const ezUInt32 face = faceAndArrayIndex % context.m_uiNumFaces;
+      const ezUInt32 arrayIndex = faceAndArrayIndex / context.m_uiNumFaces;
+
+      const ezSimdVec4f* filterSource = context.m_pSource->GetPixelPointer<ezSimdVec4f>(0, face, arrayIndex, coords[0], coords[1], coords[2]);
+      ezSimdVec4f* filterTarget = context.m_pTarget->GetPixelPointer<ezSimdVec4f>(0, face, arrayIndex, coords[0], coords[1], coords[2]);
+      context.m_FilterLine(context.m_uiNumSourceElements, filterSource, filterTarget, context.m_uiStride, *context.m_pWeights,
+        context.m_FirstSampleIndices, context.m_AddressMode, context.m_BorderColor);
+    }
+  };
+
+  ezParallelForParams params;
+  // small images (e.g. the lower mip levels) are not worth splitting up into tasks
+  params.uiBinSize = bParallel ? ezMath::Max(1u, 16384u / (targetSize[axis] * weights.GetNumWeights())) : ezMath::MaxValue<ezUInt32>();
+
+  ezTaskSystem::ParallelForIndexed(0, numLines, filterLines, "ezImageUtils::FilterLines", params);
+}
+
 static void DownScaleFastLine(
   ezUInt32 pixelStride, const ezUInt8* src, ezUInt8* dest, ezUInt32 lengthIn, ezUInt32 strideIn, ezUInt32 lengthOut, ezUInt32 strideOut)
 {
@@ -676,7 +788,7 @@ static void DownScaleFastLine(
   }
 }
 
-static void DownScaleFast(const ezImageView& image, ezImage& out_Result, ezUInt32 width, ezUInt32 height)
+static void DownScaleFast(const ezImageView& image, ezImage& out_Result, ezUInt32 width, ezUInt32 height, bool bParallel)
 {
   ezImageFormat::Enum format = image.GetImageFormat();
 
@@ -697,17 +809,24 @@ static void DownScaleFast(const ezImageView& image, ezImage& out_Result, ezUInt3
   ezImage intermediate;
   intermediate.ResetAndAlloc(intermediateHeader);
 
-  for (ezUInt32 arrayIndex = 0; arrayIndex < numArrayElements; arrayIndex++)
-  {
-    for (ezUInt32 face = 0; face < numFaces; face++)
-    {
-      for (ezUInt32 row = 0; row < originalHeight; row++)
+  // rows and columns are independent of each other, so they are distributed over tasks
+  ezParallelForParams params;
+  params.uiBinSize = bParallel ? 64 : ezMath::MaxValue<ezUInt32>();
+
+  ezTaskSystem::ParallelForIndexed(
+    0, numArrayElements * numFaces * originalHeight,
+    [&image, &intermediate, pixelStride, originalWidth, originalHeight, numFaces, width](ezUInt32 startRow, ezUInt32 endRow) {
+      for (ezUInt32 i = startRow; i < endRow; ++i)
       {
+        const ezUInt32 row = i % originalHeight;
+        const ezUInt32 face = (i / originalHeight) % numFaces;
+        const ezUInt32 arrayIndex = i / (originalHeight * numFaces);
+
         DownScaleFastLine(pixelStride, image.GetPixelPointer<ezUInt8>(0, face, arrayIndex, 0, row),
           intermediate.GetPixelPointer<ezUInt8>(0, face, arrayIndex, 0, row), originalWidth, pixelStride, width, pixelStride);
       }
-    }
-  }
+    },
+    "ezImageUtils::DownScaleFast", params);
 
   // input and output images may be the same, so we can't access the original image below this point
 
@@ -723,18 +842,21 @@ static void DownScaleFast(const ezImageView& image, ezImage& out_Result, ezUInt3
   EZ_ASSERT_DEBUG(intermediate.GetRowPitch() < ezMath::MaxValue<ezUInt32>(), "Row pitch exceeds ezUInt32 max value.");
   EZ_ASSERT_DEBUG(out_Result.GetRowPitch() < ezMath::MaxValue<ezUInt32>(), "Row pitch exceeds ezUInt32 max value.");
 
-  for (ezUInt32 arrayIndex = 0; arrayIndex < numArrayElements; arrayIndex++)
-  {
-    for (ezUInt32 face = 0; face < numFaces; face++)
-    {
-      for (ezUInt32 col = 0; col < width; col++)
+  ezTaskSystem::ParallelForIndexed(
+    0, numArrayElements * numFaces * width,
+    [&intermediate, &out_Result, pixelStride, originalHeight, numFaces, width, height](ezUInt32 startCol, ezUInt32 endCol) {
+      for (ezUInt32 i = startCol; i < endCol; ++i)
       {
+        const ezUInt32 col = i % width;
+        const ezUInt32 face = (i / width) % numFaces;
+        const ezUInt32 arrayIndex = i / (width * numFaces);
+
         DownScaleFastLine(pixelStride, intermediate.GetPixelPointer<ezUInt8>(0, face, arrayIndex, col),
-          out_Result.GetPixelPointer<ezUInt8>(0, face, arrayIndex, col), originalHeight, static_cast<ezUInt32>(intermediate.GetRowPitch()), height,
-          static_cast<ezUInt32>(out_Result.GetRowPitch()));
+          out_Result.GetPixelPointer<ezUInt8>(0, face, arrayIndex, col), originalHeight, static_cast<ezUInt32>(intermediate.GetRowPitch()),
+          height, static_cast<ezUInt32>(out_Result.GetRowPitch()));
       }
-    }
-  }
+    },
+    "ezImageUtils::DownScaleFast", params);
 }
 
 static float EvaluateAverageCoverage(ezBlobPtr<const ezColor> colors, float alphaThreshold)
@@ -822,10 +944,9 @@ ezResult ezImageUtils::Scale(const ezImageView& source, ezImage& target, ezUInt3
   return Scale3D(source, target, width, height, 1, filter, addressModeU, addressModeV, ezImageAddressMode::Clamp, borderColor);
 }
 
-ezResult ezImageUtils::Scale3D(const ezImageView& source, ezImage& target, ezUInt32 width, ezUInt32 height, ezUInt32 depth,
-  const ezImageFilter* filter /*= ez_NULL*/, ezImageAddressMode::Enum addressModeU /*= ezImageAddressMode::Clamp*/,
-  ezImageAddressMode::Enum addressModeV /*= ezImageAddressMode::Clamp*/,
-  ezImageAddressMode::Enum addressModeW /*= ezImageAddressMode::Clamp*/, const ezColor& borderColor /*= ezColors::Black*/)
+static ezResult Scale3DInternal(const ezImageView& source, ezImage& target, ezUInt32 width, ezUInt32 height, ezUInt32 depth,
+  const ezImageFilter* filter, ezImageAddressMode::Enum addressModeU, ezImageAddressMode::Enum addressModeV,
+  ezImageAddressMode::Enum addressModeW, const ezColor& borderColor, bool bParallel)
 {
   if (width == 0 || height == 0 || depth == 0)
   {
@@ -840,8 +961,6 @@ ezResult ezImageUtils::Scale3D(const ezImageView& source, ezImage& target, ezUIn
   const ezUInt32 originalWidth = source.GetWidth();
   const ezUInt32 originalHeight = source.GetHeight();
   const ezUInt32 originalDepth = source.GetDepth();
-  const ezUInt32 numFaces = source.GetNumFaces();
-  const ezUInt32 numArrayElements = source.GetNumArrayIndices();
 
   if (originalWidth == width && originalHeight == height && originalDepth == depth)
   {
@@ -858,7 +977,7 @@ ezResult ezImageUtils::Scale3D(const ezImageView& source, ezImage& target, ezUIn
       downScaleFactorX * width == originalWidth && downScaleFactorY * height == originalHeight && depth == 1 && originalDepth == 1 &&
       ezMath::IsPowerOf2(downScaleFactorX) && ezMath::IsPowerOf2(downScaleFactorY))
   {
-    DownScaleFast(source, target, width, height);
+    DownScaleFast(source, target, width, height, bParallel);
     return EZ_SUCCESS;
   }
 
@@ -938,22 +1057,7 @@ ezResult ezImageUtils::Scale3D(const ezImageView& source, ezImage& target, ezUIn
     stepHeader.SetWidth(width);
     stepTarget->ResetAndAlloc(stepHeader);
 
-    for (ezUInt32 arrayIndex = 0; arrayIndex < numArrayElements; ++arrayIndex)
-    {
-      for (ezUInt32 face = 0; face < numFaces; ++face)
-      {
-        for (ezUInt32 z = 0; z < originalDepth; ++z)
-        {
-          for (ezUInt32 y = 0; y < originalHeight; ++y)
-          {
-            const ezSimdVec4f* filterSource = stepSource->GetPixelPointer<ezSimdVec4f>(0, face, arrayIndex, 0, y, z);
-            ezSimdVec4f* filterTarget = stepTarget->GetPixelPointer<ezSimdVec4f>(0, face, arrayIndex, 0, y, z);
-            FilterLine(originalWidth, filterSource, filterTarget, 1, weights, firstSampleIndices, addressModeU,
-              ezSimdVec4f(borderColor.r, borderColor.g, borderColor.b, borderColor.a));
-          }
-        }
-      }
-    }
+    FilterLines(*stepSource, *stepTarget, 0, weights, firstSampleIndices, addressModeU, borderColor, bParallel);
 
     releaseScratch(*stepSource);
     stepSource = stepTarget;
@@ -982,22 +1086,7 @@ ezResult ezImageUtils::Scale3D(const ezImageView& source, ezImage& target, ezUIn
     stepHeader.SetHeight(height);
     stepTarget->ResetAndAlloc(stepHeader);
 
-    for (ezUInt32 arrayIndex = 0; arrayIndex < numArrayElements; ++arrayIndex)
-    {
-      for (ezUInt32 face = 0; face < numFaces; ++face)
-      {
-        for (ezUInt32 z = 0; z < originalDepth; ++z)
-        {
-          for (ezUInt32 x = 0; x < width; ++x)
-          {
-            const ezSimdVec4f* filterSource = stepSource->GetPixelPointer<ezSimdVec4f>(0, face, arrayIndex, x, 0, z);
-            ezSimdVec4f* filterTarget = stepTarget->GetPixelPointer<ezSimdVec4f>(0, face, arrayIndex, x, 0, z);
-            FilterLine(originalHeight, filterSource, filterTarget, width, weights, firstSampleIndices, addressModeV,
-              ezSimdVec4f(borderColor.r, borderColor.g, borderColor.b, borderColor.a));
-          }
-        }
-      }
-    }
+    FilterLines(*stepSource, *stepTarget, 1, weights, firstSampleIndices, addressModeV, borderColor, bParallel);
 
     releaseScratch(*stepSource);
     stepSource = stepTarget;
@@ -1026,22 +1115,7 @@ ezResult ezImageUtils::Scale3D(const ezImageView& source, ezImage& target, ezUIn
     stepHeader.SetDepth(depth);
     stepTarget->ResetAndAlloc(stepHeader);
 
-    for (ezUInt32 arrayIndex = 0; arrayIndex < numArrayElements; ++arrayIndex)
-    {
-      for (ezUInt32 face = 0; face < numFaces; ++face)
-      {
-        for (ezUInt32 y = 0; y < height; ++y)
-        {
-          for (ezUInt32 x = 0; x < width; ++x)
-          {
-            const ezSimdVec4f* filterSource = stepSource->GetPixelPointer<ezSimdVec4f>(0, face, arrayIndex, x, y, 0);
-            ezSimdVec4f* filterTarget = stepTarget->GetPixelPointer<ezSimdVec4f>(0, face, arrayIndex, x, y, 0);
-            FilterLine(originalHeight, filterSource, filterTarget, width * height, weights, firstSampleIndices, addressModeW,
-              ezSimdVec4f(borderColor.r, borderColor.g, borderColor.b, borderColor.a));
-          }
-        }
-      }
-    }
+    FilterLines(*stepSource, *stepTarget, 2, weights, firstSampleIndices, addressModeW, borderColor, bParallel);
 
     releaseScratch(*stepSource);
     stepSource = stepTarget;
@@ -1051,6 +1125,56 @@ ezResult ezImageUtils::Scale3D(const ezImageView& source, ezImage& target, ezUIn
   return ezImageConversion::Convert(*stepSource, target, format);
 }
 
+ezResult ezImageUtils::Scale3D(const ezImageView& source, ezImage& target, ezUInt32 width, ezUInt32 height, ezUInt32 depth,
+  const ezImageFilter* filter /*= ez_NULL*/, ezImageAddressMode::Enum addressModeU /*= ezImageAddressMode::Clamp*/,
+  ezImageAddressMode::Enum addressModeV /*= ezImageAddressMode::Clamp*/,
+  ezImageAddressMode::Enum addressModeW /*= ezImageAddressMode::Clamp*/, const ezColor& borderColor /*= ezColors::Black*/)
+{
+  return Scale3DInternal(source, target, width, height, depth, filter, addressModeU, addressModeV, addressModeW, borderColor, true);
+}
+
+/// Fills all mip levels of one face of one array slice of the target. The top mip level must already be present in the target.
+static void GenerateMipMapsForSubImage(
+  ezImage& target, ezUInt32 face, ezUInt32 arrayIndex, float targetCoverage, const ezImageUtils::MipMapOptions& mipMapOptions, bool bParallel)
+{
+  ezImageHeader currentMipMapHeader = target.GetHeader();
+  currentMipMapHeader.SetNumMipLevels(1);
+  currentMipMapHeader.SetNumFaces(1);
+  currentMipMapHeader.SetNumArrayIndices(1);
+
+  for (ezUInt32 mipMapLevel = 0; mipMapLevel < target.GetNumMipLevels() - 1; mipMapLevel++)
+  {
+    ezImageHeader nextMipMapHeader = currentMipMapHeader;
+    nextMipMapHeader.SetWidth(ezMath::Max(1u, nextMipMapHeader.GetWidth() / 2));
+    nextMipMapHeader.SetHeight(ezMath::Max(1u, nextMipMapHeader.GetHeight() / 2));
+    nextMipMapHeader.SetDepth(ezMath::Max(1u, nextMipMapHeader.GetDepth() / 2));
+
+    auto sourceData = target.GetSubImageView(mipMapLevel, face, arrayIndex).GetByteBlobPtr();
+    ezImage currentMipMap;
+    currentMipMap.ResetAndUseExternalStorage(currentMipMapHeader, sourceData);
+
+    auto dstData = target.GetSubImageView(mipMapLevel + 1, face, arrayIndex).GetByteBlobPtr();
+    ezImage nextMipMap;
+    nextMipMap.ResetAndUseExternalStorage(nextMipMapHeader, dstData);
+
+    Scale3DInternal(currentMipMap, nextMipMap, nextMipMapHeader.GetWidth(), nextMipMapHeader.GetHeight(), nextMipMapHeader.GetDepth(),
+      mipMapOptions.m_filter, mipMapOptions.m_addressModeU, mipMapOptions.m_addressModeV, mipMapOptions.m_addressModeW,
+      mipMapOptions.m_borderColor, bParallel);
+
+    if (mipMapOptions.m_preserveCoverage)
+    {
+      NormalizeCoverage(nextMipMap.GetBlobPtr<ezColor>(), mipMapOptions.m_alphaThreshold, targetCoverage);
+    }
+
+    if (mipMapOptions.m_renormalizeNormals)
+    {
+      ezImageUtils::RenormalizeNormalMap(nextMipMap);
+    }
+
+    currentMipMapHeader = nextMipMapHeader;
+  }
+}
+
 void ezImageUtils::GenerateMipMaps(const ezImageView& source, ezImage& target, const MipMapOptions& options)
 {
   ezImageHeader header = source.GetHeader();
@@ -1079,60 +1203,40 @@ void ezImageUtils::GenerateMipMaps(const ezImageView& source, ezImage& target, c
 
   target.ResetAndAlloc(header);
 
-  for (ezUInt32 arrayIndex = 0; arrayIndex < source.GetNumArrayIndices(); arrayIndex++)
-  {
-    for (ezUInt32 face = 0; face < source.GetNumFaces(); face++)
-    {
-      ezImageHeader currentMipMapHeader = header;
-      currentMipMapHeader.SetNumMipLevels(1);
-      currentMipMapHeader.SetNumFaces(1);
-      currentMipMapHeader.SetNumArrayIndices(1);
-
-      auto sourceView = source.GetSubImageView(0, face, arrayIndex).GetByteBlobPtr();
-      auto targetView = target.GetSubImageView(0, face, arrayIndex).GetByteBlobPtr();
+  const ezUInt32 numFaces = source.GetNumFaces();
+  const ezUInt32 numSubImages = source.GetNumArrayIndices() * numFaces;
 
-      memcpy(targetView.GetPtr(), sourceView.GetPtr(), targetView.GetCount());
+  // The mip chains of the faces and array slices are independent of each other. When there are several, each task works on
+  // whole mip chains, otherwise the rows of each mip level are distributed over tasks.
+  const bool bParallelSubImages = numSubImages > 1;
 
-      float targetCoverage = 0.0f;
-      if (mipMapOptions.m_preserveCoverage)
-      {
-        targetCoverage =
-          EvaluateAverageCoverage(source.GetSubImageView(0, face, arrayIndex).GetBlobPtr<ezColor>(), mipMapOptions.m_alphaThreshold);
-      }
+  ezParallelForParams params;
+  params.uiBinSize = bParallelSubImages ? 1 : ezMath::MaxValue<ezUInt32>();
 
-      for (ezUInt32 mipMapLevel = 0; mipMapLevel < numMipMaps - 1; mipMapLevel++)
+  ezTaskSystem::ParallelForIndexed(
+    0, numSubImages,
+    [&source, &target, &mipMapOptions, numFaces, bParallelSubImages](ezUInt32 startIndex, ezUInt32 endIndex) {
+      for (ezUInt32 subImage = startIndex; subImage < endIndex; ++subImage)
       {
-        ezImageHeader nextMipMapHeader = currentMipMapHeader;
-        nextMipMapHeader.SetWidth(ezMath::Max(1u, nextMipMapHeader.GetWidth() / 2));
-        nextMipMapHeader.SetHeight(ezMath::Max(1u, nextMipMapHeader.GetHeight() / 2));
-        nextMipMapHeader.SetDepth(ezMath::Max(1u, nextMipMapHeader.GetDepth() / 2));
+        const ezUInt32 face = subImage % numFaces;
+        const ezUInt32 arrayIndex = subImage / numFaces;
 
-        auto sourceData = target.GetSubImageView(mipMapLevel, face, arrayIndex).GetByteBlobPtr();
-        ezImage currentMipMap;
-        currentMipMap.ResetAndUseExternalStorage(currentMipMapHeader, sourceData);
+        auto sourceView = source.GetSubImageView(0, face, arrayIndex).GetByteBlobPtr();
+        auto targetView = target.GetSubImageView(0, face, arrayIndex).GetByteBlobPtr();
 
-        auto dstData = target.GetSubImageView(mipMapLevel + 1, face, arrayIndex).GetByteBlobPtr();
-        ezImage nextMipMap;
-        nextMipMap.ResetAndUseExternalStorage(nextMipMapHeader, dstData);
-
-        ezImageUtils::Scale3D(currentMipMap, nextMipMap, nextMipMapHeader.GetWidth(), nextMipMapHeader.GetHeight(),
-          nextMipMapHeader.GetDepth(), mipMapOptions.m_filter, mipMapOptions.m_addressModeU, mipMapOptions.m_addressModeV,
-          mipMapOptions.m_addressModeW, mipMapOptions.m_borderColor);
+        memcpy(targetView.GetPtr(), sourceView.GetPtr(), targetView.GetCount());
 
+        float targetCoverage = 0.0f;
         if (mipMapOptions.m_preserveCoverage)
         {
-          NormalizeCoverage(nextMipMap.GetBlobPtr<ezColor>(), mipMapOptions.m_alphaThreshold, targetCoverage);
-        }
-
-        if (mipMapOptions.m_renormalizeNormals)
-        {
-          RenormalizeNormalMap(nextMipMap);
+          targetCoverage =
+            EvaluateAverageCoverage(source.GetSubImageView(0, face, arrayIndex).GetBlobPtr<ezColor>(), mipMapOptions.m_alphaThreshold);
         }
 
-        currentMipMapHeader = nextMipMapHeader;
+        GenerateMipMapsForSubImage(target, face, arrayIndex, targetCoverage, mipMapOptions, !bParallelSubImages);
       }
-    }
-  }
+    },
+    "ezImageUtils::GenerateMipMaps", params);
 }
 
 void ezImageUtils::ReconstructNormalZ(ezImage& image)
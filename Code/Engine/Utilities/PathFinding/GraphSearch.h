@@ -1,5 +1,8 @@
 #pragma once
 
+#include <Foundation/Containers/Bitfield.h>
+#include <Foundation/Containers/Deque.h>
+#include <Foundation/Containers/HashTable.h>
 #include <Foundation/Math/Math.h>
 #include <Utilities/UtilitiesDLL.h>
 #include <Utilities/PathFinding/PathState.h>
@@ -56,16 +59,58 @@ public:
   /// \brief Needs to be called by the used ezPathStateGenerator to add nodes to evaluate.
   void AddPathNode(ezInt64 iNodeIndex, const PathStateType& NewState);
 
+  /// \brief Enables the dense node index mode, if all node indices of the graph are in the range [0; uiNumNodes).
+  ///
+  /// By default the path states are stored in a hash table, which works with arbitrary node indices. When the graph uses contiguous
+  /// node indices, for example the cell indices of a grid, the states can instead be stored in an array that is indexed by the node index
+  /// directly, which is a lot faster. The array is allocated once and reused by all following searches, so it costs memory proportional
+  /// to the number of nodes in the graph. Pass zero to switch back to the hash table.
+  void SetDenseNodeIndexRange(ezUInt32 uiNumNodes);
+
 private:
+  struct NodeData
+  {
+    PathStateType m_State;
+
+    /// The node index in the graph.
+    ezInt64 m_iNodeIndex;
+
+    /// The position of this node in m_OpenList or ezInvalidIndex, if it is not (or not anymore) waiting to be expanded.
+    ezUInt32 m_uiOpenListIndex;
+  };
+
+  struct OpenListEntry
+  {
+    EZ_DECLARE_POD_TYPE();
+
+    float m_fEstimatedCostToTarget;
+    ezUInt32 m_uiNode;
+  };
+
   void ClearPathStates();
+  PathStateType* GetPathState(ezInt64 iNodeIndex);
+  ezUInt32 AddNode(ezInt64 iNodeIndex);
+  ezUInt32 FindNode(ezInt64 iNodeIndex) const;
+
+  void AddToOpenList(ezUInt32 uiNode);
+  void UpdateInOpenList(ezUInt32 uiNode);
+  void SetOpenListEntry(ezUInt32 uiIndex, const OpenListEntry& entry);
+  void MoveUpInOpenList(ezUInt32 uiIndex);
+  void MoveDownInOpenList(ezUInt32 uiIndex);
   ezInt64 FindBestNodeToExpand(PathStateType*& out_pPathState);
   void FillOutPathResult(ezInt64 iEndNodeIndex, ezDeque<PathResultData>& out_Path);
 
   ezPathStateGenerator<PathStateType>* m_pStateGenerator;
 
-  ezHashTable<ezInt64, PathStateType> m_PathStates;
+  // All nodes that were reached during the current search. In dense mode the array is indexed by the node index directly
+  // and m_VisitedNodes tells which of the entries belong to the current search. Otherwise m_NodeLookup maps node indices to array indices.
+  ezDynamicArray<NodeData> m_Nodes;
+  ezHashTable<ezInt64, ezUInt32> m_NodeLookup;
+  ezDynamicBitfield m_VisitedNodes;
+  ezUInt32 m_uiDenseNodeIndexRange = 0;
 
-  ezDeque<ezInt64> m_StateQueue;
+  // min-heap of all nodes that still need to be expanded, ordered by their estimated costs
+  ezDynamicArray<OpenListEntry> m_OpenList;
 
   ezInt64 m_iCurNodeIndex;
   PathStateType m_CurState;
@@ -50,6 +50,9 @@ public:
   /// \brief Returns the index of the ConvexArea at the given cell coordinates. Negative, if the cell is blocked.
   ezInt32 GetAreaAt(const ezVec2I32& Coord) const { return m_NodesGrid.GetCell(Coord); }
 
+  /// \brief Returns whether the given cell coordinates are inside the grid from which the navmesh was created.
+  bool IsValidCellCoordinate(const ezVec2I32& Coord) const { return m_NodesGrid.IsValidCellCoordinate(Coord); }
+
   /// \brief Returns the number of convex areas that this navmesh consists of.
   ezUInt32 GetNumConvexAreas() const { return m_ConvexAreas.GetCount(); }
 
@@ -1,39 +1,190 @@
 #pragma once
 
+template <typename PathStateType>
+void ezPathSearch<PathStateType>::SetDenseNodeIndexRange(ezUInt32 uiNumNodes)
+{
+  m_uiDenseNodeIndexRange = uiNumNodes;
+
+  m_Nodes.Clear();
+  m_NodeLookup.Clear();
+  m_OpenList.Clear();
+
+  if (uiNumNodes > 0)
+  {
+    m_Nodes.SetCount(uiNumNodes);
+    m_VisitedNodes.SetCount(uiNumNodes, false);
+  }
+  else
+  {
+    m_Nodes.Compact();
+    m_VisitedNodes.Clear();
+  }
+}
+
 template <typename PathStateType>
 void ezPathSearch<PathStateType>::ClearPathStates()
 {
-  m_PathStates.Clear();
-  m_StateQueue.Clear();
+  if (m_uiDenseNodeIndexRange > 0)
+  {
+    m_VisitedNodes.ClearAllBits();
+  }
+  else
+  {
+    m_Nodes.Clear();
+    m_NodeLookup.Clear();
+  }
+
+  m_OpenList.Clear();
 }
 
 template <typename PathStateType>
-ezInt64 ezPathSearch<PathStateType>::FindBestNodeToExpand(PathStateType*& out_pPathState)
+EZ_ALWAYS_INLINE ezUInt32 ezPathSearch<PathStateType>::FindNode(ezInt64 iNodeIndex) const
+{
+  if (m_uiDenseNodeIndexRange > 0)
+  {
+    EZ_ASSERT_DEBUG(iNodeIndex >= 0 && iNodeIndex < m_uiDenseNodeIndexRange, "Node index {0} is outside the dense node index range", iNodeIndex);
+
+    const ezUInt32 uiNode = static_cast<ezUInt32>(iNodeIndex);
+    return m_VisitedNodes.IsBitSet(uiNode) ? uiNode : ezInvalidIndex;
+  }
+
+  ezUInt32 uiNode = ezInvalidIndex;
+  m_NodeLookup.TryGetValue(iNodeIndex, uiNode);
+  return uiNode;
+}
+
+template <typename PathStateType>
+PathStateType* ezPathSearch<PathStateType>::GetPathState(ezInt64 iNodeIndex)
+{
+  const ezUInt32 uiNode = FindNode(iNodeIndex);
+  return uiNode != ezInvalidIndex ? &m_Nodes[uiNode].m_State : nullptr;
+}
+
+template <typename PathStateType>
+ezUInt32 ezPathSearch<PathStateType>::AddNode(ezInt64 iNodeIndex)
 {
-  float fLowestEstimation = ezMath::Infinity<float>();
-  out_pPathState = nullptr;
-  ezUInt32 iBestInQueue = 0;
+  ezUInt32 uiNode;
 
-  for (ezUInt32 i = 0; i < m_StateQueue.GetCount(); ++i)
+  if (m_uiDenseNodeIndexRange > 0)
   {
-    const ezInt64 iNodeIndex = m_StateQueue[i];
+    EZ_ASSERT_DEV(iNodeIndex >= 0 && iNodeIndex < m_uiDenseNodeIndexRange, "Node index {0} is outside the dense node index range", iNodeIndex);
 
-    PathStateType* pState = &m_PathStates[iNodeIndex];
+    uiNode = static_cast<ezUInt32>(iNodeIndex);
+    m_VisitedNodes.SetBit(uiNode);
+  }
+  else
+  {
+    uiNode = m_Nodes.GetCount();
+    m_Nodes.ExpandAndGetRef();
+    m_NodeLookup.Insert(iNodeIndex, uiNode);
+  }
 
-    if (pState->m_fEstimatedCostToTarget < fLowestEstimation)
-    {
-      fLowestEstimation = pState->m_fEstimatedCostToTarget;
-      out_pPathState = pState;
-      iBestInQueue = i;
-    }
+  NodeData& node = m_Nodes[uiNode];
+  node.m_iNodeIndex = iNodeIndex;
+  node.m_uiOpenListIndex = ezInvalidIndex;
+  return uiNode;
+}
+
+template <typename PathStateType>
+void ezPathSearch<PathStateType>::AddToOpenList(ezUInt32 uiNode)
+{
+  OpenListEntry entry;
+  entry.m_fEstimatedCostToTarget = m_Nodes[uiNode].m_State.m_fEstimatedCostToTarget;
+  entry.m_uiNode = uiNode;
+
+  m_OpenList.PushBack(entry);
+  MoveUpInOpenList(m_OpenList.GetCount() - 1);
+}
+
+template <typename PathStateType>
+void ezPathSearch<PathStateType>::UpdateInOpenList(ezUInt32 uiNode)
+{
+  const ezUInt32 uiIndex = m_Nodes[uiNode].m_uiOpenListIndex;
+  OpenListEntry& entry = m_OpenList[uiIndex];
+
+  const float fNewEstimation = m_Nodes[uiNode].m_State.m_fEstimatedCostToTarget;
+  const bool bDecreased = fNewEstimation < entry.m_fEstimatedCostToTarget;
+  entry.m_fEstimatedCostToTarget = fNewEstimation;
+
+  if (bDecreased)
+    MoveUpInOpenList(uiIndex);
+  else
+    MoveDownInOpenList(uiIndex);
+}
+
+template <typename PathStateType>
+EZ_ALWAYS_INLINE void ezPathSearch<PathStateType>::SetOpenListEntry(ezUInt32 uiIndex, const OpenListEntry& entry)
+{
+  m_OpenList[uiIndex] = entry;
+  m_Nodes[entry.m_uiNode].m_uiOpenListIndex = uiIndex;
+}
+
+template <typename PathStateType>
+void ezPathSearch<PathStateType>::MoveUpInOpenList(ezUInt32 uiIndex)
+{
+  const OpenListEntry entry = m_OpenList[uiIndex];
+
+  while (uiIndex > 0)
+  {
+    const ezUInt32 uiParent = (uiIndex - 1) / 2;
+
+    if (!(entry.m_fEstimatedCostToTarget < m_OpenList[uiParent].m_fEstimatedCostToTarget))
+      break;
+
+    SetOpenListEntry(uiIndex, m_OpenList[uiParent]);
+    uiIndex = uiParent;
   }
 
-  EZ_ASSERT_DEV(out_pPathState != nullptr, "Implementation Error");
+  SetOpenListEntry(uiIndex, entry);
+}
+
+template <typename PathStateType>
+void ezPathSearch<PathStateType>::MoveDownInOpenList(ezUInt32 uiIndex)
+{
+  const OpenListEntry entry = m_OpenList[uiIndex];
+  const ezUInt32 uiCount = m_OpenList.GetCount();
 
-  const ezInt64 iBestNodeIndex = m_StateQueue[iBestInQueue];
-  m_StateQueue.RemoveAtAndSwap(iBestInQueue);
+  while (true)
+  {
+    ezUInt32 uiChild = uiIndex * 2 + 1;
+    if (uiChild >= uiCount)
+      break;
+
+    if (uiChild + 1 < uiCount && m_OpenList[uiChild + 1].m_fEstimatedCostToTarget < m_OpenList[uiChild].m_fEstimatedCostToTarget)
+      ++uiChild;
+
+    if (!(m_OpenList[uiChild].m_fEstimatedCostToTarget < entry.m_fEstimatedCostToTarget))
+      break;
+
+    SetOpenListEntry(uiIndex, m_OpenList[uiChild]);
+    uiIndex = uiChild;
+  }
 
-  return iBestNodeIndex;
+  SetOpenListEntry(uiIndex, entry);
+}
+
+template <typename PathStateType>
+ezInt64 ezPathSearch<PathStateType>::FindBestNodeToExpand(PathStateType*& out_pPathState)
+{
+  EZ_ASSERT_DEV(!m_OpenList.IsEmpty(), "Implementation Error");
+
+  NodeData& bestNode = m_Nodes[m_OpenList[0].m_uiNode];
+  bestNode.m_uiOpenListIndex = ezInvalidIndex;
+
+  const ezUInt32 uiLast = m_OpenList.GetCount() - 1;
+  if (uiLast > 0)
+  {
+    SetOpenListEntry(0, m_OpenList[uiLast]);
+    m_OpenList.PopBack();
+    MoveDownInOpenList(0);
+  }
+  else
+  {
+    m_OpenList.PopBack();
+  }
+
+  out_pPathState = &bestNode.m_State;
+  return bestNode.m_iNodeIndex;
 }
 
 template <typename PathStateType>
@@ -43,7 +194,7 @@ void ezPathSearch<PathStateType>::FillOutPathResult(ezInt64 iEndNodeIndex, ezDeq
 
   while (true)
   {
-    const PathStateType* pCurState = &m_PathStates[iEndNodeIndex];
+    const PathStateType* pCurState = GetPathState(iEndNodeIndex);
 
     PathResultData r;
     r.m_iNodeIndex = iEndNodeIndex;
@@ -69,28 +220,36 @@ void ezPathSearch<PathStateType>::AddPathNode(ezInt64 iNodeIndex, const PathStat
   // ezArgF(m_pCurPathState->m_fEstimatedCostToTarget, 2), ezArgF(NewState.m_fEstimatedCostToTarget, 2));
   EZ_ASSERT_DEV(NewState.m_fEstimatedCostToTarget >= NewState.m_fCostToNode, "Unrealistic expectations will get you nowhere.");
 
-  PathStateType* pExistingState;
+  const ezUInt32 uiExistingNode = FindNode(iNodeIndex);
 
-  if (m_PathStates.TryGetValue(iNodeIndex, pExistingState))
+  if (uiExistingNode != ezInvalidIndex)
   {
-    // state already exists in the hash table, and has a lower cost -> ignore the new state
-    if (pExistingState->m_fCostToNode <= NewState.m_fCostToNode)
+    NodeData& existingNode = m_Nodes[uiExistingNode];
+
+    // state already exists, and has a lower cost -> ignore the new state
+    if (existingNode.m_State.m_fCostToNode <= NewState.m_fCostToNode)
       return;
 
     // incoming state is better than the existing state -> update existing state
-    *pExistingState = NewState;
-    pExistingState->m_iReachedThroughNode = m_iCurNodeIndex;
+    existingNode.m_State = NewState;
+    existingNode.m_State.m_iReachedThroughNode = m_iCurNodeIndex;
+
+    // if it still waits to be expanded, move it to its new place in the queue
+    if (existingNode.m_uiOpenListIndex != ezInvalidIndex)
+    {
+      UpdateInOpenList(uiExistingNode);
+    }
+
     return;
   }
 
   // the state has not been reached before -> insert it
-  pExistingState = &m_PathStates[iNodeIndex];
-
-  *pExistingState = NewState;
-  pExistingState->m_iReachedThroughNode = m_iCurNodeIndex;
+  const ezUInt32 uiNewNode = AddNode(iNodeIndex);
+  m_Nodes[uiNewNode].m_State = NewState;
+  m_Nodes[uiNewNode].m_State.m_iReachedThroughNode = m_iCurNodeIndex;
 
   // put it into the queue of states that still need to be expanded
-  m_StateQueue.PushBack(iNodeIndex);
+  AddToOpenList(uiNewNode);
 }
 
 template <typename PathStateType>
@@ -103,13 +262,12 @@ ezResult ezPathSearch<PathStateType>::FindPath(ezInt64 iStartNodeIndex, const Pa
 
   if (iStartNodeIndex == iTargetNodeIndex)
   {
-    m_PathStates.Reserve(1);
-
-    m_PathStates[iTargetNodeIndex] = StartState;
+    NodeData& targetNode = m_Nodes[AddNode(iTargetNodeIndex)];
+    targetNode.m_State = StartState;
 
     PathResultData r;
     r.m_iNodeIndex = iTargetNodeIndex;
-    r.m_pPathState = &m_PathStates[iTargetNodeIndex];
+    r.m_pPathState = &targetNode.m_State;
 
     out_Path.Clear();
     out_Path.PushBack(r);
@@ -117,9 +275,8 @@ ezResult ezPathSearch<PathStateType>::FindPath(ezInt64 iStartNodeIndex, const Pa
     return EZ_SUCCESS;
   }
 
-  m_PathStates.Reserve(10000);
-
-  PathStateType& FirstState = m_PathStates[iStartNodeIndex];
+  const ezUInt32 uiFirstNode = AddNode(iStartNodeIndex);
+  PathStateType& FirstState = m_Nodes[uiFirstNode].m_State;
 
   m_pStateGenerator->StartSearch(iStartNodeIndex, &FirstState, iTargetNodeIndex);
 
@@ -128,10 +285,10 @@ ezResult ezPathSearch<PathStateType>::FindPath(ezInt64 iStartNodeIndex, const Pa
   FirstState.m_iReachedThroughNode = iStartNodeIndex;
 
   // put the start state into the to-be-expanded queue
-  m_StateQueue.PushBack(iStartNodeIndex);
+  AddToOpenList(uiFirstNode);
 
   // while the queue is not empty, expand the next node and see where that gets us
-  while (!m_StateQueue.IsEmpty())
+  while (!m_OpenList.IsEmpty())
   {
     PathStateType* pCurState;
     m_iCurNodeIndex = FindBestNodeToExpand(pCurState);
@@ -172,9 +329,8 @@ ezResult ezPathSearch<PathStateType>::FindClosest(ezInt64 iStartNodeIndex, const
 
   ClearPathStates();
 
-  m_PathStates.Reserve(10000);
-
-  PathStateType& FirstState = m_PathStates[iStartNodeIndex];
+  const ezUInt32 uiFirstNode = AddNode(iStartNodeIndex);
+  PathStateType& FirstState = m_Nodes[uiFirstNode].m_State;
 
   m_pStateGenerator->StartSearchForClosest(iStartNodeIndex, &FirstState);
 
@@ -183,10 +339,10 @@ ezResult ezPathSearch<PathStateType>::FindClosest(ezInt64 iStartNodeIndex, const
   FirstState.m_iReachedThroughNode = iStartNodeIndex;
 
   // put the start state into the to-be-expanded queue
-  m_StateQueue.PushBack(iStartNodeIndex);
+  AddToOpenList(uiFirstNode);
 
   // while the queue is not empty, expand the next node and see where that gets us
-  while (!m_StateQueue.IsEmpty())
+  while (!m_OpenList.IsEmpty())
   {
     PathStateType* pCurState;
     m_iCurNodeIndex = FindBestNodeToExpand(pCurState);
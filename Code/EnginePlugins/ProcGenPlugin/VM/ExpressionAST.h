@@ -43,6 +43,7 @@ public:
 
       // Ternary
       Select,
+      MultiplyAdd,
 
       // Constant
       FloatConstant,
@@ -60,6 +61,7 @@ public:
 
     static bool IsUnary(Enum nodeType);
     static bool IsBinary(Enum nodeType);
+    static bool IsTernary(Enum nodeType);
     static bool IsConstant(Enum nodeType);
     static bool IsInput(Enum nodeType);
     static bool IsOutput(Enum nodeType);
@@ -83,6 +85,14 @@ public:
     Node* m_pRightOperand = nullptr;
   };
 
+  /// \brief Only created by the optimizer of ezExpressionCompiler, e.g. MultiplyAdd computes First * Second + Third.
+  struct TernaryOperator : public Node
+  {
+    Node* m_pFirstOperand = nullptr;
+    Node* m_pSecondOperand = nullptr;
+    Node* m_pThirdOperand = nullptr;
+  };
+
   struct Select : public Node
   {
     Node* m_pCondition = nullptr;
@@ -118,6 +128,7 @@ public:
 
   UnaryOperator* CreateUnaryOperator(NodeType::Enum type, Node* pOperand);
   BinaryOperator* CreateBinaryOperator(NodeType::Enum type, Node* pLeftOperand, Node* pRightOperand);
+  TernaryOperator* CreateTernaryOperator(NodeType::Enum type, Node* pFirstOperand, Node* pSecondOperand, Node* pThirdOperand);
   Select* CreateSelect(Node* pCondition, Node* pTrueOperand, Node* pFalseOperand);
   Constant* CreateConstant(const ezVariant& value);
   Input* CreateInput(const ezHashedString& sName);
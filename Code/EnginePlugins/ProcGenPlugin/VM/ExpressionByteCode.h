@@ -56,6 +56,13 @@ public:
 
       Call,
 
+      // Ternary, appended after Call to keep the values of the existing op codes stable
+      FirstTernary,
+
+      MulAdd_RRR,
+
+      LastTernary,
+
       Count
     };
   };
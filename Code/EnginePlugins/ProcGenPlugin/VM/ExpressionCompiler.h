@@ -10,9 +10,27 @@ public:
   ezExpressionCompiler();
   ~ezExpressionCompiler();
 
+  /// \brief Compiles the given AST to byte code.
+  ///
+  /// If optimizations are enabled, the AST is modified in place before the byte code is generated.
   ezResult Compile(ezExpressionAST& ast, ezExpressionByteCode& out_byteCode);
 
+  /// \brief Enables constant folding, common subexpression elimination, removal of dead outputs and fusing of multiply-add operations.
+  /// Enabled by default.
+  void SetOptimizationsEnabled(bool bEnable) { m_bOptimizationsEnabled = bEnable; }
+
+  /// \brief If enabled, Compile() logs the number of instructions and registers before and after the optimizations.
+  void SetLogOptimizationResults(bool bEnable) { m_bLogOptimizationResults = bEnable; }
+
 private:
+  ezResult OptimizeAST(ezExpressionAST& ast);
+  void RemoveDeadOutputs(ezExpressionAST& ast);
+  ezResult CollectNodesPostOrder(ezExpressionAST& ast, ezDynamicArray<ezExpressionAST::Node*>& out_Nodes);
+  ezExpressionAST::Node* FoldAndSimplify(ezExpressionAST& ast, ezExpressionAST::Node* pNode);
+  ezExpressionAST::Node* FuseMultiplyAdd(ezExpressionAST& ast, ezExpressionAST::Node* pNode);
+  ezExpressionAST::Node* GetUniqueNode(ezExpressionAST::Node* pNode);
+  ezExpressionAST::Node* CreateConstant(ezExpressionAST& ast, float fValue);
+
   ezResult BuildNodeInstructions(const ezExpressionAST& ast);
   ezResult UpdateRegisterLifetime(const ezExpressionAST& ast);
   ezResult AssignRegisters();
@@ -36,4 +54,17 @@ private:
   };
 
   ezDynamicArray<LiveInterval> m_LiveIntervals;
+
+  struct NodeHashHelper
+  {
+    static ezUInt32 Hash(const ezExpressionAST::Node* pNode);
+    static bool Equal(const ezExpressionAST::Node* a, const ezExpressionAST::Node* b);
+  };
+
+  ezHashTable<const ezExpressionAST::Node*, ezExpressionAST::Node*, NodeHashHelper> m_UniqueNodes;
+  ezHashTable<const ezExpressionAST::Node*, ezExpressionAST::Node*> m_NodeReplacements;
+  ezHashTable<const ezExpressionAST::Node*, ezUInt32> m_NodeUseCount;
+
+  bool m_bOptimizationsEnabled = true;
+  bool m_bLogOptimizationResults = false;
 };
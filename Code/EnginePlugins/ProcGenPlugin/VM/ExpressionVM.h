@@ -67,7 +67,18 @@ public:
   ezResult Execute(const ezExpressionByteCode& byteCode, ezArrayPtr<const ezExpression::Stream> inputs, ezArrayPtr<ezExpression::Stream> outputs,
     ezUInt32 uiNumInstances, const ezExpression::GlobalData& globalData = ezExpression::GlobalData());
 
+  /// \brief Returns whether the CPU and the OS support AVX instructions, which allows the VM to process 8 instances per instruction.
+  static bool IsAvxSupported();
+
+  /// \brief Enables or disables the 8-wide AVX execution path. It is enabled by default if AVX is supported.
+  ///
+  /// Disabling it is mostly useful to compare the performance and results against the 4-wide ezSimdVec4f path.
+  void SetAvxEnabled(bool bEnable) { m_bAvxEnabled = bEnable && IsAvxSupported(); }
+  bool IsAvxEnabled() const { return m_bAvxEnabled; }
+
 private:
+  bool m_bAvxEnabled = false;
+
   ezDynamicArray<ezSimdVec4f, ezAlignedAllocatorWrapper> m_Registers;
 
   ezDynamicArray<ezUInt32> m_InputMapping;
@@ -58,6 +58,13 @@ namespace
     "",
 
     "Call",
+
+    // Ternary
+    "",
+
+    "MulAdd_RRR",
+
+    "",
   };
 
   EZ_CHECK_AT_COMPILETIME_MSG(
@@ -144,6 +151,15 @@ void ezExpressionByteCode::Disassemble(ezStringBuilder& out_sDisassembly) const
         out_sDisassembly.AppendFormat("{0} r{1} r{2} r{3}\n", szOpCode, r, a, b);
       }
     }
+    else if (opCode > OpCode::FirstTernary && opCode < OpCode::LastTernary)
+    {
+      ezUInt32 r = GetRegisterIndex(pByteCode, 1);
+      ezUInt32 a = GetRegisterIndex(pByteCode, 1);
+      ezUInt32 b = GetRegisterIndex(pByteCode, 1);
+      ezUInt32 c = GetRegisterIndex(pByteCode, 1);
+
+      out_sDisassembly.AppendFormat("{0} r{1} r{2} r{3} r{4}\n", szOpCode, r, a, b, c);
+    }
     else if (opCode == OpCode::Call)
     {
       ezUInt32 uiIndex = GetFunctionIndex(pByteCode);
@@ -198,7 +214,7 @@ void ezExpressionByteCode::Save(ezStreamWriter& stream) const
   }
 
   {
-    chunk.BeginChunk("Code", 2);
+    chunk.BeginChunk("Code", 3);
 
     chunk << m_ByteCode.GetCount();
     chunk.WriteBytes(m_ByteCode.GetData(), m_ByteCode.GetCount() * sizeof(StorageType));
@@ -238,7 +254,9 @@ ezResult ezExpressionByteCode::Load(ezStreamReader& stream)
     }
     else if (chunk.GetCurrentChunk().m_sChunkName == "Code")
     {
-      if (chunk.GetCurrentChunk().m_uiChunkVersion >= 2)
+      // Version 3 only added the MulAdd_RRR op code after all existing ones, so version 2 byte code is read unchanged.
+      const ezUInt32 uiChunkVersion = chunk.GetCurrentChunk().m_uiChunkVersion;
+      if (uiChunkVersion == 2 || uiChunkVersion == 3)
       {
         ezUInt32 uiByteCodeCount = 0;
         chunk >> uiByteCodeCount;
@@ -248,7 +266,7 @@ ezResult ezExpressionByteCode::Load(ezStreamReader& stream)
       }
       else
       {
-        ezLog::Error("Invalid Code Chunk Version {0}. Expected >= 2", chunk.GetCurrentChunk().m_uiChunkVersion);
+        ezLog::Error("Invalid Code Chunk Version {0}. Expected 2 or 3", uiChunkVersion);
 
         chunk.EndStream();
         return EZ_FAILURE;
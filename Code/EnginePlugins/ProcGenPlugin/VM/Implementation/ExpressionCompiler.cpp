@@ -40,18 +40,186 @@ namespace
         return ezExpressionByteCode::OpCode::Min_RR;
       case ezExpressionAST::NodeType::Max:
         return ezExpressionByteCode::OpCode::Max_RR;
+
+      case ezExpressionAST::NodeType::MultiplyAdd:
+        return ezExpressionByteCode::OpCode::MulAdd_RRR;
       default:
         EZ_ASSERT_NOT_IMPLEMENTED;
         return ezExpressionByteCode::OpCode::FirstUnary;
     }
   }
+
+  EZ_ALWAYS_INLINE bool IsConstant(const ezExpressionAST::Node* pNode) { return ezExpressionAST::NodeType::IsConstant(pNode->m_Type); }
+
+  EZ_ALWAYS_INLINE float GetConstantValue(const ezExpressionAST::Node* pNode)
+  {
+    return static_cast<const ezExpressionAST::Constant*>(pNode)->m_Value.Get<float>();
+  }
+
+  /// Returns true if x * (1 / fValue) gives exactly the same result as x / fValue, which is the case for powers of two.
+  static bool HasExactReciprocal(float fValue)
+  {
+    const ezUInt32 uiBits = *reinterpret_cast<const ezUInt32*>(&fValue);
+    const ezUInt32 uiExponent = (uiBits >> 23) & 0xFF;
+    const ezUInt32 uiMantissa = uiBits & 0x7FFFFF;
+
+    if (uiMantissa != 0 || uiExponent == 0 || uiExponent == 0xFF)
+      return false;
+
+    const float fReciprocal = 1.0f / fValue;
+    return fReciprocal * fValue == 1.0f;
+  }
+
+  static float FoldUnary(ezExpressionAST::NodeType::Enum nodeType, float x)
+  {
+    switch (nodeType)
+    {
+      case ezExpressionAST::NodeType::Negate:
+        return -x;
+      case ezExpressionAST::NodeType::Absolute:
+        return ezMath::Abs(x);
+      case ezExpressionAST::NodeType::Sqrt:
+        return ezMath::Sqrt(x);
+      case ezExpressionAST::NodeType::Sin:
+        return ezMath::Sin(ezAngle::Radian(x));
+      case ezExpressionAST::NodeType::Cos:
+        return ezMath::Cos(ezAngle::Radian(x));
+      case ezExpressionAST::NodeType::Tan:
+        return ezMath::Tan(ezAngle::Radian(x));
+      case ezExpressionAST::NodeType::ASin:
+        return ezMath::ASin(x).GetRadian();
+      case ezExpressionAST::NodeType::ACos:
+        return ezMath::ACos(x).GetRadian();
+      case ezExpressionAST::NodeType::ATan:
+        return ezMath::ATan(x).GetRadian();
+      default:
+        EZ_ASSERT_NOT_IMPLEMENTED;
+        return 0.0f;
+    }
+  }
+
+  static float FoldBinary(ezExpressionAST::NodeType::Enum nodeType, float a, float b)
+  {
+    switch (nodeType)
+    {
+      case ezExpressionAST::NodeType::Add:
+        return a + b;
+      case ezExpressionAST::NodeType::Subtract:
+        return a - b;
+      case ezExpressionAST::NodeType::Multiply:
+        return a * b;
+      case ezExpressionAST::NodeType::Divide:
+        return a / b;
+      case ezExpressionAST::NodeType::Min:
+        return ezMath::Min(a, b);
+      case ezExpressionAST::NodeType::Max:
+        return ezMath::Max(a, b);
+      default:
+        EZ_ASSERT_NOT_IMPLEMENTED;
+        return 0.0f;
+    }
+  }
+
+  static bool IsCommutative(ezExpressionAST::NodeType::Enum nodeType)
+  {
+    return nodeType == ezExpressionAST::NodeType::Add || nodeType == ezExpressionAST::NodeType::Multiply ||
+           nodeType == ezExpressionAST::NodeType::Min || nodeType == ezExpressionAST::NodeType::Max;
+  }
+
+  struct PostOrderEntry
+  {
+    EZ_DECLARE_POD_TYPE();
+
+    ezExpressionAST::Node* m_pNode;
+    bool m_bChildrenPushed;
+  };
 } // namespace
 
+// static
+ezUInt32 ezExpressionCompiler::NodeHashHelper::Hash(const ezExpressionAST::Node* pNode)
+{
+  ezHybridArray<ezUInt64, 16> values;
+  values.PushBack(pNode->m_Type);
+
+  ezExpressionAST::NodeType::Enum nodeType = pNode->m_Type;
+  if (ezExpressionAST::NodeType::IsConstant(nodeType))
+  {
+    const float fValue = GetConstantValue(pNode);
+    values.PushBack(*reinterpret_cast<const ezUInt32*>(&fValue));
+  }
+  else if (ezExpressionAST::NodeType::IsInput(nodeType))
+  {
+    values.PushBack(static_cast<const ezExpressionAST::Input*>(pNode)->m_sName.GetHash());
+  }
+  else if (nodeType == ezExpressionAST::NodeType::FunctionCall)
+  {
+    values.PushBack(static_cast<const ezExpressionAST::FunctionCall*>(pNode)->m_sName.GetHash());
+  }
+
+  for (auto pChild : ezExpressionAST::GetChildren(pNode))
+  {
+    values.PushBack(reinterpret_cast<ezUInt64>(pChild));
+  }
+
+  return ezHashingUtils::xxHash32(values.GetData(), values.GetCount() * sizeof(ezUInt64));
+}
+
+// static
+bool ezExpressionCompiler::NodeHashHelper::Equal(const ezExpressionAST::Node* a, const ezExpressionAST::Node* b)
+{
+  if (a == b)
+    return true;
+
+  if (a->m_Type != b->m_Type)
+    return false;
+
+  ezExpressionAST::NodeType::Enum nodeType = a->m_Type;
+  if (ezExpressionAST::NodeType::IsConstant(nodeType))
+  {
+    // compare the bits, so that 0 and -0 are not merged
+    const float fA = GetConstantValue(a);
+    const float fB = GetConstantValue(b);
+    return *reinterpret_cast<const ezUInt32*>(&fA) == *reinterpret_cast<const ezUInt32*>(&fB);
+  }
+  else if (ezExpressionAST::NodeType::IsInput(nodeType))
+  {
+    return static_cast<const ezExpressionAST::Input*>(a)->m_sName == static_cast<const ezExpressionAST::Input*>(b)->m_sName;
+  }
+  else if (nodeType == ezExpressionAST::NodeType::FunctionCall)
+  {
+    if (static_cast<const ezExpressionAST::FunctionCall*>(a)->m_sName != static_cast<const ezExpressionAST::FunctionCall*>(b)->m_sName)
+      return false;
+  }
+  else if (!ezExpressionAST::NodeType::IsUnary(nodeType) && !ezExpressionAST::NodeType::IsBinary(nodeType) &&
+           !ezExpressionAST::NodeType::IsTernary(nodeType))
+  {
+    // outputs and unknown node types are never merged
+    return false;
+  }
+
+  auto childrenA = ezExpressionAST::GetChildren(a);
+  auto childrenB = ezExpressionAST::GetChildren(b);
+  return childrenA == childrenB;
+}
+
 ezExpressionCompiler::ezExpressionCompiler() = default;
 ezExpressionCompiler::~ezExpressionCompiler() = default;
 
 ezResult ezExpressionCompiler::Compile(ezExpressionAST& ast, ezExpressionByteCode& out_byteCode)
 {
+  ezUInt32 uiNumUnoptimizedInstructions = 0;
+
+  if (m_bOptimizationsEnabled)
+  {
+    if (m_bLogOptimizationResults && BuildNodeInstructions(ast).Succeeded())
+    {
+      uiNumUnoptimizedInstructions = m_NodeInstructions.GetCount();
+    }
+
+    if (OptimizeAST(ast).Failed())
+      return EZ_FAILURE;
+  }
+
   if (BuildNodeInstructions(ast).Failed())
     return EZ_FAILURE;
 
@@ -64,9 +232,275 @@ ezResult ezExpressionCompiler::Compile(ezExpressionAST& ast, ezExpressionByteCod
   if (GenerateByteCode(ast, out_byteCode).Failed())
     return EZ_FAILURE;
 
+  if (m_bOptimizationsEnabled && m_bLogOptimizationResults)
+  {
+    ezLog::Info("Expression optimizations: {0} instructions before, {1} instructions after, {2} temp registers", uiNumUnoptimizedInstructions,
+      out_byteCode.GetNumInstructions(), out_byteCode.GetNumTempRegisters());
+  }
+
   return EZ_SUCCESS;
 }
 
+ezResult ezExpressionCompiler::OptimizeAST(ezExpressionAST& ast)
+{
+  RemoveDeadOutputs(ast);
+
+  ezDynamicArray<ezExpressionAST::Node*> nodes;
+
+  // Constant folding, simplification and common subexpression elimination.
+  // Children are visited before their parents, so all children are already replaced by their unique version when a node is processed.
+  {
+    EZ_SUCCEED_OR_RETURN(CollectNodesPostOrder(ast, nodes));
+
+    m_UniqueNodes.Clear();
+    m_NodeReplacements.Clear();
+
+    for (auto pNode : nodes)
+    {
+      for (auto& pChild : ezExpressionAST::GetChildren(pNode))
+      {
+        m_NodeReplacements.TryGetValue(pChild, pChild);
+      }
+
+      if (ezExpressionAST::NodeType::IsOutput(pNode->m_Type))
+        continue;
+
+      ezExpressionAST::Node* pNewNode = GetUniqueNode(FoldAndSimplify(ast, pNode));
+      if (pNewNode != pNode)
+      {
+        m_NodeReplacements.Insert(pNode, pNewNode);
+      }
+    }
+  }
+
+  // Fuse multiplications with additions, which needs to know how often the result of a multiplication is used
+  {
+    EZ_SUCCEED_OR_RETURN(CollectNodesPostOrder(ast, nodes));
+
+    m_NodeUseCount.Clear();
+    m_NodeReplacements.Clear();
+
+    for (auto pNode : nodes)
+    {
+      for (auto pChild : ezExpressionAST::GetChildren(pNode))
+      {
+        m_NodeUseCount[pChild]++;
+      }
+    }
+
+    for (auto pNode : nodes)
+    {
+      for (auto& pChild : ezExpressionAST::GetChildren(pNode))
+      {
+        m_NodeReplacements.TryGetValue(pChild, pChild);
+      }
+
+      ezExpressionAST::Node* pNewNode = FuseMultiplyAdd(ast, pNode);
+      if (pNewNode != pNode)
+      {
+        m_NodeReplacements.Insert(pNode, pNewNode);
+      }
+    }
+  }
+
+  return EZ_SUCCESS;
+}
+
+void ezExpressionCompiler::RemoveDeadOutputs(ezExpressionAST& ast)
+{
+  // The instructions of the first output are emitted last, so if multiple outputs write to the same stream
+  // only the first one has an effect and all others can be removed.
+  for (ezUInt32 i = ast.m_OutputNodes.GetCount(); i-- > 1;)
+  {
+    if (ast.m_OutputNodes[i] == nullptr)
+      continue;
+
+    for (ezUInt32 j = 0; j < i; ++j)
+    {
+      if (ast.m_OutputNodes[j] != nullptr && ast.m_OutputNodes[j]->m_sName == ast.m_OutputNodes[i]->m_sName)
+      {
+        ast.m_OutputNodes.RemoveAtAndCopy(i);
+        break;
+      }
+    }
+  }
+}
+
+ezResult ezExpressionCompiler::CollectNodesPostOrder(ezExpressionAST& ast, ezDynamicArray<ezExpressionAST::Node*>& out_Nodes)
+{
+  out_Nodes.Clear();
+
+  ezHashSet<const ezExpressionAST::Node*> visitedNodes;
+  ezHybridArray<PostOrderEntry, 64> nodeStack;
+
+  for (ezExpressionAST::Node* pOutputNode : ast.m_OutputNodes)
+  {
+    if (pOutputNode == nullptr)
+      continue;
+
+    nodeStack.PushBack({pOutputNode, false});
+
+    while (!nodeStack.IsEmpty())
+    {
+      PostOrderEntry& entry = nodeStack.PeekBack();
+      ezExpressionAST::Node* pCurrentNode = entry.m_pNode;
+
+      if (entry.m_bChildrenPushed)
+      {
+        nodeStack.PopBack();
+
+        if (!visitedNodes.Contains(pCurrentNode))
+        {
+          visitedNodes.Insert(pCurrentNode);
+          out_Nodes.PushBack(pCurrentNode);
+        }
+
+        continue;
+      }
+
+      entry.m_bChildrenPushed = true;
+
+      if (visitedNodes.Contains(pCurrentNode))
+        continue;
+
+      for (auto pChild : ezExpressionAST::GetChildren(pCurrentNode))
+      {
+        if (pChild == nullptr)
+          return EZ_FAILURE;
+
+        if (!visitedNodes.Contains(pChild))
+        {
+          nodeStack.PushBack({pChild, false});
+        }
+      }
+    }
+  }
+
+  return EZ_SUCCESS;
+}
+
+ezExpressionAST::Node* ezExpressionCompiler::FoldAndSimplify(ezExpressionAST& ast, ezExpressionAST::Node* pNode)
+{
+  ezExpressionAST::NodeType::Enum nodeType = pNode->m_Type;
+
+  if (ezExpressionAST::NodeType::IsUnary(nodeType))
+  {
+    auto pUnary = static_cast<ezExpressionAST::UnaryOperator*>(pNode);
+
+    if (IsConstant(pUnary->m_pOperand))
+    {
+      return CreateConstant(ast, FoldUnary(nodeType, GetConstantValue(pUnary->m_pOperand)));
+    }
+
+    // There is no negate op code, 0 - x only needs a single instruction
+    if (nodeType == ezExpressionAST::NodeType::Negate)
+    {
+      return ast.CreateBinaryOperator(ezExpressionAST::NodeType::Subtract, CreateConstant(ast, 0.0f), pUnary->m_pOperand);
+    }
+  }
+  else if (ezExpressionAST::NodeType::IsBinary(nodeType))
+  {
+    auto pBinary = static_cast<ezExpressionAST::BinaryOperator*>(pNode);
+    ezExpressionAST::Node* pLeft = pBinary->m_pLeftOperand;
+    ezExpressionAST::Node* pRight = pBinary->m_pRightOperand;
+
+    if (IsConstant(pLeft) && IsConstant(pRight))
+    {
+      return CreateConstant(ast, FoldBinary(nodeType, GetConstantValue(pLeft), GetConstantValue(pRight)));
+    }
+
+    // Only the left operand can be encoded as a constant in the byte code, so move constants to the left if possible
+    if (IsConstant(pRight))
+    {
+      const float fValue = GetConstantValue(pRight);
+
+      if (IsCommutative(nodeType))
+      {
+        pBinary->m_pLeftOperand = pRight;
+        pBinary->m_pRightOperand = pLeft;
+      }
+      else if (nodeType == ezExpressionAST::NodeType::Subtract)
+      {
+        pBinary = ast.CreateBinaryOperator(ezExpressionAST::NodeType::Add, CreateConstant(ast, -fValue), pLeft);
+      }
+      else if (nodeType == ezExpressionAST::NodeType::Divide && HasExactReciprocal(fValue))
+      {
+        pBinary = ast.CreateBinaryOperator(ezExpressionAST::NodeType::Multiply, CreateConstant(ast, 1.0f / fValue), pLeft);
+      }
+
+      nodeType = pBinary->m_Type;
+      pLeft = pBinary->m_pLeftOperand;
+      pRight = pBinary->m_pRightOperand;
+    }
+
+    if (IsConstant(pLeft))
+    {
+      const float fValue = GetConstantValue(pLeft);
+
+      if ((nodeType == ezExpressionAST::NodeType::Add && fValue == 0.0f) ||
+          (nodeType == ezExpressionAST::NodeType::Multiply && fValue == 1.0f))
+      {
+        return pRight;
+      }
+    }
+    else if ((nodeType == ezExpressionAST::NodeType::Min || nodeType == ezExpressionAST::NodeType::Max) && pLeft == pRight)
+    {
+      return pLeft;
+    }
+
+    return pBinary;
+  }
+
+  return pNode;
+}
+
+ezExpressionAST::Node* ezExpressionCompiler::FuseMultiplyAdd(ezExpressionAST& ast, ezExpressionAST::Node* pNode)
+{
+  if (pNode->m_Type != ezExpressionAST::NodeType::Add)
+    return pNode;
+
+  auto pAdd = static_cast<ezExpressionAST::BinaryOperator*>(pNode);
+  if (IsConstant(pAdd->m_pLeftOperand) || IsConstant(pAdd->m_pRightOperand))
+  {
+    // Mul + Add_CR does not need more instructions than a fused operation with a constant register
+    return pNode;
+  }
+
+  auto TryFuse = [&](ezExpressionAST::Node* pMultiply, ezExpressionAST::Node* pAddend) -> ezExpressionAST::Node* {
+    if (pMultiply->m_Type != ezExpressionAST::NodeType::Multiply || m_NodeUseCount[pMultiply] != 1)
+      return nullptr;
+
+    auto pMul = static_cast<ezExpressionAST::BinaryOperator*>(pMultiply);
+    if (IsConstant(pMul->m_pLeftOperand))
+      return nullptr;
+
+    return ast.CreateTernaryOperator(ezExpressionAST::NodeType::MultiplyAdd, pMul->m_pLeftOperand, pMul->m_pRightOperand, pAddend);
+  };
+
+  if (auto pFused = TryFuse(pAdd->m_pLeftOperand, pAdd->m_pRightOperand))
+    return pFused;
+
+  if (auto pFused = TryFuse(pAdd->m_pRightOperand, pAdd->m_pLeftOperand))
+    return pFused;
+
+  return pNode;
+}
+
+ezExpressionAST::Node* ezExpressionCompiler::GetUniqueNode(ezExpressionAST::Node* pNode)
+{
+  ezExpressionAST::Node* pExistingNode = nullptr;
+  if (m_UniqueNodes.TryGetValue(pNode, pExistingNode))
+    return pExistingNode;
+
+  m_UniqueNodes.Insert(pNode, pNode);
+  return pNode;
+}
+
+ezExpressionAST::Node* ezExpressionCompiler::CreateConstant(ezExpressionAST& ast, float fValue)
+{
+  return GetUniqueNode(ast.CreateConstant(fValue));
+}
+
 ezResult ezExpressionCompiler::BuildNodeInstructions(const ezExpressionAST& ast)
 {
   m_NodeStack.Clear();
@@ -136,7 +570,12 @@ ezResult ezExpressionCompiler::BuildNodeInstructions(const ezExpressionAST& ast)
     auto pCurrentNode = m_NodeStack.PeekBack();
     m_NodeStack.PopBack();
 
-    if (!m_NodeToRegisterIndex.Contains(pCurrentNode))
+    if (ezExpressionAST::NodeType::IsOutput(pCurrentNode->m_Type))
+    {
+      // Outputs write directly to the output stream and don't need a register
+      m_NodeInstructions.PushBack(pCurrentNode);
+    }
+    else if (!m_NodeToRegisterIndex.Contains(pCurrentNode))
     {
       m_NodeInstructions.PushBack(pCurrentNode);
 
@@ -160,8 +599,18 @@ ezResult ezExpressionCompiler::UpdateRegisterLifetime(const ezExpressionAST& ast
     auto pCurrentNode = m_NodeInstructions[uiInstructionIndex];
 
     auto children = ezExpressionAST::GetChildren(pCurrentNode);
-    for (auto pChild : children)
+    for (ezUInt32 uiChildIndex = 0; uiChildIndex < children.GetCount(); ++uiChildIndex)
     {
+      auto pChild = children[uiChildIndex];
+
+      // A constant left operand of a binary operator is encoded in the instruction itself and does not need to be kept alive,
+      // even if the same constant node also got a register for another instruction.
+      if (uiChildIndex == 0 && ezExpressionAST::NodeType::IsBinary(pCurrentNode->m_Type) &&
+          ezExpressionAST::NodeType::IsConstant(pChild->m_Type))
+      {
+        continue;
+      }
+
       ezUInt32 uiRegisterIndex = ezInvalidIndex;
       if (m_NodeToRegisterIndex.TryGetValue(pChild, uiRegisterIndex))
       {
@@ -241,10 +690,15 @@ ezResult ezExpressionCompiler::GenerateByteCode(const ezExpressionAST& ast, ezEx
 
   for (auto pCurrentNode : m_NodeInstructions)
   {
-    ezUInt32 uiTargetRegister = m_NodeToRegisterIndex[pCurrentNode];
-    uiMaxRegisterIndex = ezMath::Max(uiMaxRegisterIndex, uiTargetRegister);
-
     ezExpressionAST::NodeType::Enum nodeType = pCurrentNode->m_Type;
+
+    ezUInt32 uiTargetRegister = 0;
+    if (!ezExpressionAST::NodeType::IsOutput(nodeType))
+    {
+      uiTargetRegister = m_NodeToRegisterIndex[pCurrentNode];
+      uiMaxRegisterIndex = ezMath::Max(uiMaxRegisterIndex, uiTargetRegister);
+    }
+
     if (ezExpressionAST::NodeType::IsUnary(nodeType))
     {
       auto pUnary = static_cast<const ezExpressionAST::UnaryOperator*>(pCurrentNode);
@@ -274,6 +728,16 @@ ezResult ezExpressionCompiler::GenerateByteCode(const ezExpressionAST& ast, ezEx
       byteCode.PushBack(bLeftIsConstant ? uiConstantValue : m_NodeToRegisterIndex[pBinary->m_pLeftOperand]);
       byteCode.PushBack(m_NodeToRegisterIndex[pBinary->m_pRightOperand]);
     }
+    else if (ezExpressionAST::NodeType::IsTernary(nodeType))
+    {
+      auto pTernary = static_cast<const ezExpressionAST::TernaryOperator*>(pCurrentNode);
+
+      byteCode.PushBack(NodeTypeToOpCode(nodeType));
+      byteCode.PushBack(uiTargetRegister);
+      byteCode.PushBack(m_NodeToRegisterIndex[pTernary->m_pFirstOperand]);
+      byteCode.PushBack(m_NodeToRegisterIndex[pTernary->m_pSecondOperand]);
+      byteCode.PushBack(m_NodeToRegisterIndex[pTernary->m_pThirdOperand]);
+    }
     else if (ezExpressionAST::NodeType::IsConstant(nodeType))
     {
       EZ_ASSERT_DEV(nodeType == ezExpressionAST::NodeType::FloatConstant, "Only floats are supported");
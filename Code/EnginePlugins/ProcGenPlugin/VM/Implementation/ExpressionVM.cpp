@@ -4,6 +4,22 @@
 #include <ProcGenPlugin/VM/ExpressionByteCode.h>
 #include <ProcGenPlugin/VM/ExpressionVM.h>
 
+// The AVX path only relies on ezSimdVec4f storing 4 floats, so it is also used when ezSimdVec4f is implemented with the FPU
+#if EZ_ENABLED(EZ_PLATFORM_ARCH_X86)
+#  define EZ_EXPRESSION_VM_AVX EZ_ON
+#  include <immintrin.h>
+#  if EZ_ENABLED(EZ_COMPILER_MSVC)
+#    include <intrin.h>
+// MSVC allows AVX intrinsics in any function, the code is only executed after checking the CPU features
+#    define EZ_AVX_FUNCTION
+#  else
+// GCC and Clang only allow AVX intrinsics in functions that are explicitly compiled for AVX
+#    define EZ_AVX_FUNCTION __attribute__((target("avx")))
+#  endif
+#else
+#  define EZ_EXPRESSION_VM_AVX EZ_OFF
+#endif
+
 namespace
 {
   //#define DEBUG_VM
@@ -84,6 +100,27 @@ namespace
     }
   }
 
+  template <typename Func>
+  VM_INLINE void VMOperation3(const ezExpressionByteCode::StorageType*& pByteCode, ezSimdVec4f* pRegisters, ezUInt32 uiNumRegisters,
+    Func func)
+  {
+    ezSimdVec4f* r = pRegisters + ezExpressionByteCode::GetRegisterIndex(pByteCode, uiNumRegisters);
+    ezSimdVec4f* re = r + uiNumRegisters;
+
+    ezSimdVec4f* a = pRegisters + ezExpressionByteCode::GetRegisterIndex(pByteCode, uiNumRegisters);
+    ezSimdVec4f* b = pRegisters + ezExpressionByteCode::GetRegisterIndex(pByteCode, uiNumRegisters);
+    ezSimdVec4f* c = pRegisters + ezExpressionByteCode::GetRegisterIndex(pByteCode, uiNumRegisters);
+
+    while (r != re)
+    {
+      *r = func(*a, *b, *c);
+      ++r;
+      ++a;
+      ++b;
+      ++c;
+    }
+  }
+
   VM_INLINE float ReadInputData(const ezUInt8* pData) { return *reinterpret_cast<const float*>(pData); }
 
   void VMLoadInput(const ezExpressionByteCode::StorageType*& pByteCode, ezSimdVec4f* pRegisters, ezUInt32 uiNumRegisters,
@@ -166,6 +203,194 @@ namespace
 
     func(inputs, output, globalData);
   }
+
+#if EZ_ENABLED(EZ_EXPRESSION_VM_AVX)
+
+  // The AVX path uses the same register layout as the SSE path, two consecutive ezSimdVec4f are processed as one __m256.
+  // The number of registers is always a multiple of two in that case, the main loop handles 16 instances per iteration.
+  static_assert(sizeof(ezSimdVec4f) == 4 * sizeof(float), "The AVX path expects ezSimdVec4f to consist of 4 floats");
+
+  struct AvxAbs
+  {
+    EZ_AVX_FUNCTION EZ_ALWAYS_INLINE static __m256 Op(__m256 x) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x); }
+  };
+
+  struct AvxSqrt
+  {
+    EZ_AVX_FUNCTION EZ_ALWAYS_INLINE static __m256 Op(__m256 x) { return _mm256_sqrt_ps(x); }
+  };
+
+  struct AvxMov
+  {
+    EZ_AVX_FUNCTION EZ_ALWAYS_INLINE static __m256 Op(__m256 x) { return x; }
+  };
+
+  struct AvxAdd
+  {
+    EZ_AVX_FUNCTION EZ_ALWAYS_INLINE static __m256 Op(__m256 a, __m256 b) { return _mm256_add_ps(a, b); }
+  };
+
+  struct AvxSub
+  {
+    EZ_AVX_FUNCTION EZ_ALWAYS_INLINE static __m256 Op(__m256 a, __m256 b) { return _mm256_sub_ps(a, b); }
+  };
+
+  struct AvxMul
+  {
+    EZ_AVX_FUNCTION EZ_ALWAYS_INLINE static __m256 Op(__m256 a, __m256 b) { return _mm256_mul_ps(a, b); }
+  };
+
+  struct AvxDiv
+  {
+    EZ_AVX_FUNCTION EZ_ALWAYS_INLINE static __m256 Op(__m256 a, __m256 b) { return _mm256_div_ps(a, b); }
+  };
+
+  struct AvxMin
+  {
+    EZ_AVX_FUNCTION EZ_ALWAYS_INLINE static __m256 Op(__m256 a, __m256 b) { return _mm256_min_ps(a, b); }
+  };
+
+  struct AvxMax
+  {
+    EZ_AVX_FUNCTION EZ_ALWAYS_INLINE static __m256 Op(__m256 a, __m256 b) { return _mm256_max_ps(a, b); }
+  };
+
+  struct AvxMulAdd
+  {
+    // AVX itself has no fused multiply-add, FMA3 would need a separate CPU feature check
+    EZ_AVX_FUNCTION EZ_ALWAYS_INLINE static __m256 Op(__m256 a, __m256 b, __m256 c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+  };
+
+  template <typename Op>
+  EZ_AVX_FUNCTION void VMOperation1_AVX(const ezExpressionByteCode::StorageType*& pByteCode, ezSimdVec4f* pRegisters, ezUInt32 uiNumRegisters)
+  {
+    float* r = reinterpret_cast<float*>(pRegisters + ezExpressionByteCode::GetRegisterIndex(pByteCode, uiNumRegisters));
+    float* re = r + uiNumRegisters * 4;
+
+    const float* x = reinterpret_cast<const float*>(pRegisters + ezExpressionByteCode::GetRegisterIndex(pByteCode, uiNumRegisters));
+
+    for (; r + 16 <= re; r += 16, x += 16)
+    {
+      _mm256_storeu_ps(r, Op::Op(_mm256_loadu_ps(x)));
+      _mm256_storeu_ps(r + 8, Op::Op(_mm256_loadu_ps(x + 8)));
+    }
+
+    if (r != re)
+    {
+      _mm256_storeu_ps(r, Op::Op(_mm256_loadu_ps(x)));
+    }
+  }
+
+  template <typename Op>
+  EZ_AVX_FUNCTION void VMOperation1_C_AVX(const ezExpressionByteCode::StorageType*& pByteCode, ezSimdVec4f* pRegisters, ezUInt32 uiNumRegisters)
+  {
+    float* r = reinterpret_cast<float*>(pRegisters + ezExpressionByteCode::GetRegisterIndex(pByteCode, uiNumRegisters));
+    float* re = r + uiNumRegisters * 4;
+
+    const __m256 x = Op::Op(_mm256_set1_ps(*reinterpret_cast<const float*>(pByteCode)));
+    ++pByteCode;
+
+    for (; r != re; r += 8)
+    {
+      _mm256_storeu_ps(r, x);
+    }
+  }
+
+  template <typename Op>
+  EZ_AVX_FUNCTION void VMOperation2_AVX(const ezExpressionByteCode::StorageType*& pByteCode, ezSimdVec4f* pRegisters, ezUInt32 uiNumRegisters)
+  {
+    float* r = reinterpret_cast<float*>(pRegisters + ezExpressionByteCode::GetRegisterIndex(pByteCode, uiNumRegisters));
+    float* re = r + uiNumRegisters * 4;
+
+    const float* a = reinterpret_cast<const float*>(pRegisters + ezExpressionByteCode::GetRegisterIndex(pByteCode, uiNumRegisters));
+    const float* b = reinterpret_cast<const float*>(pRegisters + ezExpressionByteCode::GetRegisterIndex(pByteCode, uiNumRegisters));
+
+    for (; r + 16 <= re; r += 16, a += 16, b += 16)
+    {
+      _mm256_storeu_ps(r, Op::Op(_mm256_loadu_ps(a), _mm256_loadu_ps(b)));
+      _mm256_storeu_ps(r + 8, Op::Op(_mm256_loadu_ps(a + 8), _mm256_loadu_ps(b + 8)));
+    }
+
+    if (r != re)
+    {
+      _mm256_storeu_ps(r, Op::Op(_mm256_loadu_ps(a), _mm256_loadu_ps(b)));
+    }
+  }
+
+  template <typename Op>
+  EZ_AVX_FUNCTION void VMOperation2_C_AVX(const ezExpressionByteCode::StorageType*& pByteCode, ezSimdVec4f* pRegisters, ezUInt32 uiNumRegisters)
+  {
+    float* r = reinterpret_cast<float*>(pRegisters + ezExpressionByteCode::GetRegisterIndex(pByteCode, uiNumRegisters));
+    float* re = r + uiNumRegisters * 4;
+
+    const __m256 a = _mm256_set1_ps(*reinterpret_cast<const float*>(pByteCode));
+    ++pByteCode;
+
+    const float* b = reinterpret_cast<const float*>(pRegisters + ezExpressionByteCode::GetRegisterIndex(pByteCode, uiNumRegisters));
+
+    for (; r + 16 <= re; r += 16, b += 16)
+    {
+      _mm256_storeu_ps(r, Op::Op(a, _mm256_loadu_ps(b)));
+      _mm256_storeu_ps(r + 8, Op::Op(a, _mm256_loadu_ps(b + 8)));
+    }
+
+    if (r != re)
+    {
+      _mm256_storeu_ps(r, Op::Op(a, _mm256_loadu_ps(b)));
+    }
+  }
+
+  template <typename Op>
+  EZ_AVX_FUNCTION void VMOperation3_AVX(const ezExpressionByteCode::StorageType*& pByteCode, ezSimdVec4f* pRegisters, ezUInt32 uiNumRegisters)
+  {
+    float* r = reinterpret_cast<float*>(pRegisters + ezExpressionByteCode::GetRegisterIndex(pByteCode, uiNumRegisters));
+    float* re = r + uiNumRegisters * 4;
+
+    const float* a = reinterpret_cast<const float*>(pRegisters + ezExpressionByteCode::GetRegisterIndex(pByteCode, uiNumRegisters));
+    const float* b = reinterpret_cast<const float*>(pRegisters + ezExpressionByteCode::GetRegisterIndex(pByteCode, uiNumRegisters));
+    const float* c = reinterpret_cast<const float*>(pRegisters + ezExpressionByteCode::GetRegisterIndex(pByteCode, uiNumRegisters));
+
+    for (; r + 16 <= re; r += 16, a += 16, b += 16, c += 16)
+    {
+      _mm256_storeu_ps(r, Op::Op(_mm256_loadu_ps(a), _mm256_loadu_ps(b), _mm256_loadu_ps(c)));
+      _mm256_storeu_ps(r + 8, Op::Op(_mm256_loadu_ps(a + 8), _mm256_loadu_ps(b + 8), _mm256_loadu_ps(c + 8)));
+    }
+
+    if (r != re)
+    {
+      _mm256_storeu_ps(r, Op::Op(_mm256_loadu_ps(a), _mm256_loadu_ps(b), _mm256_loadu_ps(c)));
+    }
+  }
+
+  bool DetectAvxSupport()
+  {
+#  if EZ_ENABLED(EZ_COMPILER_MSVC)
+    int cpuInfo[4];
+    __cpuid(cpuInfo, 1);
+
+    const bool bOSXSave = (cpuInfo[2] & (1 << 27)) != 0;
+    const bool bAvx = (cpuInfo[2] & (1 << 28)) != 0;
+
+    // the OS must save the upper halves of the YMM registers on context switches
+    return bOSXSave && bAvx && (_xgetbv(0) & 0x6) == 0x6;
+#  else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx") != 0;
+#  endif
+  }
+
+#endif
+
+#if EZ_ENABLED(EZ_EXPRESSION_VM_AVX)
+#  define VM_AVX_OPERATION(func, op)                   \
+    if (bUseAvx)                                       \
+    {                                                  \
+      func<op>(pByteCode, pRegisters, uiNumRegisters); \
+      break;                                           \
+    }
+#else
+#  define VM_AVX_OPERATION(func, op)
+#endif
 } // namespace
 
 //////////////////////////////////////////////////////////////////////////
@@ -227,9 +452,24 @@ void ezExpression::Stream::ValidateDataSize(ezUInt32 uiNumInstances, const char*
 
 //////////////////////////////////////////////////////////////////////////
 
-ezExpressionVM::ezExpressionVM() = default;
+ezExpressionVM::ezExpressionVM()
+{
+  m_bAvxEnabled = IsAvxSupported();
+}
+
 ezExpressionVM::~ezExpressionVM() = default;
 
+// static
+bool ezExpressionVM::IsAvxSupported()
+{
+#if EZ_ENABLED(EZ_EXPRESSION_VM_AVX)
+  static bool s_bAvxSupported = DetectAvxSupport();
+  return s_bAvxSupported;
+#else
+  return false;
+#endif
+}
+
 void ezExpressionVM::RegisterFunction(const char* szName, ezExpressionFunction func,
   ezExpressionValidateGlobalData validationFunc /*= ezExpressionValidateGlobalData()*/)
 {
@@ -344,7 +584,14 @@ ezResult ezExpressionVM::Execute(const ezExpressionByteCode& byteCode, ezArrayPt
     }
   }
 
-  const ezUInt32 uiNumRegisters = (uiNumInstances + 3) / 4;
+#if EZ_ENABLED(EZ_EXPRESSION_VM_AVX)
+  const bool bUseAvx = m_bAvxEnabled;
+#else
+  const bool bUseAvx = false;
+#endif
+
+  // the AVX path processes two registers at once, the additional instances just repeat the last input value like in the 4-wide path
+  const ezUInt32 uiNumRegisters = bUseAvx ? ((uiNumInstances + 7) / 8) * 2 : (uiNumInstances + 3) / 4;
   const ezUInt32 uiLastInstanceIndex = uiNumInstances - 1;
 
   const ezUInt32 uiTotalNumRegisters = byteCode.GetNumTempRegisters() * uiNumRegisters;
@@ -364,10 +611,12 @@ ezResult ezExpressionVM::Execute(const ezExpressionByteCode& byteCode, ezArrayPt
     {
         // unary
       case ezExpressionByteCode::OpCode::Abs_R:
+        VM_AVX_OPERATION(VMOperation1_AVX, AvxAbs);
         VMOperation1(pByteCode, pRegisters, uiNumRegisters, [](const ezSimdVec4f& x) { return x.Abs(); });
         break;
 
       case ezExpressionByteCode::OpCode::Sqrt_R:
+        VM_AVX_OPERATION(VMOperation1_AVX, AvxSqrt);
         VMOperation1(pByteCode, pRegisters, uiNumRegisters, [](const ezSimdVec4f& x) { return x.GetSqrt(); });
         break;
 
@@ -396,10 +645,12 @@ ezResult ezExpressionVM::Execute(const ezExpressionByteCode& byteCode, ezArrayPt
         break;
 
       case ezExpressionByteCode::OpCode::Mov_R:
+        VM_AVX_OPERATION(VMOperation1_AVX, AvxMov);
         VMOperation1(pByteCode, pRegisters, uiNumRegisters, [](const ezSimdVec4f& x) { return x; });
         break;
 
       case ezExpressionByteCode::OpCode::Mov_C:
+        VM_AVX_OPERATION(VMOperation1_C_AVX, AvxMov);
         VMOperation1_C(pByteCode, pRegisters, uiNumRegisters, [](const ezSimdVec4f& x) { return x; });
         break;
 
@@ -413,53 +664,72 @@ ezResult ezExpressionVM::Execute(const ezExpressionByteCode& byteCode, ezArrayPt
 
         // binary
       case ezExpressionByteCode::OpCode::Add_RR:
+        VM_AVX_OPERATION(VMOperation2_AVX, AvxAdd);
         VMOperation2(pByteCode, pRegisters, uiNumRegisters, [](const ezSimdVec4f& a, const ezSimdVec4f& b) { return a + b; });
         break;
 
       case ezExpressionByteCode::OpCode::Add_CR:
+        VM_AVX_OPERATION(VMOperation2_C_AVX, AvxAdd);
         VMOperation2_C(pByteCode, pRegisters, uiNumRegisters, [](const ezSimdVec4f& a, const ezSimdVec4f& b) { return a + b; });
         break;
 
       case ezExpressionByteCode::OpCode::Sub_RR:
+        VM_AVX_OPERATION(VMOperation2_AVX, AvxSub);
         VMOperation2(pByteCode, pRegisters, uiNumRegisters, [](const ezSimdVec4f& a, const ezSimdVec4f& b) { return a - b; });
         break;
 
       case ezExpressionByteCode::OpCode::Sub_CR:
+        VM_AVX_OPERATION(VMOperation2_C_AVX, AvxSub);
         VMOperation2_C(pByteCode, pRegisters, uiNumRegisters, [](const ezSimdVec4f& a, const ezSimdVec4f& b) { return a - b; });
         break;
 
       case ezExpressionByteCode::OpCode::Mul_RR:
+        VM_AVX_OPERATION(VMOperation2_AVX, AvxMul);
         VMOperation2(pByteCode, pRegisters, uiNumRegisters, [](const ezSimdVec4f& a, const ezSimdVec4f& b) { return a.CompMul(b); });
         break;
 
       case ezExpressionByteCode::OpCode::Mul_CR:
+        VM_AVX_OPERATION(VMOperation2_C_AVX, AvxMul);
         VMOperation2_C(pByteCode, pRegisters, uiNumRegisters, [](const ezSimdVec4f& a, const ezSimdVec4f& b) { return a.CompMul(b); });
         break;
 
       case ezExpressionByteCode::OpCode::Div_RR:
+        VM_AVX_OPERATION(VMOperation2_AVX, AvxDiv);
         VMOperation2(pByteCode, pRegisters, uiNumRegisters, [](const ezSimdVec4f& a, const ezSimdVec4f& b) { return a.CompDiv(b); });
         break;
 
       case ezExpressionByteCode::OpCode::Div_CR:
+        VM_AVX_OPERATION(VMOperation2_C_AVX, AvxDiv);
         VMOperation2_C(pByteCode, pRegisters, uiNumRegisters, [](const ezSimdVec4f& a, const ezSimdVec4f& b) { return a.CompDiv(b); });
         break;
 
       case ezExpressionByteCode::OpCode::Min_RR:
+        VM_AVX_OPERATION(VMOperation2_AVX, AvxMin);
         VMOperation2(pByteCode, pRegisters, uiNumRegisters, [](const ezSimdVec4f& a, const ezSimdVec4f& b) { return a.CompMin(b); });
         break;
 
       case ezExpressionByteCode::OpCode::Min_CR:
+        VM_AVX_OPERATION(VMOperation2_C_AVX, AvxMin);
         VMOperation2_C(pByteCode, pRegisters, uiNumRegisters, [](const ezSimdVec4f& a, const ezSimdVec4f& b) { return a.CompMin(b); });
         break;
 
       case ezExpressionByteCode::OpCode::Max_RR:
+        VM_AVX_OPERATION(VMOperation2_AVX, AvxMax);
         VMOperation2(pByteCode, pRegisters, uiNumRegisters, [](const ezSimdVec4f& a, const ezSimdVec4f& b) { return a.CompMax(b); });
         break;
 
       case ezExpressionByteCode::OpCode::Max_CR:
+        VM_AVX_OPERATION(VMOperation2_C_AVX, AvxMax);
         VMOperation2_C(pByteCode, pRegisters, uiNumRegisters, [](const ezSimdVec4f& a, const ezSimdVec4f& b) { return a.CompMax(b); });
         break;
 
+        // ternary
+      case ezExpressionByteCode::OpCode::MulAdd_RRR:
+        VM_AVX_OPERATION(VMOperation3_AVX, AvxMulAdd);
+        VMOperation3(pByteCode, pRegisters, uiNumRegisters,
+          [](const ezSimdVec4f& a, const ezSimdVec4f& b, const ezSimdVec4f& c) { return a.CompMul(b) + c; });
+        break;
+
         // call
       case ezExpressionByteCode::OpCode::Call:
       {
@@ -0,0 +1,104 @@
+#include <Foundation/Application/Application.h>
+#include <Foundation/IO/FileSystem/FileReader.h>
+#include <Foundation/IO/FileSystem/FileSystem.h>
+#include <Foundation/IO/FileSystem/FileWriter.h>
+#include <Foundation/Logging/ConsoleWriter.h>
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Logging/VisualStudioWriter.h>
+#include <Foundation/Profiling/Profiling.h>
+#include <Foundation/Strings/StringBuilder.h>
+#include <Foundation/Utilities/CommandLineUtils.h>
+
+/// Converts a binary trace that was written by ezProfilingSystem::StartStreaming() into a JSON file that can be opened in chrome://tracing.
+///
+/// Usage: ProfilingTraceConverter -in "path/to/trace.ezpt" [-out "path/to/trace.json"]
+class ezProfilingTraceConverter : public ezApplication
+{
+  ezStringBuilder m_sInputFile;
+  ezStringBuilder m_sOutputFile;
+
+public:
+  typedef ezApplication SUPER;
+
+  ezProfilingTraceConverter()
+    : ezApplication("ProfilingTraceConverter")
+  {
+  }
+
+  ezResult ParseArguments()
+  {
+    ezCommandLineUtils* cmd = ezCommandLineUtils::GetGlobalInstance();
+
+    m_sInputFile = cmd->GetAbsolutePathOption("-in");
+    m_sOutputFile = cmd->GetAbsolutePathOption("-out");
+
+    if (m_sInputFile.IsEmpty())
+    {
+      ezLog::Error("Missing '-in' argument");
+      return EZ_FAILURE;
+    }
+
+    if (m_sOutputFile.IsEmpty())
+    {
+      m_sOutputFile = m_sInputFile;
+      m_sOutputFile.ChangeFileExtension("json");
+    }
+
+    return EZ_SUCCESS;
+  }
+
+  virtual void AfterCoreSystemsStartup() override
+  {
+    // Add the empty data directory to access files via absolute paths
+    ezFileSystem::AddDataDirectory("", "App", ":", ezFileSystem::AllowWrites);
+
+    ezGlobalLog::AddLogWriter(ezLogWriter::Console::LogMessageHandler);
+    ezGlobalLog::AddLogWriter(ezLogWriter::VisualStudio::LogMessageHandler);
+  }
+
+  virtual void BeforeCoreSystemsShutdown() override
+  {
+    // prevent further output during shutdown
+    ezGlobalLog::RemoveLogWriter(ezLogWriter::Console::LogMessageHandler);
+    ezGlobalLog::RemoveLogWriter(ezLogWriter::VisualStudio::LogMessageHandler);
+
+    SUPER::BeforeCoreSystemsShutdown();
+  }
+
+  virtual ApplicationExecution Run() override
+  {
+    if (ParseArguments().Failed())
+    {
+      SetReturnCode(1);
+      return ezApplication::Quit;
+    }
+
+    ezFileReader input;
+    if (input.Open(m_sInputFile).Failed())
+    {
+      ezLog::Error("Could not open '{0}' for reading.", m_sInputFile);
+      SetReturnCode(1);
+      return ezApplication::Quit;
+    }
+
+    ezFileWriter output;
+    if (output.Open(m_sOutputFile).Failed())
+    {
+      ezLog::Error("Could not open '{0}' for writing.", m_sOutputFile);
+      SetReturnCode(1);
+      return ezApplication::Quit;
+    }
+
+    if (ezProfilingSystem::ConvertTraceToJSON(input, output).Failed())
+    {
+      ezLog::Error("Failed to convert '{0}'.", m_sInputFile);
+      SetReturnCode(1);
+      return ezApplication::Quit;
+    }
+
+    ezLog::Success("Profiling trace written to '{0}'.", m_sOutputFile);
+    return ezApplication::Quit;
+  }
+};
+
+EZ_CONSOLEAPP_ENTRY_POINT(ezProfilingTraceConverter);
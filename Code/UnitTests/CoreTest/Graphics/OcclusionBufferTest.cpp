@@ -0,0 +1,123 @@
+#include <CoreTestPCH.h>
+
+#include <Core/Graphics/OcclusionBuffer.h>
+#include <Foundation/Utilities/GraphicsUtils.h>
+
+EZ_CREATE_SIMPLE_TEST_GROUP(Graphics);
+
+namespace
+{
+  ezBoundingBox MakeBox(const ezVec3& vCenter, const ezVec3& vHalfExtents)
+  {
+    ezBoundingBox box;
+    box.SetCenterAndHalfExtents(vCenter, vHalfExtents);
+    return box;
+  }
+
+  void TestPerspective(ezClipSpaceDepthRange::Enum depthRange)
+  {
+    // camera at the origin looking along +x
+    const ezMat4 mView = ezGraphicsUtils::CreateLookAtViewMatrix(ezVec3::ZeroVector(), ezVec3(1, 0, 0), ezVec3(0, 0, 1));
+    const ezMat4 mProj = ezGraphicsUtils::CreatePerspectiveProjectionMatrixFromFovX(ezAngle::Degree(120.0f), 1.0f, 0.1f, 1000.0f, depthRange);
+
+    ezOcclusionBuffer buffer;
+    buffer.Initialize(126, 64);
+    EZ_TEST_INT(buffer.GetWidth(), 128);
+    EZ_TEST_INT(buffer.GetHeight(), 64);
+
+    buffer.BeginView(mProj * mView, depthRange);
+    EZ_TEST_BOOL(!buffer.HasOccluders());
+    EZ_TEST_BOOL(buffer.IsBoxVisible(MakeBox(ezVec3(20, 0, 0), ezVec3(1.0f))));
+
+    // a wall in front of the camera
+    ezMat4 mWallTransform;
+    mWallTransform.SetTranslationMatrix(ezVec3(10, 0, 0));
+    buffer.RasterizeBox(MakeBox(ezVec3::ZeroVector(), ezVec3(0.2f, 10.0f, 10.0f)), mWallTransform);
+    EZ_TEST_BOOL(buffer.HasOccluders());
+
+    // behind the wall
+    EZ_TEST_BOOL(!buffer.IsBoxVisible(MakeBox(ezVec3(20, 0, 0), ezVec3(1.0f))));
+    EZ_TEST_BOOL(!buffer.IsBoxVisible(MakeBox(ezVec3(500, 100, -50), ezVec3(10.0f))));
+
+    // in front of the wall
+    EZ_TEST_BOOL(buffer.IsBoxVisible(MakeBox(ezVec3(5, 0, 0), ezVec3(1.0f))));
+
+    // next to the wall
+    EZ_TEST_BOOL(buffer.IsBoxVisible(MakeBox(ezVec3(12, 15, 0), ezVec3(0.5f))));
+
+    // behind the wall, but larger than it
+    EZ_TEST_BOOL(buffer.IsBoxVisible(MakeBox(ezVec3(20, 0, 0), ezVec3(1.0f, 30.0f, 1.0f))));
+
+    // intersecting the wall
+    EZ_TEST_BOOL(buffer.IsBoxVisible(MakeBox(ezVec3(10, 0, 0), ezVec3(1.0f))));
+
+    // intersecting the near plane
+    EZ_TEST_BOOL(buffer.IsBoxVisible(MakeBox(ezVec3(0, 0, 0), ezVec3(0.5f))));
+
+    // a floor below the camera that extends behind it needs to be clipped at the near plane
+    buffer.BeginView(mProj * mView, depthRange);
+    buffer.RasterizeBox(MakeBox(ezVec3(0, 0, -2), ezVec3(100.0f, 100.0f, 0.1f)), ezMat4::IdentityMatrix());
+
+    EZ_TEST_BOOL(!buffer.IsBoxVisible(MakeBox(ezVec3(20, 0, -10), ezVec3(1.0f))));
+    EZ_TEST_BOOL(buffer.IsBoxVisible(MakeBox(ezVec3(20, 0, 0), ezVec3(1.0f))));
+  }
+} // namespace
+
+EZ_CREATE_SIMPLE_TEST(Graphics, OcclusionBuffer)
+{
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Perspective ZeroToOne")
+  {
+    TestPerspective(ezClipSpaceDepthRange::ZeroToOne);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Perspective MinusOneToOne")
+  {
+    TestPerspective(ezClipSpaceDepthRange::MinusOneToOne);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Orthographic")
+  {
+    const ezMat4 mView = ezGraphicsUtils::CreateLookAtViewMatrix(ezVec3::ZeroVector(), ezVec3(1, 0, 0), ezVec3(0, 0, 1));
+    const ezMat4 mProj = ezGraphicsUtils::CreateOrthographicProjectionMatrix(40.0f, 40.0f, 0.1f, 100.0f);
+
+    ezOcclusionBuffer buffer;
+    buffer.Initialize(64, 64);
+    buffer.BeginView(mProj * mView);
+
+    ezMat4 mWallTransform;
+    mWallTransform.SetTranslationMatrix(ezVec3(10, 0, 0));
+    buffer.RasterizeBox(MakeBox(ezVec3::ZeroVector(), ezVec3(0.2f, 10.0f, 10.0f)), mWallTransform);
+
+    // an occluder behind the camera must not hide anything
+    mWallTransform.SetTranslationMatrix(ezVec3(-10, 0, 0));
+    buffer.RasterizeBox(MakeBox(ezVec3::ZeroVector(), ezVec3(0.2f, 50.0f, 50.0f)), mWallTransform);
+
+    EZ_TEST_BOOL(!buffer.IsBoxVisible(MakeBox(ezVec3(20, 0, 0), ezVec3(1.0f))));
+    EZ_TEST_BOOL(!buffer.IsBoxVisible(MakeBox(ezVec3(50, 5, 5), ezVec3(4.0f))));
+    EZ_TEST_BOOL(buffer.IsBoxVisible(MakeBox(ezVec3(5, 0, 0), ezVec3(1.0f))));
+    EZ_TEST_BOOL(buffer.IsBoxVisible(MakeBox(ezVec3(20, 15, 0), ezVec3(1.0f))));
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "RasterizeTriangle")
+  {
+    ezOcclusionBuffer buffer;
+    buffer.Initialize(16, 16);
+
+    // identity view-projection, the triangle covers the lower left half of the screen
+    buffer.BeginView(ezMat4::IdentityMatrix(), ezClipSpaceDepthRange::ZeroToOne);
+    buffer.RasterizeTriangle(ezVec3(-1, -1, 0.5f), ezVec3(1, -1, 0.5f), ezVec3(-1, 1, 0.5f));
+
+    EZ_TEST_FLOAT(buffer.GetDepth(0, 15), 0.5f, 0.0001f);
+    EZ_TEST_FLOAT(buffer.GetDepth(4, 8), 0.5f, 0.0001f);
+    EZ_TEST_FLOAT(buffer.GetDepth(15, 0), ezMath::MaxValue<float>(), 0.0f);
+
+    // closer triangle with the opposite winding overwrites the depth
+    buffer.RasterizeTriangle(ezVec3(-1, -1, 0.25f), ezVec3(-1, 1, 0.25f), ezVec3(1, -1, 0.25f));
+    EZ_TEST_FLOAT(buffer.GetDepth(4, 8), 0.25f, 0.0001f);
+
+    // farther triangle does not
+    buffer.RasterizeTriangle(ezVec3(-1, -1, 0.75f), ezVec3(-1, 1, 0.75f), ezVec3(1, 1, 0.75f));
+    EZ_TEST_FLOAT(buffer.GetDepth(4, 8), 0.25f, 0.0001f);
+    EZ_TEST_FLOAT(buffer.GetDepth(8, 1), 0.75f, 0.0001f);
+  }
+}
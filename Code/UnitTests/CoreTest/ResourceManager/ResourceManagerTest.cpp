@@ -1,6 +1,9 @@
 #include <CoreTestPCH.h>
 
+#include <Core/ResourceManager/ResourceLoadingQueue.h>
 #include <Core/ResourceManager/ResourceManager.h>
+#include <Foundation/Math/Random.h>
+#include <Foundation/Time/Stopwatch.h>
 #include <Foundation/Types/ScopeExit.h>
 
 EZ_CREATE_SIMPLE_TEST_GROUP(ResourceManager);
@@ -129,6 +132,61 @@ namespace
   EZ_BEGIN_DYNAMIC_REFLECTED_TYPE(TestResource, 1, ezRTTIDefaultAllocator<TestResource>)
   EZ_END_DYNAMIC_REFLECTED_TYPE;
 
+  typedef ezTypedResourceHandle<class TestQualityResource> TestQualityResourceHandle;
+
+  /// Pretends to have 3 quality levels that use 1000 bytes of GPU memory each.
+  class TestQualityResource : public ezResource
+  {
+    EZ_ADD_DYNAMIC_REFLECTION(TestQualityResource, ezResource);
+    EZ_RESOURCE_DECLARE_COMMON_CODE(TestQualityResource);
+
+  public:
+    TestQualityResource()
+      : ezResource(ezResource::DoUpdate::OnAnyThread, 1)
+    {
+    }
+
+    ezUInt32 m_uiLoadedQualityLevels = 0;
+
+  protected:
+    virtual ezResourceLoadDesc UnloadData(Unload WhatToUnload) override
+    {
+      if (WhatToUnload == Unload::AllQualityLevels || m_uiLoadedQualityLevels <= 1)
+        m_uiLoadedQualityLevels = 0;
+      else
+        --m_uiLoadedQualityLevels;
+
+      ezResourceLoadDesc ld;
+      ld.m_State = m_uiLoadedQualityLevels > 0 ? ezResourceState::Loaded : ezResourceState::Unloaded;
+      ld.m_uiQualityLevelsDiscardable = static_cast<ezUInt8>(m_uiLoadedQualityLevels > 0 ? m_uiLoadedQualityLevels - 1 : 0);
+      ld.m_uiQualityLevelsLoadable = static_cast<ezUInt8>(3 - m_uiLoadedQualityLevels);
+
+      return ld;
+    }
+
+    virtual ezResourceLoadDesc UpdateContent(ezStreamReader* Stream) override
+    {
+      m_uiLoadedQualityLevels = 3;
+
+      ezResourceLoadDesc ld;
+      ld.m_State = ezResourceState::Loaded;
+      ld.m_uiQualityLevelsDiscardable = 2;
+      ld.m_uiQualityLevelsLoadable = 0;
+
+      return ld;
+    }
+
+    virtual void UpdateMemoryUsage(MemoryUsage& out_NewMemoryUsage) override
+    {
+      out_NewMemoryUsage.m_uiMemoryCPU = 0;
+      out_NewMemoryUsage.m_uiMemoryGPU = m_uiLoadedQualityLevels * 1000;
+    }
+  };
+
+  EZ_RESOURCE_IMPLEMENT_COMMON_CODE(TestQualityResource);
+  EZ_BEGIN_DYNAMIC_REFLECTED_TYPE(TestQualityResource, 1, ezRTTIDefaultAllocator<TestQualityResource>)
+  EZ_END_DYNAMIC_REFLECTED_TYPE;
+
 } // namespace
 
 EZ_CREATE_SIMPLE_TEST(ResourceManager, Basics)
@@ -289,3 +347,329 @@ EZ_CREATE_SIMPLE_TEST(ResourceManager, NestedLoading)
     EZ_TEST_INT(ezResourceManager::GetAllResourcesOfType<TestResource>()->GetCount(), 0);
   }
 }
+
+EZ_CREATE_SIMPLE_TEST(ResourceManager, LoadingQueue)
+{
+  struct QueuedResource
+  {
+    ezResource* m_pResource = nullptr;
+    float m_fPriority = 0.0f;
+    ezUInt32 m_uiInsertionOrder = 0;
+    bool m_bQueued = false;
+  };
+
+  auto CreateResources = [](ezUInt32 uiNumResources, ezDynamicArray<TestResourceHandle>& out_Handles, ezDynamicArray<QueuedResource>& out_Resources) {
+    out_Handles.Reserve(uiNumResources);
+    out_Resources.SetCount(uiNumResources);
+
+    ezStringBuilder sResourceID;
+    for (ezUInt32 i = 0; i < uiNumResources; ++i)
+    {
+      sResourceID.Format("LoadingQueue-{}", i);
+      out_Handles.PushBack(ezResourceManager::LoadResource<TestResource>(sResourceID));
+
+      // pointer only access does not put the resource into the loading queue of the resource manager
+      ezResourceLock<TestResource> pTestResource(out_Handles[i], ezResourceAcquireMode::PointerOnly);
+      out_Resources[i].m_pResource = pTestResource.GetPointerNonConst();
+    }
+  };
+
+  auto FreeResources = [](ezDynamicArray<TestResourceHandle>& handles) {
+    const ezUInt32 uiNumResources = handles.GetCount();
+    handles.Clear();
+
+    EZ_TEST_INT(ezResourceManager::FreeAllUnusedResources(), uiNumResources);
+    EZ_TEST_INT(ezResourceManager::GetAllResourcesOfType<TestResource>()->GetCount(), 0);
+  };
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Shifting Priorities")
+  {
+    ezDynamicArray<TestResourceHandle> hResources;
+    ezDynamicArray<QueuedResource> resources;
+    CreateResources(1000, hResources, resources);
+
+    ezRandom rng;
+    rng.Initialize(42);
+
+    ezResourceLoadingQueue queue;
+    ezUInt32 uiInsertionOrder = 0;
+
+    for (ezUInt32 round = 0; round < 10; ++round)
+    {
+      for (auto& res : resources)
+      {
+        const ezUInt32 uiAction = rng.UIntInRange(4);
+
+        // only a few distinct values, to test that equal priorities are returned in insertion order
+        const float fPriority = static_cast<float>(rng.UIntInRange(20));
+
+        if (!res.m_bQueued)
+        {
+          if (uiAction == 0)
+            continue;
+
+          res.m_fPriority = fPriority;
+          res.m_uiInsertionOrder = uiInsertionOrder++;
+          res.m_bQueued = true;
+          queue.Insert(res.m_pResource, fPriority);
+        }
+        else if (uiAction == 0)
+        {
+          res.m_bQueued = false;
+          EZ_TEST_BOOL(queue.Remove(res.m_pResource));
+          EZ_TEST_BOOL(!queue.Remove(res.m_pResource));
+        }
+        else if (uiAction == 1)
+        {
+          res.m_fPriority = fPriority;
+          EZ_TEST_BOOL(queue.UpdatePriority(res.m_pResource, fPriority));
+        }
+
+        EZ_TEST_BOOL(queue.Contains(res.m_pResource) == res.m_bQueued);
+      }
+
+      // sort the reference by priority and insertion order, and load some of the resources in between the priority changes
+      ezDynamicArray<QueuedResource*> expectedOrder;
+      for (auto& res : resources)
+      {
+        if (res.m_bQueued)
+          expectedOrder.PushBack(&res);
+      }
+
+      expectedOrder.Sort([](const QueuedResource* a, const QueuedResource* b) {
+        if (a->m_fPriority != b->m_fPriority)
+          return a->m_fPriority < b->m_fPriority;
+
+        return a->m_uiInsertionOrder < b->m_uiInsertionOrder;
+      });
+
+      EZ_TEST_INT(queue.GetCount(), expectedOrder.GetCount());
+
+      const ezUInt32 uiNumToLoad = (round == 9) ? expectedOrder.GetCount() : ezMath::Min(100u, expectedOrder.GetCount());
+      for (ezUInt32 i = 0; i < uiNumToLoad; ++i)
+      {
+        EZ_TEST_FLOAT(queue.PeekFront().m_fPriority, expectedOrder[i]->m_fPriority, 0.0f);
+        EZ_TEST_BOOL(queue.PopFront() == expectedOrder[i]->m_pResource);
+        EZ_TEST_BOOL(!queue.Contains(expectedOrder[i]->m_pResource));
+
+        expectedOrder[i]->m_bQueued = false;
+      }
+    }
+
+    EZ_TEST_BOOL(queue.IsEmpty());
+
+    FreeResources(hResources);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Insert At Front")
+  {
+    ezDynamicArray<TestResourceHandle> hResources;
+    ezDynamicArray<QueuedResource> resources;
+    CreateResources(4, hResources, resources);
+
+    ezResourceLoadingQueue queue;
+    queue.Insert(resources[0].m_pResource, 0.0f);
+    queue.Insert(resources[1].m_pResource, 5.0f);
+    queue.Insert(resources[2].m_pResource, 0.0f, true);
+    queue.Insert(resources[3].m_pResource, 0.0f, true);
+
+    EZ_TEST_BOOL(queue.PopFront() == resources[3].m_pResource);
+    EZ_TEST_BOOL(queue.PopFront() == resources[2].m_pResource);
+    EZ_TEST_BOOL(queue.PopFront() == resources[0].m_pResource);
+
+    queue.Insert(resources[0].m_pResource, 10.0f);
+    EZ_TEST_BOOL(queue.UpdatePriority(resources[0].m_pResource, 1.0f));
+    EZ_TEST_BOOL(queue.PopFront() == resources[0].m_pResource);
+
+    queue.Clear();
+    EZ_TEST_BOOL(!queue.Contains(resources[1].m_pResource));
+    EZ_TEST_BOOL(!queue.UpdatePriority(resources[1].m_pResource, 1.0f));
+
+    FreeResources(hResources);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Performance")
+  {
+    const ezUInt32 uiNumResources = 20000;
+
+    ezDynamicArray<TestResourceHandle> hResources;
+    ezDynamicArray<QueuedResource> resources;
+    CreateResources(uiNumResources, hResources, resources);
+
+    ezRandom rng;
+    rng.Initialize(7);
+
+    ezResourceLoadingQueue queue;
+    ezStopwatch sw;
+
+    for (auto& res : resources)
+    {
+      queue.Insert(res.m_pResource, rng.FloatMinMax(0.0f, 100.0f));
+    }
+
+    const ezTime tInsert = sw.Checkpoint();
+
+    // simulates re-evaluating the deadlines of all queued resources a couple of times
+    for (ezUInt32 round = 0; round < 10; ++round)
+    {
+      for (auto& res : resources)
+      {
+        queue.UpdatePriority(res.m_pResource, rng.FloatMinMax(0.0f, 100.0f));
+      }
+    }
+
+    const ezTime tUpdate = sw.Checkpoint();
+
+    float fLastPriority = 0.0f;
+    bool bSorted = true;
+    while (!queue.IsEmpty())
+    {
+      bSorted &= queue.PeekFront().m_fPriority >= fLastPriority;
+      fLastPriority = queue.PeekFront().m_fPriority;
+      queue.PopFront();
+    }
+
+    const ezTime tPop = sw.Checkpoint();
+
+    EZ_TEST_BOOL(bSorted);
+
+    ezTestFramework::Output(ezTestOutput::Duration, "Loading queue with %u resources: insert %.2fms, %u priority updates %.2fms, pop all %.2fms",
+      uiNumResources, tInsert.GetMilliseconds(), uiNumResources * 10, tUpdate.GetMilliseconds(), tPop.GetMilliseconds());
+
+    FreeResources(hResources);
+  }
+}
+
+EZ_CREATE_SIMPLE_TEST(ResourceManager, MemoryBudget)
+{
+  TestResourceTypeLoader TypeLoader;
+  ezResourceManager::SetResourceTypeLoader<TestResource>(&TypeLoader);
+  ezResourceManager::SetResourceTypeLoader<TestQualityResource>(&TypeLoader);
+  EZ_SCOPE_EXIT(ezResourceManager::SetResourceTypeLoader<TestResource>(nullptr));
+  EZ_SCOPE_EXIT(ezResourceManager::SetResourceTypeLoader<TestQualityResource>(nullptr));
+
+  auto Exists = [](const char* szResourceID) -> bool {
+    // LoadResource would create the resource, so look it up without creating it
+    return ezResourceManager::GetExistingResource<TestResource>(szResourceID).IsValid();
+  };
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Free Unused Resources")
+  {
+    const ezUInt32 uiNumResources = 20;
+
+    ezDynamicArray<TestResourceHandle> hResources;
+
+    ezStringBuilder sResourceID;
+    for (ezUInt32 i = 0; i < uiNumResources; ++i)
+    {
+      sResourceID.Format("Budget-{}", i);
+      hResources.PushBack(ezResourceManager::LoadResource<TestResource>(sResourceID));
+
+      ezResourceLock<TestResource> pTestResource(hResources[i], ezResourceAcquireMode::BlockTillLoaded_NeverFail);
+      EZ_TEST_BOOL(pTestResource.GetAcquireResult() == ezResourceAcquireResult::Final);
+
+      // the last 5 resources are least important, thus they are freed first
+      if (i >= 15)
+      {
+        pTestResource.GetPointerNonConst()->SetPriority(ezResourcePriority::VeryLow);
+      }
+    }
+
+    ezUInt64 uiMemoryCPU = 0;
+    ezUInt64 uiMemoryGPU = 0;
+    ezResourceManager::GetMemoryUsageForResourceType(ezGetStaticRTTI<TestResource>(), uiMemoryCPU, uiMemoryGPU);
+    EZ_TEST_INT(uiMemoryCPU, uiNumResources * sizeof(TestResource));
+
+    // only the first 5 resources stay referenced
+    hResources.SetCount(5);
+
+    ezResourceManager::SetMemoryBudgetForResourceType<TestResource>(12 * sizeof(TestResource), 0);
+    EZ_SCOPE_EXIT(ezResourceManager::SetMemoryBudgetForResourceType<TestResource>(0, 0));
+
+    EZ_TEST_INT(ezResourceManager::EnforceMemoryBudgets(), 8);
+
+    // all low priority resources and 3 of the unreferenced medium priority ones are gone
+    ezUInt32 uiNumExisting[3] = {};
+    for (ezUInt32 i = 0; i < uiNumResources; ++i)
+    {
+      sResourceID.Format("Budget-{}", i);
+
+      if (Exists(sResourceID))
+      {
+        uiNumExisting[i < 5 ? 0 : (i < 15 ? 1 : 2)]++;
+      }
+    }
+
+    EZ_TEST_INT(uiNumExisting[0], 5);
+    EZ_TEST_INT(uiNumExisting[1], 7);
+    EZ_TEST_INT(uiNumExisting[2], 0);
+
+    ezResourceManager::GetMemoryUsageForResourceType(ezGetStaticRTTI<TestResource>(), uiMemoryCPU, uiMemoryGPU);
+    EZ_TEST_INT(uiMemoryCPU, 12 * sizeof(TestResource));
+
+    // within budget, nothing happens
+    EZ_TEST_INT(ezResourceManager::EnforceMemoryBudgets(), 0);
+
+    // referenced resources without quality levels to discard are never touched
+    ezResourceManager::SetMemoryBudgetForResourceType<TestResource>(sizeof(TestResource), 0);
+    EZ_TEST_INT(ezResourceManager::EnforceMemoryBudgets(), 7);
+    EZ_TEST_INT(ezResourceManager::GetAllResourcesOfType<TestResource>()->GetCount(), 5);
+
+    hResources.Clear();
+    ezResourceManager::FreeAllUnusedResources();
+    EZ_TEST_INT(ezResourceManager::GetAllResourcesOfType<TestResource>()->GetCount(), 0);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Unload Quality Levels")
+  {
+    TestQualityResourceHandle hOld = ezResourceManager::LoadResource<TestQualityResource>("BudgetQuality-Old");
+    TestQualityResourceHandle hNew = ezResourceManager::LoadResource<TestQualityResource>("BudgetQuality-New");
+
+    {
+      ezResourceLock<TestQualityResource> pOld(hOld, ezResourceAcquireMode::BlockTillLoaded_NeverFail);
+    }
+
+    // the second resource has been acquired more recently, so the first one is unloaded first
+    ezResourceManager::PerFrameUpdate();
+
+    {
+      ezResourceLock<TestQualityResource> pNew(hNew, ezResourceAcquireMode::BlockTillLoaded_NeverFail);
+    }
+
+    ezResourceManager::PerFrameUpdate();
+
+    ezUInt64 uiMemoryCPU = 0;
+    ezUInt64 uiMemoryGPU = 0;
+    ezResourceManager::GetMemoryUsageForResourceType(ezGetStaticRTTI<TestQualityResource>(), uiMemoryCPU, uiMemoryGPU);
+    EZ_TEST_INT(uiMemoryGPU, 6000);
+
+    ezResourceManager::SetMemoryBudgetForResourceType<TestQualityResource>(0, 3500);
+    EZ_SCOPE_EXIT(ezResourceManager::SetMemoryBudgetForResourceType<TestQualityResource>(0, 0));
+
+    // two quality levels of the older resource, then one of the newer one
+    EZ_TEST_INT(ezResourceManager::EnforceMemoryBudgets(), 2);
+
+    {
+      ezResourceLock<TestQualityResource> pOld(hOld, ezResourceAcquireMode::PointerOnly);
+      ezResourceLock<TestQualityResource> pNew(hNew, ezResourceAcquireMode::PointerOnly);
+
+      EZ_TEST_INT(pOld->m_uiLoadedQualityLevels, 1);
+      EZ_TEST_INT(pNew->m_uiLoadedQualityLevels, 2);
+      EZ_TEST_INT(pOld->GetNumQualityLevelsDiscardable(), 0);
+      EZ_TEST_INT(pOld->GetMemoryUsage().m_uiMemoryGPU, 1000);
+    }
+
+    // only the newer resource has a quality level left that may be discarded
+    ezResourceManager::SetMemoryBudgetForResourceType<TestQualityResource>(0, 1500);
+    EZ_TEST_INT(ezResourceManager::EnforceMemoryBudgets(), 1);
+    EZ_TEST_INT(ezResourceManager::EnforceMemoryBudgets(), 0);
+
+    ezResourceManager::GetMemoryUsageForResourceType(ezGetStaticRTTI<TestQualityResource>(), uiMemoryCPU, uiMemoryGPU);
+    EZ_TEST_INT(uiMemoryGPU, 2000);
+
+    hOld.Invalidate();
+    hNew.Invalidate();
+    ezResourceManager::FreeAllUnusedResources();
+    EZ_TEST_INT(ezResourceManager::GetAllResourcesOfType<TestQualityResource>()->GetCount(), 0);
+  }
+}
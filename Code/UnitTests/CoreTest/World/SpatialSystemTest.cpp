@@ -57,10 +57,11 @@ namespace
   // clang-format on
 } // namespace
 
-EZ_CREATE_SIMPLE_TEST(World, SpatialSystem)
+static void TestSpatialSystem(ezSpatialSystemType::Enum spatialSystemType)
 {
   ezWorldDesc worldDesc("Test");
   worldDesc.m_uiRandomNumberGeneratorSeed = 5;
+  worldDesc.m_AutoCreatedSpatialSystemType = spatialSystemType;
 
   ezWorld world(worldDesc);
   EZ_LOCK(world.GetWriteMarker());
@@ -207,6 +208,162 @@ EZ_CREATE_SIMPLE_TEST(World, SpatialSystem)
     }
   }
 
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "FindVisibleObjects")
+  {
+    ezFrustum testFrustum;
+    testFrustum.SetFrustum(ezVec3(100.0f, 60.0f, 400.0f), ezVec3(1.0f, 0.5f, 0.2f), ezVec3(0.0f, 0.0f, 1.0f), ezAngle::Degree(70.0f), ezAngle::Degree(50.0f), 1.0f, 8000.0f);
+
+    ezDynamicArray<const ezGameObject*> visibleObjects;
+    ezHashSet<const ezGameObject*> uniqueObjects;
+    world.GetSpatialSystem()->FindVisibleObjects(testFrustum, uiCategoryBitmask, visibleObjects);
+
+    EZ_TEST_BOOL(!visibleObjects.IsEmpty());
+
+    for (auto pObject : visibleObjects)
+    {
+      EZ_TEST_BOOL(testFrustum.Overlaps(pObject->GetGlobalBoundsSimd().GetSphere()));
+      EZ_TEST_BOOL(!uniqueObjects.Insert(pObject));
+      EZ_TEST_BOOL(pObject->IsStatic());
+    }
+
+    // Check for missing objects
+    for (auto it = world.GetObjects(); it.IsValid(); ++it)
+    {
+      if (testFrustum.Overlaps(it->GetGlobalBoundsSimd().GetSphere()))
+      {
+        EZ_TEST_BOOL(it->IsDynamic() || uniqueObjects.Contains(it));
+      }
+    }
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "FindVisibleObjects Batch")
+  {
+    // more frusta than fit into one batch of the regular grid
+    constexpr ezUInt32 uiNumFrusta = 40;
+
+    ezDynamicArray<ezFrustum> frusta;
+    for (ezUInt32 i = 0; i < uiNumFrusta; ++i)
+    {
+      ezAngle rotation = ezAngle::Degree(i * 360.0f / uiNumFrusta);
+      ezVec3 dir(ezMath::Cos(rotation), ezMath::Sin(rotation), -0.2f);
+      ezVec3 pos(i * 50.0f - 1000.0f, (i % 3) * 300.0f, 200.0f);
+
+      frusta.ExpandAndGetRef().SetFrustum(pos, dir, ezVec3(0.0f, 0.0f, 1.0f), ezAngle::Degree(60.0f), ezAngle::Degree(40.0f), 1.0f, 500.0f + i * 100.0f);
+    }
+
+    ezDynamicArray<ezDynamicArray<const ezGameObject*>> visibleObjectsPerFrustum;
+    visibleObjectsPerFrustum.SetCount(uiNumFrusta);
+    world.GetSpatialSystem()->FindVisibleObjects(frusta, uiCategoryBitmask, visibleObjectsPerFrustum);
+
+    ezUInt32 uiTotalVisibleObjects = 0;
+    for (ezUInt32 i = 0; i < uiNumFrusta; ++i)
+    {
+      ezDynamicArray<const ezGameObject*> expectedObjects;
+      world.GetSpatialSystem()->FindVisibleObjects(frusta[i], uiCategoryBitmask, expectedObjects);
+
+      ezHashSet<const ezGameObject*> uniqueObjects;
+      for (auto pObject : visibleObjectsPerFrustum[i])
+      {
+        EZ_TEST_BOOL(!uniqueObjects.Insert(pObject));
+      }
+
+      EZ_TEST_INT(visibleObjectsPerFrustum[i].GetCount(), expectedObjects.GetCount());
+      for (auto pObject : expectedObjects)
+      {
+        EZ_TEST_BOOL(uniqueObjects.Contains(pObject));
+      }
+
+      uiTotalVisibleObjects += expectedObjects.GetCount();
+    }
+
+    EZ_TEST_BOOL(uiTotalVisibleObjects > 0);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Moving Objects")
+  {
+    // move all dynamic objects, some only a little, others to a completely different place
+    for (ezUInt32 i = 500; i < objects.GetCount(); ++i)
+    {
+      ezVec3 pos = objects[i]->GetLocalPosition();
+      if (i % 2 == 0)
+      {
+        pos += ezVec3(10.0f, -5.0f, 2.0f);
+      }
+      else
+      {
+        pos = -pos;
+      }
+
+      objects[i]->SetLocalPosition(pos);
+    }
+
+    world.Update();
+
+    ezBoundingSphere testSphere(ezVec3(-100.0f, 60.0f, -400.0f), 5000.0f);
+    const ezUInt32 uiDynamicCategoryBitmask = ezDefaultSpatialDataCategories::RenderDynamic.GetBitmask();
+
+    ezDynamicArray<ezGameObject*> objectsInSphere;
+    ezHashSet<ezGameObject*> uniqueObjects;
+    world.GetSpatialSystem()->FindObjectsInSphere(testSphere, uiDynamicCategoryBitmask, objectsInSphere);
+
+    for (auto pObject : objectsInSphere)
+    {
+      EZ_TEST_BOOL(testSphere.Overlaps(pObject->GetGlobalBounds().GetSphere()));
+      EZ_TEST_BOOL(!uniqueObjects.Insert(pObject));
+      EZ_TEST_BOOL(pObject->IsDynamic());
+    }
+
+    // Check for missing objects
+    for (auto it = world.GetObjects(); it.IsValid(); ++it)
+    {
+      if (testSphere.Overlaps(it->GetGlobalBounds().GetSphere()))
+      {
+        EZ_TEST_BOOL(it->IsStatic() || uniqueObjects.Contains(it));
+      }
+    }
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Empty Category Bitmask")
+  {
+    ezSpatialSystem* pSpatialSystem = world.GetSpatialSystem();
+    ezGameObject* pObject = objects[0];
+
+    ezSimdBBoxSphere bounds(ezSimdVec4f(0.0f, 0.0f, 50000.0f), ezSimdVec4f(1.0f), 1.8f);
+
+    const ezUInt32 uiSpecialCategoryBitmask = s_SpecialTestCategory.GetBitmask();
+    ezSpatialDataHandle hData = pSpatialSystem->CreateSpatialData(bounds, pObject, uiSpecialCategoryBitmask);
+
+    const ezBoundingSphere testSphere(ezVec3(0.0f, 0.0f, 50000.0f), 10.0f);
+    ezDynamicArray<ezGameObject*> objectsInSphere;
+
+    pSpatialSystem->FindObjectsInSphere(testSphere, uiSpecialCategoryBitmask, objectsInSphere);
+    EZ_TEST_INT(objectsInSphere.GetCount(), 1);
+
+    // clearing the bitmask removes the data from all queries, changing the bounds afterwards must be a no-op
+    pSpatialSystem->UpdateSpatialData(hData, bounds, pObject, 0);
+    bounds.Transform(ezSimdTransform(ezSimdVec4f(1.0f, 0.0f, 0.0f)));
+    pSpatialSystem->UpdateSpatialData(hData, bounds, pObject, 0);
+
+    objectsInSphere.Clear();
+    pSpatialSystem->FindObjectsInSphere(testSphere, uiSpecialCategoryBitmask, objectsInSphere);
+    EZ_TEST_BOOL(objectsInSphere.IsEmpty());
+
+    // setting a bitmask again inserts the data at its current bounds
+    pSpatialSystem->UpdateSpatialData(hData, bounds, pObject, uiSpecialCategoryBitmask);
+
+    objectsInSphere.Clear();
+    pSpatialSystem->FindObjectsInSphere(testSphere, uiSpecialCategoryBitmask, objectsInSphere);
+    EZ_TEST_INT(objectsInSphere.GetCount(), 1);
+
+    // deleting data with an empty bitmask must not touch the spatial structure
+    pSpatialSystem->UpdateSpatialData(hData, bounds, pObject, 0);
+    pSpatialSystem->DeleteSpatialData(hData);
+
+    objectsInSphere.Clear();
+    pSpatialSystem->FindObjectsInSphere(testSphere, uiSpecialCategoryBitmask, objectsInSphere);
+    EZ_TEST_BOOL(objectsInSphere.IsEmpty());
+  }
+
   if (false)
   {
     ezStringBuilder outputPath = ezTestFramework::GetInstance()->GetAbsOutputPath();
@@ -248,3 +405,13 @@ EZ_CREATE_SIMPLE_TEST(World, SpatialSystem)
 
   world.Update();
 }
+
+EZ_CREATE_SIMPLE_TEST(World, SpatialSystem)
+{
+  TestSpatialSystem(ezSpatialSystemType::RegularGrid);
+}
+
+EZ_CREATE_SIMPLE_TEST(World, SpatialSystem_BVH)
+{
+  TestSpatialSystem(ezSpatialSystemType::BoundingVolumeHierarchy);
+}
@@ -1,5 +1,6 @@
 #include <CoreTestPCH.h>
 
+#include <Core/Messages/UpdateLocalBoundsMessage.h>
 #include <Core/World/World.h>
 #include <Foundation/Time/Clock.h>
 #include <Foundation/Time/Stopwatch.h>
@@ -56,6 +57,117 @@ namespace
   EZ_END_COMPONENT_TYPE;
   // clang-format on
 
+  class ezBoundsTestComponent;
+  typedef ezComponentManager<ezBoundsTestComponent, ezBlockStorageType::Compact> ezBoundsTestComponentManager;
+
+  class ezBoundsTestComponent : public ezComponent
+  {
+    EZ_DECLARE_COMPONENT_TYPE(ezBoundsTestComponent, ezComponent, ezBoundsTestComponentManager);
+
+  public:
+    virtual void Initialize() override { GetOwner()->UpdateLocalBounds(); }
+
+    void OnUpdateLocalBounds(ezMsgUpdateLocalBounds& msg)
+    {
+      ezBoundingBox bounds;
+      bounds.SetCenterAndHalfExtents(ezVec3::ZeroVector(), ezVec3(m_fHalfExtents));
+
+      msg.AddBounds(bounds, GetOwner()->IsDynamic() ? ezDefaultSpatialDataCategories::RenderDynamic : ezDefaultSpatialDataCategories::RenderStatic);
+    }
+
+    float m_fHalfExtents = 1.0f;
+  };
+
+  // clang-format off
+  EZ_BEGIN_COMPONENT_TYPE(ezBoundsTestComponent, 1, ezComponentMode::Static)
+  {
+    EZ_BEGIN_MESSAGEHANDLERS
+    {
+      EZ_MESSAGE_HANDLER(ezMsgUpdateLocalBounds, OnUpdateLocalBounds)
+    }
+    EZ_END_MESSAGEHANDLERS;
+  }
+  EZ_END_COMPONENT_TYPE;
+  // clang-format on
+
+  struct ezMsgPostTest : public ezMessage
+  {
+    EZ_DECLARE_MESSAGE_TYPE(ezMsgPostTest, ezMessage);
+
+    ezUInt32 m_uiValue = 0;
+  };
+
+  // clang-format off
+  EZ_IMPLEMENT_MESSAGE_TYPE(ezMsgPostTest);
+  EZ_BEGIN_DYNAMIC_REFLECTED_TYPE(ezMsgPostTest, 1, ezRTTIDefaultAllocator<ezMsgPostTest>)
+  EZ_END_DYNAMIC_REFLECTED_TYPE;
+  // clang-format on
+
+  class ezPostMessageTestComponentManager;
+
+  class ezPostMessageTestComponent : public ezComponent
+  {
+    EZ_DECLARE_COMPONENT_TYPE(ezPostMessageTestComponent, ezComponent, ezPostMessageTestComponentManager);
+
+  public:
+    void OnPostTest(ezMsgPostTest& msg)
+    {
+      ++m_uiNumReceived;
+      m_uiSum += msg.m_uiValue;
+    }
+
+    ezUInt32 m_uiNumReceived = 0;
+    ezUInt64 m_uiSum = 0;
+  };
+
+  class ezPostMessageTestComponentManager : public ezComponentManager<ezPostMessageTestComponent, ezBlockStorageType::Compact>
+  {
+  public:
+    ezPostMessageTestComponentManager(ezWorld* pWorld)
+      : ezComponentManager<ezPostMessageTestComponent, ezBlockStorageType::Compact>(pWorld)
+    {
+    }
+
+    virtual void Initialize() override
+    {
+      auto desc = ezWorldModule::UpdateFunctionDesc(ezWorldModule::UpdateFunction(&ezPostMessageTestComponentManager::Update, this), "Update");
+      desc.m_bOnlyUpdateWhenSimulating = false;
+      desc.m_Phase = ezWorldModule::UpdateFunctionDesc::Phase::Async;
+      desc.m_uiGranularity = 100;
+
+      RegisterUpdateFunction(desc);
+    }
+
+    void Update(const ezWorldModule::UpdateContext& context)
+    {
+      ezMsgPostTest msg;
+
+      for (auto it = this->m_ComponentStorage.GetIterator(context.m_uiFirstComponentIndex, context.m_uiComponentCount); it.IsValid(); ++it)
+      {
+        ComponentType* pComponent = it;
+        for (ezUInt32 i = 0; i < m_uiMessagesPerComponent; ++i)
+        {
+          msg.m_uiValue = i;
+          GetWorld()->PostMessage(pComponent->GetHandle(), msg, ezObjectMsgQueueType::PostAsync);
+        }
+      }
+    }
+
+    ezUInt32 m_uiMessagesPerComponent = 0;
+  };
+
+  // clang-format off
+  EZ_BEGIN_COMPONENT_TYPE(ezPostMessageTestComponent, 1, ezComponentMode::Static)
+  {
+    EZ_BEGIN_MESSAGEHANDLERS
+    {
+      EZ_MESSAGE_HANDLER(ezMsgPostTest, OnPostTest)
+    }
+    EZ_END_MESSAGEHANDLERS;
+  }
+  EZ_END_COMPONENT_TYPE;
+  // clang-format on
+
   void AddObjectsToWorld(ezWorld& world, bool bDynamic, ezUInt32 uiNumObjects, ezUInt32 uiTreeLevelNumNodeDiv, ezUInt32 uiTreeDepth, ezInt32 iAttachCompsDepth,
                        ezGameObjectHandle hParent = ezGameObjectHandle())
   {
@@ -114,6 +226,180 @@ namespace
     }
   }
 
+  void MeasureSpatialSystem(ezSpatialSystemType::Enum spatialSystemType, const char* szName, ezUInt32 uiNumObjects)
+  {
+    ezWorldDesc worldDesc("Test");
+    worldDesc.m_uiRandomNumberGeneratorSeed = 42;
+    worldDesc.m_AutoCreatedSpatialSystemType = spatialSystemType;
+    ezWorld world(worldDesc);
+
+    EZ_LOCK(world.GetWriteMarker());
+
+    auto& rng = world.GetRandomNumberGenerator();
+
+    ezDynamicArray<ezGameObject*> dynamicObjects;
+
+    // very uneven density: most objects are clustered in a few small towns, the rest is spread across a huge landscape
+    const ezVec3 townCenters[] = {ezVec3(0.0f), ezVec3(3000.0f, 500.0f, 0.0f), ezVec3(-8000.0f, 12000.0f, 20.0f)};
+
+    for (ezUInt32 i = 0; i < uiNumObjects; ++i)
+    {
+      ezGameObjectDesc gd;
+      gd.m_bDynamic = (i % 10) == 0;
+
+      if (i % 4 == 0)
+      {
+        gd.m_LocalPosition.Set((float)rng.DoubleMinMax(-20000.0, 20000.0), (float)rng.DoubleMinMax(-20000.0, 20000.0), (float)rng.DoubleMinMax(-100.0, 500.0));
+      }
+      else
+      {
+        gd.m_LocalPosition = townCenters[i % EZ_ARRAY_SIZE(townCenters)] + ezVec3((float)rng.DoubleMinMax(-300.0, 300.0), (float)rng.DoubleMinMax(-300.0, 300.0), (float)rng.DoubleMinMax(0.0, 50.0));
+      }
+
+      ezGameObject* pObject = nullptr;
+      world.CreateObject(gd, pObject);
+
+      ezBoundsTestComponent* pComponent = nullptr;
+      ezBoundsTestComponent::CreateComponent(pObject, pComponent);
+      pComponent->m_fHalfExtents = (float)rng.DoubleMinMax(0.5, 10.0);
+
+      if (gd.m_bDynamic)
+      {
+        dynamicObjects.PushBack(pObject);
+      }
+    }
+
+    const ezSpatialSystem& spatialSystem = *world.GetSpatialSystem();
+    const ezUInt32 uiAllCategories = ezDefaultSpatialDataCategories::RenderStatic.GetBitmask() | ezDefaultSpatialDataCategories::RenderDynamic.GetBitmask();
+
+    ezStopwatch sw;
+
+    world.Update();
+
+    ezTestFramework::Output(ezTestOutput::Duration, "%s: Creating %u objects: %.2fms", szName, uiNumObjects, sw.Checkpoint().GetMilliseconds());
+
+    {
+      const ezUInt32 uiNumQueries = 100;
+      ezUInt32 uiNumVisible = 0;
+
+      ezDynamicArray<const ezGameObject*> visibleObjects;
+
+      sw.Checkpoint();
+
+      for (ezUInt32 i = 0; i < uiNumQueries; ++i)
+      {
+        const ezVec3 vPosition = townCenters[i % EZ_ARRAY_SIZE(townCenters)] + ezVec3(-500.0f, 0.0f, 100.0f);
+        const ezAngle rotation = ezAngle::Degree(i * 360.0f / uiNumQueries);
+        const ezVec3 vForwards(ezMath::Cos(rotation), ezMath::Sin(rotation), -0.1f);
+
+        ezFrustum frustum;
+        frustum.SetFrustum(vPosition, vForwards, ezVec3(0, 0, 1), ezAngle::Degree(90.0f), ezAngle::Degree(60.0f), 0.1f, 5000.0f);
+
+        visibleObjects.Clear();
+        spatialSystem.FindVisibleObjects(frustum, uiAllCategories, visibleObjects);
+        uiNumVisible += visibleObjects.GetCount();
+      }
+
+      ezTestFramework::Output(ezTestOutput::Duration, "%s: %u frustum queries (%u visible): %.2fms", szName, uiNumQueries, uiNumVisible, sw.Checkpoint().GetMilliseconds());
+    }
+
+    {
+      // shadow views of a frame: cube map faces of several point lights plus cascades along the main view
+      ezDynamicArray<ezFrustum> frusta;
+      for (ezUInt32 uiLight = 0; uiLight < 3; ++uiLight)
+      {
+        const ezVec3 vLightPos = townCenters[uiLight] + ezVec3(50.0f, -20.0f, 30.0f);
+        const ezVec3 faceDirs[] = {ezVec3(1, 0, 0), ezVec3(-1, 0, 0), ezVec3(0, 1, 0), ezVec3(0, -1, 0), ezVec3(0, 0, 1), ezVec3(0, 0, -1)};
+
+        for (const ezVec3& vDir : faceDirs)
+        {
+          const ezVec3 vUp = ezMath::Abs(vDir.z) > 0.5f ? ezVec3(1, 0, 0) : ezVec3(0, 0, 1);
+          frusta.ExpandAndGetRef().SetFrustum(vLightPos, vDir, vUp, ezAngle::Degree(90.0f), ezAngle::Degree(90.0f), 0.1f, 400.0f);
+        }
+      }
+
+      for (ezUInt32 uiCascade = 0; uiCascade < 4; ++uiCascade)
+      {
+        const float fFar = 250.0f * (1 << (uiCascade * 2));
+        frusta.ExpandAndGetRef().SetFrustum(ezVec3(-500.0f, 0.0f, 100.0f), ezVec3(1.0f, 0.2f, -0.1f), ezVec3(0, 0, 1), ezAngle::Degree(90.0f), ezAngle::Degree(60.0f), 0.1f, fFar);
+      }
+
+      const ezUInt32 uiNumFrames = 10;
+      ezUInt32 uiNumVisibleSingle = 0;
+      ezUInt32 uiNumVisibleBatch = 0;
+
+      ezDynamicArray<const ezGameObject*> visibleObjects;
+      ezDynamicArray<ezDynamicArray<const ezGameObject*>> visibleObjectsPerFrustum;
+      visibleObjectsPerFrustum.SetCount(frusta.GetCount());
+
+      sw.Checkpoint();
+
+      for (ezUInt32 frame = 0; frame < uiNumFrames; ++frame)
+      {
+        for (const ezFrustum& frustum : frusta)
+        {
+          visibleObjects.Clear();
+          spatialSystem.FindVisibleObjects(frustum, uiAllCategories, visibleObjects);
+          uiNumVisibleSingle += visibleObjects.GetCount();
+        }
+      }
+
+      ezTestFramework::Output(ezTestOutput::Duration, "%s: %u frames with %u single frustum queries (%u visible): %.2fms", szName, uiNumFrames, frusta.GetCount(), uiNumVisibleSingle, sw.Checkpoint().GetMilliseconds());
+
+      for (ezUInt32 frame = 0; frame < uiNumFrames; ++frame)
+      {
+        for (auto& objects : visibleObjectsPerFrustum)
+        {
+          objects.Clear();
+        }
+
+        spatialSystem.FindVisibleObjects(frusta, uiAllCategories, visibleObjectsPerFrustum);
+
+        for (auto& objects : visibleObjectsPerFrustum)
+        {
+          uiNumVisibleBatch += objects.GetCount();
+        }
+      }
+
+      ezTestFramework::Output(ezTestOutput::Duration, "%s: %u frames with %u batched frustum queries (%u visible): %.2fms", szName, uiNumFrames, frusta.GetCount(), uiNumVisibleBatch, sw.Checkpoint().GetMilliseconds());
+
+      EZ_TEST_INT(uiNumVisibleSingle, uiNumVisibleBatch);
+    }
+
+    {
+      const ezUInt32 uiNumQueries = 10000;
+      ezUInt32 uiNumFound = 0;
+
+      for (ezUInt32 i = 0; i < uiNumQueries; ++i)
+      {
+        const ezVec3 vCenter = dynamicObjects[i % dynamicObjects.GetCount()]->GetGlobalPosition();
+
+        spatialSystem.FindObjectsInSphere(ezBoundingSphere(vCenter, 20.0f), uiAllCategories, [&](ezGameObject*) {
+          ++uiNumFound;
+          return ezVisitorExecution::Continue;
+        });
+      }
+
+      ezTestFramework::Output(ezTestOutput::Duration, "%s: %u sphere queries (%u found): %.2fms", szName, uiNumQueries, uiNumFound, sw.Checkpoint().GetMilliseconds());
+    }
+
+    {
+      const ezUInt32 uiNumFrames = 5;
+
+      for (ezUInt32 frame = 0; frame < uiNumFrames; ++frame)
+      {
+        for (ezGameObject* pObject : dynamicObjects)
+        {
+          pObject->SetLocalPosition(pObject->GetLocalPosition() + ezVec3(2.0f, 1.0f, 0.0f));
+        }
+
+        world.Update();
+      }
+
+      ezTestFramework::Output(ezTestOutput::Duration, "%s: Moving %u objects for %u frames: %.2fms", szName, dynamicObjects.GetCount(), uiNumFrames, sw.Checkpoint().GetMilliseconds());
+    }
+  }
+
 } // namespace
 
 
@@ -288,3 +574,67 @@ EZ_CREATE_SIMPLE_TEST(World, Profile_Update)
     }
   }
 }
+
+EZ_CREATE_SIMPLE_TEST(World, Profile_SpatialSystem)
+{
+  EZ_TEST_BLOCK(EnableInRelease, "Regular Grid")
+  {
+    MeasureSpatialSystem(ezSpatialSystemType::RegularGrid, "Regular Grid", 200000);
+  }
+
+  EZ_TEST_BLOCK(EnableInRelease, "Bounding Volume Hierarchy")
+  {
+    MeasureSpatialSystem(ezSpatialSystemType::BoundingVolumeHierarchy, "BVH", 200000);
+  }
+}
+
+EZ_CREATE_SIMPLE_TEST(World, Profile_PostMessage)
+{
+  EZ_TEST_BLOCK(EnableInRelease, "Post 1,000,000 messages from async updates")
+  {
+    const ezUInt32 uiNumComponents = 10000;
+    const ezUInt32 uiMessagesPerComponent = 100;
+
+    ezWorldDesc worldDesc("Test");
+    worldDesc.m_bAutoCreateSpatialSystem = false; // allows multi-threaded update
+    ezWorld world(worldDesc);
+
+    EZ_LOCK(world.GetWriteMarker());
+
+    ezPostMessageTestComponentManager* pManager = world.GetOrCreateComponentManager<ezPostMessageTestComponentManager>();
+    pManager->m_uiMessagesPerComponent = uiMessagesPerComponent;
+
+    for (ezUInt32 i = 0; i < uiNumComponents; ++i)
+    {
+      ezGameObjectDesc gd;
+      ezGameObject* pObject = nullptr;
+      world.CreateObject(gd, pObject);
+
+      ezPostMessageTestComponent* pComponent = nullptr;
+      pManager->CreateComponent(pObject, pComponent);
+    }
+
+    ezStopwatch sw;
+
+    // first round always has some overhead
+    for (ezUInt32 i = 0; i < 3; ++i)
+    {
+      world.Update();
+
+      const ezTime tDiff = sw.Checkpoint();
+
+      ezTestFramework::Output(ezTestOutput::Duration, "Posting and processing %u messages (MT): %.2fms", uiNumComponents * uiMessagesPerComponent, tDiff.GetMilliseconds());
+    }
+
+    ezUInt32 uiNumReceived = 0;
+    ezUInt64 uiSum = 0;
+    for (auto it = pManager->GetComponents(); it.IsValid(); ++it)
+    {
+      uiNumReceived += it->m_uiNumReceived;
+      uiSum += it->m_uiSum;
+    }
+
+    EZ_TEST_INT(uiNumReceived, 3 * uiNumComponents * uiMessagesPerComponent);
+    EZ_TEST_BOOL(uiSum == 3ull * uiNumComponents * (uiMessagesPerComponent * (uiMessagesPerComponent - 1) / 2));
+  }
+}
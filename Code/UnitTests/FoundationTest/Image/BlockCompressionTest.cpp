@@ -0,0 +1,127 @@
+#include <FoundationTestPCH.h>
+
+#include <Foundation/IO/FileSystem/FileSystem.h>
+#include <Foundation/Time/Stopwatch.h>
+#include <Texture/Image/Conversions/DXTConversions.h>
+#include <Texture/Image/Image.h>
+#include <Texture/Image/ImageConversion.h>
+
+namespace BlockCompressionTestDetail
+{
+  /// Peak signal-to-noise ratio of the RGB (and optionally alpha) channels of two RGBA8 images of the same size.
+  static double ComputePSNR(const ezImage& imageA, const ezImage& imageB, bool bIncludeAlpha)
+  {
+    const ezUInt32 uiNumChannels = bIncludeAlpha ? 4 : 3;
+    double fSquaredError = 0.0;
+
+    for (ezUInt32 y = 0; y < imageA.GetHeight(); ++y)
+    {
+      const ezColorBaseUB* pPixelA = imageA.GetPixelPointer<ezColorBaseUB>(0, 0, 0, 0, y);
+      const ezColorBaseUB* pPixelB = imageB.GetPixelPointer<ezColorBaseUB>(0, 0, 0, 0, y);
+
+      for (ezUInt32 x = 0; x < imageA.GetWidth(); ++x)
+      {
+        for (ezUInt32 ch = 0; ch < uiNumChannels; ++ch)
+        {
+          const double fDiff = double(pPixelA[x].GetData()[ch]) - double(pPixelB[x].GetData()[ch]);
+          fSquaredError += fDiff * fDiff;
+        }
+      }
+    }
+
+    const double fMeanSquaredError = fSquaredError / (double(imageA.GetWidth()) * imageA.GetHeight() * uiNumChannels);
+    if (fMeanSquaredError == 0.0)
+      return 100.0;
+
+    return 10.0 * ezMath::Log10(static_cast<float>(255.0 * 255.0 / fMeanSquaredError));
+  }
+} // namespace BlockCompressionTestDetail
+
+EZ_CREATE_SIMPLE_TEST(Image, BlockCompression)
+{
+  using namespace BlockCompressionTestDetail;
+
+  const ezStringBuilder sReadDir(">sdk/", ezTestFramework::GetInstance()->GetRelTestDataPath());
+
+  if (EZ_TEST_BOOL(ezFileSystem::AddDataDirectory(sReadDir, "BlockCompressionTest").Succeeded()).Failed())
+    return;
+
+  ezImage source;
+  EZ_TEST_BOOL(source.LoadFrom("ImageConversions/reference.png").Succeeded());
+  EZ_TEST_BOOL(source.Convert(ezImageFormat::R8G8B8A8_UNORM).Succeeded());
+
+  // BC1 turns everything that is not fully opaque into transparent black, so it is tested on an opaque version of the image
+  ezImage opaqueSource;
+  opaqueSource.ResetAndCopy(source);
+
+  for (ezUInt32 y = 0; y < opaqueSource.GetHeight(); ++y)
+  {
+    ezColorBaseUB* pPixel = opaqueSource.GetPixelPointer<ezColorBaseUB>(0, 0, 0, 0, y);
+
+    for (ezUInt32 x = 0; x < opaqueSource.GetWidth(); ++x)
+    {
+      pPixel[x].a = 255;
+    }
+  }
+
+  ezImage hdrSource;
+  hdrSource.ResetAndCopy(opaqueSource);
+  EZ_TEST_BOOL(hdrSource.Convert(ezImageFormat::R16G16B16A16_FLOAT).Succeeded());
+
+  const char* szQualityNames[] = {"Fast", "Normal", "High"};
+
+  // Note that on Windows BC1, BC6H and BC7 are encoded with DirectXTex, which does not use the quality setting.
+
+  auto TestFormat = [&](const ezImage& sourceImage, const ezImage& referenceImage, ezImageFormat::Enum format, bool bIncludeAlpha,
+                      const double* pMinPSNR) {
+    for (ezUInt32 uiQuality = ezBlockCompressionQuality::Fast; uiQuality <= ezBlockCompressionQuality::High; ++uiQuality)
+    {
+      ezSetBlockCompressionQuality(static_cast<ezBlockCompressionQuality::Enum>(uiQuality));
+
+      ezImage compressed;
+      ezStopwatch sw;
+      EZ_TEST_BOOL(ezImageConversion::Convert(sourceImage, compressed, format).Succeeded());
+      const ezTime tCompression = sw.GetRunningTotal();
+
+      ezImage decompressed;
+      EZ_TEST_BOOL(ezImageConversion::Convert(compressed, decompressed, ezImageFormat::R8G8B8A8_UNORM).Succeeded());
+
+      const double fPSNR = ComputePSNR(referenceImage, decompressed, bIncludeAlpha);
+      const double fMegaPixelsPerSecond = (double(sourceImage.GetWidth()) * sourceImage.GetHeight() / 1000000.0) / tCompression.GetSeconds();
+
+      ezTestFramework::Output(ezTestOutput::Duration, "%s (%s): %.2f MPixel/s, PSNR %.2f dB", ezImageFormat::GetName(format),
+        szQualityNames[uiQuality], fMegaPixelsPerSecond, fPSNR);
+
+      EZ_TEST_BOOL_MSG(fPSNR >= pMinPSNR[uiQuality], "%s (%s): PSNR of %.2f dB is below %.2f dB", ezImageFormat::GetName(format),
+        szQualityNames[uiQuality], fPSNR, pMinPSNR[uiQuality]);
+    }
+  };
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "BC1")
+  {
+    const double fMinPSNR[] = {27.0, 27.5, 27.5};
+    TestFormat(opaqueSource, opaqueSource, ezImageFormat::BC1_UNORM, false, fMinPSNR);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "BC3")
+  {
+    const double fMinPSNR[] = {28.5, 29.0, 29.0};
+    TestFormat(source, source, ezImageFormat::BC3_UNORM, true, fMinPSNR);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "BC6H")
+  {
+    const double fMinPSNR[] = {22.0, 32.5, 32.5};
+    TestFormat(hdrSource, opaqueSource, ezImageFormat::BC6H_UF16, false, fMinPSNR);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "BC7")
+  {
+    const double fMinPSNR[] = {29.5, 38.0, 38.0};
+    TestFormat(source, source, ezImageFormat::BC7_UNORM, true, fMinPSNR);
+  }
+
+  ezSetBlockCompressionQuality(ezBlockCompressionQuality::Default);
+
+  ezFileSystem::RemoveDataDirectoryGroup("BlockCompressionTest");
+}
@@ -3,6 +3,9 @@
 #include <Foundation/IO/FileSystem/DataDirTypeFolder.h>
 #include <Foundation/IO/FileSystem/FileReader.h>
 #include <Foundation/IO/FileSystem/FileSystem.h>
+#include <Foundation/Math/Random.h>
+#include <Foundation/Time/Stopwatch.h>
+#include <Texture/Image/ImageFilter.h>
 #include <Texture/Image/ImageUtils.h>
 
 
@@ -116,5 +119,70 @@ EZ_CREATE_SIMPLE_TEST(Image, ImageUtils)
     EZ_TEST_INT(uiError, 1433);
   }
 
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Scale and GenerateMipMaps Determinism")
+  {
+    // Several slices are processed in parallel per slice, a single slice is processed in parallel per row.
+    // Both must produce exactly the same data.
+    const ezUInt32 uiNumSlices = 6;
+
+    ezImageHeader header;
+    header.SetImageFormat(ezImageFormat::R32G32B32A32_FLOAT);
+    header.SetWidth(256);
+    header.SetHeight(192);
+    header.SetNumArrayIndices(uiNumSlices);
+
+    ezImage source;
+    source.ResetAndAlloc(header);
+
+    ezRandom rng;
+    rng.Initialize(42);
+
+    for (float& value : source.GetBlobPtr<float>())
+    {
+      value = rng.FloatZeroToOneInclusive();
+    }
+
+    ezImageFilterSincWithKaiserWindow kaiserFilter;
+    const ezImageFilter* filters[] = {nullptr, &kaiserFilter};
+
+    for (const ezImageFilter* pFilter : filters)
+    {
+      ezImageUtils::MipMapOptions options;
+      options.m_filter = pFilter;
+      options.m_addressModeU = ezImageAddressMode::Repeat;
+      options.m_preserveCoverage = true;
+
+      ezImage mipMaps;
+      ezStopwatch sw;
+      ezImageUtils::GenerateMipMaps(source, mipMaps, options);
+      ezTestFramework::Output(ezTestOutput::Duration, "GenerateMipMaps (%s, %u slices): %.2fms", pFilter ? "Kaiser" : "Triangle", uiNumSlices,
+        sw.GetRunningTotal().GetMilliseconds());
+
+      ezImage scaled;
+      EZ_TEST_BOOL(ezImageUtils::Scale(source, scaled, 100, 77, pFilter, ezImageAddressMode::Mirror).Succeeded());
+
+      for (ezUInt32 uiSlice = 0; uiSlice < uiNumSlices; ++uiSlice)
+      {
+        ezImage sliceMipMaps;
+        ezImageUtils::GenerateMipMaps(source.GetSubImageView(0, 0, uiSlice), sliceMipMaps, options);
+
+        for (ezUInt32 uiMip = 0; uiMip < mipMaps.GetNumMipLevels(); ++uiMip)
+        {
+          ezImageView expected = sliceMipMaps.GetSubImageView(uiMip);
+          ezImageView actual = mipMaps.GetSubImageView(uiMip, 0, uiSlice);
+
+          EZ_TEST_BOOL(memcmp(expected.GetByteBlobPtr().GetPtr(), actual.GetByteBlobPtr().GetPtr(), expected.GetByteBlobPtr().GetCount()) == 0);
+        }
+
+        ezImage sliceScaled;
+        EZ_TEST_BOOL(ezImageUtils::Scale(source.GetSubImageView(0, 0, uiSlice), sliceScaled, 100, 77, pFilter, ezImageAddressMode::Mirror).Succeeded());
+
+        ezImageView expected = sliceScaled.GetSubImageView();
+        ezImageView actual = scaled.GetSubImageView(0, 0, uiSlice);
+        EZ_TEST_BOOL(memcmp(expected.GetByteBlobPtr().GetPtr(), actual.GetByteBlobPtr().GetPtr(), expected.GetByteBlobPtr().GetCount()) == 0);
+      }
+    }
+  }
+
   ezFileSystem::RemoveDataDirectoryGroup("ImageTest");
 }
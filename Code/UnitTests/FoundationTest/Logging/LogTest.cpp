@@ -254,3 +254,122 @@ EZ_CREATE_SIMPLE_TEST(Logging, GlobalTestLog)
     }
   }
 }
+
+EZ_CREATE_SIMPLE_TEST(Logging, AsyncLog)
+{
+  ezLog::GetThreadLocalLogSystem()->SetLogLevel(ezLogMsgType::All);
+
+  struct LoggedMessage
+  {
+    ezLogMsgType::Enum m_Type;
+    ezUInt8 m_uiIndentation;
+    ezString m_sText;
+  };
+
+  ezMutex messagesMutex;
+  ezDynamicArray<LoggedMessage> messages;
+
+  auto writer = [&](const ezLoggingEventData& le) {
+    if (le.m_EventType == ezLogMsgType::Flush || !ezStringUtils::StartsWith(le.m_szText, "Async"))
+      return;
+
+    EZ_LOCK(messagesMutex);
+    messages.PushBack({le.m_EventType, le.m_uiIndentation, le.m_szText});
+  };
+
+  const ezEventSubscriptionID writerID = ezGlobalLog::AddLogWriter(writer);
+
+  class AsyncLogThread : public ezThread
+  {
+  public:
+    ezUInt32 m_uiIndex = 0;
+
+    virtual ezUInt32 Run() override
+    {
+      // more than fits into one queue
+      for (ezUInt32 i = 0; i < 1000; ++i)
+      {
+        ezStringBuilder sBlockName;
+        sBlockName.Format("Async block {} {}", m_uiIndex, i);
+
+        EZ_LOG_BLOCK(sBlockName);
+        ezLog::Warning("Async message {} {}", m_uiIndex, i);
+      }
+
+      return 0;
+    }
+  };
+
+  const ezUInt32 uiNumWarnings = ezGlobalLog::GetMessageCount(ezLogMsgType::WarningMsg);
+
+  ezGlobalLog::SetAsyncMode(true);
+  EZ_TEST_BOOL(ezGlobalLog::IsAsyncMode());
+
+  {
+    AsyncLogThread threads[4];
+
+    for (ezUInt32 t = 0; t < EZ_ARRAY_SIZE(threads); ++t)
+    {
+      threads[t].m_uiIndex = t;
+      threads[t].Start();
+    }
+
+    for (ezUInt32 t = 0; t < EZ_ARRAY_SIZE(threads); ++t)
+    {
+      threads[t].Join();
+    }
+  }
+
+  // counted right away, not when the messages are dispatched
+  EZ_TEST_INT(ezGlobalLog::GetMessageCount(ezLogMsgType::WarningMsg) - uiNumWarnings, 4 * 1000);
+
+  ezGlobalLog::SetAsyncMode(false);
+  EZ_TEST_BOOL(!ezGlobalLog::IsAsyncMode());
+
+  // nobody is dispatching anymore, so the crash handler flush does not back off
+  EZ_TEST_BOOL(ezGlobalLog::TryFlushAsyncMessages());
+
+  ezGlobalLog::RemoveLogWriter(writerID);
+
+  // every block header was written, because every block contains a message
+  EZ_TEST_INT(messages.GetCount(), 4 * 1000 * 3);
+
+  // the messages of different threads are interleaved, but for each thread the order and the block nesting are kept
+  ezUInt32 uiNextMessage[4] = {};
+  ezStringBuilder sExpected;
+  for (const LoggedMessage& msg : messages)
+  {
+    const bool bBlock = msg.m_Type != ezLogMsgType::WarningMsg;
+    const ezUInt32 uiThread = msg.m_sText.GetData()[bBlock ? 12 : 14] - '0';
+    if (!EZ_TEST_BOOL(uiThread < 4).Succeeded())
+      break;
+
+    const ezUInt32 uiStep = uiNextMessage[uiThread]++;
+    const ezUInt32 uiIndex = uiStep / 3;
+    switch (uiStep % 3)
+    {
+      case 0:
+        EZ_TEST_INT(msg.m_Type, ezLogMsgType::BeginGroup);
+        EZ_TEST_INT(msg.m_uiIndentation, 0);
+        sExpected.Format("Async block {} {}", uiThread, uiIndex);
+        break;
+      case 1:
+        EZ_TEST_INT(msg.m_Type, ezLogMsgType::WarningMsg);
+        EZ_TEST_INT(msg.m_uiIndentation, 1);
+        sExpected.Format("Async message {} {}", uiThread, uiIndex);
+        break;
+      case 2:
+        EZ_TEST_INT(msg.m_Type, ezLogMsgType::EndGroup);
+        EZ_TEST_INT(msg.m_uiIndentation, 0);
+        sExpected.Format("Async block {} {}", uiThread, uiIndex);
+        break;
+    }
+
+    EZ_TEST_STRING(msg.m_sText, sExpected);
+  }
+
+  for (ezUInt32 t = 0; t < 4; ++t)
+  {
+    EZ_TEST_INT(uiNextMessage[t], 1000 * 3);
+  }
+}
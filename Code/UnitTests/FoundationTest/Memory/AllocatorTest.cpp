@@ -1,8 +1,12 @@
 #include <FoundationTestPCH.h>
 
 #include <Foundation/Memory/CommonAllocators.h>
+#include <Foundation/Memory/FrameAllocator.h>
 #include <Foundation/Memory/LargeBlockAllocator.h>
+#include <Foundation/Memory/MemoryTracker.h>
 #include <Foundation/Memory/StackAllocator.h>
+#include <Foundation/Threading/TaskSystem.h>
+#include <Foundation/Threading/Thread.h>
 
 struct EZ_ALIGN(NonAlignedVector, EZ_ALIGNMENT_MINIMUM)
 {
@@ -75,6 +79,74 @@ void TestAlignmentHelper(size_t uiExpectedAlignment)
   EZ_TEST_BOOL(stats.m_uiNumAllocations - stats.m_uiNumDeallocations == 0);
 }
 
+namespace
+{
+  class SmallObjectFreeThread : public ezThread
+  {
+  public:
+    SmallObjectFreeThread(ezAllocatorBase* pAllocator, ezArrayPtr<void*> allocations)
+      : ezThread("Test Thread")
+      , m_pAllocator(pAllocator)
+      , m_Allocations(allocations)
+    {
+    }
+
+    ezAllocatorBase* m_pAllocator;
+    ezArrayPtr<void*> m_Allocations;
+    ezDynamicArray<void*> m_OwnAllocations;
+
+    virtual ezUInt32 Run()
+    {
+      // free the blocks of the other thread and keep some of our own alive, so that their slabs are orphaned on exit
+      for (void*& ptr : m_Allocations)
+      {
+        m_pAllocator->Deallocate(ptr);
+        ptr = nullptr;
+
+        m_OwnAllocations.PushBack(m_pAllocator->Allocate(48, 16));
+      }
+
+      return 0;
+    }
+  };
+
+  class AllocThread : public ezThread
+  {
+  public:
+    AllocThread(ezAllocatorBase* pAllocator, ezUInt32 uiNumAllocations, bool bFreeAllocations)
+      : ezThread("Test Thread")
+      , m_pAllocator(pAllocator)
+      , m_uiNumAllocations(uiNumAllocations)
+      , m_bFreeAllocations(bFreeAllocations)
+    {
+    }
+
+    ezAllocatorBase* m_pAllocator;
+    ezUInt32 m_uiNumAllocations;
+    bool m_bFreeAllocations;
+    ezDynamicArray<void*> m_Allocations;
+
+    virtual ezUInt32 Run()
+    {
+      for (ezUInt32 i = 0; i < m_uiNumAllocations; ++i)
+      {
+        m_Allocations.PushBack(m_pAllocator->Allocate(48, 16));
+      }
+
+      if (m_bFreeAllocations)
+      {
+        for (void* ptr : m_Allocations)
+        {
+          m_pAllocator->Deallocate(ptr);
+        }
+        m_Allocations.Clear();
+      }
+
+      return 0;
+    }
+  };
+} // namespace
+
 EZ_CREATE_SIMPLE_TEST_GROUP(Memory);
 
 EZ_CREATE_SIMPLE_TEST(Memory, Allocator)
@@ -235,4 +307,328 @@ EZ_CREATE_SIMPLE_TEST(Memory, Allocator)
 
     EZ_TEST_BOOL(ezConstructionCounter::HasDestructed(50));
   }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "FrameAllocator")
+  {
+    ezFrameAllocator::Reset();
+
+    ezAllocatorBase* pAllocator = ezFrameAllocator::GetCurrentAllocator();
+    EZ_TEST_BOOL(pAllocator == ezFrameAllocator::GetCurrentAllocator());
+
+    for (ezUInt32 i = 0; i < 10; ++i)
+    {
+      AlignedVector* pVector = EZ_NEW(pAllocator, AlignedVector);
+      EZ_TEST_BOOL(ezMemoryUtils::IsAligned(pVector, 16));
+      EZ_TEST_INT(pAllocator->AllocatedSize(pVector), sizeof(AlignedVector));
+    }
+
+    // allocations with destructors are destroyed once their buffer is reset, unless they are deleted before
+    ezDynamicArray<ezConstructionCounter*> counters;
+    for (ezUInt32 i = 0; i < 10; ++i)
+    {
+      counters.PushBack(EZ_NEW(pAllocator, ezConstructionCounter));
+    }
+    EZ_TEST_BOOL(ezConstructionCounter::HasConstructed(10));
+
+    EZ_DELETE(pAllocator, counters[0]);
+    EZ_TEST_BOOL(ezConstructionCounter::HasDestructed(1));
+
+    // large allocations
+    ezArrayPtr<ezUInt8> largeBlock = EZ_NEW_ARRAY(pAllocator, ezUInt8, 100000);
+    ezMemoryUtils::ZeroFill(largeBlock.GetPtr(), largeBlock.GetCount());
+    EZ_TEST_INT(pAllocator->AllocatedSize(largeBlock.GetPtr()), 100000);
+
+    // alignments above the one of the chunks
+    for (ezUInt32 uiAlign = 32; uiAlign <= 256; uiAlign *= 2)
+    {
+      void* pMemory = pAllocator->Allocate(40, uiAlign);
+      EZ_TEST_BOOL(ezMemoryUtils::IsAligned(pMemory, uiAlign));
+      EZ_TEST_INT(pAllocator->AllocatedSize(pMemory), 40);
+      pAllocator->Deallocate(pMemory);
+    }
+
+    // growing containers
+    {
+      ezDynamicArray<ezUInt32> numbers(pAllocator);
+      for (ezUInt32 i = 0; i < 10000; ++i)
+      {
+        numbers.PushBack(i);
+      }
+
+      bool bAllCorrect = true;
+      for (ezUInt32 i = 0; i < 10000; ++i)
+      {
+        bAllCorrect &= (numbers[i] == i);
+      }
+      EZ_TEST_BOOL(bAllCorrect);
+    }
+
+    // the memory of the previous frame stays valid after one swap
+    ezFrameAllocator::Swap();
+    EZ_TEST_BOOL(ezConstructionCounter::HasDestructed(0));
+    EZ_TEST_BOOL(ezFrameAllocator::GetCurrentAllocator() != pAllocator);
+
+    ezFrameAllocator::Swap();
+    EZ_TEST_BOOL(ezConstructionCounter::HasDestructed(9));
+    EZ_TEST_BOOL(ezFrameAllocator::GetCurrentAllocator() == pAllocator);
+    EZ_TEST_INT(static_cast<ezFrameAllocatorArena*>(pAllocator)->GetUsedMemory(), 0);
+    EZ_TEST_BOOL(static_cast<ezFrameAllocatorArena*>(pAllocator)->GetPeakMemory() >= 100000);
+
+    // allocations from several threads at once
+    const ezUInt32 uiNumAllocations = 10000;
+    ezDynamicArray<ezUInt32*> allocations;
+    allocations.SetCount(uiNumAllocations);
+
+    ezTaskSystem::ParallelForIndexed(0, uiNumAllocations, [&allocations](ezUInt32 uiStartIndex, ezUInt32 uiEndIndex) {
+      ezAllocatorBase* pThreadAllocator = ezFrameAllocator::GetCurrentAllocator();
+
+      for (ezUInt32 i = uiStartIndex; i < uiEndIndex; ++i)
+      {
+        const ezUInt32 uiCount = 1 + (i % 64);
+        allocations[i] = EZ_NEW_RAW_BUFFER(pThreadAllocator, ezUInt32, uiCount);
+
+        for (ezUInt32 j = 0; j < uiCount; ++j)
+        {
+          allocations[i][j] = i;
+        }
+      }
+    });
+
+    bool bNoOverlap = true;
+    for (ezUInt32 i = 0; i < uiNumAllocations; ++i)
+    {
+      const ezUInt32 uiCount = 1 + (i % 64);
+      for (ezUInt32 j = 0; j < uiCount; ++j)
+      {
+        bNoOverlap &= (allocations[i][j] == i);
+      }
+    }
+    EZ_TEST_BOOL(bNoOverlap);
+
+    ezDynamicArray<ezFrameAllocator::ThreadStats> threadStats;
+    ezFrameAllocator::GetThreadStats(threadStats);
+    EZ_TEST_BOOL(!threadStats.IsEmpty());
+
+    // the arenas of an exited thread are deleted once both buffers have been swapped
+    {
+      const ezUInt32 uiNumThreads = threadStats.GetCount();
+
+      AllocThread thread(pAllocator, 10, false);
+      thread.Start();
+      thread.Join();
+
+      ezFrameAllocator::GetThreadStats(threadStats);
+      EZ_TEST_INT(threadStats.GetCount(), uiNumThreads + 1);
+
+      ezFrameAllocator::Swap();
+      ezFrameAllocator::GetThreadStats(threadStats);
+      EZ_TEST_INT(threadStats.GetCount(), uiNumThreads + 1);
+
+      ezFrameAllocator::Swap();
+      ezFrameAllocator::GetThreadStats(threadStats);
+      EZ_TEST_INT(threadStats.GetCount(), uiNumThreads);
+    }
+
+    ezFrameAllocator::Reset();
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "SmallObjectAllocator")
+  {
+    ezSmallObjectAllocator allocator("SmallObjectAllocator");
+
+    // sizes across all size classes and the large allocation path
+    ezDynamicArray<ezUInt8*> allocations;
+    for (ezUInt32 uiSize = 1; uiSize <= 2048; uiSize += 7)
+    {
+      ezUInt8* ptr = static_cast<ezUInt8*>(allocator.Allocate(uiSize, 16));
+      EZ_TEST_BOOL(ezMemoryUtils::IsAligned(ptr, 16));
+      EZ_TEST_INT(allocator.AllocatedSize(ptr), uiSize);
+
+      ezMemoryUtils::PatternFill(ptr, static_cast<ezUInt8>(uiSize), uiSize);
+      allocations.PushBack(ptr);
+    }
+
+    EZ_TEST_BOOL(ezMemoryPolicies::ezSmallObjectAllocation::GetNumSlabs() > 0);
+
+    bool bAllCorrect = true;
+    for (ezUInt32 i = 0; i < allocations.GetCount(); ++i)
+    {
+      const ezUInt32 uiSize = 1 + i * 7;
+      for (ezUInt32 j = 0; j < uiSize; ++j)
+      {
+        bAllCorrect &= (allocations[i][j] == static_cast<ezUInt8>(uiSize));
+      }
+    }
+    EZ_TEST_BOOL(bAllCorrect);
+
+    for (ezUInt8* ptr : allocations)
+    {
+      allocator.Deallocate(ptr);
+    }
+    allocations.Clear();
+
+    // larger alignments are served by the heap
+    void* pAligned = allocator.Allocate(64, 64);
+    EZ_TEST_BOOL(ezMemoryUtils::IsAligned(pAligned, 64));
+    allocator.Deallocate(pAligned);
+
+    // reallocation keeps the content
+    {
+      ezDynamicArray<ezUInt32> numbers(&allocator);
+      for (ezUInt32 i = 0; i < 10000; ++i)
+      {
+        numbers.PushBack(i);
+      }
+
+      bAllCorrect = true;
+      for (ezUInt32 i = 0; i < 10000; ++i)
+      {
+        bAllCorrect &= (numbers[i] == i);
+      }
+      EZ_TEST_BOOL(bAllCorrect);
+    }
+
+    // blocks freed on another thread are reused
+    const ezUInt32 uiNumAllocations = 10000;
+    ezDynamicArray<void*> crossThread;
+    for (ezUInt32 i = 0; i < uiNumAllocations; ++i)
+    {
+      crossThread.PushBack(allocator.Allocate(48, 16));
+    }
+
+    {
+      SmallObjectFreeThread thread(&allocator, crossThread.GetArrayPtr());
+      thread.Start();
+      thread.Join();
+
+      EZ_TEST_INT(thread.m_OwnAllocations.GetCount(), uiNumAllocations);
+
+      // the slabs of the exited thread are adopted by this thread
+      for (ezUInt32 i = 0; i < uiNumAllocations; ++i)
+      {
+        crossThread[i] = allocator.Allocate(48, 16);
+      }
+
+      for (void* ptr : thread.m_OwnAllocations)
+      {
+        allocator.Deallocate(ptr);
+      }
+    }
+
+    for (void* ptr : crossThread)
+    {
+      allocator.Deallocate(ptr);
+    }
+
+    // slabs of an exited thread are released by the next exiting thread once all of their blocks have been freed elsewhere
+    {
+      const ezUInt64 uiNumSlabs = ezMemoryPolicies::ezSmallObjectAllocation::GetNumSlabs();
+
+      AllocThread thread1(&allocator, uiNumAllocations, false);
+      thread1.Start();
+      thread1.Join();
+
+      EZ_TEST_BOOL(ezMemoryPolicies::ezSmallObjectAllocation::GetNumSlabs() > uiNumSlabs);
+
+      for (void* ptr : thread1.m_Allocations)
+      {
+        allocator.Deallocate(ptr);
+      }
+
+      // its own slabs are empty when it exits, so they are released right away as well
+      AllocThread thread2(&allocator, 1, true);
+      thread2.Start();
+      thread2.Join();
+
+#if EZ_DISABLED(EZ_USE_SMALL_OBJECT_ALLOCATIONS)
+      // otherwise the default allocator shares the slabs and the threads themselves allocate from them
+      EZ_TEST_INT(ezMemoryPolicies::ezSmallObjectAllocation::GetNumSlabs(), uiNumSlabs);
+#endif
+    }
+
+    ezAllocatorBase::Stats stats = allocator.GetStats();
+    EZ_TEST_INT(stats.m_uiNumAllocations - stats.m_uiNumDeallocations, 0);
+    EZ_TEST_INT(stats.m_uiAllocationSize, 0);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "MemoryTracker")
+  {
+    typedef ezAllocator<ezMemoryPolicies::ezHeapAllocation, ezMemoryTrackingFlags::All> TrackedAllocator;
+    TrackedAllocator allocator("MemoryTrackerTest");
+
+    // allocations on many threads, freed on this thread
+    const ezUInt32 uiNumAllocations = 10000;
+    ezDynamicArray<ezUInt8*> allocations;
+    allocations.SetCount(uiNumAllocations);
+
+    ezTaskSystem::ParallelForIndexed(0, uiNumAllocations, [&](ezUInt32 uiStartIndex, ezUInt32 uiEndIndex) {
+      for (ezUInt32 i = uiStartIndex; i < uiEndIndex; ++i)
+      {
+        allocations[i] = static_cast<ezUInt8*>(allocator.Allocate(1 + (i % 100), 8));
+      }
+    });
+
+    ezUInt64 uiExpectedSize = 0;
+    bool bAllSizesCorrect = true;
+    for (ezUInt32 i = 0; i < uiNumAllocations; ++i)
+    {
+      uiExpectedSize += 1 + (i % 100);
+      bAllSizesCorrect &= (allocator.AllocatedSize(allocations[i]) == 1 + (i % 100));
+    }
+    EZ_TEST_BOOL(bAllSizesCorrect);
+
+    ezAllocatorBase::Stats stats = allocator.GetStats();
+    EZ_TEST_INT(stats.m_uiNumAllocations, uiNumAllocations);
+    EZ_TEST_INT(stats.m_uiNumDeallocations, 0);
+    EZ_TEST_INT(stats.m_uiAllocationSize, uiExpectedSize);
+    EZ_TEST_INT(stats.m_uiPerFrameAllocationSize, uiExpectedSize);
+
+    ezMemoryTracker::ResetPerFrameAllocatorStats();
+    EZ_TEST_INT(allocator.GetStats().m_uiPerFrameAllocationSize, 0);
+
+    for (ezUInt8* ptr : allocations)
+    {
+      allocator.Deallocate(ptr);
+    }
+
+    stats = allocator.GetStats();
+    EZ_TEST_INT(stats.m_uiNumAllocations, uiNumAllocations);
+    EZ_TEST_INT(stats.m_uiNumDeallocations, uiNumAllocations);
+    EZ_TEST_INT(stats.m_uiAllocationSize, 0);
+    EZ_TEST_INT(stats.m_uiPerFrameAllocationSize, 0);
+
+    // stack trace sampling
+    ezMemoryTracker::SetStackTraceSampling(4);
+
+    ezUInt32 uiNumStackTraces = 0;
+    for (ezUInt32 i = 0; i < 100; ++i)
+    {
+      allocations[i] = static_cast<ezUInt8*>(allocator.Allocate(16, 8));
+
+      if (ezMemoryTracker::GetAllocationInfo(allocator.GetId(), allocations[i]).m_pStackTrace != nullptr)
+        ++uiNumStackTraces;
+
+      // unsampled allocations are still tracked
+      EZ_TEST_INT(allocator.AllocatedSize(allocations[i]), 16);
+    }
+
+    ezMemoryTracker::SetStackTraceSampling(0xFFFFFFFF, 1024);
+
+    void* pLarge = allocator.Allocate(2048, 8);
+    EZ_TEST_BOOL(ezMemoryTracker::GetAllocationInfo(allocator.GetId(), pLarge).m_pStackTrace != nullptr);
+    allocator.Deallocate(pLarge);
+
+    ezMemoryTracker::SetStackTraceSampling(1);
+
+    for (ezUInt32 i = 0; i < 100; ++i)
+    {
+      allocator.Deallocate(allocations[i]);
+    }
+
+#if EZ_ENABLED(EZ_PLATFORM_WINDOWS) || EZ_ENABLED(EZ_PLATFORM_LINUX)
+    EZ_TEST_INT(uiNumStackTraces, 25);
+#endif
+
+    EZ_TEST_INT(allocator.GetStats().m_uiAllocationSize, 0);
+  }
 }
@@ -0,0 +1,203 @@
+#include <FoundationTestPCH.h>
+
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Memory/CommonAllocators.h>
+#include <Foundation/Threading/Thread.h>
+#include <Foundation/Time/Time.h>
+
+namespace
+{
+  enum AllocatorConstants
+  {
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEBUG)
+    NUM_ITERATIONS = 16,
+    NUM_LIVE_ALLOCATIONS = 1024 * 4,
+#else
+    NUM_ITERATIONS = 64,
+    NUM_LIVE_ALLOCATIONS = 1024 * 16,
+#endif
+    MAX_THREADS = 8
+  };
+
+  /// Replaces the blocks in m_Allocations with new blocks of varying small sizes and frees the blocks of another thread.
+  class AllocationThread : public ezThread
+  {
+  public:
+    AllocationThread()
+      : ezThread("Test Thread")
+    {
+    }
+
+    ezAllocatorBase* m_pAllocator = nullptr;
+    ezUInt32 m_uiSeed = 0;
+    ezUInt32 m_uiNumIterations = 0;
+
+    ezArrayPtr<void*> m_Allocations;
+
+    /// Blocks that were allocated by another thread and are freed by this thread.
+    ezArrayPtr<void*> m_ForeignAllocations;
+
+    virtual ezUInt32 Run()
+    {
+      ezUInt32 uiRandom = m_uiSeed;
+
+      for (ezUInt32 n = 0; n < m_uiNumIterations; ++n)
+      {
+        for (ezUInt32 i = 0; i < NUM_LIVE_ALLOCATIONS; ++i)
+        {
+          uiRandom = uiRandom * 1664525 + 1013904223;
+          const size_t uiSize = 8 + ((uiRandom >> 16) % 248);
+
+          // blocks of the previous round were freed by another thread already
+          if (m_Allocations[i] != nullptr)
+          {
+            m_pAllocator->Deallocate(m_Allocations[i]);
+          }
+
+          m_Allocations[i] = m_pAllocator->Allocate(uiSize, EZ_ALIGNMENT_MINIMUM);
+        }
+
+        for (void*& ptr : m_ForeignAllocations)
+        {
+          if (ptr != nullptr)
+          {
+            m_pAllocator->Deallocate(ptr);
+            ptr = nullptr;
+          }
+        }
+      }
+
+      return 0;
+    }
+  };
+
+  void RunThreads(ezArrayPtr<AllocationThread> threads)
+  {
+    for (AllocationThread& thread : threads)
+    {
+      thread.Start();
+    }
+
+    for (AllocationThread& thread : threads)
+    {
+      thread.Join();
+    }
+  }
+
+  /// Every thread keeps NUM_LIVE_ALLOCATIONS blocks alive and replaces them NUM_ITERATIONS times.
+  ezTime RunThreadLocalAllocations(ezAllocatorBase* pAllocator, ezUInt32 uiNumThreads)
+  {
+    ezDynamicArray<void*> allocations[MAX_THREADS];
+    AllocationThread threads[MAX_THREADS];
+
+    for (ezUInt32 t = 0; t < uiNumThreads; ++t)
+    {
+      allocations[t].SetCount(NUM_LIVE_ALLOCATIONS);
+
+      threads[t].m_pAllocator = pAllocator;
+      threads[t].m_uiSeed = t;
+      threads[t].m_uiNumIterations = NUM_ITERATIONS;
+      threads[t].m_Allocations = allocations[t].GetArrayPtr();
+    }
+
+    ezTime t0 = ezTime::Now();
+    RunThreads(ezMakeArrayPtr(threads, uiNumThreads));
+    ezTime t1 = ezTime::Now();
+
+    for (ezUInt32 t = 0; t < uiNumThreads; ++t)
+    {
+      for (void* ptr : allocations[t])
+      {
+        pAllocator->Deallocate(ptr);
+      }
+    }
+
+    return t1 - t0;
+  }
+
+  /// In every round each thread allocates NUM_LIVE_ALLOCATIONS blocks and frees the blocks that its neighbour allocated in the
+  /// previous round, so all memory is freed by another thread than the one that allocated it.
+  ezTime RunCrossThreadFrees(ezAllocatorBase* pAllocator, ezUInt32 uiNumThreads)
+  {
+    ezDynamicArray<void*> allocations[2][MAX_THREADS];
+
+    for (ezUInt32 t = 0; t < uiNumThreads; ++t)
+    {
+      allocations[0][t].SetCount(NUM_LIVE_ALLOCATIONS);
+      allocations[1][t].SetCount(NUM_LIVE_ALLOCATIONS);
+    }
+
+    ezTime tDuration;
+
+    for (ezUInt32 n = 0; n < NUM_ITERATIONS; ++n)
+    {
+      AllocationThread threads[MAX_THREADS];
+
+      for (ezUInt32 t = 0; t < uiNumThreads; ++t)
+      {
+        threads[t].m_pAllocator = pAllocator;
+        threads[t].m_uiSeed = n * MAX_THREADS + t;
+        threads[t].m_uiNumIterations = 1;
+        threads[t].m_Allocations = allocations[n % 2][t].GetArrayPtr();
+        threads[t].m_ForeignAllocations = allocations[(n + 1) % 2][(t + 1) % uiNumThreads].GetArrayPtr();
+      }
+
+      ezTime t0 = ezTime::Now();
+      RunThreads(ezMakeArrayPtr(threads, uiNumThreads));
+      tDuration += ezTime::Now() - t0;
+    }
+
+    for (ezUInt32 t = 0; t < uiNumThreads; ++t)
+    {
+      for (void* ptr : allocations[NUM_ITERATIONS % 2 == 0 ? 1 : 0][t])
+      {
+        pAllocator->Deallocate(ptr);
+      }
+    }
+
+    return tDuration;
+  }
+} // namespace
+
+// Enable when needed
+#define EZ_PERFORMANCE_TESTS_STATE ezTestBlock::DisabledNoWarning
+
+EZ_CREATE_SIMPLE_TEST(Performance, Allocators)
+{
+  ezHeapAllocator heapAllocator("Performance HeapAllocator");
+  ezSmallObjectAllocator smallObjectAllocator("Performance SmallObjectAllocator");
+
+  // without allocation tracking, which serializes all threads on the memory tracker
+  ezAllocator<ezMemoryPolicies::ezHeapAllocation, ezMemoryTrackingFlags::None> untrackedHeapAllocator("Performance Untracked HeapAllocator");
+  ezAllocator<ezMemoryPolicies::ezSmallObjectAllocation, ezMemoryTrackingFlags::None> untrackedSmallObjectAllocator(
+    "Performance Untracked SmallObjectAllocator");
+
+  ezAllocatorBase* allocators[] = {&heapAllocator, &smallObjectAllocator, &untrackedHeapAllocator, &untrackedSmallObjectAllocator};
+  const char* allocatorNames[] = {"ezHeapAllocator", "ezSmallObjectAllocator", "Untracked ezHeapAllocator", "Untracked ezSmallObjectAllocator"};
+
+  EZ_TEST_BLOCK(EZ_PERFORMANCE_TESTS_STATE, "Thread Local Allocations")
+  {
+    for (ezUInt32 a = 0; a < EZ_ARRAY_SIZE(allocators); ++a)
+    {
+      for (ezUInt32 uiNumThreads = 1; uiNumThreads <= MAX_THREADS; uiNumThreads *= 2)
+      {
+        ezTime t = RunThreadLocalAllocations(allocators[a], uiNumThreads);
+
+        ezLog::Info("[test]{0} Thread Local Allocations, {1} Threads {2}ms", allocatorNames[a], uiNumThreads, ezArgF(t.GetMilliseconds(), 4));
+      }
+    }
+  }
+
+  EZ_TEST_BLOCK(EZ_PERFORMANCE_TESTS_STATE, "Cross Thread Frees")
+  {
+    for (ezUInt32 a = 0; a < EZ_ARRAY_SIZE(allocators); ++a)
+    {
+      for (ezUInt32 uiNumThreads = 2; uiNumThreads <= MAX_THREADS; uiNumThreads *= 2)
+      {
+        ezTime t = RunCrossThreadFrees(allocators[a], uiNumThreads);
+
+        ezLog::Info("[test]{0} Cross Thread Frees, {1} Threads {2}ms", allocatorNames[a], uiNumThreads, ezArgF(t.GetMilliseconds(), 4));
+      }
+    }
+  }
+}
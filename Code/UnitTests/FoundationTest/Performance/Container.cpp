@@ -1,6 +1,7 @@
 #include <FoundationTestPCH.h>
 
 #include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Containers/FlatHashTable.h>
 #include <Foundation/Logging/Log.h>
 #include <Foundation/Reflection/Reflection.h>
 #include <Foundation/Strings/String.h>
@@ -426,4 +427,149 @@ EZ_CREATE_SIMPLE_TEST(Performance, Container)
                   ezArgF((t1 - t0).GetMilliseconds() / static_cast<double>(NUM_SAMPLES), 4), sum);
     }
   }
+
+  EZ_TEST_BLOCK(ezTestBlock::DisabledNoWarning, "ezFlatHashTable<void*, ezUInt32>")
+  {
+    ezUInt32 sum = 0;
+
+
+
+    for (ezUInt32 size = 1024; size < 4096 * 32; size += 1024)
+    {
+      ezFlatHashTable<void*, ezUInt32> map;
+
+      for (ezUInt32 i = 0; i < size; i++)
+      {
+        map.Insert(malloc(64), 64);
+      }
+
+      void* ptrs[1024];
+
+      ezTime t0 = ezTime::Now();
+      for (ezUInt32 n = 0; n < NUM_SAMPLES; n++)
+      {
+
+        for (ezUInt32 i = 0; i < 1024; i++)
+        {
+          void* mem = malloc(64);
+          map.Insert(mem, 64);
+          map.Remove(mem);
+          ptrs[i] = mem;
+        }
+
+        for (ezUInt32 i = 0; i < 1024; i++)
+          free(ptrs[i]);
+
+        for (auto it = map.GetIterator(); it.IsValid(); it.Next())
+        {
+          sum += it.Value();
+        }
+      }
+      ezTime t1 = ezTime::Now();
+
+      for (auto it = map.GetIterator(); it.IsValid(); it.Next())
+      {
+        free(it.Key());
+      }
+
+      ezLog::Info("[test]ezFlatHashTable<void*, ezUInt32> size = {0} => {1}ms", size,
+                  ezArgF((t1 - t0).GetMilliseconds() / static_cast<double>(NUM_SAMPLES), 4), sum);
+    }
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::DisabledNoWarning, "ezHashTable<void*, ezUInt32> Lookup")
+  {
+    ezUInt32 sum = 0;
+
+    for (ezUInt32 size = 1024; size < 4096 * 32; size += 1024)
+    {
+      ezHashTable<void*, ezUInt32> map;
+      ezDynamicArray<void*> keys;
+      keys.Reserve(size);
+
+      for (ezUInt32 i = 0; i < size; i++)
+      {
+        void* mem = malloc(64);
+        map.Insert(mem, i);
+        keys.PushBack(mem);
+      }
+
+      // pointers that are not in the map
+      void* missingKeys[1024];
+      for (ezUInt32 i = 0; i < 1024; i++)
+        missingKeys[i] = malloc(64);
+
+      ezTime t0 = ezTime::Now();
+      for (ezUInt32 n = 0; n < NUM_SAMPLES; n++)
+      {
+        for (ezUInt32 i = 0; i < size; i++)
+        {
+          sum += *map.GetValue(keys[i]);
+        }
+
+        for (ezUInt32 i = 0; i < 1024; i++)
+        {
+          sum += map.Contains(missingKeys[i]) ? 1 : 0;
+        }
+      }
+      ezTime t1 = ezTime::Now();
+
+      for (ezUInt32 i = 0; i < 1024; i++)
+        free(missingKeys[i]);
+
+      for (ezUInt32 i = 0; i < size; i++)
+        free(keys[i]);
+
+      ezLog::Info("[test]ezHashTable<void*, ezUInt32> Lookup size = {0} => {1}ms", size,
+                  ezArgF((t1 - t0).GetMilliseconds() / static_cast<double>(NUM_SAMPLES), 4), sum);
+    }
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::DisabledNoWarning, "ezFlatHashTable<void*, ezUInt32> Lookup")
+  {
+    ezUInt32 sum = 0;
+
+    for (ezUInt32 size = 1024; size < 4096 * 32; size += 1024)
+    {
+      ezFlatHashTable<void*, ezUInt32> map;
+      ezDynamicArray<void*> keys;
+      keys.Reserve(size);
+
+      for (ezUInt32 i = 0; i < size; i++)
+      {
+        void* mem = malloc(64);
+        map.Insert(mem, i);
+        keys.PushBack(mem);
+      }
+
+      // pointers that are not in the map
+      void* missingKeys[1024];
+      for (ezUInt32 i = 0; i < 1024; i++)
+        missingKeys[i] = malloc(64);
+
+      ezTime t0 = ezTime::Now();
+      for (ezUInt32 n = 0; n < NUM_SAMPLES; n++)
+      {
+        for (ezUInt32 i = 0; i < size; i++)
+        {
+          sum += *map.GetValue(keys[i]);
+        }
+
+        for (ezUInt32 i = 0; i < 1024; i++)
+        {
+          sum += map.Contains(missingKeys[i]) ? 1 : 0;
+        }
+      }
+      ezTime t1 = ezTime::Now();
+
+      for (ezUInt32 i = 0; i < 1024; i++)
+        free(missingKeys[i]);
+
+      for (ezUInt32 i = 0; i < size; i++)
+        free(keys[i]);
+
+      ezLog::Info("[test]ezFlatHashTable<void*, ezUInt32> Lookup size = {0} => {1}ms", size,
+                  ezArgF((t1 - t0).GetMilliseconds() / static_cast<double>(NUM_SAMPLES), 4), sum);
+    }
+  }
 }
@@ -2,7 +2,10 @@
 
 #include <Foundation/IO/FileSystem/FileSystem.h>
 #include <Foundation/IO/FileSystem/FileWriter.h>
+#include <Foundation/IO/MemoryStream.h>
+#include <Foundation/IO/OSFile.h>
 #include <Foundation/Profiling/Profiling.h>
+#include <Foundation/Threading/Thread.h>
 #include <Foundation/Threading/ThreadUtils.h>
 
 namespace
@@ -20,7 +23,27 @@ namespace
       ezLog::Info("Profiling capture saved to '{0}'.", fileWriter.GetFilePathAbsolute().GetData());
     }
   }
-}
+
+  class ProfilingTestThread : public ezThread
+  {
+  public:
+    ProfilingTestThread()
+      : ezThread("Profiling Test Thread")
+    {
+    }
+
+    virtual ezUInt32 Run()
+    {
+      for (ezUInt32 i = 0; i < 10; ++i)
+      {
+        EZ_PROFILE_SCOPE("Thread scope");
+        ezThreadUtils::Sleep(ezTime::Milliseconds(1));
+      }
+
+      return 0;
+    }
+  };
+} // namespace
 
 EZ_CREATE_SIMPLE_TEST_GROUP(Profiling);
 
@@ -51,4 +74,198 @@ EZ_CREATE_SIMPLE_TEST(Profiling, Profiling)
 
     WriteOutProfilingCapture(":output/profilingScopes.json");
   }
+
+#if EZ_ENABLED(EZ_USE_PROFILING)
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Scope names")
+  {
+    const ezUInt32 uiId = ezProfilingSystem::RegisterScopeName("Registered scope", "Function");
+    EZ_TEST_INT(ezProfilingSystem::RegisterScopeName("Registered scope", "Function"), uiId);
+    EZ_TEST_BOOL(ezProfilingSystem::RegisterScopeName("Registered scope", nullptr) != uiId);
+
+    ezStringBuilder sDynamicName("Registered");
+    sDynamicName.Append(" scope");
+    EZ_TEST_INT(ezProfilingSystem::RegisterScopeName(sDynamicName, "Function"), uiId);
+
+    ezProfilingSystem::Clear();
+    ezProfilingSystem::SetDiscardThreshold(ezTime::Zero());
+
+    const char* szLongName = "A scope name that is much longer than the forty characters that used to be stored per scope";
+
+    for (ezUInt32 i = 0; i < 3; ++i)
+    {
+      EZ_PROFILE_SCOPE("Static scope");
+
+      // the same buffer with different content for every scope
+      sDynamicName.Format("Dynamic scope {}", i);
+      EZ_PROFILE_SCOPE(sDynamicName.GetData());
+
+      EZ_PROFILE_SCOPE(szLongName);
+    }
+
+    {
+      EZ_PROFILE_LIST_SCOPE("List scope", "Section 1");
+      EZ_PROFILE_LIST_NEXT_SECTION("Section 2");
+    }
+
+    ezProfilingSystem::SetDiscardThreshold(ezTime::Milliseconds(0.1));
+
+    ezProfilingSystem::ProfilingData profilingData = ezProfilingSystem::Capture();
+
+    ezMap<ezString, ezUInt32> scopeCounts;
+    for (const ezProfilingSystem::CPUScopesBufferFlat& eventBuffer : profilingData.m_AllEventBuffers)
+    {
+      if (eventBuffer.m_uiThreadId != (ezUInt64)ezThreadUtils::GetCurrentThreadID())
+        continue;
+
+      for (const ezProfilingSystem::CPUScope& scope : eventBuffer.m_Data)
+      {
+        scopeCounts[scope.m_szName]++;
+
+        if (ezStringUtils::IsEqual(scope.m_szName, "Static scope"))
+        {
+          EZ_TEST_BOOL(scope.m_szFunctionName != nullptr);
+        }
+        else if (ezStringUtils::IsEqual(scope.m_szName, "Section 1"))
+        {
+          EZ_TEST_BOOL(scope.m_szFunctionName == nullptr);
+        }
+      }
+    }
+
+    EZ_TEST_INT(scopeCounts["Static scope"], 3);
+    EZ_TEST_INT(scopeCounts["Dynamic scope 0"], 1);
+    EZ_TEST_INT(scopeCounts["Dynamic scope 1"], 1);
+    EZ_TEST_INT(scopeCounts["Dynamic scope 2"], 1);
+    EZ_TEST_INT(scopeCounts[szLongName], 3);
+    EZ_TEST_INT(scopeCounts["List scope"], 1);
+    EZ_TEST_INT(scopeCounts["Section 1"], 1);
+    EZ_TEST_INT(scopeCounts["Section 2"], 1);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Counters")
+  {
+    for (ezUInt32 i = 0; i < 5; ++i)
+    {
+      EZ_PROFILE_COUNTER("Test counter", i * 10);
+    }
+
+    ezStringBuilder sDynamicName = "Dynamic counter";
+    EZ_PROFILE_COUNTER(sDynamicName.GetData(), -1.5f);
+
+    ezProfilingSystem::ProfilingData profilingData = ezProfilingSystem::Capture();
+
+    ezDynamicArray<double> values;
+    double fDynamicValue = 0.0;
+    for (const ezProfilingSystem::CPUScopesBufferFlat& eventBuffer : profilingData.m_AllEventBuffers)
+    {
+      if (eventBuffer.m_uiThreadId != (ezUInt64)ezThreadUtils::GetCurrentThreadID())
+        continue;
+
+      for (const ezProfilingSystem::CPUScope& scope : eventBuffer.m_Data)
+      {
+        EZ_TEST_BOOL(!ezStringUtils::IsEqual(scope.m_szName, "Test counter"));
+      }
+
+      for (const ezProfilingSystem::CounterSample& sample : eventBuffer.m_CounterSamples)
+      {
+        if (ezStringUtils::IsEqual(sample.m_szName, "Test counter"))
+        {
+          values.PushBack(sample.m_fValue);
+        }
+        else if (ezStringUtils::IsEqual(sample.m_szName, "Dynamic counter"))
+        {
+          fDynamicValue = sample.m_fValue;
+        }
+      }
+    }
+
+    if (EZ_TEST_INT(values.GetCount(), 5).Succeeded())
+    {
+      for (ezUInt32 i = 0; i < 5; ++i)
+      {
+        EZ_TEST_DOUBLE(values[i], i * 10.0, 0.0);
+      }
+    }
+
+    EZ_TEST_DOUBLE(fDynamicValue, -1.5, 0.0);
+
+    ezMemoryStreamStorage storage;
+    ezMemoryStreamWriter jsonWriter(&storage);
+    EZ_TEST_BOOL(profilingData.Write(jsonWriter) == EZ_SUCCESS);
+
+    ezStringBuilder sJson;
+    sJson.SetSubString_FromTo(reinterpret_cast<const char*>(storage.GetData()), reinterpret_cast<const char*>(storage.GetData()) + storage.GetStorageSize());
+    EZ_TEST_BOOL(sJson.FindSubString("\"Test counter\"") != nullptr);
+    EZ_TEST_BOOL(sJson.FindSubString("\"ph\":\"C\"") != nullptr);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Streaming")
+  {
+    ezStringBuilder sTracePath = ezTestFramework::GetInstance()->GetAbsOutputPath();
+    sTracePath.AppendPath("profilingStream.ezpt");
+
+    EZ_TEST_BOOL(!ezProfilingSystem::IsStreaming());
+    EZ_TEST_BOOL(ezProfilingSystem::StartStreaming(sTracePath, ezTime::Milliseconds(5)) == EZ_SUCCESS);
+    EZ_TEST_BOOL(ezProfilingSystem::IsStreaming());
+
+    ezProfilingSystem::InitializeGPUData();
+
+    ProfilingTestThread thread;
+    thread.Start();
+
+    // more frames than fit into one flush interval
+    for (ezUInt32 i = 0; i < 20; ++i)
+    {
+      ezProfilingSystem::StartNewFrame();
+
+      EZ_PROFILE_SCOPE("Frame scope");
+      EZ_PROFILE_COUNTER("Frame counter", i);
+      ezThreadUtils::Sleep(ezTime::Milliseconds(1));
+
+      ezProfilingSystem::AddGPUScope("GPU scope", ezTime::Now() - ezTime::Milliseconds(1), ezTime::Now());
+    }
+
+    thread.Join();
+
+    ezProfilingSystem::StopStreaming();
+    EZ_TEST_BOOL(!ezProfilingSystem::IsStreaming());
+
+    ezOSFile traceFile;
+    if (EZ_TEST_BOOL(traceFile.Open(sTracePath, ezFileOpenMode::Read) == EZ_SUCCESS).Succeeded())
+    {
+      ezDynamicArray<ezUInt8> traceData;
+      traceFile.ReadAll(traceData);
+      traceFile.Close();
+
+      ezRawMemoryStreamReader traceReader(traceData);
+
+      ezMemoryStreamStorage storage;
+      ezMemoryStreamWriter jsonWriter(&storage);
+      EZ_TEST_BOOL(ezProfilingSystem::ConvertTraceToJSON(traceReader, jsonWriter) == EZ_SUCCESS);
+
+      ezStringBuilder sJson;
+      sJson.SetSubString_FromTo(reinterpret_cast<const char*>(storage.GetData()), reinterpret_cast<const char*>(storage.GetData()) + storage.GetStorageSize());
+
+      EZ_TEST_BOOL(sJson.StartsWith("{\"traceEvents\":["));
+      EZ_TEST_BOOL(sJson.EndsWith("]}"));
+      EZ_TEST_BOOL(sJson.FindSubString("\"Profiling Test Thread\"") != nullptr);
+      EZ_TEST_BOOL(sJson.FindSubString("\"Thread scope\"") != nullptr);
+      EZ_TEST_BOOL(sJson.FindSubString("\"Frame scope\"") != nullptr);
+      EZ_TEST_BOOL(sJson.FindSubString("\"GPU scope\"") != nullptr);
+      EZ_TEST_BOOL(sJson.FindSubString("\"Frame ") != nullptr);
+      EZ_TEST_BOOL(sJson.FindSubString("\"Frame counter\"") != nullptr);
+      EZ_TEST_BOOL(sJson.FindSubString("\"ph\":\"C\"") != nullptr);
+
+      // every scope was written exactly once, no matter how many flushes happened
+      ezUInt32 uiNumFrameScopes = 0;
+      for (const char* szPos = sJson.FindSubString("\"Frame scope\""); szPos != nullptr; szPos = sJson.FindSubString("\"Frame scope\"", szPos + 1))
+      {
+        ++uiNumFrameScopes;
+      }
+
+      // begin and end events
+      EZ_TEST_INT(uiNumFrameScopes, 20 * 2);
+    }
+  }
+#endif
 }
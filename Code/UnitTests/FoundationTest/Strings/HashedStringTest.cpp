@@ -1,6 +1,56 @@
 #include <FoundationTestPCH.h>
 
 #include <Foundation/Strings/HashedString.h>
+#include <Foundation/Strings/StringBuilder.h>
+#include <Foundation/Threading/Thread.h>
+#include <Foundation/Time/Stopwatch.h>
+#include <Foundation/Types/UniquePtr.h>
+
+namespace
+{
+  enum
+  {
+    NUM_THREADS = 8,
+    NUM_STRINGS = 4096, ///< shared by all threads, so every string is added by one thread and looked up by all others
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEBUG)
+    NUM_ROUNDS = 4,
+#else
+    NUM_ROUNDS = 32,
+#endif
+  };
+
+  /// Assigns the same set of strings over and over, like multiple threads that load resources or deserialize worlds.
+  class HashedStringTestThread : public ezThread
+  {
+  public:
+    HashedStringTestThread(const ezDynamicArray<ezString>& strings, ezUInt32 uiOffset)
+      : ezThread("Test Thread")
+      , m_Strings(strings)
+      , m_uiOffset(uiOffset)
+    {
+    }
+
+    virtual ezUInt32 Run() override
+    {
+      m_HashedStrings.SetCount(m_Strings.GetCount());
+
+      for (ezUInt32 uiRound = 0; uiRound < NUM_ROUNDS; ++uiRound)
+      {
+        for (ezUInt32 i = 0; i < m_Strings.GetCount(); ++i)
+        {
+          const ezUInt32 uiIndex = (i + m_uiOffset) % m_Strings.GetCount();
+          m_HashedStrings[uiIndex].Assign(m_Strings[uiIndex].GetData());
+        }
+      }
+
+      return 0;
+    }
+
+    const ezDynamicArray<ezString>& m_Strings;
+    ezUInt32 m_uiOffset;
+    ezDynamicArray<ezHashedString> m_HashedStrings;
+  };
+} // namespace
 
 EZ_CREATE_SIMPLE_TEST(Strings, HashedString)
 {
@@ -176,3 +226,53 @@ EZ_CREATE_SIMPLE_TEST(Strings, HashedString)
   }
 #endif
 }
+
+EZ_CREATE_SIMPLE_TEST(Strings, HashedStringContention)
+{
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Assign from multiple threads")
+  {
+    ezDynamicArray<ezString> strings;
+
+    ezStringBuilder sTemp;
+    for (ezUInt32 i = 0; i < NUM_STRINGS; ++i)
+    {
+      sTemp.Format("HashedStringContention/Resource_{0}.ezAsset", i);
+      strings.PushBack(sTemp);
+    }
+
+    ezDynamicArray<ezUniquePtr<HashedStringTestThread>> threads;
+    for (ezUInt32 i = 0; i < NUM_THREADS; ++i)
+    {
+      threads.PushBack(EZ_DEFAULT_NEW(HashedStringTestThread, strings, i * NUM_STRINGS / NUM_THREADS));
+    }
+
+    ezStopwatch sw;
+
+    for (auto& pThread : threads)
+    {
+      pThread->Start();
+    }
+
+    for (auto& pThread : threads)
+    {
+      pThread->Join();
+    }
+
+    const ezTime tDiff = sw.GetRunningTotal();
+    ezTestFramework::Output(ezTestOutput::Duration, "%u threads assigning %u hashed strings: %.2fms", NUM_THREADS, NUM_THREADS * NUM_STRINGS * NUM_ROUNDS,
+      tDiff.GetMilliseconds());
+
+    // every thread must have ended up with the same storage for the same string
+    for (ezUInt32 i = 0; i < NUM_STRINGS; ++i)
+    {
+      const ezHashedString& hs = threads[0]->m_HashedStrings[i];
+      EZ_TEST_STRING(hs.GetData(), strings[i].GetData());
+
+      for (ezUInt32 t = 1; t < NUM_THREADS; ++t)
+      {
+        EZ_TEST_BOOL(threads[t]->m_HashedStrings[i] == hs);
+        EZ_TEST_BOOL(threads[t]->m_HashedStrings[i].GetData() == hs.GetData());
+      }
+    }
+  }
+}
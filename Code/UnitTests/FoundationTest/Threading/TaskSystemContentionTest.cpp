@@ -0,0 +1,223 @@
+#include <FoundationTestPCH.h>
+
+#include <Foundation/Containers/Deque.h>
+#include <Foundation/Threading/TaskSystem.h>
+#include <Foundation/Time/Stopwatch.h>
+
+namespace
+{
+  enum constants
+  {
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEBUG)
+    NUM_SPAWNERS = 16,
+    NUM_ROUNDS = 4,
+#else
+    NUM_SPAWNERS = 32,
+    NUM_ROUNDS = 16,
+#endif
+    NUM_TINY_TASKS = 128, ///< per round, below the capacity of the worker-local queues
+  };
+
+  /// Does almost no work, so that the scheduling overhead dominates.
+  class TinyTask final : public ezTask
+  {
+  public:
+    TinyTask()
+    {
+      ConfigureTask("TinyTask", ezTaskNesting::Never);
+      m_Results.SetCount(NUM_TINY_TASKS);
+    }
+
+    mutable ezDynamicArray<ezUInt32> m_Results;
+
+  private:
+    virtual void ExecuteWithMultiplicity(ezUInt32 uiInvocation) const override
+    {
+      ezUInt32 uiValue = uiInvocation;
+      for (ezUInt32 i = 0; i < 16; ++i)
+      {
+        uiValue = uiValue * 1664525u + 1013904223u;
+      }
+
+      m_Results[uiInvocation] += (uiValue != 0xFFFFFFFF) ? 1 : 0;
+    }
+  };
+
+  /// Runs on a worker thread and repeatedly starts and waits for a batch of tiny tasks.
+  class SpawnerTask final : public ezTask
+  {
+  public:
+    SpawnerTask()
+    {
+      ConfigureTask("SpawnerTask", ezTaskNesting::Maybe);
+      m_TinyTask.SetMultiplicity(NUM_TINY_TASKS);
+    }
+
+    TinyTask m_TinyTask;
+
+  private:
+    virtual void Execute() override
+    {
+      for (ezUInt32 round = 0; round < NUM_ROUNDS; ++round)
+      {
+        ezTaskGroupID id = ezTaskSystem::StartSingleTask(&m_TinyTask, ezTaskPriority::EarlyThisFrame);
+        ezTaskSystem::WaitForGroup(id);
+      }
+    }
+  };
+
+  /// Records in which order the groups of a dependency graph were executed.
+  class OrderTask final : public ezTask
+  {
+  public:
+    OrderTask() { ConfigureTask("OrderTask", ezTaskNesting::Never); }
+
+    static ezAtomicInteger32 s_iExecutionCounter;
+    ezInt32 m_iExecutionOrder = -1;
+
+  private:
+    virtual void Execute() override { m_iExecutionOrder = s_iExecutionCounter.Increment(); }
+  };
+
+  ezAtomicInteger32 OrderTask::s_iExecutionCounter;
+
+  static ezTime RunSpawnerBenchmark(ezTaskSchedulingMode::Enum mode, bool& out_bAllExecuted)
+  {
+    ezTaskSystem::SetTaskSchedulingMode(mode);
+
+    SpawnerTask spawners[NUM_SPAWNERS];
+
+    ezStopwatch sw;
+
+    ezTaskGroupID group = ezTaskSystem::CreateTaskGroup(ezTaskPriority::ThisFrame);
+    for (ezUInt32 i = 0; i < NUM_SPAWNERS; ++i)
+    {
+      ezTaskSystem::AddTaskToGroup(group, &spawners[i]);
+    }
+    ezTaskSystem::StartTaskGroup(group);
+    ezTaskSystem::WaitForGroup(group);
+
+    const ezTime duration = sw.GetRunningTotal();
+
+    out_bAllExecuted = true;
+    for (ezUInt32 i = 0; i < NUM_SPAWNERS; ++i)
+    {
+      for (ezUInt32 uiResult : spawners[i].m_TinyTask.m_Results)
+      {
+        out_bAllExecuted &= (uiResult == NUM_ROUNDS);
+      }
+    }
+
+    ezTaskSystem::SetTaskSchedulingMode(ezTaskSchedulingMode::Default);
+    return duration;
+  }
+} // namespace
+
+EZ_CREATE_SIMPLE_TEST(Threading, TaskSystemContention)
+{
+  const ezUInt32 uiNumTinyTasks = NUM_SPAWNERS * NUM_ROUNDS * NUM_TINY_TASKS;
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Tiny Tasks (Global Queue)")
+  {
+    bool bAllExecuted = false;
+    const ezTime duration = RunSpawnerBenchmark(ezTaskSchedulingMode::GlobalQueue, bAllExecuted);
+    EZ_TEST_BOOL(bAllExecuted);
+
+    ezLog::Info("[test]Global Queue: {0} tiny tasks in {1}ms ({2} threads)", uiNumTinyTasks, ezArgF(duration.GetMilliseconds(), 2),
+      ezTaskSystem::GetWorkerThreadCount(ezWorkerThreadType::ShortTasks));
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Tiny Tasks (Work Stealing)")
+  {
+    bool bAllExecuted = false;
+    const ezTime duration = RunSpawnerBenchmark(ezTaskSchedulingMode::WorkStealing, bAllExecuted);
+    EZ_TEST_BOOL(bAllExecuted);
+
+    ezLog::Info("[test]Work Stealing: {0} tiny tasks in {1}ms ({2} threads)", uiNumTinyTasks, ezArgF(duration.GetMilliseconds(), 2),
+      ezTaskSystem::GetWorkerThreadCount(ezWorkerThreadType::ShortTasks));
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Many Dependent Groups")
+  {
+    // layers of groups, where every group depends on all groups of the previous layer
+    // lots of groups finish at the same time and release their dependents concurrently
+    constexpr ezUInt32 uiNumLayers = 16;
+    constexpr ezUInt32 uiGroupsPerLayer = 32;
+
+    ezDeque<OrderTask> tasks;
+    tasks.SetCount(uiNumLayers * uiGroupsPerLayer);
+
+    ezDynamicArray<ezTaskGroupID> groups;
+    groups.SetCount(uiNumLayers * uiGroupsPerLayer);
+
+    ezStopwatch sw;
+
+    for (ezUInt32 layer = 0; layer < uiNumLayers; ++layer)
+    {
+      for (ezUInt32 i = 0; i < uiGroupsPerLayer; ++i)
+      {
+        const ezUInt32 uiGroup = layer * uiGroupsPerLayer + i;
+        groups[uiGroup] = ezTaskSystem::CreateTaskGroup(ezTaskPriority::ThisFrame);
+        ezTaskSystem::AddTaskToGroup(groups[uiGroup], &tasks[uiGroup]);
+
+        if (layer > 0)
+        {
+          for (ezUInt32 dep = 0; dep < uiGroupsPerLayer; ++dep)
+          {
+            ezTaskSystem::AddTaskGroupDependency(groups[uiGroup], groups[(layer - 1) * uiGroupsPerLayer + dep]);
+          }
+        }
+      }
+
+      // start each layer right away, so that some dependencies are still running and others are already finished
+      ezTaskSystem::StartTaskGroupBatch(groups.GetArrayPtr().GetSubArray(layer * uiGroupsPerLayer, uiGroupsPerLayer));
+    }
+
+    ezTaskSystem::WaitForGroup(groups.PeekBack());
+
+    for (ezUInt32 i = 0; i < uiGroupsPerLayer; ++i)
+    {
+      ezTaskSystem::WaitForGroup(groups[(uiNumLayers - 1) * uiGroupsPerLayer + i]);
+    }
+
+    const ezTime duration = sw.GetRunningTotal();
+
+    for (ezUInt32 layer = 1; layer < uiNumLayers; ++layer)
+    {
+      ezInt32 iLatestOfPreviousLayer = -1;
+      for (ezUInt32 i = 0; i < uiGroupsPerLayer; ++i)
+      {
+        iLatestOfPreviousLayer = ezMath::Max(iLatestOfPreviousLayer, tasks[(layer - 1) * uiGroupsPerLayer + i].m_iExecutionOrder);
+      }
+
+      for (ezUInt32 i = 0; i < uiGroupsPerLayer; ++i)
+      {
+        EZ_TEST_BOOL(tasks[layer * uiGroupsPerLayer + i].m_iExecutionOrder > iLatestOfPreviousLayer);
+      }
+    }
+
+    for (const ezTaskGroupID& group : groups)
+    {
+      EZ_TEST_BOOL(ezTaskSystem::IsTaskGroupFinished(group));
+    }
+
+    ezLog::Info("[test]Dependent Groups: {0} groups in {1}ms", groups.GetCount(), ezArgF(duration.GetMilliseconds(), 2));
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Switch Mode With Queued Tasks")
+  {
+    // tasks that are still in the local queues when switching back to the global queue must still get executed
+    ezTaskSystem::SetTaskSchedulingMode(ezTaskSchedulingMode::WorkStealing);
+
+    SpawnerTask spawner;
+    ezTaskGroupID group = ezTaskSystem::StartSingleTask(&spawner, ezTaskPriority::ThisFrame);
+
+    ezTaskSystem::SetTaskSchedulingMode(ezTaskSchedulingMode::GlobalQueue);
+    ezTaskSystem::WaitForGroup(group);
+
+    for (ezUInt32 uiResult : spawner.m_TinyTask.m_Results)
+    {
+      EZ_TEST_INT(uiResult, NUM_ROUNDS);
+    }
+  }
+}
@@ -0,0 +1,252 @@
+#include <GameEngineTestPCH.h>
+
+#include <GameEngine/AI/PathQueryWorldModule.h>
+#include <Utilities/DataStructures/GameGrid.h>
+#include <Utilities/PathFinding/GridNavmesh.h>
+
+namespace PathQueryTestDetail
+{
+  static const ezUInt16 g_uiGridSize = 32;
+
+  static bool IsSameCellType(ezUInt32 uiCell1, ezUInt32 uiCell2, void* pPassThrough)
+  {
+    const ezGameGrid<ezUInt8>* pGrid = static_cast<const ezGameGrid<ezUInt8>*>(pPassThrough);
+    return pGrid->GetCell(uiCell1) == pGrid->GetCell(uiCell2);
+  }
+
+  static bool IsCellBlocked(ezUInt32 uiCell, void* pPassThrough)
+  {
+    const ezGameGrid<ezUInt8>* pGrid = static_cast<const ezGameGrid<ezUInt8>*>(pPassThrough);
+    return pGrid->GetCell(uiCell) == 0xFF;
+  }
+
+  /// A checkerboard of two terrain types in 4x4 blocks, so that every block becomes a separate area.
+  /// A wall along x = 16 with a single gap at the top forces every path from the left to the right half through the gap.
+  static void CreateNavmesh(ezGameGrid<ezUInt8>& grid, ezGridNavmesh& navmesh)
+  {
+    grid.CreateGrid(g_uiGridSize, g_uiGridSize);
+
+    for (ezUInt32 i = 0; i < grid.GetNumCells(); ++i)
+    {
+      const ezVec2I32 coord = grid.ConvertCellIndexToCoordinate(i);
+      grid.GetCell(i) = static_cast<ezUInt8>((coord.x / 4 + coord.y / 4) % 2);
+    }
+
+    for (ezInt32 y = 0; y < g_uiGridSize - 2; ++y)
+    {
+      grid.GetCell(ezVec2I32(16, y)) = 0xFF;
+    }
+
+    navmesh.CreateFromGrid(grid, IsSameCellType, &grid, IsCellBlocked, &grid);
+  }
+
+  static bool AreNeighbors(const ezGridNavmesh& navmesh, ezInt32 iArea1, ezInt32 iArea2)
+  {
+    const ezGridNavmesh::ConvexArea& area = navmesh.GetConvexArea(iArea1);
+
+    for (ezUInt32 e = 0; e < area.m_uiNumEdges; ++e)
+    {
+      if (navmesh.GetAreaEdge(area.m_uiFirstEdge + e).m_iNeighborArea == iArea2)
+        return true;
+    }
+
+    return false;
+  }
+} // namespace PathQueryTestDetail
+
+EZ_CREATE_SIMPLE_TEST(DataStructures, PathQueryWorldModule)
+{
+  using namespace PathQueryTestDetail;
+
+  ezGameGrid<ezUInt8> grid;
+  ezGridNavmesh navmesh;
+  CreateNavmesh(grid, navmesh);
+
+  ezWorldDesc worldDesc("PathQueryTest");
+  ezWorld world(worldDesc);
+  EZ_LOCK(world.GetWriteMarker());
+
+  ezPathQueryWorldModule* pModule = world.GetOrCreateModule<ezPathQueryWorldModule>();
+  pModule->SetNavmesh(&navmesh);
+
+  ezDynamicArray<ezPathQueryResult> results;
+  ezDynamicArray<ezDynamicArray<ezInt32>> resultAreas;
+
+  auto StoreResult = [&](const ezPathQueryResult& result) {
+    results.PushBack(result);
+
+    // the areas are only valid during the callback
+    resultAreas.ExpandAndGetRef() = result.m_Areas;
+    results.PeekBack().m_Areas = ezArrayPtr<const ezInt32>();
+  };
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Paths")
+  {
+    const ezVec2I32 queries[][2] = {
+      {ezVec2I32(2, 2), ezVec2I32(28, 2)},   // through the gap
+      {ezVec2I32(3, 2), ezVec2I32(29, 3)},   // same areas as the first one, shares its search
+      {ezVec2I32(28, 2), ezVec2I32(2, 2)},   // the other way round
+      {ezVec2I32(2, 2), ezVec2I32(16, 5)},   // blocked target
+      {ezVec2I32(2, 2), ezVec2I32(2, 2)},    // same cell
+    };
+
+    ezUInt32 queryIDs[EZ_ARRAY_SIZE(queries)];
+    for (ezUInt32 i = 0; i < EZ_ARRAY_SIZE(queries); ++i)
+    {
+      queryIDs[i] = pModule->QueueQuery(queries[i][0], queries[i][1], StoreResult);
+    }
+
+    EZ_TEST_INT(pModule->GetNumPendingQueries(), EZ_ARRAY_SIZE(queries));
+
+    pModule->FinishAllQueries();
+
+    EZ_TEST_INT(pModule->GetNumPendingQueries(), 0);
+
+    if (EZ_TEST_INT(results.GetCount(), EZ_ARRAY_SIZE(queries)).Succeeded())
+    {
+      for (ezUInt32 i = 0; i < results.GetCount(); ++i)
+      {
+        const ezPathQueryResult& result = results[i];
+        const ezDynamicArray<ezInt32>& areas = resultAreas[i];
+
+        EZ_TEST_INT(result.m_uiQueryID, queryIDs[i]);
+        EZ_TEST_BOOL(result.m_StartCoord == queries[i][0]);
+        EZ_TEST_BOOL(result.m_TargetCoord == queries[i][1]);
+
+        if (navmesh.GetAreaAt(result.m_TargetCoord) < 0)
+        {
+          EZ_TEST_BOOL(result.m_Result.Failed());
+          EZ_TEST_BOOL(areas.IsEmpty());
+          continue;
+        }
+
+        if (!EZ_TEST_BOOL(result.m_Result.Succeeded()).Succeeded() || !EZ_TEST_BOOL(!areas.IsEmpty()).Succeeded())
+          continue;
+
+        EZ_TEST_INT(areas[0], navmesh.GetAreaAt(result.m_StartCoord));
+        EZ_TEST_INT(areas.PeekBack(), navmesh.GetAreaAt(result.m_TargetCoord));
+
+        for (ezUInt32 a = 1; a < areas.GetCount(); ++a)
+        {
+          EZ_TEST_BOOL(AreNeighbors(navmesh, areas[a - 1], areas[a]));
+        }
+
+        // paths between the two halves have to go up to the gap and back down
+        if ((result.m_StartCoord.x < 16) != (result.m_TargetCoord.x < 16))
+        {
+          EZ_TEST_BOOL(result.m_fPathCost > 2.0f * (g_uiGridSize - 8));
+        }
+      }
+    }
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Time Budget")
+  {
+    results.Clear();
+    resultAreas.Clear();
+
+    // every query starts in a different block of the left half, so none of the searches can be merged
+    const ezUInt32 uiNumQueries = 32;
+    for (ezUInt32 i = 0; i < uiNumQueries; ++i)
+    {
+      pModule->QueueQuery(ezVec2I32(4 * (i % 4) + 1, 4 * (i / 4) + 1), ezVec2I32(31, 0), StoreResult);
+    }
+
+    // with no budget every batch only executes a few searches, the remaining queries are postponed to the next batches
+    pModule->SetTimeBudget(ezTime::Zero());
+    world.Update();
+
+    EZ_TEST_INT(pModule->GetNumPendingQueries(), uiNumQueries);
+    EZ_TEST_BOOL(results.IsEmpty());
+
+    ezUInt32 uiNumUpdates = 0;
+    ezUInt32 uiNumDelivered = 0;
+
+    while (pModule->GetNumPendingQueries() > 0 && uiNumUpdates < uiNumQueries * 2)
+    {
+      world.Update();
+      ++uiNumUpdates;
+
+      // at least one search is executed per batch, so queries are never postponed forever
+      EZ_TEST_BOOL(results.GetCount() > uiNumDelivered);
+      uiNumDelivered = results.GetCount();
+    }
+
+    EZ_TEST_INT(pModule->GetNumPendingQueries(), 0);
+    EZ_TEST_BOOL(uiNumUpdates > 1);
+
+    // postponed queries keep their order
+    if (EZ_TEST_INT(results.GetCount(), uiNumQueries).Succeeded())
+    {
+      for (ezUInt32 i = 1; i < results.GetCount(); ++i)
+      {
+        EZ_TEST_BOOL(results[i - 1].m_uiQueryID < results[i].m_uiQueryID);
+      }
+    }
+
+    pModule->SetTimeBudget(ezTime::Milliseconds(4));
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Default Budget")
+  {
+    results.Clear();
+    resultAreas.Clear();
+
+    const ezUInt32 uiNumQueries = 32;
+    for (ezUInt32 i = 0; i < uiNumQueries; ++i)
+    {
+      pModule->QueueQuery(ezVec2I32(4 * (i % 4) + 1, 4 * (i / 4) + 1), ezVec2I32(31, 0), StoreResult);
+    }
+
+    EZ_TEST_BOOL(pModule->GetTimeBudget() == ezTime::Milliseconds(4));
+
+    world.Update();
+
+    // the tasks may only start after more than the budget has passed since the batch was scheduled
+    ezThreadUtils::Sleep(ezTime::Milliseconds(10));
+
+    world.Update();
+
+    // the budget only starts with the first search, so the batch executes more than the one guaranteed search
+    EZ_TEST_BOOL(results.GetCount() > 1);
+
+    pModule->FinishAllQueries();
+    EZ_TEST_INT(results.GetCount(), uiNumQueries);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "SetNavmesh in Callback")
+  {
+    ezUInt32 uiNumCallbacks = 0;
+
+    auto ResetNavmesh = [&](const ezPathQueryResult& result) {
+      ++uiNumCallbacks;
+
+      // cancels all other queries of the batch
+      pModule->SetNavmesh(&navmesh);
+    };
+
+    for (ezUInt32 i = 0; i < 4; ++i)
+    {
+      pModule->QueueQuery(ezVec2I32(2, 2 + i), ezVec2I32(28, 2), ResetNavmesh);
+    }
+
+    pModule->FinishAllQueries();
+
+    EZ_TEST_INT(uiNumCallbacks, 1);
+    EZ_TEST_INT(pModule->GetNumPendingQueries(), 0);
+
+    // the module still works after the navmesh was changed during the callbacks
+    results.Clear();
+    resultAreas.Clear();
+
+    pModule->QueueQuery(ezVec2I32(2, 2), ezVec2I32(28, 2), StoreResult);
+    pModule->FinishAllQueries();
+
+    if (EZ_TEST_INT(results.GetCount(), 1).Succeeded())
+    {
+      EZ_TEST_BOOL(results[0].m_Result.Succeeded());
+    }
+  }
+
+  pModule->SetNavmesh(nullptr);
+}
@@ -0,0 +1,194 @@
+#include <GameEngineTestPCH.h>
+
+#include <Foundation/Math/Random.h>
+#include <Foundation/Time/Stopwatch.h>
+#include <Utilities/PathFinding/GraphSearch.h>
+
+namespace PathSearchTestDetail
+{
+  static const ezUInt32 g_uiGridSize = 512;
+
+  /// 4-neighborhood on a square grid with blocked cells, every step costs 1.
+  class GridStateGenerator : public ezPathStateGenerator<ezPathState>
+  {
+  public:
+    GridStateGenerator(const ezDynamicArray<bool>& blocked)
+      : m_Blocked(blocked)
+    {
+    }
+
+    virtual void StartSearch(ezInt64 iStartNodeIndex, const ezPathState* pStartState, ezInt64 iTargetNodeIndex) override
+    {
+      m_iTargetNodeIndex = iTargetNodeIndex;
+    }
+
+    virtual void GenerateAdjacentStates(ezInt64 iNodeIndex, const ezPathState& StartState, ezPathSearch<ezPathState>* pPathSearch) override
+    {
+      const ezInt32 x = static_cast<ezInt32>(iNodeIndex % g_uiGridSize);
+      const ezInt32 y = static_cast<ezInt32>(iNodeIndex / g_uiGridSize);
+
+      const ezInt32 offsets[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+
+      for (ezUInt32 i = 0; i < 4; ++i)
+      {
+        const ezInt32 nx = x + offsets[i][0];
+        const ezInt32 ny = y + offsets[i][1];
+
+        if (nx < 0 || ny < 0 || nx >= (ezInt32)g_uiGridSize || ny >= (ezInt32)g_uiGridSize)
+          continue;
+
+        const ezInt64 iNeighbor = ny * g_uiGridSize + nx;
+        if (m_Blocked[static_cast<ezUInt32>(iNeighbor)])
+          continue;
+
+        ezPathState state;
+        state.m_fCostToNode = StartState.m_fCostToNode + 1.0f;
+        state.m_fEstimatedCostToTarget = state.m_fCostToNode + GetDistance(iNeighbor, m_iTargetNodeIndex);
+
+        pPathSearch->AddPathNode(iNeighbor, state);
+      }
+    }
+
+    static float GetDistance(ezInt64 iNode1, ezInt64 iNode2)
+    {
+      const ezInt64 dx = ezMath::Abs((iNode1 % g_uiGridSize) - (iNode2 % g_uiGridSize));
+      const ezInt64 dy = ezMath::Abs((iNode1 / g_uiGridSize) - (iNode2 / g_uiGridSize));
+      return static_cast<float>(dx + dy);
+    }
+
+  private:
+    const ezDynamicArray<bool>& m_Blocked;
+    ezInt64 m_iTargetNodeIndex = 0;
+  };
+
+  /// Breadth-first search for the reference path length, -1 if the target is unreachable.
+  static ezInt32 ComputeReferenceDistance(const ezDynamicArray<bool>& blocked, ezUInt32 uiStart, ezUInt32 uiTarget)
+  {
+    ezDynamicArray<ezInt32> distances;
+    distances.SetCount(g_uiGridSize * g_uiGridSize, -1);
+
+    ezDynamicArray<ezUInt32> queue;
+    queue.PushBack(uiStart);
+    distances[uiStart] = 0;
+
+    for (ezUInt32 i = 0; i < queue.GetCount(); ++i)
+    {
+      const ezUInt32 uiCell = queue[i];
+
+      if (uiCell == uiTarget)
+        return distances[uiCell];
+
+      const ezUInt32 x = uiCell % g_uiGridSize;
+      const ezUInt32 y = uiCell / g_uiGridSize;
+
+      const ezUInt32 neighbors[4] = {x > 0 ? uiCell - 1 : ezInvalidIndex, x + 1 < g_uiGridSize ? uiCell + 1 : ezInvalidIndex,
+        y > 0 ? uiCell - g_uiGridSize : ezInvalidIndex, y + 1 < g_uiGridSize ? uiCell + g_uiGridSize : ezInvalidIndex};
+
+      for (ezUInt32 uiNeighbor : neighbors)
+      {
+        if (uiNeighbor != ezInvalidIndex && !blocked[uiNeighbor] && distances[uiNeighbor] < 0)
+        {
+          distances[uiNeighbor] = distances[uiCell] + 1;
+          queue.PushBack(uiNeighbor);
+        }
+      }
+    }
+
+    return -1;
+  }
+} // namespace PathSearchTestDetail
+
+EZ_CREATE_SIMPLE_TEST(DataStructures, PathSearch)
+{
+  using namespace PathSearchTestDetail;
+
+  // a grid with about 25% randomly blocked cells
+  ezDynamicArray<bool> blocked;
+  blocked.SetCount(g_uiGridSize * g_uiGridSize);
+
+  ezRandom rng;
+  rng.Initialize(23);
+
+  for (ezUInt32 i = 0; i < blocked.GetCount(); ++i)
+  {
+    blocked[i] = rng.UIntInRange(4) == 0;
+  }
+
+  const ezUInt32 uiNumSearches = 20;
+  ezUInt32 searches[uiNumSearches][2];
+  for (ezUInt32 i = 0; i < uiNumSearches; ++i)
+  {
+    // alternate between long diagonal searches and random ones
+    ezUInt32 uiStart = (i % 2 == 0) ? 0 : rng.UIntInRange(blocked.GetCount());
+    ezUInt32 uiTarget = (i % 2 == 0) ? blocked.GetCount() - 1 : rng.UIntInRange(blocked.GetCount());
+
+    blocked[uiStart] = false;
+    blocked[uiTarget] = false;
+
+    searches[i][0] = uiStart;
+    searches[i][1] = uiTarget;
+  }
+
+  GridStateGenerator generator(blocked);
+
+  auto RunSearches = [&](ezPathSearch<ezPathState>& search, const char* szMode) {
+    ezPathState startState;
+    ezDeque<ezPathSearch<ezPathState>::PathResultData> path;
+    ezTime tTotal;
+
+    for (ezUInt32 i = 0; i < uiNumSearches; ++i)
+    {
+      const ezUInt32 uiStart = searches[i][0];
+      const ezUInt32 uiTarget = searches[i][1];
+
+      startState.m_fCostToNode = 0.0f;
+      startState.m_fEstimatedCostToTarget = GridStateGenerator::GetDistance(uiStart, uiTarget);
+
+      ezStopwatch sw;
+      const ezResult res = search.FindPath(uiStart, startState, uiTarget, path);
+      tTotal += sw.GetRunningTotal();
+
+      const ezInt32 iReferenceDistance = ComputeReferenceDistance(blocked, uiStart, uiTarget);
+
+      if (iReferenceDistance < 0)
+      {
+        EZ_TEST_BOOL(res.Failed());
+        continue;
+      }
+
+      // the heuristic never overestimates, so the path must be as short as the breadth-first search result
+      if (EZ_TEST_BOOL(res.Succeeded()).Succeeded())
+      {
+        EZ_TEST_INT(path.GetCount(), iReferenceDistance + 1);
+        EZ_TEST_INT(path[0].m_iNodeIndex, uiStart);
+        EZ_TEST_INT(path.PeekBack().m_iNodeIndex, uiTarget);
+        EZ_TEST_FLOAT(path.PeekBack().m_pPathState->m_fCostToNode, static_cast<float>(iReferenceDistance), 0.0f);
+
+        for (ezUInt32 p = 1; p < path.GetCount(); ++p)
+        {
+          EZ_TEST_FLOAT(GridStateGenerator::GetDistance(path[p - 1].m_iNodeIndex, path[p].m_iNodeIndex), 1.0f, 0.0f);
+        }
+      }
+    }
+
+    ezTestFramework::Output(ezTestOutput::Duration, "%u path searches on a %ux%u grid (%s): %.2fms", uiNumSearches, g_uiGridSize, g_uiGridSize,
+      szMode, tTotal.GetMilliseconds());
+  };
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "FindPath (Hash Table)")
+  {
+    ezPathSearch<ezPathState> search;
+    search.SetPathStateGenerator(&generator);
+
+    RunSearches(search, "hash table");
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "FindPath (Dense Node Indices)")
+  {
+    ezPathSearch<ezPathState> search;
+    search.SetPathStateGenerator(&generator);
+    search.SetDenseNodeIndexRange(g_uiGridSize * g_uiGridSize);
+
+    RunSearches(search, "dense");
+  }
+}
@@ -0,0 +1,155 @@
+#include <GameEngineTestPCH.h>
+
+#include <Core/ResourceManager/ResourceManager.h>
+#include <Foundation/Time/Stopwatch.h>
+#include <Foundation/Types/UniquePtr.h>
+#include <GameEngine/VisualScript/Nodes/VisualScriptMathNodes.h>
+#include <GameEngine/VisualScript/Nodes/VisualScriptMessageNodes.h>
+#include <GameEngine/VisualScript/Nodes/VisualScriptVariableNodes.h>
+#include <GameEngine/VisualScript/VisualScriptInstance.h>
+#include <GameEngine/VisualScript/VisualScriptResource.h>
+
+EZ_CREATE_SIMPLE_TEST_GROUP(VisualScript);
+
+namespace VisualScriptTestDetail
+{
+  static void AddNode(ezVisualScriptResourceDescriptor& desc, const ezRTTI* pType)
+  {
+    auto& node = desc.m_Nodes.ExpandAndGetRef();
+    node.m_pType = pType;
+    node.m_sTypeName = pType->GetTypeName();
+    node.m_uiFirstProperty = static_cast<ezUInt16>(desc.m_Properties.GetCount());
+  }
+
+  static void AddProperty(ezVisualScriptResourceDescriptor& desc, const char* szName, const ezVariant& value)
+  {
+    auto& prop = desc.m_Properties.ExpandAndGetRef();
+    prop.m_sName = szName;
+    prop.m_Value = value;
+
+    ++desc.m_Nodes.PeekBack().m_uiNumProperties;
+  }
+
+  static void AddDataConnection(ezVisualScriptResourceDescriptor& desc, ezUInt16 uiSourceNode, ezUInt16 uiTargetNode, ezUInt8 uiInputPin)
+  {
+    auto& con = desc.m_DataPaths.ExpandAndGetRef();
+    con.m_uiSourceNode = uiSourceNode;
+    con.m_uiOutputPin = 0;
+    con.m_uiOutputPinType = ezVisualScriptDataPinType::Number;
+    con.m_uiTargetNode = uiTargetNode;
+    con.m_uiInputPin = uiInputPin;
+    con.m_uiInputPinType = ezVisualScriptDataPinType::Number;
+  }
+
+  /// Every update: Counter = Counter * 1 + 1 * 1
+  static ezVisualScriptResourceDescriptor CreateCounterScript()
+  {
+    ezVisualScriptResourceDescriptor desc;
+
+    AddNode(desc, ezGetStaticRTTI<ezVisualScriptNode_ScriptUpdateEvent>()); // 0
+
+    AddNode(desc, ezGetStaticRTTI<ezVisualScriptNode_Number>()); // 1
+    AddProperty(desc, "Name", "Counter");
+
+    AddNode(desc, ezGetStaticRTTI<ezVisualScriptNode_MultiplyAdd>()); // 2
+    AddProperty(desc, "a2", 1.0);
+    AddProperty(desc, "b1", 1.0);
+    AddProperty(desc, "b2", 1.0);
+
+    AddNode(desc, ezGetStaticRTTI<ezVisualScriptNode_StoreNumber>()); // 3
+    AddProperty(desc, "Name", "Counter");
+
+    auto& exec = desc.m_ExecutionPaths.ExpandAndGetRef();
+    exec.m_uiSourceNode = 0;
+    exec.m_uiOutputPin = 0;
+    exec.m_uiTargetNode = 3;
+    exec.m_uiInputPin = 0;
+
+    AddDataConnection(desc, 1, 2, 0);
+    AddDataConnection(desc, 2, 3, 0);
+
+    return desc;
+  }
+} // namespace VisualScriptTestDetail
+
+EZ_CREATE_SIMPLE_TEST(VisualScript, Instances)
+{
+  using namespace VisualScriptTestDetail;
+
+  ezVisualScriptResourceHandle hScript =
+    ezResourceManager::CreateResource<ezVisualScriptResource>("VisualScriptTest_Counter", CreateCounterScript(), "Counter Script");
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Execute")
+  {
+    ezVisualScriptInstance instance;
+    instance.Configure(hScript, nullptr);
+
+    for (ezUInt32 uiFrame = 1; uiFrame <= 5; ++uiFrame)
+    {
+      instance.ExecuteScript();
+
+      double fCounter = 0;
+      instance.GetLocalVariables().RetrieveDouble(ezTempHashedString("Counter"), fCounter);
+      EZ_TEST_DOUBLE(fCounter, static_cast<double>(uiFrame), 0);
+    }
+
+    // configuring again must reset the state of the instance
+    instance.Configure(hScript, nullptr);
+    instance.ExecuteScript();
+
+    double fCounter = 0;
+    instance.GetLocalVariables().RetrieveDouble(ezTempHashedString("Counter"), fCounter);
+    EZ_TEST_DOUBLE(fCounter, 1.0, 0);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "10k Instances")
+  {
+    const ezUInt32 uiNumInstances = 10000;
+    const ezUInt32 uiNumFrames = 10;
+
+    ezDynamicArray<ezUniquePtr<ezVisualScriptInstance>> instances;
+    instances.SetCount(uiNumInstances);
+
+    ezStopwatch sw;
+
+    for (ezUInt32 i = 0; i < uiNumInstances; ++i)
+    {
+      instances[i] = EZ_DEFAULT_NEW(ezVisualScriptInstance);
+      instances[i]->Configure(hScript, nullptr);
+    }
+
+    const ezTime tInstantiation = sw.Checkpoint();
+
+    for (ezUInt32 uiFrame = 0; uiFrame < uiNumFrames; ++uiFrame)
+    {
+      for (ezUInt32 i = 0; i < uiNumInstances; ++i)
+      {
+        instances[i]->ExecuteScript();
+      }
+    }
+
+    const ezTime tExecution = sw.Checkpoint();
+
+    ezUInt32 uiNumCorrect = 0;
+    for (ezUInt32 i = 0; i < uiNumInstances; ++i)
+    {
+      double fCounter = 0;
+      instances[i]->GetLocalVariables().RetrieveDouble(ezTempHashedString("Counter"), fCounter);
+
+      if (fCounter == uiNumFrames)
+        ++uiNumCorrect;
+    }
+
+    EZ_TEST_INT(uiNumCorrect, uiNumInstances);
+
+    instances.Clear();
+
+    const ezTime tDestruction = sw.Checkpoint();
+
+    ezTestFramework::Output(ezTestOutput::Duration, "%u visual script instances: configure %.2fms, execute %.3fms per frame, destroy %.2fms",
+      uiNumInstances, tInstantiation.GetMilliseconds(), tExecution.GetMilliseconds() / uiNumFrames, tDestruction.GetMilliseconds());
+  }
+
+  hScript.Invalidate();
+  ezResourceManager::FreeAllUnusedResources();
+}